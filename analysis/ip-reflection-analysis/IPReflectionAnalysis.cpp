@@ -8,23 +8,31 @@
 #include "IPReflectionAnalysis.h"
 
 #include <fstream>
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
 
 #include <sparta/AbstractDomain.h>
 #include <sparta/PatriciaTreeMapAbstractEnvironment.h>
 #include <sparta/PatriciaTreeMapAbstractPartition.h>
 
+#include "AnalysisSummaryCache.h"
 #include "CallGraph.h"
 #include "ConfigFiles.h"
 #include "MethodOverrideGraph.h"
+#include "PassManager.h"
 #include "Resolver.h"
 #include "Show.h"
 #include "SpartaInterprocedural.h"
+#include "Trace.h"
 
 namespace {
 
 const std::string REFLECTION_ANALYSIS_RESULT_FILE =
     "redex-reflection-analysis.txt";
 
+constexpr const char* SUMMARY_CACHE_NAME = "ip_reflection_return_values";
+
 using namespace sparta;
 using namespace sparta_interprocedural;
 
@@ -83,7 +91,7 @@ struct Summary final : public AbstractDomain<Summary> {
     m_return = std::move(retval);
   }
 
-  reflection::AbstractObjectDomain get_return_value() {
+  reflection::AbstractObjectDomain get_return_value() const {
     if (is_top()) {
       return reflection::AbstractObjectDomain::top();
     }
@@ -199,7 +207,9 @@ class ReflectionAnalyzer : public Base {
     }
     this->get_summaries()->maybe_update(m_method, [&](Summary& old) {
       if (old == m_summary) {
-        // no change will be made
+        // No change that callers could observe. The reflection sites are
+        // still missing if the summary was seeded from the summary cache.
+        old.set_reflection_sites(m_summary.get_reflection_sites());
         return false;
       }
       old = m_summary; // overwrite previous value
@@ -223,19 +233,176 @@ struct ReflectionAnalysisAdaptor : public AnalysisAdaptorBase {
 };
 
 using Analysis =
-    InterproceduralAnalyzer<ReflectionAnalysisAdaptor, AnalysisParameters>;
+    IncrementalInterproceduralAnalyzer<ReflectionAnalysisAdaptor,
+                                       AnalysisParameters>;
+
+/*
+ * Return values are persisted in the analysis summary cache, one line per
+ * method, as tab-separated fields:
+ *
+ *   method  kind  type  string  int  potential-types  type-array
+ *
+ * where absent fields are "-", lists are comma-separated, and type arrays are
+ * prefixed with "@". Values referring to method-local heap addresses, or to
+ * strings that do not fit on a line, are not persisted; they get recomputed.
+ */
+boost::optional<std::string> encode_return_value(
+    const DexMethod* method, const reflection::AbstractObjectDomain& domain) {
+  auto obj = domain.get_object();
+  if (!obj || obj->heap_address != 0) {
+    return boost::none;
+  }
+  if (obj->dex_string != nullptr &&
+      obj->dex_string->str().find_first_of("\t\n") != std::string::npos) {
+    return boost::none;
+  }
+  std::ostringstream oss;
+  oss << show(method) << "\t" << obj->obj_kind << "\t"
+      << (obj->dex_type ? obj->dex_type->str() : "-") << "\t"
+      << (obj->dex_string ? obj->dex_string->str() : "-") << "\t";
+  if (obj->dex_int) {
+    oss << *obj->dex_int;
+  } else {
+    oss << "-";
+  }
+  oss << "\t";
+  std::vector<std::string> potential_types;
+  for (auto* type : obj->potential_dex_types) {
+    potential_types.push_back(type->str_copy());
+  }
+  std::sort(potential_types.begin(), potential_types.end());
+  oss << (potential_types.empty() ? "-" : boost::join(potential_types, ","))
+      << "\t";
+  if (obj->dex_type_array) {
+    oss << "@";
+    bool first = true;
+    for (auto* type : *obj->dex_type_array) {
+      oss << (first ? "" : ",") << (type ? type->str() : "?");
+      first = false;
+    }
+  } else {
+    oss << "-";
+  }
+  return oss.str();
+}
+
+boost::optional<std::pair<const DexMethod*, reflection::AbstractObject>>
+decode_return_value(const std::string& line) {
+  std::vector<std::string> fields;
+  boost::split(fields, line, [](char c) { return c == '\t'; });
+  if (fields.size() != 7) {
+    return boost::none;
+  }
+  auto* method_ref = DexMethod::get_method(fields[0]);
+  if (method_ref == nullptr || !method_ref->is_def()) {
+    return boost::none;
+  }
+  bool valid = true;
+  auto get_type = [&valid](const std::string& name) -> DexType* {
+    auto* type = DexType::get_type(name);
+    valid &= type != nullptr;
+    return type;
+  };
+
+  reflection::AbstractObject obj;
+  obj.obj_kind = (reflection::AbstractObjectKind)std::stoi(fields[1]);
+  obj.dex_type = fields[2] == "-" ? nullptr : get_type(fields[2]);
+  obj.dex_string =
+      fields[3] == "-" ? nullptr : DexString::make_string(fields[3]);
+  if (fields[4] != "-") {
+    obj.dex_int = std::stoll(fields[4]);
+  }
+  if (fields[5] != "-") {
+    std::vector<std::string> names;
+    boost::split(names, fields[5], [](char c) { return c == ','; });
+    for (const auto& name : names) {
+      obj.potential_dex_types.insert(get_type(name));
+    }
+  }
+  if (fields[6] != "-") {
+    obj.dex_type_array = std::vector<DexType*>();
+    if (fields[6].size() > 1) {
+      std::vector<std::string> names;
+      boost::split(names, fields[6].substr(1),
+                   [](char c) { return c == ','; });
+      for (const auto& name : names) {
+        obj.dex_type_array->push_back(name == "?" ? nullptr : get_type(name));
+      }
+    }
+  }
+  if (!valid) {
+    return boost::none;
+  }
+  return std::make_pair((const DexMethod*)method_ref->as_def(), std::move(obj));
+}
 
 } // namespace
 
 void IPReflectionAnalysisPass::run_pass(DexStoresVector& stores,
                                         ConfigFiles& conf,
-                                        PassManager& /* pm */) {
+                                        PassManager& pm) {
 
   Scope scope = build_class_scope(stores);
   AnalysisParameters param;
   auto analysis = Analysis(scope, m_max_iteration, &param);
+
+  // Return values of the same code from an earlier build are the fixpoint of
+  // the analysis, so seeding them lets it converge in a single iteration. The
+  // reflection sites themselves refer to registers, which the scope digest
+  // does not cover, so they are always recomputed.
+  boost::optional<std::string> summary_key;
+  size_t num_seeded = 0;
+  if (analysis_summary_cache::enabled()) {
+    summary_key = analysis_summary_cache::make_key(
+        analysis_summary_cache::scope_digest(scope),
+        {"max_iteration=" + std::to_string(m_max_iteration)});
+    auto lines = analysis_summary_cache::load(SUMMARY_CACHE_NAME, *summary_key);
+    if (lines) {
+      std::vector<std::pair<const DexMethod*, reflection::AbstractObject>>
+          seeds;
+      seeds.reserve(lines->size());
+      for (const auto& line : *lines) {
+        auto seed = decode_return_value(line);
+        if (!seed) {
+          TRACE(REFL, 1, "Ignoring reflection summaries, cannot decode %s",
+                line.c_str());
+          seeds.clear();
+          break;
+        }
+        seeds.push_back(std::move(*seed));
+      }
+      for (auto& [method, obj] : seeds) {
+        analysis.registry.update(method, [&](const Summary&) {
+          Summary summary;
+          summary.set_value(reflection::AbstractObjectDomain(obj));
+          return summary;
+        });
+      }
+      analysis.registry.materialize_update();
+      num_seeded = seeds.size();
+    }
+  }
+
   analysis.run();
   const auto& summaries = analysis.registry.get_map();
+  pm.set_metric("num_seeded_summaries", num_seeded);
+  pm.set_metric("num_analyzed_methods", analysis.num_analyzed());
+  pm.set_metric("num_reused_methods", analysis.num_reused());
+
+  if (summary_key) {
+    std::vector<std::string> lines;
+    for (const auto& [method, summary] : summaries) {
+      if (!summary.is_value()) {
+        continue;
+      }
+      if (auto line =
+              encode_return_value(method, summary.get_return_value())) {
+        lines.push_back(std::move(*line));
+      }
+    }
+    std::sort(lines.begin(), lines.end());
+    analysis_summary_cache::store(SUMMARY_CACHE_NAME, *summary_key, lines);
+  }
   m_result = std::make_shared<Result>();
   for (const auto& entry : summaries) {
     (*m_result)[entry.first] = entry.second.get_reflection_sites();
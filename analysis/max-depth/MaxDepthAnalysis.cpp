@@ -162,8 +162,13 @@ class MaxDepthFunctionAnalyzer : public Base {
     if (!m_method) {
       return;
     }
-    this->get_summaries()->update(m_method,
-                                  [&](const DepthDomain&) { return m_domain; });
+    this->get_summaries()->maybe_update(m_method, [&](DepthDomain& old) {
+      if (old.equals(m_domain)) {
+        return false;
+      }
+      old = m_domain;
+      return true;
+    });
   }
 };
 
@@ -180,7 +185,7 @@ struct MaxDepthAnalysisAdaptor : public BottomUpAnalysisAdaptorBase {
   using Callsite = Caller;
 };
 
-using Analysis = InterproceduralAnalyzer<MaxDepthAnalysisAdaptor>;
+using Analysis = IncrementalInterproceduralAnalyzer<MaxDepthAnalysisAdaptor>;
 
 } // namespace
 
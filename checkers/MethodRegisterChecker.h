@@ -11,11 +11,11 @@
 
 namespace redex_properties {
 
-class MethodRegisterChecker : public PropertyChecker {
+class MethodRegisterChecker : public MethodPropertyChecker {
  public:
-  MethodRegisterChecker() : PropertyChecker(names::MethodRegister) {}
+  MethodRegisterChecker() : MethodPropertyChecker(names::MethodRegister) {}
 
-  void run_checker(DexStoresVector&, ConfigFiles&, PassManager&, bool) override;
+  void check_method(DexMethod* method, IRCode& code) override;
 };
 
 } // namespace redex_properties
@@ -11,12 +11,12 @@
 
 namespace redex_properties {
 
-class NoInitClassInstructionsChecker : public PropertyChecker {
+class NoInitClassInstructionsChecker : public MethodPropertyChecker {
  public:
   NoInitClassInstructionsChecker()
-      : PropertyChecker(names::NoInitClassInstructions) {}
+      : MethodPropertyChecker(names::NoInitClassInstructions) {}
 
-  void run_checker(DexStoresVector&, ConfigFiles&, PassManager&, bool) override;
+  void check_method(DexMethod* method, IRCode& code) override;
 };
 
 } // namespace redex_properties
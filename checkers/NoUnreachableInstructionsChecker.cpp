@@ -9,23 +9,18 @@
 
 #include "Debug.h"
 #include "DexClass.h"
+#include "EditableCfgAdapter.h"
 #include "Show.h"
-#include "Walkers.h"
 
 namespace redex_properties {
 
-void NoUnreachableInstructionsChecker::run_checker(DexStoresVector& stores,
-                                                   ConfigFiles& /* conf */,
-                                                   PassManager& /*mgr*/,
-                                                   bool established) {
-  if (!established) {
-    return;
-  }
-  const auto& scope = build_class_scope(stores);
-  walk::parallel::opcodes(scope, [&](DexMethod* method, IRInstruction* insn) {
-    always_assert_log(!opcode::is_unreachable(insn->opcode()),
+void NoUnreachableInstructionsChecker::check_method(DexMethod* method,
+                                                    IRCode& code) {
+  editable_cfg_adapter::iterate(&code, [&](MethodItemEntry& mie) {
+    always_assert_log(!opcode::is_unreachable(mie.insn->opcode()),
                       "[%s] %s contains unreachable instruction!\n  {%s}",
-                      get_name(get_property()), SHOW(method), SHOW(insn));
+                      get_name(get_property()), SHOW(method), SHOW(mie.insn));
+    return editable_cfg_adapter::LOOP_CONTINUE;
   });
 }
 
@@ -11,12 +11,12 @@
 
 namespace redex_properties {
 
-class NoUnreachableInstructionsChecker : public PropertyChecker {
+class NoUnreachableInstructionsChecker : public MethodPropertyChecker {
  public:
   NoUnreachableInstructionsChecker()
-      : PropertyChecker(names::NoUnreachableInstructions) {}
+      : MethodPropertyChecker(names::NoUnreachableInstructions) {}
 
-  void run_checker(DexStoresVector&, ConfigFiles&, PassManager&, bool) override;
+  void check_method(DexMethod* method, IRCode& code) override;
 };
 
 } // namespace redex_properties
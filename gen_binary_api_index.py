@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# Converts a text framework API file (e.g. framework_classes_api_33.txt) into
+# the binary index that api::AndroidSDK loads without parsing. See
+# libredex/FrameworkApi.h for the format.
+
+import argparse
+import logging
+import struct
+
+
+_MAGIC = b"RDXAPIv1"
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Generate a binary framework API index"
+    )
+    parser.add_argument("api_file", help="Text API file")
+    parser.add_argument("-o", "--out", required=True, help="Binary API index")
+    return parser.parse_args()
+
+
+def read_classes(api_file):
+    with open(api_file, "r") as f:
+        # Some of the checked-in API files end in a NUL byte.
+        tokens = iter(f.read().replace("\0", " ").split())
+    classes = []
+    for cls in tokens:
+        access = int(next(tokens))
+        super_cls = next(tokens)
+        num_methods = int(next(tokens))
+        num_fields = int(next(tokens))
+        methods = []
+        for _ in range(num_methods):
+            tag = next(tokens)
+            assert tag == "M", f"Expected a method of {cls}, got {tag}"
+            methods.append((next(tokens), int(next(tokens))))
+        fields = []
+        for _ in range(num_fields):
+            tag = next(tokens)
+            assert tag == "F", f"Expected a field of {cls}, got {tag}"
+            fields.append((next(tokens), int(next(tokens))))
+        classes.append((cls, access, super_cls, methods, fields))
+    return classes
+
+
+def write_index(classes, out):
+    def u4(value):
+        return struct.pack("<I", value)
+
+    def string(value):
+        data = value.encode("utf-8")
+        return u4(len(data)) + data
+
+    with open(out, "wb") as f:
+        f.write(_MAGIC)
+        f.write(u4(len(classes)))
+        for cls, access, super_cls, methods, fields in sorted(classes):
+            f.write(string(cls) + u4(access) + string(super_cls))
+            f.write(u4(len(methods)) + u4(len(fields)))
+            for descriptor, member_access in methods + fields:
+                f.write(string(descriptor) + u4(member_access))
+
+
+def main():
+    args = parse_args()
+    classes = read_classes(args.api_file)
+    logging.info("Writing %d classes to %s", len(classes), args.out)
+    write_index(classes, args.out)
+
+
+if __name__ == "__main__":
+    logging.basicConfig(level=logging.INFO)
+    main()
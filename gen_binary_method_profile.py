@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# Converts an aggregated method stats csv (as listed in agg_method_stats_files)
+# into the columnar binary profile that MethodProfiles loads without parsing.
+# See libredex/MethodProfiles.h for the format.
+
+import argparse
+import logging
+import struct
+
+
+_MAGIC = b"RDXPRF01"
+
+# Columns of the main section, see the enum in libredex/MethodProfiles.h.
+_NAME = 1
+_APPEAR100 = 2
+_AVG_CALL = 4
+_AVG_RANK100 = 6
+_MIN_API_LEVEL = 7
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Generate a binary method profile from a csv one"
+    )
+    parser.add_argument("csv_file", help="Aggregated method stats csv")
+    parser.add_argument("-o", "--out", required=True, help="Binary profile")
+    return parser.parse_args()
+
+
+def read_profile(csv_file):
+    metadata = []
+    rows = []
+    interaction_id = ""
+    interaction_column = None
+    in_main = False
+    expect_metadata = False
+    with open(csv_file, "r") as f:
+        for line in f:
+            cells = line.rstrip("\r\n").split(",")
+            if in_main:
+                row_interaction = interaction_id
+                if interaction_column is not None:
+                    row_interaction = cells[interaction_column]
+                rows.append(
+                    (
+                        cells[_NAME],
+                        row_interaction,
+                        float(cells[_APPEAR100]),
+                        float(cells[_AVG_CALL]),
+                        float(cells[_AVG_RANK100]),
+                        int(cells[_MIN_API_LEVEL]),
+                    )
+                )
+            elif expect_metadata:
+                interaction_id = cells[0]
+                metadata.append((interaction_id, int(cells[1])))
+                expect_metadata = False
+            elif line.startswith("interaction"):
+                expect_metadata = True
+            else:
+                in_main = True
+                for col, header in enumerate(cells):
+                    if col > _MIN_API_LEVEL and header == "interaction":
+                        interaction_column = col
+    return metadata, rows
+
+
+def write_profile(metadata, rows, out):
+    def u4(value):
+        return struct.pack("<I", value)
+
+    def string(value):
+        data = value.encode("utf-8")
+        return u4(len(data)) + data
+
+    interactions = sorted({row[1] for row in rows})
+    interaction_index = {id: i for i, id in enumerate(interactions)}
+
+    names = bytearray()
+    offsets = [0]
+    for row in rows:
+        names += row[0].encode("utf-8")
+        offsets.append(len(names))
+
+    with open(out, "wb") as f:
+        f.write(_MAGIC)
+        f.write(u4(len(metadata)))
+        for interaction_id, count in metadata:
+            f.write(string(interaction_id) + u4(count))
+        f.write(u4(len(interactions)))
+        for interaction_id in interactions:
+            f.write(string(interaction_id))
+        f.write(u4(len(rows)))
+        f.write(struct.pack(f"<{len(offsets)}I", *offsets))
+        f.write(u4(len(names)) + names)
+        n = len(rows)
+        f.write(struct.pack(f"<{n}I", *(interaction_index[r[1]] for r in rows)))
+        f.write(struct.pack(f"<{n}d", *(r[2] for r in rows)))
+        f.write(struct.pack(f"<{n}d", *(r[3] for r in rows)))
+        f.write(struct.pack(f"<{n}d", *(r[4] for r in rows)))
+        f.write(struct.pack(f"<{n}h", *(r[5] for r in rows)))
+
+
+def main():
+    args = parse_args()
+    metadata, rows = read_profile(args.csv_file)
+    logging.info("Writing %d rows to %s", len(rows), args.out)
+    write_profile(metadata, rows, args.out)
+
+
+if __name__ == "__main__":
+    logging.basicConfig(level=logging.INFO)
+    main()
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "AnalysisSummaryCache.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <fstream>
+
+#include "Debug.h"
+#include "DexHasher.h"
+#include "RedexContext.h"
+#include "Trace.h"
+#include "WorkQueue.h"
+
+namespace {
+
+// Bump whenever the format or the meaning of any summary changes.
+constexpr const char* CACHE_HEADER = "redex-analysis-summary-cache v1";
+
+std::string path(const std::string& analysis, const std::string& key) {
+  return g_redex->analysis_summary_cache_dir + "/" + analysis + "-" + key +
+         ".txt";
+}
+
+} // namespace
+
+namespace analysis_summary_cache {
+
+bool enabled() { return !g_redex->analysis_summary_cache_dir.empty(); }
+
+std::string scope_digest(const Scope& scope) {
+  std::vector<std::pair<size_t, size_t>> class_hashes(scope.size());
+  workqueue_run_for<size_t>(0, scope.size(), [&](size_t i) {
+    auto hash = hashing::DexClassHasher(scope[i]).run();
+    class_hashes[i] = {hash.signature_hash, hash.code_hash};
+  });
+  std::sort(class_hashes.begin(), class_hashes.end());
+  return hashing::hash_to_string(boost::hash_value(class_hashes));
+}
+
+std::string file_digest(const std::string& path) {
+  std::ifstream input(path, std::ifstream::binary);
+  always_assert_log(input, "Can't open %s", path.c_str());
+  size_t hash = 0;
+  std::vector<char> chunk(1 << 20);
+  while (input) {
+    input.read(chunk.data(), chunk.size());
+    boost::hash_combine(hash, std::hash<std::string_view>()(std::string_view(
+                                  chunk.data(), input.gcount())));
+  }
+  return hashing::hash_to_string(hash);
+}
+
+std::string make_key(const std::string& scope_digest,
+                     const std::vector<std::string>& inputs) {
+  return scope_digest + "-" + hashing::hash_to_string(boost::hash_value(inputs));
+}
+
+boost::optional<std::vector<std::string>> load(const std::string& analysis,
+                                               const std::string& key) {
+  auto file = path(analysis, key);
+  std::ifstream input(file);
+  if (!input) {
+    return boost::none;
+  }
+  std::string line;
+  if (!std::getline(input, line) || line != CACHE_HEADER) {
+    TRACE(PM, 1, "Ignoring stale analysis summary %s", file.c_str());
+    return boost::none;
+  }
+  std::vector<std::string> lines;
+  while (std::getline(input, line)) {
+    lines.push_back(std::move(line));
+  }
+  TRACE(PM, 2, "Loaded %zu lines of analysis summary %s", lines.size(),
+        file.c_str());
+  return lines;
+}
+
+void store(const std::string& analysis,
+           const std::string& key,
+           const std::vector<std::string>& lines) {
+  boost::filesystem::create_directories(g_redex->analysis_summary_cache_dir);
+  auto file = path(analysis, key);
+  // Write to a temporary file first, so that concurrent or interrupted builds
+  // never observe a partial summary.
+  auto tmp_file = file + ".tmp";
+  {
+    std::ofstream out(tmp_file);
+    out << CACHE_HEADER << "\n";
+    for (const auto& line : lines) {
+      out << line << "\n";
+    }
+    always_assert_log(out.good(), "Could not write analysis summary to %s",
+                      tmp_file.c_str());
+  }
+  boost::filesystem::rename(tmp_file, file);
+}
+
+} // namespace analysis_summary_cache
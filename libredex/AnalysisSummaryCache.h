@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "DexClass.h"
+
+/*
+ * An on-disk cache of whole-program analysis summaries, so that summaries
+ * computed for a scope can be reused by later builds over the same code.
+ *
+ * The cache is enabled by setting the `analysis_summary_cache_dir` option of
+ * redex-all. Each summary is stored in its own file, named after the analysis
+ * and a key; the key combines the DexClassHasher digests of all classes of the
+ * scope (ignoring positions and register assignments, which the cached
+ * analyses don't depend on) with a digest of the analysis inputs. A summary is
+ * a list of lines, whose meaning is up to the analysis; references to methods
+ * and types are typically stored via `show`, and resolved again on load.
+ *
+ * The whole-program analyses that use this fold the state of all classes into
+ * their results, e.g. via the method override graph, so a summary can only be
+ * reused when none of the classes of the scope changed. Library jars are not
+ * part of the key; the cache directory must be cleared when they change.
+ */
+namespace analysis_summary_cache {
+
+bool enabled();
+
+// Returns an order-independent digest of all classes in the scope.
+std::string scope_digest(const Scope& scope);
+
+// Returns a digest of the contents of a file, for artifacts that are parsed
+// from an input file rather than computed from the scope.
+std::string file_digest(const std::string& path);
+
+// Combines the scope digest with a description of the other analysis inputs.
+std::string make_key(const std::string& scope_digest,
+                     const std::vector<std::string>& inputs);
+
+boost::optional<std::vector<std::string>> load(const std::string& analysis,
+                                               const std::string& key);
+
+void store(const std::string& analysis,
+           const std::string& key,
+           const std::vector<std::string>& lines);
+
+} // namespace analysis_summary_cache
@@ -35,8 +35,10 @@ const DexEncodedValue* parse_anno_value_helper(const DexAnnotationSet* anno_set,
       return elem.encoded_value.get();
     }
 
+    // Element names are interned, so compare them by identity.
+    const auto* elem_name = DexString::get_string(elem_str);
     for (auto& elem : elems) {
-      if (strcmp(elem.string->c_str(), elem_str.c_str()) != 0) {
+      if (elem.string != elem_name) {
         continue;
       }
       always_assert(elem.encoded_value->evtype() == type);
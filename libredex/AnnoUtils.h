@@ -57,13 +57,19 @@ template <class DexMember>
 bool has_attribute(DexMember* member,
                    const DexType* target_anno,
                    const std::string& attr_name) {
+  // Element names are interned, so a name that was never interned cannot be
+  // present, and others can be compared by identity.
+  const auto* attr = DexString::get_string(attr_name);
+  if (attr == nullptr) {
+    return false;
+  }
   auto& annos = member->get_anno_set()->get_annotations();
   for (auto& anno : annos) {
     if (anno->type() != target_anno) {
       continue;
     }
     for (auto& elem : anno->anno_elems()) {
-      if (strcmp(elem.string->c_str(), attr_name.c_str()) == 0) {
+      if (elem.string == attr) {
         return true;
       }
     }
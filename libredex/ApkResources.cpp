@@ -310,26 +310,42 @@ size_t TableSnapshot::package_count() {
   return m_table_parser.m_packages.size();
 }
 
-void TableSnapshot::get_type_names(uint32_t package_id,
-                                   std::vector<std::string>* out) {
+const TableSnapshot::TypeNameIndex& TableSnapshot::get_type_name_index(
+    uint32_t package_id) {
+  auto search = m_type_name_indices.find(package_id);
+  if (search != m_type_name_indices.end()) {
+    return search->second;
+  }
   auto& pool = m_type_strings.at(package_id);
+  auto& index = m_type_name_indices[package_id];
+  index.names.reserve(pool.size());
   for (size_t i = 0; i < pool.size(); i++) {
-    out->emplace_back(arsc::get_string_from_pool(pool, i));
+    index.names.emplace_back(arsc::get_string_from_pool(pool, i));
+    // Keep the first type of a given name, like a scan of the pool would.
+    index.name_to_type_id.emplace(index.names.back(), i + 1);
   }
+  return index;
+}
+
+void TableSnapshot::get_type_names(uint32_t package_id,
+                                   std::vector<std::string>* out) {
+  const auto& names = get_type_name_index(package_id).names;
+  out->insert(out->end(), names.begin(), names.end());
+}
+
+uint8_t TableSnapshot::get_type_id(uint32_t package_id,
+                                   const std::string& type_name) {
+  const auto& name_to_type_id =
+      get_type_name_index(package_id).name_to_type_id;
+  auto search = name_to_type_id.find(type_name);
+  return search == name_to_type_id.end() ? 0 : search->second;
 }
 
 void TableSnapshot::get_configurations(
     uint32_t package_id,
     const std::string& type_name,
     std::vector<android::ResTable_config>* out) {
-  uint8_t type_id = 0;
-  auto& pool = m_type_strings.at(package_id);
-  for (size_t i = 0; i < pool.size(); i++) {
-    if (type_name == arsc::get_string_from_pool(pool, i)) {
-      type_id = i + 1;
-      break;
-    }
-  }
+  uint8_t type_id = get_type_id(package_id, type_name);
   if (type_id > 0) {
     auto configs = m_table_parser.get_configs(package_id, type_id);
     for (const auto& c : configs) {
@@ -2405,6 +2421,16 @@ android::ResTable_config* find_equivalent_config_key(
 } // namespace
 
 size_t ResourcesArscFile::serialize() {
+  if (m_ids_to_remove.empty() && m_added_types.empty()) {
+    // Nothing alters the layout of the table, and any value edits (i.e. remap
+    // of ids) have been made in place in the writable mapping. Re-assembling
+    // would reproduce the input byte for byte, so just unmap the file.
+    TRACE(RES, 9, "No pending table changes, keeping %s as is",
+          m_path.c_str());
+    mark_file_closed();
+    m_f.file.reset();
+    return m_arsc_len;
+  }
   // Serializing will apply pending deletions. This may greatly alter the
   // ResTable_typeSpec and ResTable_type structures emitted in the resulting
   // file. To do this, forward chunks from the parsed file to ResTableBuilder
@@ -2569,13 +2595,11 @@ void ResourcesArscFile::get_type_names(std::vector<std::string>* type_names) {
 std::unordered_set<uint32_t> ResourcesArscFile::get_types_by_name(
     const std::unordered_set<std::string>& type_names) {
   auto& table_snapshot = get_table_snapshot();
-  std::vector<std::string> all_types;
-  table_snapshot.get_type_names(APPLICATION_PACKAGE, &all_types);
-
   std::unordered_set<uint32_t> type_ids;
-  for (size_t i = 0; i < all_types.size(); ++i) {
-    if (type_names.count(all_types.at(i)) == 1) {
-      type_ids.emplace((i + 1) << TYPE_INDEX_BIT_SHIFT);
+  for (const auto& type_name : type_names) {
+    auto type_id = table_snapshot.get_type_id(APPLICATION_PACKAGE, type_name);
+    if (type_id > 0) {
+      type_ids.emplace((uint32_t)type_id << TYPE_INDEX_BIT_SHIFT);
     }
   }
   return type_ids;
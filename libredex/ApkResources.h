@@ -211,6 +211,9 @@ class TableSnapshot {
   // Given a package id (shifted to low bits) emit the values from the type
   // strings pool.
   void get_type_names(uint32_t package_id, std::vector<std::string>* out);
+  // Given a package id (shifted to low bits) return the type id for the given
+  // type name, or 0 if the package has no such type.
+  uint8_t get_type_id(uint32_t package_id, const std::string& type_name);
   // Fills the output vec with ResTable_config objects for the given type in the
   // package
   void get_configurations(uint32_t package_id,
@@ -244,6 +247,16 @@ class TableSnapshot {
   android::ResStringPool m_global_strings;
   std::map<uint32_t, android::ResStringPool> m_key_strings;
   std::map<uint32_t, android::ResStringPool> m_type_strings;
+
+  struct TypeNameIndex {
+    // Decoded names, in type strings pool order.
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint8_t> name_to_type_id;
+  };
+  // Built on first use, so that name lookups don't need to decode the type
+  // strings pool over and over.
+  const TypeNameIndex& get_type_name_index(uint32_t package_id);
+  std::unordered_map<uint32_t, TypeNameIndex> m_type_name_indices;
 };
 } // namespace apk
 
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Debug.h"
+
+/*
+ * A fixed-size bitmap whose bits can be set concurrently. Setting a bit is a
+ * single atomic or on the containing word, and reports whether this call was
+ * the one that set it, which is all a work-list driven marking phase needs.
+ *
+ * Bits can only be set, not cleared; start over with a new bitmap instead.
+ */
+class AtomicBitmap {
+ public:
+  explicit AtomicBitmap(size_t size)
+      : m_size(size),
+        m_words(std::make_unique<std::atomic<uint64_t>[]>(num_words(size))) {
+    for (size_t i = 0; i < num_words(size); ++i) {
+      m_words[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  size_t size() const { return m_size; }
+
+  // Returns true if the bit was not set before.
+  bool set(size_t i) {
+    redex_assert(i < m_size);
+    uint64_t mask = uint64_t(1) << (i % 64);
+    return (m_words[i / 64].fetch_or(mask, std::memory_order_relaxed) &
+            mask) == 0;
+  }
+
+  bool test(size_t i) const {
+    redex_assert(i < m_size);
+    uint64_t mask = uint64_t(1) << (i % 64);
+    return (m_words[i / 64].load(std::memory_order_relaxed) & mask) != 0;
+  }
+
+  // Not synchronized with concurrent updates.
+  size_t count() const {
+    size_t res = 0;
+    for (size_t i = 0; i < num_words(m_size); ++i) {
+      res += __builtin_popcountll(m_words[i].load(std::memory_order_relaxed));
+    }
+    return res;
+  }
+
+ private:
+  static size_t num_words(size_t size) { return (size + 63) / 64; }
+
+  size_t m_size;
+  std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+};
@@ -14,8 +14,39 @@
 #include "Debug.h"
 #include "WorkQueue.h"
 
-BalancedPartitioning::BalancedPartitioning(std::vector<Document*>& documents)
-    : documents(documents) {
+namespace {
+
+/// Apply fn to every index in [0, size), splitting the range into chunks that
+/// are processed by up to num_threads threads.
+template <typename Fn>
+void parallel_for(uint32_t size,
+                  uint32_t chunk_size,
+                  uint32_t num_threads,
+                  const Fn& fn) {
+  uint32_t num_chunks = (size + chunk_size - 1) / chunk_size;
+  auto run_chunk = [&](uint32_t chunk) {
+    uint32_t end = std::min(size, (chunk + 1) * chunk_size);
+    for (uint32_t i = chunk * chunk_size; i < end; i++) {
+      fn(i);
+    }
+  };
+  if (num_threads <= 1 || num_chunks <= 1) {
+    for (uint32_t chunk = 0; chunk < num_chunks; chunk++) {
+      run_chunk(chunk);
+    }
+    return;
+  }
+  workqueue_run_for<uint32_t>(0, num_chunks, run_chunk,
+                              std::min(num_threads, num_chunks));
+}
+
+} // namespace
+
+BalancedPartitioning::BalancedPartitioning(std::vector<Document*>& documents,
+                                           uint32_t num_threads)
+    : documents(documents),
+      num_threads(num_threads != 0 ? num_threads
+                                   : redex_parallel::default_num_threads()) {
 
   // Pre-computing log2 values
   LOG2_CACHE[0] = 0.0;
@@ -63,9 +94,13 @@ void BalancedPartitioning::run() const {
         // Initialize 2 buckets
         split(work_item.document_begin, work_item.document_end, left_bucket);
 
-        // Do iterations to improve the objective
+        // Do iterations to improve the objective. There are 2^rec_depth
+        // sub-problems at this level, so they share the threads.
+        uint32_t iteration_threads =
+            work_item.rec_depth < 32 ? num_threads >> work_item.rec_depth : 0;
         run_iterations(work_item.document_begin, work_item.document_end,
-                       left_bucket, right_bucket, rng);
+                       left_bucket, right_bucket, rng,
+                       std::max(1u, iteration_threads));
 
         // Split documents wrt the resulting buckets
         auto document_mid =
@@ -86,7 +121,7 @@ void BalancedPartitioning::run() const {
                                            work_item.rec_depth + 1,
                                            right_bucket, mid_offset});
       },
-      redex_parallel::default_num_threads(), /*push_tasks_while_running=*/true);
+      num_threads, /*push_tasks_while_running=*/true);
   wq.add_item((WorkItem){begin(documents), end(documents), 0, 1, 0});
   wq.run_all();
 }
@@ -96,7 +131,8 @@ void BalancedPartitioning::run_iterations(
     const std::vector<Document*>::iterator& document_end,
     uint32_t left_bucket,
     uint32_t right_bucket,
-    std::mt19937& rng) const {
+    std::mt19937& rng,
+    uint32_t num_threads) const {
   // Initialize document adjacencies: renumber kmers and drop obsolete ones
   uint32_t max_kmer = update_documents(document_begin, document_end);
 
@@ -108,7 +144,7 @@ void BalancedPartitioning::run_iterations(
   for (uint32_t iter = 0; iter < ITERATIONS_PER_SPLIT; iter++) {
     uint32_t num_moved_documents =
         run_iteration(document_begin, document_end, left_bucket, right_bucket,
-                      signatures, rng);
+                      signatures, rng, num_threads);
     if (num_moved_documents == 0) break;
   }
 }
@@ -191,28 +227,31 @@ uint32_t BalancedPartitioning::run_iteration(
     uint32_t left_bucket,
     uint32_t right_bucket,
     SignaturesType& signatures,
-    std::mt19937& rng) const {
+    std::mt19937& rng,
+    uint32_t num_threads) const {
   // Initialize signature caches, if needed
-  for (KmerSignature& signature : signatures) {
-    if (signature.cache_is_invalid &&
-        (signature.left_count > 0 || signature.right_count > 0)) {
-      prepare_signature(signature);
-      signature.cache_is_invalid = false;
-    }
-  }
-
-  // Compute move gains
+  parallel_for(signatures.size(), PARALLEL_CHUNK_SIZE, num_threads,
+               [&](uint32_t kmer) {
+                 KmerSignature& signature = signatures[kmer];
+                 if (signature.cache_is_invalid &&
+                     (signature.left_count > 0 || signature.right_count > 0)) {
+                   prepare_signature(signature);
+                   signature.cache_is_invalid = false;
+                 }
+               });
+
+  // Compute move gains; each one only reads the signatures
   uint32_t num_documents =
       uint32_t(std::distance(document_begin, document_end));
   using GainPair = std::pair<double, uint32_t>;
   std::vector<GainPair> gains(num_documents);
-  for (auto it = document_begin; it != document_end; it++) {
-    Document* doc = *it;
-    uint32_t index = it - document_begin;
-    bool from_left_to_right = (doc->bucket == left_bucket);
-    double gain = move_gain(doc, from_left_to_right, signatures);
-    gains[index] = std::make_pair(gain, index);
-  }
+  parallel_for(num_documents, PARALLEL_CHUNK_SIZE, num_threads,
+               [&](uint32_t index) {
+                 const Document* doc = document_begin[index];
+                 bool from_left_to_right = (doc->bucket == left_bucket);
+                 double gain = move_gain(doc, from_left_to_right, signatures);
+                 gains[index] = std::make_pair(gain, index);
+               });
 
   // Collect left and right gains
   auto left_gains = gains.begin();
@@ -326,14 +365,16 @@ double BalancedPartitioning::move_gain(const Document* doc,
                                        bool from_left_to_right,
                                        const SignaturesType& signatures) const {
   double gain = 0;
-  // To avoid an unpredictable branch in the loop, we write two loops separately
+  // To avoid an unpredictable branch in the loop, we write two loops
+  // separately. The k-mers have been renumbered by update_documents, so they
+  // are in range, and we skip the bounds checks in this hot loop.
   if (from_left_to_right) {
     for (uint32_t kmer : doc->adjacent_kmers()) {
-      gain += signatures.at(kmer).cached_cost_lr;
+      gain += signatures[kmer].cached_cost_lr;
     }
   } else {
     for (uint32_t kmer : doc->adjacent_kmers()) {
-      gain += signatures.at(kmer).cached_cost_rl;
+      gain += signatures[kmer].cached_cost_rl;
     }
   }
   return gain;
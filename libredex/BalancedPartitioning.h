@@ -34,7 +34,11 @@ class KmerSignature;
  * N is the number of documents and M is the number of document-kmer edges;
  * (assuming that any collection of D documents contains O(D) k-mers). Notice
  * that the two different recursive sub-problems are independent and thus can
- * be efficiently processed in parallel.
+ * be efficiently processed in parallel. The top levels of the recursion tree
+ * have too few sub-problems to keep the threads busy, so there the gains of
+ * a bisection iteration are computed in parallel as well. Since every gain is
+ * computed independently and ties are broken by document index, the result
+ * doesn't depend on the number of threads.
  */
 class BalancedPartitioning {
   using SignaturesType = std::vector<KmerSignature>;
@@ -44,7 +48,9 @@ class BalancedPartitioning {
   BalancedPartitioning& operator=(const BalancedPartitioning&) = delete;
 
  public:
-  explicit BalancedPartitioning(std::vector<Document*>& documents);
+  /// A num_threads of 0 stands for the default number of threads.
+  explicit BalancedPartitioning(std::vector<Document*>& documents,
+                                uint32_t num_threads = 0);
 
   /// Run recursive graph partitioning that optimizes a given objective.
   void run() const;
@@ -56,7 +62,8 @@ class BalancedPartitioning {
                       const std::vector<Document*>::iterator& document_end,
                       uint32_t left_bucket,
                       uint32_t right_bucket,
-                      std::mt19937& rng) const;
+                      std::mt19937& rng,
+                      uint32_t num_threads) const;
 
   /// Run a bisection iteration to improve the optimization goal.
   /// Returns the total number of moved documents.
@@ -65,7 +72,8 @@ class BalancedPartitioning {
                          uint32_t left_bucket,
                          uint32_t right_bucket,
                          SignaturesType& Signatures,
-                         std::mt19937& rng) const;
+                         std::mt19937& rng,
+                         uint32_t num_threads) const;
 
   /// Try to move a document from one bucket to another.
   /// Return true iff the document is moved.
@@ -128,6 +136,9 @@ class BalancedPartitioning {
   /// Input documents that shall be reordered by the algorithm.
   std::vector<Document*>& documents;
 
+  /// The number of threads available to the algorithm.
+  uint32_t num_threads;
+
   /// Precomputed values of log2(x). Table size is small enough to fit in cache.
   static constexpr uint32_t LOG_CACHE_SIZE = 16384;
   double LOG2_CACHE[LOG_CACHE_SIZE];
@@ -141,6 +152,9 @@ class BalancedPartitioning {
   /// The probability for a vertex to skip a move from its current bucket to
   /// another bucket; it often helps to escape from a local optima.
   static constexpr double SKIP_PROBABILITY = 0.1;
+  /// The number of documents or k-mers a thread processes at once in a
+  /// parallel bisection iteration; smaller ranges are processed sequentially.
+  static constexpr uint32_t PARALLEL_CHUNK_SIZE = 4096;
 };
 
 /**
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "BaseIRAnalyzer.h"
+
+#include "RedexContext.h"
+
+namespace ir_analyzer {
+
+size_t fixpoint_num_threads(const cfg::ControlFlowGraph& cfg) {
+  if (g_redex == nullptr || g_redex->parallel_fixpoint_threads <= 1 ||
+      cfg.num_blocks() < g_redex->parallel_fixpoint_min_blocks) {
+    return 1;
+  }
+  return g_redex->parallel_fixpoint_threads;
+}
+
+} // namespace ir_analyzer
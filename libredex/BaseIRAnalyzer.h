@@ -14,6 +14,15 @@
 
 namespace ir_analyzer {
 
+/*
+ * The thread budget for a fixpoint iteration over `cfg`, to be passed to
+ * `MonotonicFixpointIterator::set_num_threads`. Only analyzers whose transfer
+ * functions are safe to run concurrently should use it. Methods run in
+ * parallel already, so this is about the few giant methods that would
+ * otherwise keep a single thread busy at the end of a parallel walk.
+ */
+size_t fixpoint_num_threads(const cfg::ControlFlowGraph& cfg);
+
 template <typename Domain>
 class BaseIRAnalyzer
     : public sparta::MonotonicFixpointIterator<cfg::GraphInterface, Domain> {
@@ -5,11 +5,18 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#pragma once
+
 #include <boost/bimap/bimap.hpp>
 #include <boost/bimap/unordered_set_of.hpp>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <limits>
 #include <ostream>
+#include <string_view>
 #include <type_traits>
+#include <vector>
 
 #include "Debug.h"
 
@@ -42,6 +49,8 @@ void write_array(std::ostream& os, const Container& container) {
  * Write a simple header. Ideally we should use a single header format across
  * all our binary files.
  */
+constexpr uint32_t GRAPH_INDEX_MAGIC = 0xfaceb0ff;
+
 inline void write_header(std::ostream& os, uint32_t version) {
   uint32_t magic = 0xfaceb000; // serves as endianess check
   write(os, magic);
@@ -55,6 +64,19 @@ inline void write_header(std::ostream& os, uint32_t version) {
  *   <serialized label for node><E1><E2>...<Em>
  *
  * The node on line n has ID n. E1 ... Em are the IDs of its neighbors.
+ *
+ * If requested, an index is appended after the last line so that readers can
+ * map the file and answer queries without deserializing the whole graph:
+ *
+ *   <offset of line 0>...<offset of line N-1>   (uint64, relative to the
+ *                                                 position of the node count)
+ *   <R0><R1>...<RN>                             (uint32, Rn is the start of
+ *                                                 node n's reverse list)
+ *   <reverse edges>                             (uint32 IDs of the nodes that
+ *                                                 list node n as a neighbor)
+ *   <index size in bytes><GRAPH_INDEX_MAGIC>    (uint64, uint32)
+ *
+ * Readers that stop after the N-th line are unaffected by the index.
  */
 template <class Node, class NodeHash = std::hash<Node>>
 class GraphWriter {
@@ -78,15 +100,29 @@ class GraphWriter {
       : m_node_writer(node_writer), m_successors(successors) {}
 
   template <class NodeContainer>
-  void write(std::ostream& os, const NodeContainer& nodes) {
+  void write(std::ostream& os,
+             const NodeContainer& nodes,
+             bool with_index = false) {
     // Give each node a unique ID.
     for (const auto& node : nodes) {
       number_node_recursive(node);
     }
     // Emit the node label and adjacency list.
     uint32_t nodes_count = m_node_ids.size();
+    auto base = os.tellp();
+    always_assert_log(!with_index || base != std::ostream::pos_type(-1),
+                      "Graph index requires a seekable stream");
+    std::vector<uint64_t> offsets;
+    std::vector<std::vector<uint32_t>> preds;
+    if (with_index) {
+      offsets.reserve(nodes_count);
+      preds.resize(nodes_count);
+    }
     binary_serialization::write(os, nodes_count);
     for (uint32_t i = 0; i < nodes_count; ++i) {
+      if (with_index) {
+        offsets.push_back(os.tellp() - base);
+      }
       const auto& node = m_node_ids.template by<Id>().at(i);
       m_node_writer(os, node);
       std::vector<uint32_t> succ_ids;
@@ -94,10 +130,43 @@ class GraphWriter {
         succ_ids.emplace_back(m_node_ids.template by<Node>().at(succ));
       }
       write_array(os, succ_ids);
+      if (with_index) {
+        for (auto succ_id : succ_ids) {
+          preds[succ_id].push_back(i);
+        }
+      }
+    }
+    if (with_index) {
+      write_index(os, offsets, preds);
     }
   }
 
  private:
+  static void write_index(std::ostream& os,
+                          const std::vector<uint64_t>& offsets,
+                          const std::vector<std::vector<uint32_t>>& preds) {
+    auto start = os.tellp();
+    for (auto offset : offsets) {
+      binary_serialization::write(os, offset);
+    }
+    uint64_t edges_count = 0;
+    for (const auto& node_preds : preds) {
+      always_assert(edges_count <= std::numeric_limits<uint32_t>::max());
+      binary_serialization::write<uint32_t>(os, edges_count);
+      edges_count += node_preds.size();
+    }
+    always_assert(edges_count <= std::numeric_limits<uint32_t>::max());
+    binary_serialization::write<uint32_t>(os, edges_count);
+    for (const auto& node_preds : preds) {
+      for (auto pred : node_preds) {
+        binary_serialization::write(os, pred);
+      }
+    }
+    uint64_t index_size = os.tellp() - start;
+    binary_serialization::write(os, index_size);
+    binary_serialization::write(os, GRAPH_INDEX_MAGIC);
+  }
+
   void number_node_recursive(const Node& node) {
     if (m_node_ids.template by<Node>().count(node)) {
       return;
@@ -113,4 +182,180 @@ class GraphWriter {
   SuccessorFunction m_successors;
 };
 
+/*
+ * Versioned, schema-tagged files, which can be read in place, e.g. from a
+ * RedexMappedFile, without deserializing them first:
+ *
+ *   <SCHEMA_FILE_MAGIC><FORMAT_VERSION><schema tag><schema version>
+ *   <values, strings and arrays, in the order the schema defines>
+ *
+ * The magic, format version, schema tag and schema version are uint32 each.
+ * Values are stored in native byte order, aligned to their alignment relative
+ * to the start of the file, with zero padding. Strings are stored as a uint32
+ * length followed by the characters. Arrays are stored as a uint32 element
+ * count followed by the (aligned) elements. The elements of arrays and all
+ * values must be trivially copyable; readers get views into the file for
+ * strings and arrays.
+ *
+ * The schema tag identifies the kind of file, e.g. make_schema_tag("IPRS");
+ * the schema version must be bumped whenever the layout or the meaning of the
+ * contents of that kind of file changes.
+ */
+constexpr uint32_t SCHEMA_FILE_MAGIC = 0xfaceb001;
+constexpr uint32_t SCHEMA_FILE_FORMAT_VERSION = 1;
+// Readers require the file to start at an address with this alignment, which
+// both mapped files and heap allocations satisfy.
+constexpr size_t SCHEMA_FILE_MAX_ALIGNMENT = alignof(uint64_t);
+
+constexpr uint32_t make_schema_tag(const char (&name)[5]) {
+  return uint32_t(uint8_t(name[0])) | uint32_t(uint8_t(name[1])) << 8 |
+         uint32_t(uint8_t(name[2])) << 16 | uint32_t(uint8_t(name[3])) << 24;
+}
+
+class SchemaWriter {
+ public:
+  SchemaWriter(std::ostream& os, uint32_t schema_tag, uint32_t schema_version)
+      : m_os(os) {
+    write<uint32_t>(SCHEMA_FILE_MAGIC);
+    write<uint32_t>(SCHEMA_FILE_FORMAT_VERSION);
+    write<uint32_t>(schema_tag);
+    write<uint32_t>(schema_version);
+  }
+
+  template <class V>
+  void write(const V& value) {
+    static_assert(std::is_trivially_copyable<V>::value);
+    static_assert(alignof(V) <= SCHEMA_FILE_MAX_ALIGNMENT);
+    align(alignof(V));
+    write_bytes(&value, sizeof(V));
+  }
+
+  void write_string(std::string_view str) {
+    write_count(str.size());
+    write_bytes(str.data(), str.size());
+  }
+
+  template <class V>
+  void write_array(const V* data, size_t count) {
+    static_assert(std::is_trivially_copyable<V>::value);
+    static_assert(alignof(V) <= SCHEMA_FILE_MAX_ALIGNMENT);
+    write_count(count);
+    align(alignof(V));
+    write_bytes(data, count * sizeof(V));
+  }
+
+  template <class V>
+  void write_array(const std::vector<V>& vec) {
+    write_array(vec.data(), vec.size());
+  }
+
+  // Number of bytes written so far, including the header.
+  uint64_t size() const { return m_offset; }
+
+ private:
+  void write_count(size_t count) {
+    always_assert(count <= std::numeric_limits<uint32_t>::max());
+    write<uint32_t>(count);
+  }
+
+  void align(size_t alignment) {
+    static const char zeros[SCHEMA_FILE_MAX_ALIGNMENT] = {};
+    write_bytes(zeros, (alignment - m_offset % alignment) % alignment);
+  }
+
+  void write_bytes(const void* data, size_t size) {
+    m_os.write((const char*)data, size);
+    m_offset += size;
+  }
+
+  std::ostream& m_os;
+  uint64_t m_offset{0};
+};
+
+template <class V>
+struct ArrayView {
+  using value_type = V;
+  using const_iterator = const V*;
+
+  const V* first;
+  const V* last;
+
+  const V* begin() const { return first; }
+  const V* end() const { return last; }
+  size_t size() const { return last - first; }
+  bool empty() const { return first == last; }
+  const V& operator[](size_t i) const { return first[i]; }
+};
+
+/*
+ * Reads a file written by SchemaWriter, in the same order. The data must
+ * outlive the reader and all strings and arrays read from it. Reading past the
+ * end of the data is an error.
+ */
+class SchemaReader {
+ public:
+  SchemaReader(const char* data, size_t size) : m_data(data), m_size(size) {
+    always_assert_log((uintptr_t)data % SCHEMA_FILE_MAX_ALIGNMENT == 0,
+                      "Schema file data is not aligned");
+    auto magic = read<uint32_t>();
+    always_assert_log(magic == SCHEMA_FILE_MAGIC,
+                      "Not a schema file, or written with another endianness");
+    m_format_version = read<uint32_t>();
+    m_schema_tag = read<uint32_t>();
+    m_schema_version = read<uint32_t>();
+  }
+
+  /*
+   * Whether the file has the current format, and the given schema tag and
+   * version. Readers of caches typically ignore files for which this is false.
+   */
+  bool has_schema(uint32_t schema_tag, uint32_t schema_version) const {
+    return m_format_version == SCHEMA_FILE_FORMAT_VERSION &&
+           m_schema_tag == schema_tag && m_schema_version == schema_version;
+  }
+
+  uint32_t schema_tag() const { return m_schema_tag; }
+  uint32_t schema_version() const { return m_schema_version; }
+
+  template <class V>
+  V read() {
+    static_assert(std::is_trivially_copyable<V>::value);
+    V value;
+    std::memcpy(&value, take(alignof(V), sizeof(V)), sizeof(V));
+    return value;
+  }
+
+  std::string_view read_string() {
+    auto count = read<uint32_t>();
+    return std::string_view(take(1, count), count);
+  }
+
+  template <class V>
+  ArrayView<V> read_array() {
+    static_assert(std::is_trivially_copyable<V>::value);
+    auto count = read<uint32_t>();
+    auto* data = take(alignof(V), uint64_t(count) * sizeof(V));
+    auto* first = reinterpret_cast<const V*>(data);
+    return ArrayView<V>{first, first + count};
+  }
+
+  bool at_end() const { return m_offset == m_size; }
+
+ private:
+  const char* take(size_t alignment, uint64_t size) {
+    auto offset = m_offset + (alignment - m_offset % alignment) % alignment;
+    always_assert_log(offset <= m_size && size <= m_size - offset,
+                      "Read past the end of schema file data");
+    m_offset = offset + size;
+    return m_data + offset;
+  }
+
+  const char* m_data;
+  uint64_t m_size;
+  uint64_t m_offset{0};
+  uint32_t m_format_version;
+  uint32_t m_schema_tag;
+  uint32_t m_schema_version;
+};
+
 } // namespace binary_serialization
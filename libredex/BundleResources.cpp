@@ -1463,7 +1463,7 @@ void ResourcesPbFile::remap_res_ids_and_serialize(
                   source_entry->set_name(source_name);
                   source_entry->set_allocated_visibility(
                       new aapt::pb::Visibility(
-                          m_res_id_to_entry.at(source_id).visibility()));
+                          m_res_id_to_visibility.at(source_id)));
                   for (const auto& source_cv : source_config_values) {
                     auto new_config_value = source_entry->add_config_value();
                     new_config_value->set_allocated_config(
@@ -1854,7 +1854,10 @@ void ResourcesPbFile::collect_resource_data_for_file(
         // config_value comparison work with different order, reorder repeated
         // fields in config_value's value
         reorder_config_value_repeated_field(&pb_restable);
-        for (const aapt::pb::Package& pb_package : pb_restable.package()) {
+        // Entries and their values are moved out of the parsed table below,
+        // which is dropped at the end of this scope, so that large tables are
+        // not held in memory twice.
+        for (aapt::pb::Package& pb_package : *pb_restable.mutable_package()) {
           auto current_package_id = pb_package.package_id().id();
           if (result == 0) {
             result = current_package_id;
@@ -1867,7 +1870,7 @@ void ResourcesPbFile::collect_resource_data_for_file(
                 current_package_id);
           m_package_id_to_module_name.emplace(
               current_package_id, module_name_from_pb_path(resources_pb_path));
-          for (const aapt::pb::Type& pb_type : pb_package.type()) {
+          for (aapt::pb::Type& pb_type : *pb_package.mutable_type()) {
             empty_package = false;
             auto current_type_id = pb_type.type_id().id();
             const auto& current_type_name = pb_type.name();
@@ -1877,7 +1880,7 @@ void ResourcesPbFile::collect_resource_data_for_file(
                           m_type_id_to_names.at(current_type_id) ==
                               current_type_name);
             m_type_id_to_names[current_type_id] = current_type_name;
-            for (const aapt::pb::Entry& pb_entry : pb_type.entry()) {
+            for (aapt::pb::Entry& pb_entry : *pb_type.mutable_entry()) {
               std::string name_string = pb_entry.name();
               auto current_entry_id = pb_entry.entry_id().id();
               auto current_resource_id = MAKE_RES_ID(
@@ -1889,9 +1892,12 @@ void ResourcesPbFile::collect_resource_data_for_file(
               m_existed_res_ids.emplace(current_resource_id);
               id_to_name.emplace(current_resource_id, name_string);
               name_to_ids[name_string].push_back(current_resource_id);
-              m_res_id_to_entry.emplace(current_resource_id, pb_entry);
-              m_res_id_to_configvalue.emplace(current_resource_id,
-                                              pb_entry.config_value());
+              m_res_id_to_visibility.emplace(
+                  current_resource_id,
+                  std::move(*pb_entry.mutable_visibility()));
+              m_res_id_to_configvalue.emplace(
+                  current_resource_id,
+                  std::move(*pb_entry.mutable_config_value()));
             }
           }
         }
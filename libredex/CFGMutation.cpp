@@ -132,6 +132,7 @@ void CFGMutation::process_block_changes(cfg::Block* block, Changes& changes) {
 void CFGMutation::flush() {
   auto timer_scope = s_timer.scope();
 
+  m_changed_blocks.clear();
   if (m_changes.empty()) {
     return;
   }
@@ -154,8 +155,10 @@ void CFGMutation::flush() {
             [](auto& a, auto& b) { return a.block->id() < b.block->id(); });
 
   Changes remaining_changes;
-  auto next_block_id = m_cfg.get_last_block()->id() + 1;
+  const auto first_new_block_id = m_cfg.get_last_block()->id() + 1;
+  auto next_block_id = first_new_block_id;
   for (auto& [block, changes, slow] : ordered_changes) {
+    m_changed_blocks.push_back(block);
     if (!slow) {
       process_block_changes(block, *changes);
       always_assert(changes->empty());
@@ -181,6 +184,10 @@ void CFGMutation::flush() {
     process_block_changes_slow(block, remaining_changes);
   }
 
+  for (auto id = first_new_block_id; id <= m_cfg.get_last_block()->id(); ++id) {
+    m_changed_blocks.push_back(m_cfg.get_block(id));
+  }
+
   // The effect of one change can erase the anchor for another.  The changes
   // left behind are the ones whose anchors were removed. They will never be
   // applied so clear them.
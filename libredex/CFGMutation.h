@@ -178,6 +178,14 @@ class CFGMutation {
   /// they are added to the mutation.
   void flush();
 
+  /// The blocks that the last flush made changes to, including any blocks it
+  /// created, in id order. Analyses can use this to bring their results up to
+  /// date instead of starting over, see
+  /// \c sparta::MonotonicFixpointIterator::update.
+  const std::vector<cfg::Block*>& changed_blocks() const {
+    return m_changed_blocks;
+  }
+
  private:
   static bool is_terminal(IROpcode op);
 
@@ -278,6 +286,7 @@ class CFGMutation {
 
   cfg::ControlFlowGraph& m_cfg;
   std::unordered_map<cfg::Block*, Changes> m_changes;
+  std::vector<cfg::Block*> m_changed_blocks;
 };
 
 inline CFGMutation::CFGMutation(cfg::ControlFlowGraph& cfg) : m_cfg(cfg) {}
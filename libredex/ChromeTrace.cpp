@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ChromeTrace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "DebugUtils.h"
+#include "Trace.h"
+
+namespace chrome_trace {
+
+namespace impl {
+std::atomic<bool> s_enabled{false};
+} // namespace impl
+
+namespace {
+
+struct Event {
+  std::string name;
+  // Complete events ('X') have a duration, counter events ('C') a value.
+  char phase;
+  const char* category;
+  uint32_t tid;
+  int64_t ts_us;
+  uint64_t dur_us_or_value;
+};
+
+std::mutex s_lock;
+std::vector<Event> s_events;
+std::string s_output_path;
+Clock::time_point s_start;
+
+uint32_t current_tid() {
+  static std::atomic<uint32_t> s_next_tid{0};
+  thread_local uint32_t tid = ++s_next_tid;
+  return tid;
+}
+
+int64_t micros_since_start(Clock::time_point t) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(t - s_start)
+      .count();
+}
+
+void write_escaped(std::ostream& os, const std::string& str) {
+  for (char c : str) {
+    switch (c) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    case '\n':
+      os << "\\n";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        os << ' ';
+      } else {
+        os << c;
+      }
+    }
+  }
+}
+
+} // namespace
+
+void enable(const std::string& output_path) {
+  std::lock_guard<std::mutex> lock(s_lock);
+  s_output_path = output_path;
+  s_start = Clock::now();
+  impl::s_enabled = true;
+}
+
+void add_span(const std::string& name,
+              const char* category,
+              Clock::time_point start,
+              Clock::time_point end) {
+  if (!is_enabled()) {
+    return;
+  }
+  auto tid = current_tid();
+  std::lock_guard<std::mutex> lock(s_lock);
+  auto ts = micros_since_start(start);
+  auto dur = std::max<int64_t>(0, micros_since_start(end) - ts);
+  s_events.push_back(Event{name, 'X', category, tid, ts, (uint64_t)dur});
+}
+
+void add_counter(const char* name, uint64_t value) {
+  if (!is_enabled()) {
+    return;
+  }
+  auto now = Clock::now();
+  std::lock_guard<std::mutex> lock(s_lock);
+  s_events.push_back(
+      Event{name, 'C', "memory", 0, micros_since_start(now), value});
+}
+
+void sample_rss() {
+  if (!is_enabled()) {
+    return;
+  }
+  add_counter("RSS", get_mem_stats().vm_rss);
+}
+
+void write() {
+  if (!is_enabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(s_lock);
+  std::ofstream os(s_output_path);
+  if (!os) {
+    TRACE(MAIN, 0, "Could not open %s to write the chrome trace",
+          s_output_path.c_str());
+    return;
+  }
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& e : s_events) {
+    os << (first ? "\n" : ",\n") << "{\"name\":\"";
+    first = false;
+    write_escaped(os, e.name);
+    os << "\",\"cat\":\"" << e.category << "\",\"ph\":\"" << e.phase
+       << "\",\"pid\":1,\"tid\":" << e.tid << ",\"ts\":" << e.ts_us;
+    if (e.phase == 'X') {
+      os << ",\"dur\":" << e.dur_us_or_value << "}";
+    } else {
+      os << ",\"args\":{\"bytes\":" << e.dur_us_or_value << "}}";
+    }
+  }
+  os << "\n]}\n";
+  TRACE(MAIN, 1, "Wrote %zu chrome trace events to %s", s_events.size(),
+        s_output_path.c_str());
+}
+
+} // namespace chrome_trace
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/*
+ * Records a timeline of spans and counters, which is written out in the Chrome
+ * trace event JSON format, and can be viewed in chrome://tracing or Perfetto.
+ *
+ * Recording is off by default, and all functions are cheap no-ops until
+ * `enable` is called.
+ */
+namespace chrome_trace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+namespace impl {
+extern std::atomic<bool> s_enabled;
+} // namespace impl
+
+// Start recording. The timeline will be written to the given path by `write`.
+void enable(const std::string& output_path);
+
+inline bool is_enabled() {
+  return impl::s_enabled.load(std::memory_order_relaxed);
+}
+
+// Record a span on the current thread. This operation is thread-safe.
+void add_span(const std::string& name,
+              const char* category,
+              Clock::time_point start,
+              Clock::time_point end);
+
+// Record the value of a counter at the current time. This operation is
+// thread-safe.
+void add_counter(const char* name, uint64_t value);
+
+// Record the current resident set size as the "RSS" counter.
+void sample_rss();
+
+// Write all recorded events to the path given to `enable`, if any. There
+// should be no concurrent recording when this function is called.
+void write();
+
+class ScopedSpan final {
+ public:
+  ScopedSpan(std::string name, const char* category)
+      : m_enabled(is_enabled()), m_category(category) {
+    if (m_enabled) {
+      m_name = std::move(name);
+      m_start = Clock::now();
+    }
+  }
+
+  ~ScopedSpan() {
+    if (m_enabled) {
+      add_span(m_name, m_category, m_start, Clock::now());
+    }
+  }
+
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+ private:
+  bool m_enabled;
+  const char* m_category;
+  std::string m_name;
+  Clock::time_point m_start;
+};
+
+} // namespace chrome_trace
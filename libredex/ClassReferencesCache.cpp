@@ -49,6 +49,19 @@ ClassReferencesCache::ClassReferencesCache(
       classes);
 }
 
+void ClassReferencesCache::refresh(const std::vector<DexClass*>& classes) {
+  workqueue_run<DexClass*>(
+      [&](DexClass* cls) {
+        auto* refs = m_cache.get_unsafe(cls);
+        if (refs != nullptr) {
+          *refs = ClassReferences(cls);
+        } else {
+          m_cache.emplace(cls, ClassReferences(cls));
+        }
+      },
+      classes);
+}
+
 const ClassReferences& ClassReferencesCache::get(const DexClass* cls) const {
   return *m_cache
               .get_or_create_and_assert_equal(
@@ -25,11 +25,30 @@ struct ClassReferences {
   std::vector<DexType*> init_types;
 };
 
+/*
+ * Caches the ClassReferences of classes. Entries for classes that were not
+ * given upfront are computed on first use. Entries are not updated when
+ * classes change; whoever changes cached classes must refresh them (or clear
+ * the cache) before the cache is used again.
+ */
 class ClassReferencesCache {
  public:
   explicit ClassReferencesCache(const std::vector<DexClass*>& classes);
   const ClassReferences& get(const DexClass* cls) const;
 
+  /*
+   * Recomputes the entries of the given classes, e.g. because their code
+   * changed. Not thread-safe, and invalidates references returned by get() for
+   * these classes.
+   */
+  void refresh(const std::vector<DexClass*>& classes);
+
+  /*
+   * Drops all entries. Not thread-safe, and invalidates all references
+   * returned by get().
+   */
+  void clear() { m_cache = decltype(m_cache)(); }
+
  private:
   mutable InsertOnlyConcurrentMap<const DexClass*, ClassReferences> m_cache;
 };
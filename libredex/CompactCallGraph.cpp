@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "CompactCallGraph.h"
+
+#include <algorithm>
+
+#include "Timer.h"
+
+namespace call_graph {
+
+CompactGraph::CompactGraph(const Graph& graph)
+    : m_dynamic_methods(graph.get_dynamic_methods()) {
+  Timer t("CompactGraph::CompactGraph");
+
+  // All nodes of a Graph are reachable from its entry.
+  std::vector<NodeId> nodes{graph.entry(), graph.exit()};
+  std::unordered_set<NodeId> visited{graph.entry(), graph.exit()};
+  std::vector<const DexMethod*> methods;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    for (const auto* edge : nodes[i]->callees()) {
+      auto* callee = edge->callee();
+      if (visited.insert(callee).second) {
+        nodes.push_back(callee);
+        methods.push_back(callee->method());
+      }
+    }
+  }
+  std::sort(methods.begin(), methods.end(), compare_dexmethods);
+
+  m_methods.reserve(methods.size() + 2);
+  m_methods.push_back(nullptr);
+  m_methods.push_back(nullptr);
+  m_methods.insert(m_methods.end(), methods.begin(), methods.end());
+  m_node_indices.reserve(methods.size());
+  for (NodeIndex n = 2; n < m_methods.size(); ++n) {
+    m_node_indices.emplace(m_methods[n], n);
+  }
+  auto get_index = [&](NodeId node) -> NodeIndex {
+    if (node->is_entry()) {
+      return ENTRY;
+    }
+    if (node->is_exit()) {
+      return EXIT;
+    }
+    return m_node_indices.at(node->method());
+  };
+
+  std::vector<uint32_t> num_preds(m_methods.size(), 0);
+  m_succ_offsets.reserve(m_methods.size() + 1);
+  m_succ_offsets.push_back(0);
+  for (NodeIndex n = 0; n < m_methods.size(); ++n) {
+    auto node = n == ENTRY  ? graph.entry()
+                : n == EXIT ? graph.exit()
+                            : graph.node(m_methods[n]);
+    for (const auto* edge : node->callees()) {
+      auto callee = get_index(edge->callee());
+      m_edge_callees.push_back(callee);
+      m_edge_callers.push_back(n);
+      m_edge_insns.push_back(edge->invoke_insn());
+      num_preds[callee]++;
+    }
+    m_succ_offsets.push_back(m_edge_callees.size());
+  }
+
+  // Counting sort of the edges by callee; within a callee, edges remain
+  // ordered by caller.
+  m_pred_offsets.reserve(m_methods.size() + 1);
+  m_pred_offsets.push_back(0);
+  for (auto count : num_preds) {
+    m_pred_offsets.push_back(m_pred_offsets.back() + count);
+  }
+  m_pred_edges.resize(m_edge_callees.size());
+  std::vector<uint32_t> next(m_pred_offsets.begin(), m_pred_offsets.end() - 1);
+  for (EdgeIndex e = 0; e < m_edge_callees.size(); ++e) {
+    m_pred_edges[next[m_edge_callees[e]]++] = e;
+  }
+}
+
+} // namespace call_graph
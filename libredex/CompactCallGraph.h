@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "CallGraph.h"
+
+namespace call_graph {
+
+/*
+ * An immutable, compact form of a call_graph::Graph.
+ *
+ * Nodes are numbered densely, with the ghost entry and exit nodes first and
+ * then the methods in dexmethods order. Edges are numbered so that the edges
+ * leaving a node are contiguous, and are stored as parallel arrays of callee
+ * node, caller node and invoke instruction (the call site). The incoming
+ * edges of all nodes are stored back to back in a single array of edge
+ * indices.
+ *
+ * This avoids one heap object per node and per successor list, and the
+ * pointer chasing when iterating. Since it never changes after construction,
+ * a single instance can be shared by all clients of the same BuildStrategy.
+ */
+class CompactGraph {
+ public:
+  using NodeIndex = uint32_t;
+  using EdgeIndex = uint32_t;
+
+  static constexpr NodeIndex ENTRY = 0;
+  static constexpr NodeIndex EXIT = 1;
+
+  struct EdgeRange {
+    class iterator {
+     public:
+      using value_type = EdgeIndex;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const EdgeIndex*;
+      using reference = EdgeIndex;
+      using iterator_category = std::forward_iterator_tag;
+
+      explicit iterator(EdgeIndex current) : m_current(current) {}
+      EdgeIndex operator*() const { return m_current; }
+      iterator& operator++() {
+        ++m_current;
+        return *this;
+      }
+      iterator operator++(int) {
+        auto result = *this;
+        ++m_current;
+        return result;
+      }
+      bool operator==(const iterator& other) const {
+        return m_current == other.m_current;
+      }
+      bool operator!=(const iterator& other) const {
+        return !(*this == other);
+      }
+
+     private:
+      EdgeIndex m_current;
+    };
+
+    EdgeIndex first;
+    EdgeIndex last;
+
+    iterator begin() const { return iterator(first); }
+    iterator end() const { return iterator(last); }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+  };
+
+  struct EdgeIndexSpan {
+    using value_type = EdgeIndex;
+    using const_iterator = const EdgeIndex*;
+
+    const EdgeIndex* first;
+    const EdgeIndex* last;
+
+    const EdgeIndex* begin() const { return first; }
+    const EdgeIndex* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+  };
+
+  explicit CompactGraph(const Graph& graph);
+
+  // Builds the pointer-based graph, and releases it once compacted.
+  explicit CompactGraph(const BuildStrategy& strategy)
+      : CompactGraph(Graph(strategy)) {}
+
+  CompactGraph(CompactGraph&&) = default;
+  CompactGraph& operator=(CompactGraph&&) = default;
+  CompactGraph(const CompactGraph&) = delete;
+  CompactGraph& operator=(const CompactGraph&) = delete;
+
+  size_t num_nodes() const { return m_methods.size(); }
+  size_t num_edges() const { return m_edge_callees.size(); }
+
+  NodeIndex entry() const { return ENTRY; }
+  NodeIndex exit() const { return EXIT; }
+
+  bool has_node(const DexMethod* method) const {
+    return m_node_indices.count(method) != 0;
+  }
+
+  // `nullptr` maps to the entry node, like in Graph::node.
+  NodeIndex node(const DexMethod* method) const {
+    if (method == nullptr) {
+      return ENTRY;
+    }
+    return m_node_indices.at(method);
+  }
+
+  // nullptr for the entry and exit nodes.
+  const DexMethod* method(NodeIndex node) const { return m_methods[node]; }
+
+  EdgeRange callees(NodeIndex node) const {
+    return {m_succ_offsets[node], m_succ_offsets[node + 1]};
+  }
+
+  EdgeIndexSpan callers(NodeIndex node) const {
+    return {m_pred_edges.data() + m_pred_offsets[node],
+            m_pred_edges.data() + m_pred_offsets[node + 1]};
+  }
+
+  NodeIndex caller(EdgeIndex edge) const { return m_edge_callers[edge]; }
+  NodeIndex callee(EdgeIndex edge) const { return m_edge_callees[edge]; }
+  // nullptr for the edges from the entry and to the exit node.
+  IRInstruction* invoke_insn(EdgeIndex edge) const {
+    return m_edge_insns[edge];
+  }
+
+  const std::unordered_set<const DexMethod*>& get_dynamic_methods() const {
+    return m_dynamic_methods;
+  }
+
+ private:
+  std::vector<const DexMethod*> m_methods;
+  std::unordered_map<const DexMethod*, NodeIndex> m_node_indices;
+  // Indexed by node, with one extra entry at the end.
+  std::vector<EdgeIndex> m_succ_offsets;
+  std::vector<uint32_t> m_pred_offsets;
+  // Indexed by edge.
+  std::vector<NodeIndex> m_edge_callees;
+  std::vector<NodeIndex> m_edge_callers;
+  std::vector<IRInstruction*> m_edge_insns;
+  std::vector<EdgeIndex> m_pred_edges;
+  std::unordered_set<const DexMethod*> m_dynamic_methods;
+};
+
+// A static-method-only API for use with the monotonic fixpoint iterator.
+class CompactGraphInterface {
+ public:
+  using Graph = CompactGraph;
+  using NodeId = CompactGraph::NodeIndex;
+  using EdgeId = CompactGraph::EdgeIndex;
+
+  static NodeId entry(const Graph& graph) { return graph.entry(); }
+  static NodeId exit(const Graph& graph) { return graph.exit(); }
+  static CompactGraph::EdgeIndexSpan predecessors(const Graph& graph,
+                                                  const NodeId& n) {
+    return graph.callers(n);
+  }
+  static CompactGraph::EdgeRange successors(const Graph& graph,
+                                            const NodeId& n) {
+    return graph.callees(n);
+  }
+  static NodeId source(const Graph& graph, const EdgeId& e) {
+    return graph.caller(e);
+  }
+  static NodeId target(const Graph& graph, const EdgeId& e) {
+    return graph.callee(e);
+  }
+};
+
+} // namespace call_graph
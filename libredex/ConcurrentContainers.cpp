@@ -7,10 +7,38 @@
 
 #include "ConcurrentContainers.h"
 
+#include <boost/core/demangle.hpp>
+#include <deque>
+
 #include "WorkQueue.h"
 
 namespace cc_impl {
 
+namespace {
+
+std::mutex s_lock_contention_mutex;
+// A deque keeps the registered counters at stable addresses.
+std::deque<LockContention> s_lock_contention;
+
+} // namespace
+
+LockContention* register_lock_contention(const char* mangled_type_name) {
+  std::lock_guard<std::mutex> guard(s_lock_contention_mutex);
+  auto& contention = s_lock_contention.emplace_back();
+  contention.type_name = boost::core::demangle(mangled_type_name);
+  return &contention;
+}
+
+std::vector<std::pair<std::string, uint64_t>> get_lock_contention() {
+  std::lock_guard<std::mutex> guard(s_lock_contention_mutex);
+  std::vector<std::pair<std::string, uint64_t>> res;
+  res.reserve(s_lock_contention.size());
+  for (const auto& contention : s_lock_contention) {
+    res.emplace_back(contention.type_name, contention.count.load());
+  }
+  return res;
+}
+
 bool is_thread_pool_active() {
   return redex_thread_pool::ThreadPool::get_instance() != nullptr;
 }
@@ -15,9 +15,12 @@
 #include <memory>
 #include <mutex>
 #include <stack>
+#include <string>
+#include <typeinfo>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "Debug.h"
 #include "Timer.h"
@@ -49,6 +52,18 @@ class ConcurrentHashtableInsertionResult;
 
 size_t get_prime_number_greater_or_equal_to(size_t);
 
+// Number of slot lock acquisitions in a ConcurrentMap type that had to wait
+// for another thread. Registered on the first contended acquisition.
+struct LockContention {
+  std::string type_name;
+  std::atomic<uint64_t> count{0};
+};
+
+LockContention* register_lock_contention(const char* mangled_type_name);
+
+// Contended acquisitions so far, per demangled ConcurrentMap type.
+std::vector<std::pair<std::string, uint64_t>> get_lock_contention();
+
 /*
  * This ConcurrentHashtable supports inserting (and "emplacing"), getting (the
  * address of inserted key-value pairs), and erasing key-value pairs. There is
@@ -69,7 +84,13 @@ size_t get_prime_number_greater_or_equal_to(size_t);
  * - resizing is O(n) on the current thread, and acquires a table-wide mutex
  *
  * (*) While implemented without locks, there is effectively some spinning on
- * individual buckets when competing operations are in progress on that bucket.
+ * individual buckets when competing insertions and erasures are in progress on
+ * that bucket. Gets never spin and are wait-free: they finish after visiting at
+ * most all storage versions and the node chains in them. This is safe without
+ * hazard pointers or epochs, since memory is never reclaimed while concurrent
+ * operations may be in progress: superseded storage versions and erased nodes
+ * are only released by the NOT thread-safe `compact` (or destruction), which
+ * thus acts as the single quiescent point at which reclamation happens.
  *
  * Resizing is automatically triggered when an insertion causes the table to
  * exceed the (hard-coded) load factor, and then this insertion blocks the
@@ -84,8 +105,12 @@ size_t get_prime_number_greater_or_equal_to(size_t);
  * or `compact` is called. This ensures that get always returns a valid
  * reference, even in the face of concurrent erasing.
  *
- * TODO: Right now, we use the (default) std::memory_order_seq_cst everywhere.
- * Acquire/release semantics should be sufficient.
+ * The read path (`get` and `find`) uses acquire loads, which pair with the
+ * (default) std::memory_order_seq_cst stores and compare-exchanges of the
+ * mutating operations.
+ *
+ * TODO: The mutating operations still use std::memory_order_seq_cst
+ * everywhere. Acquire/release semantics should be sufficient.
  */
 template <typename Key, typename Value, typename Hash, typename KeyEqual>
 class ConcurrentHashtable final {
@@ -165,17 +190,17 @@ class ConcurrentHashtable final {
    */
   iterator find(const key_type& key) {
     auto hash = hasher()(key);
-    auto* storage = m_storage.load();
+    auto* storage = m_storage.load(std::memory_order_acquire);
     auto* ptrs = storage->ptrs;
     size_t i = hash % storage->size;
     auto* root_loc = &ptrs[i];
-    auto* root = root_loc->load();
+    auto* root = root_loc->load(std::memory_order_acquire);
     for (auto* ptr = root; ptr;) {
       auto* node = get_node(ptr);
       if (key_equal()(const_key_projection()(node->value), key)) {
         return iterator(storage, i, node);
       }
-      ptr = node->prev.load();
+      ptr = node->prev.load(std::memory_order_acquire);
     }
     return end();
   }
@@ -186,17 +211,17 @@ class ConcurrentHashtable final {
    */
   const_iterator find(const key_type& key) const {
     auto hash = hasher()(key);
-    auto* storage = m_storage.load();
+    auto* storage = m_storage.load(std::memory_order_acquire);
     auto* ptrs = storage->ptrs;
     size_t i = hash % storage->size;
     auto* root_loc = &ptrs[i];
-    auto* root = root_loc->load();
+    auto* root = root_loc->load(std::memory_order_acquire);
     for (auto* ptr = root; ptr;) {
       auto* node = get_node(ptr);
       if (key_equal()(const_key_projection()(node->value), key)) {
         return const_iterator(storage, i, node);
       }
-      ptr = node->prev.load();
+      ptr = node->prev.load(std::memory_order_acquire);
     }
     return end();
   }
@@ -289,18 +314,18 @@ class ConcurrentHashtable final {
    */
   value_type* get(const key_type& key) {
     auto hash = hasher()(key);
-    auto* storage = m_storage.load();
+    auto* storage = m_storage.load(std::memory_order_acquire);
     do {
       auto* ptrs = storage->ptrs;
       auto* root_loc = &ptrs[hash % storage->size];
-      auto* root = root_loc->load();
+      auto* root = root_loc->load(std::memory_order_acquire);
       for (auto* node = get_node(root); node;
-           node = get_node(node->prev.load())) {
+           node = get_node(node->prev.load(std::memory_order_acquire))) {
         if (key_equal()(const_key_projection()(node->value), key)) {
           return &node->value;
         }
       }
-      storage = storage->next.load();
+      storage = storage->next.load(std::memory_order_acquire);
     } while (storage);
     return nullptr;
   }
@@ -310,18 +335,18 @@ class ConcurrentHashtable final {
    */
   const value_type* get(const key_type& key) const {
     auto hash = hasher()(key);
-    auto* storage = m_storage.load();
+    auto* storage = m_storage.load(std::memory_order_acquire);
     do {
       auto* ptrs = storage->ptrs;
       auto* root_loc = &ptrs[hash % storage->size];
-      auto* root = root_loc->load();
+      auto* root = root_loc->load(std::memory_order_acquire);
       for (auto* node = get_node(root); node;
-           node = get_node(node->prev.load())) {
+           node = get_node(node->prev.load(std::memory_order_acquire))) {
         if (key_equal()(const_key_projection()(node->value), key)) {
           return &node->value;
         }
       }
-      storage = storage->next.load();
+      storage = storage->next.load(std::memory_order_acquire);
     } while (storage);
     return nullptr;
   }
@@ -1219,7 +1244,7 @@ class ConcurrentMap final
     if (ptr == nullptr) {
       throw std::out_of_range("at");
     }
-    std::unique_lock<std::mutex> lock(this->get_lock_by_slot(slot));
+    auto lock = this->lock_slot(slot);
     return ptr->second;
   }
 
@@ -1253,7 +1278,7 @@ class ConcurrentMap final
     if (!ptr) {
       return default_value;
     }
-    std::unique_lock<std::mutex> lock(this->get_lock_by_slot(slot));
+    auto lock = this->lock_slot(slot);
     return ptr->second;
   }
 
@@ -1322,7 +1347,7 @@ class ConcurrentMap final
       return;
     }
     auto* constructed_value = insertion_result.incidentally_constructed_value();
-    std::unique_lock<std::mutex> lock(this->get_lock_by_slot(slot));
+    auto lock = this->lock_slot(slot);
     if (constructed_value) {
       insertion_result.stored_value_ptr->second =
           std::move(constructed_value->second);
@@ -1339,7 +1364,7 @@ class ConcurrentMap final
       return;
     }
     auto* constructed_value = insertion_result.incidentally_constructed_value();
-    std::unique_lock<std::mutex> lock(this->get_lock_by_slot(slot));
+    auto lock = this->lock_slot(slot);
     if (constructed_value) {
       insertion_result.stored_value_ptr->second =
           std::move(constructed_value->second);
@@ -1398,7 +1423,7 @@ class ConcurrentMap final
     if (!ptr) {
       return false;
     }
-    std::unique_lock<std::mutex> lock(this->get_lock_by_slot(slot));
+    auto lock = this->lock_slot(slot);
     observer(ptr->first, ptr->second);
     return true;
   }
@@ -1413,7 +1438,7 @@ class ConcurrentMap final
   void update(const Key& key, UpdateFn updater) {
     size_t slot = Hash()(key) % n_slots;
     auto& map = this->get_container(slot);
-    std::unique_lock<std::mutex> lock(this->get_lock_by_slot(slot));
+    auto lock = this->lock_slot(slot);
     auto insertion_result = map.try_emplace(key);
     auto* ptr = insertion_result.stored_value_ptr;
     updater(ptr->first, ptr->second, !insertion_result.success);
@@ -1424,7 +1449,7 @@ class ConcurrentMap final
   void update(Key&& key, UpdateFn updater) {
     size_t slot = Hash()(key) % n_slots;
     auto& map = this->get_container(slot);
-    std::unique_lock<std::mutex> lock(this->get_lock_by_slot(slot));
+    auto lock = this->lock_slot(slot);
     auto insertion_result = map.try_emplace(std::forward<Key>(key));
     auto* ptr = insertion_result.stored_value_ptr;
     updater(ptr->first, ptr->second, !insertion_result.success);
@@ -1465,7 +1490,16 @@ class ConcurrentMap final
   }
 
  private:
-  std::mutex& get_lock_by_slot(size_t slot) const { return m_locks[slot]; }
+  std::unique_lock<std::mutex> lock_slot(size_t slot) const {
+    std::unique_lock<std::mutex> lock(m_locks[slot], std::try_to_lock);
+    if (!lock.owns_lock()) {
+      static auto* contention =
+          cc_impl::register_lock_contention(typeid(ConcurrentMap).name());
+      contention->count.fetch_add(1, std::memory_order_relaxed);
+      lock.lock();
+    }
+    return lock;
+  }
 
   mutable std::mutex m_locks[n_slots];
 };
@@ -1474,6 +1508,8 @@ class ConcurrentMap final
  * A concurrent container with map semantics that only accepts insertions.
  *
  * This allows accessing constant references on values safely and lock-free.
+ * Lookups are wait-free, even while insertions cause resizing; see
+ * ConcurrentHashtable.
  */
 template <typename Key,
           typename Value,
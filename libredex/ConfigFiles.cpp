@@ -12,6 +12,7 @@
 #include <fstream>
 #include <json/json.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Debug.h"
@@ -20,6 +21,8 @@
 #include "InlinerConfig.h"
 #include "MethodProfiles.h"
 #include "ProguardMap.h"
+#include "RedexMappedFile.h"
+#include "Trace.h"
 
 using namespace std::string_literals;
 
@@ -69,26 +72,38 @@ void from_chars(std::string_view s, int64_t* res) {
 } // namespace
 
 ConfigFiles::ConfigFiles(const Json::Value& config, const std::string& outdir)
-    : m_json(config),
+    : ConfigFiles(Json::Value(config), outdir) {}
+
+ConfigFiles::ConfigFiles(Json::Value&& config, const std::string& outdir)
+    : m_json(std::move(config)),
       outdir(outdir),
       m_global_config(GlobalConfig::default_registry()),
-      m_proguard_map(
-          new ProguardMap(config.get("proguard_map", "").asString(),
-                          config.get("use_new_rename_map", 0).asBool())),
-      m_coldstart_methods_filename(
-          config.get("coldstart_methods_file", "").asString()),
-      m_printseeds(config.get("printseeds", "").asString()),
       m_method_profiles(new method_profiles::MethodProfiles()),
       m_secondary_method_profiles(new method_profiles::MethodProfiles()) {
+  const auto& json = m_json.unwrap();
+  auto proguard_map_path = json.get("proguard_map", "").asString();
+  auto use_new_rename_map = json.get("use_new_rename_map", 0).asBool();
+  if (proguard_map_path.empty()) {
+    m_proguard_map = std::make_unique<ProguardMap>();
+  } else {
+    m_pending_proguard_map =
+        std::async(std::launch::async, [proguard_map_path, use_new_rename_map] {
+          return std::make_unique<ProguardMap>(proguard_map_path,
+                                               use_new_rename_map);
+        });
+  }
+  m_coldstart_methods_filename =
+      json.get("coldstart_methods_file", "").asString();
+  m_printseeds = json.get("printseeds", "").asString();
 
-  m_coldstart_class_filename = config.get("coldstart_classes", "").asString();
+  m_coldstart_class_filename = json.get("coldstart_classes", "").asString();
   if (m_coldstart_class_filename.empty()) {
     m_coldstart_class_filename =
-        config.get("default_coldstart_classes", "").asString();
+        json.get("default_coldstart_classes", "").asString();
   }
 
   uint32_t instruction_size_bitwidth_limit =
-      config.get("instruction_size_bitwidth_limit", 0).asUInt();
+      json.get("instruction_size_bitwidth_limit", 0).asUInt();
   always_assert_log(
       instruction_size_bitwidth_limit < 32,
       "instruction_size_bitwidth_limit must be between 0 and 31, actual: %u\n",
@@ -96,7 +111,7 @@ ConfigFiles::ConfigFiles(const Json::Value& config, const std::string& outdir)
   m_instruction_size_bitwidth_limit = instruction_size_bitwidth_limit;
 
   m_recognize_coldstart_pct_marker =
-      config.get("recognize_betamap_coldstart_pct_marker", false).asBool();
+      json.get("recognize_betamap_coldstart_pct_marker", false).asBool();
 }
 
 ConfigFiles::ConfigFiles(const Json::Value& config) : ConfigFiles(config, "") {}
@@ -153,6 +168,35 @@ const std::unordered_set<DexMethodRef*>& ConfigFiles::get_pure_methods() {
         if (method) m_pure_methods.insert(method);
       }
     }
+    // Summaries of library methods, e.g. generated once per API level, can be
+    // kept in a separate file with one method per line. Lines starting with
+    // '#' are comments.
+    auto pure_methods_file = m_json.get("pure_methods_file", std::string());
+    if (!pure_methods_file.empty()) {
+      auto file = RedexMappedFile::open(pure_methods_file);
+      std::string_view data(file.const_data(), file.size());
+      size_t unresolved = 0;
+      while (!data.empty()) {
+        auto eol = data.find('\n');
+        auto line = data.substr(0, eol);
+        data.remove_prefix(eol == std::string_view::npos ? data.size()
+                                                         : eol + 1);
+        if (!line.empty() && line.back() == '\r') {
+          line.remove_suffix(1);
+        }
+        if (line.empty() || line[0] == '#') {
+          continue;
+        }
+        DexMethodRef* method = DexMethod::get_method(line);
+        if (method) {
+          m_pure_methods.insert(method);
+        } else {
+          ++unresolved;
+        }
+      }
+      TRACE(CSE, 1, "[get_pure_methods]: %zu methods in %s not found",
+            unresolved, pure_methods_file.c_str());
+    }
   }
   return m_pure_methods;
 }
@@ -209,6 +253,7 @@ std::vector<std::string> ConfigFiles::load_coldstart_classes() {
   static constexpr size_t lentail = kClassTail.size();
 
   std::vector<std::string> coldstart_classes;
+  const auto& proguard_map = get_proguard_map();
 
   std::ifstream input(m_coldstart_class_filename);
   if (!input) {
@@ -245,7 +290,7 @@ std::vector<std::string> ConfigFiles::load_coldstart_classes() {
 
     clzname.replace(pos_tail, lentail, ";");
     coldstart_classes.emplace_back(
-        m_proguard_map->translate_class("L" + clzname));
+        proguard_map.translate_class("L" + clzname));
   }
   return coldstart_classes;
 }
@@ -296,12 +341,14 @@ ConfigFiles::load_class_lists() {
       class_lists_filename.c_str(), reader.getFormattedErrorMessages().c_str());
 
   for (Json::ValueIterator it = root.begin(); it != root.end(); ++it) {
-    std::vector<std::string> class_list;
-    Json::Value current_list = *it;
-    for (Json::ValueIterator list_it = current_list.begin();
-         list_it != current_list.end();
-         ++list_it) {
-      lists[it.key().asString()].push_back((*list_it).asString());
+    const Json::Value& current_list = *it;
+    if (current_list.empty()) {
+      continue;
+    }
+    auto& class_list = lists[it.key().asString()];
+    class_list.reserve(class_list.size() + current_list.size());
+    for (const auto& cls : current_list) {
+      class_list.push_back(cls.asString());
     }
   }
 
@@ -347,6 +394,7 @@ void ConfigFiles::build_dead_class_and_live_class_split_lists() {
                 dead_class_list_filename.c_str());
         exit(EXIT_FAILURE);
       }
+      const auto& proguard_map = get_proguard_map();
       for (std::string line; std::getline(input, line);) {
         // trim trailing whitespace
         line.erase(std::find_if(line.rbegin(), line.rend(),
@@ -377,7 +425,7 @@ void ConfigFiles::build_dead_class_and_live_class_split_lists() {
         converted.append(1, ';');
         std::replace(converted.begin(), converted.end(), '.', '/');
         if (!is_relocated) {
-          auto translated = m_proguard_map->translate_class(converted);
+          auto translated = proguard_map.translate_class(converted);
           m_dead_classes.emplace(std::move(translated), load_counts);
         } else {
           // No need to proguard translate the name of the live classes since
@@ -530,6 +578,11 @@ const api::AndroidSDK& ConfigFiles::get_android_sdk_api(int32_t min_sdk_api) {
 }
 
 const ProguardMap& ConfigFiles::get_proguard_map() const {
+  std::lock_guard<std::mutex> lock(m_proguard_map_lock);
+  if (!m_proguard_map) {
+    // Rethrows any parsing failure.
+    m_proguard_map = m_pending_proguard_map.get();
+  }
   return *m_proguard_map;
 }
 
@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -47,6 +49,8 @@ class MethodProfiles;
 struct ConfigFiles {
   explicit ConfigFiles(const Json::Value& config);
   ConfigFiles(const Json::Value& config, const std::string& outdir);
+  // Takes over the config DOM, so that it is not held twice during a run.
+  ConfigFiles(Json::Value&& config, const std::string& outdir);
   ~ConfigFiles();
 
   const std::vector<std::string>& get_coldstart_classes() {
@@ -161,6 +165,8 @@ struct ConfigFiles {
   // For development only!
   void set_outdir(const std::string& new_outdir);
 
+  // The ProGuard map is parsed in the background from construction on, so
+  // that it overlaps with loading the input. This blocks until it is ready.
   const ProguardMap& get_proguard_map() const;
 
   const std::string& get_printseeds() const { return m_printseeds; }
@@ -248,7 +254,9 @@ struct ConfigFiles {
       std::unordered_map<std::string, std::vector<std::string>> l);
 
   bool m_load_class_lists_attempted{false};
-  std::unique_ptr<ProguardMap> m_proguard_map;
+  mutable std::mutex m_proguard_map_lock;
+  mutable std::future<std::unique_ptr<ProguardMap>> m_pending_proguard_map;
+  mutable std::unique_ptr<ProguardMap> m_proguard_map;
   std::string m_coldstart_class_filename;
   std::string m_coldstart_methods_filename;
   std::vector<std::string> m_coldstart_classes;
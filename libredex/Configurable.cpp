@@ -14,10 +14,10 @@
 template <typename T>
 using optional = boost::optional<T>;
 
-#define error_or_warn(error, warn, msg, ...)         \
-  always_assert_log(!(error), msg, ##__VA_ARGS__);   \
-  if (warn) {                                        \
-    fprintf(stderr, "WARNING: " msg, ##__VA_ARGS__); \
+#define error_or_warn(error, warn, msg, ...)                               \
+  always_assert_log(!(error) || s_allow_unresolved, msg, ##__VA_ARGS__);   \
+  if ((warn) && !s_allow_unresolved) {                                     \
+    fprintf(stderr, "WARNING: " msg, ##__VA_ARGS__);                       \
   }
 
 #define ASSERT_NO_BINDFLAGS(type) \
@@ -25,6 +25,9 @@ using optional = boost::optional<T>;
 
 namespace {
 
+// See Configurable::ScopedAllowUnresolved.
+bool s_allow_unresolved{false};
+
 // NOTE: "Leaf" parse functions return an `optional` return type to allow
 //       unified checking of the value in container parsing, without having
 //       to do tricks like SFINAE to have special handling for pointers
@@ -202,6 +205,15 @@ void Configurable::parse_config(const JsonWrapper& json) {
   }
 }
 
+Configurable::ScopedAllowUnresolved::ScopedAllowUnresolved()
+    : m_prev(s_allow_unresolved) {
+  s_allow_unresolved = true;
+}
+
+Configurable::ScopedAllowUnresolved::~ScopedAllowUnresolved() {
+  s_allow_unresolved = m_prev;
+}
+
 Configurable::Reflection Configurable::reflect() {
   Configurable::Reflection cr;
   cr.name = get_config_name();
@@ -223,6 +223,22 @@ class Configurable {
    * time. */
   void parse_config(const JsonWrapper& json);
 
+  /**
+   * While an instance is alive, bindings of Dex elements that fail to resolve
+   * are skipped silently, whatever their bindflags say. This allows parsing a
+   * configuration before (or without) loading any inputs. Not thread safe. */
+  class ScopedAllowUnresolved {
+   public:
+    ScopedAllowUnresolved();
+    ~ScopedAllowUnresolved();
+
+    ScopedAllowUnresolved(const ScopedAllowUnresolved&) = delete;
+    ScopedAllowUnresolved& operator=(const ScopedAllowUnresolved&) = delete;
+
+   private:
+    bool m_prev;
+  };
+
   // Type aliases for convenience
   using MapOfVectorOfStrings =
       std::unordered_map<std::string, std::vector<std::string>>;
@@ -10,6 +10,7 @@
 #include <boost/dynamic_bitset.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 #include <iterator>
+#include <new>
 #include <queue>
 #include <stack>
 #include <utility>
@@ -113,7 +114,10 @@ bool ends_with_may_throw(cfg::Block* p) {
  * - duplicates with the previous position, even across block boundaries
  *   (they will get reconstituted when the cfg is rebuild)
  * - adjacent to an immediately following position, as the last position wins.
- * Parent positions are kept as needed.
+ * Parent positions are kept as needed. Parent pointers are redirected to the
+ * first structurally equal position, so that equal parent chains (as created
+ * by repeatedly inlining the same code) are shared rather than kept once per
+ * inlined copy.
  */
 void remove_redundant_positions(IRList* ir) {
   // We build a set of duplicate positions.
@@ -131,6 +135,31 @@ void remove_redundant_positions(IRList* ir) {
     }
   }
 
+  // Share equal parent chains. Only parents within this list are considered,
+  // as others may be dangling.
+  struct PositionValueHasher {
+    size_t operator()(const DexPosition* pos) const { return hash_value(*pos); }
+  };
+  struct PositionValueEqual {
+    bool operator()(const DexPosition* a, const DexPosition* b) const {
+      return *a == *b;
+    }
+  };
+  std::unordered_map<const DexPosition*, DexPosition*, PositionValueHasher,
+                     PositionValueEqual>
+      canonical_positions;
+  for (auto& mie : *ir) {
+    if (mie.type == MFLOW_POSITION) {
+      canonical_positions.emplace(mie.pos.get(), mie.pos.get());
+    }
+  }
+  for (auto& mie : *ir) {
+    if (mie.type == MFLOW_POSITION && mie.pos->parent != nullptr &&
+        positions_to_remove.count(mie.pos->parent)) {
+      mie.pos->parent = canonical_positions.at(mie.pos->parent);
+    }
+  }
+
   // Backward pass to find positions that are not adjacent to an immediately
   // following position and must be kept (including their parents).
   bool keep_prev = false;
@@ -216,6 +245,157 @@ std::string show_insn(const IRInstruction* insn) { return show(insn); }
 
 } // namespace details
 
+namespace {
+
+// Per thread and object type. Beyond this, freed objects go back to the
+// general-purpose allocator, so that a thread that tore down a huge CFG does
+// not hold on to its memory forever.
+constexpr size_t MAX_POOLED_OBJECTS = 4096;
+// Live byte deltas are published once they grow beyond this.
+constexpr int64_t PUBLISH_THRESHOLD_BYTES = 64 * 1024;
+
+std::atomic<int64_t> s_live_bytes{0};
+std::atomic<int64_t> s_peak_bytes{0};
+
+void publish_live_bytes(int64_t delta) {
+  auto live = s_live_bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+  auto peak = s_peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !s_peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+struct FreeNode {
+  FreeNode* next;
+};
+
+struct FreeList {
+  FreeNode* head;
+  size_t size;
+};
+
+// Trivially destructible, so that it stays usable while (and after) thread
+// locals are torn down; `dead` then routes everything to the plain allocator.
+struct PoolState {
+  FreeList blocks;
+  FreeList edges;
+  int64_t pending_bytes;
+  bool reaper_registered;
+  bool dead;
+};
+
+thread_local PoolState tl_pool;
+
+void release(FreeList& list) {
+  while (list.head != nullptr) {
+    auto* next = list.head->next;
+    ::operator delete(list.head);
+    list.head = next;
+  }
+  list.size = 0;
+}
+
+struct PoolStateReaper {
+  ~PoolStateReaper() {
+    release(tl_pool.blocks);
+    release(tl_pool.edges);
+    publish_live_bytes(tl_pool.pending_bytes);
+    tl_pool.pending_bytes = 0;
+    tl_pool.dead = true;
+  }
+};
+
+// Makes sure the free lists get released when this thread exits.
+void register_reaper() {
+  static thread_local PoolStateReaper reaper;
+  tl_pool.reaper_registered = true;
+}
+
+void account(int64_t delta) {
+  if (tl_pool.dead) {
+    publish_live_bytes(delta);
+    return;
+  }
+  tl_pool.pending_bytes += delta;
+  if (tl_pool.pending_bytes >= PUBLISH_THRESHOLD_BYTES ||
+      tl_pool.pending_bytes <= -PUBLISH_THRESHOLD_BYTES) {
+    publish_live_bytes(tl_pool.pending_bytes);
+    tl_pool.pending_bytes = 0;
+  }
+}
+
+template <FreeList PoolState::*list_member>
+void* pool_allocate(size_t size) {
+  static_assert(sizeof(FreeNode) <= sizeof(Edge), "Edge too small to pool");
+  account(size);
+  if (!tl_pool.dead) {
+    if (!tl_pool.reaper_registered) {
+      register_reaper();
+    }
+    auto& list = tl_pool.*list_member;
+    if (list.head != nullptr) {
+      auto* node = list.head;
+      list.head = node->next;
+      --list.size;
+      return node;
+    }
+  }
+  return ::operator new(size);
+}
+
+template <FreeList PoolState::*list_member>
+void pool_free(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  account(-(int64_t)size);
+  if (!tl_pool.dead) {
+    if (!tl_pool.reaper_registered) {
+      register_reaper();
+    }
+    auto& list = tl_pool.*list_member;
+    if (list.size < MAX_POOLED_OBJECTS) {
+      list.head = new (ptr) FreeNode{list.head};
+      ++list.size;
+      return;
+    }
+  }
+  ::operator delete(ptr);
+}
+
+} // namespace
+
+int64_t live_memory_bytes() {
+  return s_live_bytes.load(std::memory_order_relaxed);
+}
+
+int64_t peak_memory_bytes() {
+  return s_peak_bytes.load(std::memory_order_relaxed);
+}
+
+void reset_peak_memory_bytes() {
+  s_peak_bytes.store(s_live_bytes.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+}
+
+void* Edge::operator new(size_t size) {
+  always_assert(size == sizeof(Edge));
+  return pool_allocate<&PoolState::edges>(size);
+}
+
+void Edge::operator delete(void* ptr, size_t size) {
+  pool_free<&PoolState::edges>(ptr, size);
+}
+
+void* Block::operator new(size_t size) {
+  always_assert(size == sizeof(Block));
+  return pool_allocate<&PoolState::blocks>(size);
+}
+
+void Block::operator delete(void* ptr, size_t size) {
+  pool_free<&PoolState::blocks>(ptr, size);
+}
+
 void Block::free() {
   for (auto& mie : *this) {
     switch (mie.type) {
@@ -797,10 +977,18 @@ ControlFlowGraph::ControlFlowGraph(IRList* ir,
   find_block_boundaries(ir, branch_to_targets, try_ends, try_catches);
 
   connect_blocks(branch_to_targets);
-  add_catch_edges(try_ends, try_catches);
+  // Most methods have no try regions. Their blocks are only split at
+  // branches, returns and throws, and they get no throw edges, so there is no
+  // catch bookkeeping to do for them.
+  bool has_try_catch = !try_ends.empty() || !try_catches.empty();
+  if (has_try_catch) {
+    add_catch_edges(try_ends, try_catches);
+  }
 
   if (m_editable) {
-    remove_try_catch_markers();
+    if (has_try_catch) {
+      remove_try_catch_markers();
+    }
 
     // Often, the `registers_size` parameter passed into this constructor is
     // incorrect. We recompute here to safeguard against this.
@@ -2034,6 +2222,121 @@ std::vector<Block*> ControlFlowGraph::wto_chains(
   return main_order;
 }
 
+namespace {
+
+// The hits of a block, summed over all interactions, as the maximum over its
+// source blocks; none if it has no source blocks with profile values.
+boost::optional<float> get_block_hits(const Block* b) {
+  boost::optional<float> res;
+  source_blocks::foreach_source_block(b, [&res](const auto* sb) {
+    boost::optional<float> hits;
+    sb->foreach_val([&hits](const auto& val) {
+      if (val) {
+        hits = hits.value_or(0) + val->val;
+      }
+    });
+    if (hits && (!res || *res < *hits)) {
+      res = hits;
+    }
+  });
+  return res;
+}
+
+} // namespace
+
+std::vector<Block*> ProfileGuidedLinearizationStrategy::order(
+    cfg::ControlFlowGraph& cfg,
+    sparta::WeakTopologicalOrdering<BlockChain*> wto) {
+  // Chains only need to stay together where a block starts with a
+  // move-result; the other goto edges within them were merely chained to
+  // save gotos, and are reconsidered below.
+  std::vector<std::unique_ptr<BlockChain>> owned_chains;
+  std::vector<BlockChain*> chains;
+  wto.visit_depth_first([&](BlockChain* wto_chain) {
+    for (auto* b : *wto_chain) {
+      if (chains.empty() || b == wto_chain->front() ||
+          !b->starts_with_move_result()) {
+        owned_chains.push_back(std::make_unique<BlockChain>());
+        chains.push_back(owned_chains.back().get());
+      }
+      chains.back()->push_back(b);
+    }
+  });
+
+  std::unordered_map<const Block*, boost::optional<float>> hits;
+  std::unordered_map<const Block*, BlockChain*> chain_heads;
+  std::unordered_set<const BlockChain*> cold_chains;
+  for (auto* chain : chains) {
+    chain_heads.emplace(chain->front(), chain);
+    // The entry chain must stay first.
+    bool cold = chain != chains.front();
+    for (auto* b : *chain) {
+      auto block_hits = get_block_hits(b);
+      hits.emplace(b, block_hits);
+      cold = cold && block_hits && *block_hits <= 0;
+    }
+    if (cold) {
+      cold_chains.insert(chain);
+    }
+  }
+
+  std::unordered_set<const BlockChain*> placed;
+  auto placeable_chain = [&](const Block* b) -> BlockChain* {
+    auto it = chain_heads.find(b);
+    if (it == chain_heads.end() || placed.count(it->second) ||
+        cold_chains.count(it->second)) {
+      return nullptr;
+    }
+    return it->second;
+  };
+  // The chain to place right after the given one, if any.
+  auto get_fallthrough_chain = [&](const BlockChain* chain) -> BlockChain* {
+    auto* tail = chain->back();
+    auto* goto_edge = cfg.get_succ_edge_of_type(tail, EDGE_GOTO);
+    if (goto_edge == nullptr) {
+      return nullptr;
+    }
+    auto* branch_edge = cfg.get_succ_edge_of_type(tail, EDGE_BRANCH);
+    auto last_it = tail->get_last_insn();
+    if (branch_edge != nullptr && last_it != tail->end() &&
+        opcode::is_a_conditional_branch(last_it->insn->opcode())) {
+      auto* goto_target = goto_edge->target();
+      auto* branch_target = branch_edge->target();
+      const auto& goto_hits = hits.at(goto_target);
+      const auto& branch_hits = hits.at(branch_target);
+      if (goto_target != branch_target && goto_hits && branch_hits &&
+          *branch_hits > *goto_hits && placeable_chain(branch_target)) {
+        auto* insn = last_it->insn;
+        insn->set_opcode(opcode::invert_conditional_branch(insn->opcode()));
+        cfg.set_edge_target(branch_edge, goto_target);
+        cfg.set_edge_target(goto_edge, branch_target);
+      }
+    }
+    return placeable_chain(goto_edge->target());
+  };
+
+  std::vector<Block*> result;
+  result.reserve(cfg.num_blocks());
+  auto place = [&](BlockChain* chain) {
+    placed.insert(chain);
+    result.insert(result.end(), chain->begin(), chain->end());
+  };
+  for (auto* chain : chains) {
+    if (placed.count(chain) || cold_chains.count(chain)) {
+      continue;
+    }
+    for (auto* c = chain; c != nullptr; c = get_fallthrough_chain(c)) {
+      place(c);
+    }
+  }
+  for (auto* chain : chains) {
+    if (!placed.count(chain)) {
+      place(chain);
+    }
+  }
+  return result;
+}
+
 // Add an MFLOW_TARGET at the end of each edge.
 // Insert GOTOs where necessary.
 void ControlFlowGraph::insert_branches_and_targets(
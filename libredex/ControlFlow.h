@@ -110,6 +110,21 @@ std::string show_insn(const IRInstruction* insn);
 
 } // namespace details
 
+/*
+ * Blocks and Edges are small, and every build_cfg / clear_cfg creates and
+ * destroys thousands of them. Their class-level operator new and delete keep
+ * freed objects on a per-thread free list and hand them out again, instead of
+ * going through the general-purpose allocator every time.
+ *
+ * The pool also accounts for the bytes held by live Blocks and Edges (the
+ * objects themselves, not the instructions they own). Counts are batched per
+ * thread, so the values are approximate while parallel walks are running.
+ */
+int64_t live_memory_bytes();
+int64_t peak_memory_bytes();
+// Restarts peak tracking from the current live value.
+void reset_peak_memory_bytes();
+
 struct ThrowInfo {
   // nullptr means catch all
   DexType* catch_type;
@@ -181,6 +196,9 @@ class Edge final {
     }
   }
 
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   bool operator==(const Edge& that) const {
     return m_src == that.m_src && m_target == that.m_target &&
            equals_ignore_source_and_target(that);
@@ -263,6 +281,9 @@ class Block final {
   // copy constructor
   Block(const Block& b, MethodItemEntryCloner* cloner);
 
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   BlockId id() const { return m_id; }
   ControlFlowGraph& cfg() const {
     always_assert(m_parent != nullptr);
@@ -480,6 +501,21 @@ struct LinearizationStrategy {
       sparta::WeakTopologicalOrdering<BlockChain*> wto) = 0;
 };
 
+/*
+ * Places blocks by the hit counts of their source blocks, in the spirit of
+ * Pettis-Hansen: each block is directly followed by the block its goto edge
+ * leads to, after inverting a conditional branch whose target is hotter than
+ * its fallthrough, so that hot paths fall through. Blocks whose source blocks
+ * were never hit go to the end of the method. Blocks are otherwise kept in
+ * WTO order, and blocks starting with a move-result stay with their
+ * predecessor. Without profile data, the result is the default order.
+ */
+struct ProfileGuidedLinearizationStrategy : public LinearizationStrategy {
+  std::vector<Block*> order(
+      cfg::ControlFlowGraph& cfg,
+      sparta::WeakTopologicalOrdering<BlockChain*> wto) override;
+};
+
 class ControlFlowGraph {
 
  public:
@@ -277,11 +277,56 @@ std::string to_string(const DexAssessment& assessment) {
 }
 
 DexAssessment DexScopeAssessor::run() {
-  // This struct combines all individual assessment implementations.
+  // This struct combines all individual assessment implementations, and the
+  // plain statistics, so that everything is gathered in a single parallel
+  // walk over the scope.
   struct Assessment {
     dex_position::Assessment dex_position_assessment;
+
+    size_t classes_without_deobfuscated_name{0};
+    size_t classes_with_annotations{0};
+    size_t classes_sum_annotations{0};
+
+    size_t fields_without_deobfuscated_name{0};
+    size_t num_fields{0};
+    size_t fields_with_annotations{0};
+    size_t fields_sum_annotations{0};
+
+    size_t methods_without_deobfuscated_name{0};
+    size_t num_methods{0};
+    size_t methods_with_code{0};
+    size_t huge_methods{0};
+    size_t num_instructions{0};
+    size_t sum_opcodes{0};
+    size_t code_units{0};
+    size_t methods_with_annotations{0};
+    size_t methods_sum_annotations{0};
+    size_t methods_with_param_annotations{0};
+    size_t methods_sum_param_annotations{0};
+
     Assessment& operator+=(const Assessment& other) {
       dex_position_assessment += other.dex_position_assessment;
+      classes_without_deobfuscated_name +=
+          other.classes_without_deobfuscated_name;
+      classes_with_annotations += other.classes_with_annotations;
+      classes_sum_annotations += other.classes_sum_annotations;
+      fields_without_deobfuscated_name +=
+          other.fields_without_deobfuscated_name;
+      num_fields += other.num_fields;
+      fields_with_annotations += other.fields_with_annotations;
+      fields_sum_annotations += other.fields_sum_annotations;
+      methods_without_deobfuscated_name +=
+          other.methods_without_deobfuscated_name;
+      num_methods += other.num_methods;
+      methods_with_code += other.methods_with_code;
+      huge_methods += other.huge_methods;
+      num_instructions += other.num_instructions;
+      sum_opcodes += other.sum_opcodes;
+      code_units += other.code_units;
+      methods_with_annotations += other.methods_with_annotations;
+      methods_sum_annotations += other.methods_sum_annotations;
+      methods_with_param_annotations += other.methods_with_param_annotations;
+      methods_sum_param_annotations += other.methods_sum_param_annotations;
       return *this;
     }
     bool has_problems() { return dex_position_assessment.has_problems(); }
@@ -290,172 +335,137 @@ DexAssessment DexScopeAssessor::run() {
     }
   };
 
-  struct ClassStats {
-    std::atomic<size_t> classes_without_deobfuscated_name{0};
-    std::atomic<size_t> with_annotations{0};
-    std::atomic<size_t> sum_annotations{0};
-  };
-  ClassStats class_stats{};
-  walk::parallel::classes(m_scope, [&class_stats](DexClass* c) {
-    if (c->get_deobfuscated_name_or_null() == nullptr) {
-      class_stats.classes_without_deobfuscated_name.fetch_add(1);
-    }
-    auto* aset = c->get_anno_set();
-    if (aset != nullptr && aset->size() > 0) {
-      class_stats.with_annotations.fetch_add(1, std::memory_order_relaxed);
-      class_stats.sum_annotations.fetch_add(aset->size(),
-                                            std::memory_order_relaxed);
-    }
-  });
+  dex_position::Assessor dex_position_assessor;
 
-  struct FieldStats {
-    std::atomic<size_t> fields_without_deobfuscated_name{0};
-    std::atomic<size_t> num_fields{0};
-    std::atomic<size_t> with_annotations{0};
-    std::atomic<size_t> sum_annotations{0};
-  };
-  FieldStats field_stats{};
-  walk::parallel::fields(m_scope, [&field_stats](DexField* f) {
-    field_stats.num_fields.fetch_add(1, std::memory_order_relaxed);
-    auto* aset = f->get_anno_set();
-    if (aset != nullptr && aset->size() > 0) {
-      field_stats.with_annotations.fetch_add(1, std::memory_order_relaxed);
-      field_stats.sum_annotations.fetch_add(aset->size(),
-                                            std::memory_order_relaxed);
-    }
-    if (f->get_deobfuscated_name().empty()) {
-      field_stats.fields_without_deobfuscated_name.fetch_add(1);
-    }
-  });
-
-  struct MethodStats {
-    std::atomic<size_t> methods_without_deobfuscated_name{0};
-    std::atomic<size_t> num_methods{0};
-    std::atomic<size_t> methods_with_code{0};
-    std::atomic<size_t> huge_methods{0};
-    std::atomic<size_t> num_instructions{0};
-    std::atomic<size_t> sum_opcodes{0};
-    std::atomic<size_t> code_units{0};
-    std::atomic<size_t> with_annotations{0};
-    std::atomic<size_t> sum_annotations{0};
-    std::atomic<size_t> with_param_annotations{0};
-    std::atomic<size_t> sum_param_annotations{0};
-  };
-  MethodStats method_stats{};
-  walk::parallel::methods(m_scope, [&method_stats](auto* m) {
-    method_stats.num_methods.fetch_add(1, std::memory_order_relaxed);
+  auto analyze_method = [&dex_position_assessor](DexMethod* method,
+                                                 Assessment* assessment) {
+    assessment->num_methods++;
     {
-      auto* aset = m->get_anno_set();
+      auto* aset = method->get_anno_set();
       if (aset != nullptr && aset->size() > 0) {
-        method_stats.with_annotations.fetch_add(1, std::memory_order_relaxed);
-        method_stats.sum_annotations.fetch_add(aset->size(),
-                                               std::memory_order_relaxed);
+        assessment->methods_with_annotations++;
+        assessment->methods_sum_annotations += aset->size();
       }
     }
     {
-      auto* panno = m->get_param_anno();
+      auto* panno = method->get_param_anno();
       if (panno != nullptr && !panno->empty()) {
-        method_stats.with_param_annotations.fetch_add(
-            1, std::memory_order_relaxed);
-        method_stats.sum_param_annotations.fetch_add(panno->size(),
-                                                     std::memory_order_relaxed);
+        assessment->methods_with_param_annotations++;
+        assessment->methods_sum_param_annotations += panno->size();
       }
     }
 
-    if (m->get_deobfuscated_name_or_null() == nullptr) {
-      method_stats.methods_without_deobfuscated_name.fetch_add(1);
+    if (method->get_deobfuscated_name_or_null() == nullptr) {
+      assessment->methods_without_deobfuscated_name++;
     }
 
-    auto code = m->get_code();
+    auto code = method->get_code();
     if (code == nullptr) {
       return;
     }
-    method_stats.methods_with_code.fetch_add(1, std::memory_order_relaxed);
-    method_stats.num_instructions.fetch_add(code->count_opcodes(),
-                                            std::memory_order_relaxed);
+    assessment->methods_with_code++;
+    assessment->num_instructions += code->count_opcodes();
     auto sum_opcode_sizes = code->sum_opcode_sizes();
     if (code->editable_cfg_built()) {
       sum_opcode_sizes += code->cfg().get_size_adjustment();
     }
-    method_stats.sum_opcodes.fetch_add(sum_opcode_sizes,
-                                       std::memory_order_relaxed);
+    assessment->sum_opcodes += sum_opcode_sizes;
     auto code_units = code->estimate_code_units();
     if (code->editable_cfg_built()) {
       code_units += code->cfg().get_size_adjustment();
     }
-    method_stats.code_units.fetch_add(code_units, std::memory_order_relaxed);
+    assessment->code_units += code_units;
     if (code_units > 9000) {
       // Why 9000? Because that's the default cut-off for SplitHugeSwitchPass to
       // start splitting.
-      method_stats.huge_methods.fetch_add(1, std::memory_order_relaxed);
+      assessment->huge_methods++;
     }
-  });
 
-  dex_position::Assessor dex_position_assessor;
+    code->build_cfg(/*editable*/ true, /*fresh_editable_build*/ false);
 
-  auto combined_assessment = walk::parallel::methods<Assessment>(
-      m_scope, [&dex_position_assessor](DexMethod* method) {
-        Assessment assessment;
+    auto dex_position_assessment =
+        dex_position_assessor.analyze_method(method, code->cfg());
 
-        auto code = method->get_code();
-        if (!code) {
-          return assessment;
+    if (traceEnabled(ASSESSOR, 2) && dex_position_assessment.has_problems()) {
+      if (traceEnabled(ASSESSOR, 3)) {
+        TRACE(ASSESSOR,
+              3,
+              "[scope assessor] %s: %s\n%s",
+              SHOW(method),
+              to_string(dex_position_assessment.to_dex_assessment()).c_str(),
+              SHOW(code->cfg()));
+      } else {
+        TRACE(ASSESSOR,
+              2,
+              "[scope assessor] %s: %s",
+              SHOW(method),
+              to_string(dex_position_assessment.to_dex_assessment()).c_str());
+      }
+    }
+    assessment->dex_position_assessment += dex_position_assessment;
+  };
+
+  auto combined_assessment = walk::parallel::classes<Assessment>(
+      m_scope, [&analyze_method](DexClass* cls) {
+        Assessment assessment;
+        if (cls->get_deobfuscated_name_or_null() == nullptr) {
+          assessment.classes_without_deobfuscated_name++;
+        }
+        auto* aset = cls->get_anno_set();
+        if (aset != nullptr && aset->size() > 0) {
+          assessment.classes_with_annotations++;
+          assessment.classes_sum_annotations += aset->size();
         }
 
-        code->build_cfg(/*editable*/ true, /*fresh_editable_build*/ false);
-
-        assessment.dex_position_assessment =
-            dex_position_assessor.analyze_method(method, code->cfg());
-
-        if (traceEnabled(ASSESSOR, 2) && assessment.has_problems()) {
-          if (traceEnabled(ASSESSOR, 3)) {
-            TRACE(ASSESSOR,
-                  3,
-                  "[scope assessor] %s: %s\n%s",
-                  SHOW(method),
-                  to_string(assessment.to_dex_assessment()).c_str(),
-                  SHOW(code->cfg()));
-          } else {
-            TRACE(ASSESSOR,
-                  2,
-                  "[scope assessor] %s: %s",
-                  SHOW(method),
-                  to_string(assessment.to_dex_assessment()).c_str());
+        for (auto* f : cls->get_all_fields()) {
+          assessment.num_fields++;
+          auto* field_aset = f->get_anno_set();
+          if (field_aset != nullptr && field_aset->size() > 0) {
+            assessment.fields_with_annotations++;
+            assessment.fields_sum_annotations += field_aset->size();
+          }
+          if (f->get_deobfuscated_name().empty()) {
+            assessment.fields_without_deobfuscated_name++;
           }
         }
 
+        for (auto* method : cls->get_all_methods()) {
+          analyze_method(method, &assessment);
+        }
         return assessment;
       });
 
   auto res = combined_assessment.to_dex_assessment();
   res["without_deobfuscated_names.methods"] =
-      method_stats.methods_without_deobfuscated_name.load();
+      combined_assessment.methods_without_deobfuscated_name;
   res["without_deobfuscated_names.fields"] =
-      field_stats.fields_without_deobfuscated_name.load();
+      combined_assessment.fields_without_deobfuscated_name;
   res["without_deobfuscated_names.classes"] =
-      class_stats.classes_without_deobfuscated_name.load();
+      combined_assessment.classes_without_deobfuscated_name;
 
   res["num_classes"] = m_scope.size();
-  res["num_methods"] = method_stats.num_methods.load();
-  res["num_fields"] = field_stats.num_fields.load();
-  res["methods~with~code"] = method_stats.methods_with_code.load();
-  res["huge~methods"] = method_stats.huge_methods.load();
-  res["num_instructions"] = method_stats.num_instructions.load();
-  res["sum_opcodes"] = method_stats.sum_opcodes.load();
-  res["code_units"] = method_stats.code_units.load();
-
-  res["methods.with_annotations"] = method_stats.with_annotations.load();
-  res["methods.sum_annotations"] = method_stats.sum_annotations.load();
+  res["num_methods"] = combined_assessment.num_methods;
+  res["num_fields"] = combined_assessment.num_fields;
+  res["methods~with~code"] = combined_assessment.methods_with_code;
+  res["huge~methods"] = combined_assessment.huge_methods;
+  res["num_instructions"] = combined_assessment.num_instructions;
+  res["sum_opcodes"] = combined_assessment.sum_opcodes;
+  res["code_units"] = combined_assessment.code_units;
+
+  res["methods.with_annotations"] =
+      combined_assessment.methods_with_annotations;
+  res["methods.sum_annotations"] = combined_assessment.methods_sum_annotations;
   res["methods.with_param_annotations"] =
-      method_stats.with_param_annotations.load();
+      combined_assessment.methods_with_param_annotations;
   res["methods.sum_param_annotations"] =
-      method_stats.sum_param_annotations.load();
+      combined_assessment.methods_sum_param_annotations;
 
-  res["fields.with_annotations"] = field_stats.with_annotations.load();
-  res["fields.sum_annotations"] = field_stats.sum_annotations.load();
+  res["fields.with_annotations"] = combined_assessment.fields_with_annotations;
+  res["fields.sum_annotations"] = combined_assessment.fields_sum_annotations;
 
-  res["classes.with_annotations"] = class_stats.with_annotations.load();
-  res["classes.sum_annotations"] = class_stats.sum_annotations.load();
+  res["classes.with_annotations"] =
+      combined_assessment.classes_with_annotations;
+  res["classes.sum_annotations"] = combined_assessment.classes_sum_annotations;
 
   if (combined_assessment.has_problems()) {
     TRACE(ASSESSOR, 1, "[scope assessor] %s", to_string(res).c_str());
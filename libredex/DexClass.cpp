@@ -29,6 +29,7 @@
 #include "Warning.h"
 
 #include <algorithm>
+#include <array>
 #include <boost/functional/hash.hpp>
 #include <boost/optional.hpp>
 #include <memory>
@@ -135,7 +136,7 @@ const DexString* DexString::get_string(std::string_view s) {
 }
 
 int32_t DexString::java_hashcode() const {
-  return java_hashcode_of_utf8_string(c_str());
+  return java_hashcode_of_utf8_string(c_str(), size());
 }
 
 int DexTypeList::encode(DexOutputIdx* dodx, uint32_t* output) const {
@@ -364,6 +365,8 @@ static std::vector<DexDebugEntry> eval_debug_instructions(
   // resize overhead.
   constexpr size_t kReserveSize = 10000;
   entries.reserve(kReserveSize);
+  bool lines_only = g_redex->debug_info_loading ==
+                    RedexContext::DebugInfoLoading::kLinesOnly;
 
   uint32_t pc = 0;
   while (true) {
@@ -382,10 +385,16 @@ static std::vector<DexDebugEntry> eval_debug_instructions(
     case DBG_RESTART_LOCAL:
     case DBG_START_LOCAL:
     case DBG_START_LOCAL_EXTENDED:
-    case DBG_SET_FILE:
-    case DBG_END_SEQUENCE:
     case DBG_SET_PROLOGUE_END:
     case DBG_SET_EPILOGUE_BEGIN: {
+      if (lines_only) {
+        continue;
+      }
+      entries.emplace_back(pc, std::move(opcode));
+      break;
+    }
+    case DBG_SET_FILE:
+    case DBG_END_SEQUENCE: {
       entries.emplace_back(pc, std::move(opcode));
       break;
     }
@@ -686,7 +695,9 @@ std::unique_ptr<DexCode> DexCode::get_dex_code(DexIdx* idx, uint32_t offset) {
       dc->m_tries.emplace_back(dextry);
     }
   }
-  dc->m_dbg = DexDebugItem::get_dex_debug(idx, code->debug_info_off);
+  if (g_redex->debug_info_loading != RedexContext::DebugInfoLoading::kNone) {
+    dc->m_dbg = DexDebugItem::get_dex_debug(idx, code->debug_info_off);
+  }
   return dc;
 }
 
@@ -775,16 +786,43 @@ std::string DexMethod::get_fully_deobfuscated_name() const {
 }
 
 void DexMethod::set_code(std::unique_ptr<IRCode> code) {
+  materialize_code();
   m_code = std::move(code);
 }
 
 void DexMethod::balloon() {
+  if (m_lazy_code.load(std::memory_order_acquire)) {
+    materialize_lazy_code();
+    return;
+  }
+  redex_assert(m_code == nullptr);
+  m_code = std::make_unique<IRCode>(this);
+  m_dex_code.reset();
+}
+
+void DexMethod::balloon_lazily() {
   redex_assert(m_code == nullptr);
+  if (m_dex_code != nullptr) {
+    m_lazy_code.store(true, std::memory_order_release);
+  }
+}
+
+void DexMethod::materialize_lazy_code() {
+  // Different threads may ask for the code of the same method, e.g. for an
+  // inlining callee. Lock stripes keep this cheap without growing DexMethod.
+  static std::array<std::mutex, 64> s_locks;
+  std::lock_guard<std::mutex> lock(
+      s_locks[std::hash<const DexMethod*>()(this) % s_locks.size()]);
+  if (!m_lazy_code.load(std::memory_order_relaxed)) {
+    return;
+  }
   m_code = std::make_unique<IRCode>(this);
   m_dex_code.reset();
+  m_lazy_code.store(false, std::memory_order_release);
 }
 
 void DexMethod::sync() {
+  materialize_code();
   redex_assert(m_dex_code == nullptr);
   m_dex_code = m_code->sync(this);
   m_code.reset();
@@ -862,10 +900,21 @@ DexMethod* DexMethod::make_full_method_from(DexMethod* that,
 DexMethodRef* DexMethod::get_method(
     const dex_member_refs::MethodDescriptorTokens& mdt) {
   auto cls = DexType::get_type(mdt.cls);
+  if (cls == nullptr) {
+    return nullptr;
+  }
   auto name = DexString::get_string(mdt.name);
+  if (name == nullptr) {
+    return nullptr;
+  }
   DexTypeList::ContainerType args;
+  args.reserve(mdt.args.size());
   for (auto& arg_str : mdt.args) {
-    args.push_back(DexType::get_type(arg_str));
+    auto arg = DexType::get_type(arg_str);
+    if (arg == nullptr) {
+      return nullptr;
+    }
+    args.push_back(arg);
   }
   auto dtl = DexTypeList::get_type_list(args);
   if (dtl == nullptr) {
@@ -878,8 +927,68 @@ DexMethodRef* DexMethod::get_method(
   return DexMethod::get_method(cls, name, DexProto::get_proto(rtype, dtl));
 }
 
+namespace {
+
+// A lookup-only variant of `parse_method` followed by
+// `get_method(MethodDescriptorTokens)`: nothing is copied, the argument types
+// are collected into a per-thread buffer, and we stop at the first token that
+// has no interned counterpart, which is the common case when probing for
+// methods named in configs or keep rules.
+DexMethodRef* probe_method(std::string_view s) {
+  auto find = [s](auto needle, size_t start_pos) {
+    auto pos = s.find(needle, start_pos);
+    always_assert_log(pos != std::string_view::npos,
+                      "Invalid method descriptor: %.*s", (int)s.size(),
+                      s.data());
+    return pos;
+  };
+  auto cls_end = find('.', 0);
+  auto name_start = cls_end + 1;
+  auto name_end = find(":(", name_start);
+  auto args_start = name_end + 2;
+  auto args_end = find(')', args_start);
+  auto rtype_start = args_end + 1;
+  always_assert_log(rtype_start < s.size(), "No return type found");
+
+  auto cls = DexType::get_type(s.substr(0, cls_end));
+  if (cls == nullptr) {
+    return nullptr;
+  }
+  auto name =
+      DexString::get_string(s.substr(name_start, name_end - name_start));
+  if (name == nullptr) {
+    return nullptr;
+  }
+  auto rtype = DexType::get_type(s.substr(rtype_start));
+  if (rtype == nullptr) {
+    return nullptr;
+  }
+  thread_local DexTypeList::ContainerType args;
+  args.clear();
+  auto args_str = s.substr(args_start, args_end - args_start);
+  for (size_t begin = 0; begin < args_str.size();) {
+    auto end = dex_member_refs::arg_end(args_str, begin);
+    auto arg = DexType::get_type(args_str.substr(begin, end - begin));
+    if (arg == nullptr) {
+      return nullptr;
+    }
+    args.push_back(arg);
+    begin = end;
+  }
+  auto dtl = DexTypeList::get_type_list(args);
+  if (dtl == nullptr) {
+    return nullptr;
+  }
+  return DexMethod::get_method(cls, name, DexProto::get_proto(rtype, dtl));
+}
+
+} // namespace
+
 template <bool kCheckFormat>
 DexMethodRef* DexMethod::get_method(std::string_view full_descriptor) {
+  if (!kCheckFormat) {
+    return probe_method(full_descriptor);
+  }
   return get_method(
       dex_member_refs::parse_method<kCheckFormat>(full_descriptor));
 }
@@ -1047,7 +1156,22 @@ void DexClass::set_external() {
   m_external = true;
 }
 
+void DexClass::set_super_class(DexType* super_class) {
+  always_assert_log(!m_external, "Unexpected external class %s\n",
+                    self_show().c_str());
+  m_super_class = super_class;
+  RedexContext::bump_hierarchy_generation();
+}
+
+void DexClass::set_interfaces(DexTypeList* intfs) {
+  always_assert_log(!m_external, "Unexpected external class %s\n",
+                    self_show().c_str());
+  m_interfaces = intfs;
+  RedexContext::bump_hierarchy_generation();
+}
+
 void DexClass::remove_method(const DexMethod* m) {
+  RedexContext::bump_hierarchy_generation();
   auto& meths = m->is_virtual() ? m_vmethods : m_dmethods;
   auto it = std::find(meths.begin(), meths.end(), m);
   DEBUG_ONLY bool erased = false;
@@ -1066,6 +1190,7 @@ void DexMethod::become_virtual() {
   m_virtual = true;
   auto& vmethods = cls->get_vmethods();
   insert_sorted(vmethods, this, compare_dexmethods);
+  RedexContext::bump_hierarchy_generation();
 }
 
 DexMethod* DexMethodRef::make_concrete(DexAccessFlags access,
@@ -1101,6 +1226,9 @@ void DexMethodRef::change(const DexMethodSpec& ref, bool rename_on_collision) {
 void DexMethod::make_non_concrete() {
   m_access = static_cast<DexAccessFlags>(0);
   m_concrete = false;
+  if (m_lazy_code.exchange(false)) {
+    m_dex_code.reset();
+  }
   m_code.reset();
   m_virtual = false;
   m_param_anno.reset();
@@ -1238,7 +1366,10 @@ void DexClass::load_class_data_item(
   }
 }
 
-std::unique_ptr<IRCode> DexMethod::release_code() { return std::move(m_code); }
+std::unique_ptr<IRCode> DexMethod::release_code() {
+  materialize_code();
+  return std::move(m_code);
+}
 
 std::vector<DexMethod*> DexClass::get_all_methods() const {
   std::vector<DexMethod*> all_methods(m_vmethods.begin(), m_vmethods.end());
@@ -1256,6 +1387,7 @@ void DexClass::add_method(DexMethod* m) {
   } else {
     insert_sorted(m_dmethods, m, compare_dexmethods);
   }
+  RedexContext::bump_hierarchy_generation();
 }
 
 std::vector<DexField*> DexClass::get_all_fields() const {
@@ -1275,9 +1407,11 @@ void DexClass::add_field(DexField* f) {
   } else {
     insert_sorted(m_ifields, f, compare_dexfields);
   }
+  RedexContext::bump_hierarchy_generation();
 }
 
 void DexClass::remove_field(const DexField* f) {
+  RedexContext::bump_hierarchy_generation();
   bool is_static = f->get_access() & DexAccessFlags::ACC_STATIC;
   auto& fields = is_static ? m_sfields : m_ifields;
   DEBUG_ONLY bool erase = false;
@@ -1567,7 +1701,7 @@ DexClass* DexClass::create(DexIdx* idx,
                            const dex_class_def* cdef,
                            const DexLocation* location) {
   DexClass* cls = new DexClass(idx, cdef, location);
-  if (g_redex->class_already_loaded(cls)) {
+  if (g_redex->class_already_loaded(cls, idx, cdef)) {
     // FIXME: This isn't deterministic. We're keeping whichever class we loaded
     // first, which may not always be from the same dex (if we load them in
     // parallel, for example).
@@ -1592,7 +1726,8 @@ DexClass::DexClass(DexType* type, const DexLocation* location)
       m_access_flags((DexAccessFlags)0),
       m_external(false),
       m_perf_sensitive(PerfSensitiveGroup::NONE),
-      m_dynamically_dead(false) {
+      m_dynamically_dead(false),
+      m_dense_index(g_redex->next_class_index()) {
   always_assert(type != nullptr);
   always_assert_log(type_class(type) == nullptr,
                     "class already exists for %s\n", type->c_str());
@@ -1611,7 +1746,8 @@ DexClass::DexClass(DexIdx* idx,
       m_access_flags((DexAccessFlags)cdef->access_flags),
       m_external(false),
       m_perf_sensitive(PerfSensitiveGroup::NONE),
-      m_dynamically_dead(false) {
+      m_dynamically_dead(false),
+      m_dense_index(g_redex->next_class_index()) {
   always_assert(m_self != nullptr);
 }
 
@@ -1871,6 +2007,125 @@ DexField* DexClass::find_field_from_simple_deobfuscated_name(
   return nullptr;
 }
 
+namespace {
+
+// Classes with fewer members in a list than this just scan that list.
+constexpr size_t kMemberIndexMinSize = 32;
+// Scans of a wide class needed before its index is (re)built. Amortizes
+// rebuilding while a pass is still mutating the hierarchy.
+constexpr uint32_t kMemberIndexMinMisses = 4;
+
+const DexProto* member_type(const DexMethod* method) {
+  return method->get_proto();
+}
+
+const DexType* member_type(const DexField* field) { return field->get_type(); }
+
+template <typename Member, typename Type>
+Member* scan_members(const std::vector<Member*>& members,
+                     const DexString* name,
+                     const Type* type) {
+  for (auto* member : members) {
+    if (member->get_name() == name && member_type(member) == type) {
+      return member;
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+// Positions of the members in the lists, keyed by (name, proto or type), as
+// of the given hierarchy generation and list sizes. Lists may be edited
+// directly, so hits are also checked against the list.
+struct DexClass::MemberIndex {
+  using Key = std::pair<const DexString*, const void*>;
+  using Positions = std::unordered_map<Key, uint32_t, boost::hash<Key>>;
+
+  uint64_t generation;
+  std::array<size_t, 4> sizes;
+  std::array<Positions, 4> positions;
+
+  template <typename Member>
+  static void index(const std::vector<Member*>& members, Positions* res) {
+    res->reserve(members.size());
+    for (uint32_t i = 0; i < members.size(); i++) {
+      res->emplace(Key(members[i]->get_name(), member_type(members[i])), i);
+    }
+  }
+
+  template <typename Member, typename Type>
+  Member* find(size_t list,
+               const std::vector<Member*>& members,
+               const DexString* name,
+               const Type* type) const {
+    auto it = positions[list].find(Key(name, type));
+    if (it == positions[list].end()) {
+      return nullptr;
+    }
+    auto* member = members[it->second];
+    if (member->get_name() == name && member_type(member) == type) {
+      return member;
+    }
+    // Reordered in place; fall back to a scan.
+    return scan_members(members, name, type);
+  }
+};
+
+std::shared_ptr<const DexClass::MemberIndex> DexClass::get_member_index()
+    const {
+  auto index = std::atomic_load(&m_member_index);
+  auto generation = RedexContext::hierarchy_generation();
+  std::array<size_t, 4> sizes{m_vmethods.size(), m_dmethods.size(),
+                              m_ifields.size(), m_sfields.size()};
+  if (index && index->generation == generation && index->sizes == sizes) {
+    return index;
+  }
+  if (m_member_index_misses.fetch_add(1, std::memory_order_relaxed) <
+      kMemberIndexMinMisses) {
+    return nullptr;
+  }
+  auto new_index = std::make_shared<MemberIndex>();
+  new_index->generation = generation;
+  new_index->sizes = sizes;
+  MemberIndex::index(m_vmethods, &new_index->positions[0]);
+  MemberIndex::index(m_dmethods, &new_index->positions[1]);
+  MemberIndex::index(m_ifields, &new_index->positions[2]);
+  MemberIndex::index(m_sfields, &new_index->positions[3]);
+  std::shared_ptr<const MemberIndex> res(std::move(new_index));
+  std::atomic_store(&m_member_index, res);
+  m_member_index_misses.store(0, std::memory_order_relaxed);
+  return res;
+}
+
+DexMethod* DexClass::find_method(const DexString* name,
+                                 const DexProto* proto,
+                                 bool is_virtual) const {
+  const auto& methods = is_virtual ? m_vmethods : m_dmethods;
+  if (methods.size() < kMemberIndexMinSize) {
+    return scan_members(methods, name, proto);
+  }
+  auto index = get_member_index();
+  if (index == nullptr) {
+    return scan_members(methods, name, proto);
+  }
+  return index->find(is_virtual ? 0 : 1, methods, name, proto);
+}
+
+DexField* DexClass::find_field(const DexString* name,
+                               const DexType* type,
+                               bool is_static) const {
+  const auto& fields = is_static ? m_sfields : m_ifields;
+  if (fields.size() < kMemberIndexMinSize) {
+    return scan_members(fields, name, type);
+  }
+  auto index = get_member_index();
+  if (index == nullptr) {
+    return scan_members(fields, name, type);
+  }
+  return index->find(is_static ? 3 : 2, fields, name, type);
+}
+
 DexMethod* DexClass::find_method_from_simple_deobfuscated_name(
     const std::string& method_name) {
   for (DexMethod* m : get_dmethods()) {
@@ -1981,7 +2236,7 @@ template <typename C>
 void DexMethod::gather_types(C& ltype) const {
   gather_types_shallow(ltype); // Handle DexMethodRef parts.
   std::vector<DexType*> type_vec; // Simplify refactor.
-  if (m_code) m_code->gather_types(type_vec);
+  if (auto* code = get_code()) code->gather_types(type_vec);
   if (m_anno) m_anno->gather_types(type_vec);
   auto param_anno = get_param_anno();
   if (param_anno) {
@@ -1995,15 +2250,15 @@ void DexMethod::gather_types(C& ltype) const {
 INSTANTIATE(DexMethod::gather_types, DexType*)
 
 void DexMethod::gather_init_classes(std::vector<DexType*>& ltype) const {
-  if (m_code) m_code->gather_init_classes(ltype);
+  if (auto* code = get_code()) code->gather_init_classes(ltype);
 }
 
 template <typename C>
 void DexMethod::gather_callsites(C& lcallsite) const {
   // We handle m_spec.cls and proto in the first-layer gather.
-  if (m_code) {
+  if (auto* code = get_code()) {
     std::vector<DexCallSite*> callsite_vec; // Simplify refactor.
-    m_code->gather_callsites(callsite_vec);
+    code->gather_callsites(callsite_vec);
     c_append_all(lcallsite, callsite_vec.begin(), callsite_vec.end());
   }
 }
@@ -2013,7 +2268,7 @@ template <typename C>
 void DexMethod::gather_methodhandles(C& lmethodhandle) const {
   // We handle m_spec.cls and proto in the first-layer gather.
   std::vector<DexMethodHandle*> mhandles_vec; // Simplify refactor.
-  if (m_code) m_code->gather_methodhandles(mhandles_vec);
+  if (auto* code = get_code()) code->gather_methodhandles(mhandles_vec);
   c_append_all(lmethodhandle, mhandles_vec.begin(), mhandles_vec.end());
 }
 INSTANTIATE(DexMethod::gather_methodhandles, DexMethodHandle*)
@@ -2021,7 +2276,7 @@ template <typename C>
 void DexMethod::gather_strings_internal(C& lstring, bool exclude_loads) const {
   // We handle m_name and proto in the first-layer gather.
   std::vector<const DexString*> strings_vec; // Simplify refactor.
-  if (m_code && !exclude_loads) m_code->gather_strings(strings_vec);
+  if (auto* code = get_code(); code && !exclude_loads) code->gather_strings(strings_vec);
   if (m_anno) m_anno->gather_strings(strings_vec);
   auto param_anno = get_param_anno();
   if (param_anno) {
@@ -2044,7 +2299,7 @@ void DexMethod::gather_strings(std::unordered_set<const DexString*>& lstring,
 template <typename C>
 void DexMethod::gather_fields(C& lfield) const {
   std::vector<DexFieldRef*> fields_vec; // Simplify refactor.
-  if (m_code) m_code->gather_fields(fields_vec);
+  if (auto* code = get_code()) code->gather_fields(fields_vec);
   if (m_anno) m_anno->gather_fields(fields_vec);
   auto param_anno = get_param_anno();
   if (param_anno) {
@@ -2059,9 +2314,9 @@ INSTANTIATE(DexMethod::gather_fields, DexFieldRef*)
 
 template <typename C>
 void DexMethod::gather_methods(C& lmethod) const {
-  if (m_code) {
+  if (auto* code = get_code()) {
     std::vector<DexMethodRef*> method_vec; // Simplify refactor.
-    m_code->gather_methods(method_vec);
+    code->gather_methods(method_vec);
     c_append_all(lmethod, method_vec.begin(), method_vec.end());
   }
   gather_methods_from_annos(lmethod);
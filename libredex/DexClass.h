@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
@@ -280,6 +281,8 @@ class DexFieldRef {
   DexFieldSpec m_spec;
   bool m_concrete;
   bool m_external;
+  // See RedexContext::next_field_index.
+  uint32_t m_dense_index{0};
 
   virtual ~DexFieldRef() {}
   DexFieldRef(DexType* container, const DexString* name, DexType* type) {
@@ -297,6 +300,7 @@ class DexFieldRef {
 
   bool is_concrete() const { return m_concrete; }
   bool is_external() const { return m_external; }
+  uint32_t get_dense_index() const { return m_dense_index; }
   bool is_def() const { return is_concrete() || is_external(); }
   const DexField* as_def() const;
   DexField* as_def();
@@ -820,6 +824,8 @@ class DexMethodRef {
   DexMethodSpec m_spec;
   bool m_concrete;
   bool m_external;
+  // See RedexContext::next_method_index.
+  uint32_t m_dense_index{0};
 
   ~DexMethodRef() {}
   DexMethodRef(DexType* type, const DexString* name, DexProto* proto)
@@ -835,6 +841,7 @@ class DexMethodRef {
 
   bool is_concrete() const { return m_concrete; }
   bool is_external() const { return m_external; }
+  uint32_t get_dense_index() const { return m_dense_index; }
   bool is_def() const { return is_concrete() || is_external(); }
   const DexMethod* as_def() const;
   DexMethod* as_def();
@@ -879,6 +886,9 @@ class DexMethod : public DexMethodRef {
 
   // Place these first to avoid/fill padding from DexMethodRef.
   bool m_virtual{false};
+  // Set while m_code still has to be lifted from m_dex_code, see
+  // `balloon_lazily`.
+  std::atomic<bool> m_lazy_code{false};
   DexAccessFlags m_access;
 
   std::unique_ptr<DexAnnotationSet> m_anno;
@@ -994,8 +1004,14 @@ class DexMethod : public DexMethodRef {
   DexAnnotationSet* get_anno_set() { return m_anno.get(); }
   const DexCode* get_dex_code() const { return m_dex_code.get(); }
   DexCode* get_dex_code() { return m_dex_code.get(); }
-  IRCode* get_code() { return m_code.get(); }
-  const IRCode* get_code() const { return m_code.get(); }
+  IRCode* get_code() {
+    materialize_code();
+    return m_code.get();
+  }
+  const IRCode* get_code() const {
+    const_cast<DexMethod*>(this)->materialize_code();
+    return m_code.get();
+  }
   std::unique_ptr<IRCode> release_code();
   bool is_virtual() const { return m_virtual; }
   DexAccessFlags get_access() const {
@@ -1101,6 +1117,9 @@ class DexMethod : public DexMethodRef {
    * have to call sync().
    */
   void balloon();
+  // Like `balloon`, but defers lifting the DexCode to the first access of the
+  // IRCode. Thread-safe.
+  void balloon_lazily();
   void sync();
 
   // This method frees the given `DexMethod` - different from `erase_method`,
@@ -1119,6 +1138,13 @@ class DexMethod : public DexMethodRef {
  private:
   template <typename C>
   void gather_strings_internal(C& lstring, bool exclude_loads) const;
+
+  void materialize_code() {
+    if (m_lazy_code.load(std::memory_order_acquire)) {
+      materialize_lazy_code();
+    }
+  }
+  void materialize_lazy_code();
 };
 
 using dexcode_to_offset = std::unordered_map<DexCode*, uint32_t>;
@@ -1163,6 +1189,15 @@ class DexClass {
   bool m_external;
   PerfSensitiveGroup m_perf_sensitive;
   bool m_dynamically_dead;
+  // See RedexContext::next_class_index.
+  uint32_t m_dense_index;
+  // Lookups that had to scan the member lists since the index was last
+  // (re)built; see find_method.
+  mutable std::atomic<uint32_t> m_member_index_misses{0};
+  struct MemberIndex;
+  mutable std::shared_ptr<const MemberIndex> m_member_index;
+
+  std::shared_ptr<const MemberIndex> get_member_index() const;
 
   DexClass(DexType* type, const DexLocation* location);
   void load_class_annotations(DexIdx* idx, uint32_t anno_off);
@@ -1268,6 +1303,7 @@ class DexClass {
   bool has_class_data() const;
   bool is_def() const { return true; }
   bool is_external() const { return m_external; }
+  uint32_t get_dense_index() const { return m_dense_index; }
   std::unique_ptr<DexEncodedValueArray> get_static_values();
   const DexAnnotationSet* get_anno_set() const { return m_anno.get(); }
   DexAnnotationSet* get_anno_set() { return m_anno.get(); }
@@ -1312,19 +1348,11 @@ class DexClass {
 
   void set_external();
 
-  void set_super_class(DexType* super_class) {
-    always_assert_log(!m_external, "Unexpected external class %s\n",
-                      self_show().c_str());
-    m_super_class = super_class;
-  }
+  void set_super_class(DexType* super_class);
 
   void combine_annotations_with(DexClass* other);
 
-  void set_interfaces(DexTypeList* intfs) {
-    always_assert_log(!m_external, "Unexpected external class %s\n",
-                      self_show().c_str());
-    m_interfaces = intfs;
-  }
+  void set_interfaces(DexTypeList* intfs);
 
   void clear_annotations();
   /* Encodes class_data_item, returns size in bytes.  No
@@ -1363,6 +1391,17 @@ class DexClass {
   bool is_dynamically_dead() const { return m_dynamically_dead; }
   void set_dynamically_dead(bool value = true) { m_dynamically_dead = value; }
 
+  // Find the method or field of this class with the given name and proto or
+  // type, or nullptr. Classes with many members are looked up through a
+  // lazily built index, which is rebuilt after the class hierarchy or the
+  // member lists changed.
+  DexMethod* find_method(const DexString* name,
+                         const DexProto* proto,
+                         bool is_virtual) const;
+  DexField* find_field(const DexString* name,
+                       const DexType* type,
+                       bool is_static) const;
+
   // Find methods and fields from a class using its obfuscated name.
   DexField* find_field_from_simple_deobfuscated_name(
       const std::string& field_name);
@@ -14,6 +14,8 @@
 #include "DexMethodHandle.h"
 #include "IRCode.h"
 #include "Macros.h"
+#include "RedexContext.h"
+#include "RedexMappedFile.h"
 #include "Show.h"
 #include "Trace.h"
 #include "Walkers.h"
@@ -23,6 +25,10 @@
 #include <stdexcept>
 #include <vector>
 
+#ifdef __linux__
+#include <sys/resource.h> // For getrusage
+#endif
+
 DexLoader::DexLoader(const DexLocation* location)
     : m_idx(nullptr),
       m_file(new boost::iostreams::mapped_file()),
@@ -565,15 +571,40 @@ const dex_header* DexLoader::get_dex_header(const char* file_name) {
     fprintf(stderr, "error: cannot create memory-mapped file: %s\n", file_name);
     exit(EXIT_FAILURE);
   }
+  RedexMappedFile::advise_read_mostly(m_file->const_data(), m_file->size());
   return reinterpret_cast<const dex_header*>(m_file->const_data());
 }
 
+namespace {
+
+// Process-wide page faults so far, as (minor, major).
+std::pair<long, long> get_page_faults() {
+#ifdef __linux__
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return {usage.ru_minflt, usage.ru_majflt};
+  }
+#endif
+  return {0, 0};
+}
+
+} // namespace
+
 DexClasses DexLoader::load_dex(const char* file_name,
                                dex_stats_t* stats,
                                int support_dex_version) {
+  auto page_faults_before = get_page_faults();
   const dex_header* dh = get_dex_header(file_name);
   validate_dex_header(dh, m_file->size(), support_dex_version);
-  return load_dex(dh, stats);
+  auto classes = load_dex(dh, stats);
+  if (stats) {
+    auto page_faults_after = get_page_faults();
+    stats->num_minor_page_faults +=
+        page_faults_after.first - page_faults_before.first;
+    stats->num_major_page_faults +=
+        page_faults_after.second - page_faults_before.second;
+  }
+  return classes;
 }
 
 DexClasses DexLoader::load_dex(const dex_header* dh, dex_stats_t* stats) {
@@ -622,6 +653,11 @@ DexClasses DexLoader::load_dex(const dex_header* dh, dex_stats_t* stats) {
 }
 
 static void balloon_all(const Scope& scope, bool throw_on_error) {
+  if (g_redex->lazy_code_materialization && throw_on_error) {
+    // Malformed code will then fail on first access instead.
+    walk::parallel::methods(scope, [](DexMethod* m) { m->balloon_lazily(); });
+    return;
+  }
   InsertOnlyConcurrentMap<DexMethod*, std::string> ir_balloon_errors;
   walk::parallel::methods(scope, [&](DexMethod* m) {
     if (m->get_dex_code()) {
@@ -44,26 +44,31 @@ FieldDescriptorTokens parse_field(std::string_view s) {
   return fdt;
 }
 
+size_t arg_end(std::string_view args, size_t begin) {
+  auto ch = args[begin];
+  auto end = begin + 1;
+  if (ch == '[') {
+    while (args[end] == '[') {
+      ++end;
+    }
+    ch = args[end];
+    ++end;
+  }
+  if (ch == 'L') {
+    auto semipos = args.find(';', end);
+    redex_assert(semipos != std::string::npos);
+    end = semipos + 1;
+  }
+  return end;
+}
+
 namespace {
 
 std::vector<std::string_view> split_args(std::string_view args) {
   std::vector<std::string_view> ret;
   auto begin = size_t{0};
   while (begin < args.length()) {
-    auto ch = args[begin];
-    auto end = begin + 1;
-    if (ch == '[') {
-      while (args[end] == '[') {
-        ++end;
-      }
-      ch = args[end];
-      ++end;
-    }
-    if (ch == 'L') {
-      auto semipos = args.find(';', end);
-      redex_assert(semipos != std::string::npos);
-      end = semipos + 1;
-    }
+    auto end = arg_end(args, begin);
     ret.emplace_back(args.substr(begin, end - begin));
     begin = end;
   }
@@ -82,6 +82,10 @@ FieldDescriptorTokens parse_field(std::string_view);
 template <bool kCheckFormat = false>
 MethodDescriptorTokens parse_method(std::string_view);
 
+// Returns the position just past the type descriptor that starts at `begin`
+// in `args`, the concatenated argument types of a method descriptor.
+size_t arg_end(std::string_view args, size_t begin);
+
 } // namespace dex_member_refs
 
 namespace std {
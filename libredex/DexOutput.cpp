@@ -50,6 +50,7 @@
 #include "MethodProfiles.h"
 #include "MethodSimilarityCompressionConsciousOrderer.h"
 #include "MethodSimilarityGreedyOrderer.h"
+#include "MethodStartupPageOrderer.h"
 #include "Pass.h"
 #include "RedexOptions.h" // For DebugInfoKind
 #include "Resolver.h"
@@ -133,6 +134,18 @@ GatheredTypes::keep_cls_strings_together_emitlist() {
       CustomSort<DexString, cmp_dstring>(m_cls_strings, compare_dexstrings));
 }
 
+std::vector<const DexString*>
+GatheredTypes::get_coldstart_dexstring_emitlist() {
+  return get_dexstring_emitlist(CustomSort<DexString, cmp_dstring>(
+      get_coldstart_strings(), compare_dexstrings));
+}
+
+const std::unordered_map<const DexString*, unsigned int>&
+GatheredTypes::get_coldstart_strings() {
+  build_coldstart_string_map();
+  return m_coldstart_strings;
+}
+
 std::vector<DexMethodHandle*> GatheredTypes::get_dexmethodhandle_emitlist() {
   return m_lmethodhandle;
 }
@@ -334,6 +347,88 @@ void GatheredTypes::sort_dexmethod_emitlist_profiled_order(
   std::stable_sort(lmeth.begin(), lmeth.end(), std::ref(comparator));
 }
 
+void GatheredTypes::sort_dexmethod_emitlist_startup_page_order(
+    std::vector<DexMethod*>& lmeth) {
+  redex_assert(m_config != nullptr);
+  auto& method_profiles = m_config->get_method_profiles();
+  // Some builds might not have method profiles information.
+  if (!method_profiles.is_initialized()) {
+    return;
+  }
+
+  auto& global_config = m_config->get_global_config();
+  double min_appear_percent = MethodProfileOrderingConfig().min_appear_percent;
+  if (global_config.has_config_by_name("method_profile_order")) {
+    min_appear_percent =
+        global_config
+            .get_config_by_name<MethodProfileOrderingConfig>(
+                "method_profile_order")
+            ->min_appear_percent;
+  }
+  MethodStartupPageOrderer method_orderer(method_profiles, min_appear_percent);
+  method_orderer.order(lmeth);
+}
+
+void GatheredTypes::sort_dexmethod_emitlist_appear_bucket_order(
+    std::vector<DexMethod*>& lmeth) {
+  // Methods are grouped into buckets by how often they appear in cold start,
+  // followed by the ones that appear often enough in any other interaction,
+  // and then all the others. Within a bucket, the incoming (class) order is
+  // preserved, so that the hot code of a class stays together.
+  redex_assert(m_config != nullptr);
+  auto& method_profiles = m_config->get_method_profiles();
+  // Some builds might not have method profiles information.
+  if (!method_profiles.is_initialized()) {
+    return;
+  }
+
+  MethodProfileOrderingConfig default_config;
+  const MethodProfileOrderingConfig* config = &default_config;
+  auto& global_config = m_config->get_global_config();
+  if (global_config.has_config_by_name("method_profile_order")) {
+    config = global_config.get_config_by_name<MethodProfileOrderingConfig>(
+        "method_profile_order");
+  }
+  std::vector<double> thresholds(config->appear_buckets.begin(),
+                                 config->appear_buckets.end());
+  thresholds.push_back(config->min_appear_percent);
+
+  const auto& coldstart_stats =
+      method_profiles.method_stats(method_profiles::COLD_START);
+  auto get_bucket = [&](const DexMethod* method) -> size_t {
+    auto it = coldstart_stats.find(method);
+    if (it != coldstart_stats.end()) {
+      for (size_t i = 0; i < thresholds.size(); i++) {
+        if (it->second.appear_percent >= thresholds[i]) {
+          return i;
+        }
+      }
+    }
+    for (const auto& [interaction_id, stats] :
+         method_profiles.all_interactions()) {
+      if (interaction_id == method_profiles::COLD_START) {
+        continue;
+      }
+      auto other_it = stats.find(method);
+      if (other_it != stats.end() &&
+          other_it->second.appear_percent >= config->min_appear_percent) {
+        return thresholds.size();
+      }
+    }
+    return thresholds.size() + 1;
+  };
+
+  std::unordered_map<const DexMethod*, size_t> buckets;
+  buckets.reserve(lmeth.size());
+  for (auto* m : lmeth) {
+    buckets.emplace(m, get_bucket(m));
+  }
+  std::stable_sort(lmeth.begin(), lmeth.end(),
+                   [&](const DexMethod* a, const DexMethod* b) {
+                     return buckets.at(a) < buckets.at(b);
+                   });
+}
+
 void GatheredTypes::sort_dexmethod_emitlist_clinit_order(
     std::vector<DexMethod*>& lmeth) {
   std::stable_sort(lmeth.begin(), lmeth.end(),
@@ -520,6 +615,70 @@ void GatheredTypes::build_cls_map() {
   }
 }
 
+void GatheredTypes::build_coldstart_string_map() {
+  // The profiles are only available once the config has been set, so this map
+  // is built on demand rather than in the constructor.
+  if (m_coldstart_strings_built) {
+    return;
+  }
+  m_coldstart_strings_built = true;
+  redex_assert(m_config != nullptr);
+  const auto& method_profiles = m_config->get_method_profiles();
+  // Some builds might not have method profiles information.
+  if (!method_profiles.is_initialized()) {
+    return;
+  }
+
+  auto& global_config = m_config->get_global_config();
+  double min_appear_percent = MethodProfileOrderingConfig().min_appear_percent;
+  if (global_config.has_config_by_name("method_profile_order")) {
+    min_appear_percent =
+        global_config
+            .get_config_by_name<MethodProfileOrderingConfig>(
+                "method_profile_order")
+            ->min_appear_percent;
+  }
+
+  // Order the cold-start methods by their average position in the profile,
+  // breaking ties by class order.
+  std::vector<std::pair<double, const DexMethod*>> coldstart_methods;
+  walk::methods(*m_classes, [&](DexMethod* m) {
+    auto stat = method_profiles.get_method_stat(method_profiles::COLD_START, m);
+    if (stat && stat->appear_percent >= min_appear_percent) {
+      coldstart_methods.emplace_back(stat->order_percent, m);
+    }
+  });
+  std::stable_sort(
+      coldstart_methods.begin(), coldstart_methods.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  // Each string is ranked by its first use. A method needs its name and the
+  // descriptors of the types it references resolved, besides the strings its
+  // code loads.
+  unsigned int index = 0;
+  auto add_string = [&](const DexString* s) {
+    if (m_coldstart_strings.emplace(s, index).second) {
+      index++;
+    }
+  };
+  for (const auto& [_, m] : coldstart_methods) {
+    add_string(m->get_name());
+    std::vector<DexType*> method_types;
+    m->gather_types(method_types);
+    for (auto* t : method_types) {
+      add_string(t->get_name());
+    }
+    std::vector<const DexString*> method_strings;
+    m->gather_strings(method_strings);
+    for (auto* s : method_strings) {
+      add_string(s);
+    }
+  }
+
+  TRACE(CUSTOMSORT, 1, "found %u strings from %zu cold-start methods", index,
+        coldstart_methods.size());
+}
+
 void GatheredTypes::build_method_map() {
   unsigned int index = 0;
   for (const auto& cls : *m_classes) {
@@ -544,6 +703,9 @@ constexpr uint32_t k_output_red_zone = 250000;
 
 constexpr uint32_t k_default_max_dex_size = 32 * 1024 * 1024;
 
+// Page granularity used to report how spread out the cold-start strings are.
+constexpr uint32_t STRING_DATA_PAGE_SIZE = 4096;
+
 uint32_t get_dex_output_size(const ConfigFiles& conf) {
   size_t output_size;
   conf.get_json_config().get("dex_output_buffer_size", k_default_max_dex_size,
@@ -587,7 +749,7 @@ DexOutput::DexOutput(
                          ? get_dex_output_size(config_files) * 2
                          : get_dex_output_size(config_files)) +
                     k_output_red_zone),
-      m_output(std::make_unique<uint8_t[]>(m_output_size)),
+      m_output((uint8_t*)calloc(m_output_size, 1), &free),
       m_gtypes(std::move(gtypes)),
       m_dodx(m_gtypes->get_dodx(m_output.get())),
       // Required because the BytecodeDebugger setting creates huge amounts
@@ -597,8 +759,9 @@ DexOutput::DexOutput(
       m_config_files(config_files),
       m_min_sdk(min_sdk),
       m_dex_output_config(dex_output_config) {
-  // Ensure a clean slate.
-  memset(m_output.get(), 0, m_output_size);
+  always_assert_log(m_output != nullptr,
+                    "Could not allocate %zu bytes of dex output buffer",
+                    m_output_size);
 
   always_assert_log(
       m_dodx.method_to_idx().size() <= kMaxMethodRefs,
@@ -798,6 +961,9 @@ void DexOutput::generate_string_data(SortMode mode) {
   } else if (mode == SortMode::CLASS_STRINGS) {
     TRACE(CUSTOMSORT, 2, "using class names pack for string pool sorting");
     string_order = m_gtypes->keep_cls_strings_together_emitlist();
+  } else if (mode == SortMode::COLDSTART_STRINGS) {
+    TRACE(CUSTOMSORT, 2, "using cold-start order for string pool sorting");
+    string_order = m_gtypes->get_coldstart_dexstring_emitlist();
   } else {
     TRACE(CUSTOMSORT, 2, "using default string pool sorting");
     string_order = m_gtypes->get_dexstring_emitlist();
@@ -826,6 +992,11 @@ void DexOutput::generate_string_data(SortMode mode) {
   size_t nrstr = string_order.size() + locators;
   const uint32_t str_data_start = m_offset;
 
+  // Track the pages that the strings used during cold start land on, so that
+  // the effect of the string sort mode on page faults can be measured.
+  const auto& coldstart_strings = m_gtypes->get_coldstart_strings();
+  std::unordered_set<uint32_t> coldstart_string_pages;
+
   for (auto* str : string_order) {
     // Emit lookup acceleration string if requested
     std::unique_ptr<Locator> locator = locator_for_descriptor(type_names, str);
@@ -849,9 +1020,19 @@ void DexOutput::generate_string_data(SortMode mode) {
     TRACE(CUSTOMSORT, 3, "str emit %s", SHOW(str));
     stringids[idx].offset = m_offset;
     str->encode(m_output.get() + m_offset);
+    if (coldstart_strings.count(str)) {
+      m_stats.num_coldstart_strings++;
+      for (uint32_t page = m_offset / STRING_DATA_PAGE_SIZE;
+           page <= (m_offset + str->get_entry_size() - 1) /
+                       STRING_DATA_PAGE_SIZE;
+           page++) {
+        coldstart_string_pages.insert(page);
+      }
+    }
     inc_offset(str->get_entry_size());
     m_stats.num_strings++;
   }
+  m_stats.num_coldstart_string_pages += coldstart_string_pages.size();
 
   insert_map_item(TYPE_STRING_DATA_ITEM, (uint32_t)nrstr, str_data_start,
                   m_offset - str_data_start);
@@ -1108,10 +1289,22 @@ void DexOutput::generate_code_items(const std::vector<SortMode>& mode) {
       TRACE(CUSTOMSORT, 2,
             "Unsupport bytecode sorting method SortMode::CLASS_STRINGS");
       break;
+    case SortMode::COLDSTART_STRINGS:
+      TRACE(CUSTOMSORT, 2,
+            "Unsupport bytecode sorting method SortMode::COLDSTART_STRINGS");
+      break;
     case SortMode::METHOD_SIMILARITY:
       TRACE(CUSTOMSORT, 2, "using method similarity order");
       m_gtypes->sort_dexmethod_emitlist_method_similarity_order(lmeth);
       break;
+    case SortMode::METHOD_STARTUP_PAGE_ORDER:
+      TRACE(CUSTOMSORT, 2, "using startup page order");
+      m_gtypes->sort_dexmethod_emitlist_startup_page_order(lmeth);
+      break;
+    case SortMode::METHOD_APPEAR_BUCKET_ORDER:
+      TRACE(CUSTOMSORT, 2, "using appear bucket order");
+      m_gtypes->sort_dexmethod_emitlist_appear_bucket_order(lmeth);
+      break;
     case SortMode::DEFAULT:
       TRACE(CUSTOMSORT, 2, "using default sorting order");
       m_gtypes->sort_dexmethod_emitlist_default_order(lmeth);
@@ -2955,7 +3148,14 @@ void DexOutput::write() {
     perror("Error writing dex");
     return;
   }
-  ::write(fd, m_output.get(), m_offset);
+  for (uint32_t written = 0; written < m_offset;) {
+    auto res = ::write(fd, m_output.get() + written, m_offset - written);
+    if (res <= 0) {
+      perror("Error writing dex");
+      break;
+    }
+    written += res;
+  }
   if (0 == fstat(fd, &st)) {
     m_stats.num_bytes = st.st_size;
   }
@@ -2980,7 +3180,7 @@ class UniqueReferences {
 };
 UniqueReferences s_unique_references;
 
-void DexOutput::metrics() {
+std::vector<std::function<void()>> DexOutput::unique_reference_metrics() {
   if (s_unique_references.dexes++ == 1 && !m_normal_primary_dex) {
     // clear out info from first (primary) dex
     s_unique_references.strings.clear();
@@ -2994,42 +3194,68 @@ void DexOutput::metrics() {
     s_unique_references.total_fields_size = 0;
     s_unique_references.total_methods_size = 0;
   }
-  memcpy(m_stats.signature, hdr.signature, 20);
-
-  for (auto& p : m_dodx.string_to_idx()) {
-    s_unique_references.strings.insert(p.first);
-  }
-  m_stats.num_unique_strings = s_unique_references.strings.size();
-  s_unique_references.total_strings_size += m_dodx.string_to_idx().size();
-  m_stats.strings_total_size = s_unique_references.total_strings_size;
 
-  for (auto& p : m_dodx.type_to_idx()) {
-    s_unique_references.types.insert(p.first);
-  }
-  m_stats.num_unique_types = s_unique_references.types.size();
-  s_unique_references.total_types_size += m_dodx.type_to_idx().size();
-  m_stats.types_total_size = s_unique_references.total_types_size;
-
-  for (auto& p : m_dodx.proto_to_idx()) {
-    s_unique_references.protos.insert(p.first);
-  }
-  m_stats.num_unique_protos = s_unique_references.protos.size();
-  s_unique_references.total_protos_size += m_dodx.proto_to_idx().size();
-  m_stats.protos_total_size = s_unique_references.total_protos_size;
+  // Each of these only touches its own set of unique references and its own
+  // stats, so they can run concurrently.
+  std::vector<std::function<void()>> fns;
+  fns.emplace_back([this] {
+    for (auto& p : m_dodx.string_to_idx()) {
+      s_unique_references.strings.insert(p.first);
+    }
+    m_stats.num_unique_strings = s_unique_references.strings.size();
+    s_unique_references.total_strings_size += m_dodx.string_to_idx().size();
+    m_stats.strings_total_size = s_unique_references.total_strings_size;
+  });
+  fns.emplace_back([this] {
+    for (auto& p : m_dodx.type_to_idx()) {
+      s_unique_references.types.insert(p.first);
+    }
+    m_stats.num_unique_types = s_unique_references.types.size();
+    s_unique_references.total_types_size += m_dodx.type_to_idx().size();
+    m_stats.types_total_size = s_unique_references.total_types_size;
+  });
+  fns.emplace_back([this] {
+    for (auto& p : m_dodx.proto_to_idx()) {
+      s_unique_references.protos.insert(p.first);
+    }
+    m_stats.num_unique_protos = s_unique_references.protos.size();
+    s_unique_references.total_protos_size += m_dodx.proto_to_idx().size();
+    m_stats.protos_total_size = s_unique_references.total_protos_size;
+  });
+  fns.emplace_back([this] {
+    for (auto& p : m_dodx.field_to_idx()) {
+      s_unique_references.fields.insert(p.first);
+    }
+    m_stats.num_unique_field_refs = s_unique_references.fields.size();
+    s_unique_references.total_fields_size += m_dodx.field_to_idx().size();
+    m_stats.field_refs_total_size = s_unique_references.total_fields_size;
+  });
+  fns.emplace_back([this] {
+    for (auto& p : m_dodx.method_to_idx()) {
+      s_unique_references.methods.insert(p.first);
+    }
+    m_stats.num_unique_method_refs = s_unique_references.methods.size();
+    s_unique_references.total_methods_size += m_dodx.method_to_idx().size();
+    m_stats.method_refs_total_size = s_unique_references.total_methods_size;
+  });
+  return fns;
+}
 
-  for (auto& p : m_dodx.field_to_idx()) {
-    s_unique_references.fields.insert(p.first);
+void DexOutput::metrics() {
+  memcpy(m_stats.signature, hdr.signature, 20);
+  for (auto& fn : unique_reference_metrics()) {
+    fn();
   }
-  m_stats.num_unique_field_refs = s_unique_references.fields.size();
-  s_unique_references.total_fields_size += m_dodx.field_to_idx().size();
-  m_stats.field_refs_total_size = s_unique_references.total_fields_size;
+}
 
-  for (auto& p : m_dodx.method_to_idx()) {
-    s_unique_references.methods.insert(p.first);
-  }
-  m_stats.num_unique_method_refs = s_unique_references.methods.size();
-  s_unique_references.total_methods_size += m_dodx.method_to_idx().size();
-  m_stats.method_refs_total_size = s_unique_references.total_methods_size;
+void DexOutput::write_with_metrics() {
+  // The unique reference metrics only depend on the indices computed by
+  // prepare(), so they are gathered while the dex file is being written.
+  memcpy(m_stats.signature, hdr.signature, 20);
+  auto fns = unique_reference_metrics();
+  fns.emplace_back([this] { write(); });
+  workqueue_run<std::function<void()>>(
+      [](const std::function<void()>& fn) { fn(); }, fns);
 }
 
 static SortMode make_sort_bytecode(const std::string& sort_bytecode) {
@@ -3043,6 +3269,10 @@ static SortMode make_sort_bytecode(const std::string& sort_bytecode) {
     return SortMode::METHOD_SIMILARITY;
   } else if (sort_bytecode == "method_coldstart_order") {
     return SortMode::METHOD_COLDSTART_ORDER;
+  } else if (sort_bytecode == "method_startup_page_order") {
+    return SortMode::METHOD_STARTUP_PAGE_ORDER;
+  } else if (sort_bytecode == "method_appear_bucket_order") {
+    return SortMode::METHOD_APPEAR_BUCKET_ORDER;
   } else {
     return SortMode::DEFAULT;
   }
@@ -3093,6 +3323,8 @@ SortMode get_string_sort_mode(ConfigFiles& conf) {
     string_sort_mode = SortMode::CLASS_STRINGS;
   } else if (sort_strings == "class_order") {
     string_sort_mode = SortMode::CLASS_ORDER;
+  } else if (sort_strings == "coldstart_strings") {
+    string_sort_mode = SortMode::COLDSTART_STRINGS;
   }
   return string_sort_mode;
 }
@@ -3134,8 +3366,7 @@ enhanced_dex_stats_t write_classes_to_dex(
                  code_debug_lines, dex_output_config, min_sdk);
 
   dout.prepare(string_sort_mode, code_sort_mode, conf, dex_magic);
-  dout.write();
-  dout.metrics();
+  dout.write_with_metrics();
   return dout.m_stats;
 }
 
@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/optional/optional.hpp>
 
@@ -48,6 +50,9 @@ enum class SortMode {
   METHOD_COLDSTART_ORDER,
   METHOD_PROFILED_ORDER,
   METHOD_SIMILARITY,
+  METHOD_STARTUP_PAGE_ORDER,
+  METHOD_APPEAR_BUCKET_ORDER,
+  COLDSTART_STRINGS,
   DEFAULT
 };
 
@@ -238,6 +243,8 @@ class GatheredTypes {
   std::unordered_map<const DexString*, unsigned int> m_cls_load_strings;
   std::unordered_map<const DexString*, unsigned int> m_cls_strings;
   std::unordered_map<const DexMethod*, unsigned int> m_methods_in_cls_order;
+  std::unordered_map<const DexString*, unsigned int> m_coldstart_strings;
+  bool m_coldstart_strings_built{false};
   ConfigFiles* m_config{nullptr};
 
   dexstring_to_idx get_string_index(cmp_dstring cmp = compare_dexstrings);
@@ -255,6 +262,7 @@ class GatheredTypes {
   void build_cls_load_map();
   void build_cls_map();
   void build_method_map();
+  void build_coldstart_string_map();
 
  public:
   explicit GatheredTypes(DexClasses* classes);
@@ -265,6 +273,11 @@ class GatheredTypes {
       T cmp = compare_dexstrings);
   std::vector<const DexString*> get_cls_order_dexstring_emitlist();
   std::vector<const DexString*> keep_cls_strings_together_emitlist();
+  std::vector<const DexString*> get_coldstart_dexstring_emitlist();
+  // Strings referenced by profiled cold-start methods, ranked by the first
+  // use in cold-start order. Empty if there are no method profiles.
+  const std::unordered_map<const DexString*, unsigned int>&
+  get_coldstart_strings();
   std::vector<DexMethod*> get_dexmethod_emitlist();
   std::vector<DexMethodHandle*> get_dexmethodhandle_emitlist();
   std::vector<DexCallSite*> get_dexcallsite_emitlist();
@@ -278,6 +291,10 @@ class GatheredTypes {
   void sort_dexmethod_emitlist_cls_order(std::vector<DexMethod*>& lmeth);
   void sort_dexmethod_emitlist_clinit_order(std::vector<DexMethod*>& lmeth);
   void sort_dexmethod_emitlist_profiled_order(std::vector<DexMethod*>& lmeth);
+  void sort_dexmethod_emitlist_startup_page_order(
+      std::vector<DexMethod*>& lmeth);
+  void sort_dexmethod_emitlist_appear_bucket_order(
+      std::vector<DexMethod*>& lmeth);
   void set_config(ConfigFiles* config);
 
   std::unordered_set<const DexString*> index_type_names();
@@ -322,7 +339,10 @@ class DexOutput {
  private:
   DexClasses* m_classes;
   const size_t m_output_size;
-  std::unique_ptr<uint8_t[]> m_output;
+  // Allocated with calloc, so that the (large) buffer is handed out as
+  // lazily zeroed pages: only the part of it the dex actually occupies is
+  // ever touched.
+  std::unique_ptr<uint8_t[], void (*)(void*)> m_output;
   std::shared_ptr<GatheredTypes> m_gtypes;
   DexOutputIdx m_dodx;
   uint32_t m_offset;
@@ -392,6 +412,7 @@ class DexOutput {
   void finalize_header();
   void init_header_offsets(const std::string& dex_magic);
   void write_symbol_files();
+  std::vector<std::function<void()>> unique_reference_metrics();
   uint32_t align(uint32_t offset) { return (offset + 3) & ~3; }
   void align_output() { m_offset = align(m_offset); }
   void emit_locator(Locator locator);
@@ -428,6 +449,9 @@ class DexOutput {
                const std::string& dex_magic);
   void write();
   void metrics();
+  // Same as write() followed by metrics(), but with the metrics gathered
+  // concurrently with writing the file.
+  void write_with_metrics();
   static void check_method_instruction_size_limit(const ConfigFiles& conf,
                                                   int size,
                                                   const char* method_name);
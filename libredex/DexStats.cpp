@@ -35,6 +35,8 @@ dex_stats_t& dex_stats_t::operator+=(const dex_stats_t& rhs) {
   num_dbg_items += rhs.num_dbg_items;
   dbg_total_size += rhs.dbg_total_size;
   instruction_bytes += rhs.instruction_bytes;
+  num_minor_page_faults += rhs.num_minor_page_faults;
+  num_major_page_faults += rhs.num_major_page_faults;
 
   header_item_count += rhs.header_item_count;
   header_item_bytes += rhs.header_item_bytes;
@@ -68,6 +70,8 @@ dex_stats_t& dex_stats_t::operator+=(const dex_stats_t& rhs) {
   code_bytes += rhs.code_bytes;
   string_data_count += rhs.string_data_count;
   string_data_bytes += rhs.string_data_bytes;
+  num_coldstart_strings += rhs.num_coldstart_strings;
+  num_coldstart_string_pages += rhs.num_coldstart_string_pages;
   debug_info_count += rhs.debug_info_count;
   debug_info_bytes += rhs.debug_info_bytes;
   annotation_count += rhs.annotation_count;
@@ -46,6 +46,10 @@ struct dex_stats_t {
 
   int instruction_bytes = 0;
 
+  // Page faults of the whole process while the dex was loaded.
+  int num_minor_page_faults = 0;
+  int num_major_page_faults = 0;
+
   /* Stats collected from the Map List section of a Dex. */
   int header_item_count = 0;
   int header_item_bytes = 0;
@@ -95,6 +99,11 @@ struct dex_stats_t {
   int string_data_count = 0;
   int string_data_bytes = 0;
 
+  // Strings used by profiled cold-start methods, and the number of pages
+  // of string data they are spread over.
+  int num_coldstart_strings = 0;
+  int num_coldstart_string_pages = 0;
+
   int debug_info_count = 0;
   int debug_info_bytes = 0;
 
@@ -7,8 +7,13 @@
 
 #include "DuplicateClasses.h"
 
+#include "DexIdx.h"
+#include "DexInstruction.h"
+#include "Show.h"
 #include "Trace.h"
 #include <boost/algorithm/string/predicate.hpp>
+#include <sstream>
+#include <unordered_map>
 #include <vector>
 
 namespace dup_classes {
@@ -51,4 +56,141 @@ bool is_known_dup(DexClass* cls) {
          cls->get_name()->str().find(lambda_class_prefix) != std::string::npos;
 }
 
+namespace {
+
+bool same_code(const DexCode* a, const DexCode* b) {
+  if (a == nullptr || b == nullptr) {
+    return a == b;
+  }
+  if (a->get_registers_size() != b->get_registers_size() ||
+      a->get_ins_size() != b->get_ins_size() ||
+      a->get_outs_size() != b->get_outs_size()) {
+    return false;
+  }
+  const auto& a_insns = a->get_instructions();
+  const auto& b_insns = b->get_instructions();
+  if (!std::equal(a_insns.begin(), a_insns.end(), b_insns.begin(),
+                  b_insns.end(),
+                  [](const DexInstruction* x, const DexInstruction* y) {
+                    return *x == *y;
+                  })) {
+    return false;
+  }
+  const auto& a_tries = a->get_tries();
+  const auto& b_tries = b->get_tries();
+  return std::equal(a_tries.begin(), a_tries.end(), b_tries.begin(),
+                    b_tries.end(), [](const auto& x, const auto& y) {
+                      return x->m_start_addr == y->m_start_addr &&
+                             x->m_insn_count == y->m_insn_count &&
+                             x->m_catches == y->m_catches;
+                    });
+}
+
+} // namespace
+
+std::vector<std::string> compare_class_defs(const DexClass* loaded,
+                                            DexIdx* idx,
+                                            const dex_class_def* cdef) {
+  std::vector<std::string> diffs;
+  auto describe = [&diffs](const auto&... parts) {
+    std::ostringstream oss;
+    (oss << ... << parts);
+    diffs.push_back(oss.str());
+  };
+
+  if (loaded->get_access() != (DexAccessFlags)cdef->access_flags) {
+    describe("access flags: 0x", std::hex, loaded->get_access(), " vs 0x",
+             cdef->access_flags);
+  }
+  auto super_cls = idx->get_typeidx(cdef->super_idx);
+  if (loaded->get_super_class() != super_cls) {
+    describe("super class: ", show(loaded->get_super_class()), " vs ",
+             show(super_cls));
+  }
+  auto interfaces = idx->get_type_list(cdef->interfaces_off);
+  if (loaded->get_interfaces() != interfaces) {
+    describe("interfaces: ", show(loaded->get_interfaces()), " vs ",
+             show(interfaces));
+  }
+
+  // Fields and methods are interned, so the duplicate definition refers to the
+  // same members as the loaded class whenever their signatures agree.
+  std::unordered_map<const DexFieldRef*, DexAccessFlags> fields;
+  for (const auto* field : loaded->get_all_fields()) {
+    fields.emplace(field, field->get_access());
+  }
+  std::unordered_map<const DexMethodRef*, const DexMethod*> methods;
+  for (const auto* method : loaded->get_all_methods()) {
+    methods.emplace(method, method);
+  }
+
+  const uint8_t* encd = cdef->class_data_offset == 0
+                            ? nullptr
+                            : idx->get_uleb_data(cdef->class_data_offset);
+  uint32_t counts[4] = {0, 0, 0, 0};
+  if (encd != nullptr) {
+    for (auto& count : counts) {
+      always_assert(encd < idx->end());
+      count = read_uleb128(&encd);
+    }
+  }
+  for (uint32_t kind = 0; kind < 2; ++kind) {
+    uint32_t ndex = 0;
+    for (uint32_t i = 0; i < counts[kind]; ++i) {
+      always_assert(encd < idx->end());
+      ndex += read_uleb128(&encd);
+      always_assert(encd < idx->end());
+      auto access_flags = (DexAccessFlags)read_uleb128(&encd);
+      auto* field = idx->get_fieldidx(ndex);
+      auto it = fields.find(field);
+      if (it == fields.end()) {
+        describe("field only in the duplicate: ", show(field));
+        continue;
+      }
+      if (it->second != access_flags) {
+        describe("access flags of ", show(field), ": 0x", std::hex,
+                 it->second, " vs 0x", access_flags);
+      }
+      fields.erase(it);
+    }
+  }
+  for (uint32_t kind = 2; kind < 4; ++kind) {
+    uint32_t ndex = 0;
+    for (uint32_t i = 0; i < counts[kind]; ++i) {
+      always_assert(encd < idx->end());
+      ndex += read_uleb128(&encd);
+      always_assert(encd < idx->end());
+      auto access_flags = (DexAccessFlags)read_uleb128(&encd);
+      always_assert(encd < idx->end());
+      uint32_t code_off = read_uleb128(&encd);
+      auto* method = idx->get_methodidx(ndex);
+      auto it = methods.find(method);
+      if (it == methods.end()) {
+        describe("method only in the duplicate: ", show(method));
+        continue;
+      }
+      const auto* loaded_method = it->second;
+      if (loaded_method->get_access() != access_flags) {
+        describe("access flags of ", show(method), ": 0x", std::hex,
+                 loaded_method->get_access(), " vs 0x", access_flags);
+      }
+      // The code of the loaded method is only comparable as long as it has
+      // not been converted to IR.
+      if (loaded_method->get_code() == nullptr &&
+          !same_code(loaded_method->get_dex_code(),
+                     DexCode::get_dex_code(idx, code_off).get())) {
+        describe("code of ", show(method));
+      }
+      methods.erase(it);
+    }
+  }
+  for (const auto& [field, _] : fields) {
+    describe("field only in the loaded class: ", show(field));
+  }
+  for (const auto& [method, _] : methods) {
+    describe("method only in the loaded class: ", show(method));
+  }
+  return diffs;
+}
+
 } // namespace dup_classes
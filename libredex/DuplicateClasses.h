@@ -5,6 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#pragma once
+
+#include <string>
+#include <vector>
+
 #include "DexClass.h"
 #include "JsonWrapper.h"
 
@@ -17,4 +22,13 @@ void read_dup_class_allowlist(const JsonWrapper& json_cfg);
 // classes.
 bool is_known_dup(DexClass* cls);
 
+// Compare a loaded class with another definition of it, read from `idx`,
+// without loading that definition. Access flags, super class, interfaces,
+// and the fields and methods with their access flags and code are compared.
+// Return a description of each difference; an empty vector means that the
+// definitions are identical.
+std::vector<std::string> compare_class_defs(const DexClass* loaded,
+                                            DexIdx* idx,
+                                            const dex_class_def* cdef);
+
 } // namespace dup_classes
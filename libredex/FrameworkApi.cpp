@@ -7,11 +7,16 @@
 
 #include "FrameworkApi.h"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
 #include <fstream>
 #include <istream>
 #include <sstream>
 
+#include "Show.h"
+
 namespace api {
 
 bool FrameworkAPI::has_method(const std::string& simple_deobfuscated_name,
@@ -143,6 +148,84 @@ void parse_framework_description(
                     "Failed to load any class from the framework api file");
 }
 
+constexpr std::string_view kBinaryMagic{"RDXAPIv1"};
+
+// Reads the binary format described in FrameworkApi.h. All strings are views
+// into `data`.
+class BinaryReader {
+ public:
+  explicit BinaryReader(std::string_view data) : m_data(data) {}
+
+  bool at_end() const { return m_pos == m_data.size(); }
+
+  uint32_t read_u4() {
+    always_assert_log(m_pos + 4 <= m_data.size(),
+                      "Truncated framework api index");
+    auto* bytes = reinterpret_cast<const uint8_t*>(m_data.data() + m_pos);
+    m_pos += 4;
+    return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) |
+           (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+  }
+
+  std::string_view read_str() {
+    auto size = read_u4();
+    always_assert_log(m_pos + size <= m_data.size(),
+                      "Truncated framework api index");
+    auto str = m_data.substr(m_pos, size);
+    m_pos += size;
+    return str;
+  }
+
+  std::string_view read_bytes(size_t size) {
+    always_assert_log(m_pos + size <= m_data.size(),
+                      "Truncated framework api index");
+    auto bytes = m_data.substr(m_pos, size);
+    m_pos += size;
+    return bytes;
+  }
+
+ private:
+  std::string_view m_data;
+  size_t m_pos{0};
+};
+
+void parse_binary_framework_description(
+    std::string_view data,
+    std::unordered_map<const DexType*, FrameworkAPI>* framework_classes) {
+  BinaryReader reader(data);
+  always_assert_log(reader.read_bytes(kBinaryMagic.size()) == kBinaryMagic,
+                    "Not a framework api index");
+  auto num_classes = reader.read_u4();
+  framework_classes->reserve(num_classes);
+  while (num_classes-- > 0) {
+    FrameworkAPI framework_api;
+    framework_api.cls = DexType::make_type(reader.read_str());
+    always_assert_log(framework_classes->count(framework_api.cls) == 0,
+                      "Duplicated class name!");
+    framework_api.access_flags = DexAccessFlags(reader.read_u4());
+    framework_api.super_cls = DexType::make_type(reader.read_str());
+    auto num_methods = reader.read_u4();
+    auto num_fields = reader.read_u4();
+    framework_api.mrefs_info.reserve(num_methods);
+    while (num_methods-- > 0) {
+      auto* mref = DexMethod::make_method(reader.read_str());
+      framework_api.mrefs_info.emplace_back(mref,
+                                            DexAccessFlags(reader.read_u4()));
+    }
+    framework_api.frefs_info.reserve(num_fields);
+    while (num_fields-- > 0) {
+      auto* fref = DexField::make_field(reader.read_str());
+      framework_api.frefs_info.emplace_back(fref,
+                                            DexAccessFlags(reader.read_u4()));
+    }
+    auto cls = framework_api.cls;
+    framework_classes->emplace(cls, std::move(framework_api));
+  }
+  always_assert_log(reader.at_end(), "Trailing data in framework api index");
+  always_assert_log(!framework_classes->empty(),
+                    "Failed to load any class from the framework api file");
+}
+
 } // namespace
 
 AndroidSDK AndroidSDK::from_string(const std::string& input) {
@@ -155,11 +238,64 @@ AndroidSDK AndroidSDK::from_string(const std::string& input) {
 }
 
 void AndroidSDK::load_framework_classes() {
-  std::ifstream infile(m_sdk_api_file.c_str());
-  assert_log(infile, "Failed to open framework api file: %s\n",
-             m_sdk_api_file.c_str());
+  {
+    std::ifstream infile(m_sdk_api_file.c_str(), std::ifstream::binary);
+    assert_log(infile, "Failed to open framework api file: %s\n",
+               m_sdk_api_file.c_str());
+    char magic[kBinaryMagic.size()];
+    if (!infile.read(magic, sizeof(magic)) ||
+        std::string_view(magic, sizeof(magic)) != kBinaryMagic) {
+      infile.clear();
+      infile.seekg(0);
+      parse_framework_description(infile, &m_framework_classes);
+      return;
+    }
+  }
+  boost::iostreams::mapped_file_source file(m_sdk_api_file);
+  parse_binary_framework_description(
+      std::string_view(file.data(), file.size()), &m_framework_classes);
+}
+
+void AndroidSDK::write_binary_index(const std::string& path) const {
+  std::ofstream out(path, std::ofstream::binary);
+  auto write_u4 = [&out](uint32_t value) {
+    uint8_t bytes[4] = {uint8_t(value), uint8_t(value >> 8),
+                        uint8_t(value >> 16), uint8_t(value >> 24)};
+    out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+  };
+  auto write_str = [&](std::string_view str) {
+    write_u4(str.size());
+    out.write(str.data(), str.size());
+  };
+
+  std::vector<const FrameworkAPI*> apis;
+  apis.reserve(m_framework_classes.size());
+  for (const auto& [_, api] : m_framework_classes) {
+    apis.push_back(&api);
+  }
+  std::sort(apis.begin(), apis.end(), [](const auto* a, const auto* b) {
+    return compare_dextypes(a->cls, b->cls);
+  });
 
-  parse_framework_description(infile, &m_framework_classes);
+  out.write(kBinaryMagic.data(), kBinaryMagic.size());
+  write_u4(apis.size());
+  for (const auto* api : apis) {
+    write_str(api->cls->str());
+    write_u4(api->access_flags);
+    write_str(api->super_cls->str());
+    write_u4(api->mrefs_info.size());
+    write_u4(api->frefs_info.size());
+    for (const auto& info : api->mrefs_info) {
+      write_str(show(info.mref));
+      write_u4(info.access_flags);
+    }
+    for (const auto& info : api->frefs_info) {
+      write_str(show(info.fref));
+      write_u4(info.access_flags);
+    }
+  }
+  always_assert_log(out.good(), "Could not write framework api index to %s",
+                    path.c_str());
 }
 
 } // namespace api
@@ -44,6 +44,27 @@ struct FrameworkAPI {
                  bool relax_access_flags_matching = false) const;
 };
 
+/*
+ * The framework API of an Android SDK level, loaded from an API file.
+ *
+ * API files come in two formats, told apart by their first bytes:
+ *
+ * - The text format generated by dex.py: per class, a line
+ *   `<type> <access> <super type> <#methods> <#fields>`, followed by one
+ *   `M <method descriptor> <access>` line per method and one
+ *   `F <field descriptor> <access>` line per field.
+ * - A binary index of the same content (see `write_binary_index` and
+ *   gen_binary_api_index.py), meant to be generated once per API level. It is
+ *   memory-mapped and read front to back, without any tokenization or copying
+ *   of strings. It starts with the 8 bytes `RDXAPIv1` and a `u4` class count,
+ *   followed by per-class records `str type, u4 access, str super type,
+ *   u4 #methods, u4 #fields`, each followed by their `str descriptor,
+ *   u4 access` member records. A `u4` is a little-endian uint32_t, and a `str`
+ *   is a `u4` length followed by that many bytes.
+ *
+ * Either way, the types and member references get interned into the
+ * RedexContext while loading.
+ */
 class AndroidSDK {
   AndroidSDK() = default;
 
@@ -60,6 +81,9 @@ class AndroidSDK {
 
   static AndroidSDK from_string(const std::string& input);
 
+  // Writes the loaded API in the binary format, with classes sorted by name.
+  void write_binary_index(const std::string& path) const;
+
   const std::unordered_map<const DexType*, FrameworkAPI>&
   get_framework_classes() const {
     return m_framework_classes;
@@ -8,6 +8,7 @@
 #include "FrequentlyUsedPointersCache.h"
 
 #include "DexClass.h"
+#include "RedexContext.h"
 
 void FrequentlyUsedPointers::load() {
 #define LOAD_FREQUENTLY_USED_TYPE(func_name, java_name) \
@@ -30,3 +31,24 @@ void FrequentlyUsedPointers::load() {
   WELL_KNOWN_METHODS
 #undef FOR_EACH
 }
+
+#define LOOKUP_OPTIONAL_TYPE(func_name, java_name)                     \
+  DexType* FrequentlyUsedPointers::optional_type_##func_name() const { \
+    return m_optional_type_##func_name.get(                            \
+        RedexContext::hierarchy_generation(),                          \
+        [] { return DexType::get_type(java_name); });                  \
+  }
+#define FOR_EACH LOOKUP_OPTIONAL_TYPE
+OPTIONAL_WELL_KNOWN_TYPES
+#undef FOR_EACH
+
+#define LOOKUP_OPTIONAL_METHOD(func_name, java_name)                        \
+  DexMethod* FrequentlyUsedPointers::optional_method_##func_name() const {  \
+    return m_optional_method_##func_name.get(                               \
+        RedexContext::hierarchy_generation(), [] {                          \
+          return static_cast<DexMethod*>(DexMethod::get_method(java_name)); \
+        });                                                                 \
+  }
+#define FOR_EACH LOOKUP_OPTIONAL_METHOD
+OPTIONAL_WELL_KNOWN_METHODS
+#undef FOR_EACH
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
 #include <unordered_set>
 
 #include "WellKnownTypes.h"
@@ -15,6 +19,42 @@ class DexType;
 class DexFieldRef;
 class DexMethod;
 
+// A pointer that was looked up by name, valid as long as
+// RedexContext::hierarchy_generation() does not change, with the same caveats
+// as the resolver cache (see Resolver.h). Only successful lookups are cached,
+// since the object may still be created later.
+template <typename T>
+class GenerationCachedPointer {
+ public:
+  template <typename Lookup>
+  T* get(uint64_t generation, const Lookup& lookup) const {
+    // A seqlock: a writer invalidates the generation before storing the
+    // pointer, so that a reader never pairs a pointer with a wrong generation.
+    if (m_generation.load() == generation) {
+      auto* ptr = m_ptr.load();
+      if (m_generation.load() == generation) {
+        return ptr;
+      }
+    }
+    auto* ptr = lookup();
+    if (ptr != nullptr) {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_generation.store(kInvalidGeneration);
+      m_ptr.store(ptr);
+      m_generation.store(generation);
+    }
+    return ptr;
+  }
+
+ private:
+  static constexpr uint64_t kInvalidGeneration =
+      std::numeric_limits<uint64_t>::max();
+
+  mutable std::mutex m_lock;
+  mutable std::atomic<uint64_t> m_generation{kInvalidGeneration};
+  mutable std::atomic<T*> m_ptr{nullptr};
+};
+
 #define STORE_TYPE(func_name, _)         \
  private:                                \
   DexType* m_type_##func_name = nullptr; \
@@ -36,8 +76,23 @@ class DexMethod;
  public:                                     \
   DexMethod* method_##func_name() const { return m_method_##func_name; }
 
+#define STORE_OPTIONAL_TYPE(func_name, _)                          \
+ private:                                                           \
+  GenerationCachedPointer<DexType> m_optional_type_##func_name;     \
+                                                                    \
+ public:                                                            \
+  DexType* optional_type_##func_name() const;
+
+#define STORE_OPTIONAL_METHOD(func_name, _)                         \
+ private:                                                           \
+  GenerationCachedPointer<DexMethod> m_optional_method_##func_name; \
+                                                                    \
+ public:                                                            \
+  DexMethod* optional_method_##func_name() const;
+
 // The class is designed to cache frequently used pointers while invalidate them
-// when RedexContext lifetime is over.
+// when RedexContext lifetime is over. The optional ones are looked up on
+// demand instead of being created by load().
 class FrequentlyUsedPointers {
  public:
   void load();
@@ -54,9 +109,19 @@ class FrequentlyUsedPointers {
   WELL_KNOWN_METHODS
 #undef FOR_EACH
 
+#define FOR_EACH STORE_OPTIONAL_TYPE
+  OPTIONAL_WELL_KNOWN_TYPES
+#undef FOR_EACH
+
+#define FOR_EACH STORE_OPTIONAL_METHOD
+  OPTIONAL_WELL_KNOWN_METHODS
+#undef FOR_EACH
+
   std::unordered_set<const DexType*> m_well_known_types;
 };
 
 #undef STORE_TYPE
 #undef STORE_FIELDREF
 #undef STORE_METHOD
+#undef STORE_OPTIONAL_TYPE
+#undef STORE_OPTIONAL_METHOD
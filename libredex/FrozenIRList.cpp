@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "FrozenIRList.h"
+
+#include <unordered_map>
+
+#include "ControlFlow.h"
+#include "Debug.h"
+#include "IRCode.h"
+
+FrozenIRList::FrozenIRList(const IRCode& code) {
+  always_assert(!code.editable_cfg_built());
+  std::unordered_map<const MethodItemEntry*, uint32_t> insn_indices;
+  // Branches whose targets precede the next instruction.
+  std::vector<const MethodItemEntry*> pending;
+  // (branch, index of target instruction) pairs.
+  std::vector<std::pair<const MethodItemEntry*, uint32_t>> edges;
+  for (const auto& mie : code) {
+    if (mie.type == MFLOW_TARGET) {
+      pending.push_back(mie.target->src);
+    } else if (mie.type == MFLOW_OPCODE) {
+      uint32_t idx = m_insns.size();
+      for (const auto* src : pending) {
+        edges.emplace_back(src, idx);
+      }
+      pending.clear();
+      insn_indices.emplace(&mie, idx);
+      m_insns.push_back(mie.insn);
+    }
+  }
+
+  std::vector<std::vector<uint32_t>> targets(m_insns.size());
+  for (const auto& [src, target] : edges) {
+    auto it = insn_indices.find(src);
+    if (it != insn_indices.end()) {
+      targets[it->second].push_back(target);
+    }
+  }
+  m_insn_target_offsets.reserve(m_insns.size() + 1);
+  m_insn_target_offsets.push_back(0);
+  for (const auto& insn_targets : targets) {
+    m_indices.insert(m_indices.end(), insn_targets.begin(), insn_targets.end());
+    m_insn_target_offsets.push_back(m_indices.size());
+  }
+}
+
+FrozenIRList::FrozenIRList(const cfg::ControlFlowGraph& cfg) {
+  auto blocks = cfg.blocks();
+  std::unordered_map<const cfg::Block*, uint32_t> block_indices;
+  block_indices.reserve(blocks.size());
+  for (auto* block : blocks) {
+    block_indices.emplace(block, block_indices.size());
+  }
+
+  m_insns.reserve(cfg.num_opcodes());
+  m_block_offsets.reserve(blocks.size() + 1);
+  m_block_succ_offsets.reserve(blocks.size() + 1);
+  m_block_offsets.push_back(0);
+  m_block_succ_offsets.push_back(0);
+  for (auto* block : blocks) {
+    for (const auto& mie : InstructionIterable(block)) {
+      m_insns.push_back(mie.insn);
+    }
+    m_block_offsets.push_back(m_insns.size());
+    for (const auto* edge : block->succs()) {
+      m_indices.push_back(block_indices.at(edge->target()));
+    }
+    m_block_succ_offsets.push_back(m_indices.size());
+  }
+}
+
+bool FrozenIRList::is_stale(const IRCode& code) const {
+  return code.count_opcodes() != size();
+}
+
+bool FrozenIRList::is_stale(const cfg::ControlFlowGraph& cfg) const {
+  return cfg.num_blocks() != num_blocks() || cfg.num_opcodes() != size();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class IRCode;
+class IRInstruction;
+
+namespace cfg {
+class ControlFlowGraph;
+} // namespace cfg
+
+/*
+ * An immutable, contiguous view of the instructions of a method, for
+ * read-mostly analyses that walk the same code over and over.
+ *
+ * Iterating an IRList chases one pointer per MethodItemEntry and skips over
+ * positions, debug info, source blocks and the like. A FrozenIRList copies the
+ * instruction pointers out once, in iteration order, into a single array.
+ * Control flow is kept as indices into that array:
+ *
+ * - When built from linear IRCode, `targets(i)` lists the indices of the
+ *   instructions that the branch at index `i` may jump to.
+ * - When built from a CFG, the instructions of each block are contiguous, and
+ *   `successors(b)` lists the (frozen) indices of the successor blocks of the
+ *   b-th block.
+ *
+ * The view does not own the instructions: in-place changes of an
+ * IRInstruction are visible through it, but adding, removing or moving
+ * instructions or blocks invalidates it. There is no tracking of such
+ * mutations in IRList itself; the `is_stale` overloads catch the common case
+ * of a changed instruction count, and are meant for assertions.
+ */
+class FrozenIRList {
+ public:
+  struct IndexRange {
+    using value_type = uint32_t;
+    using const_iterator = const uint32_t*;
+
+    const uint32_t* first;
+    const uint32_t* last;
+
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+  };
+
+  // `code` must not have an editable CFG; use the CFG constructor for that.
+  explicit FrozenIRList(const IRCode& code);
+  explicit FrozenIRList(const cfg::ControlFlowGraph& cfg);
+
+  size_t size() const { return m_insns.size(); }
+  bool empty() const { return m_insns.empty(); }
+  IRInstruction* operator[](size_t i) const { return m_insns[i]; }
+  IRInstruction* const* begin() const { return m_insns.data(); }
+  IRInstruction* const* end() const { return m_insns.data() + m_insns.size(); }
+
+  // Only for views built from linear IRCode.
+  IndexRange targets(size_t insn_idx) const {
+    return range(m_insn_target_offsets, insn_idx);
+  }
+
+  // Only for views built from a CFG. Blocks are numbered in the order of
+  // `cfg.blocks()`.
+  size_t num_blocks() const {
+    return m_block_offsets.empty() ? 0 : m_block_offsets.size() - 1;
+  }
+  size_t block_begin(size_t block_idx) const {
+    return m_block_offsets[block_idx];
+  }
+  size_t block_end(size_t block_idx) const {
+    return m_block_offsets[block_idx + 1];
+  }
+  IndexRange successors(size_t block_idx) const {
+    return range(m_block_succ_offsets, block_idx);
+  }
+
+  bool is_stale(const IRCode& code) const;
+  bool is_stale(const cfg::ControlFlowGraph& cfg) const;
+
+ private:
+  IndexRange range(const std::vector<uint32_t>& offsets, size_t idx) const {
+    if (offsets.empty()) {
+      return {nullptr, nullptr};
+    }
+    return {m_indices.data() + offsets[idx],
+            m_indices.data() + offsets[idx + 1]};
+  }
+
+  std::vector<IRInstruction*> m_insns;
+  // All index lists, back to back; the *_offsets vectors delimit them.
+  std::vector<uint32_t> m_indices;
+  std::vector<uint32_t> m_insn_target_offsets;
+  std::vector<uint32_t> m_block_offsets;
+  std::vector<uint32_t> m_block_succ_offsets;
+};
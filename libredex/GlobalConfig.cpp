@@ -45,6 +45,9 @@ void InlinerConfig::bind_config() {
 void OptDecisionsConfig::bind_config() {
   bind("enable_logs", false, enable_logs,
        "Should we log Redex's optimization decisions?");
+  bind("compress_output", false, compress_output,
+       "Whether to write the optimization decisions gzipped, without "
+       "indentation.");
 }
 
 void IRTypeCheckerConfig::bind_config() {
@@ -56,6 +59,10 @@ void IRTypeCheckerConfig::bind_config() {
   bind("annotated_cfg_on_error", annotated_cfg_on_error,
        annotated_cfg_on_error);
   bind("check_classes", {}, check_classes);
+  bind("skip_unchanged_methods", false, skip_unchanged_methods,
+       "Skip methods whose code has not changed since they last passed. "
+       "Faster, but misses errors caused only by changes elsewhere, e.g. to "
+       "the class hierarchy.");
 }
 
 void HasherConfig::bind_config() {
@@ -84,6 +91,7 @@ void MethodProfileOrderingConfig::bind_config() {
        second_min_appear_percent);
   bind("skip_similarity_reordering", skip_similarity_reordering,
        skip_similarity_reordering);
+  bind("appear_buckets", appear_buckets, appear_buckets);
 }
 
 void MethodSimilarityOrderingConfig::bind_config() {
@@ -110,7 +118,42 @@ void PassManagerConfig::bind_config() {
   bind("check_pass_order_properties", check_pass_order_properties,
        check_pass_order_properties);
   bind("check_properties_deep", check_properties_deep, check_properties_deep);
+  bind("check_properties_skip_unchanged_methods",
+       check_properties_skip_unchanged_methods,
+       check_properties_skip_unchanged_methods,
+       "Whether deep property checks skip methods whose code did not change "
+       "since they last passed the same checks.");
   bind("dump_mrefs", dump_mrefs, dump_mrefs);
+  bind("incremental_cache_dir", incremental_cache_dir, incremental_cache_dir,
+       "Directory of the on-disk cache used to skip passes that were a no-op "
+       "on the same input in a previous run.");
+  bind("track_changed_methods", track_changed_methods, track_changed_methods,
+       "Report per-pass metrics of the methods each pass added, removed or "
+       "changed.");
+  bind("max_concurrent_code_units", max_concurrent_code_units,
+       max_concurrent_code_units,
+       "Upper bound on the summed code size, in code units, of the classes "
+       "that size-weighted parallel walks process at the same time. Bounds "
+       "the peak memory of analyses whose memory grows with method size "
+       "without lowering the thread count. 0 means no limit.");
+  bind("release_detached_code_after_passes",
+       release_detached_code_after_passes, release_detached_code_after_passes,
+       "Names of passes after which the code of methods that were removed "
+       "from their class but not deleted is freed, e.g. after passes that "
+       "remove many methods. Reports the released code size as metrics.");
+  bind("profile_passes", profile_passes, profile_passes,
+       "Names of passes to run under the profiler given by profile_command. "
+       "Every run of such a pass writes its own profile to the meta "
+       "directory.");
+  bind("profile_command", profile_command, profile_command,
+       "Command that starts the profiler. The process id is appended, and "
+       "{data} is replaced by the profile file of the pass run. It is "
+       "stopped with SIGINT when the pass finishes.");
+  bind("profile_post_command", profile_post_command, profile_post_command,
+       "Command run on the profile of each profiled pass run, with {data} "
+       "replaced and the profile file appended. The default writes the "
+       "symbolized stacks next to the profile, ready for a flamegraph tool. "
+       "Empty to skip.");
 }
 
 void ResourceConfig::bind_config() {
@@ -179,8 +222,10 @@ void GlobalConfig::bind_config() {
   bind("no_optimizations_blocklist", {}, string_vector_param);
   bind("preserve_input_dexes", {}, bool_param);
   bind("proguard_map", "", string_param);
+  bind("profile_guided_block_layout", {}, bool_param);
   bind("prune_unexported_components", {}, string_vector_param);
   bind("pure_methods", {}, string_vector_param);
+  bind("pure_methods_file", "", string_param);
   bind("finalish_field_names", {}, string_vector_param);
   bind("record_keep_reasons", {}, bool_param);
   bind("dump_keep_reasons", {}, bool_param);
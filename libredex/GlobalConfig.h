@@ -39,6 +39,7 @@ struct IRTypeCheckerConfig : public Configurable {
   bool check_no_overwrite_this;
   bool annotated_cfg_on_error{false};
   bool check_classes;
+  bool skip_unchanged_methods{false};
 };
 
 struct HasherConfig : public Configurable {
@@ -95,6 +96,7 @@ struct OptDecisionsConfig : public Configurable {
   }
 
   bool enable_logs;
+  bool compress_output;
 };
 
 struct MethodProfileOrderingConfig : public Configurable {
@@ -112,6 +114,10 @@ struct MethodProfileOrderingConfig : public Configurable {
   float min_appear_percent{10.0f};
   float second_min_appear_percent{10.0f};
   bool skip_similarity_reordering{false};
+  // Lower bounds of the cold-start appear100 buckets used by
+  // method_appear_bucket_order, in decreasing order. min_appear_percent
+  // bounds the last bucket.
+  std::vector<unsigned int> appear_buckets{90, 50};
 };
 
 struct MethodSimilarityOrderingConfig : public Configurable {
@@ -158,7 +164,28 @@ struct PassManagerConfig : public Configurable {
   bool violations_tracking{false};
   bool check_pass_order_properties{false};
   bool check_properties_deep{false};
+  // Whether deep property checks skip methods that did not change since
+  // they were last checked.
+  bool check_properties_skip_unchanged_methods{false};
   bool dump_mrefs{false};
+  // If non-empty, passes that support it are skipped when a previous run
+  // recorded in this directory found them to be a no-op on the same input.
+  std::string incremental_cache_dir;
+  // Whether to report the number of methods each pass added, removed or
+  // changed.
+  bool track_changed_methods{false};
+  // Upper bound on the summed code size of the classes that size-weighted
+  // parallel walks process at the same time; 0 for no limit.
+  uint64_t max_concurrent_code_units{0};
+  // Passes after which the code of methods that no longer belong to any class
+  // is freed.
+  std::unordered_set<std::string> release_detached_code_after_passes;
+  // Passes to run under a sampling profiler, and the commands to start it and
+  // to process its output.
+  std::unordered_set<std::string> profile_passes;
+  std::string profile_command{"perf record -g -o {data} -p"};
+  std::string profile_post_command{
+      "sh -c 'perf script -i \"$0\" > \"$0.script\"'"};
 };
 
 struct ResourceConfig : public Configurable {
@@ -7,7 +7,9 @@
 
 #include "IODIMetadata.h"
 
+#include <algorithm>
 #include <fstream>
+#include <vector>
 
 #include "DexOutput.h"
 #include "DexUtil.h"
@@ -169,6 +171,9 @@ void IODIMetadata::write(
    *  method_id: uint64_t
    *  key: char[klen]
    * }
+   * The entries are sorted by key, so that the output is deterministic and a
+   * symbolicator can look up a method in the mapped file with a binary search
+   * over an offset index, instead of first loading every entry.
    */
   struct __attribute__((__packed__)) Header {
     uint32_t magic;
@@ -192,19 +197,31 @@ void IODIMetadata::write(
   size_t max_layer{0};
   size_t layered_count{0};
 
+  std::vector<std::pair<std::string, uint64_t>> entries;
+  entries.reserve(m_iodi_method_layers.size());
   for (const auto& [method, layer] : m_iodi_method_layers) {
     count += 1;
     always_assert_log(count != 0, "Too many entries found, overflowed");
 
     redex_assert(layer < DexOutput::kIODILayerBound);
+    if (layer > 0) {
+      layered_count++;
+      max_layer = std::max(max_layer, layer);
+    }
 
     auto name = get_iodi_name(method);
     std::string tmp;
     const std::string& layered_name = get_layered_name(name, layer, tmp);
 
     always_assert(layered_name.size() < UINT16_MAX);
+    entries.emplace_back(layered_name,
+                         method_to_id.at(const_cast<DexMethod*>(method)));
+  }
+  std::sort(entries.begin(), entries.end());
+
+  for (const auto& [layered_name, method_id] : entries) {
     entry_hdr.klen = layered_name.size();
-    entry_hdr.method_id = method_to_id.at(const_cast<DexMethod*>(method));
+    entry_hdr.method_id = method_id;
     ofs.write((const char*)&entry_hdr, sizeof(EntryHeader));
     ofs << layered_name;
   }
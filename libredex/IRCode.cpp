@@ -1227,6 +1227,15 @@ size_t IRCode::count_opcodes() const {
   return m_ir_list->count_opcodes();
 }
 
+size_t IRCode::estimate_size_quickly() const {
+  if (editable_cfg_built()) {
+    // Blocks typically hold a handful of instructions.
+    constexpr size_t kEntriesPerBlock = 4;
+    return m_cfg->num_blocks() * kEntriesPerBlock;
+  }
+  return m_ir_list->size();
+}
+
 bool IRCode::has_try_blocks() const {
   if (editable_cfg_built()) {
     auto b = this->cfg().blocks();
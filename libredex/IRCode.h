@@ -298,6 +298,13 @@ class IRCode {
    */
   size_t count_opcodes() const;
 
+  /*
+   * Returns a rough constant-time estimate of the size of the code, e.g. to be
+   * used as a cost hint for load balancing. Unlike the functions above, this
+   * does not visit the instructions.
+   */
+  size_t estimate_size_quickly() const;
+
   void sanity_check() const { m_ir_list->sanity_check(); }
 
   bool has_try_blocks() const;
@@ -17,35 +17,35 @@
 #include <boost/range/any_range.hpp>
 #include <cstring>
 #include <iterator>
+#include <limits>
 
 IRInstruction::IRInstruction(IROpcode op) : m_opcode(op) {
   auto count = opcode_impl::min_srcs_size(op);
-  if (count <= MAX_NUM_INLINE_SRCS) {
-    m_num_inline_srcs = count;
-  } else {
-    m_num_inline_srcs = MAX_NUM_INLINE_SRCS + 1;
-    m_srcs = new std::vector<reg_t>(count);
+  m_num_srcs = count;
+  if (count > MAX_NUM_INLINE_SRCS) {
+    m_srcs = new reg_t[count]();
   }
 }
 
 IRInstruction::IRInstruction(const IRInstruction& other)
     : m_opcode(other.m_opcode),
-      m_num_inline_srcs(other.m_num_inline_srcs),
+      m_num_srcs(other.m_num_srcs),
       m_dest(other.m_dest),
       m_literal(other.m_literal) {
   always_assert(!other.has_data());
-  if (m_num_inline_srcs <= MAX_NUM_INLINE_SRCS) {
-    for (auto i = 0; i < m_num_inline_srcs; ++i) {
+  if (m_num_srcs <= MAX_NUM_INLINE_SRCS) {
+    for (auto i = 0; i < m_num_srcs; ++i) {
       m_inline_srcs[i] = other.m_inline_srcs[i];
     }
   } else {
-    m_srcs = new std::vector<reg_t>(*other.m_srcs);
+    m_srcs = new reg_t[m_num_srcs];
+    std::memcpy(m_srcs, other.m_srcs, m_num_srcs * sizeof(reg_t));
   }
 }
 
 IRInstruction::~IRInstruction() {
-  if (m_num_inline_srcs > MAX_NUM_INLINE_SRCS) {
-    delete m_srcs;
+  if (m_num_srcs > MAX_NUM_INLINE_SRCS) {
+    delete[] m_srcs;
   }
   if (has_data()) {
     delete m_data;
@@ -64,41 +64,24 @@ IRInstruction* IRInstruction::set_data(std::unique_ptr<DexOpcodeData> data) {
 bool IRInstruction::operator==(const IRInstruction& that) const {
   bool simple_fields_match =
       m_opcode == that.m_opcode &&
-      m_num_inline_srcs == that.m_num_inline_srcs && m_dest == that.m_dest &&
+      m_num_srcs == that.m_num_srcs && m_dest == that.m_dest &&
       m_literal == that.m_literal; // just test one member of the union
   if (!simple_fields_match) {
     return false;
   }
   // Check the source registers union
-  if (m_num_inline_srcs <= MAX_NUM_INLINE_SRCS) {
-    for (auto i = 0; i < m_num_inline_srcs; ++i) {
-      if (m_inline_srcs[i] != that.m_inline_srcs[i]) {
-        return false;
-      }
-    }
-    return true;
-  } else {
-    return *m_srcs == *that.m_srcs;
-  }
+  return std::memcmp(srcs_data(), that.srcs_data(),
+                     m_num_srcs * sizeof(reg_t)) == 0;
 }
 
 reg_t IRInstruction::src(src_index_t i) const {
-  if (m_num_inline_srcs <= MAX_NUM_INLINE_SRCS) {
-    always_assert(i < m_num_inline_srcs);
-    return m_inline_srcs[i];
-  }
-  return m_srcs->at(i);
+  always_assert(i < m_num_srcs);
+  return srcs_data()[i];
 }
 
 IRInstruction::reg_range IRInstruction::srcs() const {
-  if (m_num_inline_srcs <= MAX_NUM_INLINE_SRCS) {
-    const reg_t* begin = std::begin(m_inline_srcs);
-    const reg_t* end = begin + m_num_inline_srcs;
-    return reg_range(begin, end);
-  }
-  const reg_t* begin = m_srcs->data();
-  const reg_t* end = begin + m_srcs->size();
-  return reg_range(begin, end);
+  const reg_t* begin = srcs_data();
+  return reg_range(begin, begin + m_num_srcs);
 }
 
 std::vector<reg_t> IRInstruction::srcs_vec() const {
@@ -111,51 +94,42 @@ std::vector<reg_t> IRInstruction::srcs_vec() const {
 }
 
 IRInstruction* IRInstruction::set_src(src_index_t i, reg_t reg) {
-  if (m_num_inline_srcs <= MAX_NUM_INLINE_SRCS) {
-    always_assert(i < m_num_inline_srcs);
-    m_inline_srcs[i] = reg;
-  } else {
-    m_srcs->at(i) = reg;
-  }
+  always_assert(i < m_num_srcs);
+  srcs_data()[i] = reg;
   return this;
 }
 
-size_t IRInstruction::srcs_size() const {
-  if (m_num_inline_srcs <= MAX_NUM_INLINE_SRCS) {
-    return m_num_inline_srcs;
-  }
-  return m_srcs->size();
-}
+size_t IRInstruction::srcs_size() const { return m_num_srcs; }
 
 IRInstruction* IRInstruction::set_srcs_size(size_t count) {
-  if (m_num_inline_srcs <= MAX_NUM_INLINE_SRCS) {
-    if (count <= MAX_NUM_INLINE_SRCS) {
-      // staying in the inline state
-      m_num_inline_srcs = count;
-    } else {
-      // inline regs -> vector
-      auto srcs = new std::vector<reg_t>();
-      srcs->reserve(count);
-      for (auto i = 0; i < m_num_inline_srcs; ++i) {
-        srcs->push_back(m_inline_srcs[i]);
-      }
-      srcs->resize(count);
-      m_num_inline_srcs = MAX_NUM_INLINE_SRCS + 1;
-      m_srcs = srcs;
-    }
+  always_assert(count <= std::numeric_limits<uint16_t>::max());
+  if (count == m_num_srcs) {
+    return this;
+  }
+  if (m_num_srcs <= MAX_NUM_INLINE_SRCS && count <= MAX_NUM_INLINE_SRCS) {
+    // staying in the inline state
+    m_num_srcs = count;
+    return this;
+  }
+  // Moving to, from or between out-of-line arrays. New registers are zero.
+  reg_t old_srcs[MAX_NUM_INLINE_SRCS];
+  reg_t* old_data = srcs_data();
+  if (m_num_srcs <= MAX_NUM_INLINE_SRCS) {
+    std::memcpy(old_srcs, m_inline_srcs, m_num_srcs * sizeof(reg_t));
+    old_data = old_srcs;
+  }
+  size_t keep = std::min<size_t>(count, m_num_srcs);
+  if (count <= MAX_NUM_INLINE_SRCS) {
+    std::memcpy(m_inline_srcs, old_data, keep * sizeof(reg_t));
   } else {
-    if (count <= MAX_NUM_INLINE_SRCS) {
-      // vector -> inline regs
-      auto old_srcs_ptr = m_srcs;
-      m_num_inline_srcs = count;
-      always_assert(count <= old_srcs_ptr->size());
-      std::memcpy(m_inline_srcs, old_srcs_ptr->data(), count * sizeof(reg_t));
-      delete old_srcs_ptr;
-    } else {
-      // staying in the vector state
-      m_srcs->resize(count);
-    }
+    auto* srcs = new reg_t[count]();
+    std::memcpy(srcs, old_data, keep * sizeof(reg_t));
+    m_srcs = srcs;
+  }
+  if (old_data != old_srcs) {
+    delete[] old_data;
   }
+  m_num_srcs = count;
   return this;
 }
 
@@ -340,18 +314,8 @@ void IRInstruction::denormalize_registers() {
     }
 
     // update m_inline_srcs or m_srcs
-    if (m_num_inline_srcs > MAX_NUM_INLINE_SRCS) {
-      delete m_srcs;
-    }
-    if (srcs.size() <= MAX_NUM_INLINE_SRCS) {
-      m_num_inline_srcs = srcs.size();
-      for (size_t i = 0; i < srcs.size(); ++i) {
-        m_inline_srcs[i] = srcs.at(i);
-      }
-    } else {
-      m_num_inline_srcs = MAX_NUM_INLINE_SRCS + 1;
-      m_srcs = new std::vector<reg_t>(std::move(srcs));
-    }
+    set_srcs_size(srcs.size());
+    std::memcpy(srcs_data(), srcs.data(), srcs.size() * sizeof(reg_t));
   }
 }
 
@@ -413,10 +413,18 @@ class IRInstruction final {
  private:
   std::string show_opcode() const; // To avoid "Show.h" in the header.
 
+  // The source registers, either inline or out-of-line.
+  const reg_t* srcs_data() const {
+    return m_num_srcs <= MAX_NUM_INLINE_SRCS ? m_inline_srcs : m_srcs;
+  }
+  reg_t* srcs_data() {
+    return m_num_srcs <= MAX_NUM_INLINE_SRCS ? m_inline_srcs : m_srcs;
+  }
+
   // 2 is chosen because it's the maximum number of registers (32 bits each) we
   // can fit in the size of a pointer (on a 64bit system).
   // In practice, most IRInstructions have 2 or fewer source registers, so we
-  // can avoid a vector allocation most of the time.
+  // can avoid a heap allocation most of the time.
   static constexpr uint8_t MAX_NUM_INLINE_SRCS = 2;
 
   // The fields of IRInstruction are carefully selected and ordered to avoid
@@ -424,13 +432,10 @@ class IRInstruction final {
   // alignment on a 64bit system.
 
   IROpcode m_opcode; // 2 bytes
-  // m_num_inline_srcs can take a small set of possible values:
-  //   * 0, ..., MAX_NUM_INLINE_SRCS: the size of the valid section of
-  //     m_inline_srcs
-  //   * MAX_NUM_INLINE_SRCS + 1: indicates that m_srcs should be used, not
-  //     m_inline_srcs
-  uint16_t m_num_inline_srcs{0}; // 2 bytes. Could be 1 byte
-                                 // but extra byte would just be padding
+  // The number of source registers. Up to MAX_NUM_INLINE_SRCS, they are
+  // stored in m_inline_srcs; otherwise m_srcs points to an array of exactly
+  // this many registers.
+  uint16_t m_num_srcs{0}; // 2 bytes
   reg_t m_dest{0}; // 4 bytes
   // 8 bytes so far
   union {
@@ -448,11 +453,12 @@ class IRInstruction final {
   };
   // 16 bytes so far
   union {
-    // m_num_inline_srcs indicates how to interpret the union. See comment above
+    // m_num_srcs indicates how to interpret the union. See comment above
     reg_t m_inline_srcs[MAX_NUM_INLINE_SRCS] = {0};
-    // Use a pointer here because it's 8 bytes instead of ~24.
-    // Be careful to new and delete it correctly!
-    std::vector<reg_t>* m_srcs;
+    // A single allocation of m_num_srcs registers, without the size and
+    // capacity overhead of a separately allocated std::vector.
+    // Be careful to new[] and delete[] it correctly!
+    reg_t* m_srcs;
   };
   // 24 bytes total
 };
@@ -14,6 +14,8 @@
 #include "DexUtil.h"
 #include "Show.h"
 
+#include <array>
+
 std::ostream& operator<<(std::ostream& os, const IROpcode& op) {
   os << show(op);
   return os;
@@ -1386,7 +1388,9 @@ bool has_side_effects(IROpcode opc) {
 
 namespace opcode_impl {
 
-bool has_dest(IROpcode op) {
+namespace {
+
+bool compute_has_dest(IROpcode op) {
   if (opcode::is_an_internal(op)) {
     return op != IOPCODE_INIT_CLASS;
   } else {
@@ -1395,7 +1399,7 @@ bool has_dest(IROpcode op) {
   }
 }
 
-bool has_move_result_pseudo(IROpcode op) {
+bool compute_has_move_result_pseudo(IROpcode op) {
   if (opcode::is_an_internal(op)) {
     return false;
   } else if (op == OPCODE_CHECK_CAST) {
@@ -1406,7 +1410,7 @@ bool has_move_result_pseudo(IROpcode op) {
   }
 }
 
-unsigned min_srcs_size(IROpcode op) {
+unsigned compute_min_srcs_size(IROpcode op) {
   if (opcode::is_an_internal(op)) {
     return 0;
   } else {
@@ -1415,6 +1419,47 @@ unsigned min_srcs_size(IROpcode op) {
   }
 }
 
+constexpr size_t kNumIROpcodes = 0
+#define OP(...) +1
+#define IOP(...) +1
+#define OPRANGE(...)
+#include "IROpcodes.def"
+    ;
+
+// The properties above each combine several switches over IR and Dex
+// opcodes, and are queried for nearly every instruction, so they are
+// tabulated once.
+struct OpcodeProperties {
+  bool has_dest;
+  bool has_move_result_pseudo;
+  uint8_t min_srcs_size;
+};
+
+const std::array<OpcodeProperties, kNumIROpcodes>& opcode_properties() {
+  static const auto s_properties = [] {
+    std::array<OpcodeProperties, kNumIROpcodes> properties{};
+    for (size_t i = 0; i < kNumIROpcodes; ++i) {
+      auto op = static_cast<IROpcode>(i);
+      properties[i] = {compute_has_dest(op), compute_has_move_result_pseudo(op),
+                       static_cast<uint8_t>(compute_min_srcs_size(op))};
+    }
+    return properties;
+  }();
+  return s_properties;
+}
+
+} // namespace
+
+bool has_dest(IROpcode op) { return opcode_properties()[op].has_dest; }
+
+bool has_move_result_pseudo(IROpcode op) {
+  return opcode_properties()[op].has_move_result_pseudo;
+}
+
+unsigned min_srcs_size(IROpcode op) {
+  return opcode_properties()[op].min_srcs_size;
+}
+
 bool dest_is_wide(IROpcode op) {
   switch (op) {
   case OPCODE_MOVE_WIDE:
@@ -13,6 +13,7 @@
 #include "Debug.h"
 #include "DexPosition.h"
 #include "DexUtil.h"
+#include "FrozenIRList.h"
 #include "Match.h"
 #include "MonitorCount.h"
 #include "RedexContext.h"
@@ -963,12 +964,11 @@ void IRTypeChecker::run() {
   // Finally, we use the inferred types to type-check each instruction in the
   // method. We stop at the first type error encountered.
   auto& type_envs = m_type_inference->get_type_environments();
-  for (const MethodItemEntry& mie : InstructionIterable(*cfg)) {
-    IRInstruction* insn = mie.insn;
+  for (IRInstruction* insn : FrozenIRList(*cfg)) {
     try {
       auto it = type_envs.find(insn);
       always_assert_log(
-          it != type_envs.end(), "%s in:\n%s", SHOW(mie), SHOW(*cfg));
+          it != type_envs.end(), "%s in:\n%s", SHOW(insn), SHOW(*cfg));
       check_instruction(insn, &it->second);
     } catch (const TypeCheckingException& e) {
       m_good = false;
@@ -976,7 +976,7 @@ void IRTypeChecker::run() {
       out << "Type error in method "
           << m_dex_method->get_deobfuscated_name_or_empty()
           << " at instruction '" << SHOW(insn) << "' @ " << std::hex
-          << static_cast<const void*>(&mie) << " for " << e.what();
+          << static_cast<const void*>(insn) << " for " << e.what();
       m_what = out.str();
       m_complete = true;
       return;
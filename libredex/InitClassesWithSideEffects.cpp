@@ -7,9 +7,11 @@
 
 #include "InitClassesWithSideEffects.h"
 
+#include "AnalysisSummaryCache.h"
 #include "MethodUtil.h"
 #include "Timer.h"
 #include "Walkers.h"
+#include <boost/algorithm/string.hpp>
 #include <memory>
 
 namespace init_classes {
@@ -53,6 +55,23 @@ InitClassesWithSideEffects::InitClassesWithSideEffects(
     const method_override_graph::Graph* method_override_graph)
     : m_create_init_class_insns(create_init_class_insns) {
   Timer t("InitClassesWithSideEffects");
+  boost::optional<std::string> summary_key;
+  if (analysis_summary_cache::enabled()) {
+    // The initial clinit_has_no_side_effects flags are inputs as well.
+    std::vector<std::string> inputs;
+    for (auto* cls : scope) {
+      if (cls->rstate.clinit_has_no_side_effects()) {
+        inputs.push_back(cls->get_type()->str_copy());
+      }
+    }
+    std::sort(inputs.begin(), inputs.end());
+    inputs.push_back(method_override_graph ? "override_graph" : "");
+    summary_key = analysis_summary_cache::make_key(
+        analysis_summary_cache::scope_digest(scope), inputs);
+    if (load_summary(scope, *summary_key)) {
+      return;
+    }
+  }
   std::unique_ptr<InsertOnlyConcurrentSet<DexMethod*>> non_true_virtuals;
   if (method_override_graph) {
     non_true_virtuals = std::make_unique<InsertOnlyConcurrentSet<DexMethod*>>(
@@ -90,6 +109,66 @@ InitClassesWithSideEffects::InitClassesWithSideEffects(
           (size_t)prev_trivial_init_classes,
           added_clinit_has_no_side_effects.size());
   } while (m_trivial_init_classes > prev_trivial_init_classes);
+  if (summary_key) {
+    store_summary(*summary_key);
+  }
+}
+
+namespace {
+constexpr const char* SUMMARY_NAME = "init_classes_with_side_effects";
+} // namespace
+
+// Each line of the summary lists a type followed by its (non-empty)
+// InitClasses, separated by spaces.
+bool InitClassesWithSideEffects::load_summary(const Scope& scope,
+                                              const std::string& key) {
+  auto lines = analysis_summary_cache::load(SUMMARY_NAME, key);
+  if (!lines) {
+    return false;
+  }
+  std::unordered_map<const DexType*, InitClasses> entries;
+  for (const auto& line : *lines) {
+    std::vector<std::string> names;
+    boost::split(names, line, boost::is_any_of(" "));
+    auto* type = DexType::get_type(names.front());
+    if (type == nullptr || names.size() < 2) {
+      return false;
+    }
+    auto& classes = entries[type];
+    for (size_t i = 1; i < names.size(); ++i) {
+      auto* cls = type_class(DexType::get_type(names[i]));
+      if (cls == nullptr) {
+        return false;
+      }
+      classes.push_back(cls);
+    }
+  }
+  for (auto* cls : scope) {
+    if (!entries.count(cls->get_type()) &&
+        !cls->rstate.clinit_has_no_side_effects()) {
+      cls->rstate.set_clinit_has_no_side_effects();
+    }
+  }
+  for (auto&& [type, classes] : entries) {
+    m_init_classes.emplace(type, std::move(classes));
+  }
+  return true;
+}
+
+void InitClassesWithSideEffects::store_summary(const std::string& key) const {
+  std::vector<std::string> lines;
+  for (auto&& [type, classes] : m_init_classes) {
+    if (classes.empty()) {
+      continue;
+    }
+    std::string line = type->str_copy();
+    for (const auto* cls : classes) {
+      line += " " + cls->get_type()->str_copy();
+    }
+    lines.push_back(std::move(line));
+  }
+  std::sort(lines.begin(), lines.end());
+  analysis_summary_cache::store(SUMMARY_NAME, key, lines);
 }
 
 const InitClasses* InitClassesWithSideEffects::get(const DexType* type) const {
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "ConcurrentContainers.h"
@@ -36,6 +37,11 @@ class InitClassesWithSideEffects {
       const method::ClInitHasNoSideEffectsPredicate& clinit_has_no_side_effects,
       const InsertOnlyConcurrentSet<DexMethod*>* non_true_virtuals);
 
+  // Restores the result from the AnalysisSummaryCache; returns false if there
+  // is no usable summary for `key`.
+  bool load_summary(const Scope& scope, const std::string& key);
+  void store_summary(const std::string& key) const;
+
  public:
   InitClassesWithSideEffects(
       const Scope& scope,
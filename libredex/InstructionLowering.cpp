@@ -8,6 +8,7 @@
 #include "InstructionLowering.h"
 
 #include "ConfigFiles.h"
+#include "ControlFlow.h"
 #include "Debug.h"
 #include "DexInstruction.h"
 #include "DexOpcodeDefs.h"
@@ -423,7 +424,10 @@ void lower_simple_instruction(DexMethod*, IRCode*, IRList::iterator* it_) {
 
 } // namespace
 
-Stats lower(DexMethod* method, bool lower_with_cfg, ConfigFiles* conf) {
+Stats lower(DexMethod* method,
+            bool lower_with_cfg,
+            ConfigFiles* conf,
+            bool profile_guided_layout) {
   Stats stats;
   auto* code = method->get_code();
   always_assert(code != nullptr);
@@ -433,7 +437,13 @@ Stats lower(DexMethod* method, bool lower_with_cfg, ConfigFiles* conf) {
   // avoid this bug, we use the CFG to remove empty blocks.
   if (lower_with_cfg) {
     code->build_cfg(/* editable */ true);
-    code->clear_cfg();
+    if (profile_guided_layout) {
+      std::unique_ptr<cfg::LinearizationStrategy> strategy =
+          std::make_unique<cfg::ProfileGuidedLinearizationStrategy>();
+      code->clear_cfg(strategy);
+    } else {
+      code->clear_cfg();
+    }
   }
 
   // Check the load-param opcodes make sense before removing them
@@ -533,16 +543,18 @@ Stats lower(DexMethod* method, bool lower_with_cfg, ConfigFiles* conf) {
   return stats;
 }
 
-Stats run(DexStoresVector& stores, bool lower_with_cfg, ConfigFiles* conf) {
+Stats run(DexStoresVector& stores,
+          bool lower_with_cfg,
+          ConfigFiles* conf,
+          bool profile_guided_layout) {
   auto scope = build_class_scope(stores);
-  return walk::parallel::methods<Stats>(scope,
-                                        [lower_with_cfg, conf](DexMethod* m) {
-                                          Stats stats;
-                                          if (m->get_code() == nullptr) {
-                                            return stats;
-                                          }
-                                          return lower(m, lower_with_cfg, conf);
-                                        });
+  return walk::parallel::methods<Stats>(scope, [&](DexMethod* m) {
+    Stats stats;
+    if (m->get_code() == nullptr) {
+      return stats;
+    }
+    return lower(m, lower_with_cfg, conf, profile_guided_layout);
+  });
 }
 
 CaseKeysExtent CaseKeysExtent::from_ordered(
@@ -65,6 +65,9 @@ struct Stats {
 /*
  * Convert IRInstructions to DexInstructions while doing the following:
  *
+ *   - With lower_with_cfg, linearize the CFG once more; with
+ *     profile_guided_layout, blocks are then placed by their source-block
+ *     hits, see cfg::ProfileGuidedLinearizationStrategy.
  *   - Check consistency of load-param opcodes
  *   - Pick the smallest opcode that can address its operands.
  *   - Insert move instructions as necessary for check-cast instructions that
@@ -74,11 +77,13 @@ struct Stats {
  */
 Stats lower(DexMethod*,
             bool lower_with_cfg = false,
-            ConfigFiles* conf = nullptr);
+            ConfigFiles* conf = nullptr,
+            bool profile_guided_layout = false);
 
 Stats run(DexStoresVector&,
           bool lower_with_cfg = false,
-          ConfigFiles* conf = nullptr);
+          ConfigFiles* conf = nullptr,
+          bool profile_guided_layout = false);
 
 namespace impl {
 
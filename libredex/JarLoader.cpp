@@ -7,7 +7,9 @@
 
 #include <boost/iostreams/device/mapped_file.hpp>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
@@ -31,6 +33,7 @@
 #include "Show.h"
 #include "Trace.h"
 #include "Util.h"
+#include "WorkQueue.h"
 
 /******************
  * Begin Class Loading code.
@@ -884,7 +887,11 @@ bool decompress_class(jar_entry& file,
   return true;
 }
 
-constexpr size_t kStartBufferSize = 128 * 1024;
+// Class files are inflated in parallel, a batch at a time, so that the memory
+// for the uncompressed class files stays bounded. Parsing stays sequential and
+// in jar order: it creates the classes, and which of two duplicate classes
+// wins depends on that order.
+constexpr size_t kDecompressBatchSize = 4096;
 
 bool process_jar_entries(
     const DexLocation* location,
@@ -894,10 +901,10 @@ bool process_jar_entries(
     Scope* classes,
     const attribute_hook_t& attr_hook,
     const jar_loader::duplicate_allowed_hook_t& is_allowed) {
-  ssize_t bufsize = kStartBufferSize;
-  std::unique_ptr<uint8_t[]> outbuffer = std::make_unique<uint8_t[]>(bufsize);
   constexpr std::string_view kClassEndString = ".class";
   init_basic_types();
+
+  std::vector<jar_entry*> class_files;
   for (auto& file : files) {
     if (file.cd_entry.ucomp_size == 0) continue;
 
@@ -908,20 +915,39 @@ bool process_jar_entries(
         filename.substr(filename.length() - kClassEndString.length());
     if (endcomp != kClassEndString) continue;
 
-    // Resize output if necessary.
-    if (bufsize < file.cd_entry.ucomp_size) {
-      while (bufsize < file.cd_entry.ucomp_size)
-        bufsize *= 2;
-      outbuffer = std::make_unique<uint8_t[]>(bufsize);
-    }
+    class_files.push_back(&file);
+  }
 
-    if (!decompress_class(file, mapping, map_size, outbuffer.get(), bufsize)) {
+  std::vector<std::unique_ptr<uint8_t[]>> outbuffers;
+  for (size_t batch_begin = 0; batch_begin < class_files.size();
+       batch_begin += kDecompressBatchSize) {
+    size_t batch_size =
+        std::min(kDecompressBatchSize, class_files.size() - batch_begin);
+    outbuffers.clear();
+    outbuffers.resize(batch_size);
+    std::atomic<bool> decompressed{true};
+    workqueue_run_for<size_t>(0, batch_size, [&](size_t i) {
+      auto& file = *class_files[batch_begin + i];
+      auto bufsize = file.cd_entry.ucomp_size;
+      auto outbuffer = std::make_unique<uint8_t[]>(bufsize);
+      if (!decompress_class(file, mapping, map_size, outbuffer.get(),
+                            bufsize)) {
+        decompressed = false;
+        return;
+      }
+      outbuffers[i] = std::move(outbuffer);
+    });
+    if (!decompressed) {
       return false;
     }
 
-    if (!parse_class(outbuffer.get(), bufsize, classes, attr_hook, is_allowed,
-                     location)) {
-      return false;
+    for (size_t i = 0; i < batch_size; ++i) {
+      auto& file = *class_files[batch_begin + i];
+      if (!parse_class(outbuffers[i].get(), file.cd_entry.ucomp_size, classes,
+                       attr_hook, is_allowed, location)) {
+        return false;
+      }
+      outbuffers[i].reset();
     }
   }
   return true;
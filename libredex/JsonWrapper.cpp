@@ -14,6 +14,8 @@
 JsonWrapper::JsonWrapper() : JsonWrapper(Json::nullValue) {}
 JsonWrapper::JsonWrapper(const Json::Value& config)
     : m_config(new Json::Value(config)) {}
+JsonWrapper::JsonWrapper(Json::Value&& config)
+    : m_config(new Json::Value(std::move(config))) {}
 
 JsonWrapper::~JsonWrapper() {}
 
@@ -21,6 +21,8 @@ class JsonWrapper {
  public:
   JsonWrapper();
   explicit JsonWrapper(const Json::Value& config);
+  // Takes over the DOM instead of copying it.
+  explicit JsonWrapper(Json::Value&& config);
 
   ~JsonWrapper();
 
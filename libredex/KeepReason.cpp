@@ -7,6 +7,10 @@
 
 #include "KeepReason.h"
 
+#include <array>
+#include <atomic>
+#include <limits>
+#include <mutex>
 #include <ostream>
 
 #include "ConcurrentContainers.h"
@@ -53,12 +57,84 @@ size_t hash_value(const Reason& reason) {
 
 namespace {
 
-// Lint will complain about this, but it is better than having to
-// forward-declare all of concurrent containers.
-std::unique_ptr<InsertOnlyConcurrentSet<keep_reason::Reason*,
-                                        keep_reason::ReasonPtrHash,
-                                        keep_reason::ReasonPtrEqual>>
-    s_keep_reasons{nullptr};
+// Interned reasons, by index. The reasons are stored in chunks of doubling
+// sizes, so that looking them up by index needs no lock while the table grows:
+// chunk k holds the reasons with indices in [2^k - 1, 2^(k+1) - 1).
+class ReasonTable {
+ public:
+  ~ReasonTable() {
+    for (size_t k = 0; k < NUM_CHUNKS; ++k) {
+      auto* chunk = m_chunks[k].load();
+      if (chunk == nullptr) {
+        break;
+      }
+      for (size_t i = 0; i < chunk_size(k) && i + chunk_size(k) - 1 < m_size;
+           ++i) {
+        delete chunk[i];
+      }
+      delete[] chunk;
+    }
+  }
+
+  ReasonIndex intern(const Reason& reason) {
+    // Most reasons get attached to many classes and members, so look them up
+    // without locking or allocating first.
+    auto* index = m_indices.get(&reason);
+    if (index != nullptr) {
+      return *index;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    index = m_indices.get(&reason);
+    if (index != nullptr) {
+      return *index;
+    }
+    always_assert(m_size < std::numeric_limits<ReasonIndex>::max());
+    ReasonIndex new_index = m_size++;
+    auto k = chunk_of(new_index);
+    auto* chunk = m_chunks[k].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+      chunk = new const Reason*[chunk_size(k)];
+      m_chunks[k].store(chunk, std::memory_order_release);
+    }
+    auto* interned = new Reason(reason);
+    chunk[new_index + 1 - chunk_size(k)] = interned;
+    // Publishes the index, after the reason is in the table.
+    m_indices.insert({interned, new_index});
+    return new_index;
+  }
+
+  const Reason* get(ReasonIndex index) const {
+    auto k = chunk_of(index);
+    auto* chunk = m_chunks[k].load(std::memory_order_acquire);
+    always_assert(chunk != nullptr);
+    return chunk[index + 1 - chunk_size(k)];
+  }
+
+ private:
+  static constexpr size_t NUM_CHUNKS = 32;
+
+  static size_t chunk_size(size_t k) { return size_t(1) << k; }
+
+  static size_t chunk_of(ReasonIndex index) {
+    uint64_t n = uint64_t(index) + 1;
+    size_t k = 0;
+    while (n >>= 1) {
+      ++k;
+    }
+    return k;
+  }
+
+  InsertOnlyConcurrentMap<const Reason*,
+                          ReasonIndex,
+                          ReasonPtrHash,
+                          ReasonPtrEqual>
+      m_indices;
+  std::mutex m_mutex;
+  ReasonIndex m_size{0};
+  std::array<std::atomic<const Reason**>, NUM_CHUNKS> m_chunks{};
+};
+
+std::unique_ptr<ReasonTable> s_keep_reasons{nullptr};
 
 } // namespace
 
@@ -67,18 +143,16 @@ bool Reason::s_record_keep_reasons = false;
 void Reason::set_record_keep_reasons(bool v) {
   s_record_keep_reasons = v;
   if (v && s_keep_reasons == nullptr) {
-    s_keep_reasons = std::make_unique<InsertOnlyConcurrentSet<
-        keep_reason::Reason*, keep_reason::ReasonPtrHash,
-        keep_reason::ReasonPtrEqual>>();
+    s_keep_reasons = std::make_unique<ReasonTable>();
   }
 }
 
-Reason* Reason::try_insert(std::unique_ptr<Reason> to_insert) {
-  auto [reason_ptr, emplaced] = s_keep_reasons->insert(to_insert.get());
-  if (emplaced) {
-    return to_insert.release();
-  }
-  return const_cast<Reason*>(*reason_ptr);
+ReasonIndex Reason::intern(const Reason& reason) {
+  return s_keep_reasons->intern(reason);
+}
+
+const Reason* Reason::get(ReasonIndex index) {
+  return s_keep_reasons->get(index);
 }
 
 void Reason::release_keep_reasons() { s_keep_reasons.reset(); }
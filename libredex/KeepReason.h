@@ -8,6 +8,7 @@
 #pragma once
 
 #include <boost/functional/hash.hpp>
+#include <cstdint>
 #include <iosfwd>
 #include <unordered_set>
 
@@ -38,6 +39,12 @@ enum KeepReasonType {
   UNKNOWN,
 };
 
+/*
+ * Index of an interned Reason in the reason table. Keep reasons are attached
+ * to classes and members as indices, which take half the space of pointers.
+ */
+using ReasonIndex = uint32_t;
+
 struct Reason {
   KeepReasonType type;
   union {
@@ -67,13 +74,22 @@ struct Reason {
   static void set_record_keep_reasons(bool v);
   static void release_keep_reasons();
 
+  /*
+   * Interns the reason built from the given arguments, and returns its index.
+   * Requires record_keep_reasons().
+   */
   template <class... Args>
-  static Reason* make_keep_reason(Args&&... args) {
-    auto to_insert = std::make_unique<Reason>(std::forward<Args>(args)...);
-    return try_insert(std::move(to_insert));
+  static ReasonIndex make_keep_reason(Args&&... args) {
+    return intern(Reason(std::forward<Args>(args)...));
   }
 
-  static Reason* try_insert(std::unique_ptr<Reason> to_insert);
+  static ReasonIndex intern(const Reason& reason);
+
+  /*
+   * Returns the interned reason with the given index. This does not lock, and
+   * may be called concurrently with interning.
+   */
+  static const Reason* get(ReasonIndex index);
 
   static bool s_record_keep_reasons;
 
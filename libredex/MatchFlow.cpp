@@ -37,6 +37,28 @@ result_t flow_t::find(cfg::ControlFlowGraph& cfg,
   return result_t{dfg.locations(lixs), std::move(order)};
 }
 
+result_t flow_t::find(const method_index_t& index, location_t l) const {
+  return find(index, {l});
+}
+
+result_t flow_t::find(const method_index_t& index,
+                      std::initializer_list<location_t> ls) const {
+  std::unordered_set<detail::LocationIx> lixs(ls.size());
+  for (auto l : ls) {
+    always_assert(this == l.m_owner && "location_t from another flow_t");
+    lixs.insert(l.m_ix);
+  }
+
+  TRACE(MFLOW, 6, "find: Building Instruction Graph from index");
+  auto dfg = detail::instruction_graph(index.m_index, m_constraints, lixs);
+
+  TRACE(MFLOW, 6, "find: Propagating Flow Constraints");
+  dfg.propagate_flow_constraints(m_constraints);
+
+  TRACE(MFLOW, 6, "find: Done.");
+  return result_t{dfg.locations(lixs), index.m_index.order()};
+}
+
 result_t::insn_range result_t::matching(location_t l) const {
   if (l.m_ix >= m_results.size()) {
     return insn_range::empty();
@@ -21,6 +21,7 @@ namespace mf {
 
 struct flag_t;
 struct location_t;
+struct method_index_t;
 struct result_t;
 
 /**
@@ -226,6 +227,23 @@ struct result_t;
  *     const   a 0
  *     const   b 1
  *     add-int c a b
+ *
+ *
+ * Sharing Work Between Queries
+ * -----------------------------------------------------------------------------
+ *
+ * Each `find` on a CFG runs an analysis specific to its predicate.  When
+ * several predicates are matched against the same method, the use-def chains
+ * of the method can be computed once instead, and shared by all of them:
+ *
+ *   mf::method_index_t index(cfg);
+ *   auto res_f = f.find(index, l);
+ *   auto res_g = g.find(index, {k, m});
+ *
+ * The index refers to the instructions of `cfg`, so it needs to be rebuilt
+ * whenever the CFG changes.  Predicates with several roots should pass all of
+ * them to a single `find`, which evaluates the constraints once for all of
+ * them.
  */
 struct flow_t {
   /**
@@ -247,12 +265,33 @@ struct flow_t {
   result_t find(cfg::ControlFlowGraph& cfg,
                 std::initializer_list<location_t> ls) const;
 
+  /**
+   * As above, but using the use-def chains precomputed in `index`.  Does not
+   * require an exit block.
+   */
+  result_t find(const method_index_t& index, location_t l) const;
+  result_t find(const method_index_t& index,
+                std::initializer_list<location_t> ls) const;
+
  private:
   friend struct location_t;
 
   std::vector<detail::Constraint> m_constraints;
 };
 
+/**
+ * Use-def chains of a CFG, shared by all the queries on it.  See "Sharing Work
+ * Between Queries" above.
+ */
+struct method_index_t {
+  explicit method_index_t(const cfg::ControlFlowGraph& cfg) : m_index(cfg) {}
+
+ private:
+  friend struct flow_t;
+
+  detail::UseDefIndex m_index;
+};
+
 constexpr detail::AliasFlag dest = detail::AliasFlag::dest;
 constexpr detail::AliasFlag alias = detail::AliasFlag::alias;
 constexpr detail::AliasFlag result = detail::AliasFlag::result;
@@ -13,6 +13,7 @@
 #include <boost/optional/optional.hpp>
 
 #include <sparta/MonotonicFixpointIterator.h>
+#include <sparta/PatriciaTreeMapAbstractPartition.h>
 #include <sparta/PatriciaTreeSetAbstractDomain.h>
 
 #include "Show.h"
@@ -171,6 +172,33 @@ struct InconsistentDFGNodesAnalysis
   const std::vector<Constraint>& m_constraints;
 };
 
+// Types for ReachingDefinitionsAnalysis' (RDA) Abstract State.  Registers
+// without definitions are bottom, so that joining them with defined ones keeps
+// the definitions.
+using RDADomain = sparta::PatriciaTreeSetAbstractDomain<IRInstruction*>;
+using RDAPartition = sparta::PatriciaTreeMapAbstractPartition<reg_t, RDADomain>;
+
+struct ReachingDefinitionsAnalysis
+    : public ir_analyzer::BaseIRAnalyzer<RDAPartition> {
+  explicit ReachingDefinitionsAnalysis(const cfg::ControlFlowGraph& cfg)
+      : ir_analyzer::BaseIRAnalyzer<RDAPartition>(cfg) {}
+
+  void analyze_instruction(const IRInstruction* insn,
+                           RDAPartition* env) const override {
+    if (auto d = dest(insn)) {
+      env->set(*d, RDADomain(const_cast<IRInstruction*>(insn)));
+    }
+  }
+};
+
+Source to_source(const RDADomain& defs) {
+  if (defs.is_bottom() || defs.is_top()) {
+    return {};
+  }
+  const auto& elements = defs.elements();
+  return Source(elements.begin(), elements.end());
+}
+
 } // namespace
 
 const Constraint::Src& Constraint::src(src_index_t ix) const {
@@ -454,6 +482,67 @@ void DataFlowGraph::propagate_flow_constraints(
   }
 }
 
+UseDefIndex::UseDefIndex(const cfg::ControlFlowGraph& cfg)
+    : m_order(std::make_shared<Order>()) {
+  ReachingDefinitionsAnalysis analysis{cfg};
+  analysis.run({});
+
+  for (auto* block : cfg.blocks()) {
+    auto env = analysis.get_entry_state_at(block);
+    for (auto& mie : ir_list::InstructionIterable(block)) {
+      auto* insn = mie.insn;
+      auto& operand_defs = m_operand_defs[insn];
+      operand_defs.reserve(insn->srcs_size());
+      for (size_t ix = 0; ix < insn->srcs_size(); ++ix) {
+        operand_defs.push_back(to_source(env.get(insn->src(ix))));
+      }
+      if (opcode::is_move_result_any(insn->opcode())) {
+        m_result_defs.emplace(insn, to_source(env.get(RESULT_REGISTER)));
+      }
+      analysis.analyze_instruction(insn, &env);
+    }
+
+    // Same order as `instruction_graph` assigns.
+    for (auto it = block->rbegin(); it != block->rend(); ++it) {
+      if (it->type != MFLOW_OPCODE) {
+        continue;
+      }
+      m_order->emplace(it->insn, m_order->size());
+      m_insns.push_back(it->insn);
+    }
+  }
+}
+
+Source UseDefIndex::defs(const IRInstruction* insn,
+                         src_index_t ix,
+                         AliasFlag alias) const {
+  Source res;
+  std::unordered_set<IRInstruction*> seen;
+  Source worklist = m_operand_defs.at(insn).at(ix);
+  while (!worklist.empty()) {
+    auto* def = worklist.back();
+    worklist.pop_back();
+    if (!seen.insert(def).second) {
+      continue;
+    }
+
+    const Source* next = nullptr;
+    if (opcode::is_a_move(def->opcode()) && alias == AliasFlag::alias) {
+      next = &m_operand_defs.at(def).at(0);
+    } else if (opcode::is_move_result_any(def->opcode()) &&
+               (alias == AliasFlag::alias || alias == AliasFlag::result)) {
+      next = &m_result_defs.at(def);
+    }
+
+    if (next) {
+      worklist.insert(worklist.end(), next->begin(), next->end());
+    } else {
+      res.push_back(def);
+    }
+  }
+  return res;
+}
+
 DataFlowGraph instruction_graph(cfg::ControlFlowGraph& cfg,
                                 const std::vector<Constraint>& constraints,
                                 const std::unordered_set<LocationIx>& roots,
@@ -553,5 +642,63 @@ DataFlowGraph instruction_graph(cfg::ControlFlowGraph& cfg,
   return graph;
 }
 
+DataFlowGraph instruction_graph(const UseDefIndex& index,
+                                const std::vector<Constraint>& constraints,
+                                const std::unordered_set<LocationIx>& roots) {
+  DataFlowGraph graph;
+  std::queue<DataFlowGraph::Node> frontier;
+
+  // Check whether (loc, insn) should be in the graph, and adds it if necessary,
+  // queueing it up for its operands to be looked at.
+  const auto test_node = [&](LocationIx loc, IRInstruction* insn) {
+    if (loc == NO_LOC) {
+      return false;
+    }
+
+    auto& constraint = constraints.at(loc);
+    if (!constraint.insn_matcher->matches(insn)) {
+      TRACE(MFLOW, 8, "instruction_graph: L%zu failing  %s", loc, SHOW(insn));
+      return false;
+    }
+
+    if (!graph.has_node(loc, insn)) {
+      TRACE(MFLOW, 6, "instruction_graph: L%zu matching %s", loc, SHOW(insn));
+      graph.add_node(loc, insn);
+      frontier.emplace(loc, insn);
+    }
+    return true;
+  };
+
+  for (auto* insn : index.instructions()) {
+    for (auto root : roots) {
+      test_node(root, insn);
+    }
+  }
+
+  for (; !frontier.empty(); frontier.pop()) {
+    auto to_loc = node_loc(frontier.front());
+    auto* to_insn = node_insn(frontier.front());
+    auto& constraint = constraints.at(to_loc);
+
+    for (src_index_t to_src = 0; to_src < to_insn->srcs_size(); ++to_src) {
+      auto& from_src = constraint.src(to_src);
+      if (from_src.loc == NO_LOC) {
+        continue;
+      }
+
+      for (auto* insn : index.defs(to_insn, to_src, from_src.alias)) {
+        if (test_node(from_src.loc, insn)) {
+          graph.add_edge(from_src.loc, insn, to_src, to_loc, to_insn);
+        } else {
+          graph.mark_inconsistent(to_loc, to_insn, to_src);
+        }
+      }
+    }
+  }
+
+  graph.calculate_entrypoints();
+  return graph;
+}
+
 } // namespace detail
 } // namespace mf
@@ -336,6 +336,36 @@ struct DataFlowGraph {
   std::unordered_map<Node, Adjacencies, boost::hash<Node>> m_adjacencies;
 };
 
+/**
+ * Reaching definitions of the operands of all instructions in a CFG, computed
+ * once and shared by all the queries on that CFG.  The result register is
+ * treated as the destination of instructions with a move-result, so that
+ * move-results can be looked through.
+ */
+struct UseDefIndex {
+  explicit UseDefIndex(const cfg::ControlFlowGraph& cfg);
+
+  /**
+   * The instructions that may supply the ix-th operand of insn.  Moves are
+   * looked through for the alias flag, and move-results for the alias and
+   * result flags, as for the edges calculated by `instruction_graph`.
+   */
+  Source defs(const IRInstruction* insn, src_index_t ix, AliasFlag alias) const;
+
+  /** All instructions of the CFG, in the order of `order()`. */
+  const std::vector<IRInstruction*>& instructions() const { return m_insns; }
+
+  const std::shared_ptr<Order>& order() const { return m_order; }
+
+ private:
+  // Definitions of each operand, and of the result register for move-results,
+  // without looking through anything.
+  std::unordered_map<const IRInstruction*, Sources> m_operand_defs;
+  std::unordered_map<const IRInstruction*, Source> m_result_defs;
+  std::vector<IRInstruction*> m_insns;
+  std::shared_ptr<Order> m_order;
+};
+
 /**
  * Calculate the use-def graph modulo instruction constraints in `constraints`,
  * transitively reachable from instructions matching the constraint in `roots`
@@ -354,6 +384,14 @@ DataFlowGraph instruction_graph(cfg::ControlFlowGraph& cfg,
                                 const std::unordered_set<LocationIx>& roots,
                                 Order* order = nullptr);
 
+/**
+ * Calculate the same graph as above, from the use-def chains in `index`
+ * instead of a backwards analysis specific to `constraints`.
+ */
+DataFlowGraph instruction_graph(const UseDefIndex& index,
+                                const std::vector<Constraint>& constraints,
+                                const std::unordered_set<LocationIx>& roots);
+
 inline void Constraint::add_src(src_index_t ix,
                                 LocationIx loc,
                                 AliasFlag alias,
@@ -8,6 +8,8 @@
 #include "MethodProfiles.h"
 
 #include <boost/algorithm/string.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <stdio.h>
@@ -45,6 +47,41 @@ bool parse_cells(std::string_view line, const Func& parse_cell) {
 
 bool empty_column(std::string_view sv) { return sv.empty() || sv == "\n"; }
 
+constexpr std::string_view kBinaryMagic{"RDXPRF01"};
+
+// Reads the binary format described in MethodProfiles.h. All strings and
+// columns are views into `data`.
+class BinaryReader {
+ public:
+  explicit BinaryReader(std::string_view data) : m_data(data) {}
+
+  bool at_end() const { return m_pos == m_data.size(); }
+
+  uint32_t read_u4() { return load<uint32_t>(read_bytes(4), 0); }
+
+  std::string_view read_str() { return read_bytes(read_u4()); }
+
+  std::string_view read_bytes(size_t size) {
+    always_assert_log(size <= m_data.size() - m_pos,
+                      "Truncated binary method profile");
+    auto bytes = m_data.substr(m_pos, size);
+    m_pos += size;
+    return bytes;
+  }
+
+  // Reads the `index`-th element of a column. Columns are not aligned.
+  template <typename T>
+  static T load(std::string_view column, size_t index) {
+    T value;
+    std::memcpy(&value, column.data() + index * sizeof(T), sizeof(T));
+    return value;
+  }
+
+ private:
+  std::string_view m_data;
+  size_t m_pos{0};
+};
+
 } // namespace
 
 AccumulatingTimer MethodProfiles::s_process_unresolved_lines_timer(
@@ -85,30 +122,63 @@ bool MethodProfiles::parse_stats_file(const std::string& csv_filename) {
     return false;
   }
 
-  // getline will allocate a buffer and put a pointer to it here
-  std::string line;
-  while (std::getline(ifs, line)) {
-    bool success = false;
-    if (line.back() == '\n') {
-      line.pop_back();
+  {
+    char magic[kBinaryMagic.size()];
+    if (ifs.read(magic, sizeof(magic)) &&
+        std::string_view(magic, sizeof(magic)) == kBinaryMagic) {
+      ifs.close();
+      boost::iostreams::mapped_file_source file(csv_filename);
+      return parse_binary_stats_file(
+          std::string_view(file.data(), file.size()));
     }
+    ifs.clear();
+    ifs.seekg(0);
+  }
+
+  // Read the whole file at once. The lines are views into this buffer, which
+  // is null-terminated, as the cell parsers require.
+  std::string contents;
+  ifs.seekg(0, std::ios::end);
+  contents.resize(ifs.tellg());
+  ifs.seekg(0);
+  if (!ifs.read(contents.data(), contents.size())) {
+    std::cerr << "FAILED to read a line!" << std::endl;
+    return false;
+  }
+
+  std::vector<std::string_view> main_lines;
+  std::string_view rest(contents);
+  while (!rest.empty()) {
+    auto eol = rest.find('\n');
+    auto line = rest.substr(0, eol);
+    rest.remove_prefix(eol == std::string_view::npos ? rest.size() : eol + 1);
     // Just in case the files were generated on a Windows OS
     // or with Windows line ending.
-    if (line.back() == '\r') {
-      line.pop_back();
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
     }
-    if (m_mode == NONE) {
-      success = parse_header(line);
-    } else {
-      success = parse_line(line);
+    if (m_mode == MAIN) {
+      // Once in the main section, every remaining line is a row.
+      main_lines.push_back(line);
+      continue;
     }
+    bool success = m_mode == NONE ? parse_header(line) : parse_metadata(line);
     if (!success) {
       return false;
     }
   }
-  if (ifs.bad()) {
-    std::cerr << "FAILED to read a line!" << std::endl;
-    return false;
+
+  // Parsing and resolving the rows is independent for each row; the results
+  // are then applied in file order.
+  std::vector<std::optional<ParsedMain>> parsed(main_lines.size());
+  workqueue_run_for<size_t>(0, main_lines.size(), [&](size_t i) {
+    parsed[i] = parse_main_internal(main_lines[i]);
+  });
+  for (auto& result : parsed) {
+    if (!result) {
+      return false;
+    }
+    (void)apply_main_internal_result(std::move(*result), &m_interaction_id);
   }
 
   TRACE(METH_PROF, 1,
@@ -117,6 +187,83 @@ bool MethodProfiles::parse_stats_file(const std::string& csv_filename) {
   return true;
 }
 
+bool MethodProfiles::parse_binary_stats_file(std::string_view data) {
+  BinaryReader reader(data);
+  if (reader.read_bytes(kBinaryMagic.size()) != kBinaryMagic) {
+    std::cerr << "FAILED to parse binary profile. Bad magic\n";
+    return false;
+  }
+  auto num_metadata = reader.read_u4();
+  while (num_metadata-- > 0) {
+    std::string interaction_id(reader.read_str());
+    m_interaction_counts.emplace(std::move(interaction_id), reader.read_u4());
+  }
+  std::vector<std::string> interaction_ids(reader.read_u4());
+  for (auto& interaction_id : interaction_ids) {
+    interaction_id = reader.read_str();
+  }
+
+  size_t num_rows = reader.read_u4();
+  auto name_offsets = reader.read_bytes((num_rows + 1) * sizeof(uint32_t));
+  auto names = reader.read_str();
+  auto interactions = reader.read_bytes(num_rows * sizeof(uint32_t));
+  auto appear_percents = reader.read_bytes(num_rows * sizeof(double));
+  auto call_counts = reader.read_bytes(num_rows * sizeof(double));
+  auto order_percents = reader.read_bytes(num_rows * sizeof(double));
+  auto min_api_levels = reader.read_bytes(num_rows * sizeof(int16_t));
+  if (!reader.at_end()) {
+    std::cerr << "FAILED to parse binary profile. Trailing data\n";
+    return false;
+  }
+
+  auto get_name = [&](size_t row) {
+    auto begin = BinaryReader::load<uint32_t>(name_offsets, row);
+    auto end = BinaryReader::load<uint32_t>(name_offsets, row + 1);
+    always_assert_log(begin <= end && end <= names.size(),
+                      "Bad name offsets in binary method profile");
+    return names.substr(begin, end - begin);
+  };
+
+  // Resolution is the expensive part, and independent for each row.
+  std::vector<DexMethodRef*> refs(num_rows);
+  workqueue_run_for<size_t>(0, num_rows, [&](size_t row) {
+    refs[row] = DexMethod::get_method</*kCheckFormat=*/true>(get_name(row));
+  });
+
+  for (size_t row = 0; row < num_rows; ++row) {
+    auto interaction = BinaryReader::load<uint32_t>(interactions, row);
+    if (interaction >= interaction_ids.size()) {
+      std::cerr << "FAILED to parse binary profile. Bad interaction index\n";
+      return false;
+    }
+    auto* interaction_id = &interaction_ids[interaction];
+
+    ParsedMain parsed;
+    parsed.ref = refs[row];
+    parsed.stats.appear_percent =
+        BinaryReader::load<double>(appear_percents, row);
+    parsed.stats.call_count = BinaryReader::load<double>(call_counts, row);
+    parsed.stats.order_percent =
+        BinaryReader::load<double>(order_percents, row);
+    parsed.stats.min_api_level =
+        BinaryReader::load<int16_t>(min_api_levels, row);
+    if (parsed.ref == nullptr) {
+      // Same as for csv lines: keep what is needed to retry later.
+      TRACE(METH_PROF, 6, "failed to resolve %s", SHOW(get_name(row)));
+      parsed.ref_str = std::make_unique<std::string>(get_name(row));
+      parsed.mdt =
+          dex_member_refs::parse_method</*kCheckFormat=*/true>(*parsed.ref_str);
+    }
+    (void)apply_main_internal_result(std::move(parsed), interaction_id);
+  }
+
+  TRACE(METH_PROF, 1,
+        "MethodProfiles successfully parsed %zu binary rows; %zu unresolved "
+        "lines",
+        num_rows, unresolved_size());
+  return true;
+}
+
 // `strtol` and `strtod` requires c string to be null terminated,
 // std::string_view::data() doesn't have this guarantee. Our `string_view`s are
 // taken from `std::string`s. This should be safe.
@@ -354,26 +501,6 @@ size_t MethodProfiles::substitute_stats(
   return res;
 }
 
-bool MethodProfiles::parse_main(const std::string& line,
-                                std::string* interaction_id) {
-  auto result = parse_main_internal(line);
-  if (!result) {
-    return false;
-  }
-  (void)apply_main_internal_result(std::move(result.value()), interaction_id);
-  return true;
-}
-
-bool MethodProfiles::parse_line(const std::string& line) {
-  if (m_mode == MAIN) {
-    return parse_main(line, &m_interaction_id);
-  } else if (m_mode == METADATA) {
-    return parse_metadata(line);
-  } else {
-    always_assert_log(false, "invalid parsing mode");
-  }
-}
-
 boost::optional<uint32_t> MethodProfiles::get_interaction_count(
     const std::string& interaction_id) const {
   const auto& search = m_interaction_counts.find(interaction_id);
@@ -79,6 +79,16 @@ class MethodProfiles {
     }
   }
 
+  // Parse one more file without requiring that any of its rows resolve to a
+  // method, e.g. to validate a profile without loading the app. Returns false
+  // if the file could not be parsed.
+  bool parse_file(const std::string& csv_filename) {
+    m_initialized = true;
+    m_interaction_id = "";
+    m_mode = NONE;
+    return parse_stats_file(csv_filename);
+  }
+
   // For testing purposes.
   static MethodProfiles initialize(
       const std::string& interaction_id,
@@ -167,14 +177,32 @@ class MethodProfiles {
   bool m_initialized{false};
 
   // Read a "simple" csv file (no quoted commas or extra spaces) and populate
-  // m_method_stats
+  // m_method_stats. Files in the binary format (see below) are detected by
+  // their magic and handed to parse_binary_stats_file.
   bool parse_stats_file(const std::string& csv_filename);
 
-  // Read a line of data (not a header)
-  bool parse_line(const std::string& line);
-  // Read a line from the main section of the aggregated stats file and put an
-  // entry into m_method_stats
-  bool parse_main(const std::string& line, std::string* interaction_id);
+  // Populate m_method_stats from a columnar binary profile, as written by
+  // gen_binary_method_profile.py. All integers are little-endian; a str is a
+  // u4 size followed by that many bytes:
+  //
+  //   "RDXPRF01"
+  //   u4 #metadata, then per metadata line: str interaction, u4 appear#
+  //   u4 #interactions, then per interaction: str interaction
+  //   u4 #rows
+  //   u4 name_offsets[#rows + 1]    -- into the names blob
+  //   str names blob
+  //   u4 interaction_index[#rows]   -- the resolved interaction of each row
+  //   f8 appear100[#rows]
+  //   f8 avg_call[#rows]
+  //   f8 avg_rank100[#rows]
+  //   i2 min_api_level[#rows]
+  //
+  // Method names are resolved in parallel, rows are then applied in order.
+  bool parse_binary_stats_file(std::string_view data);
+
+  // Read a line from the main section of the aggregated stats file. The
+  // result is put into m_method_stats by apply_main_internal_result. Safe to
+  // call concurrently.
   std::optional<ParsedMain> parse_main_internal(std::string_view line);
   bool apply_main_internal_result(ParsedMain v, std::string* interaction_id);
   // Read a line of data from the metadata section (at the top of the file)
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "MethodStartupPageOrderer.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "BalancedPartitioning.h"
+#include "Debug.h"
+#include "IRCode.h"
+#include "Timer.h"
+
+namespace {
+
+// The number of time slices each interaction is cut into.
+constexpr uint32_t NUM_CUT_POINTS = 16;
+
+// The size of the encoded code item of a method: a 16-byte header followed by
+// the instructions, aligned to 4 bytes.
+size_t estimate_code_item_size(const DexMethod* method) {
+  size_t code_units;
+  if (method->get_code() != nullptr) {
+    code_units = method->get_code()->estimate_code_units();
+  } else if (method->get_dex_code() != nullptr) {
+    code_units = method->get_dex_code()->size();
+  } else {
+    return 0;
+  }
+  return (16 + 2 * code_units + 3) & ~size_t(3);
+}
+
+} // namespace
+
+void MethodStartupPageOrderer::order(std::vector<DexMethod*>& methods) const {
+  Timer t("Reordering " + std::to_string(methods.size()) +
+          " methods for startup using BP");
+  if (methods.empty() || !m_profiles.has_stats()) return;
+
+  std::vector<DexMethod*> profiled_methods;
+  std::vector<DexMethod*> unprofiled_methods;
+  std::vector<Document> documents;
+  documents.reserve(methods.size());
+  for (DexMethod* method : methods) {
+    std::vector<uint32_t> utilities;
+    uint32_t interaction_index = 0;
+    for (const auto& [interaction_id, stats] : m_profiles.all_interactions()) {
+      auto it = stats.find(method);
+      if (it != stats.end() &&
+          it->second.appear_percent >= m_min_appear_percent) {
+        auto first_cut = std::min(
+            NUM_CUT_POINTS - 1,
+            uint32_t(it->second.order_percent * NUM_CUT_POINTS / 100));
+        for (uint32_t cut = first_cut; cut < NUM_CUT_POINTS; ++cut) {
+          utilities.push_back(interaction_index * NUM_CUT_POINTS + cut);
+        }
+      }
+      ++interaction_index;
+    }
+    if (utilities.empty()) {
+      unprofiled_methods.push_back(method);
+      continue;
+    }
+    documents.emplace_back();
+    auto& doc = documents.back();
+    doc.init(profiled_methods.size());
+    doc.assign(utilities);
+    profiled_methods.push_back(method);
+  }
+
+  if (!documents.empty()) {
+    std::vector<Document*> documents_ptr;
+    documents_ptr.reserve(documents.size());
+    for (Document& doc : documents) {
+      documents_ptr.push_back(&doc);
+    }
+    BalancedPartitioning alg(documents_ptr);
+    alg.run();
+
+    std::vector<size_t> indices(profiled_methods.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+      always_assert(documents[i].bucket < documents.size());
+      indices[i] = i;
+    }
+    std::stable_sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
+      return documents[a].bucket < documents[b].bucket;
+    });
+    for (size_t i = 0; i < indices.size(); i++) {
+      methods[i] = profiled_methods[indices[i]];
+    }
+  }
+  std::copy(unprofiled_methods.begin(), unprofiled_methods.end(),
+            methods.begin() + profiled_methods.size());
+}
+
+size_t MethodStartupPageOrderer::estimate_pages(
+    const std::vector<const DexMethod*>& layout,
+    const method_profiles::StatsMap& stats,
+    double min_appear_percent) {
+  std::unordered_set<size_t> pages;
+  size_t offset = 0;
+  for (const auto* method : layout) {
+    auto size = estimate_code_item_size(method);
+    if (size == 0) {
+      continue;
+    }
+    auto it = stats.find(method);
+    if (it != stats.end() && it->second.appear_percent >= min_appear_percent) {
+      for (size_t page = offset / CODE_PAGE_SIZE;
+           page <= (offset + size - 1) / CODE_PAGE_SIZE; ++page) {
+        pages.insert(page);
+      }
+    }
+    offset += size;
+  }
+  return pages.size();
+}
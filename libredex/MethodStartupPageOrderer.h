@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "DexClass.h"
+#include "MethodProfiles.h"
+
+/**
+ * This object defines startup-conscious code placement.
+ *
+ * The goal of the placement is to collocate the methods executed by an
+ * interaction, so that running the interaction touches (and page-faults in)
+ * as few pages of the dex as possible. Following the same idea as the
+ * compression-conscious orderer, we build a bipartite graph and reorder it
+ * with balanced partitioning: one part is the profiled methods (Documents),
+ * the other part is a set of "utility" vertices. Each interaction is cut into
+ * a fixed number of time slices by the method's average first-execution
+ * order, and a method is connected to the utility vertex of every cut point
+ * after it first executes. Methods that run early share many utilities and
+ * end up next to each other, followed by the ones that run later.
+ *
+ * Methods that are not profiled in any interaction are kept in their original
+ * relative order after the profiled ones.
+ */
+class MethodStartupPageOrderer {
+ public:
+  static constexpr size_t CODE_PAGE_SIZE = 4096;
+
+  MethodStartupPageOrderer(const method_profiles::MethodProfiles& profiles,
+                           double min_appear_percent)
+      : m_profiles(profiles), m_min_appear_percent(min_appear_percent) {}
+
+  void order(std::vector<DexMethod*>& methods) const;
+
+  // Estimate the number of distinct pages that the code of the methods of an
+  // interaction occupies when all the methods are laid out contiguously in the
+  // given order. Code sizes are approximated, so this is only a proxy for the
+  // number of page faults.
+  static size_t estimate_pages(const std::vector<const DexMethod*>& layout,
+                               const method_profiles::StatsMap& stats,
+                               double min_appear_percent);
+
+ private:
+  const method_profiles::MethodProfiles& m_profiles;
+  double m_min_appear_percent;
+};
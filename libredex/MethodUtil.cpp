@@ -7,6 +7,8 @@
 
 #include "MethodUtil.h"
 
+#include <boost/functional/hash.hpp>
+
 #include "ControlFlow.h"
 #include "EditableCfgAdapter.h"
 #include "RedexContext.h"
@@ -535,33 +537,82 @@ bool may_be_invoke_target(const DexMethod* method) {
 WELL_KNOWN_METHODS
 #undef FOR_EACH
 
-DexMethod* kotlin_jvm_internal_Intrinsics_checkParameterIsNotNull() {
-  return static_cast<DexMethod*>(DexMethod::get_method(
-      "Lkotlin/jvm/internal/Intrinsics;.checkParameterIsNotNull:(Ljava/lang/"
-      "Object;Ljava/lang/String;)V"));
-}
-
-DexMethod* kotlin_jvm_internal_Intrinsics_checkNotNullParameter() {
-  return static_cast<DexMethod*>(DexMethod::get_method(
-      "Lkotlin/jvm/internal/Intrinsics;.checkNotNullParameter:(Ljava/lang/"
-      "Object;Ljava/lang/String;)V"));
-}
-
-DexMethod* kotlin_jvm_internal_Intrinsics_checExpressionValueIsNotNull() {
-  return static_cast<DexMethod*>(DexMethod::get_method(
-      "Lkotlin/jvm/internal/Intrinsics;.checkExpressionValueIsNotNull:(Ljava/"
-      "lang/Object;Ljava/lang/String;)V"));
-}
+#define DEFINE_CACHED_OPTIONAL_METHOD(func_name, _)                 \
+  DexMethod* func_name() {                                          \
+    return g_redex->pointers_cache().optional_method_##func_name(); \
+  }
 
-DexMethod* kotlin_jvm_internal_Intrinsics_checkNotNullExpressionValue() {
-  return static_cast<DexMethod*>(DexMethod::get_method(
-      "Lkotlin/jvm/internal/Intrinsics;.checkNotNullExpressionValue:(Ljava/"
-      "lang/Object;Ljava/lang/String;)V"));
-}
+#define FOR_EACH DEFINE_CACHED_OPTIONAL_METHOD
+OPTIONAL_WELL_KNOWN_METHODS
+#undef FOR_EACH
 
-DexMethod* redex_internal_checkObjectNotNull() {
-  return static_cast<DexMethod*>(DexMethod::get_method(
-      "Lredex/$NullCheck;.null_check:(Ljava/lang/Object;)V"));
+size_t code_fingerprint(const DexMethod* method) {
+  size_t seed = 0;
+  boost::hash_combine(seed, method->get_proto());
+  boost::hash_combine(seed, method->get_access());
+  auto* code = method->get_code();
+  if (code == nullptr) {
+    return seed;
+  }
+  auto hash_insn = [&seed](const IRInstruction* insn) {
+    boost::hash_combine(seed, insn->opcode());
+    if (insn->has_dest()) {
+      boost::hash_combine(seed, insn->dest());
+    }
+    for (auto src : insn->srcs()) {
+      boost::hash_combine(seed, src);
+    }
+    boost::hash_combine(seed, insn->hash());
+  };
+  if (code->editable_cfg_built()) {
+    auto& cfg = code->cfg();
+    boost::hash_combine(seed, cfg.get_registers_size());
+    boost::hash_combine(seed, cfg.entry_block()->id());
+    for (auto* block : cfg.blocks()) {
+      boost::hash_combine(seed, block->id());
+      for (const auto& mie : ir_list::ConstInstructionIterable(*block)) {
+        hash_insn(mie.insn);
+      }
+      for (auto* edge : block->succs()) {
+        boost::hash_combine(seed, edge->type());
+        boost::hash_combine(seed, edge->target()->id());
+        if (edge->case_key()) {
+          boost::hash_combine(seed, *edge->case_key());
+        }
+        if (edge->throw_info() != nullptr) {
+          boost::hash_combine(seed, edge->throw_info()->catch_type);
+          boost::hash_combine(seed, edge->throw_info()->index);
+        }
+      }
+    }
+    return seed;
+  }
+  boost::hash_combine(seed, code->get_registers_size());
+  for (auto& mie : *code) {
+    boost::hash_combine(seed, mie.type);
+    switch (mie.type) {
+    case MFLOW_OPCODE:
+      hash_insn(mie.insn);
+      break;
+    case MFLOW_TARGET:
+      boost::hash_combine(seed, mie.target->type);
+      boost::hash_combine(seed, mie.target->src);
+      boost::hash_combine(seed, mie.target->case_key);
+      break;
+    case MFLOW_TRY:
+      boost::hash_combine(seed, mie.tentry->type);
+      boost::hash_combine(seed, mie.tentry->catch_start);
+      break;
+    case MFLOW_CATCH:
+      boost::hash_combine(seed, &mie);
+      boost::hash_combine(seed, mie.centry->catch_type);
+      boost::hash_combine(seed, mie.centry->next);
+      break;
+    default:
+      break;
+    }
+  }
+  return seed;
 }
 
 }; // namespace method
@@ -135,15 +135,13 @@ WELL_KNOWN_METHODS
 #undef FOR_EACH
 #undef DECLARE_METHOD
 
-DexMethod* kotlin_jvm_internal_Intrinsics_checkParameterIsNotNull();
+// These return nullptr if the method does not exist.
+#define DECLARE_OPTIONAL_METHOD(name, _) DexMethod* name();
 
-DexMethod* kotlin_jvm_internal_Intrinsics_checkNotNullParameter();
-
-DexMethod* kotlin_jvm_internal_Intrinsics_checExpressionValueIsNotNull();
-
-DexMethod* kotlin_jvm_internal_Intrinsics_checkNotNullExpressionValue();
-
-DexMethod* redex_internal_checkObjectNotNull();
+#define FOR_EACH DECLARE_OPTIONAL_METHOD
+OPTIONAL_WELL_KNOWN_METHODS
+#undef FOR_EACH
+#undef DECLARE_OPTIONAL_METHOD
 
 inline unsigned count_opcode_of_types(
     const cfg::ControlFlowGraph& cfg,
@@ -171,4 +169,12 @@ inline unsigned count_opcode_of_types(
   return ret;
 }
 
+/**
+ * A fingerprint of a method's signature and code, covering everything that
+ * the IRTypeChecker and the property checkers look at. Pointers of list
+ * entries are included as-is: an unchanged method keeps them, and a changed
+ * one at worst gets rechecked.
+ */
+size_t code_fingerprint(const DexMethod* method);
+
 }; // namespace method
@@ -13,6 +13,7 @@
 #include <cstring>
 #include <fstream>
 #include <json/value.h>
+#include <json/writer.h>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -28,6 +29,8 @@
 #include "Show.h"
 #include "Trace.h"
 
+#include <zlib.h>
+
 namespace {
 
 /**
@@ -171,8 +174,7 @@ std::shared_ptr<MethodOptData> ClassOptData::get_meth_opt_data(
 }
 
 std::shared_ptr<ClassOptData> OptDataMapper::get_cls_opt_data(
-    DexType* cls_type) {
-  auto cls = type_class(cls_type);
+    const DexClass* cls) {
   const auto& kv_pair = m_cls_opt_map.find(cls);
   if (kv_pair == m_cls_opt_map.end()) {
     auto cls_opt_data = std::make_shared<ClassOptData>(cls);
@@ -182,19 +184,84 @@ std::shared_ptr<ClassOptData> OptDataMapper::get_cls_opt_data(
   return kv_pair->second;
 }
 
+OptDataMapper::LogBuffer& OptDataMapper::get_thread_buffer() {
+  // The mapper is a singleton, so the buffer of a thread is never stale.
+  thread_local LogBuffer* buffer = nullptr;
+  if (buffer == nullptr) {
+    std::lock_guard<std::mutex> guard(s_opt_log_mutex);
+    m_buffers.push_back(std::make_unique<LogBuffer>());
+    buffer = m_buffers.back().get();
+  }
+  return *buffer;
+}
+
+void OptDataMapper::append(const DexClass* cls,
+                           const DexMethod* method,
+                           const IRInstruction* insn,
+                           int reason,
+                           bool is_opt) {
+  auto& buffer = get_thread_buffer();
+  if (method != nullptr && !buffer.methods.count(method)) {
+    buffer.methods.emplace(method, std::make_shared<MethodOptData>(method));
+  }
+  if (insn != nullptr && !buffer.insns.count(insn)) {
+    buffer.insns.emplace(insn, std::make_shared<InsnOptData>(method, insn));
+  }
+  buffer.records.push_back(LogRecord{cls, method, insn, reason, is_opt});
+}
+
+void OptDataMapper::flush_buffers() {
+  std::lock_guard<std::mutex> guard(s_opt_log_mutex);
+  for (auto& buffer : m_buffers) {
+    for (const auto& record : buffer->records) {
+      auto cls_opt_data = get_cls_opt_data(record.cls);
+      if (record.method == nullptr) {
+        if (record.is_opt) {
+          cls_opt_data->m_opts.emplace_back((OptReason)record.reason);
+        } else {
+          cls_opt_data->m_nopts.emplace_back((NoptReason)record.reason);
+        }
+        continue;
+      }
+      // When several threads logged the same method or insn, the first
+      // buffer's description wins.
+      auto meth_opt_data =
+          cls_opt_data->m_meth_opt_map
+              .emplace(record.method, buffer->methods.at(record.method))
+              .first->second;
+      if (record.insn == nullptr) {
+        if (record.is_opt) {
+          meth_opt_data->m_opts.emplace_back((OptReason)record.reason);
+        } else {
+          meth_opt_data->m_nopts.emplace_back((NoptReason)record.reason);
+        }
+        continue;
+      }
+      auto insn_opt_data =
+          meth_opt_data->m_insn_opt_map
+              .emplace(record.insn, buffer->insns.at(record.insn))
+              .first->second;
+      if (record.is_opt) {
+        insn_opt_data->m_opts.emplace_back((OptReason)record.reason);
+      } else {
+        insn_opt_data->m_nopts.emplace_back((NoptReason)record.reason);
+      }
+    }
+    buffer->records.clear();
+    buffer->methods.clear();
+    buffer->insns.clear();
+  }
+}
+
 void OptDataMapper::log_opt(OptReason opt,
                             const DexMethod* method,
                             const IRInstruction* insn) {
   if (!m_logs_enabled) {
     return;
   }
-  std::lock_guard<std::mutex> guard(s_opt_log_mutex);
   always_assert_log(method != nullptr, "Can't log null method\n");
   always_assert_log(insn != nullptr, "Can't log null instruction\n");
-  auto cls_opt_data = get_cls_opt_data(method->get_class());
-  auto meth_opt_data = cls_opt_data->get_meth_opt_data(method);
-  auto insn_opt_data = meth_opt_data->get_insn_opt_data(insn);
-  insn_opt_data->m_opts.emplace_back(opt);
+  append(type_class(method->get_class()), method, insn, opt, true);
 }
 
 void OptDataMapper::log_nopt(NoptReason nopt,
@@ -203,55 +270,41 @@ void OptDataMapper::log_nopt(NoptReason nopt,
   if (!m_logs_enabled) {
     return;
   }
-  std::lock_guard<std::mutex> guard(s_opt_log_mutex);
   always_assert_log(method != nullptr, "Can't log null method\n");
   always_assert_log(insn != nullptr, "Can't log null instruction\n");
-  auto cls_opt_data = get_cls_opt_data(method->get_class());
-  auto meth_opt_data = cls_opt_data->get_meth_opt_data(method);
-  auto insn_opt_data = meth_opt_data->get_insn_opt_data(insn);
-  insn_opt_data->m_nopts.emplace_back(nopt);
+  append(type_class(method->get_class()), method, insn, nopt, false);
 }
 
 void OptDataMapper::log_opt(OptReason opt, const DexMethod* method) {
   if (!m_logs_enabled) {
     return;
   }
-  std::lock_guard<std::mutex> guard(s_opt_log_mutex);
   always_assert_log(method != nullptr, "Can't log null method\n");
-  auto cls_opt_data = get_cls_opt_data(method->get_class());
-  auto meth_opt_data = cls_opt_data->get_meth_opt_data(method);
-  meth_opt_data->m_opts.emplace_back(opt);
+  append(type_class(method->get_class()), method, nullptr, opt, true);
 }
 
 void OptDataMapper::log_nopt(NoptReason nopt, const DexMethod* method) {
   if (!m_logs_enabled) {
     return;
   }
-  std::lock_guard<std::mutex> guard(s_opt_log_mutex);
   always_assert_log(method != nullptr, "Can't log null method\n");
-  auto cls_opt_data = get_cls_opt_data(method->get_class());
-  auto meth_opt_data = cls_opt_data->get_meth_opt_data(method);
-  meth_opt_data->m_nopts.emplace_back(nopt);
+  append(type_class(method->get_class()), method, nullptr, nopt, false);
 }
 
 void OptDataMapper::log_opt(OptReason opt, const DexClass* cls) {
   if (!m_logs_enabled) {
     return;
   }
-  std::lock_guard<std::mutex> guard(s_opt_log_mutex);
   always_assert_log(cls != nullptr, "Can't log null class\n");
-  auto cls_opt_data = get_cls_opt_data(cls->get_type());
-  cls_opt_data->m_opts.emplace_back(opt);
+  append(cls, nullptr, nullptr, opt, true);
 }
 
 void OptDataMapper::log_nopt(NoptReason nopt, const DexClass* cls) {
   if (!m_logs_enabled) {
     return;
   }
-  std::lock_guard<std::mutex> guard(s_opt_log_mutex);
   always_assert_log(cls != nullptr, "Can't log null class\n");
-  auto cls_opt_data = get_cls_opt_data(cls->get_type());
-  cls_opt_data->m_nopts.emplace_back(nopt);
+  append(cls, nullptr, nullptr, nopt, false);
 }
 
 Json::Value OptDataMapper::serialize_sql() {
@@ -266,6 +319,7 @@ Json::Value OptDataMapper::serialize_sql() {
   constexpr const char* CLASSES = "classes";
   constexpr const char* OPT_MESSAGES = "opt_messages";
   constexpr const char* NOPT_MESSAGES = "nopt_messages";
+  flush_buffers();
   Json::Value top;
 
   Json::Value opt_msg_arr;
@@ -321,6 +375,24 @@ Json::Value OptDataMapper::serialize_sql() {
   return top;
 }
 
+void OptDataMapper::write_sql(const std::string& path, bool compress) {
+  auto opt_data = serialize_sql();
+  if (!compress) {
+    std::ofstream opt_data_out(path);
+    opt_data_out << opt_data;
+    return;
+  }
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  auto json = Json::writeString(builder, opt_data);
+  auto* file = gzopen(path.c_str(), "wb");
+  always_assert_log(file != nullptr, "Could not open %s\n", path.c_str());
+  auto written = gzwrite(file, json.data(), json.size());
+  always_assert_log(written == (int)json.size(), "Could not write %s\n",
+                    path.c_str());
+  gzclose(file);
+}
+
 void OptDataMapper::serialize_messages_helper(
     const std::unordered_map<int, std::string>& msg_map, Json::Value* arr) {
   for (const auto& reason_msg_pair : msg_map) {
@@ -11,6 +11,7 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "DexClass.h"
 #include "IRInstruction.h"
@@ -129,6 +130,10 @@ class ClassOptData {
 
 /**
  * Records and expresses optimization data.
+ *
+ * Logged decisions are appended to a buffer owned by the logging thread, so
+ * that logging from parallel walks doesn't contend on a lock. The buffers are
+ * merged into the per-class/method/insn data when serializing.
  */
 class OptDataMapper {
  public:
@@ -176,8 +181,37 @@ class OptDataMapper {
    */
   Json::Value serialize_sql();
 
+  /**
+   * Writes the result of serialize_sql() to the given file. When compressing,
+   * the json is written without indentation and gzipped.
+   */
+  void write_sql(const std::string& path, bool compress);
+
  private:
+  struct LogRecord {
+    const DexClass* cls;
+    // Null for class-level records.
+    const DexMethod* method;
+    // Null for class- and method-level records.
+    const IRInstruction* insn;
+    int reason; // OptReason or NoptReason
+    bool is_opt;
+  };
+
+  struct LogBuffer {
+    std::vector<LogRecord> records;
+    // Methods and instructions are described when first logged by this
+    // thread, as they may have been changed or deleted by the time the
+    // buffer is flushed.
+    std::unordered_map<const DexMethod*, std::shared_ptr<MethodOptData>>
+        methods;
+    std::unordered_map<const IRInstruction*, std::shared_ptr<InsnOptData>>
+        insns;
+  };
+
   bool m_logs_enabled{false};
+  // Guarded by s_opt_log_mutex.
+  std::vector<std::unique_ptr<LogBuffer>> m_buffers;
   std::unordered_map<const DexClass*, std::shared_ptr<ClassOptData>>
       m_cls_opt_map;
   std::unordered_map<int /*OptReason*/, std::string> m_opt_msg_map;
@@ -189,10 +223,26 @@ class OptDataMapper {
   }
 
   /**
-   * Finds and returns a ClassOptData for the given class type. If the
+   * Finds and returns a ClassOptData for the given class. If the
    * ClassOptData doesn't yet exist, construct it and return.
    */
-  std::shared_ptr<ClassOptData> get_cls_opt_data(DexType* cls_type);
+  std::shared_ptr<ClassOptData> get_cls_opt_data(const DexClass* cls);
+
+  /**
+   * Returns the buffer of the calling thread, registering it on first use.
+   */
+  LogBuffer& get_thread_buffer();
+
+  void append(const DexClass* cls,
+              const DexMethod* method,
+              const IRInstruction* insn,
+              int reason,
+              bool is_opt);
+
+  /**
+   * Moves the records of all thread buffers into m_cls_opt_map.
+   */
+  void flush_buffers();
 
   /**
    * For the table {msg_type}_messages, append each row as an entry to arr.
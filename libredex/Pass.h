@@ -39,6 +39,14 @@ class Pass : public Configurable {
   // \returns True means this pass is NOT guaranteed to fully use editable cfg.
   virtual bool is_cfg_legacy() { return false; }
 
+  // \returns True if the pass is deterministic and its only effect is on the
+  // classes of the scope (as fingerprinted by DexScopeHasher), so that the
+  // PassManager may skip it when its cached result for the same input and
+  // configuration shows that it is a no-op. Passes that write meta files,
+  // keep state for later passes, or change the dex partitioning must not
+  // override this.
+  virtual bool supports_incremental_cache() const { return false; }
+
   virtual void destroy_analysis_result() {
     always_assert_log(m_kind != ANALYSIS,
                       "destroy_analysis_result not implemented for %s",
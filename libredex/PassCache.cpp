@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "PassCache.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <json/json.h>
+
+#include "Debug.h"
+#include "Trace.h"
+
+namespace {
+
+constexpr const char* CACHE_FILE = "pass_cache.json";
+// Bump whenever the meaning of the fingerprints changes.
+constexpr int CACHE_VERSION = 1;
+
+} // namespace
+
+PassCache::PassCache(std::string dir) : m_dir(std::move(dir)) {
+  if (!enabled()) {
+    return;
+  }
+  std::ifstream input(path());
+  if (!input) {
+    TRACE(PM, 1, "No pass cache at %s", path().c_str());
+    return;
+  }
+  Json::Reader reader;
+  Json::Value root;
+  if (!reader.parse(input, root) || !root.isObject() ||
+      root.get("version", 0).asInt() != CACHE_VERSION) {
+    TRACE(PM, 1, "Ignoring stale or malformed pass cache at %s",
+          path().c_str());
+    return;
+  }
+  const auto& entries = root["entries"];
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    Entry entry;
+    entry.input_hash = (*it)["input"].asString();
+    entry.config_hash = (*it)["config"].asString();
+    entry.output_hash = (*it)["output"].asString();
+    const auto& metrics = (*it)["metrics"];
+    for (auto m_it = metrics.begin(); m_it != metrics.end(); ++m_it) {
+      entry.metrics[m_it.key().asString()] = m_it->asInt64();
+    }
+    m_entries.emplace(it.key().asString(), std::move(entry));
+  }
+  TRACE(PM, 1, "Loaded %zu pass cache entries from %s", m_entries.size(),
+        path().c_str());
+}
+
+boost::optional<const PassCache::Entry&> PassCache::find_noop(
+    const std::string& key,
+    const std::string& input_hash,
+    const std::string& config_hash) const {
+  auto it = m_entries.find(key);
+  if (it == m_entries.end()) {
+    return boost::none;
+  }
+  const auto& entry = it->second;
+  if (entry.input_hash != input_hash || entry.config_hash != config_hash ||
+      entry.output_hash != input_hash) {
+    return boost::none;
+  }
+  return entry;
+}
+
+void PassCache::record(const std::string& key, Entry entry) {
+  m_entries[key] = std::move(entry);
+  m_dirty = true;
+}
+
+void PassCache::save() const {
+  if (!enabled() || !m_dirty) {
+    return;
+  }
+  Json::Value entries(Json::objectValue);
+  for (const auto& [key, entry] : m_entries) {
+    Json::Value value;
+    value["input"] = entry.input_hash;
+    value["config"] = entry.config_hash;
+    value["output"] = entry.output_hash;
+    Json::Value metrics(Json::objectValue);
+    for (const auto& [name, metric] : entry.metrics) {
+      metrics[name] = (Json::Int64)metric;
+    }
+    value["metrics"] = std::move(metrics);
+    entries[key] = std::move(value);
+  }
+  Json::Value root;
+  root["version"] = CACHE_VERSION;
+  root["entries"] = std::move(entries);
+
+  boost::filesystem::create_directories(m_dir);
+  std::ofstream out(path());
+  out << root;
+  always_assert_log(out.good(), "Could not write pass cache to %s",
+                    path().c_str());
+}
+
+std::string PassCache::fingerprint(const hashing::DexHash& hash) {
+  return hashing::hash_to_string(hash.positions_hash) + ":" +
+         hashing::hash_to_string(hash.registers_hash) + ":" +
+         hashing::hash_to_string(hash.code_hash) + ":" +
+         hashing::hash_to_string(hash.signature_hash);
+}
+
+std::string PassCache::path() const { return m_dir + "/" + CACHE_FILE; }
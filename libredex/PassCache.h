@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "DexHasher.h"
+
+/*
+ * An on-disk cache of pass results, used to skip work across builds that
+ * only differ slightly.
+ *
+ * Each entry is keyed by the pass' position in the pipeline and remembers the
+ * fingerprint (DexScopeHasher) of the scope the pass ran on, a digest of the
+ * pass configuration, the fingerprint of the resulting scope, and the metrics
+ * the pass reported.
+ *
+ * As the PassManager cannot yet restore IR from disk, a cached result can only
+ * be replayed when the pass left the scope unchanged: then running the pass
+ * again on the same input, with the same configuration, is known to be a
+ * no-op, and the PassManager only needs to replay the metrics. Only passes
+ * that opt in via `Pass::supports_incremental_cache()` are considered.
+ */
+class PassCache {
+ public:
+  struct Entry {
+    std::string input_hash;
+    std::string config_hash;
+    std::string output_hash;
+    std::unordered_map<std::string, int64_t> metrics;
+  };
+
+  // Loads the cache from `dir`. An empty `dir` disables the cache. A missing
+  // or malformed cache file yields an empty cache.
+  explicit PassCache(std::string dir);
+
+  bool enabled() const { return !m_dir.empty(); }
+
+  // Returns the cached entry for `key`, if the recorded run saw the same input
+  // and configuration and did not change the scope.
+  boost::optional<const Entry&> find_noop(const std::string& key,
+                                          const std::string& input_hash,
+                                          const std::string& config_hash) const;
+
+  void record(const std::string& key, Entry entry);
+
+  // Writes the cache back to disk, if anything was recorded.
+  void save() const;
+
+  static std::string fingerprint(const hashing::DexHash& hash);
+
+  size_t hits() const { return m_hits; }
+  void count_hit() { ++m_hits; }
+
+ private:
+  std::string path() const;
+
+  std::string m_dir;
+  std::unordered_map<std::string, Entry> m_entries;
+  bool m_dirty{false};
+  size_t m_hits{0};
+};
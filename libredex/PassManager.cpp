@@ -8,20 +8,27 @@
 #include "PassManager.h"
 #include "DexAssessments.h"
 
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
+#include <atomic>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <iostream>
 #include <json/json.h>
 #include <limits>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <thread>
 #include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
 
 #ifdef __linux__
@@ -35,9 +42,12 @@
 #include "AssetManager.h"
 #include "CFGMutation.h"
 #include "CallGraph.h"
+#include "ChromeTrace.h"
 #include "ClassChecker.h"
 #include "CommandProfiling.h"
+#include "ConcurrentContainers.h"
 #include "ConfigFiles.h"
+#include "ControlFlow.h"
 #include "Debug.h"
 #include "DexClass.h"
 #include "DexLoader.h"
@@ -51,15 +61,19 @@
 #include "InstructionLowering.h"
 #include "JemallocUtil.h"
 #include "MethodProfiles.h"
+#include "MethodUtil.h"
 #include "Native.h"
 #include "OptData.h"
 #include "Pass.h"
+#include "PassCache.h"
 #include "PrintSeeds.h"
 #include "ProguardPrintConfiguration.h"
 #include "ProguardReporting.h"
 #include "Purity.h"
 #include "ReachableClasses.h"
+#include "RedexContext.h"
 #include "RedexPropertiesManager.h"
+#include "Resolver.h"
 #include "Sanitizers.h"
 #include "ScopedCFG.h"
 #include "ScopedMemStats.h"
@@ -78,6 +92,7 @@ AccumulatingTimer m_check_unique_deobfuscateds_timer{
 
 constexpr const char* INCOMING_HASHES = "incoming_hashes.txt";
 constexpr const char* OUTGOING_HASHES = "outgoing_hashes.txt";
+constexpr const char* PASS_HASHES = "redex-pass-hashes.txt";
 constexpr const char* REMOVABLE_NATIVES = "redex-removable-natives.txt";
 const std::string PASS_ORDER_KEY = "pass_order";
 
@@ -92,12 +107,127 @@ const Pass* get_profiled_pass(const PassManager& mgr) {
   return pass;
 }
 
+// The profiler for this run of `pass`, if the config selects the pass. The
+// "{data}" placeholder in the commands is replaced by a profile file in the
+// meta directory, named after the pass and run.
+boost::optional<ScopedCommandProfiling::ProfilerInfo> get_pass_profiler_info(
+    const PassManagerConfig& pm_config,
+    const ConfigFiles& conf,
+    const Pass* pass,
+    size_t run) {
+  if (!pm_config.profile_passes.count(pass->name())) {
+    return boost::none;
+  }
+  auto data_file = conf.metafile("redex-profile-" + pass->name() + "-" +
+                                 std::to_string(run) + ".perf.data");
+  auto substitute = [&](std::string cmd) {
+    boost::replace_all(cmd, "{data}", data_file);
+    return cmd;
+  };
+  ScopedCommandProfiling::ProfilerInfo info(
+      substitute(pm_config.profile_command), boost::none,
+      pm_config.profile_post_command.empty()
+          ? boost::none
+          : boost::make_optional(substitute(pm_config.profile_post_command)));
+  info.data_file = data_file;
+  return info;
+}
+
 std::string get_apk_dir(const ConfigFiles& config) {
   auto apkdir = config.get_json_config()["apk_dir"].asString();
   apkdir.erase(std::remove(apkdir.begin(), apkdir.end(), '"'), apkdir.end());
   return apkdir;
 }
 
+// Reports how many methods each pass added, removed or changed, by comparing
+// method fingerprints before and after the pass.
+class ChangedMethodsTracker {
+ public:
+  explicit ChangedMethodsTracker(bool enabled) : m_enabled(enabled) {}
+
+  void run_initially(const Scope& scope) {
+    if (m_enabled) {
+      m_fingerprints = compute(scope);
+    }
+  }
+
+  void run_after_pass(PassManager& mgr, const Pass* pass, const Scope& scope) {
+    if (!m_enabled) {
+      return;
+    }
+    auto fingerprints = compute(scope);
+    size_t added = 0;
+    size_t changed = 0;
+    for (const auto& [method, fingerprint] : fingerprints) {
+      auto it = m_fingerprints.find(method);
+      if (it == m_fingerprints.end()) {
+        added++;
+        TRACE(PM, 3, "%s added %s", pass->name().c_str(), SHOW(method));
+      } else if (it->second != fingerprint) {
+        changed++;
+        TRACE(PM, 3, "%s changed %s", pass->name().c_str(), SHOW(method));
+      }
+    }
+    size_t removed = m_fingerprints.size() + added - fingerprints.size();
+    TRACE(PM, 1, "%s added %zu, removed %zu and changed %zu methods",
+          pass->name().c_str(), added, removed, changed);
+    ScopedMetrics sm(mgr);
+    sm.set_metric("changed_methods.added", added);
+    sm.set_metric("changed_methods.removed", removed);
+    sm.set_metric("changed_methods.changed", changed);
+    m_fingerprints = std::move(fingerprints);
+  }
+
+ private:
+  static std::unordered_map<const DexMethod*, size_t> compute(
+      const Scope& scope) {
+    std::vector<const DexMethod*> methods;
+    walk::methods(scope, [&](DexMethod* m) { methods.push_back(m); });
+    std::vector<size_t> fingerprints(methods.size());
+    workqueue_run_for<size_t>(0, methods.size(), [&](size_t i) {
+      fingerprints[i] = method::code_fingerprint(methods[i]);
+    });
+    std::unordered_map<const DexMethod*, size_t> res;
+    res.reserve(methods.size());
+    for (size_t i = 0; i < methods.size(); i++) {
+      res.emplace(methods[i], fingerprints[i]);
+    }
+    return res;
+  }
+
+  bool m_enabled;
+  std::unordered_map<const DexMethod*, size_t> m_fingerprints;
+};
+
+// Frees the code of methods that are still interned but no longer belong to
+// any class in the scope, e.g. because a pass removed them from their class
+// without deleting them. Such code otherwise stays alive until exit.
+void release_detached_code(PassManager& mgr, const Scope& scope) {
+  Timer t("Release detached code");
+  std::unordered_set<const DexMethod*> attached;
+  walk::methods(scope, [&](DexMethod* m) { attached.insert(m); });
+  std::unordered_set<DexMethod*> detached;
+  g_redex->walk_methods([&](DexMethodRef* mref) {
+    if (mref->is_def() && !attached.count(mref->as_def())) {
+      detached.insert(mref->as_def());
+    }
+  });
+  size_t released_methods = 0;
+  size_t released_code_units = 0;
+  for (auto* method : detached) {
+    auto code = method->release_code();
+    if (code) {
+      released_methods++;
+      released_code_units += code->estimate_code_units();
+    }
+  }
+  TRACE(PM, 1, "Released the code of %zu detached methods (%zu code units)",
+        released_methods, released_code_units);
+  ScopedMetrics sm(mgr);
+  sm.set_metric("compaction.released_methods", released_methods);
+  sm.set_metric("compaction.released_code_units", released_code_units);
+}
+
 class CheckerConfig {
  public:
   explicit CheckerConfig(const ConfigFiles& conf, bool relaxed_init_check)
@@ -123,6 +253,11 @@ class CheckerConfig {
 
     m_check_classes = type_checker_args.get("check_classes", true).asBool();
 
+    if (type_checker_args.get("skip_unchanged_methods", false).asBool()) {
+      m_checked_fingerprints =
+          std::make_shared<ConcurrentMap<const DexMethod*, size_t>>();
+    }
+
     for (auto& trigger_pass : type_checker_args["run_after_passes"]) {
       m_type_checker_trigger_passes.insert(trigger_pass.asString());
     }
@@ -242,14 +377,33 @@ class CheckerConfig {
       return code->editable_cfg_built() ? show(code->cfg()) : show(code);
     };
 
+    // Fingerprints also cover the checker settings, which differ between
+    // the input, per-pass and final runs.
+    size_t settings = m_validate_access | (m_check_no_overwrite_this << 1);
+    std::atomic<size_t> skipped{0};
     auto res =
         walk::parallel::methods<Result>(scope, [&](DexMethod* dex_method) {
+          size_t fingerprint = 0;
+          if (m_checked_fingerprints) {
+            fingerprint = method::code_fingerprint(dex_method);
+            boost::hash_combine(fingerprint, settings);
+            if (m_checked_fingerprints->get(dex_method, 0) == fingerprint) {
+              skipped.fetch_add(1, std::memory_order_relaxed);
+              return Result();
+            }
+          }
           auto checker = run_checker(dex_method);
           if (!checker.fail()) {
+            if (m_checked_fingerprints) {
+              m_checked_fingerprints->insert_or_assign(
+                  std::make_pair(dex_method, fingerprint));
+            }
             return Result();
           }
           return Result(dex_method);
         });
+    TRACE(PM, 1, "IRTypeChecker skipped %zu unchanged methods",
+          skipped.load());
 
     if (res.errors != 0) {
       // Re-run the smallest method to produce error message.
@@ -312,6 +466,10 @@ class CheckerConfig {
   bool m_annotated_cfg_on_error{false};
   bool m_annotated_cfg_on_error_reduced{true};
   bool m_check_classes;
+  // Fingerprints of methods that passed, shared by all copies of this config.
+  // Only set with `skip_unchanged_methods`.
+  std::shared_ptr<ConcurrentMap<const DexMethod*, size_t>>
+      m_checked_fingerprints;
   bool m_relaxed_init_check;
 };
 
@@ -416,26 +574,33 @@ class VisualizerHelper {
 class AnalysisUsageHelper {
  public:
   using PreservedMap = std::unordered_map<AnalysisID, Pass*>;
+  using ReuseStatsMap =
+      std::unordered_map<AnalysisID, PassManager::AnalysisReuseStats>;
 
-  explicit AnalysisUsageHelper(PreservedMap& m)
-      : m_preserved_analysis_passes(m) {}
+  AnalysisUsageHelper(PreservedMap& m, ReuseStatsMap& stats)
+      : m_preserved_analysis_passes(m), m_reuse_stats(stats) {}
 
   void pre_pass(Pass* pass) { pass->set_analysis_usage(m_analysis_usage); }
 
-  void post_pass(Pass* pass) {
+  // `wall_seconds` is how long the pass took; zero if it didn't actually run.
+  void post_pass(Pass* pass, double wall_seconds = 0) {
     // Invalidate existing preserved analyses according to policy set by each
     // pass.
     m_analysis_usage.do_pass_invalidation(&m_preserved_analysis_passes);
 
     if (pass->is_analysis_pass()) {
       // If the pass is an analysis pass, preserve it.
-      m_preserved_analysis_passes.emplace(get_analysis_id_by_pass(pass), pass);
+      auto id = get_analysis_id_by_pass(pass);
+      m_preserved_analysis_passes.emplace(id, pass);
+      // Later reuses save a build of the most recent computation.
+      m_reuse_stats[id].build_seconds = wall_seconds;
     }
   }
 
  private:
   AnalysisUsage m_analysis_usage;
   PreservedMap& m_preserved_analysis_passes;
+  ReuseStatsMap& m_reuse_stats;
 };
 
 class JNINativeContextHelper {
@@ -623,6 +788,47 @@ bool is_run_hasher_after_each_pass(const ConfigFiles& conf,
   return hasher_args.get("run_after_each_pass", false).asBool();
 }
 
+// Writes the scope hash after every pass to the meta directory and, if the
+// hasher config names the file of a previous run as "reference_pass_hashes",
+// fails at the first pass whose hash differs from it. Nondeterminism then
+// shows up in the pass that introduced it, within a single run.
+class PassHashStream {
+ public:
+  explicit PassHashStream(const ConfigFiles& conf) {
+    m_out.open(conf.metafile(PASS_HASHES));
+    const Json::Value& hasher_args = conf.get_json_config()["hasher"];
+    auto reference = hasher_args.get("reference_pass_hashes", "").asString();
+    if (!reference.empty()) {
+      m_reference.open(reference);
+      always_assert_log(m_reference.is_open(),
+                        "Cannot open reference pass hashes %s",
+                        reference.c_str());
+    }
+  }
+
+  void record(const std::string& pass_name, const hashing::DexHash& hash) {
+    auto line = pass_name + " code#" + hashing::hash_to_string(hash.code_hash) +
+                " registers#" + hashing::hash_to_string(hash.registers_hash) +
+                " positions#" + hashing::hash_to_string(hash.positions_hash) +
+                " signature#" + hashing::hash_to_string(hash.signature_hash);
+    m_out << line << std::endl;
+    if (!m_reference.is_open()) {
+      return;
+    }
+    std::string expected;
+    always_assert_log(std::getline(m_reference, expected),
+                      "Reference pass hashes end before %s", pass_name.c_str());
+    always_assert_log(line == expected,
+                      "Scope hash diverges from the reference after %s:\n"
+                      "  actual:   %s\n  expected: %s",
+                      pass_name.c_str(), line.c_str(), expected.c_str());
+  }
+
+ private:
+  std::ofstream m_out;
+  std::ifstream m_reference;
+};
+
 void ensure_editable_cfg(DexStoresVector& stores) {
   auto temp_scope = build_class_scope(stores);
   walk::parallel::code(temp_scope, [&](DexMethod*, IRCode& code) {
@@ -1073,13 +1279,41 @@ struct JemallocStats {
     full_stats = pmc->jemalloc_full_stats;
   }
 
+  // Stats as of the start of the current pass.
+  std::unordered_map<std::string, uint64_t> before_pass;
+
+  void snapshot_before_pass() {
+#ifdef USE_JEMALLOC
+    before_pass.clear();
+    jemalloc_util::some_malloc_stats([&](const char* key, uint64_t value) {
+      before_pass.emplace(key, value);
+    });
+#endif
+  }
+
   void process_jemalloc_stats_for_pass(const Pass* pass, size_t run) {
 #ifdef USE_JEMALLOC
     std::string key_base = "~jemalloc.";
+    uint64_t allocated = 0;
+    uint64_t active = 0;
     auto cb = [&](const char* key, uint64_t value) {
       pm->set_metric(key_base + key, value);
+      // What the pass left behind for later passes, e.g. caches that were
+      // never released.
+      auto it = before_pass.find(key);
+      if (it != before_pass.end()) {
+        pm->set_metric(key_base + "retained_by_pass." + key,
+                       (int64_t)value - (int64_t)it->second);
+      }
+      if (strcmp(key, "stats.allocated") == 0) {
+        allocated = value;
+      } else if (strcmp(key, "stats.active") == 0) {
+        active = value;
+      }
     };
     jemalloc_util::some_malloc_stats(cb);
+    // Bytes in active pages that are not in use by the application.
+    pm->set_metric(key_base + "fragmentation", (int64_t)(active - allocated));
 
     if (full_stats) {
       std::string name =
@@ -1294,6 +1528,8 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
       conf.get_global_config().get_config_by_name<PassManagerConfig>(
           "pass_manager");
   redex_assert(pm_config != nullptr);
+  redex_parallel::set_concurrent_cost_budget(
+      pm_config->max_concurrent_code_units);
 
   auto profiler_info = ScopedCommandProfiling::maybe_info_from_env("");
   const Pass* profiler_info_pass = nullptr;
@@ -1314,6 +1550,7 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
 
   // Clear stale data. Make sure we start fresh.
   m_preserved_analysis_passes.clear();
+  m_analysis_reuse_stats.clear();
 
   {
     Timer t("API Level Checker");
@@ -1352,13 +1589,20 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
   // against the *initial* methods
   conf.get_method_profiles();
 
+  boost::optional<PassHashStream> pass_hash_stream;
   if (run_hasher_after_each_pass) {
     m_initial_hash = run_hasher(nullptr, scope);
+    pass_hash_stream.emplace(conf);
+    pass_hash_stream->record("(initial)", *m_initial_hash);
   }
 
   CheckUniqueDeobfuscatedNames check_unique_deobfuscated{conf};
   check_unique_deobfuscated.run_initially(scope);
 
+  ChangedMethodsTracker changed_methods_tracker{
+      pm_config->track_changed_methods};
+  changed_methods_tracker.run_initially(scope);
+
   VisualizerHelper graph_visualizer(conf);
   ViolationsTracking violatios_tracking(
       pm_config->violations_tracking ||
@@ -1404,14 +1648,11 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
   auto post_pass_verifiers = [&](Pass* pass, size_t i, size_t size) {
     ConcurrentSet<const DexMethodRef*> all_code_referenced_methods;
     ConcurrentSet<DexMethod*> unique_methods;
-    bool is_editable_cfg_friendly = !pass->is_cfg_legacy();
-    walk::parallel::code(build_class_scope(stores), [&](DexMethod* m,
-                                                        IRCode& code) {
-      if (is_editable_cfg_friendly) {
-        always_assert_log(code.editable_cfg_built(), "%s has a cfg!", SHOW(m));
-        code.cfg().reset_exit_block();
-      }
-      if (slow_invariants_debug) {
+    // The exit blocks of editable CFGs were already reset together with their
+    // simplification after the pass, so only the slow checks need a walk.
+    if (slow_invariants_debug) {
+      walk::parallel::code(build_class_scope(stores), [&](DexMethod* m,
+                                                          IRCode& code) {
         std::vector<DexMethodRef*> methods;
         methods.reserve(1000);
         methods.push_back(m);
@@ -1427,14 +1668,17 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
         if (!unique_methods.insert(m)) {
           not_reached_log("Duplicate method: %s", SHOW(m));
         }
-      }
-    });
-    if (slow_invariants_debug) {
+      });
       ScopedMetrics sm(*this);
       sm.set_metric("num_code_referenced_methods",
                     all_code_referenced_methods.size());
     }
 
+    if (pm_config->track_changed_methods) {
+      changed_methods_tracker.run_after_pass(*this, pass,
+                                             build_class_scope(stores));
+    }
+
     bool run_hasher = run_hasher_after_each_pass;
     bool run_assessor = assessor_config->run_after_each_pass ||
                         (assessor_config->run_finally && i == size - 1);
@@ -1447,6 +1691,8 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
       if (run_hasher) {
         m_current_pass_info->hash = boost::optional<hashing::DexHash>(
             this->run_hasher(pass->name().c_str(), scope));
+        pass_hash_stream->record(m_current_pass_info->name,
+                                 *m_current_pass_info->hash);
       }
       if (run_assessor) {
         ::run_assessor(*this, scope);
@@ -1472,6 +1718,8 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
   };
 
   if (pm_config->check_properties_deep && m_properties_manager != nullptr) {
+    m_properties_manager->set_skip_unchanged_methods(
+        pm_config->check_properties_skip_unchanged_methods);
     TRACE(PM, 2, "Checking initial properties of...");
     m_properties_manager->check(stores, *this);
   }
@@ -1483,6 +1731,16 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
 
   std::unordered_map<const Pass*, size_t> runs;
 
+  PassCache pass_cache(pm_config->incremental_cache_dir);
+  auto scope_fingerprint = [&]() {
+    if (m_current_pass_info->hash) {
+      return PassCache::fingerprint(*m_current_pass_info->hash);
+    }
+    auto timer = m_hashers_timer.scope();
+    scope = build_class_scope(it);
+    return PassCache::fingerprint(hashing::DexScopeHasher(scope).run());
+  };
+
   /////////////////////
   // MAIN PASS LOOP. //
   /////////////////////
@@ -1491,8 +1749,10 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
   for (size_t i = 0; i < m_activated_passes.size(); ++i) {
     Pass* pass = m_activated_passes[i];
     const size_t pass_run = ++runs[pass];
-    AnalysisUsageHelper analysis_usage_helper{m_preserved_analysis_passes};
+    AnalysisUsageHelper analysis_usage_helper{m_preserved_analysis_passes,
+                                              m_analysis_reuse_stats};
     analysis_usage_helper.pre_pass(pass);
+    m_analyses_reused_by_current_pass.clear();
 
     if (!after_interdex && pass->name() == "InterDexPass") {
       after_interdex = true;
@@ -1503,6 +1763,29 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
     Timer t(pass->name() + " " + std::to_string(pass_run) + " (run)");
     m_current_pass_info = &m_pass_info[i];
 
+    boost::optional<PassCache::Entry> cache_entry;
+    if (pass_cache.enabled() && pass->supports_incremental_cache()) {
+      cache_entry = PassCache::Entry();
+      cache_entry->input_hash = scope_fingerprint();
+      cache_entry->config_hash = hashing::hash_to_string(boost::hash_value(
+          m_current_pass_info->config.unwrap().toStyledString()));
+      auto cached = pass_cache.find_noop(m_current_pass_info->name,
+                                         cache_entry->input_hash,
+                                         cache_entry->config_hash);
+      if (cached) {
+        TRACE(PM, 1, "Skipping %s, cached as a no-op for this input.",
+              pass->name().c_str());
+        for (const auto& [key, value] : cached->metrics) {
+          set_metric(key, value);
+        }
+        set_metric("incremental_cache.hit", 1);
+        pass_cache.count_hit();
+        analysis_usage_helper.post_pass(pass);
+        m_current_pass_info = nullptr;
+        continue;
+      }
+    }
+
     pre_pass_verifiers(pass, i);
 
     double cpu_time;
@@ -1515,9 +1798,17 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
                                      : boost::none;
       auto scoped_command_all_prof = ScopedCommandProfiling::maybe_from_info(
           profiler_all_info, &pass->name());
+      auto scoped_command_config_prof =
+          ScopedCommandProfiling::maybe_from_info(
+              get_pass_profiler_info(*pm_config, conf, pass, pass_run),
+              &pass->name());
       jemalloc_util::ScopedProfiling malloc_prof(m_malloc_profile_pass == pass);
+      jemalloc_stats.snapshot_before_pass();
       auto maybe_track_violations =
           violatios_tracking.maybe_track(this, stores);
+      auto hwm_start = get_mem_stats().vm_hwm;
+      size_t cfgs_built_start = build_cfg_counter;
+      uint64_t allocations_start = jemalloc_util::num_allocations();
       double cpu_time_start = ((double)std::clock()) / CLOCKS_PER_SEC;
       auto wall_time_start = std::chrono::steady_clock::now();
       if (pass->is_cfg_legacy()) {
@@ -1536,10 +1827,49 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
         ensure_editable_cfg(stores);
         TRACE(PM, 2, "%s Pass uses editable cfg.\n", SHOW(pass->name()));
       }
-      pass->run_pass(stores, conf, *this);
+      walk::parallel::stats().reset();
+      cfg::reset_peak_memory_bytes();
+      // Passes may edit member lists directly, without going through the
+      // mutators that bump the hierarchy generation, so cached resolutions
+      // are only trusted within a pass.
+      RedexContext::bump_hierarchy_generation();
+      resolver_cache::drop_stale_entries();
+      resolver_cache::reset_stats();
+      {
+        chrome_trace::ScopedSpan pass_span(pass->name(), "pass");
+        pass->run_pass(stores, conf, *this);
+      }
       auto wall_time_end = std::chrono::steady_clock::now();
       double cpu_time_end = ((double)std::clock()) / CLOCKS_PER_SEC;
 
+      auto& walk_stats = walk::parallel::stats();
+      set_metric(PERF_METHODS_VISITED_KEY, walk_stats.methods);
+      set_metric(PERF_CFGS_BUILT_KEY, build_cfg_counter - cfgs_built_start);
+      set_metric(PERF_ALLOCATIONS_KEY,
+                 jemalloc_util::num_allocations() - allocations_start);
+      set_metric(PERF_PEAK_RSS_DELTA_KEY,
+                 get_mem_stats().vm_hwm - hwm_start);
+      if (walk_stats.walks > 0) {
+        // How long threads were idle at the end of parallel walks, waiting for
+        // the last, most expensive classes to finish.
+        set_metric("timing.parallel_walks", walk_stats.walks);
+        set_metric("timing.parallel_walks.total_tail_us",
+                   walk_stats.total_tail_us);
+        set_metric("timing.parallel_walks.max_tail_us",
+                   walk_stats.max_tail_us);
+      }
+
+      auto resolver_stats = resolver_cache::get_stats();
+      if (resolver_stats.hits + resolver_stats.misses > 0) {
+        set_metric("resolver_cache.hits", resolver_stats.hits);
+        set_metric("resolver_cache.misses", resolver_stats.misses);
+      }
+
+      // Memory held by CFG Blocks and Edges; a high value after the pass means
+      // that it left many CFGs (or big ones) alive.
+      set_metric("memory.cfg.peak_bytes", cfg::peak_memory_bytes());
+      set_metric("memory.cfg.live_bytes_after", cfg::live_memory_bytes());
+
       // Collect dex info metrics after InterDexPass.
       if (after_interdex) {
         auto& root_store = stores.at(0);
@@ -1578,7 +1908,8 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
                      total_mrefs - total_methods);
         }
       }
-      // Ensure the CFG is clean, e.g., no unreachable blocks.
+      // Ensure the CFG is clean, e.g., no unreachable blocks, and drop any
+      // ghost exit block. The CFGs stay alive for the next pass.
       if (!pass->is_cfg_legacy()) {
         auto temp_scope = build_class_scope(stores);
         walk::parallel::code(temp_scope, [&](DexMethod* method, IRCode& code) {
@@ -1586,9 +1917,14 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
                             "%s has no editable cfg after cfg-friendly pass %s",
                             SHOW(method), pass->name().c_str());
           code.cfg().simplify();
+          code.cfg().reset_exit_block();
         });
       }
 
+      if (pm_config->release_detached_code_after_passes.count(
+              pass->name())) {
+        release_detached_code(*this, build_class_scope(stores));
+      }
       g_redex->compact();
 
       trace_cls.dump(pass->name(), stores);
@@ -1607,7 +1943,18 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
 
     post_pass_verifiers(pass, i, m_activated_passes.size());
 
-    analysis_usage_helper.post_pass(pass);
+    if (cache_entry) {
+      cache_entry->output_hash = scope_fingerprint();
+      for (const auto& [key, value] : m_current_pass_info->metrics) {
+        // Performance counters describe this run, not the cached one.
+        if (key != PASS_ORDER_KEY && !boost::starts_with(key, "perf.")) {
+          cache_entry->metrics.emplace(key, value);
+        }
+      }
+      pass_cache.record(m_current_pass_info->name, std::move(*cache_entry));
+    }
+
+    analysis_usage_helper.post_pass(pass, wall_time.count());
 
     process_method_profiles(*this, conf);
     process_secondary_method_profiles(*this, conf);
@@ -1618,6 +1965,13 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
       break;
     }
 
+    set_metric(PERF_WALL_TIME_KEY, (int64_t)(wall_time.count() * 1000));
+    set_metric(PERF_CPU_TIME_KEY, (int64_t)(cpu_time * 1000));
+    set_metric(PERF_THREAD_UTILIZATION_KEY,
+               wall_time.count() == 0
+                   ? 0
+                   : (int64_t)(100.0 * cpu_time / wall_time.count() /
+                               redex_parallel::default_num_threads()));
     set_metric("timing.cpu_time.100", (int64_t)(cpu_time * 100));
     set_metric("timing.wall_time.100", (int64_t)(wall_time.count() * 100));
     if (wall_time.count() != 0) {
@@ -1655,6 +2009,25 @@ void PassManager::run_passes(DexStoresVector& stores, ConfigFiles& conf) {
   maybe_print_seeds_outgoing(conf, it);
   maybe_write_hashes_outgoing(conf, scope);
 
+  if (pass_cache.enabled()) {
+    TRACE(PM, 1, "Skipped %zu passes via the incremental pass cache.",
+          pass_cache.hits());
+    pass_cache.save();
+  }
+
+  double analysis_seconds_saved = 0;
+  for (const auto& [id, stats] : m_analysis_reuse_stats) {
+    TRACE(PM, 1, "Analysis %s: built in %.3fs, reused %zu times", id.c_str(),
+          stats.build_seconds, stats.reuses);
+    analysis_seconds_saved += stats.saved_seconds();
+  }
+  if (!m_analysis_reuse_stats.empty()) {
+    TRACE(PM, 1, "Preserved analyses saved an estimated %.3fs",
+          analysis_seconds_saved);
+    Timer::add_timer("PassManager.PreservedAnalyses.saved",
+                     analysis_seconds_saved);
+  }
+
   sanitizers::lsan_do_recoverable_leak_check();
 
   for (auto& [name, seconds] : AccumulatingTimer::get_times()) {
@@ -1812,6 +2185,18 @@ ReserveRefsInfo PassManager::get_reserved_refs() const {
   return res;
 }
 
+void PassManager::record_analysis_reuse(const AnalysisID& id) const {
+  if (m_current_pass_info == nullptr ||
+      !m_analyses_reused_by_current_pass.insert(id).second) {
+    return;
+  }
+  auto& stats = m_analysis_reuse_stats[id];
+  stats.reuses++;
+  m_current_pass_info->metrics["analysis.reused"]++;
+  m_current_pass_info->metrics["analysis.time_saved_ms"] +=
+      (int64_t)(stats.build_seconds * 1000);
+}
+
 void PassManager::check_unreleased_reserved_refs() {
   for (const auto& [name, info] : m_reserved_ref_infos) {
     fprintf(stderr, "ABORT! Unreleased reserved refs: %s(%zu, %zu, %zu)\n",
@@ -13,6 +13,7 @@
 #include <string>
 #include <typeinfo>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -65,6 +66,21 @@ class PassManager {
 
   ~PassManager();
 
+  // Performance counters that are set in the metrics of every pass that
+  // runs, under these keys. Times are in milliseconds, memory in bytes.
+  // Methods visited counts the methods of the classes visited by parallel
+  // walks; the allocation count is always 0 without jemalloc.
+  static constexpr const char* PERF_WALL_TIME_KEY = "perf.wall_time_ms";
+  static constexpr const char* PERF_CPU_TIME_KEY = "perf.cpu_time_ms";
+  static constexpr const char* PERF_THREAD_UTILIZATION_KEY =
+      "perf.thread_utilization_percent";
+  static constexpr const char* PERF_PEAK_RSS_DELTA_KEY =
+      "perf.peak_rss_delta_bytes";
+  static constexpr const char* PERF_METHODS_VISITED_KEY =
+      "perf.methods_visited";
+  static constexpr const char* PERF_CFGS_BUILT_KEY = "perf.cfgs_built";
+  static constexpr const char* PERF_ALLOCATIONS_KEY = "perf.allocations";
+
   struct PassInfo {
     const Pass* pass;
     size_t order; // zero-based
@@ -130,11 +146,26 @@ class PassManager {
     auto pass =
         m_preserved_analysis_passes.find(get_analysis_id_by_pass<PassType>());
     if (pass != m_preserved_analysis_passes.end()) {
+      record_analysis_reuse(pass->first);
       return static_cast<PassType*>(pass->second);
     }
     return nullptr;
   }
 
+  // How long each analysis took to build, and how many later passes picked up
+  // the preserved result instead of recomputing it. Every reuse is counted as
+  // one build saved.
+  struct AnalysisReuseStats {
+    double build_seconds{0};
+    size_t reuses{0};
+
+    double saved_seconds() const { return build_seconds * reuses; }
+  };
+  const std::unordered_map<AnalysisID, AnalysisReuseStats>&
+  get_analysis_reuse_stats() const {
+    return m_analysis_reuse_stats;
+  }
+
   Pass* find_pass(const std::string& pass_name) const;
 
   struct ActivatedPasses {
@@ -167,10 +198,18 @@ class PassManager {
 
   void check_unreleased_reserved_refs();
 
+  void record_analysis_reuse(const AnalysisID& id) const;
+
   AssetManager m_asset_mgr;
   std::vector<Pass*> m_registered_passes;
   std::vector<Pass*> m_activated_passes;
   std::unordered_map<AnalysisID, Pass*> m_preserved_analysis_passes;
+  // Only touched from the thread driving the passes. Mutable so that reuses can
+  // be counted in `get_preserved_analysis`.
+  mutable std::unordered_map<AnalysisID, AnalysisReuseStats>
+      m_analysis_reuse_stats;
+  // The analyses that the current pass has already picked up.
+  mutable std::unordered_set<AnalysisID> m_analyses_reused_by_current_pass;
 
   // Per-pass information and metrics
   std::vector<PassManager::PassInfo> m_pass_info;
@@ -15,6 +15,7 @@
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <sstream>
 #include <tuple>
@@ -1577,6 +1578,43 @@ PointsToSemantics::PointsToSemantics(const Scope& scope, bool generate_stubs)
 }
 
 void PointsToSemantics::load_stubs(const std::string& file_name) {
+  read_method_semantics(file_name, [this](PointsToMethodSemantics&& semantics) {
+    DexMethodRef* dex_method = semantics.get_method();
+    auto it = m_method_semantics.find(dex_method);
+    if (it == m_method_semantics.end()) {
+      m_method_semantics.emplace(dex_method, std::move(semantics));
+    } else {
+      TRACE(PTA, 2, "Collision with stub for method %s", SHOW(dex_method));
+    }
+  });
+}
+
+void PointsToSemantics::write_method_semantics(const Scope& scope,
+                                               std::ostream& output,
+                                               bool generate_stubs) {
+  TypeSystem type_system(scope);
+  PointsToSemanticsUtils utils;
+  std::mutex output_mutex;
+  walk::parallel::methods(scope, [&](DexMethod* dex_method) {
+    MethodKind kind = method_kind(dex_method, generate_stubs);
+    PointsToMethodSemantics semantics(dex_method, kind, /* start_var_id */ 0,
+                                      /* size_hint */ 8);
+    if (dex_method->get_code() != nullptr) {
+      pts_impl::PointsToActionGenerator generator(dex_method, &semantics,
+                                                  type_system, utils);
+      generator.run();
+    }
+    // The S-expression is printed outside of the critical section.
+    std::ostringstream out;
+    out << semantics.to_s_expr() << std::endl;
+    std::lock_guard<std::mutex> lock(output_mutex);
+    output << out.str();
+  });
+}
+
+void PointsToSemantics::read_method_semantics(
+    const std::string& file_name,
+    const std::function<void(PointsToMethodSemantics&&)>& f) {
   std::ifstream file_input(file_name);
   s_expr_istream s_expr_input(file_input);
   while (s_expr_input.good()) {
@@ -1590,13 +1628,7 @@ void PointsToSemantics::load_stubs(const std::string& file_name) {
     auto semantics_opt = PointsToMethodSemantics::from_s_expr(expr);
     always_assert_log(
         semantics_opt, "Couldn't parse S-expression: %s\n", expr.str().c_str());
-    DexMethodRef* dex_method = semantics_opt->get_method();
-    auto it = m_method_semantics.find(dex_method);
-    if (it == m_method_semantics.end()) {
-      m_method_semantics.emplace(dex_method, *semantics_opt);
-    } else {
-      TRACE(PTA, 2, "Collision with stub for method %s", SHOW(dex_method));
-    }
+    f(std::move(*semantics_opt));
   }
 }
 
@@ -1613,21 +1645,23 @@ MethodKind PointsToSemantics::default_method_kind() const {
   return m_generate_stubs ? PTS_STUB : PTS_APK;
 }
 
-void PointsToSemantics::initialize_entry(DexMethod* dex_method) {
+MethodKind PointsToSemantics::method_kind(DexMethod* dex_method,
+                                          bool generate_stubs) {
   DexAccessFlags access_flags = dex_method->get_access();
-  MethodKind kind;
   if (dex_method->get_code() == nullptr) {
     if ((access_flags & DexAccessFlags::ACC_ABSTRACT)) {
-      kind = PTS_ABSTRACT;
-    } else {
-      // The definition of a method that is neither abstract nor native should
-      // always have an associated IRCode component.
-      redex_assert(access_flags & DexAccessFlags::ACC_NATIVE);
-      kind = PTS_NATIVE;
+      return PTS_ABSTRACT;
     }
-  } else {
-    kind = default_method_kind();
+    // The definition of a method that is neither abstract nor native should
+    // always have an associated IRCode component.
+    redex_assert(access_flags & DexAccessFlags::ACC_NATIVE);
+    return PTS_NATIVE;
   }
+  return generate_stubs ? PTS_STUB : PTS_APK;
+}
+
+void PointsToSemantics::initialize_entry(DexMethod* dex_method) {
+  MethodKind kind = method_kind(dex_method, m_generate_stubs);
   m_method_semantics.emplace(std::piecewise_construct,
                              std::forward_as_tuple(dex_method),
                              std::forward_as_tuple(/* dex_method */ dex_method,
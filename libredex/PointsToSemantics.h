@@ -9,13 +9,16 @@
 
 #include <bitset>
 #include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <iosfwd>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <boost/container/flat_map.hpp>
+#include <boost/container/small_vector.hpp>
 #include <boost/optional.hpp>
 
 #include <sparta/S_Expression.h>
@@ -428,8 +431,14 @@ class PointsToAction final {
   // method call are denoted by positive indexes that correspond to their
   // position in the original invocation. Arguments specific to a points-to
   // operation (like the left-hand side of an assignment operation) have a
-  // negative index.
-  boost::container::flat_map<int32_t, PointsToVariable> m_arguments;
+  // negative index. All operations other than method calls and disjunctions
+  // have at most three arguments, which are stored inline.
+  using Arguments = boost::container::flat_map<
+      int32_t,
+      PointsToVariable,
+      std::less<int32_t>,
+      boost::container::small_vector<std::pair<int32_t, PointsToVariable>, 3>>;
+  Arguments m_arguments;
 };
 
 std::ostream& operator<<(std::ostream& o, const PointsToAction& a);
@@ -535,6 +544,26 @@ class PointsToSemantics final {
    */
   void load_stubs(const std::string& file_name);
 
+  /*
+   * Generates points-to actions for all methods in the given scope in parallel
+   * and writes them to the output stream as S-expressions, in the format read
+   * by load_stubs(). The semantics of each method is discarded as soon as it
+   * has been written, so that large scopes can be processed without keeping
+   * all points-to actions in memory. The order of the methods in the output is
+   * unspecified.
+   */
+  static void write_method_semantics(const Scope& scope,
+                                     std::ostream& output,
+                                     bool generate_stubs = false);
+
+  /*
+   * Reads the semantics of methods from a file written by
+   * write_method_semantics() (or a stub file), one method at a time.
+   */
+  static void read_method_semantics(
+      const std::string& file_name,
+      const std::function<void(PointsToMethodSemantics&&)>& f);
+
   iterator begin() { return m_method_semantics.begin(); }
 
   iterator end() { return m_method_semantics.end(); }
@@ -547,6 +576,8 @@ class PointsToSemantics final {
  private:
   MethodKind default_method_kind() const;
 
+  static MethodKind method_kind(DexMethod* dex_method, bool generate_stubs);
+
   void initialize_entry(DexMethod* dex_method);
 
   void generate_points_to_actions(DexMethod* dex_method);
@@ -7,11 +7,14 @@
 
 #include "ProguardMap.h"
 
+#include <boost/algorithm/string/split.hpp>
 #include <fstream>
 
+#include "AnalysisSummaryCache.h"
 #include "DexPosition.h"
 #include "DexUtil.h"
 #include "IRCode.h"
+#include "RedexContext.h"
 #include "Show.h"
 #include "Timer.h"
 #include "Trace.h"
@@ -19,9 +22,8 @@
 
 namespace {
 
-std::string find_or_same(
-    const std::string& key,
-    const std::unordered_map<std::string, std::string>& map) {
+std::string_view find_or_same(std::string_view key,
+                              const ProguardMap::StringMap& map) {
   auto it = map.find(key);
   if (it == map.end()) return key;
   return it->second;
@@ -224,43 +226,202 @@ ProguardMap::ProguardMap(const std::string& filename, bool use_new_rename_map) {
   std::ifstream fp(filename);
   always_assert_log(fp, "Can't open proguard map: %s\n", filename.c_str());
 
+  boost::optional<std::string> cache_key;
+  if (g_redex != nullptr && analysis_summary_cache::enabled()) {
+    cache_key = analysis_summary_cache::make_key(
+        analysis_summary_cache::file_digest(filename),
+        {use_new_rename_map ? "full" : "proguard"});
+    auto lines = analysis_summary_cache::load("proguard_map", *cache_key);
+    if (lines && deserialize(*lines)) {
+      TRACE(PGR, 1, "Loaded proguard map %s from the cache", filename.c_str());
+      return;
+    }
+  }
+
   if (use_new_rename_map) {
     parse_full_map(fp);
   } else {
     parse_proguard_map(fp);
   }
+  if (cache_key) {
+    analysis_summary_cache::store("proguard_map", *cache_key, serialize());
+  }
+}
+
+namespace {
+
+// Each table is stored as a line with its number of entries, followed by one
+// tab-separated line per entry. Names never contain tabs or newlines.
+using StringMap = ProguardMap::StringMap;
+
+void serialize_map(const StringMap& map, std::vector<std::string>* lines) {
+  lines->push_back(std::to_string(map.size()));
+  for (const auto& [key, value] : map) {
+    lines->push_back(str_copy(key) + "\t" + str_copy(value));
+  }
+}
+
+// Splits the next line into exactly `n` tab-separated fields.
+bool next_fields(const std::vector<std::string>& lines,
+                 size_t* pos,
+                 size_t n,
+                 std::vector<std::string>* fields) {
+  if (*pos >= lines.size()) {
+    return false;
+  }
+  fields->clear();
+  boost::split(*fields, lines[(*pos)++], [](char c) { return c == '\t'; });
+  return fields->size() == n;
+}
+
+bool next_count(const std::vector<std::string>& lines,
+                size_t* pos,
+                size_t* count) {
+  std::vector<std::string> fields;
+  if (!next_fields(lines, pos, 1, &fields) || fields[0].empty() ||
+      fields[0].find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  *count = std::stoull(fields[0]);
+  return *count <= lines.size() - *pos;
+}
+
+template <typename Intern>
+bool deserialize_map(const std::vector<std::string>& lines,
+                     size_t* pos,
+                     const Intern& intern,
+                     StringMap* map) {
+  size_t count;
+  if (!next_count(lines, pos, &count)) {
+    return false;
+  }
+  map->reserve(count);
+  std::vector<std::string> fields;
+  while (count-- > 0) {
+    if (!next_fields(lines, pos, 2, &fields)) {
+      return false;
+    }
+    map->emplace(intern(fields[0]), intern(fields[1]));
+  }
+  return true;
+}
+
+} // namespace
+
+std::string_view ProguardMap::intern(const std::string& name) {
+  return *m_names.insert(name).first;
+}
+
+std::vector<std::string> ProguardMap::serialize() const {
+  std::vector<std::string> lines;
+  for (const auto* map :
+       {&m_classMap, &m_fieldMap, &m_methodMap, &m_obfClassMap,
+        &m_obfFieldMap, &m_obfMethodMap, &m_obfUntypedFieldMap,
+        &m_obfUntypedMethodMap}) {
+    serialize_map(*map, &lines);
+  }
+  lines.push_back(std::to_string(m_obfMethodLinesMap.size()));
+  for (const auto& [method, ranges] : m_obfMethodLinesMap) {
+    lines.push_back(str_copy(method) + "\t" + std::to_string(ranges.size()));
+    for (const auto& range : ranges) {
+      lines.push_back(std::to_string(range->start) + "\t" +
+                      std::to_string(range->end) + "\t" +
+                      std::to_string(range->original_start) + "\t" +
+                      std::to_string(range->original_end) + "\t" +
+                      range->original_name);
+    }
+  }
+  lines.push_back(std::to_string(m_pg_coalesced_interfaces.size()));
+  for (const auto& type : m_pg_coalesced_interfaces) {
+    lines.push_back(type);
+  }
+  return lines;
+}
+
+bool ProguardMap::deserialize(const std::vector<std::string>& lines) {
+  size_t pos = 0;
+  bool ok = true;
+  auto intern_name = [this](const std::string& name) { return intern(name); };
+  try {
+    for (auto* map :
+         {&m_classMap, &m_fieldMap, &m_methodMap, &m_obfClassMap,
+          &m_obfFieldMap, &m_obfMethodMap, &m_obfUntypedFieldMap,
+          &m_obfUntypedMethodMap}) {
+      ok = ok && deserialize_map(lines, &pos, intern_name, map);
+    }
+
+    auto to_u4 = [](const std::string& s) {
+      return static_cast<uint32_t>(std::stoul(s));
+    };
+    size_t num_methods = 0;
+    ok = ok && next_count(lines, &pos, &num_methods);
+    std::vector<std::string> fields;
+    for (size_t i = 0; ok && i < num_methods; ++i) {
+      ok = next_fields(lines, &pos, 2, &fields);
+      if (!ok) {
+        break;
+      }
+      auto& ranges = m_obfMethodLinesMap[intern(fields[0])];
+      size_t num_ranges = std::stoull(fields[1]);
+      for (size_t j = 0; ok && j < num_ranges; ++j) {
+        ok = next_fields(lines, &pos, 5, &fields);
+        if (ok) {
+          ranges.emplace_back(std::make_unique<ProguardLineRange>(
+              to_u4(fields[0]), to_u4(fields[1]), to_u4(fields[2]),
+              to_u4(fields[3]), std::move(fields[4])));
+        }
+      }
+    }
+
+    size_t num_interfaces = 0;
+    ok = ok && next_count(lines, &pos, &num_interfaces);
+    for (size_t i = 0; ok && i < num_interfaces; ++i) {
+      m_pg_coalesced_interfaces.insert(lines[pos++]);
+    }
+    ok = ok && pos == lines.size();
+  } catch (const std::exception&) {
+    // Numbers that don't parse.
+    ok = false;
+  }
+
+  if (!ok) {
+    // Fall back to parsing, from a clean slate.
+    *this = ProguardMap();
+  }
+  return ok;
 }
 
 std::string ProguardMap::translate_class(const std::string& cls) const {
-  return find_or_same(cls, m_classMap);
+  return std::string(find_or_same(cls, m_classMap));
 }
 
 std::string ProguardMap::translate_field(const std::string& field) const {
-  return find_or_same(field, m_fieldMap);
+  return std::string(find_or_same(field, m_fieldMap));
 }
 
 std::string ProguardMap::translate_method(const std::string& method) const {
-  return find_or_same(method, m_methodMap);
+  return std::string(find_or_same(method, m_methodMap));
 }
 
 std::string ProguardMap::deobfuscate_class(const std::string& cls) const {
-  return find_or_same(cls, m_obfClassMap);
+  return std::string(find_or_same(cls, m_obfClassMap));
 }
 
 std::string ProguardMap::deobfuscate_field(const std::string& field) const {
-  return find_or_same(find_or_same(field, m_obfFieldMap), m_obfUntypedFieldMap);
+  return std::string(
+      find_or_same(find_or_same(field, m_obfFieldMap), m_obfUntypedFieldMap));
 }
 
 std::string ProguardMap::deobfuscate_method(const std::string& method) const {
-  return find_or_same(find_or_same(method, m_obfMethodMap),
-                      m_obfUntypedMethodMap);
+  return std::string(find_or_same(find_or_same(method, m_obfMethodMap),
+                                  m_obfUntypedMethodMap));
 }
 
 std::vector<ProguardMap::Frame> ProguardMap::deobfuscate_frame(
     const DexString* method_name, uint32_t line) const {
   std::vector<Frame> frames;
-  auto ranges_it = m_obfMethodLinesMap.find(
-      str_copy(pg_impl::lines_key(method_name->str())));
+  auto ranges_it =
+      m_obfMethodLinesMap.find(pg_impl::lines_key(method_name->str()));
   if (ranges_it != m_obfMethodLinesMap.end()) {
     for (const auto& range : ranges_it->second) {
       if (!range->matches(line)) {
@@ -285,8 +446,7 @@ std::vector<ProguardMap::Frame> ProguardMap::deobfuscate_frame(
 
 ProguardLineRangeVector& ProguardMap::method_lines(
     const std::string& obfuscated_method) {
-  return m_obfMethodLinesMap.at(
-      str_copy(pg_impl::lines_key(obfuscated_method)));
+  return m_obfMethodLinesMap.at(pg_impl::lines_key(obfuscated_method));
 }
 
 void ProguardMap::parse_proguard_map(std::istream& fp) {
@@ -352,8 +512,8 @@ bool ProguardMap::parse_class_full_format(const std::string& line) {
 
   m_currClass = old_class_name;
   m_currNewClass = new_class_name;
-  m_classMap[m_currClass] = m_currNewClass;
-  m_obfClassMap[m_currNewClass] = m_currClass;
+  m_classMap[intern(m_currClass)] = intern(m_currNewClass);
+  m_obfClassMap[intern(m_currNewClass)] = intern(m_currClass);
   return true;
 }
 
@@ -394,8 +554,8 @@ bool ProguardMap::parse_field_full_format(const std::string& line) {
   auto pgnew = new_field_name;
   auto pgold = old_field_name;
 
-  m_fieldMap[pgold] = pgnew;
-  m_obfFieldMap[pgnew] = pgold;
+  m_fieldMap[intern(pgold)] = intern(pgnew);
+  m_obfFieldMap[intern(pgnew)] = intern(pgold);
   return true;
 }
 
@@ -423,8 +583,8 @@ bool ProguardMap::parse_method_full_format(const std::string& line) {
 
   auto pgold = old_method_name;
   auto pgnew = new_method_name;
-  m_methodMap[pgold] = pgnew;
-  m_obfMethodMap[pgnew] = pgold;
+  m_methodMap[intern(pgold)] = intern(pgnew);
+  m_obfMethodMap[intern(pgnew)] = intern(pgold);
   return true;
 }
 
@@ -437,8 +597,8 @@ bool ProguardMap::parse_class(const std::string& line) {
   if (!id(p, newname)) return false;
   m_currClass = convert_type(classname);
   m_currNewClass = convert_type(newname);
-  m_classMap[m_currClass] = m_currNewClass;
-  m_obfClassMap[m_currNewClass] = m_currClass;
+  m_classMap[intern(m_currClass)] = intern(m_currNewClass);
+  m_obfClassMap[intern(m_currNewClass)] = intern(m_currClass);
   return true;
 }
 
@@ -468,9 +628,9 @@ bool ProguardMap::parse_field(const std::string& line) {
             pgold.c_str());
     m_pg_coalesced_interfaces.insert(ctype);
   }
-  m_fieldMap[pgold] = pgnew;
-  m_obfFieldMap[pgnew] = pgold;
-  m_obfUntypedFieldMap[pgnew_notype] = pgold;
+  m_fieldMap[intern(pgold)] = intern(pgnew);
+  m_obfFieldMap[intern(pgnew)] = intern(pgold);
+  m_obfUntypedFieldMap[intern(pgnew_notype)] = intern(pgold);
   return true;
 }
 
@@ -520,11 +680,11 @@ bool ProguardMap::parse_method(const std::string& line) {
   auto pgold = convert_method(classname, old_rtype, methodname, old_args);
   auto pgnew = convert_method(m_currNewClass, new_rtype, newname, new_args);
   auto pgnew_no_rtype = convert_method(m_currNewClass, "", newname, new_args);
-  m_methodMap[pgold] = pgnew;
-  m_obfMethodMap[pgnew] = pgold;
-  m_obfUntypedMethodMap[pgnew_no_rtype] = pgold;
+  m_methodMap[intern(pgold)] = intern(pgnew);
+  m_obfMethodMap[intern(pgnew)] = intern(pgold);
+  m_obfUntypedMethodMap[intern(pgnew_no_rtype)] = intern(pgold);
   lines->original_name = pgold;
-  m_obfMethodLinesMap[str_copy(pg_impl::lines_key(pgnew))].push_back(
+  m_obfMethodLinesMap[pg_impl::lines_key(intern(pgnew))].push_back(
       std::move(lines));
   return true;
 }
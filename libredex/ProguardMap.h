@@ -10,6 +10,7 @@
 #include <cstddef>
 #include <iosfwd>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -55,6 +56,14 @@ struct ProguardMap {
    */
   explicit ProguardMap(std::istream& is) { parse_proguard_map(is); }
 
+  // The tables hold views into m_names, so a ProguardMap can only be moved.
+  ProguardMap(const ProguardMap&) = delete;
+  ProguardMap& operator=(const ProguardMap&) = delete;
+  ProguardMap(ProguardMap&&) = default;
+  ProguardMap& operator=(ProguardMap&&) = default;
+
+  using StringMap = std::unordered_map<std::string_view, std::string_view>;
+
   /**
    * Translate un-obfuscated class name to obfuscated name.
    */
@@ -124,26 +133,40 @@ struct ProguardMap {
   bool parse_field_full_format(const std::string& line);
   bool parse_method_full_format(const std::string& line);
 
+  // The parsed tables, in the line format of analysis_summary_cache, so that
+  // large maps are parsed only once across builds.
+  std::vector<std::string> serialize() const;
+  bool deserialize(const std::vector<std::string>& lines);
+
+  // Returns the single stored copy of `name`.
+  std::string_view intern(const std::string& name);
+
  private:
+  // Every name mentioned by the tables below, stored once: both directions of
+  // a mapping refer to the same strings. Nodes of an unordered_set are stable,
+  // so the views stay valid as it grows.
+  std::unordered_set<std::string> m_names;
+
   // Unobfuscated to obfuscated maps
-  std::unordered_map<std::string, std::string> m_classMap;
-  std::unordered_map<std::string, std::string> m_fieldMap;
-  std::unordered_map<std::string, std::string> m_methodMap;
+  StringMap m_classMap;
+  StringMap m_fieldMap;
+  StringMap m_methodMap;
 
   // Obfuscated to unobfuscated maps from proguard
-  std::unordered_map<std::string, std::string> m_obfClassMap;
-  std::unordered_map<std::string, std::string> m_obfFieldMap;
-  std::unordered_map<std::string, std::string> m_obfMethodMap;
+  StringMap m_obfClassMap;
+  StringMap m_obfFieldMap;
+  StringMap m_obfMethodMap;
 
   // Field map for reflection analysis when type is unknown
   // Stores Lcom/facebook/Class;.field -> original name without class name
-  std::unordered_map<std::string, std::string> m_obfUntypedFieldMap;
+  StringMap m_obfUntypedFieldMap;
 
   // Method map for reflection analysis when return type is unknown
   // Stores Lcom/facebook/Class;.method(II) -> original name without class name
-  std::unordered_map<std::string, std::string> m_obfUntypedMethodMap;
+  StringMap m_obfUntypedMethodMap;
 
-  std::unordered_map<std::string, ProguardLineRangeVector> m_obfMethodLinesMap;
+  std::unordered_map<std::string_view, ProguardLineRangeVector>
+      m_obfMethodLinesMap;
 
   // Interfaces that are (most likely) coalesced by Proguard.
   std::unordered_set<std::string> m_pg_coalesced_interfaces;
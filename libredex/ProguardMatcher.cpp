@@ -6,6 +6,8 @@
  */
 
 #include <algorithm>
+#include <boost/functional/hash.hpp>
+#include <boost/optional.hpp>
 #include <boost/regex.hpp>
 #include <fstream>
 #include <iostream>
@@ -15,9 +17,11 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "AnalysisSummaryCache.h"
 #include "ClassHierarchy.h"
 #include "ConcurrentContainers.h"
 #include "DexAnnotation.h"
+#include "DexHasher.h"
 #include "DexUtil.h"
 #include "IRCode.h"
 #include "ProguardMatcher.h"
@@ -56,6 +60,28 @@ std::vector<std::unique_ptr<boost::regex>> make_rxs(
   return rxs;
 }
 
+// Returns the leading part of the internal name that every class matched by
+// the class name pattern `name` must start with. Only characters that
+// `form_type_regex` leaves literal are included, so we stop at the first
+// wildcard or other special character.
+std::string class_name_literal_prefix(const std::string& name) {
+  if (name == "*" || name == "**") {
+    return ""; // These are never matched against a regex; see ClassMatcher.
+  }
+  auto desc = proguard_parser::convert_wildcard_type(name);
+  size_t len = 0;
+  while (len < desc.size()) {
+    char ch = desc[len];
+    if (!std::isalnum(static_cast<unsigned char>(ch)) && ch != '_' &&
+        ch != '/' && ch != '$') {
+      break;
+    }
+    ++len;
+  }
+  desc.resize(len);
+  return desc;
+}
+
 std::string_view get_deobfuscated_name(const DexType* type) {
   auto cls = type_class(type);
   if (cls == nullptr) {
@@ -404,11 +430,23 @@ class ProguardMatcher {
   ProguardRuleRecorder steal_recorder() { return std::move(m_recorder); }
 
  private:
+  // The classes matched by slow rules can be reused by later builds over the
+  // same classes; see AnalysisSummaryCache.h.
+  std::string match_cache_key(RuleType rule_type,
+                              bool process_external,
+                              const std::vector<const KeepSpec*>& rules);
+  boost::optional<std::vector<std::vector<DexClass*>>> load_cached_matches(
+      const std::string& key, size_t num_rules) const;
+  void store_matches(const std::string& key,
+                     const std::vector<std::vector<DexClass*>>& matches) const;
+
   const ProguardMap& m_pg_map;
   const Scope& m_classes;
   const Scope& m_external_classes;
   ClassHierarchy m_hierarchy;
   ProguardRuleRecorder m_recorder;
+  // Lazily computed by match_cache_key.
+  std::string m_scope_digest;
 };
 
 template <class DexMember>
@@ -859,6 +897,77 @@ DexClass* ProguardMatcher::find_single_class(
   return type_class(typ);
 }
 
+std::string ProguardMatcher::match_cache_key(
+    RuleType rule_type,
+    bool process_external,
+    const std::vector<const KeepSpec*>& rules) {
+  if (m_scope_digest.empty()) {
+    // Class-level matches depend on the names, access flags, annotations and
+    // the whole super class and interface chains, which may go through
+    // external classes. The class digests cover all but the deobfuscated
+    // names of the classes themselves.
+    std::vector<std::pair<std::string_view, std::string_view>> names;
+    for (const auto* classes : {&m_classes, &m_external_classes}) {
+      for (const auto* cls : *classes) {
+        names.emplace_back(cls->get_name()->str(),
+                           cls->get_deobfuscated_name().str());
+      }
+    }
+    std::sort(names.begin(), names.end());
+    m_scope_digest = analysis_summary_cache::scope_digest(m_classes) + "-" +
+                     analysis_summary_cache::scope_digest(m_external_classes) +
+                     "-" + hashing::hash_to_string(boost::hash_value(names));
+  }
+  std::vector<std::string> inputs{to_string(rule_type),
+                                  process_external ? "external" : ""};
+  for (const auto* rule : rules) {
+    inputs.push_back(show_keep(*rule, /* show_source */ false));
+  }
+  return analysis_summary_cache::make_key(m_scope_digest, inputs);
+}
+
+boost::optional<std::vector<std::vector<DexClass*>>>
+ProguardMatcher::load_cached_matches(const std::string& key,
+                                     size_t num_rules) const {
+  auto lines = analysis_summary_cache::load("proguard_matches", key);
+  if (!lines || lines->size() != num_rules) {
+    return boost::none;
+  }
+  std::vector<std::vector<DexClass*>> matches(num_rules);
+  for (size_t i = 0; i < num_rules; ++i) {
+    std::istringstream line((*lines)[i]);
+    std::string name;
+    while (line >> name) {
+      auto* cls = type_class(DexType::get_type(name));
+      if (cls == nullptr) {
+        TRACE(PGR, 1, "Ignoring cached proguard matches: unknown class %s",
+              name.c_str());
+        return boost::none;
+      }
+      matches[i].push_back(cls);
+    }
+  }
+  return matches;
+}
+
+void ProguardMatcher::store_matches(
+    const std::string& key,
+    const std::vector<std::vector<DexClass*>>& matches) const {
+  std::vector<std::string> lines;
+  lines.reserve(matches.size());
+  for (const auto& rule_matches : matches) {
+    std::string line;
+    for (const auto* cls : rule_matches) {
+      if (!line.empty()) {
+        line += ' ';
+      }
+      line += cls->get_name()->str();
+    }
+    lines.push_back(std::move(line));
+  }
+  analysis_summary_cache::store("proguard_matches", key, lines);
+}
+
 void ProguardMatcher::classify_rules(const KeepRuleMatcher& rule_matcher,
                                      const RuleType& rule_type,
                                      const KeepSpec* keep_rule) {
@@ -905,23 +1014,89 @@ void ProguardMatcher::process_keep(KeepSpecSet::iterator keep_rules_begin,
     }
   };
 
-  // We only parallelize if keep_rule needs to be applied to all classes.
-  auto wq = workqueue_foreach<const KeepSpec*>([&](const KeepSpec* keep_rule) {
+  // Classes sorted by deobfuscated name; filled in below once we know there
+  // are slow rules. A class can only match a (non-negated) class name pattern
+  // if its name starts with the pattern's literal prefix, and all such classes
+  // form a contiguous range in here. This lets most rules with wildcards
+  // visit a small slice of the classes instead of running their regexes on
+  // all of them.
+  std::vector<std::pair<std::string_view, DexClass*>> sorted_classes;
+
+  // Returns the [begin, end) ranges of `sorted_classes` that may match the
+  // rule, sorted and without overlaps.
+  auto get_candidate_ranges = [&sorted_classes](const KeepSpec& keep_rule) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (const auto& class_name : keep_rule.class_spec.classNames) {
+      if (class_name.negated) {
+        // A class matching a negated pattern is rejected, never accepted.
+        continue;
+      }
+      auto prefix = class_name_literal_prefix(class_name.name);
+      auto begin = std::lower_bound(
+          sorted_classes.begin(), sorted_classes.end(), prefix,
+          [](const auto& entry, const std::string& p) {
+            return entry.first < p;
+          });
+      auto end = std::partition_point(
+          begin, sorted_classes.end(), [&prefix](const auto& entry) {
+            return entry.first.compare(0, prefix.size(), prefix) == 0;
+          });
+      ranges.emplace_back(begin - sorted_classes.begin(),
+                          end - sorted_classes.begin());
+    }
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<std::pair<size_t, size_t>> merged;
+    for (const auto& range : ranges) {
+      if (!merged.empty() && range.first <= merged.back().second) {
+        merged.back().second = std::max(merged.back().second, range.second);
+      } else if (range.first < range.second) {
+        merged.push_back(range);
+      }
+    }
+    return merged;
+  };
+
+  // Slow rules have to be matched against all classes; see below. We
+  // parallelize over them, and apply each rule's member-level keeps on the
+  // classes it matched right away.
+  std::vector<const KeepSpec*> slow_rules;
+  // When reusing the matches of a previous build, the classes that each slow
+  // rule matched, i.e. the classes to call `keep_processor` on.
+  boost::optional<std::vector<std::vector<DexClass*>>> cached_matches;
+  std::vector<std::vector<DexClass*>> matches;
+
+  auto process_slow_rule = [&](size_t rule_idx) {
+    const auto* keep_rule = slow_rules[rule_idx];
     RegexMap regex_map;
-    ClassMatcher class_match(*keep_rule);
     KeepRuleMatcher rule_matcher(rule_type, *keep_rule, regex_map);
+    auto keep = [&](DexClass* cls) {
+      std::unique_lock<std::mutex> lock(get_lock(cls));
+      rule_matcher.keep_processor(cls);
+    };
 
-    for (const auto& cls : m_classes) {
-      process_single_keep(class_match, rule_matcher, cls);
-    }
-    if (process_external) {
-      for (const auto& cls : m_external_classes) {
-        process_single_keep(class_match, rule_matcher, cls);
+    if (cached_matches) {
+      for (auto* cls : (*cached_matches)[rule_idx]) {
+        keep(cls);
+      }
+    } else {
+      ClassMatcher class_match(*keep_rule);
+      auto& rule_matches = matches[rule_idx];
+      for (const auto& [begin, end] : get_candidate_ranges(*keep_rule)) {
+        for (size_t i = begin; i < end; ++i) {
+          auto* cls = sorted_classes[i].second;
+          if (!process_external && cls->is_external()) {
+            continue;
+          }
+          if (class_match.match(cls)) {
+            rule_matches.push_back(cls);
+            keep(cls);
+          }
+        }
       }
     }
 
     classify_rules(rule_matcher, rule_type, keep_rule);
-  });
+  };
 
   RegexMap regex_map;
   for (auto it = keep_rules_begin; it != keep_rules_end; ++it) {
@@ -969,10 +1144,44 @@ void ProguardMatcher::process_keep(KeepSpecSet::iterator keep_rules_begin,
 
     TRACE(PGR, 2, "Slow rule: %s", show_keep(keep_rule).c_str());
     // Otherwise, it might take a longer time. Add to the work queue.
-    wq.add_item(&keep_rule);
+    slow_rules.push_back(&keep_rule);
+  }
+
+  if (slow_rules.empty()) {
+    return;
+  }
+
+  std::string cache_key;
+  if (analysis_summary_cache::enabled()) {
+    cache_key = match_cache_key(rule_type, process_external, slow_rules);
+    cached_matches = load_cached_matches(cache_key, slow_rules.size());
+  }
+  if (cached_matches) {
+    TRACE(PGR, 1, "Reusing matches of %zu slow rules for %s",
+          slow_rules.size(), to_string(rule_type).c_str());
+    workqueue_run_for<size_t>(0, slow_rules.size(), process_slow_rule);
+    return;
   }
 
-  wq.run_all();
+  auto add_sorted_classes = [&sorted_classes](const Scope& classes) {
+    for (auto* cls : classes) {
+      if (cls != nullptr) {
+        sorted_classes.emplace_back(cls->get_deobfuscated_name().str(), cls);
+      }
+    }
+  };
+  add_sorted_classes(m_classes);
+  if (process_external) {
+    add_sorted_classes(m_external_classes);
+  }
+  std::stable_sort(
+      sorted_classes.begin(), sorted_classes.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+  matches.resize(slow_rules.size());
+  workqueue_run_for<size_t>(0, slow_rules.size(), process_slow_rule);
+  if (!cache_key.empty()) {
+    store_matches(cache_key, matches);
+  }
 }
 
 void ProguardMatcher::process_proguard_rules(
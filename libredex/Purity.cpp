@@ -14,6 +14,7 @@
 
 #include <sparta/WeakTopologicalOrdering.h>
 
+#include "AnalysisSummaryCache.h"
 #include "ConfigFiles.h"
 #include "ControlFlow.h"
 #include "DexClass.h"
@@ -986,8 +987,42 @@ size_t compute_no_side_effects_methods(
     const method_override_graph::Graph* method_override_graph,
     const method::ClInitHasNoSideEffectsPredicate& clinit_has_no_side_effects,
     const std::unordered_set<DexMethodRef*>& pure_methods,
-    std::unordered_set<const DexMethod*>* result) {
+    std::unordered_set<const DexMethod*>* result,
+    const std::string* summary_cache_context) {
   Timer t("compute_no_side_effects_methods");
+  constexpr const char* SUMMARY_NAME = "no_side_effects_methods";
+  boost::optional<std::string> summary_key;
+  if (summary_cache_context && analysis_summary_cache::enabled()) {
+    std::vector<std::string> inputs;
+    inputs.reserve(pure_methods.size() + 2);
+    for (auto* pure_method : pure_methods) {
+      inputs.push_back(show(pure_method));
+    }
+    std::sort(inputs.begin(), inputs.end());
+    inputs.push_back(*summary_cache_context);
+    inputs.push_back(method_override_graph ? "override_graph" : "");
+    summary_key = analysis_summary_cache::make_key(
+        analysis_summary_cache::scope_digest(scope), inputs);
+    auto lines = analysis_summary_cache::load(SUMMARY_NAME, *summary_key);
+    if (lines) {
+      std::unordered_set<const DexMethod*> cached;
+      for (const auto& line : *lines) {
+        auto* method_ref = DexMethod::get_method(line);
+        if (method_ref == nullptr || !method_ref->is_def()) {
+          TRACE(CSE, 1, "[CSE] ignoring summary with unknown method %s",
+                line.c_str());
+          cached.clear();
+          lines = boost::none;
+          break;
+        }
+        cached.insert(method_ref->as_def());
+      }
+      if (lines) {
+        result->insert(cached.begin(), cached.end());
+        return 0;
+      }
+    }
+  }
   std::unordered_map<const DexMethod*, CseUnorderedLocationSet>
       method_locations;
   auto iterations = analyze_read_locations(
@@ -999,6 +1034,15 @@ size_t compute_no_side_effects_methods(
     TRACE(CSE, 4, "[CSE] no side effects method %s", SHOW(p.first));
     result->insert(p.first);
   }
+  if (summary_key) {
+    std::vector<std::string> lines;
+    lines.reserve(method_locations.size());
+    for (auto& p : method_locations) {
+      lines.push_back(show(p.first));
+    }
+    std::sort(lines.begin(), lines.end());
+    analysis_summary_cache::store(SUMMARY_NAME, *summary_key, lines);
+  }
   return iterations;
 }
 
@@ -173,14 +173,17 @@ size_t compute_conditionally_pure_methods(
 // state and only call other methods which do not have side effects.
 // The return value indicates how many iterations the fixed-point computation
 // required.
-// The return value indicates how many iterations the fixed-point computation
-// required.
+// If `summary_cache_context` is given and the AnalysisSummaryCache is enabled,
+// the result is looked up in and stored to the cache. As the predicate is
+// opaque, the context must identify how `clinit_has_no_side_effects` was
+// derived from the scope.
 size_t compute_no_side_effects_methods(
     const Scope& scope,
     const method_override_graph::Graph* method_override_graph,
     const method::ClInitHasNoSideEffectsPredicate& clinit_has_no_side_effects,
     const std::unordered_set<DexMethodRef*>& pure_methods,
-    std::unordered_set<const DexMethod*>* result);
+    std::unordered_set<const DexMethod*>* result,
+    const std::string* summary_cache_context = nullptr);
 
 // Determines whether for a given (possibly abstract) method, there may be a
 // method that effectively implements it. (If not, then that implies that no
@@ -759,7 +759,8 @@ MethodReferencesGatherer::get_returning_dependency(
   if (opcode::is_invoke_static(op) || opcode::is_invoke_direct(op)) {
     always_assert(refs->methods.size() == 1);
     const auto* resolved_callee =
-        resolve_method(insn->get_method(), opcode_to_search(insn), m_method);
+        resolve_method_cached(insn->get_method(), opcode_to_search(insn),
+                              m_method);
     if (resolved_callee) {
       always_assert(!resolved_callee->is_virtual());
       always_assert(!is_abstract(resolved_callee));
@@ -893,7 +894,7 @@ void MethodReferencesGatherer::default_gather_mie(const MethodItemEntry& mie,
       }
     } else if (gather_methods && (opcode::is_invoke_virtual(op) ||
                                   opcode::is_invoke_interface(op))) {
-      auto resolved_callee = resolve_invoke_method(insn, m_method);
+      auto resolved_callee = resolve_invoke_method_cached(insn, m_method);
       if (!resolved_callee) {
         // Typically clone() on an array, or other obscure external references
         TRACE(REACH, 2, "Unresolved virtual callee at %s", SHOW(insn));
@@ -2161,6 +2162,8 @@ void sweep(DexStoresVector& stores,
                       removed_symbols);
     sweep_interfaces(reachables, cls);
   });
+  // Member lists were edited in place above.
+  RedexContext::bump_hierarchy_generation();
 }
 
 void reanimate_zombie_methods(const ReachableAspects& reachable_aspects) {
@@ -2182,11 +2185,11 @@ void sweep_code(
     InsertOnlyConcurrentSet<DexMethod*>* affected_methods) {
   Timer t("Sweep Code");
   auto scope = build_class_scope(stores);
-  std::unordered_set<DexType*> uninstantiable_types;
-  std::unordered_set<DexMethod*> uncallable_instance_methods;
-  for (auto* cls : scope) {
+  remove_uninstantiables_impl::UninstantiableTypes uninstantiable_types;
+  ConcurrentSet<DexMethod*> uncallable_instance_methods;
+  walk::parallel::classes(scope, [&](DexClass* cls) {
     if (!reachable_aspects.instantiable_types.count_unsafe(cls)) {
-      uninstantiable_types.insert(cls->get_type());
+      uninstantiable_types.insert(cls);
     }
     if (prune_uncallable_instance_method_bodies) {
       for (auto* m : cls->get_dmethods()) {
@@ -2201,8 +2204,7 @@ void sweep_code(
         }
       }
     }
-  }
-  uninstantiable_types.insert(type::java_lang_Void());
+  });
   *remove_uninstantiables_stats = walk::parallel::methods<
       remove_uninstantiables_impl::Stats>(scope, [&](DexMethod* method) {
     auto code = method->get_code();
@@ -2231,7 +2233,7 @@ void sweep_code(
       cfg.remove_unreachable_blocks();
       affected_methods->insert(method);
     }
-    if (uncallable_instance_methods.count(method)) {
+    if (uncallable_instance_methods.count_unsafe(method)) {
       if (skip_uncallable_virtual_methods && method->is_virtual()) {
         return remove_uninstantiables_impl::Stats();
       }
@@ -2416,7 +2418,7 @@ void dump_graph(std::ostream& os, const ReachableObjectGraph& retainers_of) {
   auto key_adaptor = boost::adaptors::keys(retainers_of);
   std::vector<ReachableObject> keys(key_adaptor.begin(), key_adaptor.end());
   std::sort(keys.begin(), keys.end(), compare);
-  gw.write(os, keys);
+  gw.write(os, keys, /* with_index */ true);
 }
 
 template void TransitiveClosureMarkerWorker::push<DexClass>(
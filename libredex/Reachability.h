@@ -12,6 +12,7 @@
 
 #include <WorkQueue.h>
 
+#include "AtomicBitmap.h"
 #include "ConcurrentContainers.h"
 #include "ControlFlow.h"
 #include "DexClass.h"
@@ -19,6 +20,7 @@
 #include "MethodOverrideGraph.h"
 #include "MethodUtil.h"
 #include "Pass.h"
+#include "RedexContext.h"
 #include "RemoveUninstantiablesImpl.h"
 #include "Thread.h"
 
@@ -166,23 +168,46 @@ class ReachableObjects {
 
   void record_reachability(const DexMethodRef* member, const DexClass* cls);
 
-  static constexpr size_t MARK_SLOTS = 127;
-
-  ConcurrentSet<const DexClass*,
-                std::hash<const DexClass*>,
-                std::equal_to<const DexClass*>,
-                MARK_SLOTS>
-      m_marked_classes;
-  ConcurrentSet<const DexFieldRef*,
-                std::hash<const DexFieldRef*>,
-                std::equal_to<const DexFieldRef*>,
-                MARK_SLOTS>
-      m_marked_fields;
-  ConcurrentSet<const DexMethodRef*,
-                std::hash<const DexMethodRef*>,
-                std::equal_to<const DexMethodRef*>,
-                MARK_SLOTS>
-      m_marked_methods;
+  // Marks are kept in bitmaps over the dense indices of classes, fields and
+  // methods (see RedexContext::next_class_index and friends). Objects created
+  // after this ReachableObjects was go to an overflow set.
+  template <class T>
+  class MarkedSet {
+   public:
+    explicit MarkedSet(size_t capacity) : m_bits(capacity) {}
+
+    bool insert(const T* obj) {
+      auto idx = obj->get_dense_index();
+      bool inserted =
+          idx < m_bits.size() ? m_bits.set(idx) : m_overflow.insert(obj);
+      if (inserted) {
+        m_size.fetch_add(1, std::memory_order_relaxed);
+      }
+      return inserted;
+    }
+
+    bool count(const T* obj) const {
+      auto idx = obj->get_dense_index();
+      return idx < m_bits.size() ? m_bits.test(idx) : m_overflow.count(obj);
+    }
+
+    bool count_unsafe(const T* obj) const {
+      auto idx = obj->get_dense_index();
+      return idx < m_bits.size() ? m_bits.test(idx)
+                                 : m_overflow.count_unsafe(obj);
+    }
+
+    size_t size() const { return m_size.load(std::memory_order_relaxed); }
+
+   private:
+    AtomicBitmap m_bits;
+    ConcurrentSet<const T*> m_overflow;
+    std::atomic<size_t> m_size{0};
+  };
+
+  MarkedSet<DexClass> m_marked_classes{g_redex->num_class_indices()};
+  MarkedSet<DexFieldRef> m_marked_fields{g_redex->num_field_indices()};
+  MarkedSet<DexMethodRef> m_marked_methods{g_redex->num_method_indices()};
   ReachableObjectGraph m_retainers_of;
 
   friend class RootSetMarker;
@@ -31,18 +31,23 @@ static_assert(std::is_same<DexTypeList::ContainerType,
 
 RedexContext* g_redex;
 
+std::atomic<uint64_t> RedexContext::s_hierarchy_generation{0};
+
 RedexContext::RedexContext(bool allow_class_duplicates)
     : s_small_string_storage{16384, 111,
                              boost::thread::hardware_concurrency() / 2},
       s_medium_string_storage{65536, 2000,
                               boost::thread::hardware_concurrency() / 4},
       s_large_string_storage{0, 0, boost::thread::hardware_concurrency()},
+      s_type_storage{262144, 0, boost::thread::hardware_concurrency()},
+      s_proto_storage{262144, 0, boost::thread::hardware_concurrency()},
       m_allow_class_duplicates(allow_class_duplicates) {
   for (size_t i = 0; i < s_small_string_set.size(); ++i) {
     s_small_string_set[i] =
         new InsertOnlyConcurrentSet<DexStringRepr, DexStringReprHash,
                                     DexStringReprEqual>();
   }
+  bump_hierarchy_generation();
 }
 
 RedexContext::~RedexContext() {
@@ -62,17 +67,10 @@ RedexContext::~RedexContext() {
   size_t small_strings_size = 0;
   size_t large_strings_size = 0;
 
+  // DexTypes and DexProtos live in arenas, which release their buffers
+  // wholesale when they get destroyed; we only have to clear the tables.
   parallel_run({[&] {
-                  Timer timer("Delete DexTypes", /* indent */ false);
-                  // NB: This table intentionally contains aliases (multiple
-                  // DexStrings map to the same DexType), so we have to dedup
-                  // the set of types before deleting to avoid double-frees.
-                  std::unordered_set<DexType*> delete_types;
-                  for (auto const& p : s_type_map) {
-                    if (delete_types.emplace(p.second).second) {
-                      delete p.second;
-                    }
-                  }
+                  Timer timer("Clear DexTypes", /* indent */ false);
                   s_type_map.clear();
                 },
                 [&] {
@@ -83,10 +81,7 @@ RedexContext::~RedexContext() {
                   s_typelist_map.clear();
                 },
                 [&] {
-                  Timer timer("Delete DexProtos", /* indent */ false);
-                  for (auto* proto : s_proto_set) {
-                    delete proto;
-                  }
+                  Timer timer("Clear DexProtos", /* indent */ false);
                   s_proto_set.clear();
                 },
                 [&] {
@@ -201,7 +196,7 @@ RedexContext::~RedexContext() {
   s_method_map.clear();
 
   std::ostringstream oss;
-  auto log_stats = [&oss](auto* name, ConcurrentStringStorage& storage) {
+  auto log_stats = [&oss](auto* name, ConcurrentArena& storage) {
     auto stats = storage.get_stats();
     oss << "\n  " << name << ": " << stats.containers << " containers with "
         << stats.buffers << " buffers, " << stats.used << " / "
@@ -213,8 +208,10 @@ RedexContext::~RedexContext() {
   log_stats("small", s_small_string_storage);
   log_stats("medium", s_medium_string_storage);
   log_stats("large", s_large_string_storage);
+  log_stats("types", s_type_storage);
+  log_stats("protos", s_proto_storage);
   TRACE(PM, 1,
-        "String storage of %zu + %zu strings @ %u hardware concurrency:%s",
+        "Arena storage of %zu + %zu strings @ %u hardware concurrency:%s",
         small_strings_size, large_strings_size,
         boost::thread::hardware_concurrency(), oss.str().c_str());
 }
@@ -258,7 +255,15 @@ static StoredValue* try_insert(Key key,
   return ptr->load();
 }
 
-RedexContext::ConcurrentStringStorage::Container::~Container() {
+namespace {
+// Objects placed into an arena are released together with the arena.
+struct ArenaDeleter {
+  template <class T>
+  void operator()(T*) const {}
+};
+} // namespace
+
+RedexContext::ConcurrentArena::Container::~Container() {
   for (const auto* p = buffer; p;) {
     auto next = p->next;
     delete p;
@@ -266,7 +271,7 @@ RedexContext::ConcurrentStringStorage::Container::~Container() {
   }
 }
 
-char* RedexContext::ConcurrentStringStorage::Container::allocate(
+char* RedexContext::ConcurrentArena::Container::allocate(
     size_t length) {
   if (buffer == nullptr || buffer->used + length > buffer->allocated) {
     buffer = new Buffer(default_size == 0 ? length : default_size, buffer);
@@ -276,8 +281,8 @@ char* RedexContext::ConcurrentStringStorage::Container::allocate(
   return storage;
 }
 
-RedexContext::ConcurrentStringStorage::Context
-RedexContext::ConcurrentStringStorage::get_context() {
+RedexContext::ConcurrentArena::Context
+RedexContext::ConcurrentArena::get_context() {
 #if !IS_WINDOWS
   static std::atomic<size_t> next_index = 0;
   thread_local size_t index_plus_1 = 0;
@@ -321,8 +326,8 @@ RedexContext::ConcurrentStringStorage::get_context() {
   }
 }
 
-RedexContext::ConcurrentStringStorage::Stats
-RedexContext::ConcurrentStringStorage::get_stats() const {
+RedexContext::ConcurrentArena::Stats
+RedexContext::ConcurrentArena::get_stats() const {
   Stats stats;
   stats.waited = waited.load();
   stats.contention = contention.load();
@@ -347,7 +352,7 @@ RedexContext::ConcurrentStringStorage::get_stats() const {
   return stats;
 }
 
-RedexContext::ConcurrentStringStorage::Context::~Context() {
+RedexContext::ConcurrentArena::Context::~Context() {
   auto* other_container = owner->slots[index].container.exchange(container);
   if (other_container == nullptr) {
     std::atomic_thread_fence(std::memory_order_release);
@@ -366,21 +371,16 @@ RedexContext::ConcurrentStringStorage::Context::~Context() {
 }
 
 char* RedexContext::store_string(std::string_view str) {
-  ConcurrentStringStorage& concurrent_string_storage =
+  ConcurrentArena& concurrent_string_storage =
       str.length() < s_small_string_storage.max_allocation
           ? s_small_string_storage
       : str.length() < s_medium_string_storage.max_allocation
           ? s_medium_string_storage
           : s_large_string_storage;
 
-  char* storage;
-  {
-    auto storage_context = concurrent_string_storage.get_context();
-
-    // Note that DexStrings are keyed by a string_view created from the actual
-    // storage. The string_view is valid until the storage is destroyed.
-    storage = storage_context.container->allocate(str.length() + 1);
-  }
+  // Note that DexStrings are keyed by a string_view created from the actual
+  // storage. The string_view is valid until the storage is destroyed.
+  char* storage = concurrent_string_storage.allocate(str.length() + 1);
   memcpy(storage, str.data(), str.length());
   storage[str.length()] = 0;
   return storage;
@@ -399,7 +399,7 @@ const DexString* RedexContext::make_string(std::string_view str) {
       return reinterpret_cast<const DexString*>(rv_ptr);
     }
     char* storage = store_string(str);
-    uint32_t utfsize = length_of_utf8_string(storage);
+    uint32_t utfsize = length_of_utf8_string(storage, str.size());
     return reinterpret_cast<const DexString*>(
         s_small_string_set[str.size()]
             ->insert(DexStringRepr{storage, (uint32_t)str.length(), utfsize})
@@ -414,7 +414,7 @@ const DexString* RedexContext::make_string(std::string_view str) {
     return *rv_ptr;
   }
   char* storage = store_string(str);
-  uint32_t utfsize = length_of_utf8_string(storage);
+  uint32_t utfsize = length_of_utf8_string(storage, str.size());
   std::unique_ptr<DexString> string(
       new DexString(storage, str.length(), utfsize));
   return *try_insert(std::move(string), &segment);
@@ -476,7 +476,9 @@ DexType* RedexContext::make_type(const DexString* dstring) {
   if (rv != nullptr) {
     return rv;
   }
-  std::unique_ptr<DexType> type(new DexType(dstring));
+  std::unique_ptr<DexType, ArenaDeleter> type(
+      new (s_type_storage.allocate_object<DexType>()) DexType(dstring));
+  // If unsuccessful, we have wasted a bit of type storage.
   return try_insert(dstring, std::move(type), &s_type_map);
 }
 
@@ -516,6 +518,7 @@ DexFieldRef* RedexContext::make_field(const DexType* container,
   }
   std::unique_ptr<DexField> field(new DexField(
       const_cast<DexType*>(container), name, const_cast<DexType*>(type)));
+  field->m_dense_index = next_field_index();
   return try_insert<DexField, DexFieldRef>(r, std::move(field), &s_field_map);
 }
 
@@ -556,6 +559,7 @@ void RedexContext::mutate_field(DexFieldRef* field,
                                 const DexFieldSpec& ref,
                                 bool rename_on_collision) {
   std::lock_guard<std::mutex> lock(s_field_lock);
+  bump_hierarchy_generation();
   DexFieldSpec& r = field->m_spec;
   s_field_map.erase(r);
   r.cls = ref.cls != nullptr ? ref.cls : field->m_spec.cls;
@@ -612,8 +616,11 @@ DexProto* RedexContext::make_proto(const DexType* rtype,
   if (rv_ptr != nullptr) {
     return const_cast<DexProto*>(*rv_ptr);
   }
-  std::unique_ptr<DexProto> proto(new DexProto(
-      const_cast<DexType*>(rtype), const_cast<DexTypeList*>(args), shorty));
+  std::unique_ptr<DexProto, ArenaDeleter> proto(
+      new (s_proto_storage.allocate_object<DexProto>())
+          DexProto(const_cast<DexType*>(rtype), const_cast<DexTypeList*>(args),
+                   shorty));
+  // If unsuccessful, we have wasted a bit of proto storage.
   return const_cast<DexProto*>(*try_insert(std::move(proto), &s_proto_set));
 }
 
@@ -645,6 +652,7 @@ DexMethodRef* RedexContext::make_method(const DexType* type_,
   }
   std::unique_ptr<DexMethod, DexMethod::Deleter> method(
       new DexMethod(type, name, proto));
+  method->m_dense_index = next_method_index();
   return try_insert<DexMethod, DexMethodRef>(r, std::move(method),
                                              &s_method_map);
 }
@@ -697,6 +705,7 @@ void RedexContext::mutate_method(DexMethodRef* method,
                                  const DexMethodSpec& new_spec,
                                  bool rename_on_collision) {
   std::lock_guard<std::mutex> lock(s_method_lock);
+  bump_hierarchy_generation();
   DexMethodSpec old_spec = method->m_spec;
   s_method_map.erase(method->m_spec);
 
@@ -808,7 +817,9 @@ RedexContext::get_position_pattern_switch_manager() {
 // Return false on unique classes
 // Return true on benign duplicate classes
 // Throw RedexException on problematic duplicate classes
-bool RedexContext::class_already_loaded(DexClass* cls) {
+bool RedexContext::class_already_loaded(DexClass* cls,
+                                        DexIdx* idx,
+                                        const dex_class_def* cdef) {
   const DexType* type = cls->get_type();
   auto prev_cls = type->m_self.load(std::memory_order_acquire);
   if (prev_cls == nullptr) {
@@ -819,22 +830,41 @@ bool RedexContext::class_already_loaded(DexClass* cls) {
     if (prev_loc == cur_loc || dup_classes::is_known_dup(cls)) {
       // benign duplicates
       TRACE(MAIN, 1, "Warning: found a duplicate class: %s", SHOW(cls));
-    } else {
-      const std::string& class_name = show(cls);
-      TRACE(MAIN,
-            1,
-            "Found a duplicate class: %s in two dexes:\ndex 1: %s\ndex "
-            "2: %s\n",
-            class_name.c_str(),
-            prev_loc.c_str(),
-            cur_loc.c_str());
-
-      if (!m_allow_class_duplicates) {
-        throw RedexException(
-            RedexError::DUPLICATE_CLASSES,
-            "Found duplicate class in two different files.",
-            {{"class", class_name}, {"dex1", prev_loc}, {"dex2", cur_loc}});
+      return true;
+    }
+    const std::string& class_name = show(cls);
+    std::vector<std::string> diffs;
+    if (idx != nullptr && cdef != nullptr) {
+      diffs = dup_classes::compare_class_defs(prev_cls, idx, cdef);
+      if (diffs.empty()) {
+        // Identical duplicates are benign, whichever copy we keep.
+        TRACE(MAIN, 1, "Warning: found an identical duplicate class: %s in %s",
+              class_name.c_str(), cur_loc.c_str());
+        return true;
+      }
+    }
+    std::ostringstream diff;
+    for (const auto& d : diffs) {
+      diff << "\n  " << d;
+    }
+    TRACE(MAIN,
+          1,
+          "Found a duplicate class: %s in two dexes:\ndex 1: %s\ndex "
+          "2: %s%s\n",
+          class_name.c_str(),
+          prev_loc.c_str(),
+          cur_loc.c_str(),
+          diff.str().c_str());
+
+    if (!m_allow_class_duplicates) {
+      std::map<std::string, std::string> extra{
+          {"class", class_name}, {"dex1", prev_loc}, {"dex2", cur_loc}};
+      if (!diffs.empty()) {
+        extra.emplace("diff", diff.str());
       }
+      throw RedexException(RedexError::DUPLICATE_CLASSES,
+                           "Found duplicate class in two different files.",
+                           extra);
     }
     return true;
   }
@@ -850,6 +880,7 @@ void RedexContext::publish_class(DexClass* cls) {
                     cls->get_name()->c_str(),
                     cls->get_deobfuscated_name().c_str());
   m_classes.insert(cls);
+  bump_hierarchy_generation();
   if (cls->is_external()) {
     std::lock_guard<std::mutex> l(m_external_classes_mutex);
     m_external_classes.emplace_back(cls);
@@ -911,6 +942,20 @@ void RedexContext::set_sb_interaction_index(
   m_sb_interaction_indices = input;
 }
 
+std::vector<RedexContext::ArenaStats> RedexContext::get_arena_stats() const {
+  std::vector<ArenaStats> res;
+  auto add = [&res](const char* kind, const ConcurrentArena& arena) {
+    auto stats = arena.get_stats();
+    res.push_back({kind, stats.allocated, stats.used});
+  };
+  add("small_strings", s_small_string_storage);
+  add("medium_strings", s_medium_string_storage);
+  add("large_strings", s_large_string_storage);
+  add("types", s_type_storage);
+  add("protos", s_proto_storage);
+  return res;
+}
+
 void RedexContext::compact() {
   // We parallelize destruction for efficiency.
   auto parallel_run = [](const std::vector<std::function<void()>>& fns) {
@@ -10,6 +10,7 @@
 #include <array>
 #include <atomic>
 #include <boost/functional/hash.hpp>
+#include <cstddef>
 #include <cstring>
 #include <deque>
 #include <functional>
@@ -20,6 +21,7 @@
 #include <set>
 #include <sstream>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -35,12 +37,14 @@ class DexDebugInstruction;
 class DexField;
 class DexFieldRef;
 class DexMethod;
+class DexIdx;
 class DexMethodHandle;
 class DexMethodRef;
 class DexProto;
 class DexString;
 struct DexStringRepr;
 class DexType;
+struct dex_class_def;
 class DexTypeList;
 class PositionPatternSwitchManager;
 struct DexDebugEntry;
@@ -145,7 +149,11 @@ struct RedexContext {
   // Return false on unique classes
   // Return true on benign duplicate classes
   // Throw RedexException on problematic duplicate classes
-  bool class_already_loaded(DexClass* cls);
+  // When the definition of `cls` is given by `idx` and `cdef`, duplicates that
+  // are identical to the loaded class are benign.
+  bool class_already_loaded(DexClass* cls,
+                            DexIdx* idx = nullptr,
+                            const dex_class_def* cdef = nullptr);
 
   void publish_class(DexClass* cls);
 
@@ -158,6 +166,16 @@ struct RedexContext {
     }
   }
 
+  // Calls `walker` for every interned method ref, once per name it is
+  // interned under. Not safe to run concurrently with method creation or
+  // removal.
+  template <class MethodWalkerFn = void(DexMethodRef*)>
+  void walk_methods(MethodWalkerFn walker) {
+    for (auto&& [_, loc] : s_method_map) {
+      walker(loc.load());
+    }
+  }
+
   const std::vector<DexClass*>& external_classes() const {
     return m_external_classes;
   }
@@ -213,6 +231,27 @@ struct RedexContext {
   // This is for convenience.
   bool instrument_mode{false};
 
+  // If set, code loaded from dex files is lifted to IRCode on first access
+  // instead of at load time, see `DexMethod::balloon_lazily`.
+  bool lazy_code_materialization{false};
+
+  // How much of the debug info of code loaded from dex files gets
+  // materialized. Builds that strip debug info anyway can skip local variable
+  // and prologue/epilogue entries, which leaves the line numbers needed for
+  // IODI, or skip debug items altogether.
+  enum class DebugInfoLoading { kFull, kLinesOnly, kNone };
+  DebugInfoLoading debug_info_loading{DebugInfoLoading::kFull};
+
+  // Intraprocedural fixpoint iterations that opt in (see
+  // `ir_analyzer::fixpoint_num_threads`) use up to this many threads for
+  // methods with at least `parallel_fixpoint_min_blocks` blocks.
+  size_t parallel_fixpoint_threads{1};
+  size_t parallel_fixpoint_min_blocks{2000};
+
+  // If non-empty, whole-program analysis summaries are cached in this
+  // directory across builds, see AnalysisSummaryCache.h.
+  std::string analysis_summary_cache_dir;
+
   bool ordering_changes_allowed() const { return m_ordering_changes_allowed; }
   void set_ordering_changes_allowed(bool new_val) {
     m_ordering_changes_allowed = new_val;
@@ -225,12 +264,48 @@ struct RedexContext {
   // versions.
   void compact();
 
+  // Bytes allocated / used by one of the bump-pointer arenas backing the
+  // interning tables.
+  struct ArenaStats {
+    const char* kind;
+    size_t allocated;
+    size_t used;
+  };
+  // Not synchronized with concurrent allocations; meant to be called between
+  // passes.
+  std::vector<ArenaStats> get_arena_stats() const;
+
+  // Dense indices of classes, fields and methods (including refs), handed out
+  // at creation, so that analyses can use bitmaps instead of pointer-keyed
+  // sets. Indices are not reused, so there are gaps for deleted objects, and
+  // for objects that lost an insertion race.
+  uint32_t next_class_index() { return m_num_class_indices.fetch_add(1); }
+  uint32_t next_field_index() { return m_num_field_indices.fetch_add(1); }
+  uint32_t next_method_index() { return m_num_method_indices.fetch_add(1); }
+  uint32_t num_class_indices() const { return m_num_class_indices.load(); }
+  uint32_t num_field_indices() const { return m_num_field_indices.load(); }
+  uint32_t num_method_indices() const { return m_num_method_indices.load(); }
+
+  // Bumped whenever a class hierarchy or member list changes through the
+  // DexClass / RedexContext mutators, so that caches of resolution results
+  // (see Resolver.h) can tell that they are stale. The counter is process-wide
+  // and also bumped for every new context, so that cached pointers never
+  // outlive the objects they point to.
+  static void bump_hierarchy_generation() {
+    s_hierarchy_generation.fetch_add(1, std::memory_order_relaxed);
+  }
+  static uint64_t hierarchy_generation() {
+    return s_hierarchy_generation.load(std::memory_order_relaxed);
+  }
+
  private:
   struct Strcmp;
   struct TruncatedStringHash;
 
-  // A thread-safe container for raw string storage
-  struct ConcurrentStringStorage {
+  // A thread-safe bump-pointer arena. It is used for raw string storage, and
+  // for interned objects which are trivially destructible and never freed
+  // individually, so that teardown only has to release a few large buffers.
+  struct ConcurrentArena {
     static constexpr size_t n_slots = 11;
     // A not thread-safe container, holding individually allocated buffers
     struct Container {
@@ -256,7 +331,7 @@ struct RedexContext {
     // A context for a temporarily acquired container that will be released to
     // its owner when the context is destructed
     struct Context {
-      ConcurrentStringStorage* owner;
+      ConcurrentArena* owner;
       size_t index;
       Container* container;
       ~Context();
@@ -287,7 +362,7 @@ struct RedexContext {
     std::array<Slot, n_slots> slots;
     std::mutex pool_lock;
     std::vector<std::unique_ptr<Container>> pool;
-    ConcurrentStringStorage(size_t default_buffer_size,
+    ConcurrentArena(size_t default_buffer_size,
                             size_t max_allocation,
                             size_t max_containers)
         : default_buffer_size(default_buffer_size),
@@ -295,7 +370,18 @@ struct RedexContext {
           max_containers(std::max(max_containers, n_slots)) {}
     Context get_context();
     Stats get_stats() const;
-    ~ConcurrentStringStorage() {
+    char* allocate(size_t length) {
+      auto context = get_context();
+      return context.container->allocate(length);
+    }
+    template <typename T>
+    void* allocate_object() {
+      static_assert(std::is_trivially_destructible_v<T>);
+      static_assert(alignof(T) <= alignof(std::max_align_t));
+      constexpr size_t size = (sizeof(T) + alignof(T) - 1) & ~(alignof(T) - 1);
+      return allocate(size);
+    }
+    ~ConcurrentArena() {
       for (auto& slot : slots) {
         delete slot.container.load();
       }
@@ -419,14 +505,15 @@ struct RedexContext {
       s_small_string_set;
 
   // We maintain three kinds of raw string storage
-  ConcurrentStringStorage s_small_string_storage;
-  ConcurrentStringStorage s_medium_string_storage;
-  ConcurrentStringStorage s_large_string_storage;
+  ConcurrentArena s_small_string_storage;
+  ConcurrentArena s_medium_string_storage;
+  ConcurrentArena s_large_string_storage;
 
   char* store_string(std::string_view);
 
   // DexType
   AtomicMap<const DexString*, DexType*> s_type_map;
+  ConcurrentArena s_type_storage;
 
   // DexFieldRef
   AtomicMap<DexFieldSpec, DexFieldRef*> s_field_map;
@@ -459,6 +546,7 @@ struct RedexContext {
   };
   InsertOnlyConcurrentSet<DexProto*, DexProtoKeyHash, DexProtoKeyEqual>
       s_proto_set;
+  ConcurrentArena s_proto_storage;
 
   // DexMethod
   AtomicMap<DexMethodSpec, DexMethodRef*> s_method_map;
@@ -504,4 +592,10 @@ struct RedexContext {
       method_return_values;
 
   bool m_ordering_changes_allowed{true};
+
+  std::atomic<uint32_t> m_num_class_indices{0};
+  std::atomic<uint32_t> m_num_field_indices{0};
+  std::atomic<uint32_t> m_num_method_indices{0};
+
+  static std::atomic<uint64_t> s_hierarchy_generation;
 };
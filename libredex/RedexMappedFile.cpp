@@ -10,8 +10,19 @@
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <fstream>
 
+#ifdef __linux__
+#include <sys/mman.h> // For madvise
+#endif
+
 #include "Debug.h"
 
+namespace {
+
+// Smaller mappings would not fill a single 2MiB huge page.
+constexpr size_t kHugePageMinMappingSize = 4 * 1024 * 1024;
+
+} // namespace
+
 RedexMappedFile::RedexMappedFile(
     std::unique_ptr<boost::iostreams::mapped_file> file,
     std::string filename,
@@ -44,9 +55,28 @@ RedexMappedFile RedexMappedFile::open(std::string path, bool read_only) {
     throw std::runtime_error(std::string("Could not map ") + path);
   }
 
+  if (read_only) {
+    advise_read_mostly(map->const_data(), map->size());
+  }
   return RedexMappedFile(std::move(map), std::move(path), read_only);
 }
 
+void RedexMappedFile::advise_read_mostly(const char* data, size_t size) {
+#ifdef __linux__
+  if (size == 0) {
+    return;
+  }
+  // Inputs are decoded in parallel from all over the file, so prefetch all of
+  // it rather than rely on sequential readahead.
+  madvise(const_cast<char*>(data), size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+  if (size >= kHugePageMinMappingSize) {
+    madvise(const_cast<char*>(data), size, MADV_HUGEPAGE);
+  }
+#endif
+#endif
+}
+
 const char* RedexMappedFile::const_data() const { return file->const_data(); }
 char* RedexMappedFile::data() const {
   redex_assert(!read_only);
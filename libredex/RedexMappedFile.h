@@ -34,6 +34,10 @@ struct RedexMappedFile {
 
   static RedexMappedFile open(std::string path, bool read_only = true);
 
+  // Hints the kernel that a read-mostly mapping will be read in full soon,
+  // and asks for huge pages for large ones. No-op where unsupported.
+  static void advise_read_mostly(const char* data, size_t size);
+
   const char* const_data() const;
   char* data() const;
   size_t size() const;
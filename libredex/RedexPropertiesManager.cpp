@@ -8,15 +8,21 @@
 #include "RedexPropertiesManager.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <sstream>
 #include <string_view>
 
+#include <boost/functional/hash.hpp>
+
 #include "ConfigFiles.h"
+#include "DexClass.h"
+#include "MethodUtil.h"
 #include "RedexProperties.h"
 #include "RedexPropertyChecker.h"
 #include "StlUtil.h"
 #include "Trace.h"
+#include "Walkers.h"
 
 namespace redex_properties {
 
@@ -88,12 +94,66 @@ std::unordered_set<Property> Manager::get_required(
   return res;
 }
 
+void Manager::set_skip_unchanged_methods(bool skip) {
+  if (!skip) {
+    m_checked_fingerprints = nullptr;
+  } else if (!m_checked_fingerprints) {
+    m_checked_fingerprints =
+        std::make_unique<ConcurrentMap<const DexMethod*, size_t>>();
+  }
+}
+
 void Manager::check(DexStoresVector& stores, PassManager& mgr) {
+  std::vector<MethodPropertyChecker*> method_checkers;
   for (auto* checker : m_checkers) {
+    bool established = m_established.count(checker->get_property());
+    if (auto* method_checker = dynamic_cast<MethodPropertyChecker*>(checker)) {
+      if (method_checker->is_active(established)) {
+        method_checkers.push_back(method_checker);
+      }
+      continue;
+    }
+    TRACE(PM, 3, "Checking for %s...", get_name(checker->get_property()));
+    checker->run_checker(stores, m_conf, mgr, established);
+  }
+  check_methods(stores, method_checkers);
+}
+
+void Manager::check_methods(
+    DexStoresVector& stores,
+    const std::vector<MethodPropertyChecker*>& checkers) {
+  if (checkers.empty()) {
+    return;
+  }
+  // A method that passed some checks still needs to be checked when another
+  // property becomes active, so the fingerprints cover the active checkers.
+  size_t active = 0;
+  for (auto* checker : checkers) {
     TRACE(PM, 3, "Checking for %s...", get_name(checker->get_property()));
-    checker->run_checker(stores, m_conf, mgr,
-                         m_established.count(checker->get_property()));
+    boost::hash_combine(active, checker);
   }
+  std::atomic<size_t> skipped{0};
+  walk::parallel::code(
+      build_class_scope(stores), [&](DexMethod* method, IRCode& code) {
+        size_t fingerprint = 0;
+        if (m_checked_fingerprints) {
+          fingerprint = method::code_fingerprint(method);
+          boost::hash_combine(fingerprint, active);
+          if (m_checked_fingerprints->get(method, 0) == fingerprint) {
+            skipped.fetch_add(1, std::memory_order_relaxed);
+            return;
+          }
+        }
+        for (auto* checker : checkers) {
+          checker->check_method(method, code);
+        }
+        if (m_checked_fingerprints) {
+          m_checked_fingerprints->insert_or_assign(
+              std::make_pair(method, fingerprint));
+        }
+      });
+  TRACE(PM, 2, "Property checks skipped %zu unchanged methods",
+        skipped.load());
 }
 
 const std::unordered_set<Property>& Manager::apply(
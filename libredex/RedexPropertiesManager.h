@@ -10,19 +10,24 @@
 #include "RedexProperties.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "ConcurrentContainers.h"
+
 struct ConfigFiles;
+class DexMethod;
 class DexStore;
 using DexStoresVector = std::vector<DexStore>;
 class PassManager;
 
 namespace redex_properties {
 
+class MethodPropertyChecker;
 class PropertyChecker;
 
 class Manager {
@@ -43,6 +48,10 @@ class Manager {
 
   void check(DexStoresVector& stores, PassManager& mgr);
 
+  // Whether method checkers skip methods whose code did not change since they
+  // last passed the same set of checks.
+  void set_skip_unchanged_methods(bool skip);
+
   const std::unordered_set<Property>& apply(
       const PropertyInteractions& interactions);
   const std::unordered_set<Property>& apply_and_check(
@@ -66,6 +75,14 @@ class Manager {
   std::unordered_set<Property> m_established;
 
   std::vector<redex_properties::PropertyChecker*> m_checkers;
+
+  // Fingerprints of methods that passed the method checkers, see
+  // `set_skip_unchanged_methods`.
+  std::unique_ptr<ConcurrentMap<const DexMethod*, size_t>>
+      m_checked_fingerprints;
+
+  void check_methods(DexStoresVector& stores,
+                     const std::vector<MethodPropertyChecker*>& checkers);
 };
 
 } // namespace redex_properties
@@ -8,6 +8,9 @@
 #include "RedexPropertyChecker.h"
 #include "RedexPropertyCheckerRegistry.h"
 
+#include "DexClass.h"
+#include "Walkers.h"
+
 namespace redex_properties {
 
 PropertyChecker::PropertyChecker(Property property) : m_property(property) {
@@ -16,4 +19,17 @@ PropertyChecker::PropertyChecker(Property property) : m_property(property) {
 
 PropertyChecker::~PropertyChecker() {}
 
+void MethodPropertyChecker::run_checker(DexStoresVector& stores,
+                                        ConfigFiles& /* conf */,
+                                        PassManager& /* mgr */,
+                                        bool established) {
+  if (!is_active(established)) {
+    return;
+  }
+  const auto& scope = build_class_scope(stores);
+  walk::parallel::code(scope, [&](DexMethod* method, IRCode& code) {
+    check_method(method, code);
+  });
+}
+
 } // namespace redex_properties
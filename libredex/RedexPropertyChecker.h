@@ -12,6 +12,7 @@
 #include "DexStore.h"
 
 struct ConfigFiles;
+class IRCode;
 class PassManager;
 
 namespace redex_properties {
@@ -29,4 +30,26 @@ class PropertyChecker {
                            bool established) = 0;
 };
 
+/**
+ * A checker that looks at the code of each method in isolation. The manager
+ * runs all active method checkers in a single parallel walk per check point,
+ * and can skip methods whose code did not change since they last passed.
+ */
+class MethodPropertyChecker : public PropertyChecker {
+ public:
+  using PropertyChecker::PropertyChecker;
+
+  // Whether the methods need to be checked, given whether the property is
+  // currently established.
+  virtual bool is_active(bool established) const { return established; }
+
+  // Called in parallel for the methods with code.
+  virtual void check_method(DexMethod* method, IRCode& code) = 0;
+
+  void run_checker(DexStoresVector& stores,
+                   ConfigFiles& conf,
+                   PassManager& mgr,
+                   bool established) override;
+};
+
 } // namespace redex_properties
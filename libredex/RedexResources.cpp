@@ -257,11 +257,15 @@ void AndroidResources::collect_layout_classes_and_attributes(
     std::unordered_set<std::string>* out_classes,
     std::unordered_multimap<std::string, std::string>* out_attributes) {
   auto res_table = load_res_table();
+  const auto num_threads =
+      std::min(redex_parallel::default_num_threads(), kReadXMLThreads);
   auto collect_fn = [&](const std::vector<std::string>& prefixes) {
-    std::mutex out_mutex;
-    resources::StringOrReferenceSet classes;
-    std::unordered_multimap<std::string, resources::StringOrReference>
-        attributes;
+    // Every worker accumulates into its own slot, which are only combined
+    // once all files have been read.
+    std::vector<resources::StringOrReferenceSet> worker_classes(num_threads);
+    std::vector<
+        std::unordered_multimap<std::string, resources::StringOrReference>>
+        worker_attributes(num_threads);
     workqueue_run<std::string>(
         [&](sparta::WorkerState<std::string>* worker_state,
             const std::string& input) {
@@ -281,22 +285,23 @@ void AndroidResources::collect_layout_classes_and_attributes(
             return;
           }
 
-          resources::StringOrReferenceSet local_classes;
-          std::unordered_multimap<std::string, resources::StringOrReference>
-              local_attributes;
+          auto id = worker_state->worker_id();
           collect_layout_classes_and_attributes_for_file(
-              input, attributes_to_read, &local_classes, &local_attributes);
-          if (!local_classes.empty() || !local_attributes.empty()) {
-            std::unique_lock<std::mutex> lock(out_mutex);
-            // C++17: use merge to avoid copies.
-            classes.insert(local_classes.begin(), local_classes.end());
-            attributes.insert(local_attributes.begin(), local_attributes.end());
-          }
+              input, attributes_to_read, &worker_classes[id],
+              &worker_attributes[id]);
         },
         std::vector<std::string>{""},
-        std::min(redex_parallel::default_num_threads(), kReadXMLThreads),
+        num_threads,
         /*push_tasks_while_running=*/true);
 
+    resources::StringOrReferenceSet classes;
+    std::unordered_multimap<std::string, resources::StringOrReference>
+        attributes;
+    for (size_t i = 0; i < num_threads; i++) {
+      classes.merge(worker_classes[i]);
+      attributes.merge(worker_attributes[i]);
+    }
+
     // Resolve references that were encountered while reading xml files
     for (const auto& val : classes) {
       if (val.is_reference()) {
@@ -339,7 +344,11 @@ void AndroidResources::collect_layout_classes_and_attributes(
 
 void AndroidResources::collect_xml_attribute_string_values(
     std::unordered_set<std::string>* out) {
-  std::mutex out_mutex;
+  const auto num_threads =
+      std::min(redex_parallel::default_num_threads(), kReadXMLThreads);
+  // Every worker accumulates into its own set, which are only combined once
+  // all files have been read.
+  std::vector<std::unordered_set<std::string>> worker_values(num_threads);
   workqueue_run<std::string>(
       [&](sparta::WorkerState<std::string>* worker_state,
           const std::string& input) {
@@ -357,17 +366,16 @@ void AndroidResources::collect_xml_attribute_string_values(
           return;
         }
 
-        std::unordered_set<std::string> local_out_values;
-        collect_xml_attribute_string_values_for_file(input, &local_out_values);
-        if (!local_out_values.empty()) {
-          std::unique_lock<std::mutex> lock(out_mutex);
-          // C++17: use merge to avoid copies.
-          out->insert(local_out_values.begin(), local_out_values.end());
-        }
+        collect_xml_attribute_string_values_for_file(
+            input, &worker_values[worker_state->worker_id()]);
       },
       std::vector<std::string>{""},
-      std::min(redex_parallel::default_num_threads(), kReadXMLThreads),
+      num_threads,
       /*push_tasks_while_running=*/true);
+
+  for (auto& values : worker_values) {
+    out->merge(values);
+  }
 }
 
 void AndroidResources::rename_classes_in_layouts(
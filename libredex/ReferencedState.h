@@ -7,11 +7,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <boost/optional.hpp>
 #include <limits>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "Debug.h"
 #include "KeepReason.h"
@@ -197,7 +199,8 @@ class ReferencedState {
   // keeping memory requirements still small in non-default case.
   struct KeepReasons {
     std::mutex m_keep_reasons_mtx;
-    keep_reason::ReasonPtrSet m_keep_reasons;
+    // Sorted and unique.
+    std::vector<keep_reason::ReasonIndex> m_keep_reasons;
   };
   mutable std::atomic<KeepReasons*> m_keep_reasons{nullptr};
 
@@ -415,14 +418,24 @@ class ReferencedState {
     inner_struct.m_unset_allowobfuscation = false;
   }
 
-  const keep_reason::ReasonPtrSet& keep_reasons() const {
-    if (!keep_reason::Reason::record_keep_reasons()) {
-      // We really should not allow this.
-      static keep_reason::ReasonPtrSet SINGLETON;
-      return SINGLETON;
+  /*
+   * Returns the keep reasons of this DexMember, in the order in which the
+   * reasons were first recorded in this Redex run.
+   */
+  std::vector<const keep_reason::Reason*> keep_reasons() const {
+    std::vector<const keep_reason::Reason*> res;
+    // We really should not allow calling this when not recording.
+    auto* keep_reasons = m_keep_reasons.load();
+    if (!keep_reason::Reason::record_keep_reasons() ||
+        keep_reasons == nullptr) {
+      return res;
     }
-    auto& keep_reasons = ensure_keep_reasons();
-    return keep_reasons.m_keep_reasons;
+    std::lock_guard<std::mutex> lock(keep_reasons->m_keep_reasons_mtx);
+    res.reserve(keep_reasons->m_keep_reasons.size());
+    for (auto index : keep_reasons->m_keep_reasons) {
+      res.push_back(keep_reason::Reason::get(index));
+    }
+    return res;
   }
 
   template <class... Args>
@@ -669,11 +682,15 @@ class ReferencedState {
     return *expected;
   }
 
-  void add_keep_reason(const keep_reason::Reason* reason) {
+  void add_keep_reason(keep_reason::ReasonIndex reason) {
     always_assert(keep_reason::Reason::record_keep_reasons());
     auto& keep_reasons = ensure_keep_reasons();
     std::lock_guard<std::mutex> lock(keep_reasons.m_keep_reasons_mtx);
-    keep_reasons.m_keep_reasons.emplace(reason);
+    auto& reasons = keep_reasons.m_keep_reasons;
+    auto it = std::lower_bound(reasons.begin(), reasons.end(), reason);
+    if (it == reasons.end() || *it != reason) {
+      reasons.insert(it, reason);
+    }
   }
 
   friend class keep_rules::impl::KeepState;
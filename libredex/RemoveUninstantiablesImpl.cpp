@@ -16,6 +16,7 @@
 #include "MethodFixup.h"
 #include "NullPointerExceptionUtil.h"
 #include "PassManager.h"
+#include "RedexContext.h"
 #include "ScopedCFG.h"
 #include "Trace.h"
 #include "Walkers.h"
@@ -113,9 +114,11 @@ void Stats::report(PassManager& mgr) const {
 #undef REPORT
 }
 
-Stats replace_uninstantiable_refs(
-    const std::unordered_set<DexType*>& scoped_uninstantiable_types,
-    cfg::ControlFlowGraph& cfg) {
+namespace {
+
+template <typename IsUninstantiable>
+Stats replace_uninstantiable_refs_impl(
+    const IsUninstantiable& is_uninstantiable, cfg::ControlFlowGraph& cfg) {
   cfg::CFGMutation m(cfg);
 
   Stats stats;
@@ -126,7 +129,7 @@ Stats replace_uninstantiable_refs(
     auto op = insn->opcode();
     switch (op) {
     case OPCODE_INSTANCE_OF:
-      if (scoped_uninstantiable_types.count(insn->get_type())) {
+      if (is_uninstantiable(insn->get_type())) {
         auto dest = cfg.move_result_of(it)->insn->dest();
         m.replace(it, {ir_const(dest, 0)});
         stats.instance_ofs++;
@@ -140,14 +143,14 @@ Stats replace_uninstantiable_refs(
       // Note that we don't want to call resolve_method here: The most precise
       // class information is already present in the supplied method reference,
       // which gives us the best change of finding an uninstantiable type.
-      if (scoped_uninstantiable_types.count(insn->get_method()->get_class())) {
+      if (is_uninstantiable(insn->get_method()->get_class())) {
         m.replace(it, npe_creator.get_insns(insn));
         stats.invokes++;
       }
       continue;
 
     case OPCODE_CHECK_CAST:
-      if (scoped_uninstantiable_types.count(insn->get_type())) {
+      if (is_uninstantiable(insn->get_type())) {
         auto src = insn->src(0);
         auto dest = cfg.move_result_of(it)->insn->dest();
         m.replace(it,
@@ -163,21 +166,21 @@ Stats replace_uninstantiable_refs(
     }
 
     if (opcode::is_an_iget(op) &&
-        scoped_uninstantiable_types.count(insn->get_field()->get_class())) {
+        is_uninstantiable(insn->get_field()->get_class())) {
       m.replace(it, npe_creator.get_insns(insn));
       stats.field_accesses_on_uninstantiable++;
       continue;
     }
 
     if (opcode::is_an_iput(op) &&
-        scoped_uninstantiable_types.count(insn->get_field()->get_class())) {
+        is_uninstantiable(insn->get_field()->get_class())) {
       m.replace(it, npe_creator.get_insns(insn));
       stats.field_accesses_on_uninstantiable++;
       continue;
     }
 
     if ((opcode::is_an_iget(op) || opcode::is_an_sget(op)) &&
-        scoped_uninstantiable_types.count(insn->get_field()->get_type())) {
+        is_uninstantiable(insn->get_field()->get_type())) {
       auto dest = cfg.move_result_of(it)->insn->dest();
       m.replace(it, {ir_const(dest, 0)});
       stats.get_uninstantiables++;
@@ -185,8 +188,7 @@ Stats replace_uninstantiable_refs(
     }
 
     if (opcode::is_an_invoke(op) &&
-        scoped_uninstantiable_types.count(
-            insn->get_method()->get_proto()->get_rtype())) {
+        is_uninstantiable(insn->get_method()->get_proto()->get_rtype())) {
       auto move_result_it = cfg.move_result_of(it);
       if (!move_result_it.is_end()) {
         auto dest = move_result_it->insn->dest();
@@ -201,6 +203,43 @@ Stats replace_uninstantiable_refs(
   return stats;
 }
 
+} // namespace
+
+UninstantiableTypes::UninstantiableTypes()
+    : m_bits(g_redex->num_class_indices()) {}
+
+void UninstantiableTypes::insert(const DexClass* cls) {
+  m_bits.set(cls->get_dense_index());
+}
+
+bool UninstantiableTypes::contains(const DexType* type) const {
+  if (type == type::java_lang_Void()) {
+    return true;
+  }
+  auto* cls = type_class(type);
+  if (cls == nullptr) {
+    return false;
+  }
+  auto idx = cls->get_dense_index();
+  return idx < m_bits.size() && m_bits.test(idx);
+}
+
+Stats replace_uninstantiable_refs(
+    const std::unordered_set<DexType*>& scoped_uninstantiable_types,
+    cfg::ControlFlowGraph& cfg) {
+  return replace_uninstantiable_refs_impl(
+      [&](DexType* type) { return scoped_uninstantiable_types.count(type); },
+      cfg);
+}
+
+Stats replace_uninstantiable_refs(
+    const UninstantiableTypes& scoped_uninstantiable_types,
+    cfg::ControlFlowGraph& cfg) {
+  return replace_uninstantiable_refs_impl(
+      [&](DexType* type) { return scoped_uninstantiable_types.contains(type); },
+      cfg);
+}
+
 Stats replace_all_with_unreachable_throw(cfg::ControlFlowGraph& cfg) {
   auto* entry = cfg.entry_block();
   always_assert_log(entry, "Expect an entry block");
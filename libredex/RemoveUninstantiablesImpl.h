@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "AtomicBitmap.h"
 #include "ConcurrentContainers.h"
 #include "DexStore.h"
 #include "Pass.h"
@@ -45,12 +46,34 @@ struct Stats {
   void report(PassManager& mgr) const;
 };
 
+/// The types of classes that are known to be uninstantiable, as a bitmap over
+/// the dense indices of classes (see RedexContext::next_class_index), so that
+/// it can be filled in parallel and queried without hashing.
+/// java.lang.Void is always uninstantiable. Types without classes, and
+/// classes created after the set, never are.
+class UninstantiableTypes {
+ public:
+  UninstantiableTypes();
+
+  /// Thread-safe.
+  void insert(const DexClass* cls);
+
+  bool contains(const DexType* type) const;
+
+ private:
+  AtomicBitmap m_bits;
+};
+
 /// Look for mentions of uninstantiable classes in \p cfg and modify them
 /// in-place.
 Stats replace_uninstantiable_refs(
     const std::unordered_set<DexType*>& scoped_uninstantiable_types,
     cfg::ControlFlowGraph& cfg);
 
+Stats replace_uninstantiable_refs(
+    const UninstantiableTypes& scoped_uninstantiable_types,
+    cfg::ControlFlowGraph& cfg);
+
 /// Replace the instructions in \p cfg with `throw unreachable;`.  Preserves the
 /// initial run of load-param instructions in the ControlFlowGraph.
 ///
@@ -6,7 +6,11 @@
  */
 
 #include "Resolver.h"
+
+#include <atomic>
+
 #include "DexUtil.h"
+#include "RedexContext.h"
 
 namespace {
 
@@ -20,17 +24,7 @@ DexMethod* resolve_intf_method_ref(const DexClass* cls,
                                    const DexString* name,
                                    const DexProto* proto) {
 
-  auto find_method = [&](const DexClass* cls) -> DexMethod* {
-    const auto& vmethods = cls->get_vmethods();
-    for (const auto vmethod : vmethods) {
-      if (vmethod->get_name() == name && vmethod->get_proto() == proto) {
-        return vmethod;
-      }
-    }
-    return nullptr;
-  };
-
-  auto method = find_method(cls);
+  auto method = cls->find_method(name, proto, /* is_virtual */ true);
   if (method) return method;
   for (const auto& super_intf : *cls->get_interfaces()) {
     const auto& super_intf_cls = type_class(super_intf);
@@ -75,18 +69,16 @@ DexMethod* resolve_method(const DexClass* cls,
       }
     }
     if (search == MethodSearch::Virtual || search == MethodSearch::Any) {
-      for (auto& vmeth : cls->get_vmethods()) {
-        if (match(name, proto, vmeth)) {
-          return vmeth;
-        }
+      auto* vmeth = cls->find_method(name, proto, /* is_virtual */ true);
+      if (vmeth != nullptr) {
+        return vmeth;
       }
     }
     if (search == MethodSearch::Direct || search == MethodSearch::Static ||
         search == MethodSearch::Any) {
-      for (auto& dmeth : cls->get_dmethods()) {
-        if (match(name, proto, dmeth)) {
-          return dmeth;
-        }
+      auto* dmeth = cls->find_method(name, proto, /* is_virtual */ false);
+      if (dmeth != nullptr) {
+        return dmeth;
       }
     }
     // direct methods only look up the given class
@@ -123,24 +115,18 @@ DexField* resolve_field(const DexType* owner,
                         const DexString* name,
                         const DexType* type,
                         FieldSearch fs) {
-  auto field_eq = [&](const DexField* a) {
-    return a->get_name() == name && a->get_type() == type;
-  };
-
   const DexClass* cls = type_class(owner);
   while (cls) {
     if (fs == FieldSearch::Instance || fs == FieldSearch::Any) {
-      for (auto ifield : cls->get_ifields()) {
-        if (field_eq(ifield)) {
-          return ifield;
-        }
+      auto* ifield = cls->find_field(name, type, /* is_static */ false);
+      if (ifield != nullptr) {
+        return ifield;
       }
     }
     if (fs == FieldSearch::Static || fs == FieldSearch::Any) {
-      for (auto sfield : cls->get_sfields()) {
-        if (field_eq(sfield)) {
-          return sfield;
-        }
+      auto* sfield = cls->find_field(name, type, /* is_static */ true);
+      if (sfield != nullptr) {
+        return sfield;
       }
       // static final fields may be coming from interfaces so we
       // have to walk up the interface hierarchy too
@@ -180,3 +166,105 @@ DexMethod* find_top_intf_impl(const DexClass* cls,
   }
   return top_impl;
 }
+
+namespace {
+
+template <typename Ref, typename Search>
+struct ResolverCacheKey {
+  const Ref* ref;
+  Search search;
+  uint64_t generation;
+
+  bool operator==(const ResolverCacheKey& other) const {
+    return ref == other.ref && search == other.search &&
+           generation == other.generation;
+  }
+};
+
+template <typename Key>
+struct ResolverCacheKeyHash {
+  size_t operator()(const Key& key) const {
+    size_t seed = 0;
+    boost::hash_combine(seed, key.ref);
+    boost::hash_combine(seed, static_cast<int>(key.search));
+    boost::hash_combine(seed, key.generation);
+    return seed;
+  }
+};
+
+using MethodCacheKey = ResolverCacheKey<DexMethodRef, MethodSearch>;
+using FieldCacheKey = ResolverCacheKey<DexFieldRef, FieldSearch>;
+
+// Entries are never updated in place; a new generation gets new keys, which
+// keeps lookups lock-free.
+InsertOnlyConcurrentMap<MethodCacheKey,
+                        DexMethod*,
+                        ResolverCacheKeyHash<MethodCacheKey>>
+    s_method_cache;
+InsertOnlyConcurrentMap<FieldCacheKey,
+                        DexField*,
+                        ResolverCacheKeyHash<FieldCacheKey>>
+    s_field_cache;
+uint64_t s_cached_generation{0};
+
+std::atomic<size_t> s_hits{0};
+std::atomic<size_t> s_misses{0};
+
+template <typename Map, typename Key, typename ResolveFn>
+auto lookup_or_resolve(Map& map, const Key& key, const ResolveFn& resolve) {
+  auto* cached = map.get(key);
+  if (cached != nullptr) {
+    s_hits.fetch_add(1, std::memory_order_relaxed);
+    return *cached;
+  }
+  s_misses.fetch_add(1, std::memory_order_relaxed);
+  auto resolved = resolve();
+  map.emplace(key, resolved);
+  return resolved;
+}
+
+} // namespace
+
+namespace resolver_cache {
+
+Stats get_stats() {
+  return Stats{s_hits.load(std::memory_order_relaxed),
+               s_misses.load(std::memory_order_relaxed)};
+}
+
+void reset_stats() {
+  s_hits = 0;
+  s_misses = 0;
+}
+
+void drop_stale_entries() {
+  auto generation = RedexContext::hierarchy_generation();
+  if (generation != s_cached_generation) {
+    s_method_cache.clear();
+    s_field_cache.clear();
+    s_cached_generation = generation;
+  }
+}
+
+} // namespace resolver_cache
+
+DexMethod* resolve_method_cached(DexMethodRef* method,
+                                 MethodSearch search,
+                                 const DexMethod* caller) {
+  if (search == MethodSearch::Super || method->is_def()) {
+    return resolve_method(method, search, caller);
+  }
+  MethodCacheKey key{method, search, RedexContext::hierarchy_generation()};
+  return lookup_or_resolve(s_method_cache, key, [&]() {
+    return resolve_method(method, search, caller);
+  });
+}
+
+DexField* resolve_field_cached(const DexFieldRef* field, FieldSearch search) {
+  if (field->is_def()) {
+    return resolve_field(field, search);
+  }
+  FieldCacheKey key{field, search, RedexContext::hierarchy_generation()};
+  return lookup_or_resolve(s_field_cache, key,
+                           [&]() { return resolve_field(field, search); });
+}
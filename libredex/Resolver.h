@@ -375,6 +375,61 @@ inline DexField* resolve_field(const DexFieldRef* field,
                        search);
 }
 
+/**
+ * A process-wide, thread-safe cache of resolution results for refs that are
+ * not definitions, including failed resolutions.
+ *
+ * Entries are tagged with RedexContext::hierarchy_generation() at the time
+ * they were computed, and are ignored as soon as a class hierarchy or member
+ * list changed through the DexClass / RedexContext mutators. The PassManager
+ * also bumps the generation before every pass, so code that pokes at member
+ * vectors directly can only observe stale results within the same pass.
+ */
+namespace resolver_cache {
+
+struct Stats {
+  size_t hits{0};
+  size_t misses{0};
+};
+
+Stats get_stats();
+void reset_stats();
+
+// Drops entries of past generations. Not thread-safe; meant to be called
+// between passes.
+void drop_stale_entries();
+
+} // namespace resolver_cache
+
+/**
+ * Like resolve_method(method, search), but consults the resolver cache.
+ * MethodSearch::Super depends on the caller and is not cached.
+ */
+DexMethod* resolve_method_cached(DexMethodRef* method,
+                                 MethodSearch search,
+                                 const DexMethod* caller = nullptr);
+
+/**
+ * Like resolve_invoke_method(insn, caller), but consults the resolver cache.
+ */
+inline DexMethod* resolve_invoke_method_cached(
+    const IRInstruction* insn, const DexMethod* caller = nullptr) {
+  auto callee_ref = insn->get_method();
+  auto search = opcode_to_search(insn);
+  auto callee = resolve_method_cached(callee_ref, search, caller);
+  if (!callee && search == MethodSearch::Virtual) {
+    callee = resolve_method_cached(callee_ref, MethodSearch::InterfaceVirtual,
+                                   caller);
+  }
+  return callee;
+}
+
+/**
+ * Like resolve_field(field, search), but consults the resolver cache.
+ */
+DexField* resolve_field_cached(const DexFieldRef* field,
+                               FieldSearch search = FieldSearch::Any);
+
 struct ConcurrentMethodResolver {
   ConcurrentMethodRefCache concurrent_resolve_cache;
   DexMethod* operator()(DexMethodRef* method,
@@ -10,6 +10,7 @@
 #include "DebugUtils.h"
 #include "Pass.h"
 #include "PassManager.h"
+#include "RedexContext.h"
 #include "Show.h"
 #include "Trace.h"
 
@@ -53,6 +54,20 @@ class ScopedMemStats {
       TRACE(STATS, 1, "VmRSS for %s went from %s to %s (%s%s).", name,
             pretty_bytes(m_rss_before).c_str(), pretty_bytes(rss_after).c_str(),
             rss_delta_sign, pretty_bytes(rss_delta_abs).c_str());
+
+      if (g_redex != nullptr) {
+        for (const auto& arena : g_redex->get_arena_stats()) {
+          if (mgr != nullptr) {
+            mgr->set_metric(std::string("arena_") + arena.kind + "_allocated",
+                            arena.allocated);
+            mgr->set_metric(std::string("arena_") + arena.kind + "_used",
+                            arena.used);
+          }
+          TRACE(STATS, 1, "Arena %s after %s: %s used / %s allocated.",
+                arena.kind, name, pretty_bytes(arena.used).c_str(),
+                pretty_bytes(arena.allocated).c_str());
+        }
+      }
     }
   }
 
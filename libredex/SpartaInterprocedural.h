@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include <sparta/Analyzer.h>
 #include <sparta/MonotonicFixpointIterator.h>
 
@@ -55,15 +60,59 @@ class MethodSummaryRegistry : public sparta::AbstractRegistry {
  private:
   ConcurrentMap<const DexMethod*, Summary> m_map;
   bool m_has_update = false;
+  // Every change of a summary gets a new tick of `m_clock`, recorded as the
+  // version of the method; see IncrementalInterproceduralAnalyzer.
+  std::atomic<uint64_t> m_clock{0};
+  ConcurrentMap<const DexMethod*, uint64_t> m_versions;
+
+  static std::vector<const DexMethod*>*& read_recorder() {
+    thread_local std::vector<const DexMethod*>* recorder = nullptr;
+    return recorder;
+  }
+
+  void bump_version(const DexMethod* method) {
+    auto version = ++m_clock;
+    m_versions.update(method, [&](const DexMethod*, uint64_t& v, bool) {
+      v = version;
+    });
+  }
 
  public:
+  /*
+   * While alive, collects the methods whose summary is read through `get` on
+   * the current thread.
+   */
+  class ScopedReadRecorder {
+   public:
+    explicit ScopedReadRecorder(std::vector<const DexMethod*>* reads)
+        : m_previous(read_recorder()) {
+      read_recorder() = reads;
+    }
+    ~ScopedReadRecorder() { read_recorder() = m_previous; }
+
+   private:
+    std::vector<const DexMethod*>* m_previous;
+  };
+
   bool has_update() const override { return m_has_update; }
   void materialize_update() override { m_has_update = false; }
 
   Summary get(const DexMethod* method, Summary default_value) const {
+    if (auto* reads = read_recorder()) {
+      reads->push_back(method);
+    }
     return m_map.get(method, default_value);
   }
 
+  // The current tick of the clock. Summaries with a later version changed
+  // after this call.
+  uint64_t clock() const { return m_clock.load(); }
+
+  // The tick at which the summary of `method` last changed, 0 if never.
+  uint64_t version_of(const DexMethod* method) const {
+    return m_versions.get(method, 0);
+  }
+
   // returns true if the entry exists.
   bool update(const DexMethod* method,
               std::function<Summary(const Summary&)> updater) {
@@ -72,6 +121,7 @@ class MethodSummaryRegistry : public sparta::AbstractRegistry {
       entry_exists = exists;
       value = updater(value);
     });
+    bump_version(method);
     m_has_update = true; // benign race conditions as long as materialize_update
                          // is not called during update.
     return entry_exists;
@@ -87,6 +137,7 @@ class MethodSummaryRegistry : public sparta::AbstractRegistry {
                  });
 
     if (changed) {
+      bump_version(method);
       m_has_update = true; // benign race conditions as long as
                            // materialize_update is not called during update.
     }
@@ -98,4 +149,87 @@ class MethodSummaryRegistry : public sparta::AbstractRegistry {
   }
 };
 
+/*
+ * An InterproceduralAnalyzer that does not re-analyze a method whose inputs
+ * did not change. The inputs are its caller context and the summaries it read
+ * from the registry during its last analysis. When they are unchanged, the
+ * method's summary in the registry is still up to date, and only the caller
+ * context computed last time is replayed. On warm global iterations only the
+ * frontier of methods affected by changed summaries is analyzed again.
+ *
+ * Requirements on the analysis:
+ * - The Registry is a MethodSummaryRegistry, and an unchanged summary is not
+ *   reported as an update (use `maybe_update`, or `update` only on changes).
+ * - The FunctionAnalyzer only depends on its caller context and on the
+ *   summaries it reads through the registry.
+ * - A FunctionAnalyzer for a null method does nothing, as for the ghost
+ *   entry and exit nodes of the call graph.
+ */
+template <typename Analysis, typename AnalysisParameters = void>
+class IncrementalInterproceduralAnalyzer
+    : public sparta::InterproceduralAnalyzer<Analysis, AnalysisParameters> {
+  using Base = sparta::InterproceduralAnalyzer<Analysis, AnalysisParameters>;
+
+ public:
+  using Function = typename Base::Function;
+  using Registry = typename Base::Registry;
+  using CallGraph = typename Base::CallGraph;
+  using CallerContext = typename Base::CallerContext;
+  using FunctionAnalyzer = typename Base::FunctionAnalyzer;
+
+  using Base::Base;
+
+  std::shared_ptr<FunctionAnalyzer> run_on_function(
+      const Function& function,
+      Registry* reg,
+      CallerContext* context,
+      const CallGraph* graph) override {
+    if (function == nullptr) {
+      return Base::run_on_function(function, reg, context, graph);
+    }
+    if (auto entry = m_cache.get(function, nullptr);
+        entry != nullptr && entry->input.equals(*context) &&
+        std::all_of(entry->reads.begin(), entry->reads.end(),
+                    [&](const DexMethod* read) {
+                      return reg->version_of(read) <= entry->clock;
+                    })) {
+      *context = entry->output;
+      m_num_reused++;
+      return std::make_shared<FunctionAnalyzer>(nullptr);
+    }
+
+    auto entry = std::make_shared<CacheEntry>(*context, reg->clock());
+    std::shared_ptr<FunctionAnalyzer> analyzer;
+    {
+      typename Registry::ScopedReadRecorder recorder(&entry->reads);
+      analyzer = Base::run_on_function(function, reg, context, graph);
+    }
+    entry->output = *context;
+    m_cache.update(function,
+                   [&](const Function&, std::shared_ptr<CacheEntry>& value,
+                       bool) { value = std::move(entry); });
+    m_num_analyzed++;
+    return analyzer;
+  }
+
+  // Over all runs so far.
+  size_t num_analyzed() const { return m_num_analyzed; }
+  size_t num_reused() const { return m_num_reused; }
+
+ private:
+  struct CacheEntry {
+    CacheEntry(CallerContext input, uint64_t clock)
+        : input(std::move(input)), output(this->input), clock(clock) {}
+
+    CallerContext input;
+    CallerContext output;
+    uint64_t clock;
+    std::vector<const DexMethod*> reads;
+  };
+
+  ConcurrentMap<Function, std::shared_ptr<CacheEntry>> m_cache;
+  std::atomic<size_t> m_num_analyzed{0};
+  std::atomic<size_t> m_num_reused{0};
+};
+
 } // namespace sparta_interprocedural
@@ -7,6 +7,8 @@
 
 #include "ThreadPool.h"
 
+#include "ChromeTrace.h"
+
 namespace {
 
 redex_thread_pool::ThreadPool* s_threadpool{nullptr};
@@ -24,6 +26,17 @@ boost::thread ThreadPool::create_thread(std::function<void()> bound_f) {
   return boost::thread(attrs, std::move(bound_run));
 }
 
+void ThreadPool::run_async_bound(std::function<void()> bound_f) {
+  if (chrome_trace::is_enabled()) {
+    // This shows the per-thread activity of work queues.
+    bound_f = [f = std::move(bound_f)]() {
+      chrome_trace::ScopedSpan span("WorkQueue worker", "workqueue");
+      f();
+    };
+  }
+  sparta::ThreadPool<boost::thread>::run_async_bound(std::move(bound_f));
+}
+
 void ThreadPool::create() { s_threadpool = new ThreadPool(); }
 
 void ThreadPool::destroy() {
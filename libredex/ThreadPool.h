@@ -26,6 +26,8 @@ class ThreadPool : public sparta::ThreadPool<boost::thread> {
 
  protected:
   boost::thread create_thread(std::function<void()> bound_f) override;
+
+  void run_async_bound(std::function<void()> bound_f) override;
 };
 
 } // namespace redex_thread_pool
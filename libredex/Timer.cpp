@@ -11,7 +11,7 @@
 
 #include "Trace.h"
 
-unsigned Timer::s_indent = 0;
+std::atomic<unsigned> Timer::s_indent{0};
 std::mutex Timer::s_lock;
 Timer::times_t Timer::s_times;
 std::mutex AccumulatingTimer::s_lock;
@@ -24,6 +24,7 @@ Timer::Timer(const std::string& msg, bool indent)
   if (indent) {
     ++s_indent;
   }
+  chrome_trace::sample_rss();
 }
 
 Timer::~Timer() {
@@ -32,8 +33,10 @@ Timer::~Timer() {
   }
   auto end = std::chrono::high_resolution_clock::now();
   auto duration_s = std::chrono::duration<double>(end - m_start).count();
-  TRACE(TIME, 1, "%*s%s completed in %.1lf seconds", 4 * s_indent, "",
+  TRACE(TIME, 1, "%*s%s completed in %.1lf seconds", 4 * s_indent.load(), "",
         m_msg.c_str(), duration_s);
+  chrome_trace::add_span(m_msg, "timer", m_start, end);
+  chrome_trace::sample_rss();
 
   Timer::add_timer(std::move(m_msg), duration_s);
 }
@@ -43,7 +46,7 @@ void Timer::add_timer(std::string msg, double dur_s) {
   s_times.emplace_back(std::move(msg), dur_s);
 }
 
-AccumulatingTimer::AccumulatingTimer(std::string msg) {
+AccumulatingTimer::AccumulatingTimer(std::string msg) : m_msg(msg) {
   add_timer(std::move(msg), m_microseconds);
 }
 
@@ -16,6 +16,8 @@
 #include <utility>
 #include <vector>
 
+#include "ChromeTrace.h"
+
 struct Timer {
   explicit Timer(const std::string& msg, bool indent = true);
   ~Timer();
@@ -30,7 +32,8 @@ struct Timer {
  private:
   static std::mutex s_lock;
   static times_t s_times;
-  static unsigned s_indent;
+  // Timers may also run on background threads.
+  static std::atomic<unsigned> s_indent;
   std::string m_msg;
   std::chrono::high_resolution_clock::time_point m_start;
   bool m_indent;
@@ -50,6 +53,12 @@ class AccumulatingTimer {
       auto dur_in_mus =
           std::chrono::duration_cast<std::chrono::microseconds>(end - m_start);
       m_context->m_microseconds->fetch_add((uint64_t)dur_in_mus.count());
+      // Only record long scopes, as scopes might be very frequent.
+      if (chrome_trace::is_enabled() &&
+          dur_in_mus >= kMinChromeTraceDuration) {
+        chrome_trace::add_span(m_context->m_msg, "accumulating_timer", m_start,
+                               end);
+      }
     }
 
     // Disallow copying.
@@ -61,6 +70,8 @@ class AccumulatingTimer {
     AccumulatingTimerScope& operator=(AccumulatingTimerScope&&) = default;
 
    private:
+    static constexpr std::chrono::microseconds kMinChromeTraceDuration{1000};
+
     AccumulatingTimer* m_context;
     std::chrono::high_resolution_clock::time_point m_start;
   };
@@ -94,4 +105,5 @@ class AccumulatingTimer {
   static times_impl_t* s_times;
   std::shared_ptr<std::atomic<uint64_t>> m_microseconds{
       std::make_shared<std::atomic<uint64_t>>(0)};
+  std::string m_msg;
 };
@@ -7,6 +7,7 @@
 
 #include "Trace.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdarg>
 #include <cstdio>
@@ -14,6 +15,7 @@
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -44,6 +46,7 @@ struct Tracer {
     m_method_filter = getenv("TRACE_METHOD_FILTER");
     if (!traceenv) {
       init_trace_file(nullptr);
+      update_max_trace_level();
       return;
     }
 
@@ -73,6 +76,17 @@ struct Tracer {
 #define TM(x) m_module_id_name_map[static_cast<int>(x)] = #x;
     TMS
 #undef TM
+    update_max_trace_level();
+  }
+
+  void update_max_trace_level() {
+#ifndef NTRACE
+    long max_level = m_level;
+    for (auto level : m_traces) {
+      max_level = std::max(max_level, level);
+    }
+    trace_impl::g_max_trace_level = max_level;
+#endif
   }
 
   ~Tracer() {
@@ -205,9 +219,16 @@ static Tracer tracer;
 } // namespace
 
 #ifndef NTRACE
-bool traceEnabled(TraceModule module, int level) {
+namespace trace_impl {
+
+// Until the tracer is initialized, defer every check to it.
+long g_max_trace_level = std::numeric_limits<long>::max();
+
+bool trace_enabled_slow(TraceModule module, int level) {
   return tracer.traceEnabled(module, level);
 }
+
+} // namespace trace_impl
 #endif
 
 void trace(TraceModule module,
@@ -189,7 +189,18 @@ enum TraceModule : int {
 #ifdef NTRACE
 constexpr bool traceEnabled(TraceModule, int) { return false; }
 #else
-bool traceEnabled(TraceModule module, int level);
+namespace trace_impl {
+// The highest level enabled for any module. Levels above it are rejected
+// inline with a single comparison, which is the common case when tracing is
+// off; only the rest go through the out-of-line per-module check.
+extern long g_max_trace_level;
+bool trace_enabled_slow(TraceModule module, int level);
+} // namespace trace_impl
+
+inline bool traceEnabled(TraceModule module, int level) {
+  return level <= trace_impl::g_max_trace_level &&
+         trace_impl::trace_enabled_slow(module, level);
+}
 #endif // NTRACE
 
 void trace(TraceModule module,
@@ -624,8 +624,13 @@ void TypeInference::run(bool is_static,
       not_reached();
     }
   }
+  set_num_threads(ir_analyzer::fixpoint_num_threads(m_cfg));
   MonotonicFixpointIterator::run(init_state);
-  populate_type_environments();
+  if (m_on_demand) {
+    drop_non_join_states();
+  } else {
+    populate_type_environments();
+  }
 }
 
 // This method analyzes an instruction and updates the type environment
@@ -1603,4 +1608,67 @@ void TypeInference::populate_type_environments() {
   }
 }
 
+void TypeInference::drop_non_join_states() {
+  m_exit_states.clear();
+  m_insn_blocks.reserve(m_cfg.num_opcodes());
+  for (cfg::Block* block : m_cfg.blocks()) {
+    for (auto& mie : InstructionIterable(block)) {
+      m_insn_blocks.emplace(mie.insn, block);
+    }
+    // The entry state of a block with a single predecessor is the exit state
+    // of that predecessor. Unreachable (bottom) states are kept, and stored
+    // explicitly for blocks the fixpoint iteration never visited, so that
+    // replaying always ends at a stored state.
+    auto it = m_entry_states.find(block);
+    if (it == m_entry_states.end()) {
+      m_entry_states.emplace(block, TypeEnvironment::bottom());
+    } else if (block->preds().size() == 1 && block != m_cfg.entry_block() &&
+               !it->second.is_bottom()) {
+      m_entry_states.erase(it);
+    }
+  }
+}
+
+TypeEnvironment TypeInference::get_entry_state_on_demand(
+    cfg::Block* block) const {
+  std::vector<cfg::Edge*> chain;
+  TypeEnvironment state;
+  for (auto* b = block;; b = chain.back()->src()) {
+    if (b == m_last_entry_block) {
+      state = m_last_entry_state;
+      break;
+    }
+    auto it = m_entry_states.find(b);
+    if (it != m_entry_states.end()) {
+      state = it->second;
+      break;
+    }
+    always_assert(b->preds().size() == 1);
+    chain.push_back(b->preds().front());
+  }
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    analyze_node((*it)->src(), &state);
+    state = analyze_edge(*it, state);
+  }
+  m_last_entry_block = block;
+  m_last_entry_state = state;
+  return state;
+}
+
+TypeEnvironment TypeInference::get_type_environment(
+    const IRInstruction* insn) const {
+  if (!m_on_demand) {
+    return m_type_envs.at(insn);
+  }
+  auto* block = m_insn_blocks.at(insn);
+  auto state = get_entry_state_on_demand(block);
+  for (auto& mie : InstructionIterable(block)) {
+    if (mie.insn == insn) {
+      break;
+    }
+    analyze_instruction(mie.insn, &state, block);
+  }
+  return state;
+}
+
 } // namespace type_inference
@@ -327,11 +327,33 @@ class TypeInference final
 
   std::unordered_set<DexType*> get_annotations() const { return m_annotations; }
 
+  // Selects a bounded-memory mode for callers that only query the types at a
+  // few instructions; must be called before `run`. Instead of populating the
+  // type environment at every instruction, `run` then only keeps the entry
+  // states of the entry block and of join points (blocks with more than one
+  // predecessor), and `get_type_environment` replays the analysis forward
+  // from the nearest stored state. In this mode, `get_type_environments` is
+  // empty and `get_{entry,exit}_state_at` must not be used, and queries are
+  // not thread-safe.
+  void set_on_demand_type_environments() { m_on_demand = true; }
+
+  // The type environment right before `insn`, in either mode.
+  TypeEnvironment get_type_environment(const IRInstruction* insn) const;
+
  private:
   void populate_type_environments();
+  void drop_non_join_states();
+  TypeEnvironment get_entry_state_on_demand(cfg::Block* block) const;
 
   const cfg::ControlFlowGraph& m_cfg;
   std::unordered_map<const IRInstruction*, TypeEnvironment> m_type_envs;
+  bool m_on_demand{false};
+  // Only populated in on-demand mode.
+  std::unordered_map<const IRInstruction*, cfg::Block*> m_insn_blocks;
+  // The last entry state recomputed on demand; consecutive queries usually
+  // walk down the same chain of blocks.
+  mutable cfg::Block* m_last_entry_block{nullptr};
+  mutable TypeEnvironment m_last_entry_state;
   const bool m_skip_check_cast_upcasting;
   const std::unordered_set<DexType*> m_annotations;
   const method_override_graph::Graph* m_method_override_graph;
@@ -7,6 +7,8 @@
 
 #include "TypeSystem.h"
 
+#include <algorithm>
+
 #include "DexUtil.h"
 #include "RedexContext.h"
 #include "Resolver.h"
@@ -187,6 +189,85 @@ void TypeSystem::make_instanceof_interfaces_table() {
   for (const auto& root : no_parents) {
     make_interfaces_table(root);
   }
+  make_intervals(no_parents);
+  make_implementor_intervals();
+}
+
+void TypeSystem::make_intervals(const TypeVector& roots) {
+  const auto& hierarchy = m_class_scopes.get_class_hierarchy();
+  // (type, whether its children were pushed already)
+  std::vector<std::pair<const DexType*, bool>> stack;
+  for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+    stack.emplace_back(*it, false);
+  }
+  while (!stack.empty()) {
+    auto& [type, expanded] = stack.back();
+    if (expanded) {
+      m_intervals.at(type).end = m_preorder.size();
+      stack.pop_back();
+      continue;
+    }
+    if (m_intervals.count(type)) {
+      stack.pop_back();
+      continue;
+    }
+    expanded = true;
+    uint32_t index = m_preorder.size();
+    m_intervals.emplace(type, Interval{index, index + 1});
+    m_preorder.push_back(type);
+    auto children = hierarchy.find(type);
+    if (children == hierarchy.end()) {
+      continue;
+    }
+    // `type` and `expanded` are invalidated by the pushes below.
+    for (auto it = children->second.rbegin(); it != children->second.rend();
+         ++it) {
+      stack.emplace_back(*it, false);
+    }
+  }
+}
+
+void TypeSystem::make_implementor_intervals() {
+  for (const auto& [intf, implementors] :
+       m_class_scopes.get_interface_map()) {
+    std::vector<uint32_t> indices;
+    indices.reserve(implementors.size());
+    for (const auto* type : implementors) {
+      const auto* interval = get_interval(type);
+      if (interval != nullptr) {
+        indices.push_back(interval->begin);
+      }
+    }
+    std::sort(indices.begin(), indices.end());
+    auto& intervals = m_implementor_intervals[intf];
+    for (auto index : indices) {
+      if (!intervals.empty() && intervals.back().end == index) {
+        intervals.back().end++;
+      } else {
+        intervals.push_back(Interval{index, index + 1});
+      }
+    }
+  }
+}
+
+bool TypeSystem::implements(const DexType* cls, const DexType* intf) const {
+  const auto* interval = get_interval(cls);
+  if (interval == nullptr) {
+    const auto& implementors = m_class_scopes.get_interface_map().find(intf);
+    if (implementors == m_class_scopes.get_interface_map().end()) return false;
+    return implementors->second.count(cls) > 0;
+  }
+  auto it = m_implementor_intervals.find(intf);
+  if (it == m_implementor_intervals.end()) {
+    return false;
+  }
+  const auto& intervals = it->second;
+  auto index = interval->begin;
+  // The first interval that ends after `index`.
+  auto pos = std::upper_bound(
+      intervals.begin(), intervals.end(), index,
+      [](uint32_t i, const Interval& interval) { return i < interval.end; });
+  return pos != intervals.end() && pos->begin <= index;
 }
 
 void TypeSystem::make_interfaces_table(const DexType* type) {
@@ -31,6 +31,27 @@ using namespace virt_scope;
  * MethodOverrideGraph over the VirtualScopes used here; the former is faster.
  */
 class TypeSystem {
+ public:
+  // A half-open range of positions in the pre-order numbering of the class
+  // hierarchy.
+  struct Interval {
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  struct TypeRange {
+    using value_type = const DexType*;
+    using const_iterator = TypeVector::const_iterator;
+
+    TypeVector::const_iterator first;
+    TypeVector::const_iterator last;
+
+    TypeVector::const_iterator begin() const { return first; }
+    TypeVector::const_iterator end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+  };
+
  private:
   static const TypeSet empty_set;
   static const TypeVector empty_vec;
@@ -40,6 +61,20 @@ class TypeSystem {
   InstanceOfTable m_instanceof_table;
   TypeToTypeSet m_interfaces;
 
+  // All classes in a pre-order walk of the class hierarchy, so that the
+  // subtree of a type is the contiguous range given by its interval.
+  TypeVector m_preorder;
+  std::unordered_map<const DexType*, Interval> m_intervals;
+  // The implementors of each interface, as sorted, disjoint intervals. Since
+  // whole subtrees implement an interface, these are usually few.
+  std::unordered_map<const DexType*, std::vector<Interval>>
+      m_implementor_intervals;
+
+  const Interval* get_interval(const DexType* type) const {
+    auto it = m_intervals.find(type);
+    return it == m_intervals.end() ? nullptr : &it->second;
+  }
+
  public:
   explicit TypeSystem(const Scope& scope);
 
@@ -59,8 +94,26 @@ class TypeSystem {
    * The type must be a class (not an interface).
    */
   void get_all_children(const DexType* type, TypeSet& children) const {
-    return ::get_all_children(
-        m_class_scopes.get_class_hierarchy(), type, children);
+    if (get_interval(type) == nullptr) {
+      return ::get_all_children(m_class_scopes.get_class_hierarchy(), type,
+                                children);
+    }
+    auto range = get_all_children_range(type);
+    children.insert(range.begin(), range.end());
+  }
+
+  /**
+   * Get all the children of a given type, excluding the type itself, as a
+   * slice of the pre-order walk of the class hierarchy. The range is empty
+   * for types not in the hierarchy.
+   */
+  TypeRange get_all_children_range(const DexType* type) const {
+    const auto* interval = get_interval(type);
+    if (interval == nullptr) {
+      return {m_preorder.end(), m_preorder.end()};
+    }
+    return {m_preorder.begin() + interval->begin + 1,
+            m_preorder.begin() + interval->end};
   }
 
   /**
@@ -107,16 +160,13 @@ class TypeSystem {
    * The type must be a class (not an interface).
    */
   bool is_subtype(const DexType* parent, const DexType* child) const {
-    const auto& parent_it = m_instanceof_table.find(parent);
-    const auto& child_it = m_instanceof_table.find(child);
-    if (parent_it == m_instanceof_table.end() ||
-        child_it == m_instanceof_table.end()) {
+    const auto* parent_interval = get_interval(parent);
+    const auto* child_interval = get_interval(child);
+    if (parent_interval == nullptr || child_interval == nullptr) {
       return false;
     }
-    const auto& p_chain = parent_it->second;
-    const auto& c_chain = child_it->second;
-    if (p_chain.size() > c_chain.size()) return false;
-    return c_chain.at(p_chain.size() - 1) == parent;
+    return parent_interval->begin <= child_interval->begin &&
+           child_interval->begin < parent_interval->end;
   }
 
   /**
@@ -124,11 +174,7 @@ class TypeSystem {
    * The interface may be implemented via some parent of the class
    * or an interface DAG.
    */
-  bool implements(const DexType* cls, const DexType* intf) const {
-    const auto& implementors = m_class_scopes.get_interface_map().find(intf);
-    if (implementors == m_class_scopes.get_interface_map().end()) return false;
-    return implementors->second.count(cls) > 0;
-  }
+  bool implements(const DexType* cls, const DexType* intf) const;
 
   /**
    * Return all classes that implement an interface.
@@ -224,4 +270,6 @@ class TypeSystem {
  private:
   void make_instanceof_interfaces_table();
   void make_interfaces_table(const DexType* type);
+  void make_intervals(const TypeVector& roots);
+  void make_implementor_intervals();
 };
@@ -9,6 +9,7 @@
 
 #include "DexUtil.h"
 #include "Lazy.h"
+#include "MethodUtil.h"
 #include "RedexContext.h"
 #include "Show.h"
 #include "Trace.h"
@@ -22,6 +23,15 @@ namespace type {
 WELL_KNOWN_TYPES
 #undef FOR_EACH
 
+#define DEFINE_CACHED_OPTIONAL_TYPE(func_name, _)                 \
+  DexType* func_name() {                                          \
+    return g_redex->pointers_cache().optional_type_##func_name(); \
+  }
+
+#define FOR_EACH DEFINE_CACHED_OPTIONAL_TYPE
+OPTIONAL_WELL_KNOWN_TYPES
+#undef FOR_EACH
+
 namespace pseudo {
 
 #define DEFINE_CACHED_PSEUDO_TYPE(func_name, _)           \
@@ -375,42 +385,42 @@ DexType* get_boxed_reference_type(const DexType* type) {
 // Takes a reference type, returns its corresponding unboxing method
 DexMethodRef* get_unboxing_method_for_type(const DexType* type) {
   if (type == type::java_lang_Boolean()) {
-    return DexMethod::make_method("Ljava/lang/Boolean;.booleanValue:()Z");
+    return method::java_lang_Boolean_booleanValue();
   } else if (type == type::java_lang_Byte()) {
-    return DexMethod::make_method("Ljava/lang/Byte;.byteValue:()B");
+    return method::java_lang_Byte_byteValue();
   } else if (type == type::java_lang_Short()) {
-    return DexMethod::make_method("Ljava/lang/Short;.shortValue:()S");
+    return method::java_lang_Short_shortValue();
   } else if (type == type::java_lang_Character()) {
-    return DexMethod::make_method("Ljava/lang/Character;.charValue:()C");
+    return method::java_lang_Character_charValue();
   } else if (type == type::java_lang_Integer()) {
-    return DexMethod::make_method("Ljava/lang/Integer;.intValue:()I");
+    return method::java_lang_Integer_intValue();
   } else if (type == type::java_lang_Long()) {
-    return DexMethod::make_method("Ljava/lang/Long;.longValue:()J");
+    return method::java_lang_Long_longValue();
   } else if (type == type::java_lang_Float()) {
-    return DexMethod::make_method("Ljava/lang/Float;.floatValue:()F");
+    return method::java_lang_Float_floatValue();
   } else if (type == type::java_lang_Double()) {
-    return DexMethod::make_method("Ljava/lang/Double;.doubleValue:()D");
+    return method::java_lang_Double_doubleValue();
   }
   return nullptr;
 }
 
 DexMethodRef* get_Number_unboxing_method_for_type(const DexType* type) {
   if (type == type::java_lang_Boolean()) {
-    return DexMethod::make_method("Ljava/lang/Number;.booleanValue:()Z");
+    return method::java_lang_Number_booleanValue();
   } else if (type == type::java_lang_Byte()) {
-    return DexMethod::make_method("Ljava/lang/Number;.byteValue:()B");
+    return method::java_lang_Number_byteValue();
   } else if (type == type::java_lang_Short()) {
-    return DexMethod::make_method("Ljava/lang/Number;.shortValue:()S");
+    return method::java_lang_Number_shortValue();
   } else if (type == type::java_lang_Character()) {
-    return DexMethod::make_method("Ljava/lang/Number;.charValue:()C");
+    return method::java_lang_Number_charValue();
   } else if (type == type::java_lang_Integer()) {
-    return DexMethod::make_method("Ljava/lang/Number;.intValue:()I");
+    return method::java_lang_Number_intValue();
   } else if (type == type::java_lang_Long()) {
-    return DexMethod::make_method("Ljava/lang/Number;.longValue:()J");
+    return method::java_lang_Number_longValue();
   } else if (type == type::java_lang_Float()) {
-    return DexMethod::make_method("Ljava/lang/Number;.floatValue:()F");
+    return method::java_lang_Number_floatValue();
   } else if (type == type::java_lang_Double()) {
-    return DexMethod::make_method("Ljava/lang/Number;.doubleValue:()D");
+    return method::java_lang_Number_doubleValue();
   }
   return nullptr;
 }
@@ -529,11 +539,8 @@ boost::optional<int32_t> evaluate_type_check(const DexType* src_type,
 }
 
 bool is_kotlin_lambda(const DexClass* cls) {
-  DexType* kotlin_type = DexType::make_type("Lkotlin/jvm/internal/Lambda;");
-  if (cls->get_super_class() == kotlin_type) {
-    return true;
-  }
-  return false;
+  DexType* kotlin_type = type::kotlin_jvm_internal_Lambda();
+  return kotlin_type != nullptr && cls->get_super_class() == kotlin_type;
 }
 
 bool is_kotlin_non_capturing_lambda(const DexClass* cls) {
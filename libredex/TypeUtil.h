@@ -38,6 +38,14 @@ WELL_KNOWN_TYPES
 #undef FOR_EACH
 #undef DECLARE_TYPE
 
+// These return nullptr if the type does not exist.
+#define DECLARE_OPTIONAL_TYPE(name, _) DexType* name();
+
+#define FOR_EACH DECLARE_OPTIONAL_TYPE
+OPTIONAL_WELL_KNOWN_TYPES
+#undef FOR_EACH
+#undef DECLARE_OPTIONAL_TYPE
+
 namespace pseudo {
 #define DECLARE_PSEUDO_TYPE_FIELD(name, _) DexFieldRef* name();
 
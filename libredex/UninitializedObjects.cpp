@@ -13,9 +13,6 @@
 
 namespace {
 
-using namespace uninitialized_objects;
-using namespace ir_analyzer;
-
 const IRInstruction* get_first_load_param(const cfg::ControlFlowGraph& cfg) {
   const auto param_insns = InstructionIterable(cfg.get_param_instructions());
   auto& mie = *param_insns.begin();
@@ -24,6 +21,13 @@ const IRInstruction* get_first_load_param(const cfg::ControlFlowGraph& cfg) {
   return insn;
 }
 
+} // namespace
+
+namespace uninitialized_objects {
+namespace impl {
+
+using namespace ir_analyzer;
+
 class Analyzer final : public BaseIRAnalyzer<UninitializedObjectEnvironment> {
  public:
   explicit Analyzer(DexMethod* method)
@@ -57,13 +61,12 @@ class Analyzer final : public BaseIRAnalyzer<UninitializedObjectEnvironment> {
  private:
   const IRInstruction* m_init_first_load_param;
 };
-} // namespace
 
-namespace uninitialized_objects {
+} // namespace impl
 
 UninitializedObjectEnvironments get_uninitialized_object_environments(
     DexMethod* method) {
-  Analyzer fp_iter(method);
+  impl::Analyzer fp_iter(method);
   fp_iter.run({});
   UninitializedObjectEnvironments res;
   for (cfg::Block* block : method->get_code()->cfg().blocks()) {
@@ -76,4 +79,34 @@ UninitializedObjectEnvironments get_uninitialized_object_environments(
   return res;
 }
 
+UninitializedObjectsAnalysis::UninitializedObjectsAnalysis(DexMethod* method)
+    : m_cfg(method->get_code()->cfg()),
+      m_analyzer(std::make_unique<impl::Analyzer>(method)) {
+  m_analyzer->run({});
+}
+
+UninitializedObjectsAnalysis::~UninitializedObjectsAnalysis() = default;
+
+const UninitializedObjectEnvironment&
+UninitializedObjectsAnalysis::get_environment_at(const IRInstruction* insn) {
+  auto it = m_environments.find(insn);
+  if (it != m_environments.end()) {
+    return it->second;
+  }
+  if (m_blocks.empty()) {
+    for (cfg::Block* block : m_cfg.blocks()) {
+      for (const auto& mie : InstructionIterable(block)) {
+        m_blocks.emplace(mie.insn, block);
+      }
+    }
+  }
+  auto* block = m_blocks.at(insn);
+  auto env = m_analyzer->get_entry_state_at(block);
+  for (const auto& mie : InstructionIterable(block)) {
+    m_environments.emplace(mie.insn, env);
+    m_analyzer->analyze_instruction(mie.insn, &env);
+  }
+  return m_environments.at(insn);
+}
+
 } // namespace uninitialized_objects
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 
 #include <sparta/ConstantAbstractDomain.h>
@@ -15,6 +16,11 @@
 #include "DexClass.h"
 #include "IRInstruction.h"
 
+namespace cfg {
+class Block;
+class ControlFlowGraph;
+} // namespace cfg
+
 namespace uninitialized_objects {
 
 using UninitializedObjectDomain = sparta::ConstantAbstractDomain<bool>;
@@ -33,4 +39,29 @@ using UninitializedObjectEnvironments =
 UninitializedObjectEnvironments get_uninitialized_object_environments(
     DexMethod* method);
 
+namespace impl {
+class Analyzer;
+} // namespace impl
+
+// Runs the analysis once, and then answers queries for individual
+// instructions. The environments of the instructions of a block are only
+// materialized when an instruction of that block is first queried, which is
+// much cheaper than get_uninitialized_object_environments when only a few
+// instructions are of interest. Not thread-safe.
+class UninitializedObjectsAnalysis {
+ public:
+  explicit UninitializedObjectsAnalysis(DexMethod* method);
+  ~UninitializedObjectsAnalysis();
+
+  // The environment before the given instruction of the method's cfg.
+  const UninitializedObjectEnvironment& get_environment_at(
+      const IRInstruction* insn);
+
+ private:
+  const cfg::ControlFlowGraph& m_cfg;
+  std::unique_ptr<impl::Analyzer> m_analyzer;
+  std::unordered_map<const IRInstruction*, cfg::Block*> m_blocks;
+  UninitializedObjectEnvironments m_environments;
+};
+
 } // namespace uninitialized_objects
@@ -8,6 +8,7 @@
 #include "VirtualScope.h"
 
 #include <map>
+#include <numeric>
 #include <set>
 
 #include "Creators.h"
@@ -17,6 +18,7 @@
 #include "Show.h"
 #include "Timer.h"
 #include "Trace.h"
+#include "WorkQueue.h"
 
 namespace {
 
@@ -650,10 +652,15 @@ void load_methods(const DexType* type, SignatureMap& sig_map) {
  * in this case, not knowing interface I, we mark all methods in A, B and C
  * ESCAPED but methods in D are not, so in this case they are just FINAL and
  * effectively D.k() would be non virtual as opposed to C.k() which is ESCAPED.
+ *
+ * The subtrees of the children are independent of each other. With
+ * `parallel_children`, they are built concurrently and then merged in the
+ * same order as the serial walk, so the result is the same either way.
  */
 bool build_signature_map(const ClassHierarchy& hierarchy,
                          const DexType* type,
-                         SignatureMap& sig_map) {
+                         SignatureMap& sig_map,
+                         bool parallel_children = false) {
   always_assert_log(sig_map.empty(),
                     "intf_methods and children_methods are out params");
   const TypeSet& children = hierarchy.at(type);
@@ -669,16 +676,41 @@ bool build_signature_map(const ClassHierarchy& hierarchy,
   // recurse through every child to collect all methods
   // and interface methods under type
   bool escape_up = false;
-  for (const auto& child : children) {
-    SignatureMap child_sig_map;
-    escape_up =
-        build_signature_map(hierarchy, child, child_sig_map) || escape_up;
-    TRACE(VIRT,
-          3,
-          "* Merging sig map of %s with child %s",
-          SHOW(type),
-          SHOW(child));
-    merge(base_sigs, intf_sig_map, sig_map, child_sig_map);
+  if (parallel_children && children.size() > 1) {
+    std::vector<const DexType*> ordered_children(children.begin(),
+                                                 children.end());
+    std::vector<SignatureMap> child_sig_maps(ordered_children.size());
+    std::vector<uint8_t> child_escapes(ordered_children.size(), 0);
+    std::vector<size_t> indices(ordered_children.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    workqueue_run<size_t>(
+        [&](size_t i) {
+          child_escapes[i] = build_signature_map(hierarchy, ordered_children[i],
+                                                 child_sig_maps[i]);
+        },
+        indices);
+    for (size_t i = 0; i < ordered_children.size(); ++i) {
+      escape_up = child_escapes[i] || escape_up;
+      TRACE(VIRT,
+            3,
+            "* Merging sig map of %s with child %s",
+            SHOW(type),
+            SHOW(ordered_children[i]));
+      merge(base_sigs, intf_sig_map, sig_map, child_sig_maps[i]);
+      child_sig_maps[i].clear();
+    }
+  } else {
+    for (const auto& child : children) {
+      SignatureMap child_sig_map;
+      escape_up =
+          build_signature_map(hierarchy, child, child_sig_map) || escape_up;
+      TRACE(VIRT,
+            3,
+            "* Merging sig map of %s with child %s",
+            SHOW(type),
+            SHOW(child));
+      merge(base_sigs, intf_sig_map, sig_map, child_sig_map);
+    }
   }
 
   TRACE(VIRT, 3, "* Marking methods at %s", SHOW(type));
@@ -777,7 +809,10 @@ void get_root_scopes(const SignatureMap& sig_map,
 
 SignatureMap build_signature_map(const ClassHierarchy& class_hierarchy) {
   SignatureMap signature_map;
-  build_signature_map(class_hierarchy, type::java_lang_Object(), signature_map);
+  // Make sure the class for Object exists before walking concurrently.
+  get_vmethods(type::java_lang_Object());
+  build_signature_map(class_hierarchy, type::java_lang_Object(), signature_map,
+                      /* parallel_children */ true);
   return signature_map;
 }
 
@@ -868,14 +903,40 @@ const ClassHierarchy& ClassScopes::get_parent_to_children() const {
  * for the entire system as redex knows it.
  */
 void ClassScopes::build_class_scopes(const DexType* type) {
-  auto cls = type_class(type);
-  always_assert(cls != nullptr || type == type::java_lang_Object());
-  get_root_scopes(m_sig_map, type, m_scopes);
+  std::vector<const DexType*> types;
+  std::vector<const DexType*> stack{type};
+  while (!stack.empty()) {
+    auto current = stack.back();
+    stack.pop_back();
+    types.push_back(current);
+    const auto& children_it = m_hierarchy.find(current);
+    if (children_it != m_hierarchy.end()) {
+      stack.insert(stack.end(), children_it->second.begin(),
+                   children_it->second.end());
+    }
+  }
 
-  const auto& children_it = m_hierarchy.find(type);
-  if (children_it != m_hierarchy.end()) {
-    for (const auto& child : children_it->second) {
-      build_class_scopes(child);
+  // The scopes rooted at a type only depend on the (complete) signature map,
+  // so all types can be handled concurrently.
+  std::vector<std::vector<const VirtualScope*>> type_scopes(types.size());
+  std::vector<size_t> indices(types.size());
+  std::iota(indices.begin(), indices.end(), 0);
+  workqueue_run<size_t>(
+      [&](size_t i) {
+        auto current = types[i];
+        auto cls = type_class(current);
+        always_assert(cls != nullptr || current == type::java_lang_Object());
+        Scopes cls_scopes;
+        get_root_scopes(m_sig_map, current, cls_scopes);
+        auto it = cls_scopes.find(current);
+        if (it != cls_scopes.end()) {
+          type_scopes[i] = std::move(it->second);
+        }
+      },
+      indices);
+  for (size_t i = 0; i < types.size(); ++i) {
+    if (!type_scopes[i].empty()) {
+      m_scopes[types[i]] = std::move(type_scopes[i]);
     }
   }
 }
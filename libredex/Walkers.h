@@ -8,8 +8,11 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "ControlFlow.h"
@@ -423,7 +426,7 @@ class walk {
         Classes const& classes,
         const WalkerFn& walker,
         size_t num_threads = redex_parallel::default_num_threads()) {
-      workqueue_run<DexClass*>( // over-parallelized maybe
+      run_weighted_by_code(
           [&walker](DexClass* cls) { walker(cls); },
           classes,
           num_threads);
@@ -440,7 +443,7 @@ class walk {
         Accumulator init = Accumulator()) {
       std::vector<CacheAligned<Accumulator>> acc_vec(num_threads, init);
       auto reduce = Reduce();
-      workqueue_run<DexClass*>( // over-parallelized maybe
+      run_weighted_by_code(
           [&walker, &acc_vec, &reduce](sparta::WorkerState<DexClass*>* state,
                                        DexClass* cls) {
             Accumulator& acc = acc_vec[state->worker_id()];
@@ -461,7 +464,7 @@ class walk {
         const Classes& classes,
         const WalkerFn& walker,
         size_t num_threads = redex_parallel::default_num_threads()) {
-      workqueue_run<DexClass*>(
+      run_weighted_by_code(
           [&walker](DexClass* cls) { walk::iterate_methods(cls, walker); },
           classes,
           num_threads);
@@ -487,7 +490,7 @@ class walk {
         Accumulator init = Accumulator()) {
       std::vector<CacheAligned<Accumulator>> acc_vec(num_threads, init);
 
-      workqueue_run<DexClass*>(
+      run_weighted_by_code(
           [&](sparta::WorkerState<DexClass*>* state, DexClass* cls) {
             Accumulator& acc = acc_vec[state->worker_id()];
             for (auto dmethod : cls->get_dmethods()) {
@@ -587,7 +590,7 @@ class walk {
         const FilterFn& filter,
         const WalkerFn& walker,
         size_t num_threads = redex_parallel::default_num_threads()) {
-      workqueue_run<DexClass*>(
+      run_weighted_by_code(
           [&filter, &walker](DexClass* cls) {
             walk::iterate_code(cls, filter, walker);
           },
@@ -614,7 +617,7 @@ class walk {
         const FilterFn& filter,
         const WalkerFn& walker,
         size_t num_threads = redex_parallel::default_num_threads()) {
-      workqueue_run<DexClass*>(
+      run_weighted_by_code(
           [&filter, &walker](DexClass* cls) {
             walk::iterate_opcodes(cls, filter, walker);
           },
@@ -657,7 +660,7 @@ class walk {
         const Predicate& predicate,
         const Walker& walker,
         size_t num_threads = redex_parallel::default_num_threads()) {
-      workqueue_run<DexClass*>(
+      run_weighted_by_code(
           [&predicate, &walker](DexClass* cls) {
             walk::iterate_matching(cls, predicate, walker);
           },
@@ -680,7 +683,7 @@ class walk {
         const Predicate& predicate,
         const WalkerFn& walker,
         size_t num_threads = redex_parallel::default_num_threads()) {
-      workqueue_run<DexClass*>(
+      run_weighted_by_code(
           [&predicate, &walker](DexClass* cls) {
             walk::iterate_matching_block(cls, predicate, walker);
           },
@@ -698,5 +701,93 @@ class walk {
       workqueue_run<const virt_scope::VirtualScope*>(
           walker, virtual_scopes, num_threads);
     }
+
+    // Statistics about the walks that schedule classes by their code size,
+    // accumulated until the next `reset()`.
+    struct Stats {
+      std::atomic<size_t> walks{0};
+      // Time during which some threads were already idle, at the end of walks.
+      std::atomic<uint64_t> total_tail_us{0};
+      std::atomic<uint64_t> max_tail_us{0};
+      // Methods of the classes visited by those walks.
+      std::atomic<size_t> methods{0};
+
+      void reset() {
+        walks = 0;
+        total_tail_us = 0;
+        max_tail_us = 0;
+        methods = 0;
+      }
+    };
+
+    static Stats& stats() {
+      static Stats s_stats;
+      return s_stats;
+    }
+
+   private:
+    // Estimates the cost of walking the code of all methods of a class.
+    static uint64_t code_cost(const DexClass* cls) {
+      uint64_t cost = 1;
+      for (auto* methods : {&cls->get_dmethods(), &cls->get_vmethods()}) {
+        for (auto* method : *methods) {
+          auto* code = method->get_code();
+          if (code != nullptr) {
+            cost += code->estimate_size_quickly();
+          }
+        }
+      }
+      return cost;
+    }
+
+    // Like `workqueue_run`, but schedules the classes with the most code first,
+    // so that a few huge methods don't keep a single thread busy at the end.
+    // With a concurrent cost budget, classes are only started while their
+    // summed code size stays within it.
+    template <class Classes, typename Fn>
+    static void run_weighted_by_code(const Fn& fn,
+                                     const Classes& classes,
+                                     size_t num_threads) {
+      if (redex_parallel::get_concurrent_cost_budget() != 0) {
+        auto budgeted_fn = [&fn](sparta::WorkerState<DexClass*>* state,
+                                 DexClass* cls) {
+          redex_parallel::ScopedCostBudget budget(code_cost(cls));
+          if constexpr (std::is_invocable_v<const Fn&, DexClass*>) {
+            fn(cls);
+          } else {
+            fn(state, cls);
+          }
+        };
+        run_weighted_by_code_impl(budgeted_fn, classes, num_threads);
+        return;
+      }
+      run_weighted_by_code_impl(fn, classes, num_threads);
+    }
+
+    template <class Classes, typename Fn>
+    static void run_weighted_by_code_impl(const Fn& fn,
+                                          const Classes& classes,
+                                          size_t num_threads) {
+      auto wq = workqueue_foreach<DexClass*>(fn, num_threads);
+      size_t methods = 0;
+      for (DexClass* cls : classes) {
+        wq.add_weighted_item(cls, code_cost(cls));
+        methods += cls->get_dmethods().size() + cls->get_vmethods().size();
+      }
+      wq.run_all();
+
+      uint64_t tail_us =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              wq.last_run_tail())
+              .count();
+      auto& s = stats();
+      s.walks.fetch_add(1, std::memory_order_relaxed);
+      s.methods.fetch_add(methods, std::memory_order_relaxed);
+      s.total_tail_us.fetch_add(tail_us, std::memory_order_relaxed);
+      auto max = s.max_tail_us.load(std::memory_order_relaxed);
+      while (tail_us > max &&
+             !s.max_tail_us.compare_exchange_weak(max, tail_us)) {
+      }
+    }
   };
 };
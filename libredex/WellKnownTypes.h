@@ -33,6 +33,8 @@
   FOR_EACH(java_lang_Float, "Ljava/lang/Float;")                         \
   FOR_EACH(java_lang_Double, "Ljava/lang/Double;")                       \
   FOR_EACH(java_lang_RuntimeException, "Ljava/lang/RuntimeException;")   \
+  FOR_EACH(java_lang_NullPointerException,                               \
+           "Ljava/lang/NullPointerException;")                           \
   FOR_EACH(dalvik_annotation_Signature, "Ldalvik/annotation/Signature;") \
   FOR_EACH(dalvik_annotation_MemberClasses,                              \
            "Ldalvik/annotation/"                                         \
@@ -75,4 +77,63 @@
            "[Ljava/lang/Object;.clone:()Ljava/lang/Object;")                  \
   FOR_EACH(java_lang_Class_forName,                                           \
            "Ljava/lang/Class;.forName:(Ljava/lang/String;)Ljava/"             \
-           "lang/Class;")
+           "lang/Class;")                                                     \
+  FOR_EACH(java_lang_Boolean_booleanValue,                                    \
+           "Ljava/lang/Boolean;.booleanValue:()Z")                            \
+  FOR_EACH(java_lang_Byte_byteValue, "Ljava/lang/Byte;.byteValue:()B")        \
+  FOR_EACH(java_lang_Short_shortValue, "Ljava/lang/Short;.shortValue:()S")    \
+  FOR_EACH(java_lang_Character_charValue,                                     \
+           "Ljava/lang/Character;.charValue:()C")                             \
+  FOR_EACH(java_lang_Long_longValue, "Ljava/lang/Long;.longValue:()J")        \
+  FOR_EACH(java_lang_Float_floatValue, "Ljava/lang/Float;.floatValue:()F")    \
+  FOR_EACH(java_lang_Double_doubleValue,                                      \
+           "Ljava/lang/Double;.doubleValue:()D")                              \
+  FOR_EACH(java_lang_Number_booleanValue,                                     \
+           "Ljava/lang/Number;.booleanValue:()Z")                             \
+  FOR_EACH(java_lang_Number_byteValue, "Ljava/lang/Number;.byteValue:()B")    \
+  FOR_EACH(java_lang_Number_shortValue, "Ljava/lang/Number;.shortValue:()S")  \
+  FOR_EACH(java_lang_Number_charValue, "Ljava/lang/Number;.charValue:()C")    \
+  FOR_EACH(java_lang_Number_intValue, "Ljava/lang/Number;.intValue:()I")      \
+  FOR_EACH(java_lang_Number_longValue, "Ljava/lang/Number;.longValue:()J")    \
+  FOR_EACH(java_lang_Number_floatValue, "Ljava/lang/Number;.floatValue:()F")  \
+  FOR_EACH(java_lang_Number_doubleValue,                                      \
+           "Ljava/lang/Number;.doubleValue:()D")
+
+// Types and methods that may not exist. They are looked up rather than created,
+// see FrequentlyUsedPointers. (name, java_name)
+#define OPTIONAL_WELL_KNOWN_TYPES                                      \
+  FOR_EACH(java_lang_StringBuilder, "Ljava/lang/StringBuilder;")       \
+  FOR_EACH(kotlin_jvm_internal_Lambda, "Lkotlin/jvm/internal/Lambda;")
+
+#define OPTIONAL_WELL_KNOWN_METHODS                                           \
+  FOR_EACH(java_lang_StringBuilder_init,                                      \
+           "Ljava/lang/StringBuilder;.<init>:()V")                            \
+  FOR_EACH(java_lang_StringBuilder_init_int,                                  \
+           "Ljava/lang/StringBuilder;.<init>:(I)V")                           \
+  FOR_EACH(java_lang_StringBuilder_init_String,                               \
+           "Ljava/lang/StringBuilder;.<init>:(Ljava/lang/String;)V")          \
+  FOR_EACH(java_lang_StringBuilder_append_String,                             \
+           "Ljava/lang/StringBuilder;.append:(Ljava/lang/String;)Ljava/"      \
+           "lang/StringBuilder;")                                             \
+  FOR_EACH(java_lang_StringBuilder_toString,                                  \
+           "Ljava/lang/StringBuilder;.toString:()Ljava/lang/String;")         \
+  FOR_EACH(kotlin_jvm_internal_Intrinsics_checkParameterIsNotNull,            \
+           "Lkotlin/jvm/internal/Intrinsics;.checkParameterIsNotNull:(Ljava/" \
+           "lang/Object;Ljava/lang/String;)V")                                \
+  FOR_EACH(kotlin_jvm_internal_Intrinsics_checkNotNullParameter,              \
+           "Lkotlin/jvm/internal/Intrinsics;.checkNotNullParameter:(Ljava/"   \
+           "lang/Object;Ljava/lang/String;)V")                                \
+  FOR_EACH(kotlin_jvm_internal_Intrinsics_checExpressionValueIsNotNull,       \
+           "Lkotlin/jvm/internal/Intrinsics;.checkExpressionValueIsNotNull:(" \
+           "Ljava/lang/Object;Ljava/lang/String;)V")                          \
+  FOR_EACH(kotlin_jvm_internal_Intrinsics_checkNotNullExpressionValue,        \
+           "Lkotlin/jvm/internal/Intrinsics;.checkNotNullExpressionValue:("   \
+           "Ljava/lang/Object;Ljava/lang/String;)V")                          \
+  FOR_EACH(kotlin_jvm_internal_Intrinsics_WrCheckParameter_V1_3,              \
+           "Lkotlin/jvm/internal/Intrinsics;.$WrCheckParameter_V1_3:(Ljava/"  \
+           "lang/Object;I)V")                                                 \
+  FOR_EACH(kotlin_jvm_internal_Intrinsics_WrCheckParameter_V1_4,              \
+           "Lkotlin/jvm/internal/Intrinsics;.$WrCheckParameter_V1_4:(Ljava/"  \
+           "lang/Object;I)V")                                                 \
+  FOR_EACH(redex_internal_checkObjectNotNull,                                 \
+           "Lredex/$NullCheck;.null_check:(Ljava/lang/Object;)V")
@@ -7,7 +7,10 @@
 
 #include "WorkQueue.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 
 #include "DebugUtils.h"
 
@@ -18,3 +21,36 @@ void redex_queue_exception_handler(std::exception& e) {
 }
 
 } // namespace redex_workqueue_impl
+
+namespace redex_parallel {
+
+namespace {
+
+std::atomic<uint64_t> s_budget{0};
+std::mutex s_budget_mutex;
+std::condition_variable s_budget_cv;
+uint64_t s_cost_in_use{0};
+
+} // namespace
+
+void set_concurrent_cost_budget(uint64_t budget) { s_budget = budget; }
+
+uint64_t get_concurrent_cost_budget() { return s_budget; }
+
+ScopedCostBudget::ScopedCostBudget(uint64_t cost) : m_cost(cost) {
+  std::unique_lock<std::mutex> lock(s_budget_mutex);
+  s_budget_cv.wait(lock, [&] {
+    return s_cost_in_use == 0 || s_cost_in_use + m_cost <= s_budget;
+  });
+  s_cost_in_use += m_cost;
+}
+
+ScopedCostBudget::~ScopedCostBudget() {
+  {
+    std::lock_guard<std::mutex> lock(s_budget_mutex);
+    s_cost_in_use -= m_cost;
+  }
+  s_budget_cv.notify_all();
+}
+
+} // namespace redex_parallel
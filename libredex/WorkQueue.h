@@ -53,6 +53,29 @@ inline size_t default_num_threads() {
   // to take advantage of SMT.
   return std::max(1u, boost::thread::hardware_concurrency());
 }
+
+/*
+ * Bounds the summed cost of the work items that cost-aware walks run at the
+ * same time, so that walks whose memory use grows with the size of each item
+ * can use all threads on small items without running out of memory on big
+ * ones. An item costlier than the whole budget still runs, but alone.
+ * A budget of 0 means no limit.
+ */
+void set_concurrent_cost_budget(uint64_t budget);
+uint64_t get_concurrent_cost_budget();
+
+// Blocks until `cost` fits into the budget, and releases it on destruction.
+class ScopedCostBudget {
+ public:
+  explicit ScopedCostBudget(uint64_t cost);
+  ~ScopedCostBudget();
+
+  ScopedCostBudget(const ScopedCostBudget&) = delete;
+  ScopedCostBudget& operator=(const ScopedCostBudget&) = delete;
+
+ private:
+  uint64_t m_cost;
+};
 } // namespace redex_parallel
 
 // These functions are the most convenient way to create a sparta::WorkQueue
@@ -1136,28 +1136,52 @@ void ResFileManipulator::serialize(android::Vector<char>* out) {
     final_size -= size;
   }
   LOG_ALWAYS_FATAL_IF(final_size < 0, "final size went negative");
+  out->setCapacity(vec_start + final_size);
+  // Positions within the original data that have an edit, in file order. Data
+  // in between them is copied over in bulk.
+  std::vector<char*> edit_positions;
+  edit_positions.reserve(m_additions.size() + m_deletions.size());
+  for (const auto& [c, block] : m_additions) {
+    edit_positions.emplace_back(c);
+  }
+  for (const auto& [c, size] : m_deletions) {
+    edit_positions.emplace_back(c);
+  }
+  std::sort(edit_positions.begin(), edit_positions.end());
+  edit_positions.erase(
+      std::unique(edit_positions.begin(), edit_positions.end()),
+      edit_positions.end());
   // Copy the original data, applying our edits along the way.
   char* current = m_data;
-  size_t i = 0;
+  char* end = m_data + m_length;
+  auto next_edit = edit_positions.begin();
   auto emit = [&](const Block& block) {
     out->appendArray((const char*)block.buffer.get(), block.size);
   };
-  auto advance = [&](size_t amount) {
-    i += amount;
-    current += amount;
-  };
-  while (i < m_length) {
+  while (current < end) {
+    // Edits that fell within a deleted range are never reached.
+    while (next_edit != edit_positions.end() && *next_edit < current) {
+      next_edit++;
+    }
+    char* stop =
+        next_edit == edit_positions.end() ? end : std::min(*next_edit, end);
+    if (stop > current) {
+      out->appendArray(current, stop - current);
+      current = stop;
+      continue;
+    }
+    next_edit++;
     auto addition = m_additions.find(current);
     if (addition != m_additions.end()) {
       emit(addition->second);
     }
     auto deletion = m_deletions.find(current);
     if (deletion != m_deletions.end()) {
-      advance(deletion->second);
+      current += deletion->second;
       continue;
     }
     out->push_back(*current);
-    advance(1);
+    current++;
   }
   // Lastly, check if there is a request to add at the very end of the file.
   auto addition = m_additions.find(m_data + m_length);
@@ -23,6 +23,7 @@
 #include "DexUtil.h"
 #include "IRInstruction.h"
 #include "PassManager.h"
+#include "RedexContext.h"
 #include "Show.h"
 #include "Trace.h"
 #include "Walkers.h"
@@ -48,9 +49,10 @@ void write_violations_to_file(const app_module_usage::Violations& violations,
   ofs.close();
 }
 
+template <typename GetStore>
 void write_method_module_usages_to_file(
     const app_module_usage::MethodStoresReferenced& method_store_refs,
-    const InsertOnlyConcurrentMap<DexType*, DexStore*>& type_store_map,
+    const GetStore& get_store,
     const std::string& path) {
 
   TRACE(APP_MOD_USE, 4, "Outputting module usages at %s", path.c_str());
@@ -59,9 +61,9 @@ void write_method_module_usages_to_file(
     if (store_refs.empty()) {
       continue;
     }
-    auto it = type_store_map.find(method->get_class());
-    if (it != type_store_map.end()) {
-      ofs << "(" << it->second->get_name() << ") ";
+    auto* method_store = get_store(method->get_class());
+    if (method_store) {
+      ofs << "(" << method_store->get_name() << ") ";
     }
     ofs << show(method);
     for (const auto& [store, refl_only] : store_refs) {
@@ -119,10 +121,16 @@ void AppModuleUsagePass::run_pass(DexStoresVector& stores,
     return;
   }
 
+  // Each class has its own slot, so the stores can be filled in in parallel.
+  // The first store defining a class wins.
+  m_class_stores.assign(g_redex->num_class_indices(), nullptr);
   for (auto& store : stores) {
     Scope scope = build_class_scope(store.get_dexen());
-    walk::classes(scope, [&](DexClass* cls) {
-      m_type_store_map.emplace(cls->get_type(), &store);
+    walk::parallel::classes(scope, [&](DexClass* cls) {
+      auto& cls_store = m_class_stores[cls->get_dense_index()];
+      if (!cls_store) {
+        cls_store = &store;
+      }
     });
   }
 
@@ -130,21 +138,22 @@ void AppModuleUsagePass::run_pass(DexStoresVector& stores,
 
   const auto& full_scope = build_class_scope(stores);
   // TODO: Remove classes from scope that are exempt from checking.
-  auto method_store_refs = analyze_method_xstore_references(full_scope);
-  auto field_store_refs = analyze_field_xstore_references(full_scope);
+  auto xstore_refs = analyze_xstore_references(full_scope);
+  const auto& method_store_refs = xstore_refs.methods;
 
   if (m_output_module_use) {
     auto module_use_path = conf.metafile(APP_MODULE_USAGE_OUTPUT_FILENAME);
-    write_method_module_usages_to_file(method_store_refs, m_type_store_map,
-                                       module_use_path);
+    write_method_module_usages_to_file(
+        method_store_refs,
+        [this](const DexType* type) { return get_store(type); },
+        module_use_path);
 
     auto module_count_path = conf.metafile(APP_MODULE_COUNT_OUTPUT_FILENAME);
     write_app_module_use_stats(method_store_refs, module_count_path);
   }
 
   app_module_usage::Violations violations;
-  auto num_violations =
-      gather_violations(method_store_refs, field_store_refs, violations);
+  auto num_violations = gather_violations(xstore_refs, violations);
   auto report_path = conf.metafile(USES_AM_ANNO_VIOLATIONS_FILENAME);
   write_violations_to_file(violations, report_path);
 
@@ -200,8 +209,16 @@ void AppModuleUsagePass::load_preexisting_violations(DexStoresVector& stores) {
   ifs.close();
 }
 
-app_module_usage::MethodStoresReferenced
-AppModuleUsagePass::analyze_method_xstore_references(const Scope& scope) {
+DexStore* AppModuleUsagePass::get_store(const DexType* type) const {
+  auto* cls = type_class(type);
+  if (!cls || cls->get_dense_index() >= m_class_stores.size()) {
+    return nullptr;
+  }
+  return m_class_stores[cls->get_dense_index()];
+}
+
+app_module_usage::XStoreReferences
+AppModuleUsagePass::analyze_xstore_references(const Scope& scope) const {
 
   auto get_type_ref_for_insn = [](IRInstruction* insn) -> DexType* {
     if (insn->has_method()) {
@@ -214,11 +231,10 @@ AppModuleUsagePass::analyze_method_xstore_references(const Scope& scope) {
     return nullptr;
   };
 
-  app_module_usage::MethodStoresReferenced method_store_refs;
+  app_module_usage::XStoreReferences refs;
   reflection::MetadataCache refl_metadata_cache;
 
-  walk::parallel::code(scope, [&](DexMethod* method, IRCode& code) {
-    const auto* method_store = m_type_store_map.at(method->get_class());
+  auto analyze_method = [&](DexMethod* method, const DexStore* method_store) {
     std::unique_ptr<reflection::ReflectionAnalysis> analysis =
         std::make_unique<reflection::ReflectionAnalysis>(
             /* dex_method */ method,
@@ -247,19 +263,15 @@ AppModuleUsagePass::analyze_method_xstore_references(const Scope& scope) {
 
     auto get_store_if_access_is_xstore = [&](DexType* to) -> DexStore* {
       // The type may be external.
-      auto it = m_type_store_map.find(to);
-      if (it == m_type_store_map.end()) {
-        return nullptr;
-      }
-      auto store = it->second;
-      if (!store->is_root_store() && store != method_store) {
+      auto store = get_store(to);
+      if (store && !store->is_root_store() && store != method_store) {
         return store;
       }
       return nullptr;
     };
 
     app_module_usage::StoresReferenced stores_referenced;
-    auto& cfg = code.cfg();
+    auto& cfg = method->get_code()->cfg();
     for (const auto& mie : cfg::InstructionIterable(cfg)) {
       IRInstruction* insn = mie.insn;
       auto maybe_type_ref = get_type_ref_for_insn(insn);
@@ -284,47 +296,45 @@ AppModuleUsagePass::analyze_method_xstore_references(const Scope& scope) {
     }
 
     if (!stores_referenced.empty()) {
-      method_store_refs.emplace(method, std::move(stores_referenced));
+      refs.methods.emplace(method, std::move(stores_referenced));
     }
-  });
-
-  return method_store_refs;
-}
+  };
 
-InsertOnlyConcurrentMap<DexField*, DexStore*>
-AppModuleUsagePass::analyze_field_xstore_references(const Scope& scope) {
-  InsertOnlyConcurrentMap<DexField*, DexStore*> ret;
-  walk::parallel::fields(scope, [&](DexField* field) {
-    auto field_store = m_type_store_map.at(field->get_class());
-
-    auto field_type = field->get_type();
-    auto it = m_type_store_map.find(field_type);
-    if (it == m_type_store_map.end()) {
-      // Type may be external.
-      return;
+  // Methods and fields are analyzed in the same walk, which looks up the
+  // store of each class only once.
+  walk::parallel::classes(scope, [&](DexClass* cls) {
+    const auto* cls_store = m_class_stores.at(cls->get_dense_index());
+    for (auto* method : cls->get_all_methods()) {
+      if (method->get_code()) {
+        analyze_method(method, cls_store);
+      }
     }
-    auto store = it->second;
-    if (!store->is_root_store() && store != field_store) {
-      ret.emplace(field, store);
+    for (auto* field : cls->get_all_fields()) {
+      // The type may be external.
+      auto store = get_store(field->get_type());
+      if (store && !store->is_root_store() && store != cls_store) {
+        refs.fields.emplace(field, store);
+      }
     }
   });
-  return ret;
+
+  return refs;
 }
 
 unsigned AppModuleUsagePass::gather_violations(
-    const app_module_usage::MethodStoresReferenced& method_store_refs,
-    const InsertOnlyConcurrentMap<DexField*, DexStore*>& field_store_refs,
+    const app_module_usage::XStoreReferences& refs,
     app_module_usage::Violations& violations) const {
   int trace_level = m_crash_with_violations ? 0 : 1;
+  app_module_usage::ClassModulesGranted granted;
 
   unsigned n_violations{0u};
-  for (const auto& [method, stores_referenced] : method_store_refs) {
+  for (const auto& [method, stores_referenced] : refs.methods) {
     auto method_name = show(method);
     for (const auto& [store, only_reflection] : stores_referenced) {
-      if (access_granted_by_annotation(method, store)) {
+      if (access_granted_by_annotation(method, store, granted)) {
         continue;
       }
-      if (access_excused_due_to_preexisting(show(method), store)) {
+      if (access_excused_due_to_preexisting(method_name, store)) {
         continue;
       }
       TRACE(
@@ -332,26 +342,26 @@ unsigned AppModuleUsagePass::gather_violations(
           trace_level,
           "%s (from module \"%s\") uses app module \"%s\" without annotation\n",
           method_name.c_str(),
-          m_type_store_map.at(method->get_class())->get_name().c_str(),
+          get_store(method->get_class())->get_name().c_str(),
           store->get_name().c_str());
       violations[method_name].emplace(store->get_name());
       n_violations++;
     }
   }
 
-  for (const auto& [field, store] : field_store_refs) {
+  for (const auto& [field, store] : refs.fields) {
     auto field_name = show(field);
-    if (access_granted_by_annotation(field, store)) {
+    if (access_granted_by_annotation(field, store, granted)) {
       continue;
     }
-    if (access_excused_due_to_preexisting(show(field), store)) {
+    if (access_excused_due_to_preexisting(field_name, store)) {
       continue;
     }
     TRACE(APP_MOD_USE,
           trace_level,
           "%s (from module \"%s\") uses app module \"%s\" without annotation\n",
           field_name.c_str(),
-          m_type_store_map.at(field->get_class())->get_name().c_str(),
+          get_store(field->get_class())->get_name().c_str(),
           store->get_name().c_str());
     violations[field_name].emplace(store->get_name());
     n_violations++;
@@ -409,35 +419,43 @@ bool AppModuleUsagePass::access_excused_due_to_preexisting(
   return false;
 }
 
-bool AppModuleUsagePass::access_granted_by_annotation(DexMethod* method,
-                                                      DexStore* target) const {
+bool AppModuleUsagePass::access_granted_by_annotation(
+    DexMethod* method,
+    DexStore* target,
+    app_module_usage::ClassModulesGranted& granted) const {
   if (get_modules_used(method, m_uses_app_module_annotation)
           .count(target->get_name())) {
     return true;
   }
-  return access_granted_by_annotation(type_class(method->get_class()), target);
+  return get_modules_granted(type_class(method->get_class()), granted)
+      .count(target->get_name());
 }
 
-bool AppModuleUsagePass::access_granted_by_annotation(DexField* field,
-                                                      DexStore* target) const {
+bool AppModuleUsagePass::access_granted_by_annotation(
+    DexField* field,
+    DexStore* target,
+    app_module_usage::ClassModulesGranted& granted) const {
   if (get_modules_used(field, m_uses_app_module_annotation)
           .count(target->get_name())) {
     return true;
   }
-  return access_granted_by_annotation(type_class(field->get_class()), target);
+  return get_modules_granted(type_class(field->get_class()), granted)
+      .count(target->get_name());
 }
 
-bool AppModuleUsagePass::access_granted_by_annotation(DexClass* cls,
-                                                      DexStore* target) const {
-  if (!cls) {
-    return false;
+const std::unordered_set<std::string_view>&
+AppModuleUsagePass::get_modules_granted(
+    DexClass* cls, app_module_usage::ClassModulesGranted& granted) const {
+  auto it = granted.find(cls);
+  if (it != granted.end()) {
+    return it->second;
   }
-  if (get_modules_used(cls, m_uses_app_module_annotation)
-          .count(target->get_name())) {
-    return true;
+  if (!cls) {
+    return granted[cls];
   }
 
   // Check outer class.
+  const std::unordered_set<std::string_view>* outer_modules = nullptr;
   std::string_view cls_name = cls->str();
   auto dollar_sign_idx = cls_name.rfind('$');
   while (dollar_sign_idx != std::string_view::npos) {
@@ -446,11 +464,17 @@ bool AppModuleUsagePass::access_granted_by_annotation(DexClass* cls,
     auto* ty = DexType::get_type(new_class_name);
     DexClass* outer_class = ty ? type_class(ty) : nullptr;
     if (outer_class) {
-      return access_granted_by_annotation(outer_class, target);
+      outer_modules = &get_modules_granted(outer_class, granted);
+      break;
     }
     dollar_sign_idx = cls_name.rfind('$');
   }
-  return false;
+
+  auto modules = get_modules_used(cls, m_uses_app_module_annotation);
+  if (outer_modules) {
+    modules.insert(outer_modules->begin(), outer_modules->end());
+  }
+  return granted.emplace(cls, std::move(modules)).first->second;
 }
 
 static AppModuleUsagePass s_pass;
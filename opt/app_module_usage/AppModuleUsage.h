@@ -9,6 +9,10 @@
 #include <map>
 #include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "ConcurrentContainers.h"
 #include "DexClass.h"
@@ -20,6 +24,18 @@ using StoresReferenced =
     std::unordered_map<DexStore*, bool /* used_only_reflectively */>;
 using MethodStoresReferenced =
     InsertOnlyConcurrentMap<DexMethod*, StoresReferenced>;
+using FieldStoresReferenced = InsertOnlyConcurrentMap<DexField*, DexStore*>;
+
+// All references from one store to another non-root store.
+struct XStoreReferences {
+  MethodStoresReferenced methods;
+  FieldStoresReferenced fields;
+};
+
+// Modules that members of a class may use according to the annotations of
+// the class and of its outer classes.
+using ClassModulesGranted =
+    std::unordered_map<const DexClass*, std::unordered_set<std::string_view>>;
 
 using Violations = std::map<std::string /* entrypoint */,
                             std::set<std::string /* module name */>>;
@@ -77,32 +93,38 @@ class AppModuleUsagePass : public Pass {
  private:
   void load_preexisting_violations(DexStoresVector&);
 
-  app_module_usage::MethodStoresReferenced analyze_method_xstore_references(
-      const Scope& scope);
+  // Returns the store defining the given type, or nullptr if it is external.
+  DexStore* get_store(const DexType* type) const;
 
-  InsertOnlyConcurrentMap<DexField*, DexStore*> analyze_field_xstore_references(
-      const Scope& scope);
+  app_module_usage::XStoreReferences analyze_xstore_references(
+      const Scope& scope) const;
 
   // Returns number of violations.
-  unsigned gather_violations(
-      const app_module_usage::MethodStoresReferenced& method_store_refs,
-      const InsertOnlyConcurrentMap<DexField*, DexStore*>& field_store_refs,
-      app_module_usage::Violations& violations) const;
+  unsigned gather_violations(const app_module_usage::XStoreReferences& refs,
+                             app_module_usage::Violations& violations) const;
 
   // returns true if the given entrypoint name is allowed to use the given store
   bool access_excused_due_to_preexisting(const std::string& entrypoint_name,
                                          DexStore* store_used) const;
-  bool access_granted_by_annotation(DexMethod* method, DexStore* target) const;
-  bool access_granted_by_annotation(DexField* field, DexStore* target) const;
-  bool access_granted_by_annotation(DexClass* cls, DexStore* target) const;
+  bool access_granted_by_annotation(
+      DexMethod* method,
+      DexStore* target,
+      app_module_usage::ClassModulesGranted& granted) const;
+  bool access_granted_by_annotation(
+      DexField* field,
+      DexStore* target,
+      app_module_usage::ClassModulesGranted& granted) const;
+  const std::unordered_set<std::string_view>& get_modules_granted(
+      DexClass* cls, app_module_usage::ClassModulesGranted& granted) const;
 
   // Map of violations from entrypoint names to the names of stores used
   // by the entrypoint
   std::unordered_map<std::string, std::unordered_set<DexStore*>>
       m_preexisting_violations;
 
-  // To quickly look up wich DexStore ("module") a DexType is from
-  InsertOnlyConcurrentMap<DexType*, DexStore*> m_type_store_map;
+  // To quickly look up wich DexStore ("module") a DexClass is from, indexed by
+  // the dense index of the class
+  std::vector<DexStore*> m_class_stores;
 
   bool m_output_module_use;
   bool m_crash_with_violations;
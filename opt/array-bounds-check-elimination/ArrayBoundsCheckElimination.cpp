@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ArrayBoundsCheckElimination.h"
+
+#include <vector>
+
+#include <sparta/AbstractDomain.h>
+#include <sparta/PatriciaTreeSetAbstractDomain.h>
+
+#include "BaseIRAnalyzer.h"
+#include "ControlFlow.h"
+#include "DexClass.h"
+#include "IRCode.h"
+#include "IRInstruction.h"
+#include "PassManager.h"
+#include "Show.h"
+#include "Trace.h"
+#include "Walkers.h"
+
+namespace {
+
+// A fact relates up to two registers, packed as kind | x | y.
+using Fact = uint64_t;
+
+enum FactKind : uint64_t {
+  // x >= 0
+  NONNEG = 1,
+  // x != null
+  NONNULL = 2,
+  // x == y.length
+  LENGTH = 3,
+  // x < y.length
+  BELOW = 4,
+};
+
+constexpr size_t REG_BITS = 28;
+constexpr uint64_t REG_MASK = (uint64_t(1) << REG_BITS) - 1;
+// Holds the value of a primary instruction until its move-result-pseudo.
+constexpr reg_t RESULT_REGISTER = REG_MASK;
+
+Fact make_fact(FactKind kind, reg_t x, reg_t y = 0) {
+  return (uint64_t(kind) << (2 * REG_BITS)) | (uint64_t(x) << REG_BITS) | y;
+}
+
+FactKind kind_of(Fact fact) { return FactKind(fact >> (2 * REG_BITS)); }
+reg_t x_of(Fact fact) { return (fact >> REG_BITS) & REG_MASK; }
+reg_t y_of(Fact fact) { return fact & REG_MASK; }
+bool is_binary(Fact fact) {
+  return kind_of(fact) == LENGTH || kind_of(fact) == BELOW;
+}
+
+/*
+ * The facts that hold on every path. This is realized via the reverse adaptor,
+ * as we want to compute the intersection on joins.
+ */
+class FactsDomain final
+    : public sparta::AbstractDomainReverseAdaptor<
+          sparta::PatriciaTreeSetAbstractDomain<Fact>,
+          FactsDomain> {
+ public:
+  using AbstractDomainReverseAdaptor::AbstractDomainReverseAdaptor;
+
+  // Some older compilers complain that the class is not default constructible.
+  // We intended to use the default constructors of the base class (via using
+  // AbstractDomainReverseAdaptor::AbstractDomainReverseAdaptor), but some
+  // compilers fail to catch this. So we insert a redundant '= default'.
+  FactsDomain() = default;
+
+  bool has(FactKind kind, reg_t x, reg_t y = 0) const {
+    return unwrap().contains(make_fact(kind, x, y));
+  }
+
+  void add(FactKind kind, reg_t x, reg_t y = 0) {
+    unwrap().add(make_fact(kind, x, y));
+  }
+
+  // The arrays y for which `kind(x, y)` holds.
+  std::vector<reg_t> arrays(FactKind kind, reg_t x) const {
+    std::vector<reg_t> res;
+    for (auto fact : unwrap().elements()) {
+      if (kind_of(fact) == kind && x_of(fact) == x) {
+        res.push_back(y_of(fact));
+      }
+    }
+    return res;
+  }
+
+  // Forget everything about `reg`, which is being overwritten.
+  void kill(reg_t reg) {
+    std::vector<Fact> killed;
+    for (auto fact : unwrap().elements()) {
+      if (x_of(fact) == reg || (is_binary(fact) && y_of(fact) == reg)) {
+        killed.push_back(fact);
+      }
+    }
+    unwrap().remove(killed.begin(), killed.end());
+  }
+
+  // `dest` gets the value of `src`.
+  void copy(reg_t src, reg_t dest) {
+    if (src == dest) {
+      return;
+    }
+    kill(dest);
+    std::vector<Fact> copied;
+    for (auto fact : unwrap().elements()) {
+      auto x = x_of(fact);
+      auto y = y_of(fact);
+      bool binary = is_binary(fact);
+      if (x != src && !(binary && y == src)) {
+        continue;
+      }
+      copied.push_back(make_fact(kind_of(fact), x == src ? dest : x,
+                                 binary && y == src ? dest : y));
+    }
+    unwrap().add(copied.begin(), copied.end());
+  }
+
+  // x < y
+  void add_less_than(reg_t x, reg_t y) {
+    for (auto array : arrays(LENGTH, y)) {
+      add(BELOW, x, array);
+    }
+  }
+};
+
+bool is_reachable(const FactsDomain& state) {
+  return state.unwrap().is_value();
+}
+
+class Analyzer final : public ir_analyzer::BaseIRAnalyzer<FactsDomain> {
+ public:
+  explicit Analyzer(const cfg::ControlFlowGraph& cfg)
+      : ir_analyzer::BaseIRAnalyzer<FactsDomain>(cfg) {}
+
+  void analyze_instruction(const IRInstruction* insn,
+                           FactsDomain* state) const override {
+    if (!is_reachable(*state)) {
+      return;
+    }
+    auto op = insn->opcode();
+    switch (op) {
+    case OPCODE_CONST:
+      state->kill(insn->dest());
+      if (insn->get_literal() >= 0) {
+        state->add(NONNEG, insn->dest());
+      }
+      return;
+    case OPCODE_MOVE:
+    case OPCODE_MOVE_OBJECT:
+      state->copy(insn->src(0), insn->dest());
+      return;
+    case IOPCODE_MOVE_RESULT_PSEUDO:
+    case IOPCODE_MOVE_RESULT_PSEUDO_OBJECT:
+      state->copy(RESULT_REGISTER, insn->dest());
+      state->kill(RESULT_REGISTER);
+      return;
+    case IOPCODE_MOVE_RESULT_PSEUDO_WIDE:
+      state->kill(insn->dest());
+      state->kill(insn->dest() + 1);
+      state->kill(RESULT_REGISTER);
+      return;
+    case OPCODE_ARRAY_LENGTH:
+      state->kill(RESULT_REGISTER);
+      state->add(NONNULL, insn->src(0));
+      state->add(NONNEG, RESULT_REGISTER);
+      state->add(LENGTH, RESULT_REGISTER, insn->src(0));
+      return;
+    case OPCODE_NEW_ARRAY:
+      // A negative size would have thrown.
+      state->kill(RESULT_REGISTER);
+      state->add(NONNEG, insn->src(0));
+      state->add(NONNULL, RESULT_REGISTER);
+      state->add(LENGTH, insn->src(0), RESULT_REGISTER);
+      return;
+    case OPCODE_ADD_INT_LIT:
+      analyze_add_lit(insn, state);
+      return;
+    default:
+      break;
+    }
+    if (opcode::is_an_aget(op) || opcode::is_an_aput(op)) {
+      // The access succeeded, so the index is in bounds from now on.
+      auto array = insn->src(opcode::is_an_aget(op) ? 0 : 1);
+      auto index = insn->src(opcode::is_an_aget(op) ? 1 : 2);
+      state->kill(RESULT_REGISTER);
+      state->add(NONNULL, array);
+      state->add(NONNEG, index);
+      state->add(BELOW, index, array);
+      return;
+    }
+    if (insn->has_dest()) {
+      state->kill(insn->dest());
+      if (insn->dest_is_wide()) {
+        state->kill(insn->dest() + 1);
+      }
+    } else if (insn->has_move_result_any()) {
+      state->kill(RESULT_REGISTER);
+    }
+  }
+
+  FactsDomain analyze_edge(const cfg::GraphInterface::EdgeId& e,
+                           const FactsDomain& exit_state_at_source) const
+      override {
+    if (e->type() == cfg::EDGE_THROW) {
+      // The throwing instruction didn't complete.
+      return FactsDomain();
+    }
+    auto* src = e->src();
+    auto last_it = src->get_last_insn();
+    if (!is_reachable(exit_state_at_source) || last_it == src->end() ||
+        !opcode::is_a_conditional_branch(last_it->insn->opcode())) {
+      return exit_state_at_source;
+    }
+    auto* insn = last_it->insn;
+    bool taken = e->type() == cfg::EDGE_BRANCH;
+    auto state = exit_state_at_source;
+    switch (insn->opcode()) {
+    case OPCODE_IF_LT:
+      if (taken) {
+        state.add_less_than(insn->src(0), insn->src(1));
+      }
+      break;
+    case OPCODE_IF_GE:
+      if (!taken) {
+        state.add_less_than(insn->src(0), insn->src(1));
+      }
+      break;
+    case OPCODE_IF_GT:
+      if (taken) {
+        state.add_less_than(insn->src(1), insn->src(0));
+      }
+      break;
+    case OPCODE_IF_LE:
+      if (!taken) {
+        state.add_less_than(insn->src(1), insn->src(0));
+      }
+      break;
+    case OPCODE_IF_GEZ:
+    case OPCODE_IF_GTZ:
+      if (taken) {
+        state.add(NONNEG, insn->src(0));
+      }
+      break;
+    case OPCODE_IF_LTZ:
+    case OPCODE_IF_LEZ:
+      if (!taken) {
+        state.add(NONNEG, insn->src(0));
+      }
+      break;
+    case OPCODE_IF_NEZ:
+      if (taken) {
+        state.add(NONNULL, insn->src(0));
+      }
+      break;
+    case OPCODE_IF_EQZ:
+      if (!taken) {
+        state.add(NONNULL, insn->src(0));
+      }
+      break;
+    default:
+      break;
+    }
+    return state;
+  }
+
+  static bool is_safe(const IRInstruction* insn, const FactsDomain& state) {
+    if (!is_reachable(state)) {
+      return false;
+    }
+    auto op = insn->opcode();
+    if (op == OPCODE_ARRAY_LENGTH) {
+      return state.has(NONNULL, insn->src(0));
+    }
+    if (!opcode::is_an_aget(op) &&
+        (!opcode::is_an_aput(op) || op == OPCODE_APUT_OBJECT)) {
+      return false;
+    }
+    auto array = insn->src(opcode::is_an_aget(op) ? 0 : 1);
+    auto index = insn->src(opcode::is_an_aget(op) ? 1 : 2);
+    return state.has(NONNULL, array) && state.has(NONNEG, index) &&
+           state.has(BELOW, index, array);
+  }
+
+ private:
+  static void analyze_add_lit(const IRInstruction* insn, FactsDomain* state) {
+    auto src = insn->src(0);
+    auto dest = insn->dest();
+    auto lit = insn->get_literal();
+    if (lit == 0) {
+      state->copy(src, dest);
+      return;
+    }
+    std::vector<std::pair<FactKind, reg_t>> facts;
+    bool nonneg = state->has(NONNEG, src);
+    auto below = state->arrays(BELOW, src);
+    if (lit == 1 && nonneg && !below.empty()) {
+      // src < length <= INT_MAX, so this can't overflow.
+      facts.emplace_back(NONNEG, 0);
+    }
+    if (lit < 0) {
+      // Neither a non-negative index nor a length can underflow here.
+      if (nonneg) {
+        for (auto array : below) {
+          facts.emplace_back(BELOW, array);
+        }
+      }
+      for (auto array : state->arrays(LENGTH, src)) {
+        facts.emplace_back(BELOW, array);
+      }
+    }
+    state->kill(dest);
+    for (auto [kind, array] : facts) {
+      state->add(kind, dest, array);
+    }
+  }
+};
+
+} // namespace
+
+namespace array_bounds {
+
+Stats process_cfg(cfg::ControlFlowGraph& cfg) {
+  Stats stats;
+  Analyzer analyzer(cfg);
+  analyzer.run(FactsDomain());
+  for (auto* block : cfg.blocks()) {
+    auto state = analyzer.get_entry_state_at(block);
+    auto last_it = block->get_last_insn();
+    for (auto& mie : InstructionIterable(block)) {
+      auto* insn = mie.insn;
+      if (Analyzer::is_safe(insn, state)) {
+        stats.safe_array_accesses++;
+        if (insn == last_it->insn &&
+            cfg.get_succ_edge_of_type(block, cfg::EDGE_THROW) != nullptr) {
+          TRACE(CONSTP, 3, "[array-bounds] %s cannot throw", SHOW(insn));
+          cfg.delete_succ_edge_if(block, [](const cfg::Edge* e) {
+            return e->type() == cfg::EDGE_THROW;
+          });
+          stats.throw_edges_removed++;
+        }
+      }
+      analyzer.analyze_instruction(insn, &state);
+    }
+  }
+  if (stats.throw_edges_removed != 0) {
+    cfg.remove_unreachable_blocks();
+  }
+  return stats;
+}
+
+} // namespace array_bounds
+
+void ArrayBoundsCheckEliminationPass::run_pass(DexStoresVector& stores,
+                                               ConfigFiles& /* unused */,
+                                               PassManager& mgr) {
+  auto scope = build_class_scope(stores);
+  auto stats = walk::parallel::methods<array_bounds::Stats>(
+      scope, [](DexMethod* method) -> array_bounds::Stats {
+        auto* code = method->get_code();
+        if (!code || method->rstate.no_optimizations()) {
+          return {};
+        }
+        always_assert(code->editable_cfg_built());
+        return array_bounds::process_cfg(code->cfg());
+      });
+  mgr.incr_metric("num_safe_array_accesses", stats.safe_array_accesses);
+  mgr.incr_metric("num_throw_edges_removed", stats.throw_edges_removed);
+}
+
+static ArrayBoundsCheckEliminationPass s_pass;
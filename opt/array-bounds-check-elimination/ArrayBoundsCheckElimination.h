@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include "Pass.h"
+
+namespace cfg {
+class ControlFlowGraph;
+} // namespace cfg
+
+namespace array_bounds {
+
+struct Stats {
+  // aget, aput and array-length instructions proven not to throw.
+  size_t safe_array_accesses{0};
+  // Proven instructions in try regions whose throw edges were removed.
+  size_t throw_edges_removed{0};
+
+  Stats& operator+=(const Stats& that) {
+    safe_array_accesses += that.safe_array_accesses;
+    throw_edges_removed += that.throw_edges_removed;
+    return *this;
+  }
+};
+
+/*
+ * Proves that array accesses can neither throw a NullPointerException nor an
+ * ArrayIndexOutOfBoundsException, and removes the throw edges of those in try
+ * regions. Handlers that become unreachable are removed.
+ *
+ * The analysis tracks relations that hold on every path: registers known to
+ * be non-negative, non-null, or the length of an array, and registers known to
+ * be less than the length of an array. These come from array-length and
+ * new-array, from loop conditions comparing against a length, from earlier
+ * successful accesses, and from stepping an index by one towards zero or
+ * away from it while it stays in bounds. aput-object may still throw an
+ * ArrayStoreException, so it is never proven.
+ */
+Stats process_cfg(cfg::ControlFlowGraph& cfg);
+
+} // namespace array_bounds
+
+class ArrayBoundsCheckEliminationPass : public Pass {
+ public:
+  ArrayBoundsCheckEliminationPass() : Pass("ArrayBoundsCheckEliminationPass") {}
+
+  redex_properties::PropertyInteractions get_property_interactions()
+      const override {
+    using namespace redex_properties::interactions;
+    using namespace redex_properties::names;
+    return {
+        {DexLimitsObeyed, Preserves},
+        {NoInitClassInstructions, Preserves},
+        {NoUnreachableInstructions, Preserves},
+        {NoResolvablePureRefs, Preserves},
+        {RenameClass, Preserves},
+    };
+  }
+
+  void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+};
@@ -15,6 +15,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <fstream>
+#include <sstream>
 #include <string>
 
 #include "ConcurrentContainers.h"
@@ -25,6 +26,7 @@
 #include "PassManager.h"
 #include "Show.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 namespace {
 const std::string BASELINE_PROFILES_FILE = "additional-baseline-profiles.list";
@@ -315,42 +317,55 @@ void ArtProfileWriterPass::run_pass(DexStoresVector& stores,
     }
   }
 
-  std::ofstream ofs{conf.metafile(BASELINE_PROFILES_FILE)};
-
   always_assert(!stores.empty());
   auto& dexen = stores.front().get_dexen();
   int32_t min_sdk = mgr.get_redex_options().min_sdk;
   mgr.incr_metric("min_sdk", min_sdk);
   auto end = min_sdk >= 21 ? dexen.size() : 1;
-  InsertOnlyConcurrentSet<DexMethod*> methods_with_baseline_profile;
+  Scope profiled_scope;
   for (size_t dex_idx = 0; dex_idx < end; dex_idx++) {
     auto& dex = dexen.at(dex_idx);
-    for (auto* cls : dex) {
-      bool should_include_class = false;
-      for (auto* method : cls->get_all_methods()) {
-        auto it = method_flags.find(method);
-        if (it == method_flags.end()) {
-          continue;
-        }
-        // hot method's class should be included.
-        // In addition, if we include non-hot startup method, we also need to
-        // include its class.
-        if (it->second.hot || (it->second.startup && !it->second.not_startup)) {
-          should_include_class = true;
-        }
-        std::string descriptor = show_deobfuscated(method);
-        // reformat it into manual profile pattern so baseline profile generator
-        // in post-process can recognize the method
-        boost::replace_all(descriptor, ".", "->");
-        boost::replace_all(descriptor, ":(", "(");
-        ofs << it->second << descriptor << std::endl;
-        methods_with_baseline_profile.insert(method);
+    profiled_scope.insert(profiled_scope.end(), dex.begin(), dex.end());
+  }
+
+  // Rendering the deobfuscated descriptors is the expensive part, so the
+  // lines of each class are built in parallel, and then written out in order.
+  InsertOnlyConcurrentSet<DexMethod*> methods_with_baseline_profile;
+  std::vector<std::string> class_lines(profiled_scope.size());
+  workqueue_run_for<size_t>(0, profiled_scope.size(), [&](size_t i) {
+    auto* cls = profiled_scope[i];
+    std::ostringstream oss;
+    bool should_include_class = false;
+    for (auto* method : cls->get_all_methods()) {
+      auto it = method_flags.find(method);
+      if (it == method_flags.end()) {
+        continue;
       }
-      if (should_include_class) {
-        ofs << show_deobfuscated(cls) << std::endl;
+      // hot method's class should be included.
+      // In addition, if we include non-hot startup method, we also need to
+      // include its class.
+      if (it->second.hot || (it->second.startup && !it->second.not_startup)) {
+        should_include_class = true;
       }
+      std::string descriptor = show_deobfuscated(method);
+      // reformat it into manual profile pattern so baseline profile generator
+      // in post-process can recognize the method
+      boost::replace_all(descriptor, ".", "->");
+      boost::replace_all(descriptor, ":(", "(");
+      oss << it->second << descriptor << '\n';
+      methods_with_baseline_profile.insert(method);
+    }
+    if (should_include_class) {
+      oss << show_deobfuscated(cls) << '\n';
     }
+    class_lines[i] = oss.str();
+  });
+
+  std::ofstream ofs{conf.metafile(BASELINE_PROFILES_FILE)};
+  for (const auto& lines : class_lines) {
+    ofs << lines;
   }
+  ofs.close();
 
   auto scope = build_class_scope(stores);
   std::atomic<size_t> methods_with_baseline_profile_code_units{0};
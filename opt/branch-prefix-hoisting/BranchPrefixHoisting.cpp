@@ -609,6 +609,16 @@ size_t BranchPrefixHoistingPass::process_cfg(
     cfg::ControlFlowGraph& cfg,
     Lazy<const constant_uses::ConstantUses>& constant_uses,
     bool can_allocate_regs) {
+  // Most methods have few or no branches; don't bother sorting the blocks of
+  // those that have none.
+  const auto& all_blocks = cfg.blocks();
+  if (std::none_of(all_blocks.begin(), all_blocks.end(), [](cfg::Block* b) {
+        auto it = b->get_last_insn();
+        return it != b->end() && is_block_eligible(it->insn);
+      })) {
+    return 0;
+  }
+
   size_t ret_insns_hoisted = 0;
   bool performed_transformation = false;
   do {
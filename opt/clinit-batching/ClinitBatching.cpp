@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ClinitBatching.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ConcurrentContainers.h"
+#include "ConfigFiles.h"
+#include "ControlFlow.h"
+#include "DexStore.h"
+#include "EditableCfgAdapter.h"
+#include "IRCode.h"
+#include "IRInstruction.h"
+#include "InitClassesWithSideEffects.h"
+#include "InitDeps.h"
+#include "MethodUtil.h"
+#include "PassManager.h"
+#include "ReachableClasses.h"
+#include "Resolver.h"
+#include "Show.h"
+#include "SourceBlocks.h"
+#include "Trace.h"
+#include "TypeUtil.h"
+#include "Walkers.h"
+
+namespace {
+
+constexpr const char* METRIC_BATCHED_CLINITS = "num_batched_clinits";
+constexpr const char* METRIC_BATCHING_CLINITS = "num_batching_clinits";
+constexpr const char* METRIC_INIT_CYCLES = "num_init_cycles";
+
+// Whether anything `method` may execute refers to `type`. Calls into the
+// framework are assumed not to call back into the app; dynamic dispatch to
+// app code is not followed, and so rejected.
+bool may_refer_to(const DexMethod* method,
+                  const DexType* type,
+                  std::unordered_set<const DexMethod*>* visited) {
+  if (!visited->insert(method).second) {
+    return false;
+  }
+  auto* code = method->get_code();
+  if (code == nullptr) {
+    return true;
+  }
+  bool res = false;
+  editable_cfg_adapter::iterate(code, [&](const MethodItemEntry& mie) {
+    auto* insn = mie.insn;
+    if (insn->has_type() && insn->get_type() == type) {
+      res = true;
+    } else if (insn->has_field()) {
+      auto* field = resolve_field(insn->get_field());
+      res = insn->get_field()->get_class() == type ||
+            (field != nullptr && field->get_class() == type);
+    } else if (insn->has_method()) {
+      auto* callee =
+          resolve_method(insn->get_method(), opcode_to_search(insn), method);
+      if (insn->get_method()->get_class() == type || callee == nullptr) {
+        res = true;
+      } else if (!callee->is_external()) {
+        res = callee->get_class() == type ||
+              (!opcode::is_invoke_static(insn->opcode()) &&
+               !opcode::is_invoke_direct(insn->opcode())) ||
+              may_refer_to(callee, type, visited);
+      }
+    }
+    return res ? editable_cfg_adapter::LOOP_BREAK
+               : editable_cfg_adapter::LOOP_CONTINUE;
+  });
+  return res;
+}
+
+bool is_eligible(const DexClass* cls,
+                 const std::unordered_set<const DexType*>* startup_types) {
+  if (cls == nullptr || cls->is_external() || is_interface(cls)) {
+    return false;
+  }
+  if (startup_types != nullptr && !startup_types->count(cls->get_type())) {
+    return false;
+  }
+  auto* clinit = cls->get_clinit();
+  return clinit != nullptr && clinit->get_code() != nullptr &&
+         !clinit->rstate.no_optimizations();
+}
+
+} // namespace
+
+namespace clinit_batching {
+
+Stats batch_clinits(const Scope& scope,
+                    const init_classes::InitClassesWithSideEffects&
+                        init_classes_with_side_effects,
+                    const XStoreRefs& xstores,
+                    const std::unordered_set<const DexType*>* startup_types) {
+  // For each class, the classes whose code accesses its static fields,
+  // not counting its own static initializer.
+  ConcurrentMap<const DexType*, std::unordered_set<const DexType*>> accessors;
+  walk::parallel::code(scope, [&](DexMethod* method, IRCode& code) {
+    editable_cfg_adapter::iterate(&code, [&](const MethodItemEntry& mie) {
+      auto* insn = mie.insn;
+      if (opcode::is_an_sfield_op(insn->opcode())) {
+        auto* field = resolve_field(insn->get_field(), FieldSearch::Static);
+        auto* declaring = field != nullptr ? field->get_class()
+                                           : insn->get_field()->get_class();
+        if (!method::is_clinit(method) || method->get_class() != declaring) {
+          accessors.update(declaring, [&](auto*, auto& set, bool) {
+            set.insert(method->get_class());
+          });
+        }
+      }
+      return editable_cfg_adapter::LOOP_CONTINUE;
+    });
+  });
+
+  // Maps each class whose initializer gets batched to the class it is
+  // batched into.
+  std::unordered_map<DexClass*, DexClass*> owners;
+  for (auto* cls : scope) {
+    if (!is_eligible(cls, startup_types) || root(cls) ||
+        !init_classes_with_side_effects.get(cls->get_type())->empty()) {
+      continue;
+    }
+    const auto& sfields = cls->get_sfields();
+    if (std::any_of(sfields.begin(), sfields.end(),
+                    [](auto* field) { return root(field); })) {
+      continue;
+    }
+    auto it = accessors.find(cls->get_type());
+    if (it == accessors.end() || it->second.size() != 1) {
+      continue;
+    }
+    auto* owner = type_class(*it->second.begin());
+    if (owner == cls || !is_eligible(owner, startup_types) ||
+        !type::same_package(owner->get_type(), cls->get_type()) ||
+        xstores.illegal_ref(owner->get_type(), cls->get_type())) {
+      continue;
+    }
+    std::unordered_set<const DexMethod*> visited;
+    if (may_refer_to(cls->get_clinit(), owner->get_type(), &visited)) {
+      continue;
+    }
+    owners.emplace(cls, owner);
+  }
+  // An owner whose initializer is batched itself no longer runs first when
+  // its static methods are invoked.
+  std::vector<DexClass*> chained;
+  for (auto [cls, owner] : owners) {
+    if (owners.count(owner)) {
+      chained.push_back(cls);
+    }
+  }
+  for (auto* cls : chained) {
+    owners.erase(cls);
+  }
+
+  Stats stats;
+  std::unordered_map<const DexClass*, size_t> init_order;
+  for (auto* cls :
+       init_deps::reverse_tsort_by_clinit_deps(scope, stats.init_cycles)) {
+    init_order.emplace(cls, init_order.size());
+  }
+  std::unordered_map<DexClass*, std::vector<DexClass*>> batches;
+  for (auto [cls, owner] : owners) {
+    if (init_order.count(cls) && init_order.count(owner)) {
+      batches[owner].push_back(cls);
+    }
+  }
+
+  auto* batched_name = DexString::make_string("$clinit$");
+  for (auto& [owner, classes] : batches) {
+    std::sort(classes.begin(), classes.end(), [&](auto* a, auto* b) {
+      return init_order.at(a) < init_order.at(b);
+    });
+    std::vector<IRInstruction*> invokes;
+    for (auto* cls : classes) {
+      auto* clinit = cls->get_clinit();
+      clinit->set_access(clinit->get_access() & ~ACC_CONSTRUCTOR);
+      DexMethodSpec spec(nullptr, batched_name, nullptr);
+      clinit->change(spec, /* rename_on_collision */ true);
+      for (auto* field : cls->get_sfields()) {
+        // Now written outside of a static initializer.
+        field->set_access(field->get_access() & ~ACC_FINAL);
+      }
+      invokes.push_back(
+          (new IRInstruction(OPCODE_INVOKE_STATIC))->set_method(clinit));
+      TRACE(FINALINLINE, 2, "[clinit-batching] batching %s into %s",
+            SHOW(clinit), SHOW(owner));
+    }
+
+    auto& cfg = owner->get_clinit()->get_code()->cfg();
+    auto* entry = cfg.entry_block();
+    auto* block = cfg.create_block();
+    block->push_back(invokes);
+    if (auto* sb = source_blocks::get_first_source_block(entry)) {
+      block->insert_before(block->begin(), std::make_unique<SourceBlock>(*sb));
+    }
+    cfg.add_edge(block, entry, cfg::EDGE_GOTO);
+    cfg.set_entry_block(block);
+
+    stats.batched_clinits += classes.size();
+    stats.batching_clinits++;
+  }
+  return stats;
+}
+
+} // namespace clinit_batching
+
+void ClinitBatchingPass::run_pass(DexStoresVector& stores,
+                                  ConfigFiles& conf,
+                                  PassManager& mgr) {
+  auto scope = build_class_scope(stores);
+  std::unordered_set<const DexType*> startup_types;
+  if (m_startup_classes_only) {
+    for (const auto& str : conf.get_coldstart_classes()) {
+      if (auto* type = DexType::get_type(str)) {
+        startup_types.insert(type);
+      }
+    }
+  }
+  init_classes::InitClassesWithSideEffects init_classes_with_side_effects(
+      scope, conf.create_init_class_insns());
+  XStoreRefs xstores(stores);
+  auto stats = clinit_batching::batch_clinits(
+      scope, init_classes_with_side_effects, xstores,
+      m_startup_classes_only ? &startup_types : nullptr);
+  mgr.incr_metric(METRIC_BATCHED_CLINITS, stats.batched_clinits);
+  mgr.incr_metric(METRIC_BATCHING_CLINITS, stats.batching_clinits);
+  mgr.incr_metric(METRIC_INIT_CYCLES, stats.init_cycles);
+}
+
+static ClinitBatchingPass s_pass;
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <unordered_set>
+
+#include "DexClass.h"
+#include "Pass.h"
+
+class XStoreRefs;
+
+namespace init_classes {
+class InitClassesWithSideEffects;
+} // namespace init_classes
+
+namespace clinit_batching {
+
+struct Stats {
+  // Static initializers turned into methods invoked by another one.
+  size_t batched_clinits{0};
+  // Static initializers that the batched ones are now invoked from.
+  size_t batching_clinits{0};
+  size_t init_cycles{0};
+};
+
+/*
+ * Folds the static initializer of a class B into the static initializer of
+ * the only class A whose code accesses the static fields of B: B.<clinit>
+ * becomes a plain static method, which is invoked first thing in A.<clinit>.
+ * B is then left without a static initializer, so initializing it is cheap.
+ *
+ * Every access to a static field of B happens in a method of A, and so only
+ * after A was initialized, which by then has run the former initializer of B.
+ * This requires that B.<clinit> has no side effects, so that running it
+ * earlier is unobservable, and that nothing it may execute refers to A, whose
+ * own static fields are not initialized yet at that point. When several
+ * initializers are folded into the same class, they are invoked in the order
+ * of their initialization dependencies.
+ *
+ * When `startup_types` is given, only classes in it are considered.
+ */
+Stats batch_clinits(
+    const Scope& scope,
+    const init_classes::InitClassesWithSideEffects&
+        init_classes_with_side_effects,
+    const XStoreRefs& xstores,
+    const std::unordered_set<const DexType*>* startup_types);
+
+} // namespace clinit_batching
+
+class ClinitBatchingPass : public Pass {
+ public:
+  ClinitBatchingPass() : Pass("ClinitBatchingPass") {}
+
+  redex_properties::PropertyInteractions get_property_interactions()
+      const override {
+    using namespace redex_properties::interactions;
+    using namespace redex_properties::names;
+    return {
+        {DexLimitsObeyed, Preserves},
+        {NoResolvablePureRefs, Preserves},
+        {NoUnreachableInstructions, Preserves},
+    };
+  }
+
+  void bind_config() override {
+    bind("startup_classes_only", true, m_startup_classes_only,
+         "Only batch the static initializers of classes listed in the "
+         "coldstart class list");
+  }
+
+  void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+
+ private:
+  bool m_startup_classes_only;
+};
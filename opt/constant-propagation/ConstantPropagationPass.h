@@ -30,6 +30,11 @@ class ConstantPropagationPass : public Pass {
          true,
          m_config.transform.replace_moves_with_consts);
     bind("remove_dead_switch", true, m_config.transform.remove_dead_switch);
+    bind("prune_dead_registers_min_regs",
+         m_config.prune_dead_registers_min_regs,
+         m_config.prune_dead_registers_min_regs,
+         "Minimum number of registers of a method for the analysis to drop "
+         "dead registers at block boundaries; 0 disables it.");
   }
 
   void run_pass(DexStoresVector& stores,
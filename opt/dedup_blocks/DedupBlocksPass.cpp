@@ -18,6 +18,10 @@ const char* METRIC_INSNS_REMOVED = "insns_removed";
 const char* METRIC_BLOCKS_SPLIT = "blocks_split";
 const char* METRIC_POSITIONS_INSERTED = "positions_inserted";
 const char* METRIC_ELIGIBLE_BLOCKS = "eligible_blocks";
+const char* METRIC_BLOCK_HASH_INDEX_METHODS = "block_hash_index_methods";
+const char* METRIC_CROSS_METHOD_DUPLICATE_BLOCKS =
+    "cross_method_duplicate_blocks";
+const char* METRIC_CROSS_METHOD_DUPLICATE_INSNS = "cross_method_duplicate_insns";
 } // namespace
 
 void DedupBlocksPass::run_pass(DexStoresVector& stores,
@@ -31,6 +35,9 @@ void DedupBlocksPass::run_pass(DexStoresVector& stores,
         const auto code = method->get_code();
         if (code == nullptr || m_config.method_blocklist.count(method) != 0 ||
             method->rstate.no_optimizations()) {
+          if (m_config.collect_block_hashes) {
+            m_block_hash_index.update(method, {});
+          }
           return dedup_blocks_impl::Stats();
         }
 
@@ -43,12 +50,39 @@ void DedupBlocksPass::run_pass(DexStoresVector& stores,
 
         dedup_blocks_impl::DedupBlocks impl(&m_config, method);
         impl.run();
+        if (m_config.collect_block_hashes) {
+          m_block_hash_index.update(method, std::move(impl.get_block_hashes()));
+        }
 
         return impl.get_stats();
       },
       m_config.debug ? 1 : redex_parallel::default_num_threads());
 
   report_stats(mgr, stats);
+
+  if (m_config.collect_block_hashes) {
+    // Methods that were removed since an earlier run.
+    std::unordered_set<const DexMethod*> methods;
+    walk::methods(scope, [&](DexMethod* method) { methods.insert(method); });
+    m_block_hash_index.remove_if(
+        [&](const DexMethod* method) { return methods.count(method) == 0; });
+    report_block_hash_index(mgr);
+  }
+}
+
+void DedupBlocksPass::report_block_hash_index(PassManager& mgr) {
+  auto duplicates = m_block_hash_index.get_cross_method_duplicates();
+  size_t duplicate_insns = 0;
+  for (const auto& [_, occ] : duplicates) {
+    duplicate_insns += occ.num_opcodes * (occ.methods.size() - 1);
+  }
+  mgr.incr_metric(METRIC_BLOCK_HASH_INDEX_METHODS,
+                  m_block_hash_index.num_methods());
+  mgr.incr_metric(METRIC_CROSS_METHOD_DUPLICATE_BLOCKS, duplicates.size());
+  mgr.incr_metric(METRIC_CROSS_METHOD_DUPLICATE_INSNS, duplicate_insns);
+  TRACE(DEDUP_BLOCKS, 1,
+        "%zu blocks occur in more than one method, %zu redundant instructions",
+        duplicates.size(), duplicate_insns);
 }
 
 void DedupBlocksPass::report_stats(PassManager& mgr,
@@ -39,9 +39,23 @@ class DedupBlocksPass : public Pass {
     bind(
         "dedup_fill_in_stack_trace", false, m_config.dedup_fill_in_stack_trace);
     bind("max_iteration", 10, m_config.max_iteration);
+    bind("build_block_hash_index", false, m_config.collect_block_hashes,
+         "Maintain an index of canonical block hashes across all methods, and "
+         "report blocks that occur in more than one method.");
+    bind("block_hash_min_opcode_count",
+         dedup_blocks_impl::Config::DEFAULT_BLOCK_HASH_MIN_OPCODE_COUNT,
+         m_config.block_hash_min_opcode_count,
+         "Smallest block (in opcodes) to record in the block hash index.");
+  }
+
+  const dedup_blocks_impl::BlockHashIndex& get_block_hash_index() const {
+    return m_block_hash_index;
   }
 
  private:
   void report_stats(PassManager& mgr, const dedup_blocks_impl::Stats& stats);
+  void report_block_hash_index(PassManager& mgr);
   dedup_blocks_impl::Config m_config;
+  // Kept across runs of this pass, and updated for the methods of each run.
+  dedup_blocks_impl::BlockHashIndex m_block_hash_index;
 };
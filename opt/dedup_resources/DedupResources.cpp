@@ -10,6 +10,7 @@
 #include <boost/format.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/optional.hpp>
+#include <cstring>
 #include <fstream>
 #include <map>
 #include <unordered_set>
@@ -275,13 +276,19 @@ void compute_res_file_hashes(
   workqueue_run<std::string>(
       [&](sparta::WorkerState<std::string>* /* unused */, std::string path) {
         HashType hash = 31;
+        size_t file_size = 0;
         redex::read_file_with_contents(path,
                                        [&](const char* data, size_t size) {
                                          hash = hash_fn(data, size, hash);
+                                         file_size = size;
                                        });
+        // Fold the size into the bucket key, so that files which merely
+        // collide on the hash never need to be compared byte by byte.
+        size_t key = hash;
+        boost::hash_combine(key, file_size);
         {
           std::unique_lock<std::mutex> lock(out_mutex);
-          (*hash_to_absolute_paths)[hash].push_back(std::move(path));
+          (*hash_to_absolute_paths)[key].push_back(std::move(path));
         }
       },
       tasks,
@@ -289,29 +296,23 @@ void compute_res_file_hashes(
 }
 
 bool compare_files(const std::string& p1, const std::string& p2) {
-  std::ifstream f1(p1, std::ifstream::binary | std::ifstream::ate);
-  std::ifstream f2(p2, std::ifstream::binary | std::ifstream::ate);
-  always_assert_log(!f1.fail(), "Failed to read path %s", p1.c_str());
-  always_assert_log(!f2.fail(), "Failed to read path %s", p2.c_str());
-  if (f1.tellg() != f2.tellg()) {
-    return false; // size mismatch
-  }
-  // seek back to beginning and use std::equal to compare contents
-  f1.seekg(0, std::ifstream::beg);
-  f2.seekg(0, std::ifstream::beg);
-  return std::equal(std::istreambuf_iterator<char>(f1.rdbuf()),
-                    std::istreambuf_iterator<char>(),
-                    std::istreambuf_iterator<char>(f2.rdbuf()));
+  bool equal = false;
+  redex::read_file_with_contents(p1, [&](const char* data1, size_t size1) {
+    redex::read_file_with_contents(p2, [&](const char* data2, size_t size2) {
+      equal = size1 == size2 && std::memcmp(data1, data2, size1) == 0;
+    });
+  });
+  return equal;
 }
 
-void deduplicate_resource_files(PassManager& mgr, const std::string& zip_dir) {
-  auto resources = create_resource_reader(zip_dir);
-  auto res_table = resources->load_res_table();
-
+void deduplicate_resource_files(PassManager& mgr,
+                                const std::string& zip_dir,
+                                AndroidResources* resources,
+                                ResourceTableFile* res_table) {
   std::map<size_t, std::vector<std::string>> hash_to_absolute_paths;
   std::unordered_map<std::string, std::string> absolute_path_to_device_path;
   compute_res_file_hashes<uint32_t>(
-      zip_dir, res_table.get(), res_table->sorted_res_ids, murmur_hash3,
+      zip_dir, res_table, res_table->sorted_res_ids, murmur_hash3,
       &hash_to_absolute_paths, &absolute_path_to_device_path);
 
   std::unordered_set<std::string> do_not_deduplicate;
@@ -354,12 +355,10 @@ const std::unordered_set<std::string> SIMPLE_REFERENCE_TYPES = {
 
 void deduplicate_resource_file_references(
     PassManager& mgr,
-    const std::string& zip_dir,
+    AndroidResources* resources,
+    ResourceTableFile* res_table,
     const std::unordered_set<std::string>& disallowed_type_names,
     const std::unordered_set<uint32_t>& disallowed_ids) {
-  auto resources = create_resource_reader(zip_dir);
-  auto res_table = resources->load_res_table();
-
   bool allow_reference_dedup = false;
   std::vector<std::string> effective_disallowed_type_names;
   res_table->get_type_names(&effective_disallowed_type_names);
@@ -382,7 +381,7 @@ void deduplicate_resource_file_references(
     auto effective_disallowed_types =
         res_table->get_types_by_name(effective_disallowed_type_names);
     auto dupe_to_canon = find_duplicate_resources(
-        res_table.get(), res_table->sorted_res_ids, effective_disallowed_types,
+        res_table, res_table->sorted_res_ids, effective_disallowed_types,
         disallowed_ids, mgr);
     TRACE(DEDUP_RES, 2, "Found %zu xml references to canonicalize.",
           dupe_to_canon.size());
@@ -397,12 +396,9 @@ void deduplicate_resource_file_references(
 } // namespace
 
 void DedupResourcesPass::prepare_disallowed_ids(
-    const std::string& zip_dir,
+    ResourceTableFile* res_table,
     std::unordered_set<uint32_t>* disallowed_types,
     std::unordered_set<uint32_t>* disallowed_ids) {
-  auto resources = create_resource_reader(zip_dir);
-  auto res_table = resources->load_res_table();
-
   auto types = res_table->get_types_by_name(m_disallowed_types);
   disallowed_types->insert(types.begin(), types.end());
 
@@ -419,21 +415,31 @@ void DedupResourcesPass::run_pass(DexStoresVector& stores,
   conf.get_json_config().get("apk_dir", "", apk_dir);
   always_assert(!apk_dir.empty());
 
+  // Steps 1 through 3 only read the resource table until step 3 writes it
+  // out, so they share a single parse of it.
+  auto initial_resources = create_resource_reader(apk_dir);
+  auto initial_res_table = initial_resources->load_res_table();
+
   // 1. Basic information about what shoudln't be operate on.
   std::unordered_set<uint32_t> disallowed_types;
   std::unordered_set<uint32_t> disallowed_ids;
-  prepare_disallowed_ids(apk_dir, &disallowed_types, &disallowed_ids);
+  prepare_disallowed_ids(initial_res_table.get(), &disallowed_types,
+                         &disallowed_ids);
 
   // 2. Compute duplicates/canonical resource identifiers for some types which
   //    can be references in .xml files. This step is meant to increase the
   //    liklihood of finding identical files in the next step.
-  deduplicate_resource_file_references(mgr, apk_dir, m_disallowed_types,
-                                       disallowed_ids);
+  deduplicate_resource_file_references(mgr, initial_resources.get(),
+                                       initial_res_table.get(),
+                                       m_disallowed_types, disallowed_ids);
 
   // 3. Perform a deduplication of individual files, which may increase the
   //    number of res table rows identified as duplicates (by rewriting file
   //    paths to a canonical version of the file).
-  deduplicate_resource_files(mgr, apk_dir);
+  deduplicate_resource_files(mgr, apk_dir, initial_resources.get(),
+                             initial_res_table.get());
+  initial_res_table.reset();
+  initial_resources.reset();
 
   // 4. Re-parse the resource table data to ensure latest written changes are
   //    recognized (writes do not update any cached data in these APIs).
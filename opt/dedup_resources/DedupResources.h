@@ -10,6 +10,8 @@
 #include "Pass.h"
 #include "androidfw/ResourceTypes.h"
 
+class ResourceTableFile;
+
 /**
  * Finds resource identifiers whose metadata values are identical in all
  * configurations. Of a set of duplicates, the smallest resource identifier will
@@ -69,7 +71,7 @@ class DedupResourcesPass : public Pass {
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
 
  private:
-  void prepare_disallowed_ids(const std::string&,
+  void prepare_disallowed_ids(ResourceTableFile* res_table,
                               std::unordered_set<uint32_t>* disallowed_types,
                               std::unordered_set<uint32_t>* disallowed_ids);
 
@@ -15,6 +15,7 @@
 #include <iterator>
 #include <mutex>
 #include <string_view>
+#include <tuple>
 
 #include <boost/format.hpp>
 
@@ -250,6 +251,8 @@ is_traditional_access_method(const DexMethodRef* mref) {
 struct ProfileFile {
   RedexMappedFile mapped_file;
   std::string interaction;
+  // Offset of the first method line, right after the header.
+  size_t body_start;
 
   using StringPos = std::pair<size_t, size_t>;
 
@@ -266,26 +269,34 @@ struct ProfileFile {
 
   AccessMethods access_methods;
 
+  // The result of resolving a range of method lines. Ranges of one file are
+  // resolved independently and merged in file order, so the first line for a
+  // method still wins.
+  struct Part {
+    MethodMeta method_meta;
+    UnresolvedMethods unresolved_methods;
+    AccessMethods access_methods;
+  };
+
   ProfileFile(RedexMappedFile mapped_file,
               std::string interaction,
-              MethodMeta method_meta,
-              UnresolvedMethods unresolved_methods,
-              AccessMethods access_methods)
+              size_t body_start)
       : mapped_file(std::move(mapped_file)),
         interaction(std::move(interaction)),
-        method_meta(std::move(method_meta)),
-        unresolved_methods(std::move(unresolved_methods)),
-        access_methods(std::move(access_methods)) {}
+        body_start(body_start) {}
 
-  static std::unique_ptr<ProfileFile> prepare_profile_file(
+  std::string_view data() const {
+    return std::string_view{mapped_file.const_data(), mapped_file.size()};
+  }
+
+  // Maps the file and reads the header. Method lines are resolved separately
+  // with `split_body`, `resolve_lines` and `merge`.
+  static std::unique_ptr<ProfileFile> open_profile_file(
       const std::string& profile_file_name) {
     if (profile_file_name.empty()) {
       return std::unique_ptr<ProfileFile>();
     }
     auto file = RedexMappedFile::open(profile_file_name, /*read_only=*/true);
-    MethodMeta meta;
-    UnresolvedMethods unresolved_methods;
-    AccessMethods access_methods;
 
     std::string_view data{file.const_data(), file.size()};
     size_t pos = 0;
@@ -323,25 +334,56 @@ struct ProfileFile {
       check_components(next_line_fn(), 0, {"name", "profiled_srcblks_exprs"});
     }
 
-    while (pos < data.length()) {
+    return std::make_unique<ProfileFile>(std::move(file),
+                                         std::move(interaction), pos);
+  }
+
+  // Splits the method lines into ranges of roughly `chunk_size` bytes that
+  // start and end at line boundaries.
+  std::vector<std::pair<size_t, size_t>> split_body(size_t chunk_size) const {
+    auto d = data();
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t pos = body_start;
+    while (pos < d.length()) {
+      size_t end = pos + chunk_size;
+      if (end >= d.length()) {
+        end = d.length();
+      } else {
+        end = d.find('\n', end);
+        end = end == std::string::npos ? d.length() : end + 1;
+      }
+      ranges.emplace_back(pos, end);
+      pos = end;
+    }
+    return ranges;
+  }
+
+  Part resolve_lines(size_t begin, size_t end) const {
+    auto d = data();
+    Part part;
+    auto& meta = part.method_meta;
+    auto& unresolved_methods = part.unresolved_methods;
+    auto& access_methods = part.access_methods;
+    size_t pos = begin;
+    while (pos < end) {
       const size_t src_pos = pos;
 
       // Find the next '\n' or EOF.
-      size_t linefeed_pos = data.find('\n', src_pos);
+      size_t linefeed_pos = d.find('\n', src_pos);
       if (linefeed_pos == std::string::npos) {
-        linefeed_pos = data.length();
+        linefeed_pos = d.length();
       }
       pos = linefeed_pos + 1;
       // Do not use pos anymore! Ensure by scope from lambda.
-      [&data, &src_pos, &linefeed_pos, &meta, &unresolved_methods,
+      [&d, &src_pos, &linefeed_pos, &meta, &unresolved_methods,
        &access_methods]() {
-        size_t comma_pos = data.find(',', src_pos);
+        size_t comma_pos = d.find(',', src_pos);
         always_assert(comma_pos < linefeed_pos);
 
         auto string_pos =
             std::make_pair(comma_pos + 1, linefeed_pos - comma_pos - 1);
 
-        auto method_view = data.substr(src_pos, comma_pos - src_pos);
+        auto method_view = d.substr(src_pos, comma_pos - src_pos);
 
         if (auto access_val = is_traditional_access_method(method_view)) {
           auto* access_class = DexType::get_type(access_val->first);
@@ -372,14 +414,28 @@ struct ProfileFile {
         meta.emplace(mref, string_pos);
       }();
     }
+    return part;
+  }
 
-    return std::make_unique<ProfileFile>(
-        std::move(file), std::move(interaction), std::move(meta),
-        std::move(unresolved_methods), std::move(access_methods));
+  // Parts must be merged in file order.
+  void merge(Part&& part) {
+    if (method_meta.empty()) {
+      method_meta = std::move(part.method_meta);
+    } else {
+      method_meta.insert(part.method_meta.begin(), part.method_meta.end());
+    }
+    unresolved_methods.insert(part.unresolved_methods.begin(),
+                              part.unresolved_methods.end());
+    for (auto& [type, methods] : part.access_methods) {
+      access_methods[type].insert(methods.begin(), methods.end());
+    }
   }
 };
 
 struct Injector {
+  // Size of the line ranges profile files are resolved in.
+  static constexpr size_t kProfileChunkSize = 4 * 1024 * 1024;
+
   ConfigFiles& conf;
   std::vector<std::unique_ptr<ProfileFile>> profile_files;
   std::vector<std::string> interactions;
@@ -773,7 +829,33 @@ struct Injector {
 
       profile_files.resize(files.size());
       workqueue_run_for<size_t>(0, files.size(), [&](size_t i) {
-        profile_files.at(i) = ProfileFile::prepare_profile_file(files.at(i));
+        profile_files.at(i) = ProfileFile::open_profile_file(files.at(i));
+      });
+
+      // Resolve the method lines of all files at once, in line-aligned
+      // ranges. A single large profile (usually ColdStart) would otherwise
+      // keep one thread busy long after the others are done.
+      std::vector<std::tuple<size_t, size_t, size_t>> ranges;
+      std::vector<size_t> first_range(files.size() + 1);
+      for (size_t i = 0; i != files.size(); ++i) {
+        first_range[i] = ranges.size();
+        for (auto [begin, end] :
+             profile_files[i]->split_body(kProfileChunkSize)) {
+          ranges.emplace_back(i, begin, end);
+        }
+      }
+      first_range[files.size()] = ranges.size();
+
+      std::vector<ProfileFile::Part> parts(ranges.size());
+      workqueue_run_for<size_t>(0, ranges.size(), [&](size_t r) {
+        auto [i, begin, end] = ranges[r];
+        parts[r] = profile_files[i]->resolve_lines(begin, end);
+      });
+
+      workqueue_run_for<size_t>(0, files.size(), [&](size_t i) {
+        for (size_t r = first_range[i]; r != first_range[i + 1]; ++r) {
+          profile_files[i]->merge(std::move(parts[r]));
+        }
         TRACE(METH_PROF, 1, "Loaded basic block profile %s",
               profile_files.at(i)->interaction.c_str());
       });
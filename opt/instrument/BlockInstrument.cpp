@@ -10,6 +10,7 @@
 #include "ConfigFiles.h"
 #include "DexClass.h"
 #include "DexUtil.h"
+#include "Dominators.h"
 #include "GraphUtil.h"
 #include "Inliner.h"
 #include "LoopInfo.h"
@@ -55,6 +56,8 @@ enum class BlockType {
   Catch = 1 << 4,
   MoveException = 1 << 5,
   NoSourceBlock = 1 << 6,
+  // Control-equivalent to another block, whose bit covers its source blocks.
+  Equivalent = 1 << 7,
 };
 
 enum class InstrumentedType {
@@ -145,6 +148,14 @@ std::ostream& operator<<(std::ostream& os, const BlockType& bt) {
     written = true;
     type = type ^ BlockType::NoSourceBlock;
   }
+  if ((type & BlockType::Equivalent) == BlockType::Equivalent) {
+    if (written) {
+      os << ",";
+    }
+    os << "Equivalent";
+    written = true;
+    type = type ^ BlockType::Equivalent;
+  }
 
   if (type != BlockType::Unspecified) {
     if (written) {
@@ -182,7 +193,8 @@ struct BlockInfo {
         index_id(std::numeric_limits<size_t>::max()) {
     redex_assert(t == BlockType::Unspecified || t == BlockType::Empty ||
                  t == BlockType::Catch || t == BlockType::Useless ||
-                 (t & BlockType::NoSourceBlock) == BlockType::NoSourceBlock);
+                 (t & BlockType::NoSourceBlock) == BlockType::NoSourceBlock ||
+                 (t & BlockType::Equivalent) == BlockType::Equivalent);
   }
 
   BlockInfo(cfg::Block* b,
@@ -229,6 +241,7 @@ struct MethodInfo {
   size_t num_empty_blocks = 0;
   size_t num_useless_blocks = 0;
   size_t num_no_source_blocks = 0;
+  size_t num_equivalent_blocks = 0;
   size_t num_blocks_too_large = 0;
   size_t num_catches = 0;
   size_t num_instrumented_catches = 0;
@@ -253,6 +266,7 @@ struct MethodInfo {
     num_empty_blocks += rhs.num_empty_blocks;
     num_useless_blocks += rhs.num_useless_blocks;
     num_no_source_blocks += rhs.num_no_source_blocks;
+    num_equivalent_blocks += rhs.num_equivalent_blocks;
     num_blocks_too_large += rhs.num_blocks_too_large;
     num_catches += rhs.num_catches;
     num_instrumented_catches += rhs.num_instrumented_catches;
@@ -1084,8 +1098,149 @@ void create_block_info(
                                 BlockType::Instrumentable | type, insert_pos});
 }
 
+// The CFG with its edges reversed and a virtual exit (nullptr) that precedes
+// all blocks without successors. Its dominators are the CFG's postdominators.
+struct ReverseCfgInterface {
+  using Graph = cfg::ControlFlowGraph;
+  using NodeId = cfg::Block*;
+  using EdgeId = std::pair<NodeId, NodeId>;
+
+  static NodeId entry(const Graph&) { return nullptr; }
+
+  static std::vector<EdgeId> successors(const Graph& graph, NodeId node) {
+    std::vector<EdgeId> edges;
+    if (node == nullptr) {
+      for (auto* b : graph.blocks()) {
+        if (b->succs().empty()) {
+          edges.emplace_back(nullptr, b);
+        }
+      }
+      return edges;
+    }
+    for (auto* e : node->preds()) {
+      edges.emplace_back(node, e->src());
+    }
+    return edges;
+  }
+
+  static std::vector<EdgeId> predecessors(const Graph&, NodeId node) {
+    std::vector<EdgeId> edges;
+    if (node == nullptr) {
+      return edges;
+    }
+    if (node->succs().empty()) {
+      edges.emplace_back(nullptr, node);
+    }
+    for (auto* e : node->succs()) {
+      edges.emplace_back(e->target(), node);
+    }
+    return edges;
+  }
+
+  static NodeId source(const Graph&, const EdgeId& e) { return e.first; }
+  static NodeId target(const Graph&, const EdgeId& e) { return e.second; }
+};
+
+// Two blocks are control-equivalent when one dominates the other and is
+// postdominated by it: then, barring exceptions that leave the method, they
+// execute equally often, and a single bit (and hit counter) describes both.
+// This is the node-level counterpart of placing counters only off a spanning
+// tree: the merged blocks' source blocks are reported through the bit of the
+// dominating representative, so the metadata format does not change.
+//
+// Only normal (non-catch) blocks are merged. Blocks equivalent to the entry
+// block are returned, as method-begin tracking already covers them.
+std::vector<cfg::Block*> merge_control_equivalent_blocks(
+    cfg::ControlFlowGraph& cfg,
+    std::vector<BlockInfo>& block_info_list,
+    const std::unordered_map<const cfg::Block*, BlockInfo*>& block_mapping) {
+  std::vector<cfg::Block*> entry_merge_in;
+
+  dominators::SimpleFastDominators<cfg::GraphInterface> doms(cfg);
+  dominators::SimpleFastDominators<ReverseCfgInterface> pdoms(cfg);
+
+  // Number the postdominator tree so that ancestor queries are O(1). Blocks
+  // that cannot reach an exit are not in the tree and never merged.
+  std::unordered_map<cfg::Block*, std::vector<cfg::Block*>> pdom_children;
+  for (auto* b : graph::postorder_sort<ReverseCfgInterface>(cfg)) {
+    if (b != nullptr) {
+      pdom_children[pdoms.get_idom(b)].push_back(b);
+    }
+  }
+  std::unordered_map<cfg::Block*, std::pair<size_t, size_t>> pdom_interval;
+  {
+    size_t counter = 0;
+    std::vector<std::pair<cfg::Block*, bool>> stack{{nullptr, false}};
+    while (!stack.empty()) {
+      auto [b, done] = stack.back();
+      stack.pop_back();
+      if (done) {
+        pdom_interval[b].second = counter++;
+        continue;
+      }
+      pdom_interval[b].first = counter++;
+      stack.emplace_back(b, true);
+      auto it = pdom_children.find(b);
+      if (it != pdom_children.end()) {
+        for (auto* child : it->second) {
+          stack.emplace_back(child, false);
+        }
+      }
+    }
+  }
+  auto postdominates = [&](cfg::Block* a, cfg::Block* b) {
+    auto a_it = pdom_interval.find(a);
+    auto b_it = pdom_interval.find(b);
+    return a_it != pdom_interval.end() && b_it != pdom_interval.end() &&
+           a_it->second.first <= b_it->second.first &&
+           b_it->second.second <= a_it->second.second;
+  };
+
+  auto is_representative = [](const BlockInfo* info) {
+    return info->is_instrumentable() &&
+           (info->type & BlockType::Normal) == BlockType::Normal;
+  };
+
+  // Blocks are in DFS preorder, so dominators are decided before the blocks
+  // they dominate.
+  for (auto& info : block_info_list) {
+    if (!is_representative(&info)) {
+      continue;
+    }
+    auto* block = info.block;
+    for (auto* dom = doms.get_idom(block); dom != block;
+         block = dom, dom = doms.get_idom(dom)) {
+      if (!postdominates(info.block, dom)) {
+        continue;
+      }
+      auto it = block_mapping.find(dom);
+      if (it == block_mapping.end()) {
+        // The entry block, which is tracked by onMethodBegin.
+        always_assert(dom == cfg.entry_block());
+        entry_merge_in.push_back(info.block);
+        entry_merge_in.insert(entry_merge_in.end(), info.merge_in.begin(),
+                              info.merge_in.end());
+      } else if (is_representative(it->second)) {
+        auto& merge_in = it->second->merge_in;
+        merge_in.push_back(info.block);
+        merge_in.insert(merge_in.end(), info.merge_in.begin(),
+                        info.merge_in.end());
+      } else {
+        continue;
+      }
+      TRACE(INSTRUMENT, 9, "Block B%zu is control-equivalent to B%zu",
+            info.block->id(), dom->id());
+      info.merge_in.clear();
+      info.type = BlockType::Equivalent | BlockType::Normal;
+      info.it = std::nullopt;
+      break;
+    }
+  }
+  return entry_merge_in;
+}
+
 auto get_blocks_to_instrument(const DexMethod* m,
-                              const cfg::ControlFlowGraph& cfg,
+                              cfg::ControlFlowGraph& cfg,
                               const size_t max_num_blocks,
                               const InstrumentPass::Options& options) {
   // Collect basic blocks in the order of the source blocks (DFS).
@@ -1122,16 +1277,26 @@ auto get_blocks_to_instrument(const DexMethod* m,
     block_mapping[b] = &block_info_list.back();
   }
 
+  for (cfg::Block* b : blocks) {
+    create_block_info(m, b, options, block_mapping);
+  }
+
+  std::vector<cfg::Block*> entry_merge_in;
+  if (options.merge_control_equivalent_blocks) {
+    entry_merge_in =
+        merge_control_equivalent_blocks(cfg, block_info_list, block_mapping);
+  }
+
   BitId id = 0;
   size_t hit_id = 0;
   for (cfg::Block* b : blocks) {
-    create_block_info(m, b, options, block_mapping);
     auto* info = block_mapping[b];
     if ((info->type & BlockType::Instrumentable) == BlockType::Instrumentable) {
       if (id >= max_num_blocks) {
         // This is effectively rejecting all blocks.
         return std::make_tuple(std::vector<BlockInfo>{}, BitId(0), size_t(0),
-                               true /* too many block */);
+                               true /* too many block */,
+                               std::vector<cfg::Block*>{});
       }
 
       info->index_id = hit_id++;
@@ -1143,7 +1308,8 @@ auto get_blocks_to_instrument(const DexMethod* m,
       block_info_list.cbegin(), block_info_list.cend(),
       [](const auto& bi) { return bi.type != BlockType::Unspecified; }));
 
-  return std::make_tuple(block_info_list, id, hit_id, false);
+  return std::make_tuple(block_info_list, id, hit_id, false,
+                         std::move(entry_merge_in));
 }
 
 void insert_block_coverage_computations(const std::vector<BlockInfo>& blocks,
@@ -1250,8 +1416,9 @@ MethodInfo instrument_basic_blocks(
   size_t num_instrument_hit_blocks;
   size_t num_instrument_loop_blocks = 0;
   bool too_many_blocks;
+  std::vector<cfg::Block*> entry_merge_in;
   std::tie(blocks, num_to_instrument, num_instrument_hit_blocks,
-           too_many_blocks) =
+           too_many_blocks, entry_merge_in) =
       get_blocks_to_instrument(method, cfg, max_num_blocks, options);
 
   TRACE(INSTRUMENT, DEBUG_CFG ? 0 : 10, "BEFORE: %s, %s\n%s",
@@ -1293,6 +1460,13 @@ MethodInfo instrument_basic_blocks(
     }
   }
 
+  std::vector<SourceBlock*> entry_merged_source_blocks;
+  for (auto* b : entry_merge_in) {
+    auto sb_vec = source_blocks::gather_source_blocks(b);
+    entry_merged_source_blocks.insert(entry_merged_source_blocks.end(),
+                                      sb_vec.begin(), sb_vec.end());
+  }
+
   // Step 3: Insert onMethodBegin to track method execution, and bit-vector
   //         allocation code in its method entry point.
   //
@@ -1394,7 +1568,14 @@ MethodInfo instrument_basic_blocks(
         }
         return all;
       }()
-                      : source_blocks::gather_source_blocks(cfg.entry_block());
+                      : [&]() {
+                          auto entry = source_blocks::gather_source_blocks(
+                              cfg.entry_block());
+                          entry.insert(entry.end(),
+                                       entry_merged_source_blocks.begin(),
+                                       entry_merged_source_blocks.end());
+                          return entry;
+                        }();
   info.too_many_blocks = too_many_blocks;
   info.num_too_many_blocks = too_many_blocks ? 1 : 0;
   info.offset = method_offset;
@@ -1407,6 +1588,7 @@ MethodInfo instrument_basic_blocks(
   info.num_empty_blocks = count(BlockType::Empty);
   info.num_useless_blocks = count(BlockType::Useless);
   info.num_no_source_blocks = count(BlockType::NoSourceBlock);
+  info.num_equivalent_blocks = count(BlockType::Equivalent);
   info.num_blocks_too_large = too_many_blocks ? info.num_non_entry_blocks : 0;
   info.num_catches =
       count(BlockType::Catch) - count(BlockType::Catch | BlockType::Useless);
@@ -1433,7 +1615,8 @@ MethodInfo instrument_basic_blocks(
 
   const size_t num_rejected_blocks =
       info.num_empty_blocks + info.num_useless_blocks +
-      info.num_no_source_blocks + info.num_blocks_too_large +
+      info.num_no_source_blocks + info.num_equivalent_blocks +
+      info.num_blocks_too_large +
       (info.num_catches - info.num_instrumented_catches);
   always_assert(info.num_non_entry_blocks ==
                 info.num_instrumented_blocks + num_rejected_blocks);
@@ -1685,6 +1868,12 @@ void print_stats(ScopedMetrics& sm,
       TRACE(INSTRUMENT, 4, "- Skipped useless blocks: %s",
             SHOW(print_ratio(useless_blocks)));
       metric_ratio("useless_blocks", useless_blocks);
+      auto equivalent_blocks = std::accumulate(
+          instrumented_methods.begin(), instrumented_methods.end(), size_t(0),
+          [](size_t a, auto&& i) { return a + i.num_equivalent_blocks; });
+      TRACE(INSTRUMENT, 4, "- Skipped control-equivalent blocks: %s",
+            SHOW(print_ratio(equivalent_blocks)));
+      metric_ratio("equivalent_blocks", equivalent_blocks);
     }
   }
 
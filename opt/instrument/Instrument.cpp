@@ -144,6 +144,19 @@ void do_simple_method_tracing(DexClass* analysis_cls,
   // Write meta info of the meta file: the type of the meta file and version.
   ofs << "#,simple-method-tracing,1.0" << std::endl;
 
+  // Each method owns |stride| consecutive shorts of its shard array. Rounding
+  // the stride up to |method_stats_alignment| keeps the counters of different
+  // methods on different cache lines, so that methods updated concurrently by
+  // several threads don't contend on the same line. Decoders need the stride
+  // to untangle the arrays, so it is recorded whenever it isn't the default.
+  always_assert(options.method_stats_alignment > 0);
+  const size_t kStride =
+      (options.num_stats_per_method + options.method_stats_alignment - 1) /
+      options.method_stats_alignment * options.method_stats_alignment;
+  if (kStride != (size_t)options.num_stats_per_method) {
+    ofs << "#,layout," << NUM_SHARDS << "," << kStride << std::endl;
+  }
+
   size_t method_id = 0;
   size_t excluded = 0;
   std::unordered_set<std::string> method_names;
@@ -288,13 +301,14 @@ void do_simple_method_tracing(DexClass* analysis_cls,
   // Now we know the total number of methods to be instrumented. Do some
   // computations and actual instrumentation.
   const size_t kTotalSize = to_instrument.size();
-  TRACE(INSTRUMENT, 2, "%zu methods to be instrumented; shard size: %zu (+1)",
-        kTotalSize, kTotalSize / NUM_SHARDS);
+  TRACE(INSTRUMENT, 2,
+        "%zu methods to be instrumented; shard size: %zu (+1), stride: %zu",
+        kTotalSize, kTotalSize / NUM_SHARDS, kStride);
   for (size_t i = 0; i < kTotalSize; ++i) {
     TRACE(INSTRUMENT, 6, "Sharded %zu => [%zu][%zu] %s", i, (i % NUM_SHARDS),
           (i / NUM_SHARDS), SHOW(to_instrument[i]));
     instrument_onMethodBegin(to_instrument[i],
-                             (i / NUM_SHARDS) * options.num_stats_per_method,
+                             (i / NUM_SHARDS) * kStride,
                              analysis_method_map.at((i % NUM_SHARDS) + 1));
   }
 
@@ -309,8 +323,7 @@ void do_simple_method_tracing(DexClass* analysis_cls,
     size_t n = kTotalSize / NUM_SHARDS + (i < kTotalSize % NUM_SHARDS ? 1 : 0);
     // Get obfuscated name corresponding to each sMethodStat[1-N] field.
     const auto field_name = array_fields.at(i + 1)->get_name()->str();
-    InstrumentPass::patch_array_size(analysis_cls, field_name,
-                                     options.num_stats_per_method * n);
+    InstrumentPass::patch_array_size(analysis_cls, field_name, kStride * n);
   }
 
   // Patch method count constant.
@@ -524,6 +537,11 @@ void InstrumentPass::bind_config() {
        m_options.metadata_file_name);
   bind("num_stats_per_method", 1, m_options.num_stats_per_method);
   bind("num_shards", 1, m_options.num_shards);
+  bind("method_stats_alignment", 1, m_options.method_stats_alignment,
+       "Round the number of shorts each method owns in the method tracing "
+       "arrays up to a multiple of this. 32 gives every method its own 64-byte "
+       "cache line. Anything but 1 adds a '#,layout,<shards>,<stride>' line "
+       "to the metadata file.");
   // Note: only_cold_start_class is only used for block tracing.
   bind("only_cold_start_class", false, m_options.only_cold_start_class);
   bind("methods_replacement", {}, m_options.methods_replacement,
@@ -535,6 +553,12 @@ void InstrumentPass::bind_config() {
   bind("instrument_catches", true, m_options.instrument_catches);
   bind("instrument_blocks_without_source_block", true,
        m_options.instrument_blocks_without_source_block);
+  bind("merge_control_equivalent_blocks", false,
+       m_options.merge_control_equivalent_blocks,
+       "Only instrument one block of each set of control-equivalent blocks "
+       "and report the source blocks of the others through its bit. Reduces "
+       "the instrumentation overhead; exceptions leaving the method between "
+       "equivalent blocks are not modeled.");
   bind("instrument_only_root_store", false,
        m_options.instrument_only_root_store);
   bind("inline_onBlockHit", false, m_options.inline_onBlockHit);
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ClassReferencesAnalysisPass.h"
+
+#include "DexUtil.h"
+#include "PassManager.h"
+#include "Trace.h"
+
+void ClassReferencesAnalysisPass::run_pass(DexStoresVector& stores,
+                                           ConfigFiles& /* conf */,
+                                           PassManager& mgr) {
+  auto scope = build_class_scope(stores);
+  m_result = std::make_shared<ClassReferencesCache>(scope);
+  mgr.set_metric("classes", scope.size());
+}
+
+std::shared_ptr<ClassReferencesCache> ClassReferencesAnalysisPass::get_or_build(
+    const PassManager& mgr, const std::vector<DexClass*>& classes) {
+  auto* analysis = mgr.get_preserved_analysis<ClassReferencesAnalysisPass>();
+  if (analysis != nullptr && analysis->get_result() != nullptr) {
+    TRACE(IDEX, 2, "Reusing preserved class references");
+    return analysis->get_result();
+  }
+  return std::make_shared<ClassReferencesCache>(classes);
+}
+
+static ClassReferencesAnalysisPass s_pass;
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "ClassReferencesCache.h"
+#include "DexClass.h"
+#include "Pass.h"
+
+class PassManager;
+
+/*
+ * Gathers the references of all classes once, so that InterDex and the passes
+ * that later move classes between dexes (InterDexReshufflePass,
+ * DexRemovalPass, IntraDexClassMergingPass) don't each recompute them. The
+ * result stays alive for as long as every subsequent pass declares that it
+ * preserves this analysis; passes that only move classes between dexes do.
+ *
+ * Classes that are created while the analysis is preserved, e.g. canaries,
+ * are added to the cache on first use.
+ */
+class ClassReferencesAnalysisPass : public Pass {
+ public:
+  ClassReferencesAnalysisPass()
+      : Pass("ClassReferencesAnalysisPass", Pass::ANALYSIS) {}
+
+  redex_properties::PropertyInteractions get_property_interactions()
+      const override {
+    using namespace redex_properties::interactions;
+    using namespace redex_properties::names;
+    return {};
+  }
+
+  void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+
+  std::shared_ptr<ClassReferencesCache> get_result() { return m_result; }
+
+  void destroy_analysis_result() override { m_result = nullptr; }
+
+  // Returns the preserved cache if this analysis ran earlier and hasn't been
+  // invalidated since, and otherwise a fresh one, filled for `classes`.
+  static std::shared_ptr<ClassReferencesCache> get_or_build(
+      const PassManager& mgr, const std::vector<DexClass*>& classes);
+
+ private:
+  std::shared_ptr<ClassReferencesCache> m_result;
+};
@@ -139,6 +139,10 @@ void DexRemovalPass::run_pass(DexStoresVector& stores,
     sanity_check(oscope, stores, dex_removed);
   }
 
+  // Moving classes doesn't change their references, so they are gathered once
+  // for all rounds.
+  auto class_references_cache =
+      ClassReferencesAnalysisPass::get_or_build(mgr, /* classes */ {});
   while (true && m_class_reshuffle) {
     auto& root_store = stores.at(0);
     auto& root_dexen = root_store.get_dexen();
@@ -151,7 +155,8 @@ void DexRemovalPass::run_pass(DexStoresVector& stores,
     TRACE(IDEXR, 1, "current number of dex is %zu", root_dexen.size());
 
     ReshuffleConfig config;
-    InterDexReshuffleImpl impl(conf, mgr, config, original_scope, root_dexen);
+    InterDexReshuffleImpl impl(conf, mgr, config, original_scope, root_dexen,
+                               boost::none, class_references_cache);
     if (!impl.compute_dex_removal_plan()) {
       break;
     }
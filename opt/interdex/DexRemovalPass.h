@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include "AnalysisUsage.h"
+#include "ClassReferencesAnalysisPass.h"
 #include "ConfigFiles.h"
 #include "DexClass.h"
 #include "Pass.h"
@@ -29,6 +31,10 @@ class DexRemovalPass : public Pass {
     bind("class_reshuffle", false, m_class_reshuffle);
   }
 
+  void set_analysis_usage(AnalysisUsage& au) const override {
+    au.add_preserve_specific<ClassReferencesAnalysisPass>();
+  }
+
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
 
  private:
@@ -543,6 +543,35 @@ std::vector<std::vector<DexType*>> get_extra_classes_per_interdex_group(
   return res;
 }
 
+/**
+ * Returns the types whose initialization the class initializer of cls
+ * triggers directly, by accessing static members or creating instances.
+ */
+std::vector<DexType*> get_clinit_deps(const DexClass* cls) {
+  std::vector<DexType*> deps;
+  auto* clinit = cls->get_clinit();
+  if (clinit == nullptr || clinit->get_code() == nullptr) {
+    return deps;
+  }
+  auto* code = clinit->get_code();
+  always_assert(code->editable_cfg_built());
+  for (auto& mie : cfg::InstructionIterable(code->cfg())) {
+    auto* insn = mie.insn;
+    DexType* type = nullptr;
+    if (opcode::is_an_sfield_op(insn->opcode())) {
+      type = insn->get_field()->get_class();
+    } else if (insn->opcode() == OPCODE_INVOKE_STATIC) {
+      type = insn->get_method()->get_class();
+    } else if (insn->opcode() == OPCODE_NEW_INSTANCE) {
+      type = insn->get_type();
+    }
+    if (type != nullptr && type != cls->get_type()) {
+      deps.push_back(type);
+    }
+  }
+  return deps;
+}
+
 } // namespace
 
 void InterDex::load_interdex_types() {
@@ -658,6 +687,12 @@ void InterDex::load_interdex_types() {
               for (auto* intf : *cur_cls->get_interfaces()) {
                 self(self, intf, true);
               }
+              // Then what the class initializer initializes.
+              if (m_transitively_close_clinit_deps) {
+                for (auto* dep : get_clinit_deps(cur_cls)) {
+                  self(self, dep, true);
+                }
+              }
 
               // Then self.
               if (add_self) {
@@ -57,6 +57,7 @@ class InterDex {
            const init_classes::InitClassesWithSideEffects&
                init_classes_with_side_effects,
            bool transitively_close_interdex_order,
+           bool transitively_close_clinit_deps,
            int64_t minimize_cross_dex_refs_explore_alternatives,
            ClassReferencesCache& class_references_cache,
            bool exclude_baseline_profile_classes,
@@ -83,6 +84,7 @@ class InterDex {
         m_scope(build_class_scope(m_dexen)),
         m_xstore_refs(xstore_refs),
         m_transitively_close_interdex_order(transitively_close_interdex_order),
+        m_transitively_close_clinit_deps(transitively_close_clinit_deps),
         m_minimize_cross_dex_refs_explore_alternatives(
             minimize_cross_dex_refs_explore_alternatives),
         m_class_references_cache(class_references_cache),
@@ -255,6 +257,9 @@ class InterDex {
   size_t m_transitive_closure_added{0};
   size_t m_transitive_closure_moved{0};
   const bool m_transitively_close_interdex_order;
+  // When closing the interdex order, also pull in the classes that a
+  // <clinit> initializes, since they are loaded right along with the class.
+  const bool m_transitively_close_clinit_deps;
   const int64_t m_minimize_cross_dex_refs_explore_alternatives;
 
   ClassReferencesCache& m_class_references_cache;
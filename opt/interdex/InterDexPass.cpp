@@ -10,7 +10,9 @@
 #include "ConfigFiles.h"
 #include "DexClass.h"
 #include "DexUtil.h"
+#include "GlobalConfig.h"
 #include "JsonWrapper.h"
+#include "MethodStartupPageOrderer.h"
 #include "PassManager.h"
 #include "Show.h"
 #include "StlUtil.h"
@@ -34,6 +36,48 @@ void treat_generated_stores(DexStoresVector& stores,
   });
 }
 
+/**
+ * Estimate, for each profiled interaction, how many code pages its methods
+ * occupy across all dexes when code is emitted in class order. Each dex starts
+ * on a fresh page, so the per-dex estimates are simply added up.
+ */
+void report_startup_pages(ConfigFiles& conf,
+                          const DexClassesVector& dexen,
+                          PassManager& mgr) {
+  const auto& method_profiles = conf.get_method_profiles();
+  if (!method_profiles.is_initialized() || !method_profiles.has_stats()) {
+    return;
+  }
+  auto& global_config = conf.get_global_config();
+  double min_appear_percent = MethodProfileOrderingConfig().min_appear_percent;
+  if (global_config.has_config_by_name("method_profile_order")) {
+    min_appear_percent =
+        global_config
+            .get_config_by_name<MethodProfileOrderingConfig>(
+                "method_profile_order")
+            ->min_appear_percent;
+  }
+
+  std::vector<std::vector<const DexMethod*>> layouts(dexen.size());
+  for (size_t i = 0; i < dexen.size(); ++i) {
+    for (auto* cls : dexen[i]) {
+      layouts[i].insert(layouts[i].end(), cls->get_dmethods().begin(),
+                        cls->get_dmethods().end());
+      layouts[i].insert(layouts[i].end(), cls->get_vmethods().begin(),
+                        cls->get_vmethods().end());
+    }
+  }
+  for (const auto& [interaction_id, stats] :
+       method_profiles.all_interactions()) {
+    size_t pages = 0;
+    for (const auto& layout : layouts) {
+      pages += MethodStartupPageOrderer::estimate_pages(layout, stats,
+                                                        min_appear_percent);
+    }
+    mgr.set_metric("startup_pages." + interaction_id, pages);
+  }
+}
+
 } // namespace
 
 namespace interdex {
@@ -180,6 +224,8 @@ void InterDexPass::bind_config() {
 
   bind("transitively_close_interdex_order", m_transitively_close_interdex_order,
        m_transitively_close_interdex_order);
+  bind("transitively_close_clinit_deps", m_transitively_close_clinit_deps,
+       m_transitively_close_clinit_deps);
 
   bind("exclude_baseline_profile_classes", false,
        m_exclude_baseline_profile_classes);
@@ -219,6 +265,8 @@ void InterDexPass::run_pass(
                  m_minimize_cross_dex_refs_explore_alternatives);
   mgr.set_metric("config.transitively_close_interdex_order",
                  m_transitively_close_interdex_order);
+  mgr.set_metric("config.transitively_close_clinit_deps",
+                 m_transitively_close_clinit_deps);
 
   bool force_single_dex = conf.get_json_config().get("force_single_dex", false);
   mgr.set_metric("config.force_single_dex", force_single_dex);
@@ -230,7 +278,7 @@ void InterDexPass::run_pass(
       m_minimize_cross_dex_refs, m_fill_last_coldstart_dex,
       m_minimize_cross_dex_refs_config, refs_info, &xstore_refs,
       mgr.get_redex_options().min_sdk, init_classes_with_side_effects,
-      m_transitively_close_interdex_order,
+      m_transitively_close_interdex_order, m_transitively_close_clinit_deps,
       m_minimize_cross_dex_refs_explore_alternatives, cache,
       m_exclude_baseline_profile_classes, std::move(m_baseline_profile_config));
 
@@ -258,6 +306,7 @@ void InterDexPass::run_pass(
     mgr.set_metric(key_prefix + "background", info.background);
     mgr.set_metric(key_prefix + "betamap_ordered", info.betamap_ordered);
   }
+  report_startup_pages(conf, dexen, mgr);
 
   auto final_scope = build_class_scope(stores);
   for (const auto& plugin : plugins) {
@@ -324,6 +373,7 @@ void InterDexPass::run_pass_on_nonroot_store(
       /* fill_last_coldstart_dex=*/false, cross_dex_refs_config, refs_info,
       &xstore_refs, mgr.get_redex_options().min_sdk,
       init_classes_with_side_effects, m_transitively_close_interdex_order,
+      m_transitively_close_clinit_deps,
       m_minimize_cross_dex_refs_explore_alternatives, cache,
       m_exclude_baseline_profile_classes, std::move(m_baseline_profile_config));
 
@@ -353,13 +403,15 @@ void InterDexPass::run_pass(DexStoresVector& stores,
   ReserveRefsInfo refs_info = m_reserve_refs;
   refs_info += mgr.get_reserved_refs();
 
-  ClassReferencesCache cache(original_scope);
+  auto cache =
+      ClassReferencesAnalysisPass::get_or_build(mgr, original_scope);
 
   std::vector<DexStore*> parallel_stores;
   for (auto& store : stores) {
     if (store.is_root_store()) {
       run_pass(original_scope, xstore_refs, init_classes_with_side_effects,
-               stores, store.get_dexen(), plugins, conf, mgr, refs_info, cache);
+               stores, store.get_dexen(), plugins, conf, mgr, refs_info,
+               *cache);
     } else if (!store.is_generated()) {
       parallel_stores.push_back(&store);
     }
@@ -369,12 +421,18 @@ void InterDexPass::run_pass(DexStoresVector& stores,
       [&](DexStore* store) {
         run_pass_on_nonroot_store(
             original_scope, xstore_refs, init_classes_with_side_effects,
-            store->get_dexen(), conf, mgr, refs_info, cache);
+            store->get_dexen(), conf, mgr, refs_info, *cache);
         mgr.set_metric("nonroot_store." + store->get_name() + ".dexes",
                        store->get_dexen().size());
       },
       parallel_stores);
 
+  if (!plugins.empty()) {
+    // Plugin cleanups may have changed any class, and the cache is shared with
+    // later passes.
+    cache->clear();
+  }
+
   ++m_run;
   // For the last invocation, record that final interdex has been done.
   if (m_eval == m_run) {
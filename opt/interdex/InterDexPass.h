@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include "AnalysisUsage.h"
 #include "BaselineProfileConfig.h"
+#include "ClassReferencesAnalysisPass.h"
 #include "DexClass.h"
 #include "DexStructure.h"
 #include "InterDex.h"
@@ -87,6 +89,10 @@ class InterDexPass : public Pass {
     ++m_eval;
   }
 
+  void set_analysis_usage(AnalysisUsage& au) const override {
+    au.add_preserve_specific<ClassReferencesAnalysisPass>();
+  }
+
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
 
   bool minimize_cross_dex_refs() const { return m_minimize_cross_dex_refs; }
@@ -109,6 +115,7 @@ class InterDexPass : public Pass {
   bool m_expect_order_list;
   std::vector<std::string> m_methods_for_canary_clinit_reference;
   bool m_transitively_close_interdex_order{false};
+  bool m_transitively_close_clinit_deps{false};
   bool m_exclude_baseline_profile_classes;
   BaselineProfileConfig m_baseline_profile_config;
 
@@ -7,9 +7,12 @@
 
 #include "InterDexReshuffleImpl.h"
 #include "ClassMerging.h"
+#include "ClassReferencesAnalysisPass.h"
+#include "ClassReferencesCache.h"
 #include "InterDexPass.h"
 #include "Show.h"
 #include "Trace.h"
+#include "WorkQueue.h"
 #include <boost/algorithm/string/predicate.hpp>
 
 #include <algorithm>
@@ -59,7 +62,8 @@ InterDexReshuffleImpl::InterDexReshuffleImpl(
     ReshuffleConfig& config,
     DexClasses& original_scope,
     DexClassesVector& dexen,
-    const boost::optional<class_merging::Model&>& merging_model)
+    const boost::optional<class_merging::Model&>& merging_model,
+    std::shared_ptr<ClassReferencesCache> class_references_cache)
     : m_conf(conf),
       m_mgr(mgr),
       m_config(config),
@@ -114,16 +118,23 @@ InterDexReshuffleImpl::InterDexReshuffleImpl(
       m_class_dex_indices.emplace(cls, dex_index);
     }
   }
+  if (class_references_cache == nullptr) {
+    class_references_cache =
+        ClassReferencesAnalysisPass::get_or_build(mgr, /* classes */ {});
+  }
   walk::parallel::classes(classes, [&](DexClass* cls) {
     always_assert(m_class_refs.count(cls));
     auto& refs = m_class_refs.at(cls);
-    cls->gather_methods(refs.mrefs);
-    cls->gather_fields(refs.frefs);
-    cls->gather_types(refs.trefs);
-    std::vector<DexType*> itrefs;
-    cls->gather_init_classes(itrefs);
-    refs.itrefs.insert(itrefs.begin(), itrefs.end());
-    cls->gather_strings(refs.srefs);
+    // Gather the references the same way InterDex does, deduplicated once.
+    const auto& class_refs = class_references_cache->get(cls);
+    refs.mrefs.insert(class_refs.method_refs.begin(),
+                      class_refs.method_refs.end());
+    refs.frefs.insert(class_refs.field_refs.begin(),
+                      class_refs.field_refs.end());
+    refs.trefs.insert(class_refs.types.begin(), class_refs.types.end());
+    refs.itrefs.insert(class_refs.init_types.begin(),
+                       class_refs.init_types.end());
+    refs.srefs.insert(class_refs.strings.begin(), class_refs.strings.end());
   });
   workqueue_run_for<size_t>(
       m_first_dex_index, dexen.size(), [&](size_t dex_idx) {
@@ -290,33 +301,59 @@ void InterDexReshuffleImpl::compute_plan() {
     move_gains.recompute_gains();
     max_move_gains = std::max(max_move_gains, move_gains.size());
 
-    while (move_gains.moves_this_epoch() < m_config.max_batch_size) {
-      std::optional<Move> move_opt = move_gains.pop_max_gain();
-      if (!move_opt) {
-        break;
+    bool exhausted = false;
+    while (!exhausted &&
+           move_gains.moves_this_epoch() < m_config.max_batch_size) {
+      // Take the next best candidates and recompute their gains in parallel,
+      // speculating that no earlier candidate gets moved. A move only changes
+      // its source and target dex, so the speculative gain stays exact for
+      // candidates touching neither; the others get recomputed. This makes
+      // the plan identical to considering the candidates one at a time.
+      std::vector<Move> window;
+      while (window.size() < kSpeculationWindow) {
+        std::optional<Move> move_opt = move_gains.pop_max_gain();
+        if (!move_opt) {
+          exhausted = true;
+          break;
+        }
+        window.push_back(*move_opt);
       }
+      std::vector<gain_t> speculative_gains(window.size());
+      workqueue_run_for<size_t>(0, window.size(), [&](size_t i) {
+        speculative_gains[i] = recompute_gain(move_gains, window[i]);
+      });
 
-      const Move& move = *move_opt;
-      gain_t recomputed_gain = 0;
-      if (m_mergeability_aware) {
-        recomputed_gain = move_gains.compute_move_gain_after_merging(
-            move.cls, move.target_dex_index);
-      } else {
-        recomputed_gain =
-            move_gains.compute_move_gain(move.cls, move.target_dex_index);
-      }
-      if (recomputed_gain <= 0) {
-        continue;
-      }
+      std::unordered_set<size_t> changed_dexes;
+      for (size_t i = 0; i < window.size(); ++i) {
+        if (move_gains.moves_this_epoch() >= m_config.max_batch_size) {
+          break;
+        }
+        const Move& move = window[i];
+        if (move_gains.moved_this_epoch(move.cls)) {
+          continue;
+        }
+        auto source_dex_index = m_class_dex_indices.at(move.cls);
+        gain_t recomputed_gain =
+            changed_dexes.count(source_dex_index) ||
+                    changed_dexes.count(move.target_dex_index)
+                ? recompute_gain(move_gains, move)
+                : speculative_gains[i];
+        if (recomputed_gain <= 0) {
+          continue;
+        }
 
-      // Check if it is a valid move.
-      if (!try_plan_move(move, /*mergeability_aware=*/m_mergeability_aware)) {
-        continue;
-      }
-      if (traceEnabled(IDEXR, 5)) {
-        print_stats();
+        // Check if it is a valid move.
+        if (!try_plan_move(move,
+                           /*mergeability_aware=*/m_mergeability_aware)) {
+          continue;
+        }
+        changed_dexes.insert(source_dex_index);
+        changed_dexes.insert(move.target_dex_index);
+        if (traceEnabled(IDEXR, 5)) {
+          print_stats();
+        }
+        move_gains.moved_class(move);
       }
-      move_gains.moved_class(move);
     }
     total_moves += move_gains.moves_this_epoch();
     TRACE(IDEXR, 2, "executed %zu moves in epoch %zu",
@@ -334,6 +371,15 @@ void InterDexReshuffleImpl::compute_plan() {
   TRACE(IDEXR, 1, "executed %zu moves in %zu batches", total_moves, batches);
 }
 
+gain_t InterDexReshuffleImpl::recompute_gain(MoveGains& move_gains,
+                                             const Move& move) const {
+  if (m_mergeability_aware) {
+    return move_gains.compute_move_gain_after_merging(move.cls,
+                                                      move.target_dex_index);
+  }
+  return move_gains.compute_move_gain(move.cls, move.target_dex_index);
+}
+
 bool InterDexReshuffleImpl::compute_dex_removal_plan() {
   Timer t("compute_dex_removal_plan");
   std::unordered_map<size_t, bool> dex_eliminate;
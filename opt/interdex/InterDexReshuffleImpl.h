@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "ClassReferencesCache.h"
 #include "ConfigFiles.h"
 #include "DexClass.h"
 #include "DexStructure.h"
@@ -113,17 +114,19 @@ class MoveGains {
 
   void recompute_gains(size_t removal_dex = 0) {
     Timer t("recompute_gains");
-    m_gains_size = 0;
-    std::mutex mutex;
-    walk::parallel::classes(m_movable_classes, [&](DexClass* cls) {
+    // Gains are collected per class, without contention, and laid out in
+    // class order. (The heap order doesn't depend on it, see
+    // compare_indices_by_gains.)
+    std::vector<std::vector<Move>> class_gains(m_movable_classes.size());
+    workqueue_run_for<size_t>(0, m_movable_classes.size(), [&](size_t i) {
+      auto* cls = m_movable_classes[i];
+      if (!m_moved_classes.empty() && m_moved_classes.count(cls)) {
+        // In DexRemovalPass, if a class is already moved from the dex which
+        // is going to be eliminated, we won't move it again.
+        return;
+      }
       for (size_t dex_index = m_first_dex_index; dex_index < m_dexen.size();
            ++dex_index) {
-        if (!m_moved_classes.empty() && m_moved_classes.count(cls)) {
-          // In DexRemovalPass, if a class is already moved from the dex which
-          // is going to be eliminated, we won't move it again.
-          continue;
-        }
-
         if (dex_index == removal_dex) {
           // Won't move any class to the potential removed dex.
           continue;
@@ -140,14 +143,21 @@ class MoveGains {
           // In InterDexReshufflePass, we require gain > 0. For DexRemovalPass,
           // any gain is accepted to increase the possibility of make a dex
           // removable.
-          std::lock_guard<std::mutex> lock_guard(mutex);
-          if (m_gains_size == m_gains.size()) {
-            m_gains.resize(std::max((size_t)1024, m_gains_size * 2));
-          }
-          m_gains.at(m_gains_size++) = (Move){cls, gain, dex_index};
+          class_gains[i].push_back((Move){cls, gain, dex_index});
         }
       }
     });
+    m_gains_size = 0;
+    for (const auto& gains : class_gains) {
+      m_gains_size += gains.size();
+    }
+    if (m_gains.size() < m_gains_size) {
+      m_gains.resize(std::max((size_t)1024, m_gains_size * 2));
+    }
+    auto gains_it = m_gains.begin();
+    for (const auto& gains : class_gains) {
+      gains_it = std::copy(gains.begin(), gains.end(), gains_it);
+    }
 
     m_gains_heap_size = m_gains_size;
     if (m_gains_heap.size() < m_gains_heap_size) {
@@ -175,9 +185,7 @@ class MoveGains {
       const size_t gain_index = m_gains_heap.at(m_gains_heap_size);
       const auto& move = m_gains.at(gain_index);
 
-      auto it = m_move_epoch.find(move.cls);
-      if (it != m_move_epoch.end() && it->second >= m_epoch) {
-        // Class already moved.
+      if (moved_this_epoch(move.cls)) {
         continue;
       }
 
@@ -187,6 +195,11 @@ class MoveGains {
     return std::nullopt;
   }
 
+  bool moved_this_epoch(DexClass* cls) const {
+    auto it = m_move_epoch.find(cls);
+    return it != m_move_epoch.end() && it->second >= m_epoch;
+  }
+
   void moved_class(const Move& move) {
     size_t& class_epoch = m_move_epoch[move.cls];
     const bool was_moved_last_epoch = class_epoch == m_epoch - 1;
@@ -406,13 +419,17 @@ class MoveGains {
 
 class InterDexReshuffleImpl {
  public:
-  InterDexReshuffleImpl(ConfigFiles& conf,
-                        PassManager& mgr,
-                        ReshuffleConfig& config,
-                        DexClasses& original_scope,
-                        DexClassesVector& dexen,
-                        const boost::optional<class_merging::Model&>&
-                            merging_model = boost::none);
+  // The class references are taken from the given cache, or else from the
+  // preserved ClassReferencesAnalysisPass result, if any.
+  InterDexReshuffleImpl(
+      ConfigFiles& conf,
+      PassManager& mgr,
+      ReshuffleConfig& config,
+      DexClasses& original_scope,
+      DexClassesVector& dexen,
+      const boost::optional<class_merging::Model&>& merging_model =
+          boost::none,
+      std::shared_ptr<ClassReferencesCache> class_references_cache = nullptr);
 
   void compute_plan();
 
@@ -427,6 +444,11 @@ class InterDexReshuffleImpl {
 
   bool try_plan_move(const Move& move, bool mergeability_aware = false);
 
+  gain_t recompute_gain(MoveGains& move_gains, const Move& move) const;
+
+  // Number of candidate moves whose gains compute_plan recomputes at once.
+  static constexpr size_t kSpeculationWindow = 64;
+
   bool can_move(DexClass* cls);
 
   size_t get_eliminate_dex(
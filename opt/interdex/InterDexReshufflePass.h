@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include "AnalysisUsage.h"
+#include "ClassReferencesAnalysisPass.h"
 #include "DexClass.h"
 #include "InterDex.h"
 #include "InterDexReshuffleImpl.h"
@@ -56,6 +58,10 @@ class InterDexReshufflePass : public Pass {
     };
   }
 
+  void set_analysis_usage(AnalysisUsage& au) const override {
+    au.add_preserve_specific<ClassReferencesAnalysisPass>();
+  }
+
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
 
   void bind_config() override {
@@ -11,12 +11,14 @@
 #include "ConcurrentContainers.h"
 #include "Creators.h"
 #include "IRCode.h"
+#include "KotlinShapes.h"
 #include "LiveRange.h"
 #include "Mutators.h"
 #include "PassManager.h"
 #include "Show.h"
 #include "TypeInference.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 namespace {
 void dump_cls(DexClass* cls) {
@@ -34,32 +36,6 @@ void dump_cls(DexClass* cls) {
   }
 }
 
-// check if CLS is an inner class and return the outer class. Return nullptr if
-// this is not an inner class.
-DexClass* get_outer_class(const DexClass* cls) {
-  const auto cls_name = cls->get_name()->str();
-  auto cash_idx = cls_name.find_last_of('$');
-  if (cash_idx == std::string::npos) {
-    // this is not an inner class
-    return nullptr;
-  }
-  auto slash_idx = cls_name.find_last_of('/');
-  if (slash_idx == std::string::npos || slash_idx < cash_idx) {
-    // there's a $ in the class name
-    const std::string& outer_name = cls_name.substr(0, cash_idx) + ';';
-    DexType* outer = DexType::get_type(outer_name);
-    if (outer == nullptr) {
-      return nullptr;
-    }
-    DexClass* outer_cls = type_class(outer);
-    if (outer_cls == nullptr || outer_cls->is_external()) {
-      return nullptr;
-    }
-    return outer_cls;
-  }
-  return nullptr;
-}
-
 // Check if the method uses the first argument (i.e this pointer).
 // if strict == true, any use of this_reg will result in returning true.
 // if strict == false, if his_reg is used just to invoke virtual
@@ -163,41 +139,20 @@ bool is_valid_init(DexMethod* meth) {
 // 4. Outer (or parent) class may have <clinit> which create instance of this
 // (parent has sfield of inner class)
 // 5. CLS is final and extends J_L_O
+// Points 1-5 are checked by the ShapeIndex, which gives the outer class.
 // If this is a candidate, return outer class. Return nullptr otherwise.
-DexClass* candidate_for_companion_inlining(DexClass* cls) {
+DexClass* candidate_for_companion_inlining(DexClass* cls,
+                                           DexClass* outer_cls) {
   if (root(cls) || !can_rename(cls) || !can_delete(cls) ||
       cls->rstate.is_referenced_by_resource_xml() || cls->is_external()) {
     return nullptr;
   }
-  if (!is_final(cls) || !cls->get_ifields().empty() ||
-      !cls->get_interfaces()->empty() || cls->get_clinit() ||
-      !cls->get_sfields().empty() ||
-      cls->get_super_class() != type::java_lang_Object()) {
-    if (boost::ends_with(cls->get_name()->str(), "$Companion;")) {
-      TRACE(KOTLIN_OBJ_INLINE, 5, "Rejected $Companion cls = %s", SHOW(cls));
-    }
-    return nullptr;
-  }
-  DexClass* outer_cls = get_outer_class(cls);
 
   // Currently, we don't support companion class is in an abstract class.
-  if (!outer_cls || is_abstract(outer_cls)) {
+  if (is_abstract(outer_cls)) {
     return nullptr;
   }
 
-  bool found = false;
-  for (auto* sfield : outer_cls->get_sfields()) {
-    if (sfield->get_type() == cls->get_type()) {
-      if (found) {
-        // Expect only one sfield in outer class to hold companion object
-        // instance
-        TRACE(KOTLIN_OBJ_INLINE, 5, "Rejected cls = %s", SHOW(cls));
-        return nullptr;
-      }
-      found = true;
-    }
-  }
-
   for (auto meth : cls->get_vmethods()) {
     if (meth->rstate.no_optimizations() || !is_final(meth) ||
         !meth->get_code() || uses_this(meth)) {
@@ -374,17 +329,19 @@ void KotlinObjectInliner::run_pass(DexStoresVector& stores,
   }
 
   // Collect candidates
-  walk::parallel::classes(scope, [&](DexClass* cls) {
+  kotlin_shapes::ShapeIndex shapes(scope);
+  workqueue_run<DexClass*>([&](DexClass* cls) {
     if (do_not_inline_set.count(cls->get_type())) {
       return;
     }
-    auto outer_cls = candidate_for_companion_inlining(cls);
+    auto outer_cls = candidate_for_companion_inlining(
+        cls, shapes.get(cls).companion_outer_cls);
     if (outer_cls && !do_not_inline_set.count(outer_cls->get_type())) {
       // This is a candidate for inlining
       map.insert(std::make_pair(cls, outer_cls));
       TRACE(KOTLIN_OBJ_INLINE, 2, "Candidate cls : %s", SHOW(cls));
     }
-  });
+  }, shapes.companions());
   stats.kotlin_candidate_companion_objects = map.size();
 
   for (auto& iter : map) {
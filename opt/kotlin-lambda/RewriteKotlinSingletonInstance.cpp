@@ -107,8 +107,9 @@ void RewriteKotlinSingletonInstance::run_pass(DexStoresVector& stores,
     return init_for_type_has_side_effects(init_classes_with_side_effects, cls,
                                           safe_base_invoke);
   };
+  kotlin_shapes::ShapeIndex shapes(scope);
   KotlinInstanceRewriter::Stats stats = rewriter.collect_instance_usage(
-      scope, concurrentLambdaMap, do_not_consider_type);
+      shapes, concurrentLambdaMap, do_not_consider_type);
   stats += rewriter.remove_escaping_instance(scope, concurrentLambdaMap);
   stats += rewriter.transform(concurrentLambdaMap);
   stats.report(mgr);
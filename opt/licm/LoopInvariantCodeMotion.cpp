@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "LoopInvariantCodeMotion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ControlFlow.h"
+#include "DexClass.h"
+#include "IRCode.h"
+#include "IRInstruction.h"
+#include "IROpcode.h"
+#include "Liveness.h"
+#include "LoopInfo.h"
+#include "MethodUtil.h"
+#include "PassManager.h"
+#include "Resolver.h"
+#include "Show.h"
+#include "Trace.h"
+#include "Walkers.h"
+
+namespace {
+
+constexpr const char* METRIC_INSTRUCTIONS_HOISTED = "num_instructions_hoisted";
+constexpr const char* METRIC_METHODS_WITH_HOISTING = "num_methods_with_hoisting";
+
+// Neither throws nor has side effects, so it can be executed speculatively.
+bool is_pure(const IRInstruction* insn) {
+  auto op = insn->opcode();
+  if (opcode::can_throw(op) || opcode::has_side_effects(op)) {
+    return false;
+  }
+  return op == OPCODE_CONST || opcode::is_an_int_lit(op) ||
+         (OPCODE_NEG_INT <= op && op <= OPCODE_REM_DOUBLE);
+}
+
+// May throw, but always yields the same value for the same sources.
+bool reads_immutable_state(const DexMethod* method, const IRInstruction* insn) {
+  auto op = insn->opcode();
+  if (op == OPCODE_CONST_STRING || op == OPCODE_CONST_CLASS ||
+      op == OPCODE_ARRAY_LENGTH) {
+    return true;
+  }
+  if (!opcode::is_an_iget(op) && !opcode::is_an_sget(op)) {
+    return false;
+  }
+  // Final fields are still being written in constructors.
+  if (method::is_constructor(method)) {
+    return false;
+  }
+  auto* field = resolve_field(insn->get_field(), opcode::is_an_sget(op)
+                                                     ? FieldSearch::Static
+                                                     : FieldSearch::Instance);
+  return field != nullptr && is_final(field) && !is_volatile(field);
+}
+
+// The blocks of `loop`, including the preheaders LoopInfo created for its
+// subloops, which LoopInfo does not count as part of any loop.
+std::vector<cfg::Block*> get_loop_blocks(loop_impl::Loop* loop) {
+  std::vector<cfg::Block*> blocks = loop->get_blocks();
+  std::vector<loop_impl::Loop*> work{loop};
+  while (!work.empty()) {
+    auto* current = work.back();
+    work.pop_back();
+    for (auto it = current->subloop_begin(); it != current->subloop_end();
+         ++it) {
+      blocks.push_back((*it)->get_preheader());
+      work.push_back(*it);
+    }
+  }
+  return blocks;
+}
+
+size_t process_loop(const DexMethod* method,
+                    cfg::ControlFlowGraph& cfg,
+                    loop_impl::Loop* loop,
+                    const LivenessFixpointIterator& liveness) {
+  auto* header = loop->get_header();
+  auto* preheader = loop->get_preheader();
+  if (header == cfg.entry_block() || preheader->preds().empty() ||
+      !cfg.get_pred_edges_of_type(preheader, cfg::EDGE_THROW).empty()) {
+    return 0;
+  }
+  auto blocks = get_loop_blocks(loop);
+  // LoopInfo also reports irreducible cycles, which can be entered without
+  // passing the preheader.
+  std::unordered_set<const cfg::Block*> block_set(blocks.begin(), blocks.end());
+  for (auto* block : blocks) {
+    for (auto* edge : block->preds()) {
+      if (!block_set.count(edge->src()) &&
+          !(block == header && edge->src() == preheader)) {
+        return 0;
+      }
+    }
+  }
+
+  // How often each register is written in the loop.
+  std::unordered_map<reg_t, size_t> writes;
+  for (auto* block : blocks) {
+    for (auto& mie : InstructionIterable(block)) {
+      auto* insn = mie.insn;
+      if (insn->has_dest()) {
+        writes[insn->dest()]++;
+        if (insn->dest_is_wide()) {
+          writes[insn->dest() + 1]++;
+        }
+      }
+    }
+  }
+  auto is_written = [&](reg_t reg) {
+    auto it = writes.find(reg);
+    return it != writes.end() && it->second != 0;
+  };
+
+  const auto& live_in_header = liveness.get_live_in_vars_at(header);
+  bool header_may_throw_to_handler =
+      cfg.get_succ_edge_of_type(header, cfg::EDGE_THROW) != nullptr;
+
+  // Instructions to hoist, in an order that respects their dependencies.
+  std::vector<std::pair<cfg::Block*, IRInstruction*>> hoisted;
+  std::unordered_set<const IRInstruction*> hoisted_set;
+  bool changed;
+  do {
+    changed = false;
+    for (auto* block : blocks) {
+      // Whether something observable may already have happened in this
+      // iteration before the current instruction.
+      bool barrier = block != header || header_may_throw_to_handler;
+      auto ii = InstructionIterable(block);
+      for (auto it = ii.begin(); it != ii.end(); ++it) {
+        auto* insn = it->insn;
+        if (opcode::is_a_move_result_pseudo(insn->opcode())) {
+          continue;
+        }
+        if (hoisted_set.count(insn)) {
+          continue;
+        }
+        bool pure = is_pure(insn);
+        bool candidate =
+            pure || (!barrier && reads_immutable_state(method, insn));
+        if (candidate) {
+          auto* dest_insn = insn;
+          if (insn->has_move_result_pseudo()) {
+            auto next = std::next(it);
+            always_assert(next != ii.end());
+            dest_insn = next->insn;
+          }
+          auto dest = dest_insn->dest();
+          candidate = !dest_insn->dest_is_wide() && writes[dest] == 1 &&
+                      !live_in_header.contains(dest);
+          for (size_t i = 0; candidate && i < insn->srcs_size(); i++) {
+            candidate = !insn->src_is_wide(i) && !is_written(insn->src(i));
+          }
+          if (candidate) {
+            writes[dest]--;
+            hoisted.emplace_back(block, insn);
+            hoisted_set.insert(insn);
+            changed = true;
+            continue;
+          }
+        }
+        if (!pure) {
+          barrier = true;
+        }
+      }
+    }
+  } while (changed);
+
+  for (auto& [block, insn] : hoisted) {
+    auto it = block->to_cfg_instruction_iterator(
+        std::find_if(block->begin(), block->end(), [insn = insn](auto& mie) {
+          return mie.type == MFLOW_OPCODE && mie.insn == insn;
+        }));
+    std::vector<IRInstruction*> insns{new IRInstruction(*insn)};
+    if (insn->has_move_result_pseudo()) {
+      insns.push_back(new IRInstruction(*cfg.move_result_of(it)->insn));
+    }
+    TRACE(LOOP, 3, "[licm] hoisting %s out of a loop in %s", SHOW(insn),
+          SHOW(method));
+    preheader->push_back(insns);
+    cfg.remove_insn(it);
+  }
+  return hoisted.size();
+}
+
+} // namespace
+
+size_t LoopInvariantCodeMotionPass::process_cfg(const DexMethod* method,
+                                                cfg::ControlFlowGraph& cfg) {
+  {
+    // Don't let LoopInfo add preheaders to methods without loops.
+    loop_impl::LoopInfo probe(std::as_const(cfg));
+    if (probe.num_loops() == 0) {
+      return 0;
+    }
+  }
+  loop_impl::LoopInfo loop_info(cfg);
+  LivenessFixpointIterator liveness(cfg);
+  liveness.run(LivenessDomain());
+
+  size_t hoisted = 0;
+  // Innermost loops first, so that what they hoist can move further out.
+  for (auto it = loop_info.rbegin(); it != loop_info.rend(); ++it) {
+    hoisted += process_loop(method, cfg, &*it, liveness);
+  }
+  return hoisted;
+}
+
+void LoopInvariantCodeMotionPass::run_pass(DexStoresVector& stores,
+                                           ConfigFiles& /* unused */,
+                                           PassManager& mgr) {
+  auto scope = build_class_scope(stores);
+  std::atomic<size_t> methods_with_hoisting{0};
+  size_t hoisted = walk::parallel::methods<size_t>(
+      scope, [&](DexMethod* method) -> size_t {
+        auto* code = method->get_code();
+        if (!code || method->rstate.no_optimizations()) {
+          return 0;
+        }
+        always_assert(code->editable_cfg_built());
+        size_t res = process_cfg(method, code->cfg());
+        if (res != 0) {
+          methods_with_hoisting++;
+        }
+        return res;
+      });
+  mgr.incr_metric(METRIC_INSTRUCTIONS_HOISTED, hoisted);
+  mgr.incr_metric(METRIC_METHODS_WITH_HOISTING, methods_with_hoisting.load());
+}
+
+static LoopInvariantCodeMotionPass s_pass;
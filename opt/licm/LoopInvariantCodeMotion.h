@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include "Pass.h"
+
+class DexMethod;
+
+namespace cfg {
+class ControlFlowGraph;
+} // namespace cfg
+
+/*
+ * Hoists loop-invariant instructions into the preheader of their loop, using
+ * the loops found by service/loop-info.
+ *
+ * Instructions that can neither throw nor have side effects (constants,
+ * arithmetic) are hoisted from anywhere in the loop. Instructions that may
+ * throw but only read immutable state (const-string, const-class,
+ * array-length, and loads of final fields) are hoisted only from the loop
+ * header, before anything observable happens in an iteration, and only when
+ * the header is not covered by a try region. An instruction is invariant if
+ * none of its sources are written in the loop. Its destination must be written
+ * only by it, and must not be live into the loop header.
+ */
+class LoopInvariantCodeMotionPass : public Pass {
+ public:
+  LoopInvariantCodeMotionPass() : Pass("LoopInvariantCodeMotionPass") {}
+
+  redex_properties::PropertyInteractions get_property_interactions()
+      const override {
+    using namespace redex_properties::interactions;
+    using namespace redex_properties::names;
+    return {
+        {DexLimitsObeyed, Preserves},
+        {NoInitClassInstructions, Preserves},
+        {NoUnreachableInstructions, Preserves},
+        {NoResolvablePureRefs, Preserves},
+        {RenameClass, Preserves},
+    };
+  }
+
+  void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+
+  // Returns the number of hoisted instructions.
+  static size_t process_cfg(const DexMethod* method, cfg::ControlFlowGraph&);
+};
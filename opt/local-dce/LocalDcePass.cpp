@@ -15,6 +15,7 @@
 
 #include "ConfigFiles.h"
 #include "ControlFlow.h"
+#include "CopyPropagation.h"
 #include "DexClass.h"
 #include "DexUtil.h"
 #include "GraphUtil.h"
@@ -25,6 +26,7 @@
 #include "PassManager.h"
 #include "Purity.h"
 #include "Resolver.h"
+#include "ScopedCFG.h"
 #include "StlUtil.h"
 #include "Trace.h"
 #include "Transform.h"
@@ -53,6 +55,30 @@ constexpr const char* METRIC_INIT_CLASS_INSTRUCTIONS_REMOVED =
     "num_init_class_instructions_removed";
 constexpr const char* METRIC_INIT_CLASS_INSTRUCTIONS_REFINED =
     "num_init_class_instructions_refined";
+constexpr const char* METRIC_REDUNDANT_MOVES_ELIMINATED =
+    "redundant_moves_eliminated";
+constexpr const char* METRIC_SOURCE_REGS_REPLACED =
+    "source_regs_replaced_with_representative";
+
+// Copy propagation rarely finds anything new after the second round.
+constexpr size_t MAX_COPY_PROPAGATION_ROUNDS = 4;
+
+struct CombinedStats {
+  LocalDce::Stats dce;
+  copy_propagation_impl::Stats copy_propagation;
+
+  CombinedStats& operator+=(const CombinedStats& that) {
+    dce += that.dce;
+    copy_propagation += that.copy_propagation;
+    return *this;
+  }
+};
+
+size_t num_removed(const LocalDce::Stats& stats) {
+  return stats.npe_instruction_count + stats.dead_instruction_count +
+         stats.unreachable_instruction_count +
+         stats.init_classes.init_class_instructions_removed;
+}
 
 } // namespace
 
@@ -67,9 +93,10 @@ void LocalDcePass::run_pass(DexStoresVector& stores,
                       configured_pure_methods.end());
   auto immutable_getters = get_immutable_getters(scope);
   pure_methods.insert(immutable_getters.begin(), immutable_getters.end());
-  std::unique_ptr<const method_override_graph::Graph> override_graph;
+  std::shared_ptr<const method_override_graph::Graph> override_graph;
   if (!mgr.unreliable_virtual_scopes()) {
-    override_graph = method_override_graph::build_graph(scope);
+    override_graph =
+        MethodOverrideGraphAnalysisPass::get_or_build(mgr, scope);
   }
   std::unique_ptr<init_classes::InitClassesWithSideEffects>
       init_classes_with_side_effects;
@@ -87,10 +114,13 @@ void LocalDcePass::run_pass(DexStoresVector& stores,
           return !init_classes_with_side_effects ||
                  !init_classes_with_side_effects->refine(type);
         };
+    const std::string summary_cache_context =
+        init_classes_with_side_effects ? "init_classes" : "";
     computed_no_side_effects_methods_iterations =
         compute_no_side_effects_methods(
             scope, override_graph.get(), clinit_has_no_side_effects,
-            pure_methods, &computed_no_side_effects_methods);
+            pure_methods, &computed_no_side_effects_methods,
+            &summary_cache_context);
     for (auto m : computed_no_side_effects_methods) {
       pure_methods.insert(const_cast<DexMethod*>(m));
     }
@@ -118,18 +148,47 @@ void LocalDcePass::run_pass(DexStoresVector& stores,
     });
   }
 
-  auto stats =
-      walk::parallel::methods<LocalDce::Stats>(scope, [&](DexMethod* m) {
+  m_copy_propagation_config.regalloc_has_run = mgr.regalloc_has_run();
+  copy_propagation_impl::CopyPropagation copy_propagation(
+      m_copy_propagation_config);
+
+  auto combined_stats =
+      walk::parallel::methods<CombinedStats>(scope, [&](DexMethod* m) {
+        CombinedStats method_stats;
         auto* code = m->get_code();
         if (code == nullptr || m->rstate.no_optimizations()) {
-          return LocalDce::Stats();
+          return method_stats;
         }
 
-        LocalDce ldce(init_classes_with_side_effects.get(), pure_methods,
-                      override_graph.get(), may_allocate_registers);
-        ldce.dce(code, /* normalize_new_instances */ true, m->get_class());
-        return ldce.get_stats();
+        // Both transformations work on the same CFG, which is only built
+        // (and later linearized) once if it wasn't already.
+        cfg::ScopedCFG scoped_cfg(code);
+        size_t rounds = m_copy_propagation ? MAX_COPY_PROPAGATION_ROUNDS : 1;
+        for (size_t round = 0; round < rounds; ++round) {
+          if (m_copy_propagation) {
+            method_stats.copy_propagation += copy_propagation.run(code, m);
+          }
+          LocalDce ldce(init_classes_with_side_effects.get(), pure_methods,
+                        override_graph.get(), may_allocate_registers);
+          ldce.dce(*scoped_cfg, /* normalize_new_instances */ true,
+                   m->get_class());
+          method_stats.dce += ldce.get_stats();
+          // Removing instructions may kill definitions that prevented
+          // registers from being aliased; otherwise, there is nothing new for
+          // copy propagation to find.
+          if (num_removed(ldce.get_stats()) == 0) {
+            break;
+          }
+        }
+        return method_stats;
       });
+  const auto& stats = combined_stats.dce;
+  if (m_copy_propagation) {
+    mgr.incr_metric(METRIC_REDUNDANT_MOVES_ELIMINATED,
+                    combined_stats.copy_propagation.moves_eliminated);
+    mgr.incr_metric(METRIC_SOURCE_REGS_REPLACED,
+                    combined_stats.copy_propagation.replaced_sources);
+  }
   mgr.incr_metric(METRIC_NPE_INSTRUCTIONS, stats.npe_instruction_count);
   mgr.incr_metric(METRIC_INIT_CLASS_INSTRUCTIONS_ADDED,
                   stats.init_class_instructions_added);
@@ -7,7 +7,10 @@
 
 #pragma once
 
+#include "AnalysisUsage.h"
+#include "CopyPropagation.h"
 #include "LocalDce.h"
+#include "MethodOverrideGraphAnalysisPass.h"
 #include "Pass.h"
 
 class LocalDcePass : public Pass {
@@ -29,5 +32,23 @@ class LocalDcePass : public Pass {
     };
   }
 
+  bool supports_incremental_cache() const override { return true; }
+
+  void bind_config() override {
+    bind("copy_propagation", false, m_copy_propagation,
+         "Run copy propagation on each method before eliminating dead code, "
+         "and iterate the two on the same CFG until neither makes progress. "
+         "This replaces scheduling CopyPropagationPass right before this "
+         "pass.");
+  }
+
+  void set_analysis_usage(AnalysisUsage& au) const override {
+    au.add_preserve_specific<MethodOverrideGraphAnalysisPass>();
+  }
+
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+
+ private:
+  bool m_copy_propagation{false};
+  copy_propagation_impl::Config m_copy_propagation_config;
 };
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "MethodOverrideGraphAnalysisPass.h"
+
+#include "DexUtil.h"
+#include "PassManager.h"
+#include "Trace.h"
+
+void MethodOverrideGraphAnalysisPass::run_pass(DexStoresVector& stores,
+                                               ConfigFiles& /* conf */,
+                                               PassManager& mgr) {
+  auto scope = build_class_scope(stores);
+  m_result = method_override_graph::build_graph(scope);
+  mgr.set_metric("nodes", m_result->nodes().size());
+}
+
+std::shared_ptr<const method_override_graph::Graph>
+MethodOverrideGraphAnalysisPass::get_or_build(const PassManager& mgr,
+                                              const Scope& scope) {
+  auto* analysis =
+      mgr.get_preserved_analysis<MethodOverrideGraphAnalysisPass>();
+  if (analysis != nullptr && analysis->get_result() != nullptr) {
+    TRACE(PM, 2, "Reusing preserved method override graph");
+    return analysis->get_result();
+  }
+  return method_override_graph::build_graph(scope);
+}
+
+static MethodOverrideGraphAnalysisPass s_pass;
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "DexClass.h"
+#include "MethodOverrideGraph.h"
+#include "Pass.h"
+
+class PassManager;
+
+/*
+ * Builds the method override graph once, so that it can be shared by the
+ * passes that follow. The result stays alive for as long as every subsequent
+ * pass declares that it preserves this analysis; a pass that does not (the
+ * default for transformation passes) invalidates it.
+ *
+ * Passes that only rewrite method bodies don't change the override graph and
+ * should preserve it, and pick it up through `get_or_build`.
+ */
+class MethodOverrideGraphAnalysisPass : public Pass {
+ public:
+  MethodOverrideGraphAnalysisPass()
+      : Pass("MethodOverrideGraphAnalysisPass", Pass::ANALYSIS) {}
+
+  redex_properties::PropertyInteractions get_property_interactions()
+      const override {
+    using namespace redex_properties::interactions;
+    using namespace redex_properties::names;
+    return {};
+  }
+
+  void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+
+  std::shared_ptr<const method_override_graph::Graph> get_result() {
+    return m_result;
+  }
+
+  void destroy_analysis_result() override { m_result = nullptr; }
+
+  // Returns the preserved graph if this analysis ran earlier and hasn't been
+  // invalidated since, and otherwise builds a fresh one over `scope`.
+  static std::shared_ptr<const method_override_graph::Graph> get_or_build(
+      const PassManager& mgr, const Scope& scope);
+
+ private:
+  std::shared_ptr<const method_override_graph::Graph> m_result;
+};
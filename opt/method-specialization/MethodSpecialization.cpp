@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "MethodSpecialization.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "CallSiteSummaries.h"
+#include "ConfigFiles.h"
+#include "ControlFlow.h"
+#include "DexStore.h"
+#include "IPConstantPropagationAnalysis.h"
+#include "IRCode.h"
+#include "IRInstruction.h"
+#include "InitClassesWithSideEffects.h"
+#include "MethodProfiles.h"
+#include "MethodUtil.h"
+#include "PassManager.h"
+#include "ReachableClasses.h"
+#include "Resolver.h"
+#include "Show.h"
+#include "Shrinker.h"
+#include "Trace.h"
+#include "Walkers.h"
+#include "WorkQueue.h"
+
+using namespace inliner;
+
+namespace {
+
+constexpr const char* METRIC_HOT_CALLERS = "num_hot_callers";
+constexpr const char* METRIC_SPECIALIZED_METHODS = "num_specialized_methods";
+constexpr const char* METRIC_REJECTED_SPECIALIZATIONS =
+    "num_rejected_specializations";
+constexpr const char* METRIC_RETARGETED_INVOKES = "num_retargeted_invokes";
+constexpr const char* METRIC_ADDED_CODE_UNITS = "num_added_code_units";
+
+DexMethod* get_callee(DexMethod* caller, IRInstruction* insn) {
+  auto op = insn->opcode();
+  if (!opcode::is_invoke_static(op) && !opcode::is_invoke_direct(op)) {
+    return nullptr;
+  }
+  auto* callee = resolve_method(insn->get_method(), opcode_to_search(insn),
+                                caller);
+  if (callee == nullptr || callee->is_external() ||
+      method::is_init(callee) || method::is_clinit(callee) ||
+      callee->get_code() == nullptr || callee->rstate.no_optimizations()) {
+    return nullptr;
+  }
+  auto* cls = type_class(callee->get_class());
+  // We add the specializations next to the callee, so the class must not be
+  // accessed via reflection.
+  if (cls == nullptr || cls->is_external() || is_interface(cls) ||
+      !can_rename(cls)) {
+    return nullptr;
+  }
+  return callee;
+}
+
+// Only numeric constants, null, and nullness or sign facts are supported.
+bool filter(const ConstantValue& value) {
+  return value.maybe_get<SignedConstantDomain>() != boost::none;
+}
+
+struct Candidate {
+  DexMethod* callee;
+  CallSiteArguments arguments;
+  std::string key;
+  size_t call_sites;
+  std::unique_ptr<IRCode> code;
+  uint32_t code_units{0};
+};
+
+} // namespace
+
+namespace method_specialization {
+
+Stats specialize(const Scope& scope,
+                 shrinker::Shrinker& shrinker,
+                 const std::unordered_set<DexMethod*>& hot_callers,
+                 const Config& config) {
+  ConcurrentMethodToMethodOccurrences callee_caller;
+  ConcurrentMethodToMethodOccurrences caller_callee;
+  walk::parallel::code(scope, [&](DexMethod* caller, IRCode& code) {
+    if (!hot_callers.count(caller) || caller->rstate.no_optimizations()) {
+      return;
+    }
+    always_assert(code.editable_cfg_built());
+    for (auto& mie : InstructionIterable(code.cfg())) {
+      if (auto* callee = get_callee(caller, mie.insn)) {
+        callee_caller.update(callee, [&](auto*, auto& callers, bool) {
+          callers[caller]++;
+        });
+        caller_callee.update(caller, [&](auto*, auto& callees, bool) {
+          callees[callee]++;
+        });
+      }
+    }
+  });
+
+  // Other call-sites are assumed everywhere, so that the summaries only
+  // reflect what the hot callers pass.
+  auto has_callee_other_call_sites_fn = [](DexMethod*) { return true; };
+  std::function<bool(const ConstantValue&)> filter_fn = filter;
+  CallSiteSummaryStats call_site_summarizer_stats;
+  CallSiteSummarizer call_site_summarizer(
+      shrinker, callee_caller, caller_callee, get_callee,
+      has_callee_other_call_sites_fn, &filter_fn, &call_site_summarizer_stats);
+  call_site_summarizer.summarize();
+
+  std::vector<const DexMethod*> callees;
+  for (auto& [callee, _] : callee_caller) {
+    callees.push_back(callee);
+  }
+  std::sort(callees.begin(), callees.end(), compare_dexmethods);
+
+  std::vector<Candidate> candidates;
+  for (auto* callee : callees) {
+    auto* occurrences =
+        call_site_summarizer.get_callee_call_site_summary_occurrences(callee);
+    if (occurrences == nullptr) {
+      continue;
+    }
+    // Call-site summaries that only differ in whether the result is used
+    // share a specialization.
+    std::map<std::string, Candidate> by_key;
+    for (auto& [summary, count] : *occurrences) {
+      if (summary->arguments.is_top()) {
+        continue;
+      }
+      auto key = CallSiteSummary{summary->arguments, false}.get_key();
+      auto it = by_key.find(key);
+      if (it == by_key.end()) {
+        it = by_key
+                 .emplace(key,
+                          Candidate{const_cast<DexMethod*>(callee),
+                                    summary->arguments, key, 0, nullptr})
+                 .first;
+      }
+      it->second.call_sites += count;
+    }
+    std::vector<Candidate> callee_candidates;
+    for (auto& [_, candidate] : by_key) {
+      if (candidate.call_sites >= config.min_call_sites) {
+        callee_candidates.push_back(std::move(candidate));
+      }
+    }
+    std::stable_sort(callee_candidates.begin(), callee_candidates.end(),
+                     [](const auto& a, const auto& b) {
+                       return a.call_sites > b.call_sites;
+                     });
+    if (callee_candidates.size() > config.max_specializations_per_method) {
+      callee_candidates.resize(config.max_specializations_per_method);
+    }
+    for (auto& candidate : callee_candidates) {
+      candidates.push_back(std::move(candidate));
+    }
+  }
+
+  workqueue_run_for<size_t>(0, candidates.size(), [&](size_t i) {
+    auto& candidate = candidates[i];
+    auto* callee = candidate.callee;
+    candidate.code = std::make_unique<IRCode>(*callee->get_code());
+    auto* code = candidate.code.get();
+    auto env = constant_propagation::interprocedural::env_with_params(
+        is_static(callee), code, candidate.arguments);
+    constant_propagation::Transform::Config cp_config;
+    cp_config.pure_methods = &shrinker.get_pure_methods();
+    shrinker.constant_propagation(is_static(callee), callee->get_class(),
+                                  callee->get_proto(), code, env, cp_config);
+    shrinker.shrink_code(code, is_static(callee),
+                         /* is_init_or_clinit */ false, callee->get_class(),
+                         callee->get_proto(), [&]() { return show(callee); });
+    candidate.code_units = code->estimate_code_units();
+  });
+
+  // The hottest specializations get the code size budget first.
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.call_sites > b.call_sites;
+                   });
+  Stats stats;
+  std::unordered_map<DexMethod*, size_t> next_ids;
+  for (auto& candidate : candidates) {
+    auto* callee = candidate.callee;
+    auto code_units = callee->get_code()->estimate_code_units();
+    if (candidate.code_units * 100 >
+            code_units * (100 - config.min_size_reduction_percent) ||
+        stats.added_code_units + candidate.code_units >
+            config.max_code_size_increase) {
+      stats.rejected_specializations++;
+      continue;
+    }
+
+    const DexString* name;
+    do {
+      name = DexString::make_string(callee->get_name()->str() + "$spec$" +
+                                    std::to_string(next_ids[callee]++));
+    } while (DexMethod::get_method(callee->get_class(), name,
+                                   callee->get_proto()) != nullptr);
+    auto* specialization =
+        DexMethod::make_method_from(callee, callee->get_class(), name);
+    specialization->set_code(std::move(candidate.code));
+    specialization->set_deobfuscated_name(show_deobfuscated(specialization));
+    type_class(callee->get_class())->add_method(specialization);
+    stats.specialized_methods++;
+    stats.added_code_units += candidate.code_units;
+    TRACE(PA, 2, "[MethodSpecialization] %s for %s at %zu call-sites: %u -> %u",
+          SHOW(specialization), candidate.key.c_str(), candidate.call_sites,
+          code_units, candidate.code_units);
+
+    for (auto* insn :
+         *call_site_summarizer.get_callee_call_site_invokes(callee)) {
+      auto* summary =
+          call_site_summarizer.get_instruction_call_site_summary(insn);
+      if (summary->arguments.equals(candidate.arguments)) {
+        const_cast<IRInstruction*>(insn)->set_method(specialization);
+        stats.retargeted_invokes++;
+      }
+    }
+  }
+  return stats;
+}
+
+} // namespace method_specialization
+
+void MethodSpecializationPass::bind_config() {
+  bind("max_specializations_per_method", 2u,
+       m_config.max_specializations_per_method,
+       "Maximum number of specializations created for a single method");
+  bind("min_call_sites", 1u, m_config.min_call_sites,
+       "Minimum number of call-sites in hot callers that must share the same "
+       "arguments");
+  bind("min_size_reduction_percent", 10u, m_config.min_size_reduction_percent,
+       "By how much a specialization must be smaller than the original code");
+  bind("max_code_size_increase", 2000u, m_config.max_code_size_increase,
+       "Maximum number of code units that all specializations may add");
+  bind("min_caller_call_count", 10.0f, m_min_caller_call_count,
+       "Methods with at least this average call count in any interaction "
+       "are considered hot callers");
+}
+
+void MethodSpecializationPass::run_pass(DexStoresVector& stores,
+                                        ConfigFiles& conf,
+                                        PassManager& mgr) {
+  if (mgr.get_redex_options().instrument_pass_enabled) {
+    TRACE(PA, 1, "Skipping MethodSpecializationPass under instrumentation");
+    return;
+  }
+  std::unordered_set<DexMethod*> hot_callers;
+  for (auto& [_, stats_map] : conf.get_method_profiles().all_interactions()) {
+    for (auto& [ref, stat] : stats_map) {
+      if (stat.call_count >= m_min_caller_call_count && ref->is_def()) {
+        hot_callers.insert(const_cast<DexMethodRef*>(ref)->as_def());
+      }
+    }
+  }
+  mgr.incr_metric(METRIC_HOT_CALLERS, hot_callers.size());
+  if (hot_callers.empty()) {
+    return;
+  }
+
+  auto scope = build_class_scope(stores);
+  init_classes::InitClassesWithSideEffects init_classes_with_side_effects(
+      scope, conf.create_init_class_insns());
+  shrinker::ShrinkerConfig shrinker_config;
+  shrinker_config.run_const_prop = true;
+  shrinker_config.run_cse = true;
+  shrinker_config.run_copy_prop = true;
+  shrinker_config.run_local_dce = true;
+  shrinker_config.run_dedup_blocks = true;
+  shrinker_config.compute_pure_methods = false;
+  shrinker::Shrinker shrinker(stores, scope, init_classes_with_side_effects,
+                              shrinker_config,
+                              mgr.get_redex_options().min_sdk);
+
+  auto stats = method_specialization::specialize(scope, shrinker, hot_callers,
+                                                 m_config);
+  mgr.incr_metric(METRIC_SPECIALIZED_METHODS, stats.specialized_methods);
+  mgr.incr_metric(METRIC_REJECTED_SPECIALIZATIONS,
+                  stats.rejected_specializations);
+  mgr.incr_metric(METRIC_RETARGETED_INVOKES, stats.retargeted_invokes);
+  mgr.incr_metric(METRIC_ADDED_CODE_UNITS, stats.added_code_units);
+}
+
+static MethodSpecializationPass s_pass;
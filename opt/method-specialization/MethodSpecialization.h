@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <unordered_set>
+
+#include "DexClass.h"
+#include "Pass.h"
+
+namespace shrinker {
+class Shrinker;
+} // namespace shrinker
+
+namespace method_specialization {
+
+struct Config {
+  // Specializations created at most for a single method.
+  size_t max_specializations_per_method{2};
+  // Call-sites in hot callers that need to share the same arguments.
+  size_t min_call_sites{1};
+  // By how much a specialization must be smaller than the generic code to be
+  // worth keeping.
+  size_t min_size_reduction_percent{10};
+  // Code units all specializations together may add.
+  size_t max_code_size_increase{2000};
+};
+
+struct Stats {
+  size_t specialized_methods{0};
+  size_t rejected_specializations{0};
+  size_t retargeted_invokes{0};
+  size_t added_code_units{0};
+};
+
+/*
+ * Clones static and direct methods for the argument combinations they are
+ * most often invoked with from `hot_callers`, as found by the call-site
+ * summarizer. Arguments are known numeric constants, null, or known to be
+ * non-null or of a known sign. Each clone is simplified by the shrinker
+ * under the assumption of those arguments, and kept only when that removes
+ * enough of the generic code; matching invokes are then retargeted to it.
+ *
+ * Clones keep the signature of the original method; arguments that become
+ * unused are left to RemoveUnusedArgsPass.
+ */
+Stats specialize(const Scope& scope,
+                 shrinker::Shrinker& shrinker,
+                 const std::unordered_set<DexMethod*>& hot_callers,
+                 const Config& config);
+
+} // namespace method_specialization
+
+class MethodSpecializationPass : public Pass {
+ public:
+  MethodSpecializationPass() : Pass("MethodSpecializationPass") {}
+
+  redex_properties::PropertyInteractions get_property_interactions()
+      const override {
+    using namespace redex_properties::interactions;
+    using namespace redex_properties::names;
+    return {
+        {DexLimitsObeyed, Preserves},
+        {NoResolvablePureRefs, Preserves},
+    };
+  }
+
+  void bind_config() override;
+
+  void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+
+ private:
+  method_specialization::Config m_config;
+  // Methods invoked at least this often in any interaction are considered
+  // hot callers.
+  float m_min_caller_call_count;
+};
@@ -8,6 +8,7 @@
 #include "PerfMethodInlinePass.h"
 
 #include <boost/algorithm/string.hpp>
+#include <boost/functional/hash.hpp>
 #include <boost/optional.hpp>
 #include <boost/range/adaptor/filtered.hpp>
 #include <boost/range/algorithm/transform.hpp>
@@ -15,6 +16,7 @@
 #include <iostream>
 #include <limits>
 #include <queue>
+#include <unordered_set>
 
 #include "ConfigFiles.h"
 #include "ControlFlow.h"
@@ -92,12 +94,9 @@ class InlineForSpeedMethodProfiles final : public InlineForSpeedBase {
   bool should_inline_impl(const DexMethod* caller_method,
                           const DexMethod* callee_method) override;
 
-  bool should_inline_callsite_impl(
-      const DexMethod* caller_method ATTRIBUTE_UNUSED,
-      const DexMethod* callee_method ATTRIBUTE_UNUSED,
-      const cfg::Block* caller_block ATTRIBUTE_UNUSED) final {
-    return true;
-  }
+  bool should_inline_callsite_impl(const DexMethod* caller_method,
+                                   const DexMethod* callee_method,
+                                   const cfg::Block* caller_block) final;
 
  private:
   void compute_hot_methods();
@@ -106,13 +105,22 @@ class InlineForSpeedMethodProfiles final : public InlineForSpeedBase {
                                      uint32_t caller_insns,
                                      uint32_t callee_insns,
                                      const std::string& interaction_id,
-                                     const StatsMap& method_stats) const;
+                                     const StatsMap& method_stats,
+                                     bool* needs_hot_callsite) const;
 
   const MethodProfiles* m_method_profiles;
   std::map<std::string, std::pair<double, double>> m_min_scores;
+  // Caller/callee pairs that were only accepted because one of them is hot,
+  // but neither is small. We only inline those at hot call-sites. This is
+  // populated while pruning the call-graph, before any call-site is visited.
+  std::unordered_set<std::pair<const DexMethod*, const DexMethod*>,
+                     boost::hash<std::pair<const DexMethod*, const DexMethod*>>>
+      m_needs_hot_callsite;
 };
 
 constexpr double MIN_APPEAR_PERCENT = 80.0;
+// Smaller methods tend to benefit more from inlining.
+constexpr uint32_t SMALL_ENOUGH = 20;
 
 void InlineForSpeedMethodProfiles::compute_hot_methods() {
   if (m_method_profiles == nullptr || !m_method_profiles->has_stats()) {
@@ -184,17 +192,73 @@ bool InlineForSpeedMethodProfiles::should_inline_impl(
   }
 
   // If the pair is hot under any interaction, inline it.
+  bool needs_hot_callsite = true;
+  bool should = false;
   for (const auto& pair : m_method_profiles->all_interactions()) {
-    bool should = should_inline_per_interaction(caller_method,
-                                                callee_method,
-                                                caller_insns,
-                                                callee_insns,
-                                                pair.first,
-                                                pair.second);
-    if (should) {
+    bool interaction_needs_hot_callsite = false;
+    if (should_inline_per_interaction(caller_method,
+                                      callee_method,
+                                      caller_insns,
+                                      callee_insns,
+                                      pair.first,
+                                      pair.second,
+                                      &interaction_needs_hot_callsite)) {
+      should = true;
+      if (!interaction_needs_hot_callsite) {
+        needs_hot_callsite = false;
+        break;
+      }
+    }
+  }
+  if (should && needs_hot_callsite) {
+    m_needs_hot_callsite.emplace(caller_method, callee_method);
+  }
+  return should;
+}
+
+bool InlineForSpeedMethodProfiles::should_inline_callsite_impl(
+    const DexMethod* caller_method,
+    const DexMethod* callee_method,
+    const cfg::Block* caller_block) {
+  auto sb_vec = source_blocks::gather_source_blocks(caller_block);
+  if (sb_vec.empty() || sb_vec[0]->vals_size == 0) {
+    // No block-level profile, go with the method-level decision.
+    return true;
+  }
+  const auto* sb = sb_vec[0];
+
+  // Never inline into a block that was not hit in any interaction. Missing
+  // values mean we don't know, and we don't penalize those.
+  bool cold = !sb->foreach_val_early(
+      [](const auto& val) { return !val || val->val > 0; });
+  if (cold) {
+    return false;
+  }
+
+  if (!m_needs_hot_callsite.count(std::make_pair(caller_method,
+                                                 callee_method))) {
+    return true;
+  }
+
+  // For larger pairs, the call-site must also be hot: it must be executed
+  // about as often as the caller itself is, i.e. not be on a side path.
+  auto entry_sb_vec = source_blocks::gather_source_blocks(
+      caller_method->get_code()->cfg().entry_block());
+  const auto* entry_sb = entry_sb_vec.empty() ? nullptr : entry_sb_vec[0];
+  for (size_t i = 0; i < sb->vals_size; i++) {
+    auto val = sb->get_val(i);
+    if (!val || *val <= 0) {
+      continue;
+    }
+    auto entry_val = entry_sb != nullptr && i < entry_sb->vals_size
+                         ? entry_sb->get_val(i)
+                         : boost::none;
+    if (!entry_val || *val >= *entry_val) {
       return true;
     }
   }
+  TRACE(METH_PROF, 5, "Not at a hot call-site: %s, %s", SHOW(caller_method),
+        SHOW(callee_method));
   return false;
 }
 
@@ -204,7 +268,8 @@ bool InlineForSpeedMethodProfiles::should_inline_per_interaction(
     uint32_t caller_insns,
     uint32_t callee_insns,
     const std::string& interaction_id,
-    const StatsMap& method_stats) const {
+    const StatsMap& method_stats,
+    bool* needs_hot_callsite) const {
   const auto& caller_search = method_stats.find(caller_method);
   if (caller_search == method_stats.end()) {
     return false;
@@ -230,13 +295,13 @@ bool InlineForSpeedMethodProfiles::should_inline_per_interaction(
     return false;
   }
 
-  // Smaller methods tend to benefit more from inlining. Allow warm + small
-  // methods, or hot + medium size methods.
-  constexpr uint32_t SMALL_ENOUGH = 20;
+  // Allow warm + small methods, or hot + medium size methods. The latter only
+  // at hot call-sites.
   bool either_small =
       caller_insns < SMALL_ENOUGH || callee_insns < SMALL_ENOUGH;
   bool either_hot = caller_hits >= hot_score || callee_hits >= hot_score;
   bool result = either_small || either_hot;
+  *needs_hot_callsite = !either_small;
   if (result) {
     TRACE(METH_PROF,
           5,
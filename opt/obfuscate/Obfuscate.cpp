@@ -20,6 +20,7 @@
 #include "Trace.h"
 #include "VirtualRenamer.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 namespace {
 
@@ -160,45 +161,66 @@ void obfuscate(Scope& scope,
   DexFieldManager field_name_manager = new_dex_field_manager();
   DexMethodManager method_name_manager = new_dex_method_manager();
 
-  std::unordered_map<const DexClass*, int> next_dmethod_seeds;
+  // Fields are renamed per class, and the names picked for one class do not
+  // depend on any other class. So, create all the wrappers first, and then
+  // pick the names of each class in parallel.
+  std::vector<DexClass*> field_classes;
   for (DexClass* cls : scope) {
     always_assert_log(!cls->is_external(),
                       "Shouldn't rename members of external classes. %s",
                       SHOW(cls));
     // Checks to short-circuit expensive name-gathering logic (code is still
     // correct w/o this, but does unnecessary work)
-    bool operate_on_ifields =
-        contains_renamable_elem(cls->get_ifields(), field_name_manager);
-    bool operate_on_sfields =
-        contains_renamable_elem(cls->get_sfields(), field_name_manager);
-    bool operate_on_dmethods =
-        contains_renamable_elem(cls->get_dmethods(), method_name_manager);
-    if (operate_on_ifields || operate_on_sfields) {
-      FieldObfuscationState f_ob_state;
-      FieldNameGenerator field_name_generator(f_ob_state.ids_to_avoid,
-                                              f_ob_state.used_ids);
-
-      TRACE(OBFUSCATE, 3, "Renaming the fields of class %s",
-            SHOW(cls->get_name()));
-
-      f_ob_state.populate_ids_to_avoid(cls, field_name_manager,
-                                       /* unused */ ch);
-
-      if (operate_on_ifields) {
-        obfuscate_elems(
-            FieldRenamingContext(cls->get_ifields(), field_name_generator),
-            field_name_manager);
+    if (contains_renamable_elem(cls->get_ifields(), field_name_manager) ||
+        contains_renamable_elem(cls->get_sfields(), field_name_manager)) {
+      for (auto* f : cls->get_ifields()) {
+        field_name_manager[f];
       }
-      if (operate_on_sfields) {
-        obfuscate_elems(
-            FieldRenamingContext(cls->get_sfields(), field_name_generator),
-            field_name_manager);
+      for (auto* f : cls->get_sfields()) {
+        field_name_manager[f];
       }
-
-      // Make sure to bind the new names otherwise not all generators will
-      // assign names to the members
-      field_name_generator.bind_names();
+      field_classes.push_back(cls);
     }
+  }
+  workqueue_run<DexClass*>(
+      [&](DexClass* cls) {
+        bool operate_on_ifields =
+            contains_renamable_elem(cls->get_ifields(), field_name_manager);
+        bool operate_on_sfields =
+            contains_renamable_elem(cls->get_sfields(), field_name_manager);
+        FieldObfuscationState f_ob_state;
+        FieldNameGenerator field_name_generator(f_ob_state.ids_to_avoid,
+                                                f_ob_state.used_ids);
+
+        TRACE(OBFUSCATE, 3, "Renaming the fields of class %s",
+              SHOW(cls->get_name()));
+
+        f_ob_state.populate_ids_to_avoid(cls, field_name_manager,
+                                         /* unused */ ch);
+
+        if (operate_on_ifields) {
+          obfuscate_elems(
+              FieldRenamingContext(cls->get_ifields(), field_name_generator),
+              field_name_manager);
+        }
+        if (operate_on_sfields) {
+          obfuscate_elems(
+              FieldRenamingContext(cls->get_sfields(), field_name_generator),
+              field_name_manager);
+        }
+
+        // Make sure to bind the new names otherwise not all generators will
+        // assign names to the members
+        field_name_generator.bind_names();
+      },
+      field_classes);
+
+  // Direct methods avoid the names of methods in the whole hierarchy,
+  // including the ones already renamed, so they are renamed in scope order.
+  std::unordered_map<const DexClass*, int> next_dmethod_seeds;
+  for (DexClass* cls : scope) {
+    bool operate_on_dmethods =
+        contains_renamable_elem(cls->get_dmethods(), method_name_manager);
 
     // =========== Obfuscate Methods Below ==========
     if (operate_on_dmethods) {
@@ -1169,6 +1169,11 @@ class RootMethodReducer {
       return false;
     }
     auto [param_index, type] = *src_indices.begin();
+    if (m_config.prefer_param_expansion &&
+        m_expandable_method_params.get_expanded_method_ref(callee,
+                                                           param_index)) {
+      return true;
+    }
     auto kind = m_types.at(type).kind;
     bool multiples = kind == InlinableTypeKind::CompleteMultipleRoots;
     if (multiples && m_code_size_cache[callee] > m_config.max_inline_size &&
@@ -2006,6 +2011,10 @@ void ObjectEscapeAnalysisPass::bind_config() {
   bind("cost_move_result", COST_MOVE_RESULT, m_config.cost_move_result);
   bind("cost_new_instance", COST_NEW_INSTANCE, m_config.cost_new_instance);
   bind("savings_threshold", SAVINGS_THRESHOLD, m_config.savings_threshold);
+  bind("prefer_param_expansion", false, m_config.prefer_param_expansion,
+       "Pass the fields of non-escaping objects as separate arguments to "
+       "specialized callee clones rather than inlining the callees, which "
+       "keeps the code size of reduced methods down.");
 }
 
 void ObjectEscapeAnalysisPass::run_pass(DexStoresVector& stores,
@@ -20,6 +20,9 @@ struct ObjectEscapeConfig {
   int64_t cost_move_result;
   int64_t cost_new_instance;
   int64_t savings_threshold;
+  // Replace a non-escaping object argument with its field values whenever the
+  // callee can be expanded that way, instead of inlining the callee.
+  bool prefer_param_expansion;
 };
 
 class ObjectEscapeAnalysisPass : public Pass {
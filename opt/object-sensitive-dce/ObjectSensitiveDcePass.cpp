@@ -36,7 +36,8 @@ void ObjectSensitiveDcePass::run_pass(DexStoresVector& stores,
       "init-class instructions.");
 
   auto scope = build_class_scope(stores);
-  auto method_override_graph = method_override_graph::build_graph(scope);
+  auto method_override_graph =
+      MethodOverrideGraphAnalysisPass::get_or_build(mgr, scope);
   init_classes::InitClassesWithSideEffects init_classes_with_side_effects(
       scope, conf.create_init_class_insns(), method_override_graph.get());
 
@@ -67,7 +68,8 @@ void ObjectSensitiveDcePass::run_pass(DexStoresVector& stores,
                           *method_override_graph,
                           m_big_override_threshold,
                           &escape_summaries,
-                          &effect_summaries);
+                          &effect_summaries,
+                          m_allocation_sinking_config);
   impl.dce();
 
   auto& stats = impl.get_stats();
@@ -91,6 +93,10 @@ void ObjectSensitiveDcePass::run_pass(DexStoresVector& stores,
                  invokes_with_summaries[OPCODE_INVOKE_VIRTUAL]);
   mgr.set_metric("invoke_super_with_summaries",
                  invokes_with_summaries[OPCODE_INVOKE_SUPER]);
+  mgr.set_metric("sunk_allocations",
+                 stats.allocation_sinking_stats.sunk_allocations);
+  mgr.set_metric("removed_field_stores",
+                 stats.allocation_sinking_stats.removed_field_stores);
 }
 
 static ObjectSensitiveDcePass s_pass;
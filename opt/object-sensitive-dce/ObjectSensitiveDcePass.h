@@ -9,8 +9,11 @@
 
 #include <boost/optional.hpp>
 
+#include "AllocationSinking.h"
+#include "AnalysisUsage.h"
 #include "CallGraph.h"
 #include "LocalPointersAnalysis.h"
+#include "MethodOverrideGraphAnalysisPass.h"
 #include "Pass.h"
 #include "SideEffectSummary.h"
 #include "Trace.h"
@@ -37,6 +40,14 @@ class ObjectSensitiveDcePass final : public Pass {
          "TODO: Document me!",
          Configurable::bindflags::optionals::skip_empty_string);
     bind("big_override_threshold", UINT32_C(5), m_big_override_threshold);
+    bind("sink_allocations", true,
+         m_allocation_sinking_config.sink_allocations,
+         "Move allocations with side-effect-free constructors into the only "
+         "branch that uses them.");
+    bind("remove_dead_field_stores", true,
+         m_allocation_sinking_config.remove_dead_field_stores,
+         "Remove stores to fields of non-escaping objects that are "
+         "overwritten before they may be read.");
 
     if (!m_external_escape_summaries_file ||
         !m_external_side_effect_summaries_file) {
@@ -46,10 +57,15 @@ class ObjectSensitiveDcePass final : public Pass {
     }
   }
 
+  void set_analysis_usage(AnalysisUsage& au) const override {
+    au.add_preserve_specific<MethodOverrideGraphAnalysisPass>();
+  }
+
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
 
  private:
   boost::optional<std::string> m_external_side_effect_summaries_file;
   boost::optional<std::string> m_external_escape_summaries_file;
   uint32_t m_big_override_threshold;
+  allocation_sinking::Config m_allocation_sinking_config;
 };
@@ -20,6 +20,7 @@
 #include "TypeReference.h"
 #include "UsedVarsAnalysis.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 /**
  * We already get a set of candidate enums which are safe to be replaced with
@@ -1075,12 +1076,20 @@ class EnumTransformer final {
   EnumTransformer(const Config& config, DexStoresVector* stores)
       : m_stores(*stores), m_int_objs(0) {
     m_enum_util = std::make_unique<EnumUtil>(config);
-    for (auto it = config.candidate_enums.begin();
-         it != config.candidate_enums.end();
-         ++it) {
-      auto enum_cls = type_class(*it);
-      auto attributes = optimize_enums::analyze_enum_clinit(
-          enum_cls, config.support_kt_19_enum_entries);
+    // The <clinit> analyses are independent of each other, so run them all
+    // up front in parallel. The candidates are then handled one by one in
+    // the same order as before.
+    std::vector<DexType*> candidates(config.candidate_enums.begin(),
+                                     config.candidate_enums.end());
+    std::vector<EnumAttributes> all_attributes(candidates.size());
+    workqueue_run_for<size_t>(0, candidates.size(), [&](size_t i) {
+      all_attributes[i] = optimize_enums::analyze_enum_clinit(
+          type_class(candidates[i]), config.support_kt_19_enum_entries);
+    });
+    for (size_t i = 0; i < candidates.size(); ++i) {
+      auto* type = candidates[i];
+      auto enum_cls = type_class(type);
+      auto& attributes = all_attributes[i];
       size_t num_enum_constants = attributes.m_constants_map.size();
       if (num_enum_constants == 0) {
         TRACE(ENUM, 2, "\tCannot analyze enum %s : ord %zu sfields %zu",
@@ -1088,7 +1097,7 @@ class EnumTransformer final {
               enum_cls->get_sfields().size());
         continue;
       } else if (num_enum_constants > config.max_enum_size) {
-        if (!config.breaking_reference_equality_allowlist.count(*it)) {
+        if (!config.breaking_reference_equality_allowlist.count(type)) {
           TRACE(ENUM, 2, "\tSkip %s %zu values", SHOW(enum_cls),
                 num_enum_constants);
           continue;
@@ -1101,7 +1110,7 @@ class EnumTransformer final {
       }
       m_int_objs = std::max<uint32_t>(m_int_objs, num_enum_constants);
       m_enum_objs += num_enum_constants;
-      m_enum_attributes_map.emplace(*it, attributes);
+      m_enum_attributes_map.emplace(type, std::move(attributes));
       TRACE(ENUM, 2, "\tcleaning enum %s with num const values %zu",
             SHOW(enum_cls), num_enum_constants);
       clean_generated_methods_fields(enum_cls);
@@ -236,7 +236,9 @@ void collect_generated_switch_cases(
                   .src(1, look, uniq)
                   .src(2, ordi, uniq);
 
-  auto res = f.find(clinit_cfg, aput);
+  // Both queries below look at the same <clinit>.
+  mf::method_index_t clinit_index(clinit_cfg);
+  auto res = f.find(clinit_index, aput);
 
   std::unordered_map<IRInstruction*, IRInstruction*> new_array_to_sput;
   for (auto* insn_look : res.matching(look)) {
@@ -255,7 +257,7 @@ void collect_generated_switch_cases(
     auto newa = g.insn(m::in<IRInstruction*>(new_array_to_sput));
     auto sput = g.insn(m_sput_lookup).src(0, newa, uniq);
 
-    auto res_sputs = g.find(clinit_cfg, sput);
+    auto res_sputs = g.find(clinit_index, sput);
     for (auto* insn_sput : res_sputs.matching(sput)) {
       auto* insn_newa = res_sputs.matching(sput, insn_sput, 0).unique();
       new_array_to_sput[insn_newa] = insn_sput;
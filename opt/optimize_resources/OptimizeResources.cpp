@@ -35,6 +35,7 @@
 #include "Show.h"
 #include "StlUtil.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 #include "androidfw/ResourceTypes.h"
 #include "utils/Vector.h"
 
@@ -82,6 +83,17 @@ bool is_resource_xml(const std::string& str) {
   return false;
 }
 
+// Returns the resource ids referenced by each of the given xml files, in the
+// same order as the files.
+std::vector<std::unordered_set<uint32_t>> read_xml_reference_attributes(
+    AndroidResources* resources, const std::vector<std::string>& xml_files) {
+  std::vector<std::unordered_set<uint32_t>> result(xml_files.size());
+  workqueue_run_for<size_t>(0, xml_files.size(), [&](size_t i) {
+    result[i] = resources->get_xml_reference_attributes(xml_files[i]);
+  });
+  return result;
+}
+
 void compute_transitive_closure(
     ResourceTableFile* res_table,
     const std::string& zip_dir,
@@ -95,21 +107,24 @@ void compute_transitive_closure(
         root, ResourcePathType::ZipPath, nodes_visited, &potential_file_paths);
   }
 
-  std::unordered_set<std::string> next_xml_files;
+  std::vector<std::string> next_xml_files;
   while (!potential_file_paths.empty()) {
     for (auto& str : potential_file_paths) {
       if (is_resource_xml(str)) {
         auto r_str = std::string(zip_dir).append("/").append(str);
-        if (explored_xml_files->find(r_str) == explored_xml_files->end()) {
-          next_xml_files.emplace(std::move(r_str));
+        if (explored_xml_files->emplace(r_str).second) {
+          next_xml_files.emplace_back(std::move(r_str));
         }
       }
     }
-
     potential_file_paths.clear();
-    for (auto& str : next_xml_files) {
-      explored_xml_files->emplace(str);
-      for (uint32_t attribute : resources->get_xml_reference_attributes(str)) {
+
+    // Parsing the files of one wave is independent of the table walk, so read
+    // them all up front and only walk the references serially afterwards.
+    auto xml_references =
+        read_xml_reference_attributes(resources, next_xml_files);
+    for (const auto& attributes : xml_references) {
+      for (uint32_t attribute : attributes) {
         res_table->walk_references_for_resource(
             attribute, ResourcePathType::ZipPath, nodes_visited,
             &potential_file_paths);
@@ -407,13 +422,17 @@ void OptimizeResourcesPass::run_pass(DexStoresVector& stores,
   // without walking any reference chains.
   std::unordered_set<std::string> explored_xml_files;
   std::unordered_set<uint32_t> external_id_roots;
+  std::vector<std::string> manifest_files;
   const auto& xml_files = resources->find_all_xml_files();
   for (const std::string& path : xml_files) {
     if (path.find("AndroidManifest.xml") == std::string::npos) {
       continue;
     }
     explored_xml_files.emplace(path);
-    const auto& id_roots = resources->get_xml_reference_attributes(path);
+    manifest_files.push_back(path);
+  }
+  for (const auto& id_roots :
+       read_xml_reference_attributes(resources.get(), manifest_files)) {
     external_id_roots.insert(id_roots.begin(), id_roots.end());
   }
   TRACE(OPTRES, 2, "Total external_id_roots count: %zu",
@@ -1185,6 +1185,13 @@ static bool can_outline_from_method(DexMethod* method) {
 // Gather set of recurring small (MIN_INSNS_SIZE) adjacent instruction
 // sequences that are outlinable. Note that all longer recurring outlinable
 // instruction sequences must be comprised of shorter recurring ones.
+//
+// Instead of counting every window of MIN_INSNS_SIZE instructions in a
+// (large) concurrent map, we lay out all outlinable runs of instructions as
+// one stream of interned cores, and sort the window start positions, as in a
+// suffix array that only distinguishes the first MIN_INSNS_SIZE elements.
+// Equal windows then end up adjacent. This only needs a few integers per
+// instruction.
 static void get_recurring_cores(
     const Config& config,
     PassManager& mgr,
@@ -1195,11 +1202,12 @@ static void get_recurring_cores(
     CandidateInstructionCoresSet* recurring_cores,
     InsertOnlyConcurrentMap<DexMethod*, CanOutlineBlockDecider>*
         block_deciders) {
-  AtomicMap<CandidateInstructionCores, size_t, CandidateInstructionCoresHasher>
-      concurrent_cores;
+  // Outlinable runs of at least MIN_INSNS_SIZE instructions, per method.
+  using Runs = std::vector<std::vector<CandidateInstructionCore>>;
+  InsertOnlyConcurrentMap<DexMethod*, Runs> method_runs;
   walk::parallel::code(
       scope, [&config, &ref_checker, &sufficiently_warm_methods,
-              &sufficiently_hot_methods, &concurrent_cores,
+              &sufficiently_hot_methods, &method_runs,
               block_deciders](DexMethod* method, IRCode& code) {
         if (!can_outline_from_method(method)) {
           return;
@@ -1217,37 +1225,93 @@ static void get_recurring_cores(
               reaching_initializeds::get_reaching_initializeds(
                   cfg, reaching_initializeds::Mode::FirstLoadParam);
         }
+        Runs runs;
+        std::vector<CandidateInstructionCore> run;
+        auto flush_run = [&]() {
+          if (run.size() >= MIN_INSNS_SIZE) {
+            runs.push_back(std::move(run));
+          }
+          run.clear();
+        };
         for (auto& big_block : big_blocks::get_big_blocks(cfg)) {
           if (block_decider.can_outline_from_big_block(big_block) !=
               CanOutlineBlockDecider::Result::CanOutline) {
             continue;
           }
-          CandidateInstructionCoresBuilder cores_builder;
           for (auto& mie : big_blocks::InstructionIterable(big_block)) {
             auto insn = mie.insn;
             if (!can_outline_insn(ref_checker,
                                   reaching_initialized_init_first_param, insn,
                                   config.outline_control_flow)) {
-              cores_builder.clear();
+              flush_run();
               continue;
             }
-            cores_builder.push_back(insn);
-            if (cores_builder.has_value()) {
-              concurrent_cores.fetch_add(cores_builder.get_value(), 1);
-            }
+            run.push_back(to_core(insn));
           }
+          flush_run();
+        }
+        if (!runs.empty()) {
+          method_runs.emplace(method, std::move(runs));
         }
         block_deciders->emplace(method, std::move(block_decider));
       });
+
+  // Intern the cores, and remember where complete windows start.
+  std::unordered_map<CandidateInstructionCore, uint32_t,
+                     CandidateInstructionCoreHasher>
+      core_ids;
+  std::vector<CandidateInstructionCore> cores;
+  std::vector<uint32_t> stream;
+  std::vector<uint32_t> window_starts;
+  walk::code(scope, [&](DexMethod* method, IRCode&) {
+    auto* runs = method_runs.get(method);
+    if (runs == nullptr) {
+      return;
+    }
+    for (const auto& run : *runs) {
+      for (size_t i = 0; i < run.size(); i++) {
+        auto [it, emplaced] = core_ids.emplace(run[i], cores.size());
+        if (emplaced) {
+          cores.push_back(run[i]);
+        }
+        if (i + MIN_INSNS_SIZE <= run.size()) {
+          window_starts.push_back(stream.size());
+        }
+        stream.push_back(it->second);
+      }
+    }
+  });
+  core_ids.clear();
+  method_runs.clear();
+
+  auto window_less = [&stream](uint32_t a, uint32_t b) {
+    return std::lexicographical_compare(
+        stream.begin() + a, stream.begin() + a + MIN_INSNS_SIZE,
+        stream.begin() + b, stream.begin() + b + MIN_INSNS_SIZE);
+  };
+  auto window_equal = [&stream](uint32_t a, uint32_t b) {
+    return std::equal(stream.begin() + a, stream.begin() + a + MIN_INSNS_SIZE,
+                      stream.begin() + b);
+  };
+  std::sort(window_starts.begin(), window_starts.end(), window_less);
+
   size_t singleton_cores{0};
-  for (auto& p : concurrent_cores) {
-    auto count = p.second.load();
-    always_assert(count > 0);
-    if (count > 1) {
-      recurring_cores->insert(p.first);
+  for (size_t i = 0; i < window_starts.size();) {
+    size_t j = i + 1;
+    while (j < window_starts.size() &&
+           window_equal(window_starts[i], window_starts[j])) {
+      j++;
+    }
+    if (j - i > 1) {
+      CandidateInstructionCores window;
+      for (size_t k = 0; k < MIN_INSNS_SIZE; k++) {
+        window[k] = cores[stream[window_starts[i] + k]];
+      }
+      recurring_cores->insert(window);
     } else {
       singleton_cores++;
     }
+    i = j;
   }
   mgr.incr_metric("num_singleton_cores", singleton_cores);
   mgr.incr_metric("num_recurring_cores", recurring_cores->size());
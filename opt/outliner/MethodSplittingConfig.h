@@ -26,6 +26,9 @@ struct Config {
   float max_huge_overhead_ratio{0.02};
   int64_t max_live_in{32};
   uint64_t max_iteration{7};
+  // Only split out closures whose code is cold in every interaction, keeping
+  // all profiled code in place.
+  bool cold_only{false};
 
   // Estimated overhead of having a split method and its metadata.
   size_t cost_split_method{16};
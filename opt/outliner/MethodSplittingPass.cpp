@@ -54,6 +54,8 @@ void MethodSplittingPass::bind_config() {
        "Maximum number of live-in registers");
   bind("max_iteration", m_config.max_iteration, m_config.max_iteration,
        "Maximum number of top-level iterations");
+  bind("cold_only", m_config.cold_only, m_config.cold_only,
+       "Only split out code that is cold in every interaction");
   bind("excluded_prefices", m_config.excluded_prefices,
        m_config.excluded_prefices);
 }
@@ -31,6 +31,20 @@ bool is_hot(const cfg::Block* b) {
   return is_hot;
 }
 
+bool is_cold_in_all_interactions(const cfg::Block* b) {
+  bool is_cold = true;
+  source_blocks::foreach_source_block(b, [&is_cold](const auto* sb) {
+    if (!is_cold) {
+      return;
+    }
+    sb->foreach_val_early([&is_cold](const auto& val) {
+      is_cold = !(val && val->val > 0.0f);
+      return !is_cold;
+    });
+  });
+  return is_cold;
+}
+
 std::string_view describe(HotSplitKind kind) {
   switch (kind) {
   case HotSplitKind::Hot:
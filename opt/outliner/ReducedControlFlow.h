@@ -16,6 +16,10 @@ namespace method_splitting_impl {
 // Helper function that checks if a block is hit in any interaction.
 bool is_hot(const cfg::Block* b);
 
+// Unlike is_hot, this looks at all source blocks in the block, and returns
+// false if any of them was hit in any interaction.
+bool is_cold_in_all_interactions(const cfg::Block* b);
+
 enum class HotSplitKind {
   Hot,
   HotCold,
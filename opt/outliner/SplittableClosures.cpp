@@ -7,7 +7,7 @@
 
 #include "SplittableClosures.h"
 
-#include <sparta/PatriciaTreeSet.h>
+#include <sparta/BitVectorSet.h>
 
 #include "ClosureAggregator.h"
 #include "ConcurrentContainers.h"
@@ -103,6 +103,17 @@ std::optional<ScoredClosure> score(
     }
     any_target_hot |= c->reduced_block->is_hot;
   }
+  if (config.cold_only) {
+    // Not just the closure heads, but every block that would move out must
+    // be cold.
+    for (auto* reduced_block : sc.reduced_components) {
+      for (auto* block : reduced_block->blocks) {
+        if (!is_cold_in_all_interactions(block)) {
+          return std::nullopt;
+        }
+      }
+    }
+  }
   if (any_src_hot) {
     if (any_target_hot) {
       if (sc.split_size < config.min_hot_split_size) {
@@ -325,9 +336,8 @@ std::vector<SplittableClosure> to_splittable_closures(
     res->run({});
     return res;
   });
-  Lazy<UninitializedObjectEnvironments> uninitialized_objects([method] {
-    return std::make_unique<UninitializedObjectEnvironments>(
-        get_uninitialized_object_environments(method));
+  Lazy<UninitializedObjectsAnalysis> uninitialized_objects([method] {
+    return std::make_unique<UninitializedObjectsAnalysis>(method);
   });
   Lazy<std::unordered_map<IRInstruction*, const ReducedBlock*>> insns([&rcfg] {
     auto res = std::make_unique<
@@ -357,7 +367,7 @@ std::vector<SplittableClosure> to_splittable_closures(
       }
     }
 
-    sparta::PatriciaTreeSet<reg_t> live_in;
+    sparta::BitVectorSet<reg_t> live_in;
     for (auto* c : sc.closures) {
       live_in.union_with(
           liveness_fp_iter->get_live_in_vars_at(c->target).elements());
@@ -396,7 +406,8 @@ std::vector<SplittableClosure> to_splittable_closures(
       }
       sc.args.push_back((ClosureArgument){reg, type, nullptr});
       if (type::is_object(type)) {
-        const auto& uninitialized_env = uninitialized_objects->at(first_insn);
+        const auto& uninitialized_env =
+            uninitialized_objects->get_environment_at(first_insn);
         auto opt_uninitialized = uninitialized_env.get(reg).get_constant();
         if (!opt_uninitialized || *opt_uninitialized) {
           return true;
@@ -8,6 +8,7 @@
 #include "Peephole.h"
 
 #include <algorithm>
+#include <bitset>
 #include <cinttypes>
 #include <cmath>
 #include <iostream>
@@ -1660,7 +1661,7 @@ std::vector<Pattern> get_throw_empty_npe_patterns() {
          // Check new-instance type..
          if (!m.matched_instructions.empty()) {
            DexType* type = m.matched_instructions.front()->get_type();
-           return type == DexType::make_type("Ljava/lang/NullPointerException;");
+           return type == type::java_lang_NullPointerException();
          }
          return true;  // Let it pass.
        }},
@@ -1687,11 +1688,25 @@ bool contains(const std::vector<T>& vec, const T& value) {
   return std::find(vec.begin(), vec.end(), value) != vec.end();
 }
 
+constexpr size_t kNumIROpcodes = 0
+#define OP(...) +1
+#define IOP(...) +1
+#define OPRANGE(...)
+#include "IROpcodes.def"
+    ;
+
+using OpcodeSet = std::bitset<kNumIROpcodes>;
+
 // Each thread will have its own instance of PeepholeOptimizer, so align it in
 // order to avoid false sharing.
 class alignas(CACHE_LINE_SIZE) PeepholeOptimizer {
  private:
   std::vector<Matcher> m_matchers;
+  // For every matcher, the opcodes accepted at each position of its match
+  // sequence. A matcher can only fire in a method that contains at least one
+  // accepted opcode for every position, which lets most matchers skip most
+  // methods without walking them.
+  std::vector<std::vector<OpcodeSet>> m_match_opcodes;
   std::vector<size_t> m_stats;
   PassManager& m_mgr;
   int m_stats_removed = 0;
@@ -1726,6 +1741,33 @@ class alignas(CACHE_LINE_SIZE) PeepholeOptimizer {
       }
     }
     m_stats.resize(m_matchers.size(), 0);
+    m_match_opcodes.reserve(m_matchers.size());
+    for (const auto& matcher : m_matchers) {
+      auto& sets = m_match_opcodes.emplace_back();
+      for (const auto& dex_pattern : matcher.pattern.match) {
+        auto& set = sets.emplace_back();
+        for (auto op : dex_pattern.opcodes) {
+          set.set(op);
+        }
+      }
+    }
+  }
+
+  static OpcodeSet method_opcodes(cfg::ControlFlowGraph& cfg) {
+    OpcodeSet opcodes;
+    for (const auto& mie : cfg::InstructionIterable(cfg)) {
+      opcodes.set(mie.insn->opcode());
+    }
+    return opcodes;
+  }
+
+  bool may_match(size_t i, const OpcodeSet& opcodes) const {
+    for (const auto& set : m_match_opcodes[i]) {
+      if ((set & opcodes).none()) {
+        return false;
+      }
+    }
+    return true;
   }
 
   PeepholeOptimizer(const PeepholeOptimizer&) = delete;
@@ -1736,10 +1778,18 @@ class alignas(CACHE_LINE_SIZE) PeepholeOptimizer {
     always_assert(code->editable_cfg_built());
     auto& cfg = code->cfg();
 
+    // Replacements may introduce new opcodes, so this is recomputed after
+    // every matcher that changed the method.
+    auto opcodes = method_opcodes(cfg);
+
     // do optimizations one at a time
     // so they can match on the same pattern without interfering
     for (size_t i = 0; i < m_matchers.size(); ++i) {
+      if (!may_match(i, opcodes)) {
+        continue;
+      }
       auto& matcher = m_matchers[i];
+      bool changed = false;
 
       const auto& blocks = cfg.blocks();
       cfg::CFGMutation mutator(cfg);
@@ -1791,11 +1841,15 @@ class alignas(CACHE_LINE_SIZE) PeepholeOptimizer {
                                matcher.matched_instructions.end());
           m_stats_removed += matcher.match_index;
           matcher.reset();
+          changed = true;
         }
       }
 
       // Apply the mutator.
       mutator.flush();
+      if (changed) {
+        opcodes = method_opcodes(cfg);
+      }
     }
   }
 
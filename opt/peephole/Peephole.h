@@ -21,6 +21,8 @@ class PeepholePass : public Pass {
     return {};
   }
 
+  bool supports_incremental_cache() const override { return true; }
+
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
 
   void bind_config() override {
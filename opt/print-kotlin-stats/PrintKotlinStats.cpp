@@ -20,7 +20,6 @@ constexpr const char* W_PROP_SIGNATURE = "Lkotlin/properties/WriteProperty;";
 constexpr const char* RW_PROP_SIGNATURE =
     "Lkotlin/properties/ReadWriteProperty;";
 constexpr const char* KPROPERTY_ARRAY = "[Lkotlin/reflect/KProperty;";
-constexpr const char* KOTLIN_LAMBDA = "Lkotlin/jvm/internal/Lambda;";
 constexpr const char* DI_BASE = "Lcom/facebook/inject/AbstractLibraryModule;";
 constexpr const char* CONTINUATION_IMPL =
     "Lkotlin/coroutines/jvm/internal/ContinuationImpl;";
@@ -56,10 +55,8 @@ bool is_anonymous(std::string_view name) {
 void PrintKotlinStats::setup() {
   m_kotlin_null_assertions =
       kotlin_nullcheck_wrapper::get_kotlin_null_assertions();
-  m_kotlin_lambdas_base = DexType::get_type(KOTLIN_LAMBDA);
   m_kotlin_coroutin_continuation_base = DexType::get_type(CONTINUATION_IMPL);
   m_di_base = DexType::get_type(DI_BASE);
-  m_instance = DexString::make_string("INSTANCE");
 }
 
 // Annotate Kotlin classes before StripDebugInfoPass removes it
@@ -106,21 +103,21 @@ void PrintKotlinStats::run_pass(DexStoresVector& stores,
   });
 
   // Handle classes
+  kotlin_shapes::ShapeIndex shapes(scope);
   std::mutex mtx;
   walk::parallel::classes(scope, [&](DexClass* cls) {
-    auto local_stats = handle_class(cls);
+    auto local_stats = handle_class(cls, shapes.get(cls));
     std::lock_guard g(mtx);
     m_stats += local_stats;
   });
   m_stats.report(mgr);
 }
 
-PrintKotlinStats::Stats PrintKotlinStats::handle_class(DexClass* cls) {
+PrintKotlinStats::Stats PrintKotlinStats::handle_class(
+    DexClass* cls, const kotlin_shapes::ClassShape& shape) {
   Stats stats;
-  bool is_lambda = false;
-  if (cls->get_super_class() == m_kotlin_lambdas_base) {
+  if (shape.is_lambda) {
     stats.kotlin_lambdas++;
-    is_lambda = true;
   }
   if (cls->get_super_class() == m_kotlin_coroutin_continuation_base) {
     stats.kotlin_coroutine_continuation_base++;
@@ -130,14 +127,11 @@ PrintKotlinStats::Stats PrintKotlinStats::handle_class(DexClass* cls) {
     stats.di_generated_class++;
   }
 
-  for (auto* field : cls->get_sfields()) {
-    if (field->get_name() == m_instance &&
-        field->get_type() == cls->get_type()) {
-      if (is_lambda) {
-        stats.kotlin_non_capturing_lambda++;
-      }
-      stats.kotlin_class_with_instance++;
+  if (shape.instance_field != nullptr) {
+    if (shape.is_lambda) {
+      stats.kotlin_non_capturing_lambda++;
     }
+    stats.kotlin_class_with_instance++;
   }
   if (cls->rstate.is_cls_kotlin()) {
     stats.kotlin_class++;
@@ -9,6 +9,7 @@
 
 #include "DexClass.h"
 #include "DexUtil.h"
+#include "KotlinShapes.h"
 #include "Pass.h"
 
 class PrintKotlinStats : public Pass {
@@ -74,14 +75,12 @@ class PrintKotlinStats : public Pass {
   void eval_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
   Stats handle_method(DexMethod* method);
-  Stats handle_class(DexClass* cls);
+  Stats handle_class(DexClass* cls, const kotlin_shapes::ClassShape& shape);
   Stats get_stats() { return m_stats; }
 
  private:
   std::unordered_set<DexMethodRef*> m_kotlin_null_assertions;
-  DexType* m_kotlin_lambdas_base = nullptr;
   DexType* m_kotlin_coroutin_continuation_base = nullptr;
-  const DexString* m_instance = nullptr;
   DexType* m_di_base = nullptr;
   Stats m_stats;
 };
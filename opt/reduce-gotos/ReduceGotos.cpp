@@ -282,6 +282,26 @@ void ReduceGotosPass::process_code_switches(cfg::ControlFlowGraph& cfg,
 
 namespace {
 
+// Whether some block consisting of a single instruction accepted by the
+// filters is the target of a goto edge. Checking this first saves computing a
+// block order for the vast majority of methods, where there is nothing to do.
+template <typename BlockFilter, typename OpcodeFilter>
+bool has_goto_targets_to_inline(const cfg::ControlFlowGraph& cfg,
+                                const BlockFilter& block_filter,
+                                const OpcodeFilter& opcode_filter) {
+  for (cfg::Block* b : cfg.blocks()) {
+    auto last_mie_it = b->get_last_insn();
+    if (last_mie_it == b->end() || b->get_first_insn() != last_mie_it ||
+        !opcode_filter(last_mie_it->insn->opcode()) || block_filter(b)) {
+      continue;
+    }
+    if (cfg.get_pred_edge_of_type(b, cfg::EDGE_GOTO) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
 template <typename Blocks,
           typename BlockFilter,
           typename OpcodeFilter,
@@ -449,12 +469,22 @@ void ReduceGotosPass::process_code_ifs(cfg::ControlFlowGraph& cfg,
   // Small bonus optimization: Also eliminate move instructions that only exist
   // to faciliate shared return or throw instructions.
 
+  auto inline_goto_targets = [&cfg](const auto& block_filter,
+                                    const auto& opcode_filter,
+                                    const auto& force_block_check) {
+    if (!has_goto_targets_to_inline(cfg, block_filter, opcode_filter)) {
+      return std::make_tuple(false, size_t(0), size_t(0));
+    }
+    return process_code_ifs_impl(cfg.order(), cfg, block_filter, opcode_filter,
+                                 force_block_check);
+  };
+
   bool rerun;
   do {
     rerun = false;
     {
-      auto return_res = process_code_ifs_impl(
-          cfg.order(), cfg, [](const cfg::Block* b) { return false; },
+      auto return_res = inline_goto_targets(
+          [](const cfg::Block* b) { return false; },
           [](IROpcode op) { return opcode::is_a_return(op); },
           [](const cfg::Block* to, const cfg::Block* from) { return false; });
       rerun = std::get<0>(return_res);
@@ -462,8 +492,7 @@ void ReduceGotosPass::process_code_ifs(cfg::ControlFlowGraph& cfg,
       stats.replaced_gotos_with_returns += std::get<2>(return_res);
     }
     {
-      auto throw_res = process_code_ifs_impl(
-          cfg.order(), cfg,
+      auto throw_res = inline_goto_targets(
           [&cfg](const cfg::Block* b) {
             return !cfg.get_succ_edges_of_type(b, cfg::EDGE_THROW).empty();
           },
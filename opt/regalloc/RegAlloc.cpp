@@ -7,11 +7,16 @@
 
 #include "RegAlloc.h"
 
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
 #include "Debug.h"
 #include "DexUtil.h"
 #include "GraphColoring.h"
 #include "PassManager.h"
 #include "RegisterAllocation.h"
+#include "Show.h"
 #include "Trace.h"
 #include "Walkers.h"
 
@@ -32,11 +37,77 @@ void RegAllocPass::run_pass(DexStoresVector& stores,
   allocator_config.no_overwrite_this =
       mgr.get_redex_options().no_overwrite_this();
 
+  // Very large (typically generated) methods dominate the allocation time.
+  // For those we fall back to a configuration without coalescing and
+  // splitting, which gives up on some moves to bound the allocation time.
+  size_t fast_mode_min_insns;
+  size_t fast_mode_min_regs;
+  jw.get("fast_mode_min_insns", 0, fast_mode_min_insns);
+  jw.get("fast_mode_min_regs", 0, fast_mode_min_regs);
+  auto fast_allocator_config = allocator_config;
+  fast_allocator_config.use_coalescing = false;
+  fast_allocator_config.use_splitting = false;
+
+  struct MethodTime {
+    std::chrono::microseconds time;
+    size_t insns;
+    const DexMethod* method;
+  };
+  std::mutex method_times_mutex;
+  std::vector<MethodTime> method_times;
+  std::atomic<size_t> fast_mode_methods{0};
+
   auto scope = build_class_scope(stores);
   auto stats = walk::parallel::methods<Stats>(scope, [&](DexMethod* m) {
-    return graph_coloring::allocate(allocator_config, m);
+    auto* code = m->get_code();
+    if (code == nullptr) {
+      return Stats();
+    }
+    always_assert(code->editable_cfg_built());
+    auto insns = code->cfg().num_opcodes();
+    bool fast_mode =
+        (fast_mode_min_insns > 0 && insns >= fast_mode_min_insns) ||
+        (fast_mode_min_regs > 0 &&
+         code->cfg().get_registers_size() >= fast_mode_min_regs);
+    if (fast_mode) {
+      fast_mode_methods++;
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto method_stats = graph_coloring::allocate(
+        fast_mode ? fast_allocator_config : allocator_config, m);
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::lock_guard<std::mutex> lock(method_times_mutex);
+    method_times.push_back({time, insns, m});
+    return method_stats;
   });
 
+  std::sort(method_times.begin(), method_times.end(),
+            [](const MethodTime& a, const MethodTime& b) {
+              if (a.time != b.time) {
+                return a.time > b.time;
+              }
+              return compare_dexmethods(a.method, b.method);
+            });
+  for (size_t i = 0; i < std::min<size_t>(10, method_times.size()); i++) {
+    const auto& mt = method_times[i];
+    TRACE(REG, 1, "Slow allocation: %s (%zu insns) took %zuus",
+          SHOW(mt.method), mt.insns, (size_t)mt.time.count());
+  }
+  auto percentile_us = [&](size_t p) -> size_t {
+    if (method_times.empty()) {
+      return 0;
+    }
+    // method_times is sorted by decreasing time.
+    size_t idx = (method_times.size() - 1) * (100 - p) / 100;
+    return method_times[idx].time.count();
+  };
+  mgr.incr_metric("fast_mode_methods", fast_mode_methods.load());
+  mgr.incr_metric("method_alloc_time_us_p50", percentile_us(50));
+  mgr.incr_metric("method_alloc_time_us_p90", percentile_us(90));
+  mgr.incr_metric("method_alloc_time_us_p99", percentile_us(99));
+  mgr.incr_metric("method_alloc_time_us_max", percentile_us(100));
+
   TRACE(REG, 1, "Total reiteration count: %zu", stats.reiteration_count);
   TRACE(REG, 1, "Total Params spilled early: %zu", stats.params_spill_early);
   TRACE(REG, 1, "Total spill count: %zu", stats.moves_inserted());
@@ -35,6 +35,13 @@ class RegAllocPass : public Pass {
   void bind_config() override {
     bool unused;
     bind("live_range_splitting", false, unused);
+    size_t unused_size;
+    bind("fast_mode_min_insns", 0, unused_size,
+         "Allocate methods with at least this many instructions without "
+         "coalescing or live-range splitting. 0 disables this.");
+    bind("fast_mode_min_regs", 0, unused_size,
+         "Allocate methods with at least this many registers without "
+         "coalescing or live-range splitting. 0 disables this.");
     trait(Traits::Pass::atleast, 1);
   }
 
@@ -7,9 +7,11 @@
 
 #include "RemoveBuilders.h"
 
+#include <algorithm>
 #include <boost/regex.hpp>
 #include <tuple>
 
+#include "ConcurrentContainers.h"
 #include "ConfigFiles.h"
 #include "Dataflow.h"
 #include "DexUtil.h"
@@ -242,9 +244,14 @@ void RemoveBuildersPass::run_pass(DexStoresVector& stores,
     }
   }
 
-  std::unordered_set<DexType*> escaped_builders;
-  walk::methods(scope, [&](DexMethod* m) {
+  ConcurrentSet<DexType*> escaped_builders;
+  walk::parallel::methods(scope, [&](DexMethod* m) {
     auto builders = created_builders(m);
+    // The escape analysis only depends on the builder type, so do it once per
+    // type even if the method creates several instances.
+    std::sort(builders.begin(), builders.end(), compare_dextypes);
+    builders.erase(std::unique(builders.begin(), builders.end()),
+                   builders.end());
     for (DexType* builder : builders) {
       if (escapes_stack(builder, m)) {
         TRACE(BUILDERS,
@@ -259,7 +266,7 @@ void RemoveBuildersPass::run_pass(DexStoresVector& stores,
 
   std::unordered_set<DexType*> stack_only_builders;
   for (DexType* builder : m_builders) {
-    if (escaped_builders.find(builder) == escaped_builders.end()) {
+    if (!escaped_builders.count(builder)) {
       stack_only_builders.emplace(builder);
     }
   }
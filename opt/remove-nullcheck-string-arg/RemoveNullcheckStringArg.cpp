@@ -199,20 +199,16 @@ DexMethod* RemoveNullcheckStringArg::get_wrapper_method_with_int_index(
   auto main_block = method_creator.get_main_block();
   auto int_ind = method_creator.get_local(1);
   auto str_type = DexType::get_type("Ljava/lang/String;");
-  auto str_builder_type = DexType::get_type("Ljava/lang/StringBuilder;");
+  auto str_builder_type = type::java_lang_StringBuilder();
   if (!str_type || !str_builder_type) {
     return nullptr;
   }
 
   auto to_str_method = DexMethod::get_method(
       "Ljava/lang/Integer;.toString:(I)Ljava/lang/String;");
-  auto str_builder_init_method =
-      DexMethod::get_method("Ljava/lang/StringBuilder;.<init>:()V");
-  auto append_method = DexMethod::get_method(
-      "Ljava/lang/StringBuilder;.append:(Ljava/lang/"
-      "String;)Ljava/lang/StringBuilder;");
-  auto str_builder_to_str_method = DexMethod::get_method(
-      "Ljava/lang/StringBuilder;.toString:()Ljava/lang/String;");
+  auto str_builder_init_method = method::java_lang_StringBuilder_init();
+  auto append_method = method::java_lang_StringBuilder_append_String();
+  auto str_builder_to_str_method = method::java_lang_StringBuilder_toString();
 
   if (!to_str_method || !append_method || !str_builder_to_str_method) {
     return nullptr;
@@ -21,6 +21,7 @@
 #include "ConfigFiles.h"
 #include "ControlFlow.h"
 #include "IRInstruction.h"
+#include "LocalPointersAnalysis.h"
 #include "MethodProfiles.h"
 #include "PassManager.h"
 #include "ReachingDefinitions.h"
@@ -670,6 +671,9 @@ struct Stats {
   size_t all_methods{1};
   size_t methods_with_locks{0};
   size_t removed{0};
+  size_t removed_thread_local{0};
+  size_t replaced_string_buffers{0};
+  size_t coarsened{0};
   std::unordered_set<DexMethod*> methods_with_issues;
   std::unordered_set<DexMethod*> non_singleton_rdefs;
 
@@ -683,6 +687,9 @@ struct Stats {
     all_methods += rhs.all_methods;
     methods_with_locks += rhs.methods_with_locks;
     removed += rhs.removed;
+    removed_thread_local += rhs.removed_thread_local;
+    replaced_string_buffers += rhs.replaced_string_buffers;
+    coarsened += rhs.coarsened;
     methods_with_issues.insert(rhs.methods_with_issues.begin(),
                                rhs.methods_with_issues.end());
     non_singleton_rdefs.insert(rhs.non_singleton_rdefs.begin(),
@@ -751,17 +758,323 @@ Stats run_locks_removal(DexMethod* m, IRCode* code) {
   return stats;
 }
 
+namespace elision {
+
+// StringBuffer methods that StringBuilder has, too, with StringBuffer results
+// turned into StringBuilder ones.
+const std::unordered_set<std::string_view> kStringBufferMethods = {
+    "<init>",      "append",        "capacity", "charAt",   "delete",
+    "deleteCharAt", "ensureCapacity", "indexOf",  "insert",   "lastIndexOf",
+    "length",      "replace",       "reverse",  "setCharAt", "setLength",
+    "substring",   "toString",      "trimToSize",
+};
+
+DexType* string_buffer_type() {
+  return DexType::make_type("Ljava/lang/StringBuffer;");
+}
+
+DexType* string_builder_type() {
+  return DexType::make_type("Ljava/lang/StringBuilder;");
+}
+
+bool is_modeled_string_buffer_method(const DexMethodRef* ref) {
+  if (ref->get_class() != string_buffer_type() ||
+      !kStringBufferMethods.count(ref->get_name()->str())) {
+    return false;
+  }
+  const auto* args = ref->get_proto()->get_args();
+  return std::find(args->begin(), args->end(), string_buffer_type()) ==
+         args->end();
+}
+
+// Neither java.lang.Object's constructor nor the modeled StringBuffer methods
+// let their receiver escape; the latter may return it.
+local_pointers::InvokeToSummaryMap get_invoke_summaries(
+    ControlFlowGraph& cfg) {
+  local_pointers::InvokeToSummaryMap summaries;
+  for (const auto& mie : cfg::InstructionIterable(cfg)) {
+    auto* insn = mie.insn;
+    if (!opcode::is_an_invoke(insn->opcode())) {
+      continue;
+    }
+    auto* ref = insn->get_method();
+    if (ref == method::java_lang_Object_ctor()) {
+      summaries.emplace(insn, local_pointers::EscapeSummary{});
+    } else if (is_modeled_string_buffer_method(ref)) {
+      local_pointers::EscapeSummary summary;
+      const auto* args = ref->get_proto()->get_args();
+      for (size_t i = 0; i < args->size(); ++i) {
+        if (!type::is_primitive(args->at(i))) {
+          summary.escaping_parameters.insert(i + 1);
+        }
+      }
+      if (ref->get_proto()->get_rtype() == string_buffer_type()) {
+        summary.returned_parameters = local_pointers::ParamSet{0};
+      }
+      summaries.emplace(insn, std::move(summary));
+    }
+  }
+  return summaries;
+}
+
+using AllowUseFn = std::function<bool(
+    const IRInstruction*, size_t, const local_pointers::PointerSet&)>;
+
+// Removes the allocations from `candidates` that may escape the method, are
+// returned or thrown, or have a use that `allow_use` rejects.
+void filter_thread_local(
+    ControlFlowGraph& cfg,
+    const local_pointers::FixpointIterator& fp_iter,
+    const AllowUseFn& allow_use,
+    std::unordered_set<const IRInstruction*>* candidates) {
+  for (auto* b : cfg.blocks()) {
+    auto env = fp_iter.get_entry_state_at(b);
+    if (env.is_bottom()) {
+      continue;
+    }
+    for (const auto& mie : ir_list::InstructionIterable{b}) {
+      auto* insn = mie.insn;
+      for (size_t i = 0; i < insn->srcs_size(); ++i) {
+        const auto& pointers = env.get_pointers(insn->src(i));
+        if (!pointers.is_value()) {
+          continue;
+        }
+        for (auto* pointer : pointers.elements()) {
+          if (!candidates->count(pointer)) {
+            continue;
+          }
+          auto op = insn->opcode();
+          if (opcode::is_a_return_value(op) || op == OPCODE_THROW ||
+              (allow_use && !allow_use(insn, i, pointers))) {
+            candidates->erase(pointer);
+          }
+        }
+      }
+      fp_iter.analyze_instruction(insn, &env);
+      for (auto it = candidates->begin(); it != candidates->end();) {
+        it = env.may_have_escaped(*it) ? candidates->erase(it) : std::next(it);
+      }
+    }
+  }
+}
+
+using GetFixpointIteratorFn =
+    std::function<const local_pointers::FixpointIterator&()>;
+
+size_t replace_string_buffers(ControlFlowGraph& cfg,
+                              const GetFixpointIteratorFn& get_fp_iter) {
+  std::unordered_set<const IRInstruction*> candidates;
+  for (const auto& mie : cfg::InstructionIterable(cfg)) {
+    if (mie.insn->opcode() == OPCODE_NEW_INSTANCE &&
+        mie.insn->get_type() == string_buffer_type()) {
+      candidates.insert(mie.insn);
+    }
+  }
+  if (candidates.empty()) {
+    return 0;
+  }
+  const auto& fp_iter = get_fp_iter();
+  // Every use must still type-check once the object is a StringBuilder.
+  auto allow_use = [](const IRInstruction* insn, size_t src_index,
+                      const local_pointers::PointerSet& pointers) {
+    auto op = insn->opcode();
+    if (opcode::is_an_invoke(op)) {
+      return src_index == 0 && pointers.elements().size() == 1 &&
+             is_modeled_string_buffer_method(insn->get_method());
+    }
+    return op == OPCODE_MOVE_OBJECT || opcode::is_a_monitor(op) ||
+           op == OPCODE_IF_EQZ || op == OPCODE_IF_NEZ || op == OPCODE_IF_EQ ||
+           op == OPCODE_IF_NE;
+  };
+  filter_thread_local(cfg, fp_iter, allow_use, &candidates);
+  if (candidates.empty()) {
+    return 0;
+  }
+
+  std::vector<std::pair<IRInstruction*, DexMethodRef*>> retargets;
+  for (auto* b : cfg.blocks()) {
+    auto env = fp_iter.get_entry_state_at(b);
+    if (env.is_bottom()) {
+      continue;
+    }
+    for (const auto& mie : ir_list::InstructionIterable{b}) {
+      auto* insn = mie.insn;
+      if (opcode::is_an_invoke(insn->opcode())) {
+        const auto& pointers = env.get_pointers(insn->src(0));
+        if (pointers.is_value() && pointers.elements().size() == 1 &&
+            candidates.count(*pointers.elements().begin())) {
+          auto* ref = insn->get_method();
+          auto* proto = ref->get_proto();
+          auto* rtype = proto->get_rtype() == string_buffer_type()
+                            ? string_builder_type()
+                            : proto->get_rtype();
+          retargets.emplace_back(
+              insn, DexMethod::make_method(
+                        string_builder_type(), ref->get_name(),
+                        DexProto::make_proto(rtype, proto->get_args())));
+        }
+      }
+      fp_iter.analyze_instruction(insn, &env);
+    }
+  }
+  for (auto [insn, ref] : retargets) {
+    insn->set_method(ref);
+  }
+  for (auto* insn : candidates) {
+    const_cast<IRInstruction*>(insn)->set_type(string_builder_type());
+  }
+  return candidates.size();
+}
+
+// The allocation that a monitor's lock object comes from, if any.
+const IRInstruction* get_allocation(ControlFlowGraph& cfg,
+                                    const IRInstruction* root_def) {
+  if (root_def->opcode() != IOPCODE_MOVE_RESULT_PSEUDO_OBJECT) {
+    return nullptr;
+  }
+  auto it = cfg.find_insn(const_cast<IRInstruction*>(root_def));
+  auto primary = cfg.primary_instruction_of_move_result(it);
+  return primary->insn->opcode() == OPCODE_NEW_INSTANCE ? primary->insn
+                                                        : nullptr;
+}
+
+size_t remove_thread_local_monitors(
+    ControlFlowGraph& cfg,
+    const analysis::RDefs& rdefs,
+    const local_pointers::FixpointIterator& fp_iter) {
+  std::unordered_map<const IRInstruction*, const IRInstruction*> allocations;
+  std::unordered_set<const IRInstruction*> candidates;
+  for (const auto& [monitor_insn, root_def] : rdefs) {
+    if (auto* allocation = get_allocation(cfg, root_def)) {
+      allocations.emplace(monitor_insn, allocation);
+      candidates.insert(allocation);
+    }
+  }
+  if (candidates.empty()) {
+    return 0;
+  }
+  filter_thread_local(cfg, fp_iter, nullptr, &candidates);
+
+  CFGMutation mutation(cfg);
+  size_t removed = 0;
+  for (const auto& [monitor_insn, allocation] : allocations) {
+    if (candidates.count(allocation)) {
+      mutation.remove(cfg.find_insn(const_cast<IRInstruction*>(monitor_insn)));
+      removed++;
+    }
+  }
+  mutation.flush();
+  return removed;
+}
+
+// Removes a monitor-exit that ends a block when its only successor starts
+// with a monitor-enter on the same object, so that the lock is just kept.
+size_t coarsen(ControlFlowGraph& cfg, const analysis::RDefs& rdefs) {
+  std::vector<std::pair<Block*, Block*>> pairs;
+  for (auto* b : cfg.blocks()) {
+    auto last_it = b->get_last_insn();
+    if (last_it == b->end() || last_it->insn->opcode() != OPCODE_MONITOR_EXIT) {
+      continue;
+    }
+    auto* succ = b->goes_to();
+    if (succ == nullptr || succ->preds().size() != 1) {
+      continue;
+    }
+    auto first_it = succ->get_first_insn();
+    if (first_it == succ->end() ||
+        first_it->insn->opcode() != OPCODE_MONITOR_ENTER ||
+        rdefs.at(last_it->insn) != rdefs.at(first_it->insn)) {
+      continue;
+    }
+    pairs.emplace_back(b, succ);
+  }
+  for (auto [b, succ] : pairs) {
+    cfg.remove_insn(b->to_cfg_instruction_iterator(b->get_last_insn()));
+    cfg.remove_insn(succ->to_cfg_instruction_iterator(succ->get_first_insn()));
+  }
+  return pairs.size() * 2;
+}
+
+} // namespace elision
+
+Stats run_lock_elision(DexMethod* m,
+                       IRCode* code,
+                       const RemoveRecursiveLocksPass::Config& config) {
+  always_assert(code->editable_cfg_built());
+  auto& cfg = code->cfg();
+  Stats stats{};
+  stats.all_methods = 0;
+  std::unique_ptr<local_pointers::FixpointIterator> fp_iter;
+  auto get_fp_iter = [&]() -> const local_pointers::FixpointIterator& {
+    if (!fp_iter) {
+      fp_iter = std::make_unique<local_pointers::FixpointIterator>(
+          cfg, elision::get_invoke_summaries(cfg));
+      fp_iter->run(local_pointers::Environment());
+    }
+    return *fp_iter;
+  };
+
+  if (config.replace_string_buffers) {
+    stats.replaced_string_buffers =
+        elision::replace_string_buffers(cfg, get_fp_iter);
+    if (stats.replaced_string_buffers > 0) {
+      fp_iter.reset();
+    }
+  }
+
+  if (!(config.elide_thread_local_locks || config.coarsen_locks) ||
+      !has_monitor_ops(cfg)) {
+    return stats;
+  }
+  auto analysis = analyze(cfg);
+  if (!analysis.method_with_locks || analysis.non_singleton_rdefs ||
+      analysis.method_with_issues) {
+    return stats;
+  }
+  if (config.elide_thread_local_locks) {
+    stats.removed_thread_local = elision::remove_thread_local_monitors(
+        cfg, analysis.rdefs, get_fp_iter());
+    if (stats.removed_thread_local > 0) {
+      cfg.simplify();
+      analysis = analyze(cfg);
+      if (!analysis.method_with_locks) {
+        return stats;
+      }
+    }
+  }
+  if (config.coarsen_locks) {
+    stats.coarsened = elision::coarsen(cfg, analysis.rdefs);
+    if (stats.coarsened > 0) {
+      cfg.simplify();
+    }
+  }
+
+  // Run analysis again just to check.
+  if (stats.removed_thread_local + stats.coarsened > 0 &&
+      has_monitor_ops(cfg)) {
+    auto analysis2 = analyze(cfg);
+    always_assert_log(!analysis2.non_singleton_rdefs, "%s: %s", SHOW(m),
+                      SHOW(cfg));
+    always_assert_log(!analysis2.method_with_issues, "%s: %s", SHOW(m),
+                      SHOW(cfg));
+  }
+  return stats;
+}
+
 void run_impl(DexStoresVector& stores,
               ConfigFiles& conf,
               PassManager& mgr,
+              const RemoveRecursiveLocksPass::Config& config,
               const char* stats_prefix = nullptr) {
   auto scope = build_class_scope(stores);
 
-  Stats stats =
-      walk::parallel::methods<Stats>(scope, [](DexMethod* method) -> Stats {
+  Stats stats = walk::parallel::methods<Stats>(
+      scope, [&config](DexMethod* method) -> Stats {
         auto code = method->get_code();
         if (code != nullptr && !method->rstate.no_optimizations()) {
-          return run_locks_removal(method, code);
+          auto stats = run_locks_removal(method, code);
+          stats += run_lock_elision(method, code, config);
+          return stats;
         }
         return Stats{};
       });
@@ -817,6 +1130,9 @@ void run_impl(DexStoresVector& stores,
     }
   }
   print("removed", stats.removed);
+  print("removed_thread_local", stats.removed_thread_local);
+  print("replaced_string_buffers", stats.replaced_string_buffers);
+  print("coarsened", stats.coarsened);
 
   auto print_counts = [&print](const auto& counts, const std::string& prefix) {
     size_t last = counts.size() - 1;
@@ -859,12 +1175,20 @@ bool RemoveRecursiveLocksPass::run(DexMethod* method, IRCode* code) {
          stats.non_singleton_rdefs.empty();
 }
 
+size_t RemoveRecursiveLocksPass::elide(DexMethod* method,
+                                       IRCode* code,
+                                       const Config& config) {
+  auto stats = run_lock_elision(method, code, config);
+  return stats.removed_thread_local + stats.replaced_string_buffers +
+         stats.coarsened;
+}
+
 void RemoveRecursiveLocksPass::run_pass(DexStoresVector& stores,
                                         ConfigFiles& conf,
                                         PassManager& mgr) {
-  run_impl(stores, conf, mgr);
+  run_impl(stores, conf, mgr, m_config);
   if (kDebugPass) {
-    run_impl(stores, conf, mgr, "debug_2nd_");
+    run_impl(stores, conf, mgr, m_config, "debug_2nd_");
   }
 }
 
@@ -12,9 +12,19 @@
 class DexMethod;
 class IRCode;
 
-// A pass to remove recursive locks, usually exposed during inlining.
+// A pass to remove recursive locks, usually exposed during inlining. It also
+// elides locking that cannot be contended: monitors on objects that never
+// escape the method are removed, non-escaping StringBuffers are turned into
+// StringBuilders, and a lock that is released and immediately re-acquired is
+// held throughout instead.
 class RemoveRecursiveLocksPass : public Pass {
  public:
+  struct Config {
+    bool elide_thread_local_locks{true};
+    bool replace_string_buffers{true};
+    bool coarsen_locks{true};
+  };
+
   RemoveRecursiveLocksPass() : Pass("RemoveRecursiveLocksPass") {}
 
   redex_properties::PropertyInteractions get_property_interactions()
@@ -28,9 +38,28 @@ class RemoveRecursiveLocksPass : public Pass {
     };
   }
 
+  void bind_config() override {
+    bind("elide_thread_local_locks", true, m_config.elide_thread_local_locks,
+         "Remove monitors on objects allocated in the method that never "
+         "escape it");
+    bind("replace_string_buffers", true, m_config.replace_string_buffers,
+         "Replace StringBuffers that never escape the method with "
+         "StringBuilders");
+    bind("coarsen_locks", true, m_config.coarsen_locks,
+         "Merge a monitor-exit that is directly followed by a monitor-enter "
+         "on the same object");
+  }
+
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
 
   // For testing, only. As long as the run will not fail, it is permissible
   // to give method=nullptr.
   static bool run(DexMethod* method, IRCode* code);
+
+  // For testing, only. Returns the number of removed or rewritten
+  // instructions.
+  static size_t elide(DexMethod* method, IRCode* code, const Config& config);
+
+ private:
+  Config m_config;
 };
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <fstream>
+#include <optional>
 #include <set>
 
 #include "ConfigFiles.h"
@@ -168,6 +169,68 @@ void write_out_removed_symbols_references(
   }
 }
 
+uint64_t mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return h;
+}
+
+template <class DexMember>
+void hash_member(size_t& hash, const DexMember* member) {
+  boost::hash_combine(hash, member);
+  boost::hash_combine(hash, member->get_access());
+  boost::hash_combine(hash, root(member));
+  boost::hash_combine(hash, member->rstate.can_rename());
+  if (const auto* anno_set = member->get_anno_set()) {
+    for (const auto& anno : anno_set->get_annotations()) {
+      boost::hash_combine(hash, anno->type());
+      boost::hash_combine(hash, anno->anno_elems().size());
+    }
+  }
+}
+
+/*
+ * A digest of everything that the reachability analysis looks at: classes and
+ * members with their keep state, access flags and annotations, and all
+ * instructions. Equal digests mean the analysis would find the same result.
+ * Classes are combined commutatively, so that reordering doesn't matter.
+ */
+uint64_t compute_scope_digest(const Scope& scope) {
+  std::atomic<uint64_t> digest{scope.size()};
+  walk::parallel::classes(scope, [&](DexClass* cls) {
+    size_t hash = 0;
+    hash_member(hash, cls);
+    boost::hash_combine(hash, cls->get_super_class());
+    boost::hash_combine(hash, cls->get_interfaces());
+    for (const auto* field : cls->get_all_fields()) {
+      hash_member(hash, field);
+      boost::hash_combine(hash, field->get_static_value());
+    }
+    for (auto* method : cls->get_all_methods()) {
+      hash_member(hash, method);
+      auto* code = method->get_code();
+      if (code == nullptr) {
+        continue;
+      }
+      auto hash_insn = [&hash](const IRInstruction* insn) {
+        boost::hash_combine(hash, insn->hash());
+      };
+      if (code->editable_cfg_built()) {
+        for (const auto& mie : cfg::ConstInstructionIterable(code->cfg())) {
+          hash_insn(mie.insn);
+        }
+      } else {
+        for (const auto& mie : ir_list::ConstInstructionIterable(*code)) {
+          hash_insn(mie.insn);
+        }
+      }
+    }
+    digest += mix(hash);
+  });
+  return digest;
+}
+
 } // namespace
 
 namespace mog = method_override_graph;
@@ -181,6 +244,22 @@ void RemoveUnreachablePassBase::run_pass(DexStoresVector& stores,
   auto sweep_code = m_prune_uninstantiable_insns || m_throw_propagation;
   auto scope = build_class_scope(stores);
   always_assert(!pm.unreliable_virtual_scopes());
+
+  // If an earlier run of this pass found nothing to do, and nothing changed
+  // since, this run wouldn't do anything either.
+  std::optional<uint64_t> digest;
+  bool unchanged = false;
+  if (m_skip_if_unchanged || m_check_skip_if_unchanged) {
+    digest = compute_scope_digest(scope);
+    unchanged = m_fixpoint_digest && *m_fixpoint_digest == *digest;
+    m_fixpoint_digest = std::nullopt;
+    if (unchanged && !m_check_skip_if_unchanged) {
+      TRACE(RMU, 1, "RMU: nothing changed since the last run, skipping");
+      pm.set_metric("skipped_unchanged", 1);
+      m_fixpoint_digest = digest;
+      return;
+    }
+  }
   auto method_override_graph = mog::build_graph(scope);
   std::unique_ptr<init_classes::InitClassesWithSideEffects>
       init_classes_with_side_effects;
@@ -290,6 +369,16 @@ void RemoveUnreachablePassBase::run_pass(DexStoresVector& stores,
                                            references);
     }
   }
+  if (digest) {
+    auto digest_after = compute_scope_digest(build_class_scope(stores));
+    always_assert_log(!unchanged || digest_after == *digest,
+                      "RemoveUnreachable changed a program that was unchanged "
+                      "since its last run without effect");
+    if (digest_after == *digest) {
+      m_fixpoint_digest = digest;
+    }
+  }
+
   if (emit_graph_this_run) {
     {
       std::ofstream os;
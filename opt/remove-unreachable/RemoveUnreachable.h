@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "Pass.h"
 #include "Reachability.h"
 
@@ -52,6 +54,12 @@ class RemoveUnreachablePassBase : public Pass {
          false,
          m_prune_unreferenced_interfaces);
     bind("throw_propagation", false, m_throw_propagation);
+    bind("skip_if_unchanged", false, m_skip_if_unchanged,
+         "Skip a run when an earlier run of this pass removed nothing and the "
+         "program hasn't changed since.");
+    bind("check_skip_if_unchanged", false, m_check_skip_if_unchanged,
+         "Run even when skip_if_unchanged would skip, and check that the run "
+         "doesn't change anything.");
   }
 
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
@@ -88,6 +96,11 @@ class RemoveUnreachablePassBase : public Pass {
   bool m_prune_uncallable_virtual_methods = false;
   bool m_prune_unreferenced_interfaces = false;
   bool m_throw_propagation = false;
+  bool m_skip_if_unchanged = false;
+  bool m_check_skip_if_unchanged = false;
+  // Digest of the program after the last run of this pass, if that run
+  // didn't change anything.
+  std::optional<uint64_t> m_fixpoint_digest;
 };
 
 class RemoveUnreachablePass : public RemoveUnreachablePassBase {
@@ -7,6 +7,7 @@
 
 #include "RemoveUnusedArgs.h"
 
+#include <atomic>
 #include <deque>
 #include <mutex>
 #include <unordered_map>
@@ -27,6 +28,7 @@
 #include "Resolver.h"
 #include "Show.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 using namespace opt_metadata;
 
@@ -60,7 +62,12 @@ constexpr const char* METRIC_ITERATIONS = "iterations";
 RemoveArgs::PassStats RemoveArgs::run(ConfigFiles& config) {
   RemoveArgs::PassStats pass_stats;
   gather_results_used();
-  auto override_graph = mog::build_graph(m_scope);
+  std::unique_ptr<const mog::Graph> owned_override_graph;
+  const mog::Graph* override_graph = m_override_graph;
+  if (override_graph == nullptr) {
+    owned_override_graph = mog::build_graph(m_scope);
+    override_graph = owned_override_graph.get();
+  }
   compute_reordered_protos(*override_graph);
   auto method_stats =
       update_method_protos(*override_graph, config.get_do_not_devirt_anon());
@@ -78,6 +85,39 @@ RemoveArgs::PassStats RemoveArgs::run(ConfigFiles& config) {
   return pass_stats;
 }
 
+CallerIndex::CallerIndex(const Scope& scope) {
+  walk::parallel::code(scope, [&](DexMethod* caller, IRCode& code) {
+    always_assert(code.editable_cfg_built());
+    std::unordered_set<const DexMethod*> callees;
+    for (const auto& mie : InstructionIterable(code.cfg())) {
+      auto insn = mie.insn;
+      if (!opcode::is_an_invoke(insn->opcode())) {
+        continue;
+      }
+      auto callee = insn->get_method()->as_def();
+      if (callee != nullptr) {
+        callees.insert(callee);
+      }
+    }
+    for (auto* callee : callees) {
+      m_callers.update(callee,
+                       [caller](const DexMethod*,
+                                std::vector<DexMethod*>& callers,
+                                bool /* exists */) {
+                         callers.push_back(caller);
+                       });
+    }
+  });
+}
+
+void CallerIndex::add_callers_of(
+    const DexMethod* callee, std::unordered_set<DexMethod*>* callers) const {
+  auto it = m_callers.find(callee);
+  if (it != m_callers.end()) {
+    callers->insert(it->second.begin(), it->second.end());
+  }
+}
+
 /**
  * Inspects all invoke instructions, and whether they are followed by
  * move-result instructions, and record this information for each method.
@@ -721,41 +761,54 @@ size_t RemoveArgs::update_callsite(IRInstruction* instr) {
  * removed.
  */
 std::pair<size_t, LocalDce::Stats> RemoveArgs::update_callsites() {
-  // Walk through all methods to look for and edit callsites.
   std::mutex local_dce_stats_mutex;
   LocalDce::Stats local_dce_stats{};
-  auto cnt = walk::parallel::methods<size_t>(
-      m_scope, [&](DexMethod* method) -> size_t {
-        auto code = method->get_code();
-        if (code == nullptr) {
-          return 0;
-        }
-        always_assert(code->editable_cfg_built());
-        auto& cfg = code->cfg();
-        size_t callsite_args_removed = 0;
-        for (const auto& mie : InstructionIterable(cfg)) {
-          auto insn = mie.insn;
-          if (opcode::is_an_invoke(insn->opcode())) {
-            size_t insn_args_removed = update_callsite(insn);
-            if (insn_args_removed > 0) {
-              log_opt(CALLSITE_ARGS_REMOVED, method, insn);
-              callsite_args_removed += insn_args_removed;
-            }
-          }
+  auto update_caller = [&](DexMethod* method) -> size_t {
+    auto code = method->get_code();
+    if (code == nullptr) {
+      return 0;
+    }
+    always_assert(code->editable_cfg_built());
+    auto& cfg = code->cfg();
+    size_t callsite_args_removed = 0;
+    for (const auto& mie : InstructionIterable(cfg)) {
+      auto insn = mie.insn;
+      if (opcode::is_an_invoke(insn->opcode())) {
+        size_t insn_args_removed = update_callsite(insn);
+        if (insn_args_removed > 0) {
+          log_opt(CALLSITE_ARGS_REMOVED, method, insn);
+          callsite_args_removed += insn_args_removed;
         }
+      }
+    }
 
-        if (callsite_args_removed) {
-          run_cleanup(method,
-                      cfg,
-                      &m_init_classes_with_side_effects,
-                      m_pure_methods,
-                      local_dce_stats_mutex,
-                      local_dce_stats);
-        }
+    if (callsite_args_removed) {
+      run_cleanup(method,
+                  cfg,
+                  &m_init_classes_with_side_effects,
+                  m_pure_methods,
+                  local_dce_stats_mutex,
+                  local_dce_stats);
+    }
 
-        return callsite_args_removed;
-      });
-  return std::make_pair(cnt, local_dce_stats);
+    return callsite_args_removed;
+  };
+
+  if (m_caller_index == nullptr) {
+    // Walk through all methods to look for and edit callsites.
+    auto cnt = walk::parallel::methods<size_t>(m_scope, update_caller);
+    return std::make_pair(cnt, local_dce_stats);
+  }
+
+  // Only visit the methods that may invoke an updated method.
+  std::unordered_set<DexMethod*> callers;
+  for (auto& p : m_live_arg_idxs_map) {
+    m_caller_index->add_callers_of(p.first, &callers);
+  }
+  std::atomic<size_t> cnt{0};
+  workqueue_run<DexMethod*>(
+      [&](DexMethod* method) { cnt += update_caller(method); }, callers);
+  return std::make_pair(cnt.load(), local_dce_stats);
 }
 
 void RemoveUnusedArgsPass::run_pass(DexStoresVector& stores,
@@ -773,10 +826,15 @@ void RemoveUnusedArgsPass::run_pass(DexStoresVector& stores,
   size_t num_iterations = 0;
   LocalDce::Stats local_dce_stats;
   auto pure_methods = get_pure_methods();
+  // Built once: changed virtual methods get fresh names, so that override
+  // relations are preserved across iterations, and see CallerIndex.
+  auto override_graph = mog::build_graph(scope);
+  CallerIndex caller_index(scope);
   while (true) {
     num_iterations++;
     RemoveArgs rm_args(scope, init_classes_with_side_effects, m_blocklist,
-                       pure_methods, m_total_iterations++);
+                       pure_methods, m_total_iterations++,
+                       override_graph.get(), &caller_index);
     auto pass_stats = rm_args.run(conf);
     if (pass_stats.methods_updated_count == 0) {
       break;
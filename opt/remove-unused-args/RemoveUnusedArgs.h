@@ -8,6 +8,8 @@
 #pragma once
 
 #include <mutex>
+#include <unordered_set>
+#include <vector>
 
 #include "ConcurrentContainers.h"
 #include "ControlFlow.h"
@@ -25,6 +27,24 @@ std::deque<uint16_t> compute_live_args(
     size_t num_args,
     std::vector<cfg::InstructionIterator>* dead_insns);
 
+/**
+ * Maps each method to the methods whose code invokes it by a reference that is
+ * the method itself, which is the only kind of call site RemoveArgs updates.
+ * RemoveArgs only ever removes invokes, and keeps the identity of the methods
+ * it changes, so an index built once stays a superset of the actual callers
+ * across iterations.
+ */
+class CallerIndex {
+ public:
+  explicit CallerIndex(const Scope& scope);
+
+  void add_callers_of(const DexMethod* callee,
+                      std::unordered_set<DexMethod*>* callers) const;
+
+ private:
+  ConcurrentMap<const DexMethod*, std::vector<DexMethod*>> m_callers;
+};
+
 class RemoveArgs {
  public:
   struct MethodStats {
@@ -48,12 +68,16 @@ class RemoveArgs {
                  init_classes_with_side_effects,
              const std::vector<std::string>& blocklist,
              const std::unordered_set<DexMethodRef*>& pure_methods,
-             size_t iteration = 0)
+             size_t iteration = 0,
+             const mog::Graph* override_graph = nullptr,
+             const CallerIndex* caller_index = nullptr)
       : m_scope(scope),
         m_init_classes_with_side_effects(init_classes_with_side_effects),
         m_blocklist(blocklist),
         m_iteration(iteration),
-        m_pure_methods(pure_methods) {}
+        m_pure_methods(pure_methods),
+        m_override_graph(override_graph),
+        m_caller_index(caller_index) {}
   RemoveArgs::PassStats run(ConfigFiles& conf);
 
  private:
@@ -75,6 +99,10 @@ class RemoveArgs {
   const std::vector<std::string>& m_blocklist;
   size_t m_iteration;
   const std::unordered_set<DexMethodRef*>& m_pure_methods;
+  // Shared across iterations when given; otherwise, the override graph is
+  // built for this iteration, and all methods are scanned for call sites.
+  const mog::Graph* m_override_graph;
+  const CallerIndex* m_caller_index;
 
   DexTypeList::ContainerType get_live_arg_type_list(
       DexMethod* method, const std::deque<uint16_t>& live_arg_idxs);
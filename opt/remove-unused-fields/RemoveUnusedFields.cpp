@@ -22,6 +22,7 @@
 #include "Shrinker.h"
 #include "Trace.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 using namespace remove_unused_fields;
 using namespace shrinker;
@@ -39,6 +40,17 @@ bool has_non_zero_static_value(DexField* field) {
   return ev != nullptr && !ev->is_zero();
 }
 
+// Fields which became removable in a particular iteration.
+struct RemovableFields {
+  std::unordered_set<const DexField*> unread;
+  std::unordered_set<const DexField*> unwritten;
+  std::unordered_set<const DexField*> zero_written;
+
+  bool empty() const {
+    return unread.empty() && unwritten.empty() && zero_written.empty();
+  }
+};
+
 class RemoveUnusedFields final {
  public:
   RemoveUnusedFields(const Config& config,
@@ -54,9 +66,24 @@ class RemoveUnusedFields final {
                    scope,
                    m_init_classes_with_side_effects,
                    shrinker_config,
-                   min_sdk) {
-    analyze();
-    transform();
+                   min_sdk),
+        m_field_access_index(scope) {
+    for (size_t iteration = 0; iteration < m_config.max_iterations;
+         ++iteration) {
+      auto new_fields = analyze();
+      if (new_fields.empty()) {
+        break;
+      }
+      auto changed_methods = transform(new_fields);
+      TRACE(RMUF, 2, "iteration %zu: changed methods %zu", iteration,
+            changed_methods.size());
+      if (changed_methods.empty()) {
+        break;
+      }
+      // Transforming and shrinking may have removed the last reads or writes
+      // of other fields.
+      m_field_access_index.update(changed_methods);
+    }
   }
 
   const std::unordered_set<const DexField*>& unread_fields() const {
@@ -114,9 +141,11 @@ class RemoveUnusedFields final {
     return false;
   }
 
-  void analyze() {
+  // Classifies the fields of the scope, and returns the newly found removable
+  // fields.
+  RemovableFields analyze() {
     field_op_tracker::FieldStatsMap field_stats =
-        field_op_tracker::analyze(m_scope);
+        m_field_access_index.get_field_stats();
 
     std::unique_ptr<field_op_tracker::FieldWrites> field_writes;
     if (m_config.remove_zero_written_fields ||
@@ -129,6 +158,7 @@ class RemoveUnusedFields final {
           field_writes.get());
     }
 
+    RemovableFields new_fields;
     for (auto& pair : field_stats) {
       auto* field = pair.first;
       auto& stats = pair.second;
@@ -141,7 +171,9 @@ class RemoveUnusedFields final {
             is_synthetic(field));
       if (can_remove(field) && !is_blocklisted(field)) {
         if (m_config.remove_unread_fields && stats.reads == 0) {
-          m_unread_fields.emplace(field);
+          if (m_unread_fields.emplace(field).second) {
+            new_fields.unread.emplace(field);
+          }
           if (m_config.remove_vestigial_objects_written_fields &&
               !field_writes->non_vestigial_objects_written_fields.count_unsafe(
                   field)) {
@@ -149,11 +181,15 @@ class RemoveUnusedFields final {
           }
         } else if (m_config.remove_unwritten_fields && stats.writes == 0 &&
                    !has_non_zero_static_value(field)) {
-          m_unwritten_fields.emplace(field);
+          if (m_unwritten_fields.emplace(field).second) {
+            new_fields.unwritten.emplace(field);
+          }
         } else if (m_config.remove_zero_written_fields &&
                    !field_writes->non_zero_written_fields.count_unsafe(field) &&
                    !has_non_zero_static_value(field)) {
-          m_zero_written_fields.emplace(field);
+          if (m_zero_written_fields.emplace(field).second) {
+            new_fields.zero_written.emplace(field);
+          }
         }
       }
     }
@@ -164,15 +200,27 @@ class RemoveUnusedFields final {
           2,
           "vestigial objects written_fields %zu",
           m_vestigial_objects_written_fields.size());
+    return new_fields;
   }
 
-  void transform() {
+  // Returns the changed methods.
+  std::vector<const DexMethod*> transform(const RemovableFields& new_fields) {
+    // Only methods accessing the newly found fields need to be visited.
+    std::unordered_set<const DexField*> fields;
+    fields.insert(new_fields.unread.begin(), new_fields.unread.end());
+    fields.insert(new_fields.unwritten.begin(), new_fields.unwritten.end());
+    fields.insert(new_fields.zero_written.begin(),
+                  new_fields.zero_written.end());
+    auto accessors = m_field_access_index.get_accessors(fields);
+    std::vector<const DexMethod*> methods(accessors.begin(), accessors.end());
+    ConcurrentSet<const DexMethod*> changed_methods;
     // Replace reads to unwritten fields with appropriate const-0 instructions,
     // and remove the writes to unread fields.
-    walk::parallel::code(m_scope, [&](const DexMethod* method, IRCode& code) {
+    workqueue_run<const DexMethod*>([&](const DexMethod* method) {
       if (method->rstate.no_optimizations()) {
         return;
       }
+      auto& code = *const_cast<DexMethod*>(method)->get_code();
       always_assert(code.editable_cfg_built());
       auto& cfg = code.cfg();
       cfg::CFGMutation m(cfg);
@@ -187,7 +235,7 @@ class RemoveUnusedFields final {
         auto field = resolve_field(insn->get_field());
         bool replace_insn = false;
         bool remove_insn = false;
-        if (m_unread_fields.count(field)) {
+        if (new_fields.unread.count(field)) {
           if (can_remove_unread_field_put(field)) {
             always_assert(opcode::is_an_iput(insn->opcode()) ||
                           opcode::is_an_sput(insn->opcode()));
@@ -196,12 +244,12 @@ class RemoveUnusedFields final {
           } else {
             m_unremovable_unread_field_puts++;
           }
-        } else if (m_unwritten_fields.count(field)) {
+        } else if (new_fields.unwritten.count(field)) {
           always_assert(opcode::is_an_iget(insn->opcode()) ||
                         opcode::is_an_sget(insn->opcode()));
           TRACE(RMUF, 5, "Replacing %s with const 0", SHOW(insn));
           replace_insn = true;
-        } else if (m_zero_written_fields.count(field)) {
+        } else if (new_fields.zero_written.count(field)) {
           if (opcode::is_an_iput(insn->opcode()) ||
               opcode::is_an_sput(insn->opcode())) {
             TRACE(RMUF, 5, "Removing %s", SHOW(insn));
@@ -245,8 +293,11 @@ class RemoveUnusedFields final {
       m.flush();
       if (any_changes) {
         m_shrinker.shrink_method(const_cast<DexMethod*>(method));
+        changed_methods.insert(method);
       }
-    });
+    }, methods);
+    return std::vector<const DexMethod*>(changed_methods.begin(),
+                                         changed_methods.end());
   }
 
   const Config& m_config;
@@ -254,6 +305,7 @@ class RemoveUnusedFields final {
   const init_classes::InitClassesWithSideEffects
       m_init_classes_with_side_effects;
   Shrinker m_shrinker;
+  field_op_tracker::FieldAccessIndex m_field_access_index;
 
   std::unordered_set<const DexField*> m_unread_fields;
   std::unordered_set<const DexField*> m_unwritten_fields;
@@ -37,6 +37,7 @@ struct Config {
   std::unordered_set<const DexType*> blocklist_types;
   std::unordered_set<const DexType*> blocklist_classes;
   std::unordered_set<const DexType*> allowlist_types;
+  size_t max_iterations;
 };
 
 class PassImpl : public Pass {
@@ -76,6 +77,12 @@ class PassImpl : public Pass {
          m_config.allowlist_types,
          "Fields with these types that are otherwise eligible to be removed "
          "will be removed regardless of their lifetime dependencies.");
+    bind("max_iterations",
+         1,
+         m_config.max_iterations,
+         "Repeat the analysis and transformation as long as new fields become "
+         "removable, up to this many times. Later iterations only re-analyze "
+         "the changed methods.");
 
     // These options make it a bit more convenient to bisect the list of removed
     // fields to isolate one that's causing issues.
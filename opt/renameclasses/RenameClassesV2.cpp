@@ -8,6 +8,8 @@
 #include "RenameClassesV2.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/regex.hpp>
 #include <map>
@@ -16,6 +18,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "ConcurrentContainers.h"
 #include "ConfigFiles.h"
 #include "DexClass.h"
 #include "DexUtil.h"
@@ -380,38 +383,36 @@ RenameClassesPassV2::build_dont_rename_annotated() {
   return dont_rename_annotated;
 }
 
-static void sanity_check(const Scope& scope,
-                         const rewriter::TypeStringMap& name_mapping) {
-  std::vector<std::string> external_names_vec;
-  // Class.forName() expects strings of the form "foo.bar.Baz". We should be
-  // very suspicious if we see these strings in the string pool that
-  // correspond to the old name of a class that we have renamed...
-  for (const auto& it : name_mapping.get_class_map()) {
-    external_names_vec.push_back(
-        java_names::internal_to_external(it.first->str()));
-  }
-  std::unordered_set<std::string_view> external_names;
-  for (auto& s : external_names_vec) {
-    external_names.insert(s);
-  }
-  std::unordered_set<const DexString*> all_strings;
-  for (auto clazz : scope) {
-    clazz->gather_strings(all_strings);
-  }
-  int sketchy_strings = 0;
-  for (auto s : all_strings) {
-    if (external_names.find(s->str()) != external_names.end() ||
-        name_mapping.get_new_type_name(s)) {
-      TRACE(RENAME, 2, "Found %s in string pool after renaming", s->c_str());
-      sketchy_strings++;
+namespace {
+
+// Class.forName() expects strings of the form "foo.bar.Baz". We should be
+// very suspicious if we see these strings in the string pool that
+// correspond to the old name of a class that we have renamed...
+class SketchyStringFinder {
+ public:
+  explicit SketchyStringFinder(const rewriter::TypeStringMap& name_mapping)
+      : m_name_mapping(name_mapping) {
+    for (const auto& it : name_mapping.get_class_map()) {
+      m_external_names_vec.push_back(
+          java_names::internal_to_external(it.first->str()));
+    }
+    for (auto& s : m_external_names_vec) {
+      m_external_names.insert(s);
     }
   }
-  if (sketchy_strings > 0) {
-    fprintf(stderr,
-            "WARNING: Found a number of sketchy class-like strings after class "
-            "renaming. Re-run with TRACE=RENAME:2 for more details.\n");
+
+  bool is_sketchy(const DexString* s) const {
+    return m_external_names.count(s->str()) != 0 ||
+           m_name_mapping.get_new_type_name(s) != nullptr;
   }
-}
+
+ private:
+  const rewriter::TypeStringMap& m_name_mapping;
+  std::vector<std::string> m_external_names_vec;
+  std::unordered_set<std::string_view> m_external_names;
+};
+
+} // namespace
 
 std::string get_keep_rule(const DexClass* clazz) {
   if (keep_reason::Reason::record_keep_reasons()) {
@@ -999,19 +1000,47 @@ void RenameClassesPassV2::rename_classes(
       force_rename_map.add_type_name(pair.first, pair.second);
     }
   }
-  auto updated_instructions =
-      rewriter::rewrite_string_literal_instructions(scope, force_rename_map);
-  mgr.incr_metric(METRIC_REWRITTEN_CONST_STRINGS, updated_instructions);
 
-  /* Now we need to re-write the Signature annotations.  They use
-   * Strings rather than Type's, so they have to be explicitly
-   * handled.
+  /* We also need to re-write the Signature annotations. They use Strings
+   * rather than Type's, so they have to be explicitly handled.
+   *
+   * Both only touch the class they are found in, so they are done in a single
+   * walk over the scope, which also looks for strings that still mention the
+   * old names once the class is done.
    */
-  rewrite_dalvik_annotation_signature(scope, name_mapping);
+  SketchyStringFinder sketchy_finder(name_mapping);
+  std::atomic<uint32_t> updated_instructions{0};
+  InsertOnlyConcurrentSet<const DexString*> sketchy_strings;
+  walk::parallel::classes(scope, [&](DexClass* clazz) {
+    std::array<DexClass*, 1> classes{clazz};
+    walk::annotations(classes, [&](DexAnnotation* anno) {
+      rewriter::rewrite_dalvik_annotation_signature(anno, name_mapping);
+    });
+    if (!force_rename_map.get_class_map().empty()) {
+      walk::code(classes, [&](DexMethod*, IRCode& code) {
+        updated_instructions +=
+            rewriter::rewrite_string_literal_instructions(code,
+                                                          force_rename_map);
+      });
+    }
+
+    std::unordered_set<const DexString*> strings;
+    clazz->gather_strings(strings);
+    for (auto* s : strings) {
+      if (sketchy_finder.is_sketchy(s) && sketchy_strings.insert(s).second) {
+        TRACE(RENAME, 2, "Found %s in string pool after renaming", s->c_str());
+      }
+    }
+  });
+  mgr.incr_metric(METRIC_REWRITTEN_CONST_STRINGS, updated_instructions.load());
 
   rename_classes_in_layouts(name_mapping, mgr);
 
-  sanity_check(scope, name_mapping);
+  if (!sketchy_strings.empty()) {
+    fprintf(stderr,
+            "WARNING: Found a number of sketchy class-like strings after class "
+            "renaming. Re-run with TRACE=RENAME:2 for more details.\n");
+  }
 }
 
 void RenameClassesPassV2::rename_classes_in_layouts(
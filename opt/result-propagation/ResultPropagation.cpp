@@ -503,7 +503,8 @@ void ResultPropagationPass::run_pass(DexStoresVector& stores,
                                      ConfigFiles& /* conf */,
                                      PassManager& mgr) {
   const auto scope = build_class_scope(stores);
-  const auto method_override_graph = method_override_graph::build_graph(scope);
+  const auto method_override_graph =
+      MethodOverrideGraphAnalysisPass::get_or_build(mgr, scope);
   ReturnParamResolver resolver(*method_override_graph);
   const auto methods_which_return_parameter =
       find_methods_which_return_parameter(mgr, scope, resolver);
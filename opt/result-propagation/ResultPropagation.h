@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include "AnalysisUsage.h"
 #include "MethodOverrideGraph.h"
+#include "MethodOverrideGraphAnalysisPass.h"
 #include "Pass.h"
 #include "Resolver.h"
 
@@ -150,6 +152,10 @@ class ResultPropagationPass : public Pass {
          "Skip propagating results from selected callees.");
   }
 
+  void set_analysis_usage(AnalysisUsage& au) const override {
+    au.add_preserve_specific<MethodOverrideGraphAnalysisPass>();
+  }
+
   void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
 
  private:
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "SpeculativeDevirtualization.h"
+
+#include <atomic>
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
+#include "ConfigFiles.h"
+#include "ControlFlow.h"
+#include "DexClass.h"
+#include "IRCode.h"
+#include "IRInstruction.h"
+#include "PassManager.h"
+#include "Resolver.h"
+#include "Show.h"
+#include "SourceBlocks.h"
+#include "Trace.h"
+#include "TypeUtil.h"
+#include "Walkers.h"
+
+namespace mog = method_override_graph;
+
+namespace {
+
+constexpr const char* METRIC_PROFILED_CALL_SITES = "num_profiled_call_sites";
+constexpr const char* METRIC_GUARDED_INVOKES = "num_guarded_invokes";
+constexpr const char* METRIC_METHODS_WITH_GUARDS = "num_methods_with_guards";
+
+// The implementation the invoke dispatches to when the receiver is exactly
+// an instance of `receiver_type` or one of its subclasses, if that is a
+// single method which can be invoked from anywhere.
+DexMethod* get_speculated_target(const mog::Graph& graph,
+                                 const DexMethod* caller,
+                                 const IRInstruction* insn,
+                                 DexType* receiver_type) {
+  auto* ref = insn->get_method();
+  if (receiver_type == ref->get_class() ||
+      !type::check_cast(receiver_type, ref->get_class())) {
+    return nullptr;
+  }
+  auto* cls = type_class(receiver_type);
+  if (cls == nullptr || cls->is_external() || is_interface(cls) ||
+      !is_public(cls)) {
+    return nullptr;
+  }
+  auto* target = resolve_virtual(cls, ref->get_name(), ref->get_proto());
+  if (target == nullptr || target->is_external() || is_abstract(target) ||
+      !is_public(target) || !is_public(type_class(target->get_class()))) {
+    return nullptr;
+  }
+  if (!mog::get_overriding_methods(graph, target, /* include_interfaces */
+                                   false, receiver_type)
+           .empty()) {
+    return nullptr;
+  }
+  // Nothing to gain if the call site can only ever reach the target anyway.
+  if (resolve_invoke_method(insn, caller) == target &&
+      mog::get_overriding_methods(graph, target, /* include_interfaces */
+                                  false, ref->get_class())
+          .empty()) {
+    return nullptr;
+  }
+  return target;
+}
+
+// Turns
+//
+//   invoke-interface {v0, ...} LI;.m:()I
+//   move-result v1
+//
+// into
+//
+//   instance-of v0 LA;
+//   move-result-pseudo v2
+//   if-nez v2 :fast
+//   invoke-interface {v0, ...} LI;.m:()I
+//   move-result v1
+//   :join
+//   ...
+//   :fast
+//   check-cast v0 LA;
+//   move-result-pseudo-object v3
+//   invoke-virtual {v3, ...} LA;.m:()I
+//   move-result v1
+//   goto :join
+void guard_invoke(cfg::ControlFlowGraph& cfg,
+                  IRInstruction* insn,
+                  DexType* receiver_type) {
+  auto invoke_it = cfg.find_insn(insn);
+  auto move_result_it = cfg.move_result_of(invoke_it);
+  auto* move_result = move_result_it.is_end() ? nullptr : move_result_it->insn;
+  auto* slow_block = invoke_it.block();
+  auto* join_block =
+      cfg.split_block(move_result != nullptr ? move_result_it : invoke_it);
+  auto* guard_block = cfg.split_block_before(invoke_it);
+  if (cfg.entry_block() == slow_block) {
+    cfg.set_entry_block(guard_block);
+  }
+
+  auto receiver = insn->src(0);
+  auto is_instance = cfg.allocate_temp();
+  auto* is_instance_insn = (new IRInstruction(IOPCODE_MOVE_RESULT_PSEUDO))
+                               ->set_dest(is_instance);
+  guard_block->push_back({(new IRInstruction(OPCODE_INSTANCE_OF))
+                              ->set_type(receiver_type)
+                              ->set_src(0, receiver),
+                          is_instance_insn});
+  // instance-of may throw, in which case the guard was split.
+  auto* branch_block = cfg.find_insn(is_instance_insn, guard_block).block();
+
+  auto cast_receiver = cfg.allocate_temp();
+  auto* direct_invoke = new IRInstruction(OPCODE_INVOKE_VIRTUAL);
+  direct_invoke->set_method(DexMethod::make_method(
+      receiver_type, insn->get_method()->get_name(),
+      insn->get_method()->get_proto()));
+  direct_invoke->set_srcs_size(insn->srcs_size());
+  direct_invoke->set_src(0, cast_receiver);
+  for (size_t i = 1; i < insn->srcs_size(); i++) {
+    direct_invoke->set_src(i, insn->src(i));
+  }
+  std::vector<IRInstruction*> fast_insns{
+      (new IRInstruction(OPCODE_CHECK_CAST))
+          ->set_type(receiver_type)
+          ->set_src(0, receiver),
+      (new IRInstruction(IOPCODE_MOVE_RESULT_PSEUDO_OBJECT))
+          ->set_dest(cast_receiver),
+      direct_invoke};
+  if (move_result != nullptr) {
+    fast_insns.push_back(new IRInstruction(*move_result));
+  }
+
+  // When the invoke is in a try region, each throwing instruction of the fast
+  // path ends its own block, which gets the handlers of the original invoke.
+  bool throws =
+      cfg.get_succ_edge_of_type(slow_block, cfg::EDGE_THROW) != nullptr;
+  std::vector<std::vector<IRInstruction*>> segments(1);
+  for (auto* fast_insn : fast_insns) {
+    segments.back().push_back(fast_insn);
+    if (throws && opcode::may_throw(fast_insn->opcode())) {
+      segments.emplace_back();
+    }
+  }
+  auto* fast_block = join_block;
+  for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+    if (it->empty()) {
+      continue;
+    }
+    auto* block = cfg.create_block();
+    block->push_back(*it);
+    if (opcode::may_throw(it->back()->opcode())) {
+      cfg.copy_succ_edges_of_type(slow_block, block, cfg::EDGE_THROW);
+    }
+    cfg.add_edge(block, fast_block, cfg::EDGE_GOTO);
+    fast_block = block;
+  }
+  if (auto* sb = source_blocks::get_first_source_block(slow_block)) {
+    fast_block->insert_before(fast_block->begin(),
+                              std::make_unique<SourceBlock>(*sb));
+  }
+
+  cfg.create_branch(branch_block,
+                    (new IRInstruction(OPCODE_IF_NEZ))->set_src(0, is_instance),
+                    /* fls */ nullptr, /* tru */ fast_block);
+}
+
+} // namespace
+
+namespace speculative_devirtualization {
+
+Speculations read_receiver_profile(std::istream& input,
+                                   uint64_t min_calls,
+                                   uint64_t min_share_percent) {
+  std::unordered_map<
+      const DexMethodRef*,
+      std::unordered_map<const DexMethodRef*,
+                         std::unordered_map<DexType*, uint64_t>>>
+      counts;
+  std::string line;
+  std::vector<std::string> parts;
+  while (std::getline(input, line)) {
+    boost::split(parts, line, [](const auto& c) { return c == ','; });
+    if (parts.size() != 4) {
+      continue;
+    }
+    auto* caller = DexMethod::get_method(parts[0]);
+    auto* callee = DexMethod::get_method(parts[1]);
+    auto* type = DexType::get_type(parts[2]);
+    if (caller == nullptr || callee == nullptr || type == nullptr) {
+      TRACE(VIRT, 4, "[speculative-devirt] ignoring profile line %s",
+            line.c_str());
+      continue;
+    }
+    counts[caller][callee][type] += std::stoull(parts[3]);
+  }
+
+  Speculations speculations;
+  for (auto& [caller, call_sites] : counts) {
+    for (auto& [callee, types] : call_sites) {
+      uint64_t total = 0;
+      std::pair<DexType*, uint64_t> dominant{nullptr, 0};
+      for (auto& [type, count] : types) {
+        total += count;
+        if (dominant.first == nullptr || count > dominant.second ||
+            (count == dominant.second &&
+             compare_dextypes(type, dominant.first))) {
+          dominant = {type, count};
+        }
+      }
+      if (total >= min_calls &&
+          dominant.second * 100 >= total * min_share_percent) {
+        speculations[caller][callee] = dominant.first;
+      }
+    }
+  }
+  return speculations;
+}
+
+size_t speculate(const mog::Graph& graph,
+                 DexMethod* caller,
+                 const std::unordered_map<const DexMethodRef*, DexType*>&
+                     receiver_types) {
+  auto& cfg = caller->get_code()->cfg();
+  std::vector<std::pair<IRInstruction*, DexType*>> sites;
+  for (auto& mie : cfg::InstructionIterable(cfg)) {
+    auto* insn = mie.insn;
+    if (insn->opcode() != OPCODE_INVOKE_VIRTUAL &&
+        insn->opcode() != OPCODE_INVOKE_INTERFACE) {
+      continue;
+    }
+    auto it = receiver_types.find(insn->get_method());
+    if (it == receiver_types.end()) {
+      continue;
+    }
+    if (get_speculated_target(graph, caller, insn, it->second) == nullptr) {
+      continue;
+    }
+    sites.emplace_back(insn, it->second);
+  }
+  for (auto& [insn, receiver_type] : sites) {
+    TRACE(VIRT, 3, "[speculative-devirt] guarding %s in %s with %s", SHOW(insn),
+          SHOW(caller), SHOW(receiver_type));
+    guard_invoke(cfg, insn, receiver_type);
+  }
+  return sites.size();
+}
+
+} // namespace speculative_devirtualization
+
+void SpeculativeDevirtualizationPass::run_pass(DexStoresVector& stores,
+                                               ConfigFiles& /* unused */,
+                                               PassManager& mgr) {
+  if (!m_receiver_profile_file) {
+    TRACE(VIRT, 1, "[speculative-devirt] no receiver profile, skipping");
+    return;
+  }
+  std::ifstream input(*m_receiver_profile_file);
+  always_assert_log(input, "Cannot open receiver profile %s",
+                    m_receiver_profile_file->c_str());
+  auto speculations = speculative_devirtualization::read_receiver_profile(
+      input, m_min_calls, m_min_share_percent);
+  size_t profiled_call_sites = 0;
+  for (auto& [_, call_sites] : speculations) {
+    profiled_call_sites += call_sites.size();
+  }
+
+  auto scope = build_class_scope(stores);
+  auto graph = MethodOverrideGraphAnalysisPass::get_or_build(mgr, scope);
+  std::atomic<size_t> methods_with_guards{0};
+  size_t guarded = walk::parallel::methods<size_t>(
+      scope, [&](DexMethod* method) -> size_t {
+        auto it = speculations.find(method);
+        if (it == speculations.end() || method->get_code() == nullptr ||
+            method->rstate.no_optimizations()) {
+          return 0;
+        }
+        size_t res =
+            speculative_devirtualization::speculate(*graph, method, it->second);
+        if (res != 0) {
+          methods_with_guards++;
+        }
+        return res;
+      });
+  mgr.incr_metric(METRIC_PROFILED_CALL_SITES, profiled_call_sites);
+  mgr.incr_metric(METRIC_GUARDED_INVOKES, guarded);
+  mgr.incr_metric(METRIC_METHODS_WITH_GUARDS, methods_with_guards.load());
+}
+
+static SpeculativeDevirtualizationPass s_pass;
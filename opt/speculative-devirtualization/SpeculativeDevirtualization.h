@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <iosfwd>
+#include <unordered_map>
+
+#include "AnalysisUsage.h"
+#include "MethodOverrideGraphAnalysisPass.h"
+#include "Pass.h"
+
+class DexMethod;
+class DexMethodRef;
+class DexType;
+
+namespace speculative_devirtualization {
+
+// For each caller, the receiver type to speculate on per invoked method ref.
+using Speculations =
+    std::unordered_map<const DexMethodRef*,
+                       std::unordered_map<const DexMethodRef*, DexType*>>;
+
+/*
+ * Reads a receiver-type profile, one call site observation per line:
+ *
+ *   <caller>,<invoked method>,<receiver type>,<count>
+ *
+ * e.g. `LFoo;.bar:()V,LI;.m:()V,LA;,1234`. A call site is identified by its
+ * caller and the invoked method ref, so all invokes of the same method in a
+ * caller share one speculation. A receiver type is chosen when the call site
+ * was executed at least `min_calls` times, and the type accounts for at least
+ * `min_share_percent` of those calls. Lines naming unknown methods or types
+ * are ignored.
+ */
+Speculations read_receiver_profile(std::istream& input,
+                                   uint64_t min_calls,
+                                   uint64_t min_share_percent);
+
+/*
+ * Guards profiled invoke-virtual and invoke-interface instructions in
+ * `caller` with an instance-of check of the speculated receiver type. On the
+ * fast path the receiver is cast to that type, and the method is invoked on
+ * it, which the inliner can resolve to a single implementation. The original
+ * invoke remains on the slow path. Returns the number of guarded invokes.
+ */
+size_t speculate(const method_override_graph::Graph& graph,
+                 DexMethod* caller,
+                 const std::unordered_map<const DexMethodRef*, DexType*>&
+                     receiver_types);
+
+} // namespace speculative_devirtualization
+
+/*
+ * Uses receiver-type profiles to insert guarded direct calls at hot virtual
+ * and interface call sites. Should run before the inliner, which can then
+ * inline the guarded calls.
+ */
+class SpeculativeDevirtualizationPass : public Pass {
+ public:
+  SpeculativeDevirtualizationPass() : Pass("SpeculativeDevirtualizationPass") {}
+
+  redex_properties::PropertyInteractions get_property_interactions()
+      const override {
+    using namespace redex_properties::interactions;
+    using namespace redex_properties::names;
+    return {
+        {DexLimitsObeyed, Preserves},
+        {NoInitClassInstructions, Preserves},
+        {NoUnreachableInstructions, Preserves},
+        {RenameClass, Preserves},
+    };
+  }
+
+  void bind_config() override {
+    bind("receiver_profile", {boost::none}, m_receiver_profile_file,
+         "File with the receiver types observed at call sites; see "
+         "read_receiver_profile for the format.",
+         Configurable::bindflags::optionals::skip_empty_string);
+    bind("min_calls", UINT64_C(100), m_min_calls,
+         "Call sites executed fewer times than this are not speculated on.");
+    bind("min_share_percent", UINT64_C(90), m_min_share_percent,
+         "Share of calls at a call site the dominant receiver type must "
+         "account for.");
+  }
+
+  void set_analysis_usage(AnalysisUsage& au) const override {
+    au.add_preserve_specific<MethodOverrideGraphAnalysisPass>();
+  }
+
+  void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+
+ private:
+  boost::optional<std::string> m_receiver_profile_file;
+  uint64_t m_min_calls;
+  uint64_t m_min_share_percent;
+};
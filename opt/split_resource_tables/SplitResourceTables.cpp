@@ -7,6 +7,7 @@
 
 #include "SplitResourceTables.h"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
@@ -138,14 +139,11 @@ struct SplitCandidate {
 };
 
 uint32_t max_id(const std::vector<uint32_t>& sorted_res_ids, uint8_t type_id) {
-  uint32_t max = 0;
-  for (const auto& id : sorted_res_ids) {
-    if (GET_TYPE(id) > type_id) {
-      break;
-    }
-    max = id;
-  }
-  return max;
+  // Find the first id of any later type; the id just before it is the answer.
+  auto it = std::upper_bound(
+      sorted_res_ids.begin(), sorted_res_ids.end(), type_id,
+      [](uint8_t t, uint32_t id) { return t < GET_TYPE(id); });
+  return it == sorted_res_ids.begin() ? 0 : *std::prev(it);
 }
 
 // Given a type id, figure out if a substantial number of res ids from that type
@@ -176,13 +174,15 @@ size_t maybe_split_type(
   // amount of dead space the ID will contribute to a runny tally of the dead
   // space created by "C" among other IDs.
   std::map<std::set<android::ResTable_config>, ConfigSetStats> stats;
-  for (uint32_t id = type_to_movable_entries.at(type_id);
-       id <= max_id(res_table.sorted_res_ids, type_id);
+  auto last_id = max_id(res_table.sorted_res_ids, type_id);
+  for (uint32_t id = type_to_movable_entries.at(type_id); id <= last_id;
        id++) {
     auto config_set = res_table.get_configs_with_values(id);
     if (!config_set.empty() && config_set.size() < all_configs_size) {
-      stats[config_set].dead_space += all_configs_size - config_set.size();
-      stats[config_set].ids_with_values.emplace(id);
+      auto dead_space = all_configs_size - config_set.size();
+      auto& config_set_stats = stats[std::move(config_set)];
+      config_set_stats.dead_space += dead_space;
+      config_set_stats.ids_with_values.emplace(id);
     }
   }
   if (stats.empty()) {
@@ -112,21 +112,17 @@ struct ConcatenatorConfig {
   const DexMethodRef* to_string;
 
   ConcatenatorConfig() {
-    string_builder = DexType::get_type("Ljava/lang/StringBuilder;");
+    string_builder = type::java_lang_StringBuilder();
     always_assert(string_builder != nullptr);
-    string = DexType::get_type("Ljava/lang/String;");
+    string = type::java_lang_String();
     always_assert(string != nullptr);
-    init_void = DexMethod::get_method("Ljava/lang/StringBuilder;.<init>:()V");
+    init_void = method::java_lang_StringBuilder_init();
     always_assert(init_void != nullptr);
-    init_string = DexMethod::get_method(
-        "Ljava/lang/StringBuilder;.<init>:(Ljava/lang/String;)V");
+    init_string = method::java_lang_StringBuilder_init_String();
     always_assert(init_string != nullptr);
-    append = DexMethod::get_method(
-        "Ljava/lang/StringBuilder;.append:(Ljava/lang/String;)Ljava/lang/"
-        "StringBuilder;");
+    append = method::java_lang_StringBuilder_append_String();
     always_assert(append != nullptr);
-    to_string = DexMethod::get_method(
-        "Ljava/lang/StringBuilder;.toString:()Ljava/lang/String;");
+    to_string = method::java_lang_StringBuilder_toString();
     always_assert(to_string != nullptr);
   }
 };
@@ -24,11 +24,10 @@ using namespace stringbuilder_outliner;
 
 FixpointIterator::FixpointIterator(const cfg::ControlFlowGraph& cfg)
     : ir_analyzer::BaseIRAnalyzer<Environment>(cfg),
-      m_stringbuilder(DexType::get_type("Ljava/lang/StringBuilder;")),
-      m_stringbuilder_no_param_init(
-          DexMethod::get_method("Ljava/lang/StringBuilder;.<init>:()V")),
-      m_stringbuilder_init_with_string(DexMethod::get_method(
-          "Ljava/lang/StringBuilder;.<init>:(Ljava/lang/String;)V")),
+      m_stringbuilder(type::java_lang_StringBuilder()),
+      m_stringbuilder_no_param_init(method::java_lang_StringBuilder_init()),
+      m_stringbuilder_init_with_string(
+          method::java_lang_StringBuilder_init_String()),
       m_append_str(DexString::get_string("append")) {
   always_assert(m_stringbuilder != nullptr);
   always_assert(m_stringbuilder_init_with_string != nullptr);
@@ -108,13 +107,11 @@ void FixpointIterator::analyze_instruction(const IRInstruction* insn,
 Outliner::Outliner(Config config)
     : m_config(config),
       m_append_str(DexString::get_string("append")),
-      m_stringbuilder(DexType::get_type("Ljava/lang/StringBuilder;")),
-      m_stringbuilder_default_ctor(
-          DexMethod::get_method("Ljava/lang/StringBuilder;.<init>:()V")),
+      m_stringbuilder(type::java_lang_StringBuilder()),
+      m_stringbuilder_default_ctor(method::java_lang_StringBuilder_init()),
       m_stringbuilder_capacity_ctor(
-          DexMethod::get_method("Ljava/lang/StringBuilder;.<init>:(I)V")),
-      m_stringbuilder_tostring(DexMethod::get_method(
-          "Ljava/lang/StringBuilder;.toString:()Ljava/lang/String;")) {
+          method::java_lang_StringBuilder_init_int()),
+      m_stringbuilder_tostring(method::java_lang_StringBuilder_toString()) {
   always_assert(m_append_str);
   always_assert(m_stringbuilder);
   always_assert(m_stringbuilder_default_ctor);
@@ -198,7 +195,6 @@ void Outliner::gather_outline_candidate_typelists(
 void Outliner::analyze(IRCode& code) {
   always_assert(code.editable_cfg_built());
   auto& cfg = code.cfg();
-  cfg.calculate_exit_block();
 
   // Do a quick one-pass scan to see if the method has any instructions that may
   // be outlinable. Only do the more expensive fixpoint calculations if the
@@ -208,6 +204,8 @@ void Outliner::analyze(IRCode& code) {
     return;
   }
 
+  cfg.calculate_exit_block();
+
   auto tostring_instruction_to_state =
       gather_builder_states(cfg, tostring_instructions);
 
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "SwitchCasePeeling.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "ControlFlow.h"
+#include "DexClass.h"
+#include "IRCode.h"
+#include "IRInstruction.h"
+#include "InstructionLowering.h"
+#include "PassManager.h"
+#include "Show.h"
+#include "SourceBlocks.h"
+#include "Trace.h"
+#include "Walkers.h"
+
+namespace {
+
+constexpr const char* METRIC_SWITCHES_WITH_PEELED_CASES =
+    "num_switches_with_peeled_cases";
+constexpr const char* METRIC_PEELED_CASES = "num_peeled_cases";
+constexpr const char* METRIC_REMOVED_SWITCHES = "num_removed_switches";
+
+// The profile values of a source block summed over all interactions.
+boost::optional<float> get_hits(const SourceBlock* sb) {
+  if (sb == nullptr) {
+    return boost::none;
+  }
+  boost::optional<float> res;
+  sb->foreach_val([&res](const auto& val) {
+    if (val) {
+      res = res.get_value_or(0) + val->val;
+    }
+  });
+  return res;
+}
+
+bool is_sparse(std::vector<int32_t> keys) {
+  std::sort(keys.begin(), keys.end());
+  return instruction_lowering::CaseKeysExtent::from_ordered(keys)
+      .sufficiently_sparse();
+}
+
+} // namespace
+
+namespace switch_case_peeling {
+
+Stats process_cfg(cfg::ControlFlowGraph& cfg, const Config& config) {
+  Stats stats;
+  std::vector<cfg::Block*> switch_blocks;
+  for (auto* block : cfg.blocks()) {
+    if (block->branchingness() == opcode::BRANCH_SWITCH) {
+      switch_blocks.push_back(block);
+    }
+  }
+
+  for (auto* block : switch_blocks) {
+    auto* sb = source_blocks::get_last_source_block(block);
+    auto hits = get_hits(sb);
+    if (!hits || *hits <= 0) {
+      continue;
+    }
+    std::vector<std::pair<int32_t, cfg::Block*>> cases;
+    cfg::Block* default_block = nullptr;
+    for (auto* e : block->succs()) {
+      if (e->type() == cfg::EDGE_BRANCH) {
+        cases.emplace_back(*e->case_key(), e->target());
+      } else if (e->type() == cfg::EDGE_GOTO) {
+        default_block = e->target();
+      }
+    }
+    if (cases.size() < config.min_switch_cases) {
+      continue;
+    }
+
+    std::vector<std::pair<float, int32_t>> candidates;
+    for (auto [key, target] : cases) {
+      if (target == block || target == default_block ||
+          target->preds().size() != 1) {
+        continue;
+      }
+      auto target_hits =
+          get_hits(source_blocks::get_first_source_block(target));
+      if (target_hits &&
+          *target_hits * 100 >= *hits * config.min_case_share_percent) {
+        candidates.emplace_back(*target_hits, key);
+      }
+    }
+    if (candidates.empty()) {
+      continue;
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) {
+                return a.first != b.first ? a.first > b.first
+                                          : a.second < b.second;
+              });
+    if (candidates.size() > config.max_peeled_cases) {
+      candidates.resize(config.max_peeled_cases);
+    }
+
+    std::vector<std::pair<int32_t, cfg::Block*>> peeled;
+    std::vector<std::pair<int32_t, cfg::Block*>> remaining;
+    for (auto [_, key] : candidates) {
+      auto it = std::find_if(cases.begin(), cases.end(),
+                             [key = key](const auto& p) {
+                               return p.first == key;
+                             });
+      peeled.push_back(*it);
+    }
+    std::vector<int32_t> all_keys;
+    std::vector<int32_t> remaining_keys;
+    for (auto& p : cases) {
+      all_keys.push_back(p.first);
+      if (std::find(peeled.begin(), peeled.end(), p) == peeled.end()) {
+        remaining.push_back(p);
+        remaining_keys.push_back(p.first);
+      }
+    }
+    if (!remaining.empty() && is_sparse(remaining_keys) &&
+        !is_sparse(all_keys)) {
+      // The peeled cases stay in the switch as unreachable entries.
+      remaining = cases;
+    }
+
+    auto switch_it = block->to_cfg_instruction_iterator(block->get_last_insn());
+    auto reg = switch_it->insn->src(0);
+    TRACE(RG, 3, "[switch-case-peeling] peeling %zu of %zu cases of %s",
+          peeled.size(), cases.size(), SHOW(switch_it->insn));
+    cfg.remove_insn(switch_it);
+
+    auto copy_source_block = [sb](cfg::Block* b) {
+      if (sb != nullptr) {
+        b->insert_before(b->begin(), std::make_unique<SourceBlock>(*sb));
+      }
+    };
+    // Build the chain backwards, starting with what remains of the switch.
+    auto* next = cfg.create_block();
+    if (remaining.empty()) {
+      cfg.add_edge(next, default_block, cfg::EDGE_GOTO);
+      stats.removed_switches++;
+    } else {
+      cfg.create_branch(next,
+                        (new IRInstruction(OPCODE_SWITCH))->set_src(0, reg),
+                        default_block, remaining);
+    }
+    copy_source_block(next);
+    auto key_reg = cfg.allocate_temp();
+    for (auto it = peeled.rbegin(); it != peeled.rend(); ++it) {
+      auto [key, target] = *it;
+      auto* test_block = std::next(it) == peeled.rend() ? block
+                                                        : cfg.create_block();
+      IRInstruction* test;
+      if (key == 0) {
+        test = (new IRInstruction(OPCODE_IF_EQZ))->set_src(0, reg);
+      } else {
+        test_block->push_back((new IRInstruction(OPCODE_CONST))
+                                  ->set_literal(key)
+                                  ->set_dest(key_reg));
+        test = (new IRInstruction(OPCODE_IF_EQ))
+                   ->set_src(0, reg)
+                   ->set_src(1, key_reg);
+      }
+      cfg.create_branch(test_block, test, next, target);
+      if (test_block != block) {
+        copy_source_block(test_block);
+      }
+      next = test_block;
+    }
+    stats.switches_with_peeled_cases++;
+    stats.peeled_cases += peeled.size();
+  }
+  return stats;
+}
+
+} // namespace switch_case_peeling
+
+void SwitchCasePeelingPass::bind_config() {
+  bind("min_switch_cases", 4u, m_config.min_switch_cases,
+       "Switches with fewer cases are left alone");
+  bind("max_peeled_cases", 2u, m_config.max_peeled_cases,
+       "Maximum number of cases tested before a switch");
+  bind("min_case_share_percent", 30u, m_config.min_case_share_percent,
+       "Minimum share of the executions of a switch that a case must take to "
+       "be tested before it");
+}
+
+void SwitchCasePeelingPass::run_pass(DexStoresVector& stores,
+                                     ConfigFiles& /* unused */,
+                                     PassManager& mgr) {
+  // Don't run under instrumentation.
+  if (mgr.get_redex_options().instrument_pass_enabled) {
+    return;
+  }
+
+  auto scope = build_class_scope(stores);
+  auto stats = walk::parallel::methods<switch_case_peeling::Stats>(
+      scope, [&](DexMethod* method) -> switch_case_peeling::Stats {
+        auto* code = method->get_code();
+        if (!code || method->rstate.no_optimizations()) {
+          return {};
+        }
+        always_assert(code->editable_cfg_built());
+        return switch_case_peeling::process_cfg(code->cfg(), m_config);
+      });
+  mgr.incr_metric(METRIC_SWITCHES_WITH_PEELED_CASES,
+                  stats.switches_with_peeled_cases);
+  mgr.incr_metric(METRIC_PEELED_CASES, stats.peeled_cases);
+  mgr.incr_metric(METRIC_REMOVED_SWITCHES, stats.removed_switches);
+}
+
+static SwitchCasePeelingPass s_pass;
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include "Pass.h"
+
+namespace cfg {
+class ControlFlowGraph;
+} // namespace cfg
+
+namespace switch_case_peeling {
+
+struct Config {
+  // Switches with fewer cases are left alone; ART already lowers them into
+  // compare chains.
+  uint32_t min_switch_cases{4};
+  // At most this many cases are tested before the switch.
+  uint32_t max_peeled_cases{2};
+  // A case is peeled when it takes at least this share of the executions of
+  // its switch.
+  uint32_t min_case_share_percent{30};
+};
+
+struct Stats {
+  size_t switches_with_peeled_cases{0};
+  size_t peeled_cases{0};
+  // Switches all of whose cases were peeled.
+  size_t removed_switches{0};
+
+  Stats& operator+=(const Stats& that) {
+    switches_with_peeled_cases += that.switches_with_peeled_cases;
+    peeled_cases += that.peeled_cases;
+    removed_switches += that.removed_switches;
+    return *this;
+  }
+};
+
+/*
+ * Uses the source block profiles to find the cases that take most of the
+ * executions of a switch, and tests for them with if-eq in order of
+ * decreasing frequency before falling back to the switch for the remaining
+ * cases.
+ *
+ * A peeled case is dropped from the switch, unless that would turn a packed
+ * switch into a sparse one. Only case targets that are reached from nothing
+ * but their case are considered, so that their source block measures exactly
+ * how often the case is taken.
+ */
+Stats process_cfg(cfg::ControlFlowGraph& cfg, const Config& config);
+
+} // namespace switch_case_peeling
+
+class SwitchCasePeelingPass : public Pass {
+ public:
+  SwitchCasePeelingPass() : Pass("SwitchCasePeelingPass") {}
+
+  redex_properties::PropertyInteractions get_property_interactions()
+      const override {
+    using namespace redex_properties::interactions;
+    using namespace redex_properties::names;
+    return {
+        {DexLimitsObeyed, Preserves},
+        {NoInitClassInstructions, Preserves},
+        {NoUnreachableInstructions, Preserves},
+        {NoResolvablePureRefs, Preserves},
+        {RenameClass, Preserves},
+    };
+  }
+
+  void bind_config() override;
+  void run_pass(DexStoresVector&, ConfigFiles&, PassManager&) override;
+
+ private:
+  switch_case_peeling::Config m_config;
+};
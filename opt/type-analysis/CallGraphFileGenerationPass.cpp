@@ -8,6 +8,7 @@
 #include "CallGraphFileGenerationPass.h"
 
 #include <fstream>
+#include <numeric>
 
 #include "CallGraph.h"
 #include "ConcurrentContainers.h"
@@ -83,6 +84,96 @@ void gather_method_positions(const Scope& scope,
         }
       });
 }
+std::string node_name(
+    const call_graph::NodeId& node,
+    const InsertOnlyConcurrentMap<DexMethod*, std::string>&
+        method_to_first_position) {
+  if (node->is_entry()) {
+    return "ENTRY{ENTRY}";
+  }
+  if (node->is_exit()) {
+    return "EXIT{EXIT}";
+  }
+  DexMethod* method = const_cast<DexMethod*>(node->method());
+  std::string name = show(method);
+  if (method->is_external()) {
+    name += "{EXTERNAL}";
+  } else if (is_native(method)) {
+    name += "{NATIVE}";
+  } else if (!method->get_code()) {
+    name += "{NOCODE}";
+  } else {
+    name += (method_to_first_position.count(method)
+                 ? method_to_first_position.at(method)
+                 : "{NOPOSITION}");
+  }
+  return name;
+}
+
+void write_u32(std::ofstream& ofs, uint32_t value) {
+  ofs.write((const char*)&value, sizeof(value));
+}
+
+void write_u32s(std::ofstream& ofs, const std::vector<uint32_t>& values) {
+  ofs.write((const char*)values.data(), values.size() * sizeof(uint32_t));
+}
+
+/*
+ * Compact binary file format (version 2). The edges are stored as two
+ * compressed sparse rows so that readers can map them without decoding:
+ * magic number 0xfaceb000 (4 byte)
+ * version number 2 (4 byte)
+ * number (m) of nodes (4 byte)
+ * number (e) of edges (4 byte)
+ * m * [ string size (4 byte), string (node descriptor) ]
+ * (m + 1) * [ start of the node's callees in the callee ids (4 byte) ]
+ * e * [ callee id (4 byte) ]
+ * (m + 1) * [ start of the node's callers in the caller ids (4 byte) ]
+ * e * [ caller id (4 byte) ]
+ */
+void write_out_compact_callgraph(
+    const std::vector<call_graph::NodeId>& nodes,
+    const std::unordered_map<call_graph::NodeId, std::set<uint32_t>>&
+        nodes_to_succs,
+    const InsertOnlyConcurrentMap<DexMethod*, std::string>&
+        method_to_first_position,
+    std::ofstream& ofs) {
+  std::vector<uint32_t> succ_starts{0};
+  std::vector<uint32_t> succ_ids;
+  std::vector<uint32_t> pred_counts(nodes.size() + 1, 0);
+  succ_starts.reserve(nodes.size() + 1);
+  for (const auto& node : nodes) {
+    const auto& succs = nodes_to_succs.at(node);
+    for (auto succ : succs) {
+      succ_ids.push_back(succ);
+      ++pred_counts[succ + 1];
+    }
+    always_assert(succ_ids.size() <= std::numeric_limits<uint32_t>::max());
+    succ_starts.push_back(succ_ids.size());
+  }
+  std::vector<uint32_t> pred_starts(pred_counts.size());
+  std::partial_sum(pred_counts.begin(), pred_counts.end(),
+                   pred_starts.begin());
+  std::vector<uint32_t> pred_ids(succ_ids.size());
+  std::vector<uint32_t> fill(pred_starts.begin(), pred_starts.end() - 1);
+  for (uint32_t id = 0; id < nodes.size(); ++id) {
+    for (auto i = succ_starts[id]; i < succ_starts[id + 1]; ++i) {
+      pred_ids[fill[succ_ids[i]]++] = id;
+    }
+  }
+
+  write_u32(ofs, succ_ids.size());
+  for (const auto& node : nodes) {
+    auto name = node_name(node, method_to_first_position);
+    write_u32(ofs, name.size());
+    ofs << name;
+  }
+  write_u32s(ofs, succ_starts);
+  write_u32s(ofs, succ_ids);
+  write_u32s(ofs, pred_starts);
+  write_u32s(ofs, pred_ids);
+}
+
 /*
  * Binary file format:
  * magic number 0xfaceb000 (4 byte)
@@ -93,7 +184,8 @@ void gather_method_positions(const Scope& scope,
  */
 void write_out_callgraph(const Scope& scope,
                          const call_graph::Graph& cg,
-                         const std::string& callgraph_filename) {
+                         const std::string& callgraph_filename,
+                         bool compact) {
   std::vector<call_graph::NodeId> nodes;
   std::unordered_map<call_graph::NodeId, uint32_t> nodes_to_ids;
   std::unordered_map<call_graph::NodeId, std::set<uint32_t>> nodes_to_succs;
@@ -107,36 +199,22 @@ void write_out_callgraph(const Scope& scope,
                     std::ofstream::out | std::ofstream::trunc);
   uint32_t magic = 0xfaceb000; // serves as endianess check
   ofs.write((const char*)&magic, bit_32_size);
-  uint32_t version = 1;
+  uint32_t version = compact ? 2 : 1;
   ofs.write((const char*)&version, bit_32_size);
   ofs.write((const char*)&num_method, bit_32_size);
+  if (compact) {
+    write_out_compact_callgraph(nodes, nodes_to_succs, method_to_first_position,
+                                ofs);
+    return;
+  }
   uint32_t cur_id = 0;
   for (const auto& node : nodes) {
     always_assert_log(cur_id == nodes_to_ids.at(node), "Node id mismatch");
     ++cur_id;
-    std::string node_name;
-    if (node->is_entry()) {
-      node_name = "ENTRY{ENTRY}";
-    } else if (node->is_exit()) {
-      node_name = "EXIT{EXIT}";
-    } else {
-      DexMethod* method = const_cast<DexMethod*>(node->method());
-      node_name = show(method);
-      if (method->is_external()) {
-        node_name += "{EXTERNAL}";
-      } else if (is_native(method)) {
-        node_name += "{NATIVE}";
-      } else if (!method->get_code()) {
-        node_name += "{NOCODE}";
-      } else {
-        node_name += (method_to_first_position.count(method)
-                          ? method_to_first_position.at(method)
-                          : "{NOPOSITION}");
-      }
-    }
-    uint32_t ssize = node_name.size();
+    auto name = node_name(node, method_to_first_position);
+    uint32_t ssize = name.size();
     ofs.write((const char*)&ssize, bit_32_size);
-    ofs << node_name;
+    ofs << name;
     const auto& succs = nodes_to_succs.at(node);
     always_assert(succs.size() <= std::numeric_limits<uint32_t>::max());
     uint32_t num_succs = succs.size();
@@ -150,6 +228,9 @@ void write_out_callgraph(const Scope& scope,
 
 void CallGraphFileGenerationPass::bind_config() {
   bind("emit_graph", false, m_emit_graph);
+  bind("compact_format", false, m_compact_format,
+       "Write the graph in the version 2 format, whose callee and caller "
+       "lists can be mapped directly by query tools.");
 }
 
 void CallGraphFileGenerationPass::run_pass(DexStoresVector& stores,
@@ -163,6 +244,6 @@ void CallGraphFileGenerationPass::run_pass(DexStoresVector& stores,
   const std::string& callgraph_filename = conf.metafile(CALL_GRAPH_FILE);
   call_graph::Graph cg =
       call_graph::complete_call_graph(*method_override_graph, scope);
-  write_out_callgraph(scope, cg, callgraph_filename);
+  write_out_callgraph(scope, cg, callgraph_filename, m_compact_format);
 }
 static CallGraphFileGenerationPass s_pass;
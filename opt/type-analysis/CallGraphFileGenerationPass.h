@@ -29,4 +29,5 @@ class CallGraphFileGenerationPass : Pass {
  private:
   const char* CALL_GRAPH_FILE = "redex-callgraph.graph";
   bool m_emit_graph{false};
+  bool m_compact_format{false};
 };
@@ -1018,6 +1018,30 @@ void TypedefAnnoChecker::run(DexMethod* m) {
   }
 }
 
+ParamTypedefAnnos TypedefAnnoChecker::get_param_typedef_annos(
+    const DexMethod* callee,
+    const std::unordered_set<DexType*>& typedef_annos) {
+  auto compute = [&](const DexMethod*) -> ParamTypedefAnnos {
+    if (!callee->get_param_anno()) {
+      return std::nullopt;
+    }
+    std::vector<std::pair<int, const DexType*>> res;
+    for (auto const& param_anno : *callee->get_param_anno()) {
+      auto annotation = type_inference::get_typedef_annotation(
+          param_anno.second->get_annotations(), typedef_annos);
+      if (annotation != boost::none) {
+        res.emplace_back(param_anno.first, *annotation);
+      }
+    }
+    return res;
+  };
+  if (m_param_typedef_annos == nullptr) {
+    return compute(callee);
+  }
+  return *m_param_typedef_annos->get_or_create_and_assert_equal(callee, compute)
+              .first;
+}
+
 void TypedefAnnoChecker::check_instruction(
     DexMethod* m,
     const type_inference::TypeInference* inference,
@@ -1048,16 +1072,14 @@ void TypedefAnnoChecker::check_instruction(
     }
     callees.push_back(callee_def);
     for (const DexMethod* callee : callees) {
-      if (!callee->get_param_anno()) {
+      auto param_typedef_annos =
+          get_param_typedef_annos(callee, inference->get_annotations());
+      if (!param_typedef_annos) {
         // Callee does not expect any Typedef value. Nothing to do.
         return;
       }
-      for (auto const& param_anno : *callee->get_param_anno()) {
-        auto annotation = type_inference::get_typedef_annotation(
-            param_anno.second->get_annotations(), inference->get_annotations());
-        if (annotation == boost::none) {
-          continue;
-        }
+      for (auto const& param_anno : *param_typedef_annos) {
+        boost::optional<const DexType*> annotation = param_anno.second;
         int param_index = insn->opcode() == OPCODE_INVOKE_STATIC
                               ? param_anno.first
                               : param_anno.first + 1;
@@ -1438,9 +1460,11 @@ void TypedefAnnoCheckerPass::run_pass(DexStoresVector& stores,
   patcher.run(scope);
   TRACE(TAC, 2, "Finish patching synth accessors");
 
+  ParamTypedefAnnoCache param_typedef_annos;
   auto stats = walk::parallel::methods<Stats>(scope, [&](DexMethod* m) {
-    TypedefAnnoChecker checker = TypedefAnnoChecker(
-        strdef_constants, intdef_constants, m_config, *method_override_graph);
+    TypedefAnnoChecker checker =
+        TypedefAnnoChecker(strdef_constants, intdef_constants, m_config,
+                           *method_override_graph, &param_typedef_annos);
     checker.run(m);
     if (!checker.complete()) {
       return Stats(checker.error());
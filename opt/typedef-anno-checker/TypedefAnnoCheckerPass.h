@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include "ConcurrentContainers.h"
 #include "ControlFlow.h"
 #include "LiveRange.h"
@@ -87,6 +89,16 @@ using StrDefConstants =
 using IntDefConstants =
     InsertOnlyConcurrentMap<const DexClass*, std::unordered_set<uint64_t>>;
 
+// The typedef annotations of a method's parameters as (parameter index,
+// annotation) pairs, or none if the method has no parameter annotations at
+// all. Invoked methods are looked up from many call sites, so this is
+// computed once per method and shared by all checkers.
+using ParamTypedefAnnos =
+    std::optional<std::vector<std::pair<int, const DexType*>>>;
+
+using ParamTypedefAnnoCache =
+    InsertOnlyConcurrentMap<const DexMethod*, ParamTypedefAnnos>;
+
 class SynthAccessorPatcher {
  public:
   explicit SynthAccessorPatcher(
@@ -137,11 +149,13 @@ class TypedefAnnoChecker {
       const StrDefConstants& strdef_constants,
       const IntDefConstants& intdef_constants,
       const TypedefAnnoCheckerPass::Config& config,
-      const method_override_graph::Graph& method_override_graph)
+      const method_override_graph::Graph& method_override_graph,
+      ParamTypedefAnnoCache* param_typedef_annos = nullptr)
       : m_config(config),
         m_strdef_constants(strdef_constants),
         m_intdef_constants(intdef_constants),
-        m_method_override_graph(method_override_graph) {}
+        m_method_override_graph(method_override_graph),
+        m_param_typedef_annos(param_typedef_annos) {}
 
   void run(DexMethod* m);
 
@@ -166,6 +180,10 @@ class TypedefAnnoChecker {
   std::string error() { return m_error; }
 
  private:
+  ParamTypedefAnnos get_param_typedef_annos(
+      const DexMethod* callee,
+      const std::unordered_set<DexType*>& typedef_annos);
+
   bool m_good{true};
   std::string m_error;
   TypedefAnnoCheckerPass::Config m_config;
@@ -173,4 +191,5 @@ class TypedefAnnoChecker {
   const StrDefConstants& m_strdef_constants;
   const IntDefConstants& m_intdef_constants;
   const method_override_graph::Graph& m_method_override_graph;
+  ParamTypedefAnnoCache* m_param_typedef_annos;
 };
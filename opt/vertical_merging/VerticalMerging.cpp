@@ -15,10 +15,10 @@
 #include "EditableCfgAdapter.h"
 #include "IROpcode.h"
 #include "PassManager.h"
+#include "ReferenceRewritePlan.h"
 #include "Resolver.h"
 #include "Show.h"
 #include "Trace.h"
-#include "TypeReference.h"
 #include "Walkers.h"
 #include "WorkQueue.h"
 
@@ -562,53 +562,22 @@ void move_fields(DexClass* from_cls, DexClass* to_cls) {
 void update_references(const Scope& scope,
                        const std::unordered_map<DexType*, DexType*>& update_map,
                        const MethodRefMap& methodref_update_map) {
-  walk::parallel::opcodes(
-      scope,
-      [&update_map](DexMethod* method) {
-        // Ignore references in methods in classes that are going to be
-        // removed.
-        return !update_map.count(method->get_class());
-      },
-      [&](DexMethod* method, IRInstruction* insn) {
-        if (insn->has_type()) {
-          auto ref_type = insn->get_type();
-          DexType* type =
-              const_cast<DexType*>(type::get_element_type_if_array(ref_type));
-          auto find_mergeable = update_map.find(type);
-          if (find_mergeable == update_map.end()) {
-            return;
-          }
-          always_assert_log(insn->opcode() != OPCODE_NEW_INSTANCE,
-                            "Vertical Merging: type reference still exists %s",
-                            SHOW(insn));
-          auto merger_type = find_mergeable->second;
-          if (type::is_array(ref_type)) {
-            auto array_merger_type = type::make_array_type(merger_type);
-            insn->set_type(array_merger_type);
-          } else {
-            insn->set_type(const_cast<DexType*>(merger_type));
-          }
-        } else if (insn->has_field()) {
-          auto insn_field = insn->get_field();
-          always_assert_log(!update_map.count(insn_field->get_class()),
-                            "Vertical Merging: Field reference still exists %s",
-                            SHOW(insn));
-        } else if (insn->has_method()) {
-          auto insn_method = insn->get_method();
-          auto find = methodref_update_map.find(insn_method);
-          if (find != methodref_update_map.end()) {
-            insn->set_method(find->second);
-          } else {
-            always_assert_log(
-                !update_map.count(insn_method->get_class()),
-                "Vertical Merging: Method reference still exists %s in %s",
-                SHOW(insn), SHOW(method));
-          }
-        }
-      });
-  // Update type refs in all field or method specs.
-  type_reference::TypeRefUpdater updater(update_map);
-  updater.update_methods_fields(scope);
+  reference_update::RewritePlan plan;
+  for (const auto& pair : update_map) {
+    plan.add_type(pair.first, pair.second);
+  }
+  for (const auto& pair : methodref_update_map) {
+    plan.add_method(pair.first, pair.second);
+  }
+  reference_update::RewriteOptions options;
+  // Ignore references in methods in classes that are going to be removed.
+  options.skip_code = [&update_map](const DexClass* cls) {
+    return update_map.count(cls->get_type()) != 0;
+  };
+  options.old_types_must_be_unreferenced = true;
+  // Update type and method references in code, and type refs in all field or
+  // method specs.
+  plan.apply(scope, options);
 }
 
 void update_implements(DexClass* from_cls, DexClass* to_cls) {
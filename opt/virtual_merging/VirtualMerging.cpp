@@ -42,12 +42,14 @@
 
 #include "VirtualMerging.h"
 
+#include <numeric>
 #include <utility>
 
 #include "ConfigFiles.h"
 #include "ControlFlow.h"
 #include "CppUtil.h"
 #include "DedupVirtualMethods.h"
+#include "DexUtil.h"
 #include "IRCode.h"
 #include "IRInstruction.h"
 #include "Inliner.h"
@@ -59,6 +61,7 @@
 #include "StlUtil.h"
 #include "TypeSystem.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 namespace {
 
@@ -773,8 +776,13 @@ std::pair<std::vector<MethodData>, VirtualMergingStats> create_ordering(
     }
   }
 
-  // Sort out large methods already.
-  for (auto& p : ordering) {
+  // Sort out large methods already. Each overridden method only gets checked
+  // against its own overriding methods, so this is done in parallel; the
+  // stats are collected per method to stay deterministic.
+  std::vector<VirtualMergingStats> stats_by_method(ordering.size());
+  workqueue_run_for<size_t>(0, ordering.size(), [&](size_t i) {
+    auto& p = ordering[i];
+    auto& method_stats = stats_by_method[i];
     auto overridden_method = const_cast<DexMethod*>(p.first);
     for (auto& q : p.second) {
       q.second.erase(
@@ -791,7 +799,7 @@ std::pair<std::vector<MethodData>, VirtualMergingStats> create_ordering(
                         "[VM] %s is too large to be merged into %s",
                         SHOW(m),
                         SHOW(overridden_method));
-                  stats.huge_methods++;
+                  method_stats.huge_methods++;
                   return true;
                 }
 
@@ -808,7 +816,7 @@ std::pair<std::vector<MethodData>, VirtualMergingStats> create_ordering(
                         "[VM] Cannot inline %s into %s",
                         SHOW(m),
                         SHOW(overridden_method));
-                  stats.uninlinable_methods++;
+                  method_stats.uninlinable_methods++;
                   return true;
                 }
 
@@ -907,9 +915,12 @@ std::pair<std::vector<MethodData>, VirtualMergingStats> create_ordering(
               removals,
               num_methods,
               SHOW(overridden_method));
-        stats.caller_size_removed_methods += removals;
+        method_stats.caller_size_removed_methods += removals;
       }
     }
+  });
+  for (const auto& method_stats : stats_by_method) {
+    stats += method_stats;
   }
 
   // Remove methods that no longer have inlinees.
@@ -1069,284 +1080,365 @@ struct SBHelper {
   }
 };
 
-VirtualMergingStats apply_ordering(
-    MultiMethodInliner& inliner,
-    std::vector<MethodData>& ordering,
-    std::unordered_map<DexClass*, std::vector<const DexMethod*>>&
-        virtual_methods_to_remove,
-    std::unordered_map<DexMethod*, DexMethod*>& virtual_methods_to_remap,
-    VirtualMerging::InsertionStrategy insertion_strategy) {
+// The outcome of merging overriding methods into one overridden method.
+// Everything that may be observed by merges into other overridden methods is
+// only recorded here, and applied once all merges are done.
+struct MergeResult {
   VirtualMergingStats stats;
-  for (auto& p : ordering) {
-    auto overridden_method = const_cast<DexMethod*>(p.first);
-    for (auto& q : p.second) {
-      if (q.second.empty()) {
-        continue;
-      }
-      SBHelper sb_helper(overridden_method, q.second);
-
-      auto* virtual_scope = q.first;
-
-      for (auto* overriding_method_const : q.second) {
-        auto overriding_method =
-            const_cast<DexMethod*>(overriding_method_const);
-        size_t estimated_callee_size =
-            overriding_method->get_code()->estimate_code_units();
-        size_t estimated_insn_size =
-            is_abstract(overridden_method)
-                ? 64 // we'll need some extra instruction; 64 is conservative
-                : overridden_method->get_code()->estimate_code_units();
-        bool is_inlineable =
-            inliner.is_inlinable(overridden_method, overriding_method,
-                                 nullptr /* invoke_virtual_insn */,
-                                 estimated_insn_size, estimated_callee_size);
-        always_assert_log(is_inlineable, "[VM] Cannot inline %s into %s",
-                          SHOW(overriding_method), SHOW(overridden_method));
-
-        TRACE(VM,
-              4,
-              "[VM] Merging %s into %s",
-              SHOW(overriding_method),
-              SHOW(overridden_method));
+  VisibilityChanges visibility_changes;
+  // Pairs of merged overriding method and root method of its virtual scope.
+  std::vector<std::pair<DexMethod*, DexMethod*>> merged_methods;
+};
 
-        auto proto = overriding_method->get_proto();
-        always_assert(overridden_method->get_proto() == proto);
-        std::vector<uint32_t> param_regs;
-        std::function<void(IRInstruction*)> push_insn;
-        std::function<void(std::unique_ptr<SourceBlock>)> push_sb;
-        std::function<uint32_t()> allocate_temp;
-        std::function<uint32_t()> allocate_wide_temp;
-        std::function<void()> cleanup;
-        IRCode* overridden_code;
-        // We make the method public to avoid visibility issues. We could be
-        // more conservative (i.e. taking the strongest visibility control
-        // that encompasses the original pair) but I'm not sure it's worth the
-        // effort.
-        set_public(overridden_method);
-        if (is_abstract(overridden_method)) {
-          // We'll make the abstract method be not abstract, and give it a new
-          // method body.
-          // It starts out with just load-param instructions as needed, and
-          // then we'll add an invoke-virtual instruction that will get
-          // inlined.
-          stats.unabstracted_methods++;
-          overridden_method->make_concrete(
-              (DexAccessFlags)(overridden_method->get_access() & ~ACC_ABSTRACT),
-              std::make_unique<IRCode>(),
-              true /* is_virtual */);
-          overridden_code = overridden_method->get_code();
-          auto load_param_insn = new IRInstruction(IOPCODE_LOAD_PARAM_OBJECT);
-          load_param_insn->set_dest(overridden_code->allocate_temp());
+void merge_into_overridden_method(
+    MultiMethodInliner& inliner,
+    MethodData& p,
+    VirtualMerging::InsertionStrategy insertion_strategy,
+    MergeResult* result) {
+  auto overridden_method = const_cast<DexMethod*>(p.first);
+  for (auto& q : p.second) {
+    if (q.second.empty()) {
+      continue;
+    }
+    SBHelper sb_helper(overridden_method, q.second);
+
+    auto* virtual_scope = q.first;
+
+    for (auto* overriding_method_const : q.second) {
+      auto overriding_method =
+          const_cast<DexMethod*>(overriding_method_const);
+      size_t estimated_callee_size =
+          overriding_method->get_code()->estimate_code_units();
+      size_t estimated_insn_size =
+          is_abstract(overridden_method)
+              ? 64 // we'll need some extra instruction; 64 is conservative
+              : overridden_method->get_code()->estimate_code_units();
+      bool is_inlineable =
+          inliner.is_inlinable(overridden_method, overriding_method,
+                               nullptr /* invoke_virtual_insn */,
+                               estimated_insn_size, estimated_callee_size);
+      always_assert_log(is_inlineable, "[VM] Cannot inline %s into %s",
+                        SHOW(overriding_method), SHOW(overridden_method));
+
+      TRACE(VM,
+            4,
+            "[VM] Merging %s into %s",
+            SHOW(overriding_method),
+            SHOW(overridden_method));
+
+      auto proto = overriding_method->get_proto();
+      always_assert(overridden_method->get_proto() == proto);
+      std::vector<uint32_t> param_regs;
+      std::function<void(IRInstruction*)> push_insn;
+      std::function<void(std::unique_ptr<SourceBlock>)> push_sb;
+      std::function<uint32_t()> allocate_temp;
+      std::function<uint32_t()> allocate_wide_temp;
+      std::function<void()> cleanup;
+      IRCode* overridden_code;
+      // We make the method public to avoid visibility issues. We could be
+      // more conservative (i.e. taking the strongest visibility control
+      // that encompasses the original pair) but I'm not sure it's worth the
+      // effort.
+      result->visibility_changes.methods.insert(overridden_method);
+      if (is_abstract(overridden_method)) {
+        // We'll make the abstract method be not abstract, and give it a new
+        // method body.
+        // It starts out with just load-param instructions as needed, and
+        // then we'll add an invoke-virtual instruction that will get
+        // inlined.
+        result->stats.unabstracted_methods++;
+        overridden_method->make_concrete(
+            (DexAccessFlags)(overridden_method->get_access() & ~ACC_ABSTRACT),
+            std::make_unique<IRCode>(),
+            true /* is_virtual */);
+        overridden_code = overridden_method->get_code();
+        auto load_param_insn = new IRInstruction(IOPCODE_LOAD_PARAM_OBJECT);
+        load_param_insn->set_dest(overridden_code->allocate_temp());
+        overridden_code->push_back(load_param_insn);
+        param_regs.push_back(load_param_insn->dest());
+        for (auto t : *proto->get_args()) {
+          if (type::is_wide_type(t)) {
+            load_param_insn = new IRInstruction(IOPCODE_LOAD_PARAM_WIDE);
+            load_param_insn->set_dest(overridden_code->allocate_wide_temp());
+          } else {
+            load_param_insn = new IRInstruction(
+                type::is_object(t) ? IOPCODE_LOAD_PARAM_OBJECT
+                                   : IOPCODE_LOAD_PARAM);
+            load_param_insn->set_dest(overridden_code->allocate_temp());
+          }
           overridden_code->push_back(load_param_insn);
           param_regs.push_back(load_param_insn->dest());
-          for (auto t : *proto->get_args()) {
-            if (type::is_wide_type(t)) {
-              load_param_insn = new IRInstruction(IOPCODE_LOAD_PARAM_WIDE);
-              load_param_insn->set_dest(overridden_code->allocate_wide_temp());
-            } else {
-              load_param_insn = new IRInstruction(
-                  type::is_object(t) ? IOPCODE_LOAD_PARAM_OBJECT
-                                     : IOPCODE_LOAD_PARAM);
-              load_param_insn->set_dest(overridden_code->allocate_temp());
-            }
-            overridden_code->push_back(load_param_insn);
-            param_regs.push_back(load_param_insn->dest());
-          }
-
-          if (sb_helper.create_source_blocks) {
-            overridden_code->push_back(sb_helper.get_source_block_creator()());
-          }
+        }
 
-          // we'll define helper functions in a way that lets them mutate the
-          // new IRCode
-          push_insn = [=](IRInstruction* insn) {
-            overridden_code->push_back(insn);
-          };
-          push_sb = [=](std::unique_ptr<SourceBlock> sb) {
-            overridden_code->push_back(std::move(sb));
-          };
-          allocate_temp = [=]() { return overridden_code->allocate_temp(); };
-          allocate_wide_temp = [=]() {
-            return overridden_code->allocate_wide_temp();
-          };
-          cleanup = [=]() { overridden_code->build_cfg(); };
-        } else {
-          // We are dealing with a non-abstract method. In this case, we'll
-          // first insert an if-instruction to decide whether to run the
-          // overriding method that we'll inline, or whether to jump to the
-          // old method body.
-          overridden_code = overridden_method->get_code();
-          always_assert(overridden_code);
-          overridden_code->build_cfg();
-          auto& overridden_cfg = overridden_code->cfg();
-
-          // Find block with load-param instructions
-          cfg::Block* block = overridden_cfg.entry_block();
-          while (block->get_first_insn() == block->end()) {
-            const auto& succs = block->succs();
-            always_assert(succs.size() == 1);
-            const auto& out = succs[0];
-            always_assert(out->type() == cfg::EDGE_GOTO);
-            block = out->target();
-          }
+        if (sb_helper.create_source_blocks) {
+          overridden_code->push_back(sb_helper.get_source_block_creator()());
+        }
 
-          // Scan load-param instructions
-          std::unordered_set<uint32_t> param_regs_set;
-          auto last_it = block->end();
-          for (auto it = block->begin(); it != block->end(); it++) {
-            auto& mie = *it;
-            if (mie.type != MFLOW_OPCODE) {
-              continue;
-            }
-            if (!opcode::is_a_load_param(mie.insn->opcode())) {
-              break;
-            }
-            param_regs.push_back(mie.insn->dest());
-            param_regs_set.insert(mie.insn->dest());
-            last_it = it;
-          }
-          always_assert(param_regs.size() == param_regs_set.size());
-          always_assert(1 + proto->get_args()->size() == param_regs_set.size());
-          always_assert(last_it != block->end());
+        // we'll define helper functions in a way that lets them mutate the
+        // new IRCode
+        push_insn = [=](IRInstruction* insn) {
+          overridden_code->push_back(insn);
+        };
+        push_sb = [=](std::unique_ptr<SourceBlock> sb) {
+          overridden_code->push_back(std::move(sb));
+        };
+        allocate_temp = [=]() { return overridden_code->allocate_temp(); };
+        allocate_wide_temp = [=]() {
+          return overridden_code->allocate_wide_temp();
+        };
+        cleanup = [=]() { overridden_code->build_cfg(); };
+      } else {
+        // We are dealing with a non-abstract method. In this case, we'll
+        // first insert an if-instruction to decide whether to run the
+        // overriding method that we'll inline, or whether to jump to the
+        // old method body.
+        overridden_code = overridden_method->get_code();
+        always_assert(overridden_code);
+        overridden_code->build_cfg();
+        auto& overridden_cfg = overridden_code->cfg();
+
+        // Find block with load-param instructions
+        cfg::Block* block = overridden_cfg.entry_block();
+        while (block->get_first_insn() == block->end()) {
+          const auto& succs = block->succs();
+          always_assert(succs.size() == 1);
+          const auto& out = succs[0];
+          always_assert(out->type() == cfg::EDGE_GOTO);
+          block = out->target();
+        }
 
-          // We'll split the block right after the last load-param instruction
-          // --- that's where we'll insert the new if-statement.
-          {
-            auto sb_scoped =
-                sb_helper.handle_split(block, last_it, overriding_method);
-            overridden_cfg.split_block(block, last_it);
+        // Scan load-param instructions
+        std::unordered_set<uint32_t> param_regs_set;
+        auto last_it = block->end();
+        for (auto it = block->begin(); it != block->end(); it++) {
+          auto& mie = *it;
+          if (mie.type != MFLOW_OPCODE) {
+            continue;
           }
-
-          auto new_block = overridden_cfg.create_block();
-          {
-            // instance-of param0, DeclaringTypeOfOverridingMethod
-            auto instance_of_insn = new IRInstruction(OPCODE_INSTANCE_OF);
-            instance_of_insn->set_type(overriding_method->get_class());
-            instance_of_insn->set_src(0, param_regs.at(0));
-            block->push_back(instance_of_insn);
-            // move-result-pseudo if_temp
-            auto if_temp_reg = overridden_cfg.allocate_temp();
-            auto move_result_pseudo_insn =
-                new IRInstruction(IOPCODE_MOVE_RESULT_PSEUDO);
-            move_result_pseudo_insn->set_dest(if_temp_reg);
-            block->push_back(move_result_pseudo_insn);
-
-            switch (insertion_strategy) {
-            case VirtualMerging::InsertionStrategy::kJumpTo: {
-              // if-nez if_temp, new_code
-              // (fall through to old code)
-              auto if_insn = new IRInstruction(OPCODE_IF_NEZ);
-              if_insn->set_src(0, if_temp_reg);
-              overridden_cfg.create_branch(
-                  block, if_insn, /*fls=*/block->goes_to(), /*tru=*/new_block);
-              break;
-            }
-
-            case VirtualMerging::InsertionStrategy::kFallthrough: {
-              // if-eqz if_temp, old code
-              // (fall through to new_code)
-              auto if_insn = new IRInstruction(OPCODE_IF_EQZ);
-              if_insn->set_src(0, if_temp_reg);
-              overridden_cfg.create_branch(block, if_insn, /*fls=*/new_block,
-                                           /*tru=*/block->goes_to());
-              break;
-            }
-            }
+          if (!opcode::is_a_load_param(mie.insn->opcode())) {
+            break;
           }
-          // we'll define helper functions in a way that lets them mutate the
-          // cfg
-          push_insn = [=](IRInstruction* insn) { new_block->push_back(insn); };
-          auto* cfg_ptr = &overridden_cfg;
-          push_sb = [=](std::unique_ptr<SourceBlock> sb) {
-            new_block->insert_before(new_block->end(), std::move(sb));
-          };
-          allocate_temp = [=]() { return cfg_ptr->allocate_temp(); };
-          allocate_wide_temp = [=]() { return cfg_ptr->allocate_wide_temp(); };
-          cleanup = []() {};
+          param_regs.push_back(mie.insn->dest());
+          param_regs_set.insert(mie.insn->dest());
+          last_it = it;
         }
+        always_assert(param_regs.size() == param_regs_set.size());
+        always_assert(1 + proto->get_args()->size() == param_regs_set.size());
+        always_assert(last_it != block->end());
 
-        if (sb_helper.create_source_blocks) {
-          // Insert source block with val == 1.0 so that inlining normalizes
-          // source-blocks properly
-          push_sb(sb_helper.get_source_block_creator(/* val */ 1.0)());
+        // We'll split the block right after the last load-param instruction
+        // --- that's where we'll insert the new if-statement.
+        {
+          auto sb_scoped =
+              sb_helper.handle_split(block, last_it, overriding_method);
+          overridden_cfg.split_block(block, last_it);
         }
 
-        always_assert(1 + proto->get_args()->size() == param_regs.size());
-
-        // invoke-virtual temp, param1, ..., paramN, OverridingMethod
-        auto invoke_virtual_insn = new IRInstruction(OPCODE_INVOKE_VIRTUAL);
-        invoke_virtual_insn->set_method(overriding_method);
-        invoke_virtual_insn->set_srcs_size(param_regs.size());
-        for (size_t i = 0; i < param_regs.size(); i++) {
-          uint32_t reg = param_regs[i];
-          if (i == 0) {
-            uint32_t temp_reg = allocate_temp();
-            auto check_cast_insn = new IRInstruction(OPCODE_CHECK_CAST);
-            check_cast_insn->set_type(overriding_method->get_class());
-            check_cast_insn->set_src(0, reg);
-            push_insn(check_cast_insn);
-            auto move_result_pseudo_insn =
-                new IRInstruction(IOPCODE_MOVE_RESULT_PSEUDO_OBJECT);
-            move_result_pseudo_insn->set_dest(temp_reg);
-            push_insn(move_result_pseudo_insn);
-            reg = temp_reg;
+        auto new_block = overridden_cfg.create_block();
+        {
+          // instance-of param0, DeclaringTypeOfOverridingMethod
+          auto instance_of_insn = new IRInstruction(OPCODE_INSTANCE_OF);
+          instance_of_insn->set_type(overriding_method->get_class());
+          instance_of_insn->set_src(0, param_regs.at(0));
+          block->push_back(instance_of_insn);
+          // move-result-pseudo if_temp
+          auto if_temp_reg = overridden_cfg.allocate_temp();
+          auto move_result_pseudo_insn =
+              new IRInstruction(IOPCODE_MOVE_RESULT_PSEUDO);
+          move_result_pseudo_insn->set_dest(if_temp_reg);
+          block->push_back(move_result_pseudo_insn);
+
+          switch (insertion_strategy) {
+          case VirtualMerging::InsertionStrategy::kJumpTo: {
+            // if-nez if_temp, new_code
+            // (fall through to old code)
+            auto if_insn = new IRInstruction(OPCODE_IF_NEZ);
+            if_insn->set_src(0, if_temp_reg);
+            overridden_cfg.create_branch(
+                block, if_insn, /*fls=*/block->goes_to(), /*tru=*/new_block);
+            break;
+          }
+
+          case VirtualMerging::InsertionStrategy::kFallthrough: {
+            // if-eqz if_temp, old code
+            // (fall through to new_code)
+            auto if_insn = new IRInstruction(OPCODE_IF_EQZ);
+            if_insn->set_src(0, if_temp_reg);
+            overridden_cfg.create_branch(block, if_insn, /*fls=*/new_block,
+                                         /*tru=*/block->goes_to());
+            break;
+          }
           }
-          invoke_virtual_insn->set_src(i, reg);
-        }
-        push_insn(invoke_virtual_insn);
-        if (proto->is_void()) {
-          // return-void
-          sb_helper.add_return_sb(overriding_method, push_sb);
-          auto return_insn = new IRInstruction(OPCODE_RETURN_VOID);
-          push_insn(return_insn);
-        } else {
-          // move-result result_temp
-          auto rtype = proto->get_rtype();
-          auto op = opcode::move_result_for_invoke(overriding_method);
-          auto move_result_insn = new IRInstruction(op);
-          auto result_temp = op == OPCODE_MOVE_RESULT_WIDE
-                                 ? allocate_wide_temp()
-                                 : allocate_temp();
-          move_result_insn->set_dest(result_temp);
-          push_insn(move_result_insn);
-          sb_helper.add_return_sb(overriding_method, push_sb);
-          // return result_temp
-          op = opcode::return_opcode(rtype);
-          auto return_insn = new IRInstruction(op);
-          return_insn->set_src(0, result_temp);
-          push_insn(return_insn);
         }
+        // we'll define helper functions in a way that lets them mutate the
+        // cfg
+        push_insn = [=](IRInstruction* insn) { new_block->push_back(insn); };
+        auto* cfg_ptr = &overridden_cfg;
+        push_sb = [=](std::unique_ptr<SourceBlock> sb) {
+          new_block->insert_before(new_block->end(), std::move(sb));
+        };
+        allocate_temp = [=]() { return cfg_ptr->allocate_temp(); };
+        allocate_wide_temp = [=]() { return cfg_ptr->allocate_wide_temp(); };
+        cleanup = []() {};
+      }
 
-        cleanup();
-
-        // overriding_method->get_code()->build_cfg();
-        always_assert(overriding_method->get_code()->editable_cfg_built());
-        always_assert(overridden_method->get_code()->editable_cfg_built());
-        inliner::inline_with_cfg(
-            overridden_method, overriding_method, invoke_virtual_insn,
-            /* needs_receiver_cast */ nullptr, /* needs_init_class */ nullptr,
-            overridden_method->get_code()->cfg().get_registers_size());
-        inliner.visibility_changes_apply_and_record_make_static(
-            get_visibility_changes(overriding_method,
-                                   overridden_method->get_class()));
-
-        // Check if everything was inlined.
-        for (const auto& mie :
-             cfg::InstructionIterable(overridden_code->cfg())) {
-          redex_assert(invoke_virtual_insn != mie.insn);
+      if (sb_helper.create_source_blocks) {
+        // Insert source block with val == 1.0 so that inlining normalizes
+        // source-blocks properly
+        push_sb(sb_helper.get_source_block_creator(/* val */ 1.0)());
+      }
+
+      always_assert(1 + proto->get_args()->size() == param_regs.size());
+
+      // invoke-virtual temp, param1, ..., paramN, OverridingMethod
+      auto invoke_virtual_insn = new IRInstruction(OPCODE_INVOKE_VIRTUAL);
+      invoke_virtual_insn->set_method(overriding_method);
+      invoke_virtual_insn->set_srcs_size(param_regs.size());
+      for (size_t i = 0; i < param_regs.size(); i++) {
+        uint32_t reg = param_regs[i];
+        if (i == 0) {
+          uint32_t temp_reg = allocate_temp();
+          auto check_cast_insn = new IRInstruction(OPCODE_CHECK_CAST);
+          check_cast_insn->set_type(overriding_method->get_class());
+          check_cast_insn->set_src(0, reg);
+          push_insn(check_cast_insn);
+          auto move_result_pseudo_insn =
+              new IRInstruction(IOPCODE_MOVE_RESULT_PSEUDO_OBJECT);
+          move_result_pseudo_insn->set_dest(temp_reg);
+          push_insn(move_result_pseudo_insn);
+          reg = temp_reg;
         }
+        invoke_virtual_insn->set_src(i, reg);
+      }
+      push_insn(invoke_virtual_insn);
+      if (proto->is_void()) {
+        // return-void
+        sb_helper.add_return_sb(overriding_method, push_sb);
+        auto return_insn = new IRInstruction(OPCODE_RETURN_VOID);
+        push_insn(return_insn);
+      } else {
+        // move-result result_temp
+        auto rtype = proto->get_rtype();
+        auto op = opcode::move_result_for_invoke(overriding_method);
+        auto move_result_insn = new IRInstruction(op);
+        auto result_temp = op == OPCODE_MOVE_RESULT_WIDE
+                               ? allocate_wide_temp()
+                               : allocate_temp();
+        move_result_insn->set_dest(result_temp);
+        push_insn(move_result_insn);
+        sb_helper.add_return_sb(overriding_method, push_sb);
+        // return result_temp
+        op = opcode::return_opcode(rtype);
+        auto return_insn = new IRInstruction(op);
+        return_insn->set_src(0, result_temp);
+        push_insn(return_insn);
+      }
+
+      cleanup();
+
+      // overriding_method->get_code()->build_cfg();
+      always_assert(overriding_method->get_code()->editable_cfg_built());
+      always_assert(overridden_method->get_code()->editable_cfg_built());
+      inliner::inline_with_cfg(
+          overridden_method, overriding_method, invoke_virtual_insn,
+          /* needs_receiver_cast */ nullptr, /* needs_init_class */ nullptr,
+          overridden_method->get_code()->cfg().get_registers_size());
+      result->visibility_changes.insert(get_visibility_changes(
+          overriding_method, overridden_method->get_class()));
+
+      // Check if everything was inlined.
+      for (const auto& mie :
+           cfg::InstructionIterable(overridden_code->cfg())) {
+        redex_assert(invoke_virtual_insn != mie.insn);
+      }
 
-        virtual_methods_to_remove[type_class(overriding_method->get_class())]
-            .push_back(overriding_method);
-        auto virtual_scope_root = virtual_scope->methods.front();
-        always_assert(overriding_method != virtual_scope_root.first);
-        virtual_methods_to_remap.emplace(overriding_method,
-                                         virtual_scope_root.first);
+      auto virtual_scope_root = virtual_scope->methods.front();
+      always_assert(overriding_method != virtual_scope_root.first);
+      result->merged_methods.emplace_back(overriding_method,
+                                          virtual_scope_root.first);
 
-        stats.removed_virtual_methods++;
+      result->stats.removed_virtual_methods++;
+    }
+  }
+}
+
+// Partition the ordering into clusters of overridden methods that are
+// connected by the methods involved in their merges, e.g. when a method both
+// receives merged methods and gets merged itself. Merges in different clusters
+// touch disjoint methods; within a cluster, they must happen in order.
+std::vector<std::vector<size_t>> compute_clusters(
+    const std::vector<MethodData>& ordering) {
+  std::vector<size_t> parent(ordering.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&](size_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+
+  std::unordered_map<const DexMethod*, size_t> method_idx;
+  auto add = [&](const DexMethod* method, size_t i) {
+    auto [it, emplaced] = method_idx.emplace(method, i);
+    if (!emplaced) {
+      auto root = find(it->second);
+      auto other_root = find(i);
+      parent[std::max(root, other_root)] = std::min(root, other_root);
+    }
+  };
+  for (size_t i = 0; i < ordering.size(); i++) {
+    add(ordering[i].first, i);
+    for (const auto& q : ordering[i].second) {
+      for (auto* overriding_method : q.second) {
+        add(overriding_method, i);
       }
     }
   }
+
+  std::vector<std::vector<size_t>> clusters;
+  std::unordered_map<size_t, size_t> cluster_idx;
+  for (size_t i = 0; i < ordering.size(); i++) {
+    auto [it, emplaced] = cluster_idx.emplace(find(i), clusters.size());
+    if (emplaced) {
+      clusters.emplace_back();
+    }
+    clusters[it->second].push_back(i);
+  }
+  return clusters;
+}
+
+VirtualMergingStats apply_ordering(
+    MultiMethodInliner& inliner,
+    std::vector<MethodData>& ordering,
+    std::unordered_map<DexClass*, std::vector<const DexMethod*>>&
+        virtual_methods_to_remove,
+    std::unordered_map<DexMethod*, DexMethod*>& virtual_methods_to_remap,
+    VirtualMerging::InsertionStrategy insertion_strategy) {
+  auto clusters = compute_clusters(ordering);
+  TRACE(VM, 2, "[VM] Merging %zu overridden methods in %zu clusters",
+        ordering.size(), clusters.size());
+
+  std::vector<MergeResult> results(ordering.size());
+  workqueue_run_for<size_t>(0, clusters.size(), [&](size_t c) {
+    for (auto i : clusters[c]) {
+      merge_into_overridden_method(inliner, ordering[i], insertion_strategy,
+                                   &results[i]);
+    }
+  });
+
+  // Apply everything in the original order, to stay deterministic.
+  VirtualMergingStats stats;
+  for (auto& result : results) {
+    stats += result.stats;
+    inliner.visibility_changes_apply_and_record_make_static(
+        result.visibility_changes);
+    for (auto [overriding_method, root_method] : result.merged_methods) {
+      virtual_methods_to_remove[type_class(overriding_method->get_class())]
+          .push_back(overriding_method);
+      virtual_methods_to_remap.emplace(overriding_method, root_method);
+    }
+  }
   return stats;
 }
 
@@ -1355,7 +1447,8 @@ VirtualMergingStats apply_ordering(
 // Part 4: For each virtual scope, merge all pairs in order, unless inlining
 //         is for some reason not possible, e.g. because of code size
 //         constraints. Record set of methods in each class which can be
-//         removed.
+//         removed. Overridden methods that don't share any involved methods
+//         are merged into in parallel.
 void VirtualMerging::merge_methods(
     const MergablePairsByVirtualScope& mergeable_pairs,
     InsertionStrategy insertion_strategy) {
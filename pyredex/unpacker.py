@@ -31,6 +31,7 @@ from pyredex.logger import log
 from pyredex.utils import (
     abs_glob,
     ensure_libs_dir,
+    extract_zip,
     get_xz_path,
     make_temp_dir,
     remove_signature_files,
@@ -982,7 +983,7 @@ class ZipManager:
             for info in z.infolist():
                 self.per_file_compression[info.filename] = info.compress_type
                 file_casing_dict[info.filename.lower()].add(info.filename)
-            z.extractall(self.extracted_apk_dir)
+        extract_zip(self.input_apk, self.extracted_apk_dir)
 
         file_count = count_files_recursive(self.extracted_apk_dir) - file_count
         if expected_files != file_count:
@@ -9,6 +9,7 @@
 
 
 import argparse
+import concurrent.futures
 import distutils.version
 import glob
 import inspect
@@ -445,9 +446,47 @@ def argparse_yes_no_flag(
     )
 
 
+def _zip_entry_target_dir(destination_directory: str, filename: str) -> str:
+    # Mirrors the sanitization zipfile applies to member names when extracting.
+    parts = [p for p in filename.split("/") if p not in ("", os.curdir, os.pardir)]
+    if not filename.endswith("/"):
+        parts = parts[:-1]
+    return join(destination_directory, *parts)
+
+
+def extract_zip(
+    zip_path: str, destination_directory: str, threads: int = 4
+) -> None:
+    """
+    Extracts all entries of the zip file, decompressing on several threads.
+    Each thread reads through its own ZipFile, as those do not support
+    concurrent reads.
+    """
+    with zipfile.ZipFile(zip_path) as z:
+        infos = z.infolist()
+        if IS_WINDOWS or threads <= 1 or len(infos) < 2:
+            z.extractall(destination_directory)
+            return
+        # Create all directories up front, so that workers never race to
+        # create a shared parent.
+        for target_dir in {
+            _zip_entry_target_dir(destination_directory, info.filename)
+            for info in infos
+        }:
+            os.makedirs(target_dir, exist_ok=True)
+
+    def _extract_slice(start: int) -> None:
+        with zipfile.ZipFile(zip_path) as z:
+            for info in infos[start::threads]:
+                z.extract(info, destination_directory)
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=threads) as executor:
+        for future in [executor.submit(_extract_slice, i) for i in range(threads)]:
+            future.result()
+
+
 def unzip_apk(apk: str, destination_directory: str) -> None:
-    with zipfile.ZipFile(apk) as z:
-        z.extractall(destination_directory)
+    extract_zip(apk, destination_directory)
 
 
 def extract_dex_number(dexfilename: str) -> int:
@@ -23,7 +23,9 @@
 #include "ScopedCFG.h"
 #include "Show.h"
 #include "SourceBlocks.h"
+#include "Timer.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 using namespace class_merging;
 
@@ -750,12 +752,19 @@ void Model::map_fields(MergerType& merger,
  * belong to the mergeable types.
  */
 void Model::collect_methods() {
-  // collect all vmethods and dmethods of mergeable types into the merger
+  // collect all vmethods and dmethods of mergeable types into the merger.
+  // Each merger only reads the (by now fixed) hierarchy and writes its own
+  // method lists, which are filled in the same order as sequentially, so the
+  // mergers can be processed in parallel.
+  std::vector<MergerType*> mergers;
+  mergers.reserve(m_mergers.size());
   for (auto& merger_it : m_mergers) {
-    auto& merger = merger_it.second;
-    if (merger.mergeables.empty()) {
-      continue;
+    if (!merger_it.second.mergeables.empty()) {
+      mergers.push_back(&merger_it.second);
     }
+  }
+  workqueue_run<MergerType*>([&](MergerType* merger_ptr) {
+    auto& merger = *merger_ptr;
     TRACE(CLMG,
           8,
           "Collect methods for merger %s [%zu]",
@@ -823,13 +832,14 @@ void Model::collect_methods() {
         intf_meths.overridden_meth = nullptr;
       }
     }
-  }
+  }, mergers);
 
   // now for the virtual methods up the hierarchy and those in the type
   // of the merger (if an existing type) distribute them across the
   // proper merger
-  // collect all virtual scope up the hierarchy from a root
-  for (const MergerType* merger_root : m_roots) {
+  // collect all virtual scope up the hierarchy from a root. The subtrees of
+  // different roots are disjoint, so they are distributed in parallel.
+  workqueue_run<const MergerType*>([&](const MergerType* merger_root) {
     std::vector<const VirtualScope*> base_scopes;
     const auto root_type = merger_root->type;
     // get the first existing type from roots (has a DexClass)
@@ -854,7 +864,7 @@ void Model::collect_methods() {
     }
 
     distribute_virtual_methods(merger_root->type, base_scopes);
-  }
+  }, m_roots);
 }
 
 /**
@@ -1285,19 +1295,34 @@ Model Model::build_model(const Scope& scope,
                          const TypeSystem& type_system,
                          const RefChecker& refchecker) {
   Timer t("build_model");
+  AccumulatingTimer init_timer;
+  AccumulatingTimer shape_timer;
+  AccumulatingTimer collect_methods_timer;
 
   TRACE(CLMG, 3, "Build Model for %s", to_string(spec).c_str());
-  Model model(scope, stores, conf, spec, type_system, refchecker);
+  auto model = [&]() {
+    auto scope_timer = init_timer.scope();
+    return Model(scope, stores, conf, spec, type_system, refchecker);
+  }();
   TRACE(CLMG, 3, "Model:\n%s\nBuild Model done", model.print().c_str());
 
   TRACE(CLMG, 3, "Shape Model");
-  model.shape_model();
+  {
+    auto scope_timer = shape_timer.scope();
+    model.shape_model();
+  }
   TRACE(CLMG, 3, "Model:\n%s\nShape Model done", model.print().c_str());
 
   TRACE(CLMG, 3, "Final Model");
-  model.collect_methods();
+  {
+    auto scope_timer = collect_methods_timer.scope();
+    model.collect_methods();
+  }
   TRACE(CLMG, 3, "Model:\n%s\nFinal Model done", model.print().c_str());
 
+  model.m_stats.m_init_model_us = init_timer.get_microseconds();
+  model.m_stats.m_shape_model_us = shape_timer.get_microseconds();
+  model.m_stats.m_collect_methods_us = collect_methods_timer.get_microseconds();
   return model;
 }
 
@@ -1324,6 +1349,9 @@ ModelStats& ModelStats::operator+=(const ModelStats& stats) {
   m_num_vmethods_dedupped += stats.m_num_vmethods_dedupped;
   m_num_const_lifted_methods += stats.m_num_const_lifted_methods;
   m_updated_profile_method += stats.m_updated_profile_method;
+  m_init_model_us += stats.m_init_model_us;
+  m_shape_model_us += stats.m_shape_model_us;
+  m_collect_methods_us += stats.m_collect_methods_us;
   return *this;
 }
 
@@ -1362,6 +1390,9 @@ void ModelStats::update_redex_stats(const std::string& prefix,
   mgr.incr_metric(prefix + "_vmethods_dedupped", m_num_vmethods_dedupped);
   mgr.incr_metric(prefix + "_updated_profile_method", m_updated_profile_method);
   mgr.set_metric(prefix + "_const_lifted_methods", m_num_const_lifted_methods);
+  mgr.incr_metric(prefix + "_init_model_us", m_init_model_us);
+  mgr.incr_metric(prefix + "_shape_model_us", m_shape_model_us);
+  mgr.incr_metric(prefix + "_collect_methods_us", m_collect_methods_us);
 }
 
 } // namespace class_merging
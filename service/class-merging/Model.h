@@ -222,6 +222,10 @@ struct ModelStats {
   uint32_t m_num_vmethods_dedupped = 0;
   uint32_t m_num_const_lifted_methods = 0;
   uint32_t m_updated_profile_method = 0;
+  // Model construction times
+  uint64_t m_init_model_us = 0;
+  uint64_t m_shape_model_us = 0;
+  uint64_t m_collect_methods_us = 0;
 
   ModelStats& operator+=(const ModelStats& stats);
 
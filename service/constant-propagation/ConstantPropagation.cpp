@@ -32,6 +32,12 @@ Transform::Stats ConstantPropagation::run(
   {
     intraprocedural::FixpointIterator fp_iter(*cfg,
                                               ConstantPrimitiveAnalyzer());
+    fp_iter.set_num_threads(ir_analyzer::fixpoint_num_threads(*cfg));
+    if (m_config.prune_dead_registers_min_regs > 0 &&
+        cfg->get_registers_size() >= m_config.prune_dead_registers_min_regs) {
+      cfg->calculate_exit_block();
+      fp_iter.prune_dead_registers();
+    }
     fp_iter.run({});
     constant_propagation::Transform tf(m_config.transform, &runtime_cache);
     tf.apply(fp_iter, WholeProgramState(), code->cfg(), xstores,
@@ -14,6 +14,10 @@ namespace constant_propagation {
 
 struct Config {
   Transform::Config transform;
+  // In methods with at least this many registers, the analysis drops the
+  // bindings of dead registers at block boundaries; see
+  // intraprocedural::FixpointIterator::prune_dead_registers. Zero disables it.
+  size_t prune_dead_registers_min_regs{1000};
 };
 
 class ConstantPropagation final {
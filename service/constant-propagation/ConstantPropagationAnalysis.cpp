@@ -1589,6 +1589,45 @@ FixpointIterator::FixpointIterator(
       m_redex_null_check_assertion(method::redex_internal_checkObjectNotNull()),
       m_imprecise_switches(imprecise_switches) {}
 
+void FixpointIterator::prune_dead_registers() {
+  const auto& cfg = this->m_graph;
+  always_assert(cfg.exit_block() != nullptr);
+  m_liveness = std::make_unique<LivenessFixpointIterator>(cfg);
+  m_liveness->run(LivenessDomain());
+}
+
+ConstantEnvironment FixpointIterator::analyze_edge(
+    cfg::Edge* const& edge,
+    const ConstantEnvironment& exit_state_at_source) const {
+  auto env = BaseEdgeAwareIRAnalyzer::analyze_edge(edge, exit_state_at_source);
+  if (!m_liveness || env.is_bottom()) {
+    return env;
+  }
+  const auto& live_in = m_liveness->get_live_in_vars_at(edge->target());
+  // Blocks that cannot reach an exit, like infinite loops, have no
+  // meaningful liveness information.
+  if (!live_in.is_value()) {
+    return env;
+  }
+  const auto& elements = live_in.elements();
+  std::vector<reg_t> dead_regs;
+  env.get_register_environment().visit([&](const auto& binding) {
+    // The result register is implicitly read by a move-result at the start of
+    // the target block.
+    if (binding.first != RESULT_REGISTER && !elements.contains(binding.first)) {
+      dead_regs.push_back(binding.first);
+    }
+  });
+  if (!dead_regs.empty()) {
+    env.mutate_register_environment([&](ConstantRegisterEnvironment* regs) {
+      for (auto reg : dead_regs) {
+        regs->set(reg, ConstantValue::top());
+      }
+    });
+  }
+  return env;
+}
+
 void FixpointIterator::analyze_instruction_normal(
     const IRInstruction* insn, ConstantEnvironment* env) const {
   m_insn_analyzer(insn, env);
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <limits>
+#include <mutex>
 #include <unordered_set>
 #include <utility>
 
@@ -19,6 +20,7 @@
 #include "IRCode.h"
 #include "InstructionAnalyzer.h"
 #include "KotlinNullCheckMethods.h"
+#include "Liveness.h"
 #include "MethodUtil.h"
 
 class DexMethodRef;
@@ -42,7 +44,25 @@ class FixpointIterator final
                    InstructionAnalyzer<ConstantEnvironment> insn_analyzer,
                    bool imprecise_switches = false);
 
-  void clear_switch_succ_cache() const { m_switch_succs.clear(); }
+  void clear_switch_succ_cache() const {
+    std::lock_guard<std::mutex> lock(m_switch_succs_mutex);
+    m_switch_succs.clear();
+  }
+
+  /*
+   * Makes the iterator drop the bindings of registers that are dead on entry
+   * to a block, so that each stored entry state only describes the registers
+   * the block may read. This keeps the environments small in methods with
+   * many registers, and saves iterations on loops whose heads would
+   * otherwise be revisited for values that are never used again. The
+   * invariants are unchanged for every live register. Must be called before
+   * `run`.
+   */
+  void prune_dead_registers();
+
+  ConstantEnvironment analyze_edge(
+      cfg::Edge* const& edge,
+      const ConstantEnvironment& exit_state_at_source) const override;
 
  protected:
   void analyze_instruction_normal(const IRInstruction* insn,
@@ -61,14 +81,18 @@ class FixpointIterator final
 
  private:
   using SwitchSuccs = std::unordered_map<int32_t, uint32_t>;
+  // Guards the lazily filled cache when running with more than one thread.
+  mutable std::mutex m_switch_succs_mutex;
   mutable std::unordered_map<cfg::Block*, SwitchSuccs> m_switch_succs;
   InstructionAnalyzer<ConstantEnvironment> m_insn_analyzer;
   const std::unordered_set<DexMethodRef*>& m_kotlin_null_check_assertions;
   const DexMethodRef* m_redex_null_check_assertion;
 
   const bool m_imprecise_switches;
+  std::unique_ptr<LivenessFixpointIterator> m_liveness;
 
   const SwitchSuccs& find_switch_succs(cfg::Block* block) const {
+    std::lock_guard<std::mutex> lock(m_switch_succs_mutex);
     auto it = m_switch_succs.find(block);
     if (it == m_switch_succs.end()) {
       std::vector<int32_t> keys;
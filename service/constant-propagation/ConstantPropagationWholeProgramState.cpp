@@ -131,6 +131,37 @@ bool is_non_resource_root(DexField* field) {
   return (field_cls_name.find("/R$") == std::string::npos) && root(field);
 }
 
+template <typename Key>
+void join_value(const Key& key,
+                ConstantValue value,
+                std::unordered_map<Key, ConstantValue>* values) {
+  auto [it, emplaced] = values->emplace(key, value);
+  if (!emplaced) {
+    it->second.join_with(value);
+  }
+}
+
+/*
+ * The values written to fields and returned by methods, as observed by the
+ * methods analyzed by a single worker.
+ */
+struct PartialState {
+  std::unordered_map<const DexField*, ConstantValue> field_values;
+  std::unordered_map<const DexMethod*, ConstantValue> method_values;
+};
+
+struct JoinPartialStates {
+  void operator()(const PartialState& addend,
+                  PartialState* accumulator) const {
+    for (const auto& [field, value] : addend.field_values) {
+      join_value(field, value, &accumulator->field_values);
+    }
+    for (const auto& [method, value] : addend.method_values) {
+      join_value(method, value, &accumulator->method_values);
+    }
+  }
+};
+
 } // namespace
 
 namespace constant_propagation {
@@ -184,36 +215,39 @@ void WholeProgramState::collect(
     const interprocedural::FixpointIterator& fp_iter,
     const std::unordered_set<const DexField*>& definitely_assigned_ifields) {
   initialize_ifields(scope, &m_field_partition, definitely_assigned_ifields);
-  ConcurrentMap<const DexField*, ConstantValue> fields_value_tmp;
-  ConcurrentMap<const DexMethod*, ConstantValue> methods_value_tmp;
-  walk::parallel::methods(scope, [&](DexMethod* method) {
-    IRCode* code = method->get_code();
-    if (code == nullptr) {
-      return;
-    }
-    auto& cfg = code->cfg();
-    auto ipa = fp_iter.get_intraprocedural_analysis(method);
-    auto& intra_cp = ipa->fp_iter;
-    for (cfg::Block* b : cfg.blocks()) {
-      auto env = intra_cp.get_entry_state_at(b);
-      auto last_insn = b->get_last_insn();
-      for (auto& mie : InstructionIterable(b)) {
-        auto* insn = mie.insn;
-        intra_cp.analyze_instruction(insn, &env, insn == last_insn->insn);
-        collect_field_values(insn, env,
-                             method::is_clinit(method) ? method->get_class()
-                                                       : nullptr,
-                             &fields_value_tmp);
-        collect_return_values(insn, env, method, &methods_value_tmp);
-      }
-    }
-  });
-  for (const auto& pair : fields_value_tmp) {
+  // Each worker joins the values it sees into its own partial state, so that
+  // there is no contention between workers; the partial states are joined
+  // afterwards.
+  auto state = walk::parallel::methods<PartialState, JoinPartialStates>(
+      scope, [&](DexMethod* method, PartialState* partial_state) {
+        IRCode* code = method->get_code();
+        if (code == nullptr) {
+          return;
+        }
+        auto& cfg = code->cfg();
+        auto ipa = fp_iter.get_intraprocedural_analysis(method);
+        auto& intra_cp = ipa->fp_iter;
+        for (cfg::Block* b : cfg.blocks()) {
+          auto env = intra_cp.get_entry_state_at(b);
+          auto last_insn = b->get_last_insn();
+          for (auto& mie : InstructionIterable(b)) {
+            auto* insn = mie.insn;
+            intra_cp.analyze_instruction(insn, &env, insn == last_insn->insn);
+            collect_field_values(insn, env,
+                                 method::is_clinit(method) ? method->get_class()
+                                                           : nullptr,
+                                 &partial_state->field_values);
+            collect_return_values(insn, env, method,
+                                  &partial_state->method_values);
+          }
+        }
+      });
+  for (const auto& pair : state.field_values) {
     m_field_partition.update(pair.first, [&pair](auto* current_value) {
       current_value->join_with(pair.second);
     });
   }
-  for (const auto& pair : methods_value_tmp) {
+  for (const auto& pair : state.method_values) {
     m_method_partition.update(pair.first, [&pair](auto* current_value) {
       current_value->join_with(pair.second);
     });
@@ -233,7 +267,7 @@ void WholeProgramState::collect_field_values(
     const IRInstruction* insn,
     const ConstantEnvironment& env,
     const DexType* clinit_cls,
-    ConcurrentMap<const DexField*, ConstantValue>* fields_value_tmp) {
+    std::unordered_map<const DexField*, ConstantValue>* fields_value_tmp) {
   if (!opcode::is_an_sput(insn->opcode()) &&
       !opcode::is_an_iput(insn->opcode())) {
     return;
@@ -244,16 +278,8 @@ void WholeProgramState::collect_field_values(
         field->get_class() == clinit_cls) {
       return;
     }
-    auto value = env.get(insn->src(0));
-    fields_value_tmp->update(
-        field,
-        [&value](const DexField*, ConstantValue& current_value, bool exists) {
-          if (exists) {
-            current_value.join_with(value);
-          } else {
-            current_value = std::move(value);
-          }
-        });
+    join_value<const DexField*>(field, env.get(insn->src(0)),
+                                fields_value_tmp);
   }
 }
 
@@ -267,7 +293,7 @@ void WholeProgramState::collect_return_values(
     const IRInstruction* insn,
     const ConstantEnvironment& env,
     const DexMethod* method,
-    ConcurrentMap<const DexMethod*, ConstantValue>* methods_value_tmp) {
+    std::unordered_map<const DexMethod*, ConstantValue>* methods_value_tmp) {
   auto op = insn->opcode();
   if (!opcode::is_a_return(op)) {
     return;
@@ -277,23 +303,10 @@ void WholeProgramState::collect_return_values(
     // does indeed return -- even though `void` is not actually a return value,
     // this tells us that the code following any invoke of this method is
     // reachable.
-    methods_value_tmp->update(
-        method,
-        [](const DexMethod*, ConstantValue& current_value, bool /* exists */) {
-          current_value = ConstantValue::top();
-        });
+    methods_value_tmp->insert_or_assign(method, ConstantValue::top());
     return;
   }
-  auto value = env.get(insn->src(0));
-  methods_value_tmp->update(
-      method,
-      [&value](const DexMethod*, ConstantValue& current_value, bool exists) {
-        if (exists) {
-          current_value.join_with(value);
-        } else {
-          current_value = std::move(value);
-        }
-      });
+  join_value(method, env.get(insn->src(0)), methods_value_tmp);
 }
 
 void WholeProgramState::collect_static_finals(const DexClass* cls,
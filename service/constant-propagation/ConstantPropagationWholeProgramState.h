@@ -136,13 +136,13 @@ class WholeProgramState {
       const IRInstruction* insn,
       const ConstantEnvironment& env,
       const DexType* clinit_cls,
-      ConcurrentMap<const DexField*, ConstantValue>* fields_value_tmp);
+      std::unordered_map<const DexField*, ConstantValue>* fields_value_tmp);
 
   void collect_return_values(
       const IRInstruction* insn,
       const ConstantEnvironment& env,
       const DexMethod* method,
-      ConcurrentMap<const DexMethod*, ConstantValue>* methods_value_tmp);
+      std::unordered_map<const DexMethod*, ConstantValue>* methods_value_tmp);
 
   std::shared_ptr<const call_graph::Graph> m_call_graph;
 
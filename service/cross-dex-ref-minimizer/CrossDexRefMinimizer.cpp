@@ -106,10 +106,8 @@ void CrossDexRefMinimizer::reprioritize(
         affected_classes) {
   TRACE(IDEX, 4, "[dex ordering] Reprioritizing %zu classes",
         affected_classes.size());
-  for (auto p : affected_classes) {
+  for (const auto& [affected_class, delta] : affected_classes) {
     ++m_stats.reprioritizations;
-    DexClass* affected_class = p.first;
-    CrossDexRefMinimizer::ClassInfoDelta& delta = p.second;
     CrossDexRefMinimizer::ClassInfo& affected_class_info =
         m_class_infos.at(affected_class);
     affected_class_info.applied_refs_weight += delta.applied_refs_weight;
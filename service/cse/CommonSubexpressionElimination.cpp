@@ -71,6 +71,7 @@
 #include "Trace.h"
 #include "TypeInference.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 using namespace sparta;
 using namespace cse_impl;
@@ -1290,9 +1291,64 @@ void SharedState::init_scope(
   }
 
   init_method_barriers(scope);
+  init_invoke_written_locations(scope);
   init_finalizable_fields(scope);
 }
 
+void SharedState::init_invoke_written_locations(const Scope& scope) {
+  Timer t("init_invoke_written_locations");
+  ConcurrentSet<const DexMethod*> concurrent_callees;
+  walk::parallel::code(scope, [&](DexMethod*, IRCode& code) {
+    std::unordered_set<const DexMethod*> callees;
+    for (const auto& mie : cfg::InstructionIterable(code.cfg())) {
+      auto* insn = mie.insn;
+      if (!opcode::is_an_invoke(insn->opcode()) ||
+          insn->opcode() == OPCODE_INVOKE_SUPER) {
+        continue;
+      }
+      auto* callee = resolve_method(insn->get_method(), opcode_to_search(insn));
+      if (callee != nullptr) {
+        callees.insert(callee);
+      }
+    }
+    for (auto* callee : callees) {
+      concurrent_callees.insert(callee);
+    }
+  });
+
+  std::vector<const DexMethod*> callees(concurrent_callees.begin(),
+                                        concurrent_callees.end());
+  std::vector<std::optional<CseUnorderedLocationSet>> written_locations(
+      callees.size());
+  workqueue_run_for<size_t>(0, callees.size(), [&](size_t i) {
+    written_locations[i] = compute_invoke_written_locations(callees[i]);
+  });
+  m_invoke_written_locations.reserve(callees.size());
+  for (size_t i = 0; i < callees.size(); i++) {
+    m_invoke_written_locations.emplace(callees[i],
+                                       std::move(written_locations[i]));
+  }
+}
+
+std::optional<CseUnorderedLocationSet>
+SharedState::compute_invoke_written_locations(const DexMethod* method) const {
+  CseUnorderedLocationSet written_locations;
+  if (!process_base_and_overriding_methods(
+          m_method_override_graph.get(), method, &m_safe_method_defs,
+          /* ignore_methods_with_assumenosideeffects */ true,
+          [&](DexMethod* other_method) {
+            auto it = m_method_written_locations.find(other_method);
+            if (it == m_method_written_locations.end()) {
+              return false;
+            }
+            written_locations.insert(it->second.begin(), it->second.end());
+            return true;
+          })) {
+    return std::nullopt;
+  }
+  return written_locations;
+}
+
 CseUnorderedLocationSet SharedState::get_relevant_written_locations(
     const IRInstruction* insn,
     DexType* exact_virtual_scope,
@@ -1389,26 +1445,31 @@ CseUnorderedLocationSet SharedState::get_relevant_written_locations(
 
   auto method_ref = insn->get_method();
   DexMethod* method = resolve_method(method_ref, opcode_to_search(insn));
-  CseUnorderedLocationSet written_locations;
-  if (!process_base_and_overriding_methods(
-          m_method_override_graph.get(), method, &m_safe_method_defs,
-          /* ignore_methods_with_assumenosideeffects */ true,
-          [&](DexMethod* other_method) {
-            auto it = m_method_written_locations.find(other_method);
-            if (it == m_method_written_locations.end()) {
-              return false;
-            }
-            written_locations.insert(it->second.begin(), it->second.end());
-            return true;
-          })) {
-    return general_memory_barrier_locations;
+  // Invokes that were not around during init_scope, e.g. because they got
+  // inlined since, fall back to computing the locations on the fly.
+  const CseUnorderedLocationSet* all_written_locations;
+  std::optional<CseUnorderedLocationSet> computed_written_locations;
+  auto it = m_invoke_written_locations.find(method);
+  if (it != m_invoke_written_locations.end()) {
+    if (!it->second) {
+      return general_memory_barrier_locations;
+    }
+    all_written_locations = &*it->second;
+  } else {
+    computed_written_locations = compute_invoke_written_locations(method);
+    if (!computed_written_locations) {
+      return general_memory_barrier_locations;
+    }
+    all_written_locations = &*computed_written_locations;
   }
 
-  // Remove written locations that are not read
-  std20::erase_if(written_locations, [&read_locations](auto& l) {
-    return !read_locations.count(l);
-  });
-
+  // Only keep written locations that are read
+  CseUnorderedLocationSet written_locations;
+  for (const auto& l : *all_written_locations) {
+    if (read_locations.count(l)) {
+      written_locations.insert(l);
+    }
+  }
   return written_locations;
 }
 
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <optional>
+
 #include <sparta/PatriciaTreeSet.h>
 
 #include "ConcurrentContainers.h"
@@ -111,6 +113,9 @@ class SharedState {
 
  private:
   void init_method_barriers(const Scope& scope);
+  void init_invoke_written_locations(const Scope& scope);
+  std::optional<CseUnorderedLocationSet> compute_invoke_written_locations(
+      const DexMethod* method) const;
   void init_finalizable_fields(const Scope& scope);
   bool may_be_barrier(const IRInstruction* insn, DexType* exact_virtual_scope);
   bool is_invoke_safe(const IRInstruction* insn, DexType* exact_virtual_scope);
@@ -130,6 +135,11 @@ class SharedState {
       m_method_written_locations;
   std::unordered_map<const DexMethod*, CseUnorderedLocationSet>
       m_conditionally_pure_methods;
+  // For each resolved callee of an invoke in the scope, the written locations
+  // of all its possible targets, or none if it may be a general memory
+  // barrier. This is computed upfront, and is read-only afterwards.
+  std::unordered_map<const DexMethod*, std::optional<CseUnorderedLocationSet>>
+      m_invoke_written_locations;
   std::unique_ptr<const method_override_graph::Graph> m_method_override_graph;
   SharedStateStats m_stats;
   // boxing to unboxing mapping
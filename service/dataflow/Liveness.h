@@ -7,12 +7,14 @@
 
 #pragma once
 
-#include <sparta/PatriciaTreeSetAbstractDomain.h>
+#include <sparta/BitVectorSetAbstractDomain.h>
 
 #include "BaseIRAnalyzer.h"
 #include "ControlFlow.h"
 
-using LivenessDomain = sparta::PatriciaTreeSetAbstractDomain<reg_t>;
+// Registers are numbered densely from zero, so a bit vector is both smaller
+// and faster to join than a Patricia tree here.
+using LivenessDomain = sparta::BitVectorSetAbstractDomain<reg_t>;
 
 class LivenessFixpointIterator final
     : public ir_analyzer::BaseBackwardsIRAnalyzer<LivenessDomain> {
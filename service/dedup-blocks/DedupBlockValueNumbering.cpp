@@ -144,6 +144,74 @@ value_id_t BlockValues::get_value_id(const IROperation& operation) const {
     return it->second;
   }
   value_id_t id = m_value_ids.size();
-  m_value_ids.emplace(operation, id);
+  auto emplaced = m_value_ids.emplace(operation, id);
+  m_value_operations.push_back(&emplaced.first->first);
   return id;
 }
+
+size_t BlockValues::get_canonical_hash(cfg::Block* block) const {
+  const auto* block_value = get_block_value(block);
+  std::unordered_map<value_id_t, size_t> value_hashes;
+  size_t inputs = 0;
+  auto hash_operation = [&](const IROperation& operation) {
+    size_t hash = operation.opcode;
+    std::vector<size_t> src_hashes;
+    src_hashes.reserve(operation.srcs.size());
+    for (auto src : operation.srcs) {
+      src_hashes.push_back(value_hashes.at(src));
+    }
+    // The srcs of commutative operations are sorted by value id, which is
+    // specific to this method.
+    if (opcode::is_commutative(operation.opcode)) {
+      std::sort(src_hashes.begin(), src_hashes.end());
+    }
+    boost::hash_combine(hash, src_hashes);
+    if (operation.opcode == IOPCODE_LOAD_REG) {
+      boost::hash_combine(hash, inputs++);
+    } else {
+      boost::hash_combine(hash, (size_t)operation.literal);
+    }
+    return hash;
+  };
+  // Srcs always have smaller value ids than their users, but the chains can
+  // be long, so we walk them with an explicit stack.
+  auto get_value_hash = [&](value_id_t root) {
+    std::vector<value_id_t> stack{root};
+    while (!stack.empty()) {
+      auto id = stack.back();
+      if (value_hashes.count(id)) {
+        stack.pop_back();
+        continue;
+      }
+      const auto& operation = *m_value_operations.at(id);
+      bool ready = true;
+      for (auto src : operation.srcs) {
+        if (!value_hashes.count(src)) {
+          stack.push_back(src);
+          ready = false;
+        }
+      }
+      if (ready) {
+        stack.pop_back();
+        value_hashes.emplace(id, hash_operation(operation));
+      }
+    }
+    return value_hashes.at(root);
+  };
+
+  size_t hash = 0;
+  for (const auto& operation : block_value->ordered_operations) {
+    // Source blocks are the only ordered operations without an opcode.
+    if (operation.opcode == OPCODE_NOP) {
+      continue;
+    }
+    for (auto src : operation.srcs) {
+      get_value_hash(src);
+    }
+    boost::hash_combine(hash, hash_operation(operation));
+  }
+  for (const auto& [reg, value] : block_value->out_regs) {
+    boost::hash_combine(hash, get_value_hash(value));
+  }
+  return hash;
+}
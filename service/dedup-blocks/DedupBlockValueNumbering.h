@@ -101,6 +101,13 @@ class BlockValues {
 
   const BlockValue* get_block_value(cfg::Block* block) const;
 
+  // A hash of the block value that does not depend on this method's value
+  // numbering, register names or source block ids, so that it can be compared
+  // across methods. Values are hashed structurally from the operations that
+  // produce them, and input registers by their order of first use. Equal
+  // hashes are only a hint; the blocks still need to be compared.
+  size_t get_canonical_hash(cfg::Block* block) const;
+
  private:
   value_id_t prepare_and_get_reg(std::map<reg_t, value_id_t>& regs,
                                  reg_t reg) const;
@@ -116,5 +123,7 @@ class BlockValues {
       m_block_values;
   mutable std::unordered_map<IROperation, value_id_t, IROperationHasher>
       m_value_ids;
+  // Indexed by value id; points into the keys of m_value_ids.
+  mutable std::vector<const IROperation*> m_value_operations;
 };
 } // namespace DedupBlkValueNumbering
@@ -293,6 +293,23 @@ class DedupBlocksImpl {
     return false;
   }
 
+  // Compute the canonical hashes of the eligible blocks of the (final) CFG,
+  // for the cross-method BlockHashIndex.
+  void collect_block_hashes(cfg::ControlFlowGraph& cfg,
+                            std::vector<BlockHash>& block_hashes) {
+    cfg.calculate_exit_block();
+    LivenessFixpointIterator liveness_fixpoint_iter(cfg);
+    liveness_fixpoint_iter.run({});
+    DedupBlkValueNumbering::BlockValues block_values(liveness_fixpoint_iter);
+    for (cfg::Block* block : cfg.blocks()) {
+      auto size = num_opcodes(block);
+      if (size >= m_config->block_hash_min_opcode_count &&
+          is_eligible(block, cfg)) {
+        block_hashes.push_back({block_values.get_canonical_hash(block), size});
+      }
+    }
+  }
+
   /*
    * Split blocks that share postfix of instructions (that ends with the same
    * set of instructions).
@@ -1324,6 +1341,54 @@ void DedupBlocks::run() {
     }
   } while (impl.dedup(m_is_static, m_declaring_type, m_args, cfg) &&
            iteration < m_config->max_iteration);
+  if (m_config->collect_block_hashes) {
+    impl.collect_block_hashes(cfg, m_block_hashes);
+  }
+}
+
+void BlockHashIndex::update(const DexMethod* method,
+                            std::vector<BlockHash> block_hashes) {
+  if (block_hashes.empty()) {
+    m_method_block_hashes.erase(method);
+    return;
+  }
+  m_method_block_hashes.update(
+      method, [&](const DexMethod*, std::vector<BlockHash>& value, bool) {
+        value = std::move(block_hashes);
+      });
+}
+
+void BlockHashIndex::remove_if(
+    const std::function<bool(const DexMethod*)>& pred) {
+  std::vector<const DexMethod*> to_remove;
+  for (const auto& [method, _] : m_method_block_hashes) {
+    if (pred(method)) {
+      to_remove.push_back(method);
+    }
+  }
+  for (const auto* method : to_remove) {
+    m_method_block_hashes.erase(method);
+  }
+}
+
+std::unordered_map<size_t, BlockHashIndex::Occurrences>
+BlockHashIndex::get_cross_method_duplicates() const {
+  std::unordered_map<size_t, Occurrences> occurrences;
+  for (const auto& [method, block_hashes] : m_method_block_hashes) {
+    for (const auto& block_hash : block_hashes) {
+      auto& occ = occurrences[block_hash.hash];
+      occ.num_opcodes = block_hash.num_opcodes;
+      if (occ.methods.empty() || occ.methods.back() != method) {
+        occ.methods.push_back(method);
+      }
+    }
+  }
+  std20::erase_if(occurrences,
+                  [](const auto& p) { return p.second.methods.size() < 2; });
+  for (auto& [_, occ] : occurrences) {
+    std::sort(occ.methods.begin(), occ.methods.end(), compare_dexmethods);
+  }
+  return occurrences;
 }
 
 Stats& Stats::operator+=(const Stats& that) {
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <functional>
+
+#include "ConcurrentContainers.h"
 #include "DexClass.h"
 
 class IRInstruction;
@@ -22,6 +25,17 @@ struct Config {
   bool debug = false;
   bool dedup_fill_in_stack_trace = false;
   uint32_t max_iteration = 6;
+  // Whether to compute canonical hashes of the final blocks, see
+  // DedupBlocks::get_block_hashes.
+  bool collect_block_hashes = false;
+  static const unsigned int DEFAULT_BLOCK_HASH_MIN_OPCODE_COUNT = 3;
+  unsigned int block_hash_min_opcode_count =
+      DEFAULT_BLOCK_HASH_MIN_OPCODE_COUNT;
+};
+
+struct BlockHash {
+  size_t hash;
+  size_t num_opcodes;
 };
 
 struct Stats {
@@ -48,6 +62,10 @@ class DedupBlocks {
 
   const Stats& get_stats() const { return m_stats; }
 
+  // Canonical hashes of the eligible blocks left after run(), when
+  // Config::collect_block_hashes is set.
+  std::vector<BlockHash>& get_block_hashes() { return m_block_hashes; }
+
   void run();
 
  private:
@@ -57,6 +75,40 @@ class DedupBlocks {
   DexType* m_declaring_type;
   DexTypeList* m_args;
   Stats m_stats;
+  std::vector<BlockHash> m_block_hashes;
+};
+
+/*
+ * DedupBlocks only finds duplicates within a method. This index keeps the
+ * canonical block hashes of all methods, to find candidate blocks that occur in
+ * several methods, e.g. for outlining or method deduplication.
+ *
+ * It is maintained incrementally: each run of DedupBlocks replaces the entries
+ * of the methods it processed, so the same index can be carried across
+ * several invocations. Updates are thread-safe; queries are not meant to run
+ * concurrently with updates.
+ */
+class BlockHashIndex {
+ public:
+  struct Occurrences {
+    size_t num_opcodes{0};
+    // Sorted, without duplicates.
+    std::vector<const DexMethod*> methods;
+  };
+
+  void update(const DexMethod* method, std::vector<BlockHash> block_hashes);
+
+  // Drop the entries of methods that went away or are no longer processed.
+  void remove_if(const std::function<bool(const DexMethod*)>& pred);
+
+  size_t num_methods() const { return m_method_block_hashes.size(); }
+
+  // Block hashes that occur in more than one method.
+  std::unordered_map<size_t, Occurrences> get_cross_method_duplicates() const;
+
+ private:
+  ConcurrentMap<const DexMethod*, std::vector<BlockHash>>
+      m_method_block_hashes;
 };
 
 } // namespace dedup_blocks_impl
@@ -21,6 +21,7 @@
 #include "ScopedCFG.h"
 #include "TypeInference.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 namespace {
 
@@ -427,6 +428,88 @@ void analyze_writes(const Scope& scope,
   });
 };
 
+namespace {
+
+using MethodFieldStats = std::unordered_map<DexField*, FieldStats>;
+
+// The read/write counts of the instructions of a single method.
+MethodFieldStats compute_method_field_stats(const DexMethod* method) {
+  MethodFieldStats field_stats;
+  if (method::is_init(method)) {
+    // compute init_writes by checking receiver of each iput
+    cfg::ScopedCFG cfg(const_cast<DexMethod*>(method)->get_code());
+    reaching_defs::MoveAwareFixpointIterator reaching_definitions(*cfg);
+    reaching_definitions.run(reaching_defs::Environment());
+    auto first_load_param = cfg->get_param_instructions().begin()->insn;
+    always_assert(first_load_param->opcode() == IOPCODE_LOAD_PARAM_OBJECT);
+    for (cfg::Block* block : cfg->blocks()) {
+      auto env = reaching_definitions.get_entry_state_at(block);
+      auto insns = InstructionIterable(block);
+      for (auto it = insns.begin(); it != insns.end();
+           reaching_definitions.analyze_instruction(it++->insn, &env)) {
+        IRInstruction* insn = it->insn;
+        if (!opcode::is_an_iput(insn->opcode())) {
+          continue;
+        }
+        auto field = resolve_field(insn->get_field());
+        if (field == nullptr || field->get_class() != method->get_class()) {
+          continue;
+        }
+        // We only consider for init_writes those iputs where the obj is the
+        // receiver. I cannot see where the JVM spec this would be enforced,
+        // we'll be conservative to be safe.
+        auto obj_defs = env.get(insn->src(1));
+        if (!obj_defs.is_top() && !obj_defs.is_bottom() &&
+            obj_defs.elements().size() == 1 &&
+            *obj_defs.elements().begin() == first_load_param) {
+          ++field_stats[field].init_writes;
+        }
+      }
+    }
+  }
+  bool is_clinit = method::is_clinit(method);
+  editable_cfg_adapter::iterate(
+      const_cast<DexMethod*>(method)->get_code(),
+      [&](const MethodItemEntry& mie) {
+        auto insn = mie.insn;
+        auto op = insn->opcode();
+        if (!insn->has_field()) {
+          return editable_cfg_adapter::LOOP_CONTINUE;
+        }
+        auto field = resolve_field(insn->get_field());
+        if (field == nullptr) {
+          return editable_cfg_adapter::LOOP_CONTINUE;
+        }
+        if (opcode::is_an_sget(op) || opcode::is_an_iget(op)) {
+          ++field_stats[field].reads;
+        } else if (opcode::is_an_sput(op) || opcode::is_an_iput(op)) {
+          ++field_stats[field].writes;
+          if (is_clinit && is_static(field) &&
+              field->get_class() == method->get_class()) {
+            ++field_stats[field].init_writes;
+          }
+        }
+        return editable_cfg_adapter::LOOP_CONTINUE;
+      });
+  return field_stats;
+}
+
+// Gather field reads from annotations.
+void gather_annotation_reads(const Scope& scope, FieldStatsMap* field_stats) {
+  walk::annotations(scope, [&](DexAnnotation* anno) {
+    std::vector<DexFieldRef*> fields_in_anno;
+    anno->gather_fields(fields_in_anno);
+    for (const auto& field_ref : fields_in_anno) {
+      auto field = resolve_field(field_ref);
+      if (field) {
+        ++(*field_stats)[field].reads;
+      }
+    }
+  });
+}
+
+} // namespace
+
 FieldStatsMap analyze(const Scope& scope) {
   ConcurrentMap<DexField*, FieldStats> concurrent_field_stats;
   // Gather the read/write counts from instructions.
@@ -434,63 +517,7 @@ FieldStatsMap analyze(const Scope& scope) {
     if (!method->get_code()) {
       return;
     }
-    std::unordered_map<DexField*, FieldStats> field_stats;
-    if (method::is_init(method)) {
-      // compute init_writes by checking receiver of each iput
-      cfg::ScopedCFG cfg(method->get_code());
-      reaching_defs::MoveAwareFixpointIterator reaching_definitions(*cfg);
-      reaching_definitions.run(reaching_defs::Environment());
-      auto first_load_param = cfg->get_param_instructions().begin()->insn;
-      always_assert(first_load_param->opcode() == IOPCODE_LOAD_PARAM_OBJECT);
-      for (cfg::Block* block : cfg->blocks()) {
-        auto env = reaching_definitions.get_entry_state_at(block);
-        auto insns = InstructionIterable(block);
-        for (auto it = insns.begin(); it != insns.end();
-             reaching_definitions.analyze_instruction(it++->insn, &env)) {
-          IRInstruction* insn = it->insn;
-          if (!opcode::is_an_iput(insn->opcode())) {
-            continue;
-          }
-          auto field = resolve_field(insn->get_field());
-          if (field == nullptr || field->get_class() != method->get_class()) {
-            continue;
-          }
-          // We only consider for init_writes those iputs where the obj is the
-          // receiver. I cannot see where the JVM spec this would be enforced,
-          // we'll be conservative to be safe.
-          auto obj_defs = env.get(insn->src(1));
-          if (!obj_defs.is_top() && !obj_defs.is_bottom() &&
-              obj_defs.elements().size() == 1 &&
-              *obj_defs.elements().begin() == first_load_param) {
-            ++field_stats[field].init_writes;
-          }
-        }
-      }
-    }
-    bool is_clinit = method::is_clinit(method);
-    editable_cfg_adapter::iterate(
-        method->get_code(), [&](const MethodItemEntry& mie) {
-          auto insn = mie.insn;
-          auto op = insn->opcode();
-          if (!insn->has_field()) {
-            return editable_cfg_adapter::LOOP_CONTINUE;
-          }
-          auto field = resolve_field(insn->get_field());
-          if (field == nullptr) {
-            return editable_cfg_adapter::LOOP_CONTINUE;
-          }
-          if (opcode::is_an_sget(op) || opcode::is_an_iget(op)) {
-            ++field_stats[field].reads;
-          } else if (opcode::is_an_sput(op) || opcode::is_an_iput(op)) {
-            ++field_stats[field].writes;
-            if (is_clinit && is_static(field) &&
-                field->get_class() == method->get_class()) {
-              ++field_stats[field].init_writes;
-            }
-          }
-          return editable_cfg_adapter::LOOP_CONTINUE;
-        });
-    for (auto& p : field_stats) {
+    for (auto& p : compute_method_field_stats(method)) {
       concurrent_field_stats.update(
           p.first, [&](DexField*, FieldStats& fs, bool) { fs += p.second; });
     }
@@ -498,19 +525,78 @@ FieldStatsMap analyze(const Scope& scope) {
 
   FieldStatsMap field_stats(concurrent_field_stats.begin(),
                             concurrent_field_stats.end());
+  gather_annotation_reads(scope, &field_stats);
+  return field_stats;
+}
 
-  // Gather field reads from annotations.
-  walk::annotations(scope, [&](DexAnnotation* anno) {
-    std::vector<DexFieldRef*> fields_in_anno;
-    anno->gather_fields(fields_in_anno);
-    for (const auto& field_ref : fields_in_anno) {
-      auto field = resolve_field(field_ref);
-      if (field) {
-        ++field_stats[field].reads;
-      }
+FieldAccessIndex::FieldAccessIndex(const Scope& scope) {
+  walk::parallel::methods(scope, [&](DexMethod* method) {
+    if (!method->get_code()) {
+      return;
+    }
+    auto field_stats = compute_method_field_stats(method);
+    for (auto& p : field_stats) {
+      m_accessors.update(p.first,
+                         [&](const DexField*, MethodSet& methods, bool) {
+                           methods.insert(method);
+                         });
     }
+    m_method_field_stats.emplace(method, std::move(field_stats));
   });
+  gather_annotation_reads(scope, &m_annotation_field_stats);
+}
+
+void FieldAccessIndex::update(
+    const std::vector<const DexMethod*>& dirty_methods) {
+  workqueue_run<const DexMethod*>(
+      [&](const DexMethod* method) {
+        auto field_stats = compute_method_field_stats(method);
+        MethodFieldStats old_field_stats;
+        m_method_field_stats.update(
+            method, [&](const DexMethod*, MethodFieldStats& value, bool) {
+              old_field_stats = std::move(value);
+              value = field_stats;
+            });
+        for (auto& p : old_field_stats) {
+          if (!field_stats.count(p.first)) {
+            m_accessors.update(p.first,
+                               [&](const DexField*, MethodSet& methods, bool) {
+                                 methods.erase(method);
+                               });
+          }
+        }
+        for (auto& p : field_stats) {
+          if (!old_field_stats.count(p.first)) {
+            m_accessors.update(p.first,
+                               [&](const DexField*, MethodSet& methods, bool) {
+                                 methods.insert(method);
+                               });
+          }
+        }
+      },
+      dirty_methods);
+}
+
+FieldStatsMap FieldAccessIndex::get_field_stats() const {
+  FieldStatsMap field_stats = m_annotation_field_stats;
+  for (auto& [method, method_field_stats] : m_method_field_stats) {
+    for (auto& [field, stats] : method_field_stats) {
+      field_stats[field] += stats;
+    }
+  }
   return field_stats;
 }
 
+FieldAccessIndex::MethodSet FieldAccessIndex::get_accessors(
+    const std::unordered_set<const DexField*>& fields) const {
+  MethodSet res;
+  for (auto* field : fields) {
+    auto* methods = m_accessors.get_unsafe(field);
+    if (methods != nullptr) {
+      res.insert(methods->begin(), methods->end());
+    }
+  }
+  return res;
+}
+
 } // namespace field_op_tracker
@@ -11,6 +11,8 @@
 #include "DexClass.h"
 
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace field_op_tracker {
 
@@ -48,6 +50,36 @@ using FieldStatsMap = std::unordered_map<DexField*, FieldStats>;
 
 FieldStatsMap analyze(const Scope& scope);
 
+/**
+ * Keeps track of the read/write counts of each method, and of which methods
+ * access which fields, so that the FieldStatsMap of a scope can be recomputed
+ * after a transformation by only re-analyzing the methods it changed, and so
+ * that transformations can visit only the methods accessing particular fields.
+ */
+class FieldAccessIndex {
+ public:
+  using MethodSet = std::unordered_set<const DexMethod*>;
+
+  explicit FieldAccessIndex(const Scope& scope);
+
+  // Re-analyzes the given methods, which must have code, after their code was
+  // changed. Annotations are assumed to be unchanged.
+  void update(const std::vector<const DexMethod*>& dirty_methods);
+
+  // Same result as analyze(scope) for the current state of the scope.
+  FieldStatsMap get_field_stats() const;
+
+  // All methods with instructions reading or writing any of the given fields.
+  MethodSet get_accessors(
+      const std::unordered_set<const DexField*>& fields) const;
+
+ private:
+  ConcurrentMap<const DexMethod*, std::unordered_map<DexField*, FieldStats>>
+      m_method_field_stats;
+  ConcurrentMap<const DexField*, MethodSet> m_accessors;
+  FieldStatsMap m_annotation_field_stats;
+};
+
 struct FieldWrites {
   // All fields to which some potentially non-zero value is written.
   ConcurrentSet<DexField*> non_zero_written_fields;
@@ -10,48 +10,33 @@
 #include "PassManager.h"
 #include "Show.h"
 #include "Walkers.h"
-
-namespace {
-DexField* has_instance_field(DexClass* cls, const DexString* instance) {
-  for (auto* filed : cls->get_sfields()) {
-    if (filed->get_name() == instance && filed->get_type() == cls->get_type()) {
-      return filed;
-    }
-  }
-  return nullptr;
-}
-
-} // namespace
+#include "WorkQueue.h"
 
 KotlinInstanceRewriter::Stats KotlinInstanceRewriter::collect_instance_usage(
-    const Scope& scope,
+    const kotlin_shapes::ShapeIndex& shapes,
     ConcurrentMap<DexFieldRef*,
                   std::set<std::pair<IRInstruction*, DexMethod*>>>&
         concurrent_instance_map,
-
     std::function<bool(DexClass*)> do_not_consider_type) {
   // Collect all the types which are of Kotlin classes which sets INSTANCE
   // variable.
   // Get all the uses of the INSTANCE variables whose <init> does not have
   // sideeffets
   KotlinInstanceRewriter::Stats stats{};
-  walk::parallel::classes(scope, [&](DexClass* cls) {
+  workqueue_run<DexClass*>([&](DexClass* cls) {
     if (!can_rename(cls) || !can_delete(cls)) {
       return;
     }
-    auto instance = has_instance_field(cls, m_instance);
-    if (!instance) {
-      return;
-    }
     if (do_not_consider_type(cls)) {
       return;
     }
+    auto instance = shapes.get(cls).instance_field;
     if (concurrent_instance_map.count(instance)) {
       return;
     }
     std::set<std::pair<IRInstruction*, DexMethod*>> insns;
     concurrent_instance_map.emplace(instance, insns);
-  });
+  }, shapes.singletons());
   stats.kotlin_new_instance = concurrent_instance_map.size();
   return stats;
 }
@@ -9,6 +9,7 @@
 
 #include "ConcurrentContainers.h"
 #include "DexUtil.h"
+#include "KotlinShapes.h"
 
 class PassManager;
 
@@ -34,17 +35,12 @@ class KotlinInstanceRewriter {
     void report(PassManager& mgr) const;
   };
 
-  KotlinInstanceRewriter() {
-    m_instance = DexString::make_string("INSTANCE");
-    always_assert(m_instance);
-  }
-
   // Collect Kotlin noncapturing Lambda which would have an INSTANCE field of
   // the same type and is initilized in <clinit>. Collect all such Lambda. Map
   // contains the field (that contains INSTANCE) and {insn, method} where it is
   // read (or used).
   Stats collect_instance_usage(
-      const Scope& scope,
+      const kotlin_shapes::ShapeIndex& shapes,
       ConcurrentMap<DexFieldRef*,
                     std::set<std::pair<IRInstruction*, DexMethod*>>>&
           concurrent_instance_map,
@@ -67,5 +63,4 @@ class KotlinInstanceRewriter {
 
  private:
   const size_t max_no_of_instance = 1;
-  const DexString* m_instance = nullptr;
 };
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "KotlinShapes.h"
+
+#include "DexUtil.h"
+#include "TypeUtil.h"
+#include "WorkQueue.h"
+
+namespace {
+
+DexField* get_instance_field(const DexClass* cls, const DexString* instance) {
+  for (auto* field : cls->get_sfields()) {
+    if (field->get_name() == instance && field->get_type() == cls->get_type()) {
+      return field;
+    }
+  }
+  return nullptr;
+}
+
+DexClass* get_companion_outer_class(const DexClass* cls) {
+  if (!is_final(cls) || !cls->get_ifields().empty() ||
+      !cls->get_interfaces()->empty() || cls->get_clinit() ||
+      !cls->get_sfields().empty() ||
+      cls->get_super_class() != type::java_lang_Object()) {
+    return nullptr;
+  }
+  DexClass* outer_cls = kotlin_shapes::get_outer_class(cls);
+  if (outer_cls == nullptr) {
+    return nullptr;
+  }
+  bool found = false;
+  for (auto* sfield : outer_cls->get_sfields()) {
+    if (sfield->get_type() == cls->get_type()) {
+      if (found) {
+        // Expect only one sfield in outer class to hold companion object
+        // instance
+        return nullptr;
+      }
+      found = true;
+    }
+  }
+  return outer_cls;
+}
+
+} // namespace
+
+namespace kotlin_shapes {
+
+ShapeIndex::ShapeIndex(const Scope& scope) {
+  const auto* instance = DexString::make_string("INSTANCE");
+  std::vector<ClassShape> shapes(scope.size());
+  workqueue_run_for<size_t>(0, scope.size(), [&](size_t i) {
+    auto* cls = scope[i];
+    auto& shape = shapes[i];
+    shape.is_lambda = type::is_kotlin_lambda(cls);
+    shape.is_non_capturing_lambda = type::is_kotlin_non_capturing_lambda(cls);
+    shape.instance_field = get_instance_field(cls, instance);
+    shape.companion_outer_cls = get_companion_outer_class(cls);
+  });
+  for (size_t i = 0; i < scope.size(); i++) {
+    auto* cls = scope[i];
+    auto& shape = shapes[i];
+    if (shape.empty()) {
+      continue;
+    }
+    if (shape.is_lambda) {
+      m_lambdas.push_back(cls);
+    }
+    if (shape.instance_field != nullptr) {
+      m_singletons.push_back(cls);
+    }
+    if (shape.companion_outer_cls != nullptr) {
+      m_companions.push_back(cls);
+    }
+    m_shapes.emplace(cls, shape);
+  }
+}
+
+const ClassShape& ShapeIndex::get(const DexClass* cls) const {
+  static const ClassShape no_shape;
+  auto it = m_shapes.find(cls);
+  return it == m_shapes.end() ? no_shape : it->second;
+}
+
+DexClass* get_outer_class(const DexClass* cls) {
+  const auto cls_name = cls->get_name()->str();
+  auto cash_idx = cls_name.find_last_of('$');
+  if (cash_idx == std::string::npos) {
+    // this is not an inner class
+    return nullptr;
+  }
+  auto slash_idx = cls_name.find_last_of('/');
+  if (slash_idx == std::string::npos || slash_idx < cash_idx) {
+    // there's a $ in the class name
+    const std::string& outer_name = cls_name.substr(0, cash_idx) + ';';
+    DexType* outer = DexType::get_type(outer_name);
+    if (outer == nullptr) {
+      return nullptr;
+    }
+    DexClass* outer_cls = type_class(outer);
+    if (outer_cls == nullptr || outer_cls->is_external()) {
+      return nullptr;
+    }
+    return outer_cls;
+  }
+  return nullptr;
+}
+
+} // namespace kotlin_shapes
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "DexClass.h"
+
+namespace kotlin_shapes {
+
+// The Kotlin-specific shapes of a class, as far as they can be told from its
+// structure alone.
+struct ClassShape {
+  // Extends kotlin.jvm.internal.Lambda.
+  bool is_lambda{false};
+  // A lambda without instance fields, i.e. which doesn't capture anything.
+  bool is_non_capturing_lambda{false};
+  // The static INSTANCE field of the class' own type, through which Kotlin
+  // objects and non-capturing lambdas are used as singletons.
+  DexField* instance_field{nullptr};
+  // For classes shaped like a companion object, the outer class holding the
+  // instance. Such a class is final, extends java.lang.Object, has no fields,
+  // interfaces or <clinit>, and its (non-external) outer class has at most one
+  // static field of its type.
+  DexClass* companion_outer_cls{nullptr};
+
+  bool empty() const {
+    return !is_lambda && instance_field == nullptr &&
+           companion_outer_cls == nullptr;
+  }
+};
+
+/*
+ * Classifies all classes of a scope in one parallel walk, so that the Kotlin
+ * passes and statistics can query the shapes instead of each scanning the
+ * scope again. The index doesn't track changes to the classes.
+ */
+class ShapeIndex {
+ public:
+  explicit ShapeIndex(const Scope& scope);
+
+  const ClassShape& get(const DexClass* cls) const;
+
+  // The classes of each shape, in scope order.
+  const std::vector<DexClass*>& lambdas() const { return m_lambdas; }
+  const std::vector<DexClass*>& singletons() const { return m_singletons; }
+  const std::vector<DexClass*>& companions() const { return m_companions; }
+
+ private:
+  // Only classes with some shape are included.
+  std::unordered_map<const DexClass*, ClassShape> m_shapes;
+  std::vector<DexClass*> m_lambdas;
+  std::vector<DexClass*> m_singletons;
+  std::vector<DexClass*> m_companions;
+};
+
+// Check if CLS is an inner class and return the outer class. Return nullptr if
+// this is not an inner class, or if the outer class is external.
+DexClass* get_outer_class(const DexClass* cls);
+
+} // namespace kotlin_shapes
@@ -7,6 +7,9 @@
 
 #include "MethodDedup.h"
 
+#include <algorithm>
+
+#include "ConcurrentContainers.h"
 #include "DedupBlocks.h"
 #include "DexOpcode.h"
 #include "IRCode.h"
@@ -14,6 +17,7 @@
 #include "Show.h"
 #include "Trace.h"
 #include "Walkers.h"
+#include "WorkQueue.h"
 
 namespace {
 
@@ -38,36 +42,65 @@ struct CodeAsKey {
   }
 };
 
-struct CodeHasher {
-  size_t operator()(const CodeAsKey& key) const {
-    size_t result = 0;
-    for (auto& mie : cfg::InstructionIterable(
-             const_cast<cfg::ControlFlowGraph&>(key.cfg))) {
-      result ^= mie.insn->hash();
-    }
-    return result;
+// A content-based fingerprint of a method's code that is consistent with
+// CodeAsKey equality. The CFG comparison walks the blocks from the entry, so
+// the instruction hashes are combined commutatively; each one is mixed first so
+// that pairs of equal instructions don't cancel out as with a plain xor.
+size_t get_code_fingerprint(const cfg::ControlFlowGraph& cfg) {
+  uint64_t sum = 0;
+  for (const auto& mie : cfg::ConstInstructionIterable(cfg)) {
+    uint64_t h = mie.insn->hash();
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    sum += h;
   }
-};
+  size_t result = cfg.num_blocks();
+  boost::hash_combine(result, cfg.num_edges());
+  boost::hash_combine(result, sum);
+  return result;
+}
 
-using DuplicateMethods =
-    std::unordered_map<CodeAsKey, MethodOrderedSet, CodeHasher>;
+// Methods can only be identical if they agree on all of these.
+struct MethodSignature {
+  const DexProto* proto;
+  size_t code_units;
+  size_t fingerprint;
 
-std::vector<MethodOrderedSet> get_duplicate_methods_simple(
-    const MethodOrderedSet& methods, bool dedup_fill_in_stack_trace) {
-  DuplicateMethods duplicates;
-  for (DexMethod* method : methods) {
-    always_assert(method->get_code());
-    always_assert(method->get_code()->editable_cfg_built());
-    duplicates[CodeAsKey(method->get_code()->cfg(), dedup_fill_in_stack_trace)]
-        .emplace(method);
+  bool operator==(const MethodSignature& other) const {
+    return proto == other.proto && code_units == other.code_units &&
+           fingerprint == other.fingerprint;
   }
+};
 
-  std::vector<MethodOrderedSet> result;
-  for (auto& duplicate : duplicates) {
-    result.push_back(std::move(duplicate.second));
+struct MethodSignatureHasher {
+  size_t operator()(const MethodSignature& key) const {
+    size_t result = key.fingerprint;
+    boost::hash_combine(result, key.proto);
+    boost::hash_combine(result, key.code_units);
+    return result;
   }
+};
 
-  return result;
+// Split methods with the same signature into groups of identical ones. Unless
+// fingerprints collide, there is just one group.
+void get_duplicate_methods(const std::vector<DexMethod*>& methods,
+                           bool dedup_fill_in_stack_trace,
+                           std::vector<MethodOrderedSet>& result) {
+  size_t first = result.size();
+  for (DexMethod* method : methods) {
+    CodeAsKey key(method->get_code()->cfg(), dedup_fill_in_stack_trace);
+    auto it = std::find_if(
+        result.begin() + first, result.end(), [&](const auto& group) {
+          return CodeAsKey((*group.begin())->get_code()->cfg(),
+                           dedup_fill_in_stack_trace) == key;
+        });
+    if (it == result.end()) {
+      result.emplace_back().emplace(method);
+    } else {
+      it->emplace(method);
+    }
+  }
 }
 
 } // namespace
@@ -105,17 +138,33 @@ std::vector<MethodOrderedSet> group_similar_methods(
 
 std::vector<MethodOrderedSet> group_identical_methods(
     const std::vector<DexMethod*>& methods, bool dedup_fill_in_stack_trace) {
-  std::vector<MethodOrderedSet> result;
-  std::vector<MethodOrderedSet> same_protos = group_similar_methods(methods);
-
-  // Find actual duplicates.
-  for (const auto& same_proto : same_protos) {
-    std::vector<MethodOrderedSet> duplicates =
-        get_duplicate_methods_simple(same_proto, dedup_fill_in_stack_trace);
+  // Fingerprint all methods in parallel, then bucket them in one go; only
+  // methods that share a bucket need a full comparison.
+  InsertOnlyConcurrentMap<DexMethod*, MethodSignature> signatures;
+  workqueue_run<DexMethod*>(
+      [&](DexMethod* method) {
+        auto* code = method->get_code();
+        always_assert(code);
+        always_assert(code->editable_cfg_built());
+        signatures.emplace(method,
+                           MethodSignature{method->get_proto(),
+                                           code->estimate_code_units(),
+                                           get_code_fingerprint(code->cfg())});
+      },
+      methods);
 
-    result.insert(result.end(), duplicates.begin(), duplicates.end());
+  std::unordered_map<MethodSignature, std::vector<DexMethod*>,
+                     MethodSignatureHasher>
+      buckets;
+  for (auto* method : methods) {
+    buckets[signatures.at_unsafe(method)].push_back(method);
   }
 
+  std::vector<MethodOrderedSet> result;
+  result.reserve(buckets.size());
+  for (const auto& [_, bucket] : buckets) {
+    get_duplicate_methods(bucket, dedup_fill_in_stack_trace, result);
+  }
   return result;
 }
 
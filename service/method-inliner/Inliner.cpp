@@ -286,9 +286,20 @@ void MultiMethodInliner::inline_methods() {
   // inlining from there. First, we just gather data on
   // caller/non-recursive-callees pairs for each stack depth.
   {
+    // Besides the for-speed exclusions, we prune callees that can never be
+    // inlined, regardless of what their code will look like after inlining
+    // into them. Their callers then don't have to wait for them in the
+    // scheduler, and we don't compute any inlined costs for them.
     auto exclude_fn = [this](DexMethod* caller, DexMethod* callee) {
-      return for_speed() &&
-             !m_inline_for_speed->should_inline_generic(caller, callee);
+      if (for_speed() &&
+          !m_inline_for_speed->should_inline_generic(caller, callee)) {
+        return true;
+      }
+      if (is_never_inlinable(callee)) {
+        info.never_inlinable_call_edges++;
+        return true;
+      }
+      return false;
     };
     inliner::RecursionPruner recursion_pruner(callee_caller, caller_callee,
                                               std::move(exclude_fn));
@@ -1038,6 +1049,13 @@ bool MultiMethodInliner::is_blocklisted(const DexMethod* callee) {
   return false;
 }
 
+bool MultiMethodInliner::is_never_inlinable(const DexMethod* callee) {
+  if (callee->rstate.force_inline()) {
+    return false;
+  }
+  return callee->rstate.dont_inline() || is_blocklisted(callee);
+}
+
 bool MultiMethodInliner::is_estimate_over_max(uint64_t estimated_caller_size,
                                               uint64_t estimated_callee_size,
                                               uint64_t max) {
@@ -336,6 +336,12 @@ class MultiMethodInliner {
 
   bool caller_is_blocklisted(const DexMethod* caller);
 
+  /**
+   * Return true if the callee will be rejected by is_inlinable for any caller
+   * and call-site, independently of its code.
+   */
+  bool is_never_inlinable(const DexMethod* callee);
+
   /**
    * Return true if the callee contains external catch exception types
    * which are not public.
@@ -684,6 +690,7 @@ class MultiMethodInliner {
     // statistics that must be incremented sequentially
     size_t recursive{0};
     size_t max_call_stack_depth{0};
+    size_t never_inlinable_call_edges{0};
     size_t waited_seconds{0};
     int critical_path_length{0};
 
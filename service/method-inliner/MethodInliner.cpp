@@ -898,6 +898,8 @@ void run_inliner(
   TRACE(INLINE, 3, "max_call_stack_depth %zu",
         inliner.get_info().max_call_stack_depth);
   TRACE(INLINE, 3, "waited seconds %zu", inliner.get_info().waited_seconds);
+  TRACE(INLINE, 3, "never inlinable call edges %zu",
+        inliner.get_info().never_inlinable_call_edges);
   TRACE(INLINE, 3, "blocklisted meths %zu",
         (size_t)inliner.get_info().blocklisted);
   TRACE(INLINE, 3, "virtualizing methods %zu",
@@ -934,6 +936,8 @@ void run_inliner(
   mgr.incr_metric("recursive", inliner.get_info().recursive);
   mgr.incr_metric("max_call_stack_depth",
                   inliner.get_info().max_call_stack_depth);
+  mgr.incr_metric("never_inlinable_call_edges",
+                  inliner.get_info().never_inlinable_call_edges);
   mgr.incr_metric("cross_store", inliner.get_info().cross_store);
   mgr.incr_metric("api_level_mismatch", inliner.get_info().api_level_mismatch);
   mgr.incr_metric("problematic_refs", inliner.get_info().problematic_refs);
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "AllocationSinking.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "IRInstruction.h"
+#include "Liveness.h"
+#include "MethodUtil.h"
+#include "Resolver.h"
+#include "Show.h"
+#include "Trace.h"
+
+namespace ptrs = local_pointers;
+
+namespace {
+
+bool has_throw_edges(const cfg::ControlFlowGraph& cfg,
+                     const cfg::Block* block) {
+  return cfg.get_succ_edge_of_type(block, cfg::EDGE_THROW) != nullptr;
+}
+
+bool reads_reg(const IRInstruction* insn, reg_t reg) {
+  for (size_t i = 0; i < insn->srcs_size(); ++i) {
+    auto src = insn->src(i);
+    if (src == reg || (insn->src_is_wide(i) && src + 1 == reg)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool writes_reg(const IRInstruction* insn, reg_t reg) {
+  if (!insn->has_dest()) {
+    return false;
+  }
+  auto dest = insn->dest();
+  return dest == reg || (insn->dest_is_wide() && dest + 1 == reg);
+}
+
+// Whether `insn` may write memory or run a static initializer, so that moving
+// a constructor past it may change what the constructor reads.
+bool may_interfere_with_constructor(const IRInstruction* insn) {
+  auto op = insn->opcode();
+  return opcode::is_an_invoke(op) || opcode::is_an_iput(op) ||
+         opcode::is_an_aput(op) || opcode::is_an_sfield_op(op) ||
+         opcode::is_a_new(op) || opcode::is_a_monitor(op) ||
+         op == OPCODE_FILL_ARRAY_DATA || op == IOPCODE_INIT_CLASS;
+}
+
+// Whether `insn` is a constructor invocation on `reg` that only modifies the
+// object it initializes.
+bool is_side_effect_free_ctor(
+    const IRInstruction* insn,
+    reg_t reg,
+    const side_effects::InvokeToSummaryMap& invoke_to_summary_map) {
+  if (insn->opcode() != OPCODE_INVOKE_DIRECT ||
+      !method::is_init(insn->get_method()) || insn->src(0) != reg) {
+    return false;
+  }
+  for (size_t i = 1; i < insn->srcs_size(); ++i) {
+    if (insn->src(i) == reg) {
+      return false;
+    }
+  }
+  auto it = invoke_to_summary_map.find(insn);
+  if (it == invoke_to_summary_map.end()) {
+    return false;
+  }
+  const auto& summary = it->second;
+  return summary.effects == side_effects::EFF_NONE &&
+         std::all_of(summary.modified_params.begin(),
+                     summary.modified_params.end(),
+                     [](param_idx_t idx) { return idx == 0; });
+}
+
+struct Sinking {
+  cfg::Block* target;
+  cfg::InstructionIterator new_instance;
+  cfg::InstructionIterator ctor;
+};
+
+void find_sinkings(
+    const init_classes::InitClassesWithSideEffects&
+        init_classes_with_side_effects,
+    const ptrs::FixpointIterator& ptrs_fp_iter,
+    const LivenessFixpointIterator& liveness_fp_iter,
+    const side_effects::InvokeToSummaryMap& invoke_to_summary_map,
+    cfg::ControlFlowGraph& cfg,
+    cfg::Block* block,
+    std::vector<Sinking>* sinkings) {
+  if (has_throw_edges(cfg, block)) {
+    return;
+  }
+  std::vector<cfg::Block*> succs;
+  for (auto* edge : block->succs()) {
+    if (std::find(succs.begin(), succs.end(), edge->target()) == succs.end()) {
+      succs.push_back(edge->target());
+    }
+  }
+  if (succs.size() < 2) {
+    return;
+  }
+  const auto& exit_env = ptrs_fp_iter.get_exit_state_at(block);
+  if (exit_env.is_bottom()) {
+    return;
+  }
+
+  std::vector<MethodItemEntry*> mies;
+  for (auto& mie : ir_list::InstructionIterable(block)) {
+    mies.push_back(&mie);
+  }
+  for (size_t i = 0; i + 1 < mies.size(); ++i) {
+    auto* insn = mies[i]->insn;
+    if (insn->opcode() != OPCODE_NEW_INSTANCE ||
+        init_classes_with_side_effects.refine(insn->get_type()) != nullptr ||
+        exit_env.may_have_escaped(insn)) {
+      continue;
+    }
+    always_assert(opcode::is_a_move_result_pseudo(mies[i + 1]->insn->opcode()));
+    auto reg = mies[i + 1]->insn->dest();
+
+    // The first instruction touching the new object must be its constructor.
+    size_t j = i + 2;
+    while (j < mies.size() && !reads_reg(mies[j]->insn, reg) &&
+           !writes_reg(mies[j]->insn, reg)) {
+      ++j;
+    }
+    if (j == mies.size() ||
+        !is_side_effect_free_ctor(mies[j]->insn, reg, invoke_to_summary_map)) {
+      continue;
+    }
+
+    // Everything after the constructor will run before it once it is sunk, so
+    // it must neither touch the object nor what the constructor reads.
+    auto* ctor = mies[j]->insn;
+    std::vector<reg_t> arg_regs;
+    for (size_t k = 1; k < ctor->srcs_size(); ++k) {
+      arg_regs.push_back(ctor->src(k));
+      if (ctor->src_is_wide(k)) {
+        arg_regs.push_back(ctor->src(k) + 1);
+      }
+    }
+    bool movable = true;
+    for (size_t k = j + 1; k < mies.size() && movable; ++k) {
+      auto* other = mies[k]->insn;
+      movable = !reads_reg(other, reg) && !writes_reg(other, reg) &&
+                !may_interfere_with_constructor(other) &&
+                std::none_of(arg_regs.begin(), arg_regs.end(),
+                             [&](reg_t r) { return writes_reg(other, r); });
+    }
+    if (!movable) {
+      continue;
+    }
+
+    cfg::Block* target = nullptr;
+    size_t live_succs = 0;
+    for (auto* succ : succs) {
+      if (liveness_fp_iter.get_live_in_vars_at(succ).contains(reg)) {
+        target = succ;
+        ++live_succs;
+      }
+    }
+    // If the object is live in all successors, there is nothing to gain; if
+    // it is live in none, it is left to ObjectSensitiveDce.
+    if (live_succs != 1 || target == block || target->preds().size() != 1 ||
+        has_throw_edges(cfg, target)) {
+      continue;
+    }
+    sinkings->push_back(Sinking{target,
+                                block->to_cfg_instruction_iterator(*mies[i]),
+                                block->to_cfg_instruction_iterator(*mies[j])});
+  }
+}
+
+// Stores to a field of a non-escaping object are tracked per register holding
+// the object, as registers are the only way to tell that two stores definitely
+// write to the same object.
+struct LastStores {
+  const IRInstruction* pointer{nullptr};
+  std::unordered_map<const DexField*, cfg::InstructionIterator> by_field;
+};
+
+void find_dead_field_stores(const ptrs::FixpointIterator& ptrs_fp_iter,
+                            cfg::ControlFlowGraph& cfg,
+                            cfg::Block* block,
+                            std::vector<cfg::InstructionIterator>* dead) {
+  if (has_throw_edges(cfg, block)) {
+    return;
+  }
+  auto env = ptrs_fp_iter.get_entry_state_at(block);
+  if (env.is_bottom()) {
+    return;
+  }
+
+  std::map<reg_t, LastStores> last_stores;
+  // Any use of an object other than a store to it may read its fields.
+  auto forget_pointers_of = [&](reg_t reg) {
+    const auto& pointers = env.get_pointers(reg);
+    if (!pointers.is_value()) {
+      return;
+    }
+    for (auto it = last_stores.begin(); it != last_stores.end();) {
+      if (pointers.contains(it->second.pointer)) {
+        it = last_stores.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  };
+
+  for (auto& mie : ir_list::InstructionIterable(block)) {
+    auto* insn = mie.insn;
+    const IRInstruction* object = nullptr;
+    DexField* field = nullptr;
+    if (opcode::is_an_iput(insn->opcode())) {
+      field = resolve_field(insn->get_field(), FieldSearch::Instance);
+      const auto& pointers = env.get_pointers(insn->src(1));
+      if (field != nullptr && pointers.is_value() &&
+          pointers.elements().size() == 1) {
+        auto* pointer = *pointers.elements().begin();
+        if (pointer->opcode() == OPCODE_NEW_INSTANCE &&
+            !env.may_have_escaped(pointer)) {
+          object = pointer;
+        }
+      }
+    }
+
+    if (object != nullptr) {
+      forget_pointers_of(insn->src(0));
+      auto& stores = last_stores[insn->src(1)];
+      if (stores.pointer != object) {
+        stores = LastStores{object, {}};
+      }
+      auto it = stores.by_field.find(field);
+      if (it != stores.by_field.end()) {
+        dead->push_back(it->second);
+      }
+      stores.by_field.insert_or_assign(field,
+                                       block->to_cfg_instruction_iterator(mie));
+    } else {
+      for (size_t i = 0; i < insn->srcs_size(); ++i) {
+        forget_pointers_of(insn->src(i));
+      }
+    }
+
+    for (auto it = last_stores.begin(); it != last_stores.end();) {
+      if (writes_reg(insn, it->first)) {
+        it = last_stores.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    ptrs_fp_iter.analyze_instruction(insn, &env);
+  }
+}
+
+} // namespace
+
+namespace allocation_sinking {
+
+Stats optimize(const init_classes::InitClassesWithSideEffects&
+                   init_classes_with_side_effects,
+               const local_pointers::FixpointIterator& ptrs_fp_iter,
+               const side_effects::InvokeToSummaryMap& invoke_to_summary_map,
+               const Config& config,
+               cfg::ControlFlowGraph& cfg) {
+  Stats stats;
+  std::vector<cfg::InstructionIterator> dead_stores;
+  if (config.remove_dead_field_stores) {
+    for (auto* block : cfg.blocks()) {
+      find_dead_field_stores(ptrs_fp_iter, cfg, block, &dead_stores);
+    }
+  }
+  std::vector<Sinking> sinkings;
+  if (config.sink_allocations) {
+    LivenessFixpointIterator liveness_fp_iter(cfg);
+    liveness_fp_iter.run(LivenessDomain());
+    for (auto* block : cfg.blocks()) {
+      find_sinkings(init_classes_with_side_effects, ptrs_fp_iter,
+                    liveness_fp_iter, invoke_to_summary_map, cfg, block,
+                    &sinkings);
+    }
+  }
+
+  // Allocations sunk into the same block keep their relative order.
+  std::map<cfg::BlockId, std::vector<IRInstruction*>> sunk_insns;
+  for (auto& sinking : sinkings) {
+    auto& insns = sunk_insns[sinking.target->id()];
+    auto* new_instance = sinking.new_instance->insn;
+    auto move_result_it = sinking.new_instance;
+    auto* move_result = (++move_result_it)->insn;
+    insns.push_back(new IRInstruction(*new_instance));
+    insns.push_back(new IRInstruction(*move_result));
+    insns.push_back(new IRInstruction(*sinking.ctor->insn));
+    TRACE(OSDCE, 3, "SINK: %s into B%zu", SHOW(new_instance),
+          sinking.target->id());
+  }
+  for (auto& [id, insns] : sunk_insns) {
+    cfg.get_block(id)->push_front(insns);
+  }
+  for (auto& sinking : sinkings) {
+    cfg.remove_insn(sinking.ctor);
+    cfg.remove_insn(sinking.new_instance);
+  }
+  for (auto& it : dead_stores) {
+    TRACE(OSDCE, 3, "DEAD STORE: %s", SHOW(it->insn));
+    cfg.remove_insn(it);
+  }
+  stats.sunk_allocations = sinkings.size();
+  stats.removed_field_stores = dead_stores.size();
+  return stats;
+}
+
+} // namespace allocation_sinking
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include "ControlFlow.h"
+#include "InitClassesWithSideEffects.h"
+#include "LocalPointersAnalysis.h"
+#include "SideEffectSummary.h"
+
+/*
+ * ObjectSensitiveDce removes objects that are never used. This handles objects
+ * that are used, but not on every path, or not in every field they are given:
+ *
+ * - Allocations whose constructors have no side effects beyond initializing
+ *   the new object are sunk from a block ending in a branch into the single
+ *   successor in which the object is live. The other successors then no longer
+ *   pay for the allocation:
+ *
+ *     new-instance LFoo;
+ *     move-result-pseudo-object v0
+ *     invoke-direct {v0} LFoo;.<init>:()V
+ *     if-eqz v1 :use
+ *     return-void
+ *     (:use)
+ *     invoke-static {v0} LBar;.use:(LFoo;)V
+ *
+ *   becomes
+ *
+ *     if-eqz v1 :use
+ *     return-void
+ *     (:use)
+ *     new-instance LFoo;
+ *     move-result-pseudo-object v0
+ *     invoke-direct {v0} LFoo;.<init>:()V
+ *     invoke-static {v0} LBar;.use:(LFoo;)V
+ *
+ * - A store to a field of a non-escaping object is removed when the same field
+ *   of the same object gets overwritten later in the block, and nothing in
+ *   between may read the object.
+ *
+ * Both transformations only consider blocks without throw edges, so that no
+ * exception handler in the method can observe the difference.
+ */
+namespace allocation_sinking {
+
+struct Config {
+  bool sink_allocations{true};
+  bool remove_dead_field_stores{true};
+};
+
+struct Stats {
+  size_t sunk_allocations{0};
+  size_t removed_field_stores{0};
+
+  Stats& operator+=(const Stats& that) {
+    sunk_allocations += that.sunk_allocations;
+    removed_field_stores += that.removed_field_stores;
+    return *this;
+  }
+};
+
+/*
+ * The pointer analysis and the effect summaries of the invokes must describe
+ * the current state of `cfg`, whose exit block must have been computed.
+ */
+Stats optimize(const init_classes::InitClassesWithSideEffects&
+                   init_classes_with_side_effects,
+               const local_pointers::FixpointIterator& ptrs_fp_iter,
+               const side_effects::InvokeToSummaryMap& invoke_to_summary_map,
+               const Config& config,
+               cfg::ControlFlowGraph& cfg);
+
+} // namespace allocation_sinking
@@ -163,6 +163,35 @@ class CallGraphStrategy final : public call_graph::MultipleCalleeStrategy {
   call_graph::RootAndDynamic m_root_and_dynamic;
 };
 
+// The escape summaries of the invokes in `method`, in the way
+// local_pointers::analyze_scope derives them.
+ptrs::InvokeToSummaryMap build_escape_summary_map(
+    const ptrs::SummaryMap& summary_map,
+    const call_graph::Graph& call_graph,
+    const DexMethod* method) {
+  ptrs::InvokeToSummaryMap invoke_to_summary_map;
+  if (!call_graph.has_node(method)) {
+    return invoke_to_summary_map;
+  }
+  for (const auto& edge : call_graph.node(method)->callees()) {
+    if (edge->callee() == call_graph.exit()) {
+      continue;
+    }
+    auto invoke_insn = edge->invoke_insn();
+    auto& callee_summary = invoke_to_summary_map[invoke_insn];
+    auto* callee = edge->callee()->method();
+    auto it = summary_map.find(callee);
+    if (it != summary_map.end()) {
+      callee_summary.join_with(it->second);
+    } else if (callee == nullptr &&
+               ptrs::is_array_clone(invoke_insn->get_method())) {
+      callee_summary.join_with(
+          ptrs::EscapeSummary(ptrs::ParamSet{ptrs::FRESH_RETURN}, {}));
+    }
+  }
+  return invoke_to_summary_map;
+}
+
 } // namespace
 
 void ObjectSensitiveDce::dce() {
@@ -187,6 +216,8 @@ void ObjectSensitiveDce::dce() {
   init_classes::Stats init_class_stats;
   std::mutex invokes_with_summaries_mutex;
   std::unordered_map<uint16_t, size_t> invokes_with_summaries{0};
+  std::mutex allocation_sinking_stats_mutex;
+  allocation_sinking::Stats allocation_sinking_stats;
 
   walk::parallel::code(m_scope, [&](DexMethod* method, IRCode& code) {
     if (method->get_code() == nullptr || method->rstate.no_optimizations()) {
@@ -231,6 +262,21 @@ void ObjectSensitiveDce::dce() {
     mutator.flush();
 
     cfg.remove_unreachable_blocks();
+    if (m_allocation_sinking_config.sink_allocations ||
+        m_allocation_sinking_config.remove_dead_field_stores) {
+      // The analyses above describe the code before the removals.
+      cfg.calculate_exit_block();
+      ptrs::FixpointIterator ptrs_fp_iter(
+          cfg, build_escape_summary_map(*m_escape_summaries, call_graph,
+                                        method));
+      ptrs_fp_iter.run(ptrs::Environment());
+      auto local_allocation_sinking_stats = allocation_sinking::optimize(
+          *m_init_classes_with_side_effects, ptrs_fp_iter,
+          build_summary_map(*m_effect_summaries, call_graph, method),
+          m_allocation_sinking_config, cfg);
+      std::lock_guard lock_guard(allocation_sinking_stats_mutex);
+      allocation_sinking_stats += local_allocation_sinking_stats;
+    }
     TRACE(OSDCE, 5, "After:\n%s", SHOW(cfg));
     if (!dead_instructions.empty()) {
       removed += dead_instructions.size();
@@ -260,6 +306,10 @@ void ObjectSensitiveDce::dce() {
     m_stats.modified_params += summary.modified_params.size();
   }
   m_stats.invokes_with_summaries = invokes_with_summaries;
+  m_stats.allocation_sinking_stats = allocation_sinking_stats;
   TRACE(OSDCE, 1, "%zu methods with summaries, removed %zu instructions",
         m_stats.methods_with_summaries, m_stats.removed_instructions);
+  TRACE(OSDCE, 1, "sunk %zu allocations, removed %zu dead field stores",
+        allocation_sinking_stats.sunk_allocations,
+        allocation_sinking_stats.removed_field_stores);
 }
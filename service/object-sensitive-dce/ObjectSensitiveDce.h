@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "AllocationSinking.h"
 #include "DexUtil.h"
 #include "HierarchyUtil.h"
 #include "InitClassPruner.h"
@@ -32,6 +33,7 @@ class ObjectSensitiveDce {
     size_t init_class_instructions_refined{0};
     size_t methods_with_summaries{0};
     size_t modified_params{0};
+    allocation_sinking::Stats allocation_sinking_stats;
   };
 
   /*
@@ -51,6 +53,10 @@ class ObjectSensitiveDce {
    * In contrast, LocalDce can only identify unused writes to registers -- it
    * knows nothing about objects. The trade-off is that this is takes much
    * longer to run.
+   *
+   * Afterwards, allocations that are only used on some paths are sunk into the
+   * branch that uses them, and overwritten stores to fields of non-escaping
+   * objects are removed; see AllocationSinking.h.
    */
 
   explicit ObjectSensitiveDce(
@@ -61,14 +67,17 @@ class ObjectSensitiveDce {
       const method_override_graph::Graph& method_override_graph,
       const uint32_t big_override_threshold,
       local_pointers::SummaryMap* escape_summaries,
-      side_effects::SummaryMap* effect_summaries)
+      side_effects::SummaryMap* effect_summaries,
+      const allocation_sinking::Config& allocation_sinking_config =
+          allocation_sinking::Config())
       : m_scope(scope),
         m_init_classes_with_side_effects(init_classes_with_side_effects),
         m_pure_methods(pure_methods),
         m_method_override_graph(method_override_graph),
         m_big_override_threshold(big_override_threshold),
         m_escape_summaries(escape_summaries),
-        m_effect_summaries(effect_summaries) {}
+        m_effect_summaries(effect_summaries),
+        m_allocation_sinking_config(allocation_sinking_config) {}
 
   const Stats& get_stats() const { return m_stats; }
 
@@ -84,5 +93,6 @@ class ObjectSensitiveDce {
   // The following are mutated internally.
   local_pointers::SummaryMap* m_escape_summaries;
   side_effects::SummaryMap* m_effect_summaries;
+  allocation_sinking::Config m_allocation_sinking_config;
   Stats m_stats;
 };
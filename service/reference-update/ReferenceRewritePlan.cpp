@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ReferenceRewritePlan.h"
+
+#include <atomic>
+#include <optional>
+
+#include "ConcurrentContainers.h"
+#include "ControlFlow.h"
+#include "DexAnnotation.h"
+#include "IRCode.h"
+#include "Show.h"
+#include "Trace.h"
+#include "TypeReference.h"
+#include "Walkers.h"
+
+namespace {
+
+// LOld; => LNew; [LOld; => [LNew; ... Returns nullptr for other types.
+DexType* convert_type(const std::unordered_map<DexType*, DexType*>& types,
+                      DexType* type) {
+  auto level = type::get_array_level(type);
+  auto* elem_type = level ? type::get_array_element_type(type) : type;
+  auto it = types.find(elem_type);
+  if (it == types.end()) {
+    return nullptr;
+  }
+  return level ? type::make_array_type(it->second, level) : it->second;
+}
+
+template <typename Ref>
+Ref* convert_ref(const std::unordered_map<Ref*, Ref*>& refs, Ref* ref) {
+  auto it = refs.find(ref);
+  return it == refs.end() ? nullptr : it->second;
+}
+
+class Rewriter {
+ public:
+  Rewriter(const std::unordered_map<DexType*, DexType*>& types,
+           const std::unordered_map<DexMethodRef*, DexMethodRef*>& methods,
+           const std::unordered_map<DexFieldRef*, DexFieldRef*>& fields,
+           bool old_types_must_be_unreferenced)
+      : m_types(types),
+        m_methods(methods),
+        m_fields(fields),
+        m_old_types_must_be_unreferenced(old_types_must_be_unreferenced) {}
+
+  // Returns the number of rewritten references.
+  size_t rewrite_insn(const DexMethod* method, IRInstruction* insn) const {
+    size_t rewritten = 0;
+    if (insn->has_type()) {
+      auto* new_type = convert_type(m_types, insn->get_type());
+      if (new_type != nullptr) {
+        always_assert_log(!m_old_types_must_be_unreferenced ||
+                              insn->opcode() != OPCODE_NEW_INSTANCE,
+                          "Type reference still exists %s in %s", SHOW(insn),
+                          SHOW(method));
+        insn->set_type(new_type);
+        rewritten++;
+      }
+    } else if (insn->has_field()) {
+      auto* new_field = convert_ref(m_fields, insn->get_field());
+      if (new_field != nullptr) {
+        insn->set_field(new_field);
+        rewritten++;
+      }
+      always_assert_log(!m_old_types_must_be_unreferenced ||
+                            !m_types.count(insn->get_field()->get_class()),
+                        "Field reference still exists %s in %s", SHOW(insn),
+                        SHOW(method));
+    } else if (insn->has_method()) {
+      auto* new_method = convert_ref(m_methods, insn->get_method());
+      if (new_method != nullptr) {
+        insn->set_method(new_method);
+        rewritten++;
+      }
+      always_assert_log(!m_old_types_must_be_unreferenced ||
+                            !m_types.count(insn->get_method()->get_class()),
+                        "Method reference still exists %s in %s", SHOW(insn),
+                        SHOW(method));
+    }
+    return rewritten;
+  }
+
+  // Returns the number of rewritten references.
+  size_t rewrite_encoded_value(DexEncodedValue* value) const {
+    switch (value->evtype()) {
+    case DEVT_TYPE: {
+      auto* type_value = static_cast<DexEncodedValueType*>(value);
+      auto* new_type = convert_type(m_types, type_value->type());
+      if (new_type == nullptr) {
+        return 0;
+      }
+      type_value->set_type(new_type);
+      return 1;
+    }
+    case DEVT_FIELD:
+    case DEVT_ENUM: {
+      auto* field_value = static_cast<DexEncodedValueField*>(value);
+      auto* new_field = convert_ref(m_fields, field_value->field());
+      if (new_field == nullptr) {
+        return 0;
+      }
+      field_value->set_field(new_field);
+      return 1;
+    }
+    case DEVT_METHOD: {
+      auto* method_value = static_cast<DexEncodedValueMethod*>(value);
+      auto* new_method = convert_ref(m_methods, method_value->method());
+      if (new_method == nullptr) {
+        return 0;
+      }
+      method_value->set_method(new_method);
+      return 1;
+    }
+    case DEVT_ARRAY: {
+      size_t rewritten = 0;
+      auto* array_value = static_cast<DexEncodedValueArray*>(value);
+      for (auto& element : *array_value->evalues()) {
+        rewritten += rewrite_encoded_value(element.get());
+      }
+      return rewritten;
+    }
+    case DEVT_ANNOTATION: {
+      size_t rewritten = 0;
+      auto* annotation_value = static_cast<DexEncodedValueAnnotation*>(value);
+      auto* new_type = convert_type(m_types, annotation_value->type());
+      if (new_type != nullptr) {
+        annotation_value->set_type(new_type);
+        rewritten++;
+      }
+      for (auto& element : annotation_value->annotations()) {
+        rewritten += rewrite_encoded_value(element.encoded_value.get());
+      }
+      return rewritten;
+    }
+    default:
+      return 0;
+    }
+  }
+
+  // Returns the number of rewritten references.
+  size_t rewrite_annotation_set(DexAnnotationSet* anno_set) const {
+    if (anno_set == nullptr) {
+      return 0;
+    }
+    size_t rewritten = 0;
+    for (auto& anno : anno_set->get_annotations()) {
+      auto* new_type = convert_type(m_types, anno->type());
+      if (new_type != nullptr) {
+        anno->set_type(new_type);
+        rewritten++;
+      }
+      for (auto& element : anno->anno_elems()) {
+        rewritten += rewrite_encoded_value(element.encoded_value.get());
+      }
+    }
+    return rewritten;
+  }
+
+ private:
+  const std::unordered_map<DexType*, DexType*>& m_types;
+  const std::unordered_map<DexMethodRef*, DexMethodRef*>& m_methods;
+  const std::unordered_map<DexFieldRef*, DexFieldRef*>& m_fields;
+  bool m_old_types_must_be_unreferenced;
+};
+
+} // namespace
+
+namespace reference_update {
+
+void RewritePlan::add_type(DexType* old_type, DexType* new_type) {
+  auto [it, emplaced] = m_types.emplace(old_type, new_type);
+  always_assert_log(emplaced || it->second == new_type,
+                    "Conflicting substitutions for %s", SHOW(old_type));
+}
+
+void RewritePlan::add_method(DexMethodRef* old_method,
+                             DexMethodRef* new_method) {
+  auto [it, emplaced] = m_methods.emplace(old_method, new_method);
+  always_assert_log(emplaced || it->second == new_method,
+                    "Conflicting substitutions for %s", SHOW(old_method));
+}
+
+void RewritePlan::add_field(DexFieldRef* old_field, DexFieldRef* new_field) {
+  auto [it, emplaced] = m_fields.emplace(old_field, new_field);
+  always_assert_log(emplaced || it->second == new_field,
+                    "Conflicting substitutions for %s", SHOW(old_field));
+}
+
+RewriteStats RewritePlan::apply(const Scope& scope,
+                                const RewriteOptions& options) const {
+  RewriteStats stats;
+  if (empty()) {
+    return stats;
+  }
+  Rewriter rewriter(m_types, m_methods, m_fields,
+                    options.old_types_must_be_unreferenced);
+  std::optional<type_reference::TypeRefUpdater> type_ref_updater;
+  if (!m_types.empty()) {
+    type_ref_updater.emplace(m_types);
+  }
+
+  std::atomic<size_t> code_refs{0};
+  std::atomic<size_t> annotation_refs{0};
+  // References in code whose protos or field types may need an update, once
+  // all definitions have been updated.
+  ConcurrentSet<DexMethodRef*> method_refs;
+  ConcurrentSet<DexFieldRef*> field_refs;
+  walk::parallel::classes(scope, [&](DexClass* cls) {
+    size_t local_code_refs = 0;
+    size_t local_annotation_refs = 0;
+    bool skip_code = options.skip_code && options.skip_code(cls);
+    auto rewrite_code = [&](DexMethod* method, IRCode& code) {
+      auto rewrite = [&](IRInstruction* insn) {
+        if (!skip_code) {
+          local_code_refs += rewriter.rewrite_insn(method, insn);
+        }
+        if (!type_ref_updater) {
+          return;
+        }
+        if (insn->has_field()) {
+          field_refs.insert(insn->get_field());
+        } else if (insn->has_method()) {
+          method_refs.insert(insn->get_method());
+        }
+      };
+      if (code.editable_cfg_built()) {
+        for (auto& mie : InstructionIterable(code.cfg())) {
+          rewrite(mie.insn);
+        }
+      } else {
+        for (auto& mie : InstructionIterable(code)) {
+          rewrite(mie.insn);
+        }
+      }
+    };
+
+    local_annotation_refs +=
+        rewriter.rewrite_annotation_set(cls->get_anno_set());
+    for (auto* field : cls->get_all_fields()) {
+      local_annotation_refs +=
+          rewriter.rewrite_annotation_set(field->get_anno_set());
+      if (field->get_static_value() != nullptr) {
+        local_annotation_refs +=
+            rewriter.rewrite_encoded_value(field->get_static_value());
+      }
+      if (type_ref_updater) {
+        type_ref_updater->update_field_def(field);
+      }
+    }
+    for (auto* method : cls->get_all_methods()) {
+      local_annotation_refs +=
+          rewriter.rewrite_annotation_set(method->get_anno_set());
+      if (method->get_param_anno() != nullptr) {
+        for (auto& [_, anno_set] : *method->get_param_anno()) {
+          local_annotation_refs +=
+              rewriter.rewrite_annotation_set(anno_set.get());
+        }
+      }
+      if (method->get_code() != nullptr &&
+          (!skip_code || type_ref_updater)) {
+        rewrite_code(method, *method->get_code());
+      }
+      if (type_ref_updater) {
+        type_ref_updater->update_method_def(method);
+      }
+    }
+    code_refs += local_code_refs;
+    annotation_refs += local_annotation_refs;
+  });
+
+  if (type_ref_updater) {
+    type_ref_updater->update_refs(scope, method_refs, field_refs);
+  }
+  stats.code_refs = code_refs;
+  stats.annotation_refs = annotation_refs;
+  TRACE(REFU, 2, "[refu] Rewrote %zu code refs and %zu annotation refs",
+        stats.code_refs, stats.annotation_refs);
+  return stats;
+}
+
+} // namespace reference_update
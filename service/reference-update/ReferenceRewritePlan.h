@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+
+#include "DexClass.h"
+
+namespace reference_update {
+
+struct RewriteOptions {
+  // Code of classes for which this returns true is left alone, e.g. because
+  // they are about to be removed.
+  std::function<bool(const DexClass*)> skip_code;
+  // Whether it is an error for rewritten code to still refer to a member of
+  // a substituted type, or to instantiate one, e.g. because the substituted
+  // types are about to be removed.
+  bool old_types_must_be_unreferenced{false};
+};
+
+struct RewriteStats {
+  size_t code_refs{0};
+  size_t annotation_refs{0};
+};
+
+/**
+ * Accumulates type, method and field substitutions, so that they can be
+ * applied to a scope at once, instead of walking the scope once per kind of
+ * reference and per batch of updates.
+ *
+ * Applying the plan rewrites, in a single parallel walk over the classes:
+ * - type, field and method references in code;
+ * - type, field, enum and method values in annotations and static field
+ *   values;
+ * - the protos and field types of all definitions in the scope, and of all
+ *   references in code, that refer to a substituted type. This has the same
+ *   semantics as type_reference::TypeRefUpdater, i.e. updated members get
+ *   mangled names.
+ *
+ * Types are substituted inside array types as well. Method and field
+ * substitutions are keyed by the reference objects, which keep their identity
+ * when their specs get updated.
+ */
+class RewritePlan {
+ public:
+  /**
+   * As for TypeRefUpdater, the old types should all have definitions.
+   */
+  void add_type(DexType* old_type, DexType* new_type);
+  void add_method(DexMethodRef* old_method, DexMethodRef* new_method);
+  void add_field(DexFieldRef* old_field, DexFieldRef* new_field);
+
+  bool empty() const {
+    return m_types.empty() && m_methods.empty() && m_fields.empty();
+  }
+
+  RewriteStats apply(const Scope& scope,
+                     const RewriteOptions& options = RewriteOptions()) const;
+
+ private:
+  std::unordered_map<DexType*, DexType*> m_types;
+  std::unordered_map<DexMethodRef*, DexMethodRef*> m_methods;
+  std::unordered_map<DexFieldRef*, DexFieldRef*> m_fields;
+};
+
+} // namespace reference_update
@@ -205,18 +205,10 @@ namespace type_reference {
 void TypeRefUpdater::update_methods_fields(const Scope& scope) {
   // Change specs of all the other methods and fields if their specs contain
   // any candidate types.
-  walk::parallel::methods(scope, [this](DexMethod* method) {
-    if (mangling(method)) {
-      always_assert_log(
-          can_rename(method), "Method %s can not be renamed\n", SHOW(method));
-    }
-  });
-  walk::parallel::fields(scope, [this](DexField* field) {
-    if (mangling(field)) {
-      always_assert_log(
-          can_rename(field), "Field %s can not be renamed\n", SHOW(field));
-    }
-  });
+  walk::parallel::methods(
+      scope, [this](DexMethod* method) { update_method_def(method); });
+  walk::parallel::fields(scope,
+                         [this](DexField* field) { update_field_def(field); });
   // Update all the method refs and field refs.
   ConcurrentSet<DexMethodRef*> methods;
   ConcurrentSet<DexFieldRef*> fields;
@@ -241,6 +233,26 @@ void TypeRefUpdater::update_methods_fields(const Scope& scope) {
       }
     }
   });
+  update_refs(scope, methods, fields);
+}
+
+void TypeRefUpdater::update_method_def(DexMethod* method) {
+  if (mangling(method)) {
+    always_assert_log(
+        can_rename(method), "Method %s can not be renamed\n", SHOW(method));
+  }
+}
+
+void TypeRefUpdater::update_field_def(DexField* field) {
+  if (mangling(field)) {
+    always_assert_log(
+        can_rename(field), "Field %s can not be renamed\n", SHOW(field));
+  }
+}
+
+void TypeRefUpdater::update_refs(const Scope& scope,
+                                 const ConcurrentSet<DexMethodRef*>& methods,
+                                 const ConcurrentSet<DexFieldRef*>& fields) {
   workqueue_run<DexFieldRef*>([this](DexFieldRef* field) { mangling(field); },
                               fields);
   workqueue_run<DexMethodRef*>(
@@ -45,6 +45,18 @@ class TypeRefUpdater final {
 
   void update_methods_fields(const Scope& scope);
 
+  /**
+   * The steps of update_methods_fields, for callers that already walk the
+   * scope: the definitions of all methods and fields in the scope are updated
+   * first, possibly in parallel, followed by all method and field references
+   * found in code.
+   */
+  void update_method_def(DexMethod* method);
+  void update_field_def(DexField* field);
+  void update_refs(const Scope& scope,
+                   const ConcurrentSet<DexMethodRef*>& methods,
+                   const ConcurrentSet<DexFieldRef*>& fields);
+
  private:
   /**
    * Try to convert "type" to a new type. Return nullptr if it's not found in
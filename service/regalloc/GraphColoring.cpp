@@ -858,13 +858,17 @@ Allocator::find_param_splits(const std::unordered_set<reg_t>& orig_params,
  */
 void Allocator::split_params(const interference::Graph& ig,
                              const std::unordered_set<reg_t>& param_spills,
-                             cfg::ControlFlowGraph& cfg) {
+                             cfg::ControlFlowGraph& cfg,
+                             std::vector<cfg::Block*>* changed_blocks) {
   auto load_locations = find_param_splits(param_spills, cfg);
   if (load_locations.empty()) {
     return;
   }
 
   // Remap the operands of the load-param opcodes
+  if (changed_blocks != nullptr) {
+    changed_blocks->push_back(cfg.get_first_block_with_insns());
+  }
   auto params = cfg.get_param_instructions();
   auto param_insns = InstructionIterable(params);
   std::unordered_map<reg_t, reg_t> param_to_temp;
@@ -881,6 +885,9 @@ void Allocator::split_params(const interference::Graph& ig,
   for (const auto& param_pair : load_locations) {
     auto dest = param_pair.first;
     auto first_use_it = param_pair.second;
+    if (changed_blocks != nullptr) {
+      changed_blocks->push_back(first_use_it.block());
+    }
     cfg.insert_before(
         first_use_it,
         gen_move(ig.get_node(dest).type(), dest, param_to_temp.at(dest)));
@@ -905,7 +912,8 @@ void Allocator::split_params(const interference::Graph& ig,
 void Allocator::spill(const interference::Graph& ig,
                       const SpillPlan& spill_plan,
                       const RangeSet& range_set,
-                      cfg::ControlFlowGraph& cfg) {
+                      cfg::ControlFlowGraph& cfg,
+                      std::vector<cfg::Block*>* changed_blocks) {
   // TODO: account for "close" defs and uses. See [Briggs92], section 8.7
   cfg::CFGMutation m(cfg);
   auto ii = cfg::InstructionIterable(cfg);
@@ -961,6 +969,10 @@ void Allocator::spill(const interference::Graph& ig,
     }
   }
   m.flush();
+  if (changed_blocks != nullptr) {
+    changed_blocks->insert(changed_blocks->end(), m.changed_blocks().begin(),
+                           m.changed_blocks().end());
+  }
 }
 
 /*
@@ -1043,15 +1055,26 @@ void Allocator::allocate(cfg::ControlFlowGraph& cfg, bool is_static) {
     dedicate_this_register(cfg, is_static);
   }
   bool first{true};
+  // Liveness is recomputed at each iteration. Spilling only inserts moves and
+  // renames registers locally, so when the previous iteration did nothing
+  // else, only the blocks it changed (and their predecessors) need updating.
+  std::unique_ptr<LivenessFixpointIterator> fixpoint_iter;
+  std::vector<cfg::Block*> changed_blocks;
   while (true) {
     SplitCosts split_costs;
     SpillPlan spill_plan;
     SplitPlan split_plan;
     RegisterTransform reg_transform;
 
-    cfg.calculate_exit_block();
-    auto fixpoint_iter = std::make_unique<LivenessFixpointIterator>(cfg);
-    fixpoint_iter->run(LivenessDomain());
+    if (fixpoint_iter) {
+      // Spilling does not add exit points, so the exit block is still valid.
+      fixpoint_iter->update(LivenessDomain(), changed_blocks);
+    } else {
+      cfg.calculate_exit_block();
+      fixpoint_iter = std::make_unique<LivenessFixpointIterator>(cfg);
+      fixpoint_iter->run(LivenessDomain());
+    }
+    changed_blocks.clear();
 
     TRACE(REG, 5, "Allocating:\n%s", ::SHOW(cfg));
     auto ig = interference::build_graph(
@@ -1070,16 +1093,18 @@ void Allocator::allocate(cfg::ControlFlowGraph& cfg, bool is_static) {
 
     TRACE(REG, 7, "IG:\n%s", SHOW(ig));
     if (first) {
-      coalesce(&ig, cfg);
       first = false;
-      // After coalesce the live_out and live_in of blocks may change, so run
-      // LivenessFixpointIterator again.
-      if (m_config.use_splitting) {
-        fixpoint_iter->run(LivenessDomain());
-      } else {
-        fixpoint_iter = nullptr;
+      if (m_config.use_coalescing) {
+        coalesce(&ig, cfg);
+        // After coalesce the live_out and live_in of blocks may change, so run
+        // LivenessFixpointIterator again.
+        if (m_config.use_splitting) {
+          fixpoint_iter->run(LivenessDomain());
+        } else {
+          fixpoint_iter = nullptr;
+        }
+        TRACE(REG, 5, "Post-coalesce:\n%s", ::SHOW(cfg));
       }
-      TRACE(REG, 5, "Post-coalesce:\n%s", ::SHOW(cfg));
     } else {
       // TODO we should coalesce here too, but we'll need to avoid removing
       // moves that were inserted by spilling
@@ -1117,14 +1142,16 @@ void Allocator::allocate(cfg::ControlFlowGraph& cfg, bool is_static) {
         calc_split_costs(*fixpoint_iter, cfg, &split_costs);
         find_split(ig, split_costs, &reg_transform, &spill_plan, &split_plan);
       }
-      split_params(ig, spill_plan.param_spills, cfg);
-      spill(ig, spill_plan, range_set, cfg);
+      split_params(ig, spill_plan.param_spills, cfg, &changed_blocks);
+      spill(ig, spill_plan, range_set, cfg, &changed_blocks);
 
       if (!split_plan.split_around.empty()) {
         always_assert(m_config.use_splitting);
         TRACE(REG, 5, "Split plan:\n%s", SHOW(split_plan));
         m_stats.split_moves +=
             split(*fixpoint_iter, split_plan, split_costs, ig, cfg);
+        // Splitting may insert blocks between existing ones; start over.
+        fixpoint_iter = nullptr;
       }
     } else {
       transform::remap_registers(cfg, reg_transform.map);
@@ -83,6 +83,9 @@ class Allocator {
   struct Config {
     bool no_overwrite_this{false};
     bool use_splitting{false};
+    // Coalescing removes moves, but on very large methods it is a significant
+    // share of the allocation time.
+    bool use_coalescing{true};
   };
 
   struct Stats {
@@ -137,14 +140,17 @@ class Allocator {
   std::unordered_map<reg_t, cfg::InstructionIterator> find_param_splits(
       const std::unordered_set<reg_t>&, cfg::ControlFlowGraph&);
 
+  // Both append the blocks they change to the given vector, if any.
   void split_params(const interference::Graph&,
                     const std::unordered_set<reg_t>& param_spills,
-                    cfg::ControlFlowGraph&);
+                    cfg::ControlFlowGraph&,
+                    std::vector<cfg::Block*>* changed_blocks = nullptr);
 
   void spill(const interference::Graph&,
              const SpillPlan&,
              const RangeSet&,
-             cfg::ControlFlowGraph&);
+             cfg::ControlFlowGraph&,
+             std::vector<cfg::Block*>* changed_blocks = nullptr);
 
   void allocate(cfg::ControlFlowGraph& cfg, bool);
 
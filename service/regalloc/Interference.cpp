@@ -74,10 +74,14 @@ void Graph::add_edge(reg_t u, reg_t v, bool can_coalesce) {
   if (!is_adjacent(u, v)) {
     auto& u_node = m_nodes.at(u);
     auto& v_node = m_nodes.at(v);
-    u_node.m_adjacent.push_back(v);
-    v_node.m_adjacent.push_back(u);
+    u_node.add_adjacent(v);
+    v_node.add_adjacent(u);
     u_node.m_weight += edge_weight(u_node, v_node);
     v_node.m_weight += edge_weight(v_node, u_node);
+    if (can_coalesce) {
+      m_coalesceable_edges.emplace(build_edge(u, v));
+    }
+    return;
   }
   // If we have one instruction that creates a coalesceable edge between two
   // nodes s0 and s1, and another that creates a non-coalesceable edge, those
@@ -88,8 +92,9 @@ void Graph::add_edge(reg_t u, reg_t v, bool can_coalesce) {
   //
   // then the final state of the edge between s0 and s1 must be
   // non-coalesceable.
-  m_adj_matrix[build_edge(u, v)] =
-      m_adj_matrix[build_edge(u, v)] || !can_coalesce;
+  if (!can_coalesce) {
+    m_coalesceable_edges.erase(build_edge(u, v));
+  }
 }
 
 uint32_t Node::colorable_limit() const {
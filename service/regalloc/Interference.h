@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 #include <boost/range/adaptor/filtered.hpp>
 #include <unordered_map>
@@ -156,6 +157,39 @@ class Node {
   enum Property { PARAM, RANGE, SPILL, ACTIVE, PROPS_SIZE };
 
  private:
+  // Nodes with at least this many neighbors also keep them in a bit vector,
+  // so that adjacency queries don't need to scan a long list.
+  static constexpr size_t DENSE_DEGREE = 64;
+
+  bool has_adjacent(reg_t v) const {
+    if (!m_adjacent_bits.empty()) {
+      size_t word = v / 64;
+      return word < m_adjacent_bits.size() &&
+             ((m_adjacent_bits[word] >> (v % 64)) & 1);
+    }
+    return std::find(m_adjacent.begin(), m_adjacent.end(), v) !=
+           m_adjacent.end();
+  }
+
+  void add_adjacent(reg_t v) {
+    m_adjacent.push_back(v);
+    if (!m_adjacent_bits.empty()) {
+      set_adjacent_bit(v);
+    } else if (m_adjacent.size() >= DENSE_DEGREE) {
+      for (auto t : m_adjacent) {
+        set_adjacent_bit(t);
+      }
+    }
+  }
+
+  void set_adjacent_bit(reg_t v) {
+    size_t word = v / 64;
+    if (word >= m_adjacent_bits.size()) {
+      m_adjacent_bits.resize(word + 1, 0);
+    }
+    m_adjacent_bits[word] |= uint64_t(1) << (v % 64);
+  }
+
   uint32_t m_weight{0};
   uint32_t m_spill_cost{0};
   vreg_t m_max_vreg{max_unsigned_value(16)};
@@ -166,6 +200,8 @@ class Node {
   std::bitset<PROPS_SIZE> m_props;
   RegisterTypeDomain m_type_domain{RegisterType::UNKNOWN};
   std::vector<reg_t> m_adjacent;
+  // Only populated for high-degree nodes, see DENSE_DEGREE.
+  std::vector<uint64_t> m_adjacent_bits;
 
   friend class Graph;
   friend class impl::GraphBuilder;
@@ -191,11 +227,25 @@ class Graph {
   }
 
   bool is_adjacent(reg_t u, reg_t v) const {
-    return m_adj_matrix.find(impl::build_edge(u, v)) != m_adj_matrix.end();
+    auto u_it = m_nodes.find(u);
+    auto v_it = m_nodes.find(v);
+    if (u_it == m_nodes.end() || v_it == m_nodes.end()) {
+      return false;
+    }
+    const auto& u_node = u_it->second;
+    const auto& v_node = v_it->second;
+    // Query whichever node is cheaper to look into.
+    if (!u_node.m_adjacent_bits.empty() ||
+        (v_node.m_adjacent_bits.empty() &&
+         u_node.m_adjacent.size() <= v_node.m_adjacent.size())) {
+      return u_node.has_adjacent(v);
+    }
+    return v_node.has_adjacent(u);
   }
 
   bool is_coalesceable(reg_t u, reg_t v) const {
-    return !is_adjacent(u, v) || !m_adj_matrix.at(impl::build_edge(u, v));
+    return !is_adjacent(u, v) ||
+           m_coalesceable_edges.count(impl::build_edge(u, v));
   }
 
   bool has_containment_edge(reg_t u, reg_t v) const {
@@ -229,7 +279,9 @@ class Graph {
 
  private:
   std::unordered_map<reg_t, Node> m_nodes;
-  std::unordered_map<reg_pair_t, bool> m_adj_matrix;
+  // Adjacency itself is stored in the nodes. Most edges are not
+  // coalesceable, so we only keep track of the ones that are.
+  std::unordered_set<reg_pair_t> m_coalesceable_edges;
   std::unordered_set<reg_pair_t> m_containment_graph;
 
   friend class impl::GraphBuilder;
@@ -527,8 +527,7 @@ bool CheckCastAnalysis::is_check_cast_redundant(IRInstruction* insn,
 
   auto reg = insn->src(0);
   auto type_inference = get_type_inference();
-  auto& envs = type_inference->get_type_environments();
-  auto& env = envs.at(insn);
+  auto env = type_inference->get_type_environment(insn);
 
   auto type = env.get_type(reg);
   if (type.equals(type_inference::TypeDomain(IRType::ZERO))) {
@@ -551,6 +550,7 @@ bool CheckCastAnalysis::is_check_cast_redundant(IRInstruction* insn,
 type_inference::TypeInference* CheckCastAnalysis::get_type_inference() const {
   if (!m_type_inference) {
     m_type_inference = std::make_unique<type_inference::TypeInference>(m_cfg);
+    m_type_inference->set_on_demand_type_environments();
     m_type_inference->run(m_is_static, m_declaring_type, m_args, m_param_anno);
   }
   return m_type_inference.get();
@@ -123,9 +123,10 @@ Shrinker::Shrinker(
           [&](const DexType* type) {
             return !init_classes_with_side_effects.refine(type);
           };
+      const std::string summary_cache_context = "shrinker_init_classes";
       compute_no_side_effects_methods(
           scope, override_graph, clinit_has_no_side_effects, m_pure_methods,
-          &computed_no_side_effects_methods);
+          &computed_no_side_effects_methods, &summary_cache_context);
       for (auto m : computed_no_side_effects_methods) {
         m_pure_methods.insert(const_cast<DexMethod*>(m));
       }
@@ -280,9 +281,7 @@ void Shrinker::shrink_code(
       config.no_overwrite_this = true; // Downstream passes may rely on this.
       regalloc::graph_coloring::allocate(config, code, is_static,
                                          method_describer);
-      // After this, any CFG is gone.
 
-      // Assume that dedup will run, so building CFG is OK.
       auto after_features = get_features(4);
       TRACE(MMINL, 4,
             "Inliner.RegAlloc: %s: (%zu, %zu, %zu) -> (%zu, %zu, %zu)",
@@ -302,7 +301,15 @@ void Shrinker::shrink_code(
     allocator.allocate();
   }
 
-  if (m_config.run_dedup_blocks) {
+  // All stages above work on the one editable CFG built at the beginning;
+  // there is no linearization in between. The analyses they run (constant
+  // domains, available expressions, liveness, types) are specific to each
+  // stage and invalidated by the stage's own rewrites, so they are not shared.
+  //
+  // DedupBlocks can only merge or split blocks when there are at least two of
+  // them. Many methods that get here (e.g. fully inlined callees, or trivial
+  // accessors) are a single block, so we skip setting up the stage for them.
+  if (m_config.run_dedup_blocks && code->cfg().num_blocks() > 1) {
     auto timer = m_dedup_blocks_timer.scope();
     dedup_blocks_impl::Config config;
     dedup_blocks_impl::DedupBlocks dedup_blocks(
@@ -115,6 +115,48 @@ void scan_any_init_reachables(
   }
 }
 
+/*
+ * The methods whose local analysis reads the type of one of the given fields
+ * or the return type of one of the given methods.
+ */
+std::unordered_set<const DexMethod*> get_dirty_methods(
+    const Scope& scope,
+    const call_graph::Graph& cg,
+    const std::unordered_set<const DexField*>& changed_fields,
+    const std::unordered_set<const DexMethod*>& changed_methods) {
+  ConcurrentSet<const DexMethod*> dirty_methods;
+  if (changed_fields.empty() && changed_methods.empty()) {
+    return {};
+  }
+  auto is_dirty = [&](const IRInstruction* insn) {
+    auto op = insn->opcode();
+    if (opcode::is_an_iget(op) || opcode::is_an_sget(op)) {
+      return changed_fields.count(resolve_field(insn->get_field())) != 0;
+    }
+    if (!opcode::is_an_invoke(op)) {
+      return false;
+    }
+    if (changed_methods.count(
+            resolve_method(insn->get_method(), opcode_to_search(insn)))) {
+      return true;
+    }
+    const auto& callees = resolve_callees_in_graph(cg, insn);
+    return std::any_of(callees.begin(), callees.end(), [&](auto* callee) {
+      return changed_methods.count(callee) != 0;
+    });
+  };
+  walk::parallel::code(scope, [&](DexMethod* method, IRCode& code) {
+    for (auto& mie : cfg::InstructionIterable(code.cfg())) {
+      if (is_dirty(mie.insn)) {
+        dirty_methods.insert(method);
+        return;
+      }
+    }
+  });
+  return std::unordered_set<const DexMethod*>(dirty_methods.begin(),
+                                              dirty_methods.end());
+}
+
 } // namespace
 
 namespace type_analyzer {
@@ -151,6 +193,10 @@ void GlobalTypeAnalyzer::analyze_node(
   if (code == nullptr) {
     return;
   }
+  auto args = get_entry_state_at(node).get(CURRENT_PARTITION_LABEL);
+  if (reuse_node_result(method, args, current_partition)) {
+    return;
+  }
   auto& cfg = code->cfg();
   auto intra_ta = get_internal_local_analysis(method);
   const auto outgoing_edges =
@@ -176,6 +222,34 @@ void GlobalTypeAnalyzer::analyze_node(
       intra_ta->analyze_instruction(insn, &state);
     }
   }
+  m_node_results.insert_or_assign(std::make_pair(
+      method, NodeResult{m_iteration, std::move(args), *current_partition}));
+  ++m_analyzed_nodes;
+}
+
+bool GlobalTypeAnalyzer::reuse_node_result(
+    const DexMethod* method,
+    const ArgumentTypeEnvironment& args,
+    ArgumentTypePartition* exit_state) const {
+  bool reused = false;
+  m_node_results.update(
+      method, [&](const DexMethod*, NodeResult& result, bool exists) {
+        if (!exists || !result.args.equals(args)) {
+          return;
+        }
+        // Results from an earlier run are stale if the method depends on
+        // anything that changed in the WholeProgramState since.
+        if (result.iteration != m_iteration &&
+            (m_all_dirty || m_dirty_methods.count(method))) {
+          return;
+        }
+        *exit_state = result.exit_state;
+        reused = true;
+      });
+  if (reused) {
+    ++m_reused_nodes;
+  }
+  return reused;
 }
 
 ArgumentTypePartition GlobalTypeAnalyzer::analyze_edge(
@@ -484,10 +558,27 @@ std::unique_ptr<GlobalTypeAnalyzer> GlobalTypeAnalysis::analyze(
     if (gta->get_whole_program_state().leq(*wps)) {
       break;
     }
+    // Only the methods that depend on a changed field or return type, and
+    // transitively their callees whose arguments change, get analyzed again.
+    std::unordered_set<const DexField*> changed_fields;
+    std::unordered_set<const DexMethod*> changed_methods;
+    std::unordered_set<const DexMethod*> dirty_methods;
+    bool has_changes = gta->get_whole_program_state().get_changed(
+        *wps, &changed_fields, &changed_methods);
+    if (has_changes) {
+      dirty_methods =
+          get_dirty_methods(scope, *cg, changed_fields, changed_methods);
+      TRACE(TYPE, 2,
+            "[global] %zu changed fields, %zu changed methods, %zu dirty "
+            "methods",
+            changed_fields.size(), changed_methods.size(),
+            dirty_methods.size());
+    }
     // Use the refined WholeProgramState to propagate more constants via
     // the stack and registers.
     TRACE(TYPE, 2, "[global] Start a new global analysis run");
-    gta->set_whole_program_state(std::move(wps));
+    gta->set_whole_program_state(std::move(wps),
+                                 has_changes ? &dirty_methods : nullptr);
     gta->run(ArgumentTypePartition{
         {CURRENT_PARTITION_LABEL, ArgumentTypeEnvironment()}});
     ++iteration_cnt;
@@ -498,6 +589,11 @@ std::unique_ptr<GlobalTypeAnalyzer> GlobalTypeAnalysis::analyze(
         "[global] Finished in %zu global iterations (max %zu)",
         iteration_cnt,
         m_max_global_analysis_iteration);
+  TRACE(TYPE,
+        1,
+        "[global] Analyzed %zu call graph nodes, reused %zu results",
+        gta->get_num_analyzed_nodes(),
+        gta->get_num_reused_nodes());
   return gta;
 }
 
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <sparta/HashedAbstractPartition.h>
 
 #include "CallGraph.h"
@@ -91,10 +93,29 @@ class GlobalTypeAnalyzer : public sparta::ParallelMonotonicFixpointIterator<
 
   const WholeProgramState& get_whole_program_state() const { return *m_wps; }
 
-  void set_whole_program_state(std::unique_ptr<WholeProgramState> wps) {
+  /*
+   * Starts a new global iteration with a refined WholeProgramState. The next
+   * run only analyzes methods again whose arguments changed or which are in
+   * `dirty_methods`, i.e. read a field or call a method whose type changed;
+   * all others reuse their result from the previous run. Without
+   * `dirty_methods`, all previous results are discarded.
+   */
+  void set_whole_program_state(
+      std::unique_ptr<WholeProgramState> wps,
+      const std::unordered_set<const DexMethod*>* dirty_methods = nullptr) {
     m_wps = std::move(wps);
+    ++m_iteration;
+    m_all_dirty = dirty_methods == nullptr;
+    m_dirty_methods.clear();
+    if (dirty_methods != nullptr) {
+      m_dirty_methods = *dirty_methods;
+    }
   }
 
+  size_t get_num_analyzed_nodes() const { return m_analyzed_nodes; }
+
+  size_t get_num_reused_nodes() const { return m_reused_nodes; }
+
   const call_graph::Graph& get_call_graph() { return *m_call_graph; }
 
   bool is_reachable(const DexMethod* method) const;
@@ -103,6 +124,24 @@ class GlobalTypeAnalyzer : public sparta::ParallelMonotonicFixpointIterator<
   std::unique_ptr<const WholeProgramState> m_wps;
   std::shared_ptr<const call_graph::Graph> m_call_graph;
 
+  struct NodeResult {
+    size_t iteration{0};
+    ArgumentTypeEnvironment args;
+    ArgumentTypePartition exit_state;
+  };
+  // The last result of analyze_node for each method, and the global iteration
+  // and arguments it was computed with.
+  mutable ConcurrentMap<const DexMethod*, NodeResult> m_node_results;
+  size_t m_iteration{0};
+  bool m_all_dirty{true};
+  std::unordered_set<const DexMethod*> m_dirty_methods;
+  mutable std::atomic<size_t> m_analyzed_nodes{0};
+  mutable std::atomic<size_t> m_reused_nodes{0};
+
+  bool reuse_node_result(const DexMethod* method,
+                         const ArgumentTypeEnvironment& args,
+                         ArgumentTypePartition* exit_state) const;
+
   /*
    * An unsafe variant that runs the local analysis on the given method, and
    * returns the LocalAnalyzer with the end state. This is only used for
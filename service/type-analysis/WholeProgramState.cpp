@@ -406,6 +406,42 @@ bool WholeProgramState::is_reachable(const global::GlobalTypeAnalyzer& gta,
   return !m_known_methods.count(method) || gta.is_reachable(method);
 }
 
+namespace {
+
+template <typename Key>
+void collect_changed_keys(
+    const sparta::HashedAbstractPartition<Key, DexTypeDomain>& a,
+    const sparta::HashedAbstractPartition<Key, DexTypeDomain>& b,
+    std::unordered_set<Key>* changed) {
+  for (auto& [key, type] : a.bindings()) {
+    if (!type.equals(b.get(key))) {
+      changed->insert(key);
+    }
+  }
+  for (auto& [key, type] : b.bindings()) {
+    if (!a.bindings().count(key)) {
+      changed->insert(key);
+    }
+  }
+}
+
+} // namespace
+
+bool WholeProgramState::get_changed(
+    const WholeProgramState& other,
+    std::unordered_set<const DexField*>* changed_fields,
+    std::unordered_set<const DexMethod*>* changed_methods) const {
+  if (m_field_partition.is_top() || m_method_partition.is_top() ||
+      other.m_field_partition.is_top() || other.m_method_partition.is_top()) {
+    return false;
+  }
+  collect_changed_keys(m_field_partition, other.m_field_partition,
+                       changed_fields);
+  collect_changed_keys(m_method_partition, other.m_method_partition,
+                       changed_methods);
+  return true;
+}
+
 std::string WholeProgramState::print_field_partition_diff(
     const WholeProgramState& other) const {
   std::ostringstream ss;
@@ -169,6 +169,15 @@ class WholeProgramState {
     return call_graph::invoke_is_dynamic(*m_call_graph, insn);
   }
 
+  /*
+   * Collects the fields and methods whose types differ between this state and
+   * `other`. Returns false if either state is Top, in which case everything
+   * has to be considered changed.
+   */
+  bool get_changed(const WholeProgramState& other,
+                   std::unordered_set<const DexField*>* changed_fields,
+                   std::unordered_set<const DexMethod*>* changed_methods) const;
+
   // For debugging
   std::string print_field_partition_diff(const WholeProgramState& other) const;
 
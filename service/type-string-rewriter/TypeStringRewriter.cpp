@@ -164,63 +164,77 @@ const DexString* TypeStringMap::get_new_type_name(
   return nullptr;
 }
 
-void rewrite_dalvik_annotation_signature(const Scope& scope,
+bool rewrite_dalvik_annotation_signature(DexAnnotation* anno,
                                          const TypeStringMap& mapping) {
-  DexType* dalviksig = type::dalvik_annotation_Signature();
-  walk::parallel::annotations(scope, [&](DexAnnotation* anno) {
-    if (anno->type() != dalviksig) return;
-    auto& elems = anno->anno_elems();
-    for (auto& elem : elems) {
-      auto& ev = elem.encoded_value;
-      if (ev->evtype() != DEVT_ARRAY) continue;
-      auto arrayev = static_cast<DexEncodedValueArray*>(ev.get());
-      auto const& evs = arrayev->evalues();
-      for (auto& strev : *evs) {
-        if (strev->evtype() != DEVT_STRING) continue;
-        auto stringev = static_cast<DexEncodedValueString*>(strev.get());
-        auto* old_str = stringev->string();
-        auto* new_str = lookup_signature_annotation(mapping, old_str);
-        if (new_str != nullptr) {
-          TRACE(RENAME, 5, "Rewriting Signature from '%s' to '%s'",
-                old_str->c_str(), new_str->c_str());
-          stringev->string(new_str);
-        }
+  if (anno->type() != type::dalvik_annotation_Signature()) return false;
+  bool changed = false;
+  auto& elems = anno->anno_elems();
+  for (auto& elem : elems) {
+    auto& ev = elem.encoded_value;
+    if (ev->evtype() != DEVT_ARRAY) continue;
+    auto arrayev = static_cast<DexEncodedValueArray*>(ev.get());
+    auto const& evs = arrayev->evalues();
+    for (auto& strev : *evs) {
+      if (strev->evtype() != DEVT_STRING) continue;
+      auto stringev = static_cast<DexEncodedValueString*>(strev.get());
+      auto* old_str = stringev->string();
+      auto* new_str = lookup_signature_annotation(mapping, old_str);
+      if (new_str != nullptr) {
+        TRACE(RENAME, 5, "Rewriting Signature from '%s' to '%s'",
+              old_str->c_str(), new_str->c_str());
+        stringev->string(new_str);
+        changed = true;
       }
     }
+  }
+  return changed;
+}
+
+void rewrite_dalvik_annotation_signature(const Scope& scope,
+                                         const TypeStringMap& mapping) {
+  walk::parallel::annotations(scope, [&](DexAnnotation* anno) {
+    rewrite_dalvik_annotation_signature(anno, mapping);
   });
 }
 
+uint32_t rewrite_string_literal_instructions(IRCode& code,
+                                             const TypeStringMap& mapping) {
+  always_assert(code.editable_cfg_built());
+  uint32_t updates = 0;
+  auto& cfg = code.cfg();
+  for (const auto& mie : InstructionIterable(cfg)) {
+    auto insn = mie.insn;
+    if (insn->opcode() != OPCODE_CONST_STRING) {
+      continue;
+    }
+    auto* old_str = insn->get_string();
+    auto* internal_str = DexString::get_string(
+        java_names::external_to_internal(old_str->str()));
+    if (!internal_str || !DexType::get_type(internal_str)) {
+      continue;
+    }
+    auto new_type_name = mapping.get_new_type_name(internal_str);
+    if (!new_type_name) {
+      continue;
+    }
+    auto new_str = DexString::make_string(
+        java_names::internal_to_external(new_type_name->str()));
+    insn->set_string(new_str);
+    updates++;
+    TRACE(RENAME,
+          5,
+          "Replace const-string from %s to %s",
+          old_str->c_str(),
+          new_str->c_str());
+  }
+  return updates;
+}
+
 uint32_t rewrite_string_literal_instructions(const Scope& scope,
                                              const TypeStringMap& mapping) {
   std::atomic<uint32_t> total_updates(0);
-  walk::parallel::code(scope, [&](DexMethod* meth, IRCode& code) {
-    always_assert(code.editable_cfg_built());
-    auto& cfg = code.cfg();
-    for (const auto& mie : InstructionIterable(cfg)) {
-      auto insn = mie.insn;
-      if (insn->opcode() != OPCODE_CONST_STRING) {
-        continue;
-      }
-      auto* old_str = insn->get_string();
-      auto* internal_str = DexString::get_string(
-          java_names::external_to_internal(old_str->str()));
-      if (!internal_str || !DexType::get_type(internal_str)) {
-        continue;
-      }
-      auto new_type_name = mapping.get_new_type_name(internal_str);
-      if (!new_type_name) {
-        continue;
-      }
-      auto new_str = DexString::make_string(
-          java_names::internal_to_external(new_type_name->str()));
-      insn->set_string(new_str);
-      total_updates++;
-      TRACE(RENAME,
-            5,
-            "Replace const-string from %s to %s",
-            old_str->c_str(),
-            new_str->c_str());
-    }
+  walk::parallel::code(scope, [&](DexMethod*, IRCode& code) {
+    total_updates += rewrite_string_literal_instructions(code, mapping);
   });
   return total_updates.load();
 }
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "DexAnnotation.h"
 #include "DexClass.h"
 
 /**
@@ -46,6 +47,13 @@ class TypeStringMap {
 void rewrite_dalvik_annotation_signature(const Scope& scope,
                                          const TypeStringMap& mapping);
 
+/**
+ * Same as above for a single annotation, which is left alone unless it is a
+ * Signature annotation. Returns whether anything was rewritten.
+ */
+bool rewrite_dalvik_annotation_signature(DexAnnotation* anno,
+                                         const TypeStringMap& mapping);
+
 /**
  * Rewrite string literals in instructions from old type names to new type
  * names. Return the number of total updates.
@@ -55,4 +63,10 @@ void rewrite_dalvik_annotation_signature(const Scope& scope,
 uint32_t rewrite_string_literal_instructions(const Scope& scope,
                                              const TypeStringMap& mapping);
 
+/**
+ * Same as above for the instructions of a single method.
+ */
+uint32_t rewrite_string_literal_instructions(IRCode& code,
+                                             const TypeStringMap& mapping);
+
 } // namespace rewriter
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 namespace dex_encoding {
@@ -17,6 +18,25 @@ namespace details {
 [[noreturn]] void throw_invalid(const char* msg);
 [[noreturn]] void throw_invalid(const char* msg, uint32_t size);
 
+// Returns the number of leading ASCII (single byte code point) characters in
+// [s, s + size). Checks eight bytes at a time, since almost all strings in a
+// dex file are plain ASCII.
+inline size_t ascii_prefix_length(const char* s, size_t size) {
+  constexpr uint64_t kHighBits = 0x8080808080808080ull;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, s + i, sizeof(word));
+    if (word & kHighBits) {
+      break;
+    }
+  }
+  while (i < size && !(s[i] & 0x80)) {
+    ++i;
+  }
+  return i;
+}
+
 } // namespace details
 } // namespace dex_encoding
 
@@ -199,6 +219,23 @@ inline uint32_t length_of_utf8_string(const char* s) {
   return len;
 }
 
+// Same as above for a string of known size in bytes, skipping ASCII runs
+// without decoding them.
+inline uint32_t length_of_utf8_string(const char* s, size_t size) {
+  const char* end = s + size;
+  uint32_t len = 0;
+  while (s < end) {
+    size_t ascii = dex_encoding::details::ascii_prefix_length(s, end - s);
+    len += ascii;
+    s += ascii;
+    if (s < end) {
+      ++len;
+      mutf8_next_code_point(s);
+    }
+  }
+  return len;
+}
+
 // https://docs.oracle.com/javase/8/docs/api/java/lang/String.html#hashCode--
 inline int32_t java_hashcode_of_utf8_string(const char* s) {
   if (s == nullptr) {
@@ -217,6 +254,23 @@ inline int32_t java_hashcode_of_utf8_string(const char* s) {
   return ret.hash;
 }
 
+// Same as above for a string of known size in bytes. ASCII runs are folded
+// into the hash without decoding them. Hash arithmetic is modulo 2^32.
+inline int32_t java_hashcode_of_utf8_string(const char* s, size_t size) {
+  const char* end = s + size;
+  uint32_t hash = 0;
+  while (s < end) {
+    size_t ascii = dex_encoding::details::ascii_prefix_length(s, end - s);
+    for (const char* run_end = s + ascii; s < run_end; ++s) {
+      hash = hash * 31 + static_cast<uint8_t>(*s);
+    }
+    if (s < end) {
+      hash = hash * 31 + mutf8_next_code_point(s);
+    }
+  }
+  return static_cast<int32_t>(hash);
+}
+
 inline uint32_t size_of_utf8_char(const int32_t ival) {
   if (ival >= 0x00 && ival <= 0x7F) {
     return 1;
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/*
+ * Throughput benchmarks for the core operations of the sparta maps and
+ * abstract domains. Run with `--benchmark_format=json` (or
+ * `--benchmark_out=<file> --benchmark_out_format=json`) to get results that
+ * can be compared across releases, e.g. with Google Benchmark's compare.py.
+ *
+ * Sizes range from a handful of bindings, the common case for register
+ * environments, up to the larger maps seen in interprocedural analyses.
+ * Read-only operations run on inputs shared by all threads, to expose
+ * contention, e.g. on the reference counts of Patricia tree nodes.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <sparta/DenseIndexMapAbstractEnvironment.h>
+#include <sparta/FlatMap.h>
+#include <sparta/FlatSet.h>
+#include <sparta/HashedAbstractEnvironment.h>
+#include <sparta/IntervalDomain.h>
+#include <sparta/PatriciaTreeMap.h>
+#include <sparta/PatriciaTreeMapAbstractEnvironment.h>
+#include <sparta/SmallSortedSetAbstractDomain.h>
+
+using namespace sparta;
+
+namespace {
+
+using Interval = IntervalDomain<int64_t>;
+
+using PatriciaMap = PatriciaTreeMap<uint32_t, uint32_t>;
+using FlatUIntMap = FlatMap<uint32_t, uint32_t>;
+using FlatUIntSet = FlatSet<uint32_t>;
+
+using PatriciaEnvironment =
+    PatriciaTreeMapAbstractEnvironment<uint32_t, Interval>;
+using HashedEnvironment = HashedAbstractEnvironment<uint32_t, Interval>;
+using DenseEnvironment = DenseIndexMapAbstractEnvironment<uint32_t, Interval>;
+
+using SmallSet = SmallSortedSetAbstractDomain<uint32_t, /* MaxCount */ 4>;
+
+constexpr int64_t kMinSize = 8;
+constexpr int64_t kMaxSize = 1 << 14;
+constexpr int kMaxThreads = 8;
+
+// Keys are drawn from a universe four times the size of the map, so that two
+// maps of the same size overlap on about a quarter of their keys.
+std::vector<uint32_t> random_keys(size_t size, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<uint32_t> dist(0, 4 * size);
+  std::vector<uint32_t> keys(size);
+  for (auto& key : keys) {
+    key = dist(gen);
+  }
+  return keys;
+}
+
+// Mutable maps (e.g. FlatMap) combine values in place, immutable ones (e.g.
+// PatriciaTreeMap) return the combined value.
+template <typename Map, typename Combine>
+void combine_with(Map* map,
+                  const Map& other,
+                  bool is_union,
+                  Combine&& combine) {
+  if constexpr (Map::mutability == AbstractMapMutability::Mutable) {
+    auto in_place = [&](uint32_t* x, const uint32_t& y) { *x = combine(*x, y); };
+    is_union ? map->union_with(in_place, other)
+             : map->intersection_with(in_place, other);
+  } else {
+    is_union ? map->union_with(combine, other)
+             : map->intersection_with(combine, other);
+  }
+}
+
+template <typename Map>
+Map make_map(size_t size, uint32_t seed) {
+  Map map;
+  for (auto key : random_keys(size, seed)) {
+    map.insert_or_assign(key, key + 1);
+  }
+  return map;
+}
+
+Interval make_interval(uint32_t key) {
+  return Interval::finite(key, key + (key % 7));
+}
+
+template <typename Environment>
+Environment make_environment(size_t size, uint32_t seed) {
+  Environment env;
+  for (auto key : random_keys(size, seed)) {
+    env.set(key, make_interval(key));
+  }
+  return env;
+}
+
+// A pair of inputs per size, shared by all threads of a benchmark.
+template <typename T, typename Make>
+const std::pair<T, T>& shared_inputs(size_t size, Make make) {
+  static std::mutex mutex;
+  static std::unordered_map<size_t, std::pair<T, T>> inputs;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = inputs.find(size);
+  if (it == inputs.end()) {
+    it = inputs.emplace(size, std::make_pair(make(size, 1), make(size, 2)))
+             .first;
+  }
+  return it->second;
+}
+
+void set_items_processed(benchmark::State& state) {
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/*
+ * Maps
+ */
+
+template <typename Map>
+void BM_MapInsert(benchmark::State& state) {
+  auto keys = random_keys(state.range(0), 1);
+  for (auto _ : state) {
+    Map map;
+    for (auto key : keys) {
+      map.insert_or_assign(key, key + 1);
+    }
+    benchmark::DoNotOptimize(map);
+  }
+  set_items_processed(state);
+}
+
+template <typename Map>
+void BM_MapLookup(benchmark::State& state) {
+  const auto& map = shared_inputs<Map>(state.range(0), make_map<Map>).first;
+  auto keys = random_keys(state.range(0), 3);
+  for (auto _ : state) {
+    for (auto key : keys) {
+      benchmark::DoNotOptimize(map.at(key));
+    }
+  }
+  set_items_processed(state);
+}
+
+template <typename Map>
+void BM_MapUnion(benchmark::State& state) {
+  const auto& [a, b] = shared_inputs<Map>(state.range(0), make_map<Map>);
+  for (auto _ : state) {
+    auto map = a;
+    combine_with(&map, b, /* is_union */ true,
+                 [](uint32_t x, uint32_t y) { return std::max(x, y); });
+    benchmark::DoNotOptimize(map);
+  }
+  set_items_processed(state);
+}
+
+template <typename Map>
+void BM_MapIntersection(benchmark::State& state) {
+  const auto& [a, b] = shared_inputs<Map>(state.range(0), make_map<Map>);
+  for (auto _ : state) {
+    auto map = a;
+    combine_with(&map, b, /* is_union */ false,
+                 [](uint32_t x, uint32_t y) { return std::min(x, y); });
+    benchmark::DoNotOptimize(map);
+  }
+  set_items_processed(state);
+}
+
+template <typename Map>
+void BM_MapIterate(benchmark::State& state) {
+  const auto& map = shared_inputs<Map>(state.range(0), make_map<Map>).first;
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (const auto& binding : map) {
+      sum += binding.second;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  set_items_processed(state);
+}
+
+/*
+ * Sets
+ */
+
+template <typename Set>
+void BM_SetContains(benchmark::State& state) {
+  auto make_set = [](size_t size, uint32_t seed) {
+    auto keys = random_keys(size, seed);
+    return Set(keys.begin(), keys.end());
+  };
+  const auto& set = shared_inputs<Set>(state.range(0), make_set).first;
+  auto keys = random_keys(state.range(0), 3);
+  for (auto _ : state) {
+    for (auto key : keys) {
+      benchmark::DoNotOptimize(set.contains(key));
+    }
+  }
+  set_items_processed(state);
+}
+
+template <typename Set>
+void BM_SetIntersection(benchmark::State& state) {
+  auto make_set = [](size_t size, uint32_t seed) {
+    auto keys = random_keys(size, seed);
+    return Set(keys.begin(), keys.end());
+  };
+  const auto& [a, b] = shared_inputs<Set>(state.range(0), make_set);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a.get_intersection_with(b));
+  }
+  set_items_processed(state);
+}
+
+/*
+ * Abstract environments
+ */
+
+template <typename Environment>
+void BM_EnvironmentSet(benchmark::State& state) {
+  auto keys = random_keys(state.range(0), 1);
+  for (auto _ : state) {
+    Environment env;
+    for (auto key : keys) {
+      env.set(key, make_interval(key));
+    }
+    benchmark::DoNotOptimize(env);
+  }
+  set_items_processed(state);
+}
+
+template <typename Environment>
+void BM_EnvironmentGet(benchmark::State& state) {
+  const auto& env =
+      shared_inputs<Environment>(state.range(0),
+                                 make_environment<Environment>)
+          .first;
+  auto keys = random_keys(state.range(0), 3);
+  for (auto _ : state) {
+    for (auto key : keys) {
+      benchmark::DoNotOptimize(env.get(key));
+    }
+  }
+  set_items_processed(state);
+}
+
+template <typename Environment>
+void BM_EnvironmentJoin(benchmark::State& state) {
+  const auto& [a, b] = shared_inputs<Environment>(
+      state.range(0), make_environment<Environment>);
+  for (auto _ : state) {
+    auto env = a;
+    env.join_with(b);
+    benchmark::DoNotOptimize(env);
+  }
+  set_items_processed(state);
+}
+
+template <typename Environment>
+void BM_EnvironmentMeet(benchmark::State& state) {
+  const auto& [a, b] = shared_inputs<Environment>(
+      state.range(0), make_environment<Environment>);
+  for (auto _ : state) {
+    auto env = a;
+    env.meet_with(b);
+    benchmark::DoNotOptimize(env);
+  }
+  set_items_processed(state);
+}
+
+template <typename Environment>
+void BM_EnvironmentLeq(benchmark::State& state) {
+  const auto& [a, b] = shared_inputs<Environment>(
+      state.range(0), make_environment<Environment>);
+  // Comparing against the join makes leq walk all bindings instead of bailing
+  // out at the first incomparable one.
+  const auto joined = a.join(b);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a.leq(joined));
+  }
+  set_items_processed(state);
+}
+
+template <typename Environment>
+void BM_EnvironmentIterate(benchmark::State& state) {
+  const auto& env =
+      shared_inputs<Environment>(state.range(0),
+                                 make_environment<Environment>)
+          .first;
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const auto& binding : env.bindings()) {
+      sum += binding.second.lower_bound();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  set_items_processed(state);
+}
+
+/*
+ * Small domains, where the cost per operation rather than per element matters.
+ */
+
+void BM_SmallSortedSetJoinMeetLeq(benchmark::State& state) {
+  std::vector<SmallSet> sets;
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<uint32_t> dist(0, 8);
+  for (size_t i = 0; i < 64; ++i) {
+    SmallSet set;
+    for (size_t j = 0, n = dist(gen) % 4; j < n; ++j) {
+      set.add(dist(gen));
+    }
+    sets.push_back(set);
+  }
+  for (auto _ : state) {
+    for (size_t i = 0; i + 1 < sets.size(); ++i) {
+      benchmark::DoNotOptimize(sets[i].join(sets[i + 1]));
+      benchmark::DoNotOptimize(sets[i].meet(sets[i + 1]));
+      benchmark::DoNotOptimize(sets[i].leq(sets[i + 1]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * (sets.size() - 1));
+}
+
+void BM_IntervalJoinMeetLeq(benchmark::State& state) {
+  std::vector<Interval> intervals;
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<int64_t> dist(-1000, 1000);
+  for (size_t i = 0; i < 64; ++i) {
+    auto lb = dist(gen);
+    intervals.push_back(Interval::finite(lb, lb + std::abs(dist(gen))));
+  }
+  for (auto _ : state) {
+    for (size_t i = 0; i + 1 < intervals.size(); ++i) {
+      benchmark::DoNotOptimize(intervals[i].join(intervals[i + 1]));
+      benchmark::DoNotOptimize(intervals[i].meet(intervals[i + 1]));
+      benchmark::DoNotOptimize(intervals[i].leq(intervals[i + 1]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * (intervals.size() - 1));
+}
+
+} // namespace
+
+#define SPARTA_SIZED_BENCHMARK(func, type)               \
+  BENCHMARK_TEMPLATE(func, type)                         \
+      ->RangeMultiplier(8)                               \
+      ->Range(kMinSize, kMaxSize)                        \
+      ->ThreadRange(1, kMaxThreads)                      \
+      ->UseRealTime()
+
+SPARTA_SIZED_BENCHMARK(BM_MapInsert, PatriciaMap);
+SPARTA_SIZED_BENCHMARK(BM_MapInsert, FlatUIntMap);
+SPARTA_SIZED_BENCHMARK(BM_MapLookup, PatriciaMap);
+SPARTA_SIZED_BENCHMARK(BM_MapLookup, FlatUIntMap);
+SPARTA_SIZED_BENCHMARK(BM_MapUnion, PatriciaMap);
+SPARTA_SIZED_BENCHMARK(BM_MapUnion, FlatUIntMap);
+SPARTA_SIZED_BENCHMARK(BM_MapIntersection, PatriciaMap);
+SPARTA_SIZED_BENCHMARK(BM_MapIntersection, FlatUIntMap);
+SPARTA_SIZED_BENCHMARK(BM_MapIterate, PatriciaMap);
+SPARTA_SIZED_BENCHMARK(BM_MapIterate, FlatUIntMap);
+
+// Flat sets are mostly used with a few dozen elements.
+BENCHMARK_TEMPLATE(BM_SetContains, FlatUIntSet)
+    ->RangeMultiplier(2)
+    ->Range(4, 256);
+BENCHMARK_TEMPLATE(BM_SetIntersection, FlatUIntSet)
+    ->RangeMultiplier(2)
+    ->Range(4, 256);
+
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentSet, PatriciaEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentSet, HashedEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentSet, DenseEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentGet, PatriciaEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentGet, HashedEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentGet, DenseEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentJoin, PatriciaEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentJoin, HashedEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentJoin, DenseEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentMeet, PatriciaEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentMeet, HashedEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentMeet, DenseEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentLeq, PatriciaEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentLeq, HashedEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentLeq, DenseEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentIterate, PatriciaEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentIterate, HashedEnvironment);
+SPARTA_SIZED_BENCHMARK(BM_EnvironmentIterate, DenseEnvironment);
+
+BENCHMARK(BM_SmallSortedSetJoinMeetLeq)->ThreadRange(1, kMaxThreads);
+BENCHMARK(BM_IntervalJoinMeetLeq)->ThreadRange(1, kMaxThreads);
+
+BENCHMARK_MAIN();
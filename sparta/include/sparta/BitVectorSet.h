@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace sparta {
+
+namespace bvs_impl {
+
+using Word = uint64_t;
+constexpr size_t kBitsPerWord = 64;
+
+/*
+ * The word-wise kernels behind the set operations. The plain loops are simple
+ * enough for the compiler to vectorize (SSE2 on x86-64, NEON on AArch64); when
+ * the build targets AVX2 we process four words per iteration explicitly.
+ */
+
+inline void or_words(Word* dst, const Word* src, size_t n) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_or_si256(a, b));
+  }
+#endif
+  for (; i < n; ++i) {
+    dst[i] |= src[i];
+  }
+}
+
+inline void and_words(Word* dst, const Word* src, size_t n) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_and_si256(a, b));
+  }
+#endif
+  for (; i < n; ++i) {
+    dst[i] &= src[i];
+  }
+}
+
+inline void andnot_words(Word* dst, const Word* src, size_t n) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    // _mm256_andnot_si256(x, y) computes ~x & y.
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+                        _mm256_andnot_si256(b, a));
+  }
+#endif
+  for (; i < n; ++i) {
+    dst[i] &= ~src[i];
+  }
+}
+
+// Returns true iff every bit set in `a` is also set in `b`.
+inline bool is_subset_words(const Word* a, const Word* b, size_t n) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    // _mm256_testc_si256(y, x) is 1 iff (~y & x) == 0.
+    if (!_mm256_testc_si256(y, x)) {
+      return false;
+    }
+  }
+#endif
+  Word extra = 0;
+  for (; i < n; ++i) {
+    extra |= a[i] & ~b[i];
+  }
+  return extra == 0;
+}
+
+} // namespace bvs_impl
+
+/*
+ * A set of unsigned integers represented as a dense bit vector.
+ *
+ * This is meant for analyses over a small, densely used universe, like the
+ * registers of a method, where a PatriciaTreeSet pays for a tree node per
+ * element while the lattice operations boil down to a handful of word-wise
+ * ORs and ANDs here. The vector grows on demand to fit the largest element, so
+ * the universe doesn't need to be known upfront; the memory footprint is
+ * proportional to the largest element though, which makes this a poor choice
+ * for sparse sets over a large universe.
+ *
+ * Trailing zero words are always trimmed, so that two sets are equal if and
+ * only if their bit vectors are. Iteration is in increasing order.
+ */
+template <typename IntegerType>
+class BitVectorSet final {
+  static_assert(std::is_unsigned_v<IntegerType>,
+                "IntegerType is not an unsigned arihmetic type");
+
+  using Word = bvs_impl::Word;
+  static constexpr size_t kBitsPerWord = bvs_impl::kBitsPerWord;
+
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = IntegerType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const IntegerType*;
+    using reference = IntegerType;
+
+    iterator() = default;
+
+    reference operator*() const {
+      return static_cast<IntegerType>(m_index * kBitsPerWord +
+                                      __builtin_ctzll(m_bits));
+    }
+
+    iterator& operator++() {
+      m_bits &= m_bits - 1;
+      if (m_bits == 0) {
+        advance();
+      }
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator copy(*this);
+      ++(*this);
+      return copy;
+    }
+
+    bool operator==(const iterator& other) const {
+      return m_index == other.m_index && m_bits == other.m_bits;
+    }
+
+    bool operator!=(const iterator& other) const { return !(*this == other); }
+
+   private:
+    iterator(const std::vector<Word>* words, size_t index)
+        : m_words(words), m_index(index) {
+      if (m_index < m_words->size()) {
+        m_bits = (*m_words)[m_index];
+        if (m_bits == 0) {
+          advance();
+        }
+      }
+    }
+
+    void advance() {
+      while (++m_index < m_words->size()) {
+        m_bits = (*m_words)[m_index];
+        if (m_bits != 0) {
+          return;
+        }
+      }
+      m_index = m_words->size();
+      m_bits = 0;
+    }
+
+    const std::vector<Word>* m_words{nullptr};
+    size_t m_index{0};
+    Word m_bits{0};
+
+    friend class BitVectorSet;
+  };
+
+  using const_iterator = iterator;
+  using value_type = IntegerType;
+  using size_type = size_t;
+
+  BitVectorSet() = default;
+
+  explicit BitVectorSet(IntegerType e) { insert(e); }
+
+  explicit BitVectorSet(std::initializer_list<IntegerType> l) {
+    for (IntegerType x : l) {
+      insert(x);
+    }
+  }
+
+  template <typename InputIterator>
+  BitVectorSet(InputIterator first, InputIterator last) {
+    for (auto it = first; it != last; ++it) {
+      insert(*it);
+    }
+  }
+
+  bool empty() const { return m_words.empty(); }
+
+  size_t size() const {
+    size_t n = 0;
+    for (Word w : m_words) {
+      n += __builtin_popcountll(w);
+    }
+    return n;
+  }
+
+  size_t max_size() const {
+    return static_cast<size_t>(std::numeric_limits<IntegerType>::max()) + 1;
+  }
+
+  iterator begin() const { return iterator(&m_words, 0); }
+
+  iterator end() const { return iterator(&m_words, m_words.size()); }
+
+  bool contains(IntegerType e) const {
+    size_t index = e / kBitsPerWord;
+    return index < m_words.size() &&
+           ((m_words[index] >> (e % kBitsPerWord)) & 1);
+  }
+
+  bool is_subset_of(const BitVectorSet& other) const {
+    // Since trailing zero words are trimmed, a longer vector has a bit set
+    // beyond the end of the shorter one.
+    return m_words.size() <= other.m_words.size() &&
+           bvs_impl::is_subset_words(m_words.data(), other.m_words.data(),
+                                     m_words.size());
+  }
+
+  bool equals(const BitVectorSet& other) const {
+    return m_words == other.m_words;
+  }
+
+  friend bool operator==(const BitVectorSet& a, const BitVectorSet& b) {
+    return a.equals(b);
+  }
+
+  friend bool operator!=(const BitVectorSet& a, const BitVectorSet& b) {
+    return !a.equals(b);
+  }
+
+  BitVectorSet& insert(IntegerType e) {
+    size_t index = e / kBitsPerWord;
+    if (index >= m_words.size()) {
+      m_words.resize(index + 1, 0);
+    }
+    m_words[index] |= Word(1) << (e % kBitsPerWord);
+    return *this;
+  }
+
+  BitVectorSet& remove(IntegerType e) {
+    size_t index = e / kBitsPerWord;
+    if (index < m_words.size()) {
+      m_words[index] &= ~(Word(1) << (e % kBitsPerWord));
+      trim();
+    }
+    return *this;
+  }
+
+  void clear() { m_words.clear(); }
+
+  template <typename Visitor> // void (IntegerType)
+  void visit(Visitor&& visitor) const {
+    for (IntegerType e : *this) {
+      visitor(e);
+    }
+  }
+
+  BitVectorSet& union_with(const BitVectorSet& other) {
+    if (other.m_words.size() > m_words.size()) {
+      m_words.resize(other.m_words.size(), 0);
+    }
+    bvs_impl::or_words(m_words.data(), other.m_words.data(),
+                       other.m_words.size());
+    return *this;
+  }
+
+  BitVectorSet& intersection_with(const BitVectorSet& other) {
+    if (other.m_words.size() < m_words.size()) {
+      m_words.resize(other.m_words.size());
+    }
+    bvs_impl::and_words(m_words.data(), other.m_words.data(), m_words.size());
+    trim();
+    return *this;
+  }
+
+  BitVectorSet& difference_with(const BitVectorSet& other) {
+    size_t n = std::min(m_words.size(), other.m_words.size());
+    bvs_impl::andnot_words(m_words.data(), other.m_words.data(), n);
+    trim();
+    return *this;
+  }
+
+  friend std::ostream& operator<<(std::ostream& o, const BitVectorSet& s) {
+    o << "{";
+    for (auto it = s.begin(), end = s.end(); it != end;) {
+      o << static_cast<uint64_t>(*it);
+      ++it;
+      if (it != end) {
+        o << ", ";
+      }
+    }
+    o << "}";
+    return o;
+  }
+
+ private:
+  void trim() {
+    while (!m_words.empty() && m_words.back() == 0) {
+      m_words.pop_back();
+    }
+  }
+
+  std::vector<Word> m_words;
+};
+
+} // namespace sparta
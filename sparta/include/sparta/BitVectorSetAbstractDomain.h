@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <initializer_list>
+#include <ostream>
+
+#include <sparta/BitVectorSet.h>
+#include <sparta/PowersetAbstractDomain.h>
+
+namespace sparta {
+
+namespace bvsad_impl {
+
+template <typename IntegerType>
+class BitVectorSetValue final
+    : public PowersetImplementation<IntegerType,
+                                    const BitVectorSet<IntegerType>&,
+                                    BitVectorSetValue<IntegerType>> {
+ public:
+  using Set = BitVectorSet<IntegerType>;
+
+  BitVectorSetValue() = default;
+
+  explicit BitVectorSetValue(IntegerType e) : m_set(e) {}
+
+  explicit BitVectorSetValue(std::initializer_list<IntegerType> l)
+      : m_set(l) {}
+
+  explicit BitVectorSetValue(Set set) : m_set(std::move(set)) {}
+
+  const Set& elements() const { return m_set; }
+
+  bool empty() const { return m_set.empty(); }
+
+  size_t size() const { return m_set.size(); }
+
+  bool contains(const IntegerType& e) const { return m_set.contains(e); }
+
+  void add(const IntegerType& e) { m_set.insert(e); }
+
+  void add(IntegerType&& e) { m_set.insert(e); }
+
+  void remove(const IntegerType& e) { m_set.remove(e); }
+
+  void clear() { m_set.clear(); }
+
+  AbstractValueKind kind() const { return AbstractValueKind::Value; }
+
+  bool leq(const BitVectorSetValue& other) const {
+    return m_set.is_subset_of(other.m_set);
+  }
+
+  bool equals(const BitVectorSetValue& other) const {
+    return m_set.equals(other.m_set);
+  }
+
+  AbstractValueKind join_with(const BitVectorSetValue& other) {
+    m_set.union_with(other.m_set);
+    return AbstractValueKind::Value;
+  }
+
+  AbstractValueKind meet_with(const BitVectorSetValue& other) {
+    m_set.intersection_with(other.m_set);
+    return AbstractValueKind::Value;
+  }
+
+  AbstractValueKind difference_with(const BitVectorSetValue& other) {
+    m_set.difference_with(other.m_set);
+    return AbstractValueKind::Value;
+  }
+
+  friend std::ostream& operator<<(std::ostream& o,
+                                  const BitVectorSetValue& value) {
+    o << "[#" << value.size() << "]";
+    o << value.m_set;
+    return o;
+  }
+
+ private:
+  Set m_set;
+};
+
+} // namespace bvsad_impl
+
+/*
+ * A powerset abstract domain over a small, dense universe of unsigned
+ * integers, backed by a BitVectorSet. Join, meet and the partial order are
+ * word-wise bit operations, which makes this a good fit for analyses like
+ * liveness where the elements are the registers of a single method. For large
+ * or sparse universes, or when many nearly identical sets are kept alive at
+ * once, PatriciaTreeSetAbstractDomain is a better choice.
+ */
+template <typename IntegerType>
+class BitVectorSetAbstractDomain final
+    : public PowersetAbstractDomain<
+          IntegerType,
+          bvsad_impl::BitVectorSetValue<IntegerType>,
+          const BitVectorSet<IntegerType>&,
+          BitVectorSetAbstractDomain<IntegerType>> {
+ public:
+  using Value = bvsad_impl::BitVectorSetValue<IntegerType>;
+
+  BitVectorSetAbstractDomain()
+      : PowersetAbstractDomain<IntegerType,
+                               Value,
+                               const BitVectorSet<IntegerType>&,
+                               BitVectorSetAbstractDomain>() {}
+
+  explicit BitVectorSetAbstractDomain(AbstractValueKind kind)
+      : PowersetAbstractDomain<IntegerType,
+                               Value,
+                               const BitVectorSet<IntegerType>&,
+                               BitVectorSetAbstractDomain>(kind) {}
+
+  explicit BitVectorSetAbstractDomain(IntegerType e) {
+    this->set_to_value(Value(e));
+  }
+
+  explicit BitVectorSetAbstractDomain(std::initializer_list<IntegerType> l) {
+    this->set_to_value(Value(l));
+  }
+
+  static BitVectorSetAbstractDomain bottom() {
+    return BitVectorSetAbstractDomain(AbstractValueKind::Bottom);
+  }
+
+  static BitVectorSetAbstractDomain top() {
+    return BitVectorSetAbstractDomain(AbstractValueKind::Top);
+  }
+};
+
+} // namespace sparta
@@ -0,0 +1,604 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sparta/AbstractMap.h>
+#include <sparta/AbstractMapValue.h>
+#include <sparta/PatriciaTreeCore.h>
+
+namespace sparta {
+
+/*
+ * A map from small unsigned integers, like the registers of a method, that is
+ * backed by a vector indexed by key.
+ *
+ * Lookups and updates are O(1) and iteration is a linear scan of contiguous
+ * memory, where a PatriciaTreeMap chases a pointer per level of the tree. Like
+ * PatriciaTreeMap, copies are cheap: the storage is shared and copied on the
+ * first write, so that the states a fixpoint iterator keeps for every block
+ * don't duplicate unchanged maps. It has the same interface as
+ * PatriciaTreeMap (including the signatures of the combining functions), so
+ * that one can be used in place of the other.
+ *
+ * Binary operations and comparisons take time linear in the largest key
+ * rather than in the number of bindings, which makes this a poor fit for
+ * sparse maps. Keys of at least `DenseLimit` are kept in a small sorted side
+ * vector instead, so that a few large keys (e.g. a pseudo-register for the
+ * result of the last instruction) don't blow up the storage.
+ */
+template <typename Key,
+          typename Value,
+          typename ValueInterface = pt_core::SimpleValue<Value>,
+          size_t DenseLimit = (1 << 16)>
+class DenseIndexMap final
+    : public AbstractMap<DenseIndexMap<Key, Value, ValueInterface, DenseLimit>> {
+  static_assert(std::is_unsigned_v<Key>, "Key is not an unsigned integer");
+  static_assert(std::is_same_v<Value, typename ValueInterface::type>,
+                "Value must be equal to ValueInterface::type");
+  static_assert(std::is_base_of<AbstractMapValue<ValueInterface>,
+                                ValueInterface>::value,
+                "ValueInterface doesn't inherit from AbstractMapValue");
+
+ public:
+  using key_type = Key;
+  using mapped_type = typename ValueInterface::type;
+  using value_type = std::pair<Key, Value>;
+  using difference_type = std::ptrdiff_t;
+  using size_type = size_t;
+  using const_reference = const value_type&;
+  using const_pointer = const value_type*;
+  using value_interface = ValueInterface;
+
+  constexpr static AbstractMapMutability mutability =
+      AbstractMapMutability::Immutable;
+
+ private:
+  struct Storage {
+    // dense[i].first == i; unbound keys hold the default value.
+    std::vector<value_type> dense;
+    // Sorted by key; all keys are at least DenseLimit, and no value is the
+    // default value.
+    std::vector<value_type> sparse;
+    // The number of non-default bindings.
+    size_t size{0};
+  };
+
+ public:
+  // Iterates over the non-default bindings, in increasing order of keys.
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename DenseIndexMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    iterator() = default;
+
+    reference operator*() const { return *m_it; }
+
+    pointer operator->() const { return &*m_it; }
+
+    iterator& operator++() {
+      ++m_it;
+      skip_defaults();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator copy(*this);
+      ++(*this);
+      return copy;
+    }
+
+    bool operator==(const iterator& other) const {
+      // Only compare positions within the same vector.
+      return m_storage == other.m_storage && m_it == other.m_it;
+    }
+
+    bool operator!=(const iterator& other) const { return !(*this == other); }
+
+   private:
+    using base_iterator = typename std::vector<value_type>::const_iterator;
+
+    iterator(const Storage* storage, base_iterator it)
+        : m_storage(storage), m_it(it) {
+      skip_defaults();
+    }
+
+    void skip_defaults() {
+      if (m_storage == nullptr) {
+        return;
+      }
+      const auto& dense = m_storage->dense;
+      while (m_it != dense.end() &&
+             ValueInterface::is_default_value(m_it->second)) {
+        ++m_it;
+      }
+      if (m_it == dense.end()) {
+        // The sparse bindings follow the dense ones.
+        m_it = m_storage->sparse.begin();
+        m_storage = nullptr;
+      }
+    }
+
+    // Non-null while iterating over the dense bindings.
+    const Storage* m_storage{nullptr};
+    base_iterator m_it;
+
+    friend class DenseIndexMap;
+  };
+
+  using const_iterator = iterator;
+
+  DenseIndexMap() = default;
+
+  explicit DenseIndexMap(std::initializer_list<std::pair<Key, Value>> l) {
+    for (const auto& p : l) {
+      insert_or_assign(p.first, p.second);
+    }
+  }
+
+  bool empty() const { return size() == 0; }
+
+  size_t size() const { return m_storage ? m_storage->size : 0; }
+
+  size_t max_size() const { return std::numeric_limits<Key>::max(); }
+
+  iterator begin() const {
+    if (!m_storage) {
+      return iterator(nullptr, empty_sparse().end());
+    }
+    if (m_storage->dense.empty()) {
+      return iterator(nullptr, m_storage->sparse.begin());
+    }
+    return iterator(m_storage.get(), m_storage->dense.begin());
+  }
+
+  iterator end() const {
+    return iterator(nullptr, m_storage ? m_storage->sparse.end()
+                                       : empty_sparse().end());
+  }
+
+  const mapped_type& at(Key key) const {
+    if (m_storage) {
+      if (key < DenseLimit) {
+        if (key < m_storage->dense.size()) {
+          return m_storage->dense[key].second;
+        }
+      } else {
+        const auto& sparse = m_storage->sparse;
+        auto it = std::lower_bound(sparse.begin(), sparse.end(), key,
+                                   CompareWithKey());
+        if (it != sparse.end() && it->first == key) {
+          return it->second;
+        }
+      }
+    }
+    static const mapped_type default_value = ValueInterface::default_value();
+    return default_value;
+  }
+
+  bool leq(const DenseIndexMap& other) const {
+    static_assert(std::is_base_of_v<AbstractDomain<Value>, Value>,
+                  "leq can only be used when Value implements AbstractDomain");
+    if (m_storage == other.m_storage) {
+      return true;
+    }
+    return all_of_keys(other, [](const Value& x, const Value& y) {
+      return ValueInterface::leq(x, y);
+    });
+  }
+
+  bool equals(const DenseIndexMap& other) const {
+    if (m_storage == other.m_storage) {
+      return true;
+    }
+    if (size() != other.size()) {
+      return false;
+    }
+    return all_of_keys(other, [](const Value& x, const Value& y) {
+      return ValueInterface::equals(x, y);
+    });
+  }
+
+  /*
+   * Returns true if both maps share their storage, which implies equality.
+   */
+  bool reference_equals(const DenseIndexMap& other) const {
+    return m_storage == other.m_storage;
+  }
+
+  DenseIndexMap& insert_or_assign(Key key, mapped_type value) {
+    if (ValueInterface::is_default_value(value)) {
+      return remove(key);
+    }
+    *mutable_slot(key) = std::move(value);
+    return *this;
+  }
+
+  template <typename Operation> // mapped_type(const mapped_type&)
+  DenseIndexMap& update(Operation&& operation, Key key) {
+    auto value = operation(at(key));
+    return insert_or_assign(key, std::move(value));
+  }
+
+  template <typename MappingFunction> // mapped_type(const mapped_type&)
+  bool transform(MappingFunction&& f) {
+    if (empty()) {
+      return false;
+    }
+    bool changed = false;
+    for_each_binding(detach(), [&](value_type& binding) {
+      auto value = f(binding.second);
+      if (!ValueInterface::equals(value, binding.second)) {
+        changed = true;
+        binding.second = std::move(value);
+      }
+    });
+    if (changed) {
+      normalize();
+    }
+    return changed;
+  }
+
+  /*
+   * Visit all key-value pairs.
+   */
+  template <typename Visitor> // void(const value_type&)
+  void visit(Visitor&& visitor) const {
+    for (const auto& binding : *this) {
+      visitor(binding);
+    }
+  }
+
+  DenseIndexMap& remove(Key key) {
+    if (ValueInterface::is_default_value(at(key))) {
+      return *this;
+    }
+    auto* storage = detach();
+    if (key < DenseLimit) {
+      storage->dense[key].second = ValueInterface::default_value();
+      trim(storage);
+    } else {
+      auto& sparse = storage->sparse;
+      sparse.erase(std::lower_bound(sparse.begin(), sparse.end(), key,
+                                    CompareWithKey()));
+    }
+    if (--storage->size == 0) {
+      m_storage.reset();
+    }
+    return *this;
+  }
+
+  template <typename Predicate> // bool(const Key&, const mapped_type&)
+  DenseIndexMap& filter(Predicate&& predicate) {
+    bool changed = false;
+    for (const auto& [key, value] : *this) {
+      if (!predicate(key, value)) {
+        changed = true;
+        break;
+      }
+    }
+    if (!changed) {
+      return *this;
+    }
+    for_each_binding(detach(), [&](value_type& binding) {
+      if (!predicate(binding.first, binding.second)) {
+        binding.second = ValueInterface::default_value();
+      }
+    });
+    normalize();
+    return *this;
+  }
+
+  // Erases all entries where keys and `key_mask` share common bits.
+  bool erase_all_matching(Key key_mask) {
+    return filter_changed(
+        [key_mask](Key key, const mapped_type&) { return !(key & key_mask); });
+  }
+
+  // Requires CombiningFunction to coerce to
+  // std::function<mapped_type(const mapped_type&, const mapped_type&)>
+  template <typename CombiningFunction>
+  DenseIndexMap& union_with(CombiningFunction&& combine,
+                            const DenseIndexMap& other) {
+    if (other.empty() || m_storage == other.m_storage) {
+      return *this;
+    }
+    if (empty()) {
+      return *this = other;
+    }
+    auto* storage = detach();
+    const auto& other_dense = other.m_storage->dense;
+    if (storage->dense.size() < other_dense.size()) {
+      extend(storage, other_dense.size());
+    }
+    for (size_t i = 0; i < other_dense.size(); ++i) {
+      const auto& y = other_dense[i].second;
+      if (ValueInterface::is_default_value(y)) {
+        continue;
+      }
+      auto& x = storage->dense[i].second;
+      x = ValueInterface::is_default_value(x) ? y : combine(x, y);
+    }
+    if (!other.m_storage->sparse.empty()) {
+      std::vector<value_type> sparse;
+      merge_sparse(storage->sparse, other.m_storage->sparse,
+                   [&](const value_type* x, const value_type* y) {
+                     if (x && y) {
+                       sparse.emplace_back(x->first,
+                                           combine(x->second, y->second));
+                     } else {
+                       sparse.push_back(x ? *x : *y);
+                     }
+                   });
+      storage->sparse = std::move(sparse);
+    }
+    normalize();
+    return *this;
+  }
+
+  // Requires CombiningFunction to coerce to
+  // std::function<mapped_type(const mapped_type&, const mapped_type&)>
+  template <typename CombiningFunction>
+  DenseIndexMap& intersection_with(CombiningFunction&& combine,
+                                   const DenseIndexMap& other) {
+    if (m_storage == other.m_storage) {
+      return *this;
+    }
+    if (empty() || other.empty()) {
+      clear();
+      return *this;
+    }
+    auto* storage = detach();
+    const auto& other_dense = other.m_storage->dense;
+    auto& dense = storage->dense;
+    for (size_t i = 0; i < dense.size(); ++i) {
+      auto& x = dense[i].second;
+      if (ValueInterface::is_default_value(x)) {
+        continue;
+      }
+      if (i >= other_dense.size() ||
+          ValueInterface::is_default_value(other_dense[i].second)) {
+        x = ValueInterface::default_value();
+      } else {
+        x = combine(x, other_dense[i].second);
+      }
+    }
+    std::vector<value_type> sparse;
+    merge_sparse(storage->sparse, other.m_storage->sparse,
+                 [&](const value_type* x, const value_type* y) {
+                   if (x && y) {
+                     sparse.emplace_back(x->first,
+                                         combine(x->second, y->second));
+                   }
+                 });
+    storage->sparse = std::move(sparse);
+    normalize();
+    return *this;
+  }
+
+  // Requires CombiningFunction to coerce to
+  // std::function<mapped_type(const mapped_type&, const mapped_type&)>
+  // Requires `combine(bottom, ...)` to be a no-op.
+  template <typename CombiningFunction>
+  DenseIndexMap& difference_with(CombiningFunction&& combine,
+                                 const DenseIndexMap& other) {
+    if (m_storage == other.m_storage) {
+      clear();
+      return *this;
+    }
+    if (empty() || other.empty()) {
+      return *this;
+    }
+    auto* storage = detach();
+    const auto& other_dense = other.m_storage->dense;
+    auto& dense = storage->dense;
+    for (size_t i = 0; i < std::min(dense.size(), other_dense.size()); ++i) {
+      auto& x = dense[i].second;
+      const auto& y = other_dense[i].second;
+      if (!ValueInterface::is_default_value(x) &&
+          !ValueInterface::is_default_value(y)) {
+        x = combine(x, y);
+      }
+    }
+    std::vector<value_type> sparse;
+    merge_sparse(storage->sparse, other.m_storage->sparse,
+                 [&](const value_type* x, const value_type* y) {
+                   if (x && y) {
+                     sparse.emplace_back(x->first,
+                                         combine(x->second, y->second));
+                   } else if (x) {
+                     sparse.push_back(*x);
+                   }
+                 });
+    storage->sparse = std::move(sparse);
+    normalize();
+    return *this;
+  }
+
+  void clear() { m_storage.reset(); }
+
+  friend std::ostream& operator<<(std::ostream& o, const DenseIndexMap& m) {
+    o << "{";
+    for (auto it = m.begin(); it != m.end(); ++it) {
+      o << pt_util::deref(it->first) << " -> " << it->second;
+      if (std::next(it) != m.end()) {
+        o << ", ";
+      }
+    }
+    o << "}";
+    return o;
+  }
+
+ private:
+  struct CompareWithKey {
+    bool operator()(const value_type& pair, Key key) const {
+      return pair.first < key;
+    }
+  };
+
+  static const std::vector<value_type>& empty_sparse() {
+    static const std::vector<value_type> empty;
+    return empty;
+  }
+
+  // Makes sure that this map owns its storage, and returns it.
+  Storage* detach() {
+    if (!m_storage) {
+      m_storage = std::make_shared<Storage>();
+    } else if (m_storage.use_count() > 1) {
+      m_storage = std::make_shared<Storage>(*m_storage);
+    }
+    return m_storage.get();
+  }
+
+  static void extend(Storage* storage, size_t size) {
+    auto& dense = storage->dense;
+    dense.reserve(size);
+    for (size_t i = dense.size(); i < size; ++i) {
+      dense.emplace_back(static_cast<Key>(i), ValueInterface::default_value());
+    }
+  }
+
+  // Returns the slot for a non-default value bound to `key`, creating it if
+  // needed. The caller must not store the default value in it.
+  mapped_type* mutable_slot(Key key) {
+    auto* storage = detach();
+    if (key < DenseLimit) {
+      if (key >= storage->dense.size()) {
+        extend(storage, static_cast<size_t>(key) + 1);
+      }
+      auto& value = storage->dense[key].second;
+      if (ValueInterface::is_default_value(value)) {
+        ++storage->size;
+      }
+      return &value;
+    }
+    auto& sparse = storage->sparse;
+    auto it = std::lower_bound(sparse.begin(), sparse.end(), key,
+                               CompareWithKey());
+    if (it == sparse.end() || it->first != key) {
+      it = sparse.emplace(it, key, ValueInterface::default_value());
+      ++storage->size;
+    }
+    return &it->second;
+  }
+
+  static void trim(Storage* storage) {
+    auto& dense = storage->dense;
+    while (!dense.empty() &&
+           ValueInterface::is_default_value(dense.back().second)) {
+      dense.pop_back();
+    }
+  }
+
+  // Restores the invariants after a bulk update of the storage.
+  void normalize() {
+    auto* storage = m_storage.get();
+    trim(storage);
+    auto& sparse = storage->sparse;
+    sparse.erase(std::remove_if(sparse.begin(), sparse.end(),
+                                [](const value_type& binding) {
+                                  return ValueInterface::is_default_value(
+                                      binding.second);
+                                }),
+                 sparse.end());
+    size_t size = sparse.size();
+    for (const auto& binding : storage->dense) {
+      if (!ValueInterface::is_default_value(binding.second)) {
+        ++size;
+      }
+    }
+    storage->size = size;
+    if (size == 0) {
+      m_storage.reset();
+    }
+  }
+
+  // Calls `f` on all non-default bindings of `storage`.
+  template <typename F> // void(value_type&)
+  static void for_each_binding(Storage* storage, F&& f) {
+    for (auto& binding : storage->dense) {
+      if (!ValueInterface::is_default_value(binding.second)) {
+        f(binding);
+      }
+    }
+    for (auto& binding : storage->sparse) {
+      f(binding);
+    }
+  }
+
+  template <typename Predicate>
+  bool filter_changed(Predicate&& predicate) {
+    auto old_size = size();
+    filter(std::forward<Predicate>(predicate));
+    return size() != old_size;
+  }
+
+  // Calls `f(x, y)` on the bindings of both sparse vectors in increasing order
+  // of keys, where a null argument stands for an unbound key.
+  template <typename F>
+  static void merge_sparse(const std::vector<value_type>& xs,
+                           const std::vector<value_type>& ys,
+                           F&& f) {
+    auto x = xs.begin(), y = ys.begin();
+    while (x != xs.end() || y != ys.end()) {
+      if (y == ys.end() || (x != xs.end() && x->first < y->first)) {
+        f(&*x++, nullptr);
+      } else if (x == xs.end() || y->first < x->first) {
+        f(nullptr, &*y++);
+      } else {
+        f(&*x++, &*y++);
+      }
+    }
+  }
+
+  // Returns true if `p(this->at(key), other.at(key))` holds for all keys that
+  // are bound in either map.
+  template <typename P>
+  bool all_of_keys(const DenseIndexMap& other, P&& p) const {
+    static const mapped_type default_value = ValueInterface::default_value();
+    const auto& dense = m_storage ? m_storage->dense : empty_sparse();
+    const auto& other_dense =
+        other.m_storage ? other.m_storage->dense : empty_sparse();
+    for (size_t i = 0; i < std::max(dense.size(), other_dense.size()); ++i) {
+      const auto& x = i < dense.size() ? dense[i].second : default_value;
+      const auto& y =
+          i < other_dense.size() ? other_dense[i].second : default_value;
+      if (!p(x, y)) {
+        return false;
+      }
+    }
+    bool holds = true;
+    merge_sparse(m_storage ? m_storage->sparse : empty_sparse(),
+                 other.m_storage ? other.m_storage->sparse : empty_sparse(),
+                 [&](const value_type* x, const value_type* y) {
+                   holds = holds && p(x ? x->second : default_value,
+                                      y ? y->second : default_value);
+                 });
+    return holds;
+  }
+
+  std::shared_ptr<Storage> m_storage;
+};
+
+} // namespace sparta
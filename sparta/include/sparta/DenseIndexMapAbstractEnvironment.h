@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <sparta/AbstractEnvironment.h>
+#include <sparta/DenseIndexMap.h>
+
+namespace sparta {
+
+/*
+ * An abstract environment over a small, dense set of variables, like the
+ * registers of a method, with O(1) access to bindings and cheap copies.
+ *
+ * It is interchangeable with PatriciaTreeMapAbstractEnvironment, and is
+ * usually faster when most variables below the largest one are bound; see
+ * DenseIndexMap.h for the trade-offs.
+ *
+ * See AbstractEnvironment.h for more details about abstract
+ * environments.
+ */
+template <typename Variable, typename Domain>
+using DenseIndexMapAbstractEnvironment =
+    AbstractEnvironment<DenseIndexMap<Variable, Domain, TopValueInterface<Domain>>>;
+
+} // namespace sparta
@@ -16,6 +16,7 @@
 
 #include <sparta/AbstractMap.h>
 #include <sparta/AbstractMapValue.h>
+#include <sparta/FlatSearch.h>
 #include <sparta/PatriciaTreeCore.h>
 
 namespace sparta {
@@ -76,12 +77,16 @@ class FlatMap final
       AbstractMapMutability::Mutable;
 
  private:
-  struct ComparePairWithKey {
-    bool operator()(const value_type& pair, const Key& key) const {
-      return KeyCompare()(pair.first, key);
-    }
+  struct PairKey {
+    const Key& operator()(const value_type& pair) const { return pair.first; }
   };
 
+  template <typename Iterator>
+  static Iterator lower_bound(Iterator first, Iterator last, const Key& key) {
+    return flat_impl::gallop_lower_bound(first, last, key, KeyCompare(),
+                                         PairKey());
+  }
+
   struct PairEqual {
     bool operator()(const value_type& left, const value_type& right) const {
       return KeyEqual()(left.first, right.first) &&
@@ -167,9 +172,10 @@ class FlatMap final
         // [other_it, other_end] that is not defined within [it, end].
         return false;
       }
-      // Performs a binary search (in O(log(n))) which returns an iterator on
-      // the first pair where `it->first >= other_it->first`.
-      it = std::lower_bound(it, end, other_it->first, ComparePairWithKey());
+      // Performs a galloping search (in O(log(d)), where d is the distance
+      // to the result) which returns an iterator on the first pair where
+      // `it->first >= other_it->first`.
+      it = lower_bound(it, end, other_it->first);
       if (it == end || !KeyEqual()(it->first, other_it->first)) {
         return false;
       }
@@ -199,10 +205,10 @@ class FlatMap final
         // that does not exist in [it, end], hence is bound to bottom.
         return false;
       }
-      // Performs a binary search (in O(log(n))) which returs an iterator on the
-      // first pair where `other_it->first >= it->first`.
-      other_it = std::lower_bound(other_it, other_end, it->first,
-                                  ComparePairWithKey());
+      // Performs a galloping search (in O(log(d)), where d is the distance
+      // to the result) which returns an iterator on the first pair where
+      // `other_it->first >= it->first`.
+      other_it = lower_bound(other_it, other_end, it->first);
       if (other_it == other_end || !KeyEqual()(it->first, other_it->first)) {
         return false;
       }
@@ -309,7 +315,7 @@ class FlatMap final
     auto it = m_map.begin(), end = m_map.end();
     auto other_it = other.m_map.begin(), other_end = other.m_map.end();
     while (other_it != other_end) {
-      it = std::lower_bound(it, end, other_it->first, ComparePairWithKey());
+      it = lower_bound(it, end, other_it->first);
       if (it == end) {
         m_map.insert(boost::container::ordered_unique_range, other_it,
                      other_end);
@@ -336,8 +342,7 @@ class FlatMap final
     auto it = m_map.begin(), end = m_map.end();
     auto other_it = other.m_map.begin(), other_end = other.m_map.end();
     while (it != end) {
-      other_it = std::lower_bound(other_it, other_end, it->first,
-                                  ComparePairWithKey());
+      other_it = lower_bound(other_it, other_end, it->first);
       if (other_it == other_end) {
         m_map.erase(it, end);
         break;
@@ -363,7 +368,7 @@ class FlatMap final
     auto it = m_map.begin(), end = m_map.end();
     auto other_it = other.m_map.begin(), other_end = other.m_map.end();
     while (other_it != other_end) {
-      it = std::lower_bound(it, end, other_it->first, ComparePairWithKey());
+      it = lower_bound(it, end, other_it->first);
       if (it == end) {
         break;
       }
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+
+namespace sparta {
+namespace flat_impl {
+
+struct Identity {
+  template <typename T>
+  const T& operator()(const T& x) const {
+    return x;
+  }
+};
+
+/*
+ * Same as `std::lower_bound(first, last, key, comp)`, where elements are
+ * compared through `proj(element)`, but optimized for the case where the
+ * result is close to `first`.
+ *
+ * The merge-joins of FlatMap and FlatSet look up the keys of one sorted vector
+ * in another one, resuming each search where the previous one ended. When the
+ * vectors are of similar sizes, the next key is usually found within a few
+ * elements, and a binary search over the whole remainder wastes most of its
+ * comparisons. Galloping (exponential) search examines positions 0, 1, 3, 7,
+ * ... until it passes the key, then bisects the last interval, so that it
+ * costs O(log(d)) comparisons where d is the distance to the result.
+ */
+template <typename Iterator,
+          typename Key,
+          typename Compare,
+          typename Projection = Identity>
+Iterator gallop_lower_bound(Iterator first,
+                            Iterator last,
+                            const Key& key,
+                            Compare comp,
+                            Projection proj = Projection()) {
+  auto less_than_key = [&comp, &proj](const auto& element, const Key& k) {
+    return comp(proj(element), k);
+  };
+  auto size = std::distance(first, last);
+  if (size == 0 || !less_than_key(*first, key)) {
+    return first;
+  }
+  decltype(size) step = 1;
+  while (true) {
+    // Here, `first` is before `last` and its element is smaller than the key.
+    if (step >= size) {
+      return std::lower_bound(std::next(first), last, key, less_than_key);
+    }
+    auto probe = std::next(first, step);
+    if (!less_than_key(*probe, key)) {
+      return std::lower_bound(std::next(first), probe, key, less_than_key);
+    }
+    first = probe;
+    size -= step;
+    step *= 2;
+  }
+}
+
+} // namespace flat_impl
+} // namespace sparta
@@ -15,6 +15,7 @@
 #include <boost/container/flat_set.hpp>
 
 #include <sparta/AbstractSet.h>
+#include <sparta/FlatSearch.h>
 #include <sparta/PatriciaTreeUtil.h>
 
 namespace sparta {
@@ -83,7 +84,7 @@ class FlatSet final
       if (std::distance(it, end) > std::distance(other_it, other_end)) {
         return false;
       }
-      other_it = std::lower_bound(other_it, other_end, *it, Compare());
+      other_it = lower_bound(other_it, other_end, *it);
       if (other_it == other_end || !Equal()(*it, *other_it)) {
         return false;
       }
@@ -144,7 +145,7 @@ class FlatSet final
     auto it = m_set.begin(), end = m_set.end();
     auto other_it = other.m_set.begin(), other_end = other.m_set.end();
     while (other_it != other_end) {
-      it = std::lower_bound(it, end, *other_it, Compare());
+      it = lower_bound(it, end, *other_it);
       if (it == end || !Equal()(*it, *other_it)) {
         it = m_set.insert(it, *other_it);
         end = m_set.end();
@@ -162,7 +163,7 @@ class FlatSet final
     auto it = container.begin(), end = container.end();
     auto other_it = other.m_set.begin(), other_end = other.m_set.end();
     while (it != end) {
-      other_it = std::lower_bound(other_it, other_end, *it, Compare());
+      other_it = lower_bound(other_it, other_end, *it);
       if (other_it != other_end && Equal()(*it, *other_it)) {
         if (first != it) {
           *first = std::move(*it);
@@ -183,11 +184,10 @@ class FlatSet final
     auto it = m_set.begin(), end = m_set.end();
     auto other_it = other.m_set.begin(), other_end = other.m_set.end();
     while (other_it != other_end) {
-      it = std::lower_bound(it, end, *other_it);
+      it = lower_bound(it, end, *other_it);
       if (it != end && Equal()(*it, *other_it)) {
         it = m_set.erase(it);
         end = m_set.end();
-        ++it;
       }
       ++other_it;
     }
@@ -240,6 +240,13 @@ class FlatSet final
   }
 
  private:
+  template <typename Iterator>
+  static Iterator lower_bound(Iterator first,
+                              Iterator last,
+                              const Element& key) {
+    return flat_impl::gallop_lower_bound(first, last, key, Compare());
+  }
+
   BoostFlatSet m_set;
 };
 
@@ -11,8 +11,10 @@
 #include <cstddef>
 #include <functional>
 #include <iterator>
+#include <queue>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <sparta/AbstractDomain.h>
@@ -60,8 +62,8 @@ class MonotonicFixpointIteratorContext final {
   explicit MonotonicFixpointIteratorContext(const Domain& init)
       : m_init(init) {}
 
-  explicit MonotonicFixpointIteratorContext(
-      const Domain& init, const std::unordered_set<NodeId>& nodes)
+  template <typename Nodes>
+  MonotonicFixpointIteratorContext(const Domain& init, const Nodes& nodes)
       : m_init(init) {
     // Pre-populate hash table for all the nodes.
     for (auto& node : nodes) {
@@ -209,6 +211,109 @@ class MonotonicFixpointIteratorBase
     this->analyze_node(node, &exit_state);
   }
 
+ protected:
+  /*
+   * The deterministic concurrent fixpoint algorithm for weak partial orderings
+   * of Kim, Venet and Thakur (see ParallelMonotonicFixpointIterator). The entry
+   * and exit states of all the nodes in `wpo`, as well as their iteration
+   * counts in `context`, must be pre-populated, so that no hash table is
+   * resized while worker threads access it.
+   */
+  void run_wpo_in_parallel(Context* context,
+                           const WeakPartialOrdering<NodeId, NodeHash>& wpo,
+                           size_t num_threads) {
+    std::unique_ptr<std::atomic<uint32_t>[]> wpo_counter(
+        new std::atomic<uint32_t>[wpo.size()]);
+    std::fill_n(wpo_counter.get(), wpo.size(), 0);
+    auto entry_idx = wpo.get_entry();
+    assert(wpo.get_num_preds(entry_idx) == 0);
+    // Prepare work queue.
+    auto wq = sparta::work_queue<uint32_t>(
+        [context, &wpo, &entry_idx, &wpo_counter, this](
+            WorkerState<uint32_t>* worker_state, uint32_t wpo_idx) {
+          std::atomic<uint32_t>& current_counter = wpo_counter[wpo_idx];
+          assert(current_counter == wpo.get_num_preds(wpo_idx));
+          current_counter = 0;
+          // NonExit node
+          if (!wpo.is_exit(wpo_idx)) {
+            this->analyze_vertex(context, wpo.get_node(wpo_idx));
+            for (auto succ_idx : wpo.get_successors(wpo_idx)) {
+              std::atomic<uint32_t>& succ_counter = wpo_counter[succ_idx];
+              // Increase succ node's counter, push succ nodes in work queue if
+              // their counter number matches their NumSchedPreds.
+              if (++succ_counter == wpo.get_num_preds(succ_idx)) {
+                worker_state->push_task(succ_idx);
+              }
+            }
+            return nullptr;
+          }
+          // Exit node
+          // Check if component of the exit node has stabilized.
+          auto head_idx = wpo.get_head_of_exit(wpo_idx);
+          NodeId head = wpo.get_node(head_idx);
+          Domain* current_state = &this->m_entry_states[head];
+          Domain new_state = Domain::bottom();
+          this->compute_entry_state(context, head, &new_state);
+          if (new_state.leq(*current_state)) {
+            // Component stabilized.
+            context->reset_local_iteration_count_for(head);
+            *current_state = std::move(new_state);
+            for (auto succ_idx : wpo.get_successors(wpo_idx)) {
+              std::atomic<uint32_t>& succ_counter = wpo_counter[succ_idx];
+              // Increase succ node's counter, push succ nodes in work queue if
+              // their counter number matches their NumSchedPreds.
+              if (++succ_counter == wpo.get_num_preds(succ_idx)) {
+                worker_state->push_task(succ_idx);
+              }
+            }
+          } else {
+            // Component didn't stabilize.
+            this->extrapolate(*context, head, current_state, new_state);
+            context->increase_iteration_count_for(head);
+            // Set component nodes v's counter to their
+            // NumOuterSchedPreds(v, wpo_idx)
+            for (auto pred_pair : wpo.get_num_outer_preds(wpo_idx)) {
+              auto component_idx = pred_pair.first;
+              assert(component_idx != entry_idx);
+              std::atomic<uint32_t>& component_counter =
+                  wpo_counter[component_idx];
+              // Push component nodes in work queue if their counter number
+              // matches their NumSchedPreds.
+
+              // Note: On page 10, https://dl.acm.org/ft_gateway.cfm?id=3371082
+              // suggests to set the counter to be *equal* to the number of
+              // predecessors not in our component. However, that is only
+              // correct when all counter updates of a scheduling step are done
+              // together as a single atomic update. Instead, we choose to
+              // update point-wise, in which case we have to *add* the number of
+              // predecessors, and update our own counter to 0 before updating
+              // any other dependent counters.
+              if ((component_counter += pred_pair.second) ==
+                  wpo.get_num_preds(component_idx)) {
+                worker_state->push_task(component_idx);
+              }
+            }
+            if (head_idx == entry_idx) {
+              // Handle special case when there is a loop on entry node.
+              // Because entry node have num_preds = 0, and for
+              // get_num_outer_preds the nodes with num_outer_preds are ignored.
+              // So we need to manually add entry node back to work queue if
+              // the component didn't stabilize.
+              worker_state->push_task(head_idx);
+            }
+          }
+          return nullptr;
+        },
+        num_threads,
+        /*push_tasks_while_running=*/true);
+    wq.add_item(wpo.get_entry());
+    wq.run_all();
+    for (uint32_t idx = 0; idx < wpo.size(); ++idx) {
+      assert(wpo_counter[idx] == 0);
+    }
+  }
+
+ public:
   const Graph& m_graph;
   const Domain m_bottom_state = Domain::bottom();
   std::unordered_map<NodeId, Domain, NodeHash> m_entry_states;
@@ -458,95 +563,7 @@ class ParallelMonotonicFixpointIterator
   void run(const Domain& init) {
     this->set_all_to_bottom();
     Context context(init, m_all_nodes);
-    std::unique_ptr<std::atomic<uint32_t>[]> wpo_counter(
-        new std::atomic<uint32_t>[m_wpo.size()]);
-    std::fill_n(wpo_counter.get(), m_wpo.size(), 0);
-    auto entry_idx = m_wpo.get_entry();
-    assert(m_wpo.get_num_preds(entry_idx) == 0);
-    // Prepare work queue.
-    auto wq = sparta::work_queue<uint32_t>(
-        [&context, &entry_idx, &wpo_counter, this](WPOWorkerState* worker_state,
-                                                   uint32_t wpo_idx) {
-          std::atomic<uint32_t>& current_counter = wpo_counter[wpo_idx];
-          assert(current_counter == m_wpo.get_num_preds(wpo_idx));
-          current_counter = 0;
-          // NonExit node
-          if (!m_wpo.is_exit(wpo_idx)) {
-            this->analyze_vertex(&context, m_wpo.get_node(wpo_idx));
-            for (auto succ_idx : m_wpo.get_successors(wpo_idx)) {
-              std::atomic<uint32_t>& succ_counter = wpo_counter[succ_idx];
-              // Increase succ node's counter, push succ nodes in work queue if
-              // their counter number matches their NumSchedPreds.
-              if (++succ_counter == m_wpo.get_num_preds(succ_idx)) {
-                worker_state->push_task(succ_idx);
-              }
-            }
-            return nullptr;
-          }
-          // Exit node
-          // Check if component of the exit node has stabilized.
-          auto head_idx = m_wpo.get_head_of_exit(wpo_idx);
-          NodeId head = m_wpo.get_node(head_idx);
-          Domain* current_state = &this->m_entry_states[head];
-          Domain new_state = Domain::bottom();
-          this->compute_entry_state(&context, head, &new_state);
-          if (new_state.leq(*current_state)) {
-            // Component stabilized.
-            context.reset_local_iteration_count_for(head);
-            *current_state = std::move(new_state);
-            for (auto succ_idx : m_wpo.get_successors(wpo_idx)) {
-              std::atomic<uint32_t>& succ_counter = wpo_counter[succ_idx];
-              // Increase succ node's counter, push succ nodes in work queue if
-              // their counter number matches their NumSchedPreds.
-              if (++succ_counter == m_wpo.get_num_preds(succ_idx)) {
-                worker_state->push_task(succ_idx);
-              }
-            }
-          } else {
-            // Component didn't stabilize.
-            this->extrapolate(context, head, current_state, new_state);
-            context.increase_iteration_count_for(head);
-            // Set component nodes v's counter to their
-            // NumOuterSchedPreds(v, wpo_idx)
-            for (auto pred_pair : m_wpo.get_num_outer_preds(wpo_idx)) {
-              auto component_idx = pred_pair.first;
-              assert(component_idx != entry_idx);
-              std::atomic<uint32_t>& component_counter =
-                  wpo_counter[component_idx];
-              // Push component nodes in work queue if their counter number
-              // matches their NumSchedPreds.
-
-              // Note: On page 10, https://dl.acm.org/ft_gateway.cfm?id=3371082
-              // suggests to set the counter to be *equal* to the number of
-              // predecessors not in our component. However, that is only
-              // correct when all counter updates of a scheduling step are done
-              // together as a single atomic update. Instead, we choose to
-              // update point-wise, in which case we have to *add* the number of
-              // predecessors, and update our own counter to 0 before updating
-              // any other dependent counters.
-              if ((component_counter += pred_pair.second) ==
-                  m_wpo.get_num_preds(component_idx)) {
-                worker_state->push_task(component_idx);
-              }
-            }
-            if (head_idx == entry_idx) {
-              // Handle special case when there is a loop on entry node.
-              // Because entry node have num_preds = 0, and for
-              // get_num_outer_preds the nodes with num_outer_preds are ignored.
-              // So we need to manually add entry node back to work queue if
-              // the component didn't stabilize.
-              worker_state->push_task(head_idx);
-            }
-          }
-          return nullptr;
-        },
-        m_num_thread,
-        /*push_tasks_while_running=*/true);
-    wq.add_item(m_wpo.get_entry());
-    wq.run_all();
-    for (uint32_t idx = 0; idx < m_wpo.size(); ++idx) {
-      assert(wpo_counter[idx] == 0);
-    }
+    this->run_wpo_in_parallel(&context, m_wpo, m_num_thread);
   }
 
  private:
@@ -560,6 +577,14 @@ class ParallelMonotonicFixpointIterator
  * A sequential version of the fixpoint algorithm for Weak Partial Ordering.
  * Unlike the WTOMonotonicFixpointIterator, this does not rely on a recursive
  * algorithm to order its nodes, and so is not at risk of stack overflows.
+ *
+ * Giving the iterator a thread budget larger than one via `set_num_threads`
+ * makes `run` use the concurrent algorithm of
+ * ParallelMonotonicFixpointIterator instead, which analyzes independent
+ * components of the WPO at the same time. The results are the same, but
+ * `analyze_node`, `analyze_edge` and `extrapolate` must then be safe to call
+ * concurrently on different nodes and edges. This only pays off for very
+ * large graphs.
  */
 template <typename GraphInterface,
           typename Domain,
@@ -584,6 +609,10 @@ class MonotonicFixpointIterator
             fp_impl::SuccessorNodeListBuilder<GraphInterface, NodeHash>(graph),
             false) {}
 
+  void set_num_threads(size_t num_threads) { m_num_threads = num_threads; }
+
+  size_t get_num_threads() const { return m_num_threads; }
+
   /*
    * Executes the fixpoint iterator given an abstract value describing the
    * initial program configuration. This method can be invoked multiple times
@@ -591,6 +620,10 @@ class MonotonicFixpointIterator
    * initial conditions.
    */
   void run(const Domain& init) {
+    if (m_num_threads > 1) {
+      run_in_parallel(init);
+      return;
+    }
     this->clear();
     Context context(init);
     std::unique_ptr<std::atomic<uint32_t>[]> wpo_counter(
@@ -672,8 +705,134 @@ class MonotonicFixpointIterator
     }
   }
 
+  /*
+   * Brings the invariants computed by a previous call to `run` up to date
+   * after the graph has been edited, without starting over.
+   *
+   * `changed_nodes` must contain every node whose transfer function or set
+   * of incoming or outgoing edges has changed since the invariants were last
+   * computed, including newly created nodes. Only the nodes reachable from a
+   * changed node can have a different invariant; their states are reset and
+   * recomputed with a worklist, while all other states are kept as they are.
+   * States of nodes that are no longer reachable from the entry are dropped.
+   *
+   * This computes the same invariants as `run(init)` only for domains of
+   * finite height, like the powerset domains of liveness or reaching
+   * definitions, since no widening is applied. Unlike `run`, it does not rely
+   * on the weak partial ordering computed at construction time, so it is safe
+   * to call after nodes and edges have been added or removed.
+   */
+  void update(const Domain& init, const std::vector<NodeId>& changed_nodes) {
+    const auto& graph = this->m_graph;
+    auto successors_of = [&](const NodeId& node, auto&& f) {
+      for (const auto& edge : GraphInterface::successors(graph, node)) {
+        f(GraphInterface::target(graph, edge));
+      }
+    };
+
+    // The nodes reachable from the entry, in depth-first preorder, so that the
+    // worklist below mostly visits predecessors first.
+    std::vector<NodeId> reachable;
+    std::unordered_map<NodeId, size_t, NodeHash> order;
+    reachable.push_back(GraphInterface::entry(graph));
+    order.emplace(reachable.back(), 0);
+    for (size_t i = 0; i < reachable.size(); ++i) {
+      successors_of(reachable[i], [&](const NodeId& succ) {
+        if (order.emplace(succ, reachable.size()).second) {
+          reachable.push_back(succ);
+        }
+      });
+    }
+
+    std::vector<bool> affected(reachable.size(), false);
+    std::vector<size_t> stack;
+    for (const auto& node : changed_nodes) {
+      auto it = order.find(node);
+      if (it != order.end() && !affected[it->second]) {
+        affected[it->second] = true;
+        stack.push_back(it->second);
+      }
+    }
+    while (!stack.empty()) {
+      auto idx = stack.back();
+      stack.pop_back();
+      successors_of(reachable[idx], [&](const NodeId& succ) {
+        auto succ_idx = order.at(succ);
+        if (!affected[succ_idx]) {
+          affected[succ_idx] = true;
+          stack.push_back(succ_idx);
+        }
+      });
+    }
+
+    auto drop_stale_states = [&](auto& states) {
+      for (auto it = states.begin(); it != states.end();) {
+        auto order_it = order.find(it->first);
+        if (order_it == order.end() || affected[order_it->second]) {
+          it = states.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    };
+    drop_stale_states(this->m_entry_states);
+    drop_stale_states(this->m_exit_states);
+
+    Context context(init);
+    std::queue<size_t> work_queue;
+    std::vector<bool> queued(affected);
+    for (size_t idx = 0; idx < reachable.size(); ++idx) {
+      if (affected[idx]) {
+        work_queue.push(idx);
+      }
+    }
+    while (!work_queue.empty()) {
+      auto idx = work_queue.front();
+      work_queue.pop();
+      queued[idx] = false;
+      const auto& node = reachable[idx];
+      auto exit_it = this->m_exit_states.find(node);
+      bool changed = exit_it == this->m_exit_states.end();
+      Domain previous_exit_state =
+          changed ? Domain::bottom() : exit_it->second;
+      this->analyze_vertex(&context, node);
+      changed = changed || !this->m_exit_states.at(node).equals(
+                               previous_exit_state);
+      if (!changed) {
+        continue;
+      }
+      successors_of(node, [&](const NodeId& succ) {
+        auto succ_idx = order.at(succ);
+        if (affected[succ_idx] && !queued[succ_idx]) {
+          queued[succ_idx] = true;
+          work_queue.push(succ_idx);
+        }
+      });
+    }
+  }
+
  private:
+  void run_in_parallel(const Domain& init) {
+    this->clear();
+    std::unordered_set<NodeId, NodeHash> nodes;
+    nodes.reserve(m_wpo.size());
+    for (uint32_t idx = 0; idx < m_wpo.size(); ++idx) {
+      if (!m_wpo.is_exit(idx)) {
+        nodes.emplace(m_wpo.get_node(idx));
+      }
+    }
+    this->m_entry_states.reserve(nodes.size());
+    this->m_exit_states.reserve(nodes.size());
+    for (const auto& node : nodes) {
+      this->m_entry_states.emplace(node, Domain::bottom());
+      this->m_exit_states.emplace(node, Domain::bottom());
+    }
+    Context context(init, nodes);
+    this->run_wpo_in_parallel(&context, m_wpo, m_num_threads);
+  }
+
   WeakPartialOrdering<NodeId, NodeHash> m_wpo;
+  size_t m_num_threads{1};
 };
 
 /*
@@ -12,9 +12,11 @@
 #include <cstdint>
 #include <iterator>
 #include <limits>
+#include <mutex>
 #include <stack>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 
 #include <boost/functional/hash.hpp>
@@ -92,12 +94,50 @@ struct EmptyValue {
       AbstractValueKind::Value;
 };
 
+/*
+ * Hash-consing of Patricia tree nodes.
+ *
+ * When enabled, every new node is looked up in a global, concurrent unique
+ * table before it is handed out, and an existing, structurally equal node is
+ * returned instead if there is one. Patricia trees are canonical, so equal
+ * hash-consed trees are then the same pointer: that shares equal subtrees
+ * across all the environments of a program, makes equality checks of
+ * hash-consed trees a pointer comparison, and lets the `tree1 == tree2`
+ * short-cuts of the join/meet/leq algorithms fire much more often.
+ *
+ * Only trees whose nodes carry a hash can be hash-consed. These are sets, and
+ * maps whose value interface provides a `static size_t hash(const type&)`.
+ * Hash-consing is off by default; trees built while it was off are simply not
+ * shared.
+ */
+inline std::atomic<bool>& hash_consing_flag() {
+  static std::atomic<bool> flag{false};
+  return flag;
+}
+
+template <typename Value, typename = void>
+struct HasValueHash : std::false_type {};
+
+template <typename Value>
+struct HasValueHash<Value,
+                    std::void_t<decltype(Value::hash(
+                        std::declval<const typename Value::type&>()))>>
+    : std::true_type {};
+
+// Whether the nodes of trees over `Value` carry a hash.
+template <typename Value>
+constexpr bool kHasNodeHash =
+    std::is_same_v<Value, EmptyValue> || HasValueHash<Value>::value;
+
 template <typename IntegerType, typename Value>
 class PatriciaTreeLeaf;
 
 template <typename IntegerType, typename Value>
 class PatriciaTreeBranch;
 
+template <typename IntegerType, typename Value>
+class HashConsingTable;
+
 /*
  * Base node common to branches and leafs.
  */
@@ -130,6 +170,12 @@ class PatriciaTreeNode {
     return is_branch() ? static_cast<const BranchType*>(this) : nullptr;
   }
 
+  // Whether this node is owned by the hash-consing table, in which case it is
+  // the only live node with its structure.
+  bool is_hash_consed() const {
+    return m_reference_count.load(std::memory_order_relaxed) & HASH_CONSED_MASK;
+  }
+
   size_t hash() const {
     if (const auto* leaf = as_leaf()) {
       return leaf->hash();
@@ -155,10 +201,28 @@ class PatriciaTreeNode {
       : m_reference_count((is_leaf ? LEAF_MASK : 0) + 1) {}
 
  private:
+  friend class HashConsingTable<IntegerType, Value>;
+
   friend void intrusive_ptr_add_ref(const PatriciaTreeNode* p) {
     p->m_reference_count.fetch_add(1, std::memory_order_relaxed);
   }
 
+  // Takes a reference unless the node is already being destroyed.
+  bool try_add_ref() const {
+    size_t reference_count = m_reference_count.load(std::memory_order_relaxed);
+    do {
+      if ((reference_count & COUNT_MASK) == 0) {
+        return false;
+      }
+    } while (!m_reference_count.compare_exchange_weak(
+        reference_count, reference_count + 1, std::memory_order_relaxed));
+    return true;
+  }
+
+  void mark_hash_consed() const {
+    m_reference_count.fetch_or(HASH_CONSED_MASK, std::memory_order_relaxed);
+  }
+
   static void intrusive_ptr_delete_leaf(const PatriciaTreeNode* p) {
     delete static_cast<const LeafType*>(p);
   }
@@ -189,15 +253,21 @@ class PatriciaTreeNode {
   friend void intrusive_ptr_release(const PatriciaTreeNode* p) {
     size_t prev_reference_count =
         p->m_reference_count.fetch_sub(1, std::memory_order_release);
-    const bool is_unique = (prev_reference_count & ~LEAF_MASK) == 1;
+    const bool is_unique = (prev_reference_count & COUNT_MASK) == 1;
     if (is_unique) {
+      if (prev_reference_count & HASH_CONSED_MASK) {
+        HashConsingTable<IntegerType, Value>::get().erase(p);
+      }
       intrusive_ptr_delete(p);
     }
   }
 
   // We are stealing the highest bit of our reference counter to indicate
-  // whether this tree is a leaf (or, otherwise, branch).
+  // whether this tree is a leaf (or, otherwise, branch), and the next one to
+  // indicate whether it is hash-consed.
   static constexpr size_t LEAF_MASK = ~(static_cast<size_t>(-1) >> 1);
+  static constexpr size_t HASH_CONSED_MASK = LEAF_MASK >> 1;
+  static constexpr size_t COUNT_MASK = ~(LEAF_MASK | HASH_CONSED_MASK);
   mutable std::atomic<size_t> m_reference_count;
 };
 
@@ -216,7 +286,15 @@ class PatriciaTreeLeafBase {
 
   const ValueType& value() const { return m_pair.second; }
 
-  constexpr size_t hash() const { return 0; }
+  size_t hash() const {
+    if constexpr (HasValueHash<Value>::value) {
+      size_t seed = boost::hash<IntegerType>{}(m_pair.first);
+      boost::hash_combine(seed, Value::hash(m_pair.second));
+      return seed;
+    } else {
+      return 0;
+    }
+  }
 
  protected:
   PatriciaTreeLeafBase(IntegerType key, ValueType value)
@@ -266,8 +344,15 @@ class PatriciaTreeLeaf final : public PatriciaTreeNode<IntegerType, Value>,
 
   static inline boost::intrusive_ptr<PatriciaTreeLeaf> make(IntegerType key,
                                                             ValueType value) {
-    return boost::intrusive_ptr<PatriciaTreeLeaf>(
+    boost::intrusive_ptr<PatriciaTreeLeaf> leaf(
         new PatriciaTreeLeaf(key, std::move(value)), /* add_ref */ false);
+    if constexpr (kHasNodeHash<Value>) {
+      if (hash_consing_flag().load(std::memory_order_relaxed)) {
+        return HashConsingTable<IntegerType, Value>::get().intern(
+            std::move(leaf));
+      }
+    }
+    return leaf;
   }
 };
 
@@ -318,9 +403,9 @@ class PatriciaTreeBranchBase</* HasHash */ false> {
 template <typename IntegerType, typename Value>
 class PatriciaTreeBranch final
     : public PatriciaTreeNode<IntegerType, Value>,
-      public PatriciaTreeBranchBase<std::is_same_v<Value, EmptyValue>> {
+      public PatriciaTreeBranchBase<kHasNodeHash<Value>> {
   using Base = PatriciaTreeNode<IntegerType, Value>;
-  using BranchBase = PatriciaTreeBranchBase<std::is_same_v<Value, EmptyValue>>;
+  using BranchBase = PatriciaTreeBranchBase<kHasNodeHash<Value>>;
 
  public:
   PatriciaTreeBranch(IntegerType prefix,
@@ -349,10 +434,20 @@ class PatriciaTreeBranch final
       IntegerType branching_bit,
       boost::intrusive_ptr<Base> left_tree,
       boost::intrusive_ptr<Base> right_tree) {
-    return boost::intrusive_ptr<PatriciaTreeBranch>(
+    // A branch can only be canonical if its subtrees are.
+    const bool hash_cons = kHasNodeHash<Value> &&
+                           left_tree->is_hash_consed() &&
+                           right_tree->is_hash_consed() &&
+                           hash_consing_flag().load(std::memory_order_relaxed);
+    boost::intrusive_ptr<PatriciaTreeBranch> branch(
         new PatriciaTreeBranch(prefix, branching_bit, std::move(left_tree),
                                std::move(right_tree)),
         /* add_ref */ false);
+    if (hash_cons) {
+      return HashConsingTable<IntegerType, Value>::get().intern(
+          std::move(branch));
+    }
+    return branch;
   }
 
  private:
@@ -360,6 +455,94 @@ class PatriciaTreeBranch final
   boost::intrusive_ptr<Base> m_left_tree, m_right_tree;
 };
 
+/*
+ * The unique table of hash-consed nodes, sharded by hash to keep contention
+ * low. It does not own the nodes: it holds plain pointers, and a node removes
+ * itself when its last reference goes away. Lookups skip nodes whose reference
+ * count already dropped to zero, so that a dying node is never resurrected.
+ */
+template <typename IntegerType, typename Value>
+class HashConsingTable final {
+  using NodeType = PatriciaTreeNode<IntegerType, Value>;
+  using LeafType = PatriciaTreeLeaf<IntegerType, Value>;
+  using BranchType = PatriciaTreeBranch<IntegerType, Value>;
+
+ public:
+  static HashConsingTable& get() {
+    // Intentionally leaked, trees may outlive static destruction.
+    static auto* table = new HashConsingTable();
+    return *table;
+  }
+
+  // Returns a node structurally equal to `node` from the table, or publishes
+  // `node` itself if there is none.
+  template <typename T>
+  boost::intrusive_ptr<T> intern(boost::intrusive_ptr<T> node) {
+    size_t hash = node->hash();
+    auto& shard = m_shards[hash % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto range = shard.nodes.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      const NodeType* other = it->second;
+      if (is_same_node(*node, *other) && other->try_add_ref()) {
+        return boost::intrusive_ptr<T>(
+            const_cast<T*>(static_cast<const T*>(other)), /* add_ref */ false);
+      }
+    }
+    node->mark_hash_consed();
+    shard.nodes.emplace(hash, node.get());
+    return node;
+  }
+
+  void erase(const NodeType* node) {
+    size_t hash = node->hash();
+    auto& shard = m_shards[hash % kNumShards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto range = shard.nodes.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == node) {
+        shard.nodes.erase(it);
+        return;
+      }
+    }
+  }
+
+  size_t size() {
+    size_t size = 0;
+    for (auto& shard : m_shards) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      size += shard.nodes.size();
+    }
+    return size;
+  }
+
+ private:
+  static bool is_same_node(const LeafType& leaf, const NodeType& other) {
+    const auto* other_leaf = other.as_leaf();
+    return other_leaf != nullptr && leaf.key() == other_leaf->key() &&
+           Value::equals(leaf.value(), other_leaf->value());
+  }
+
+  // Subtrees of hash-consed branches are hash-consed, so comparing them by
+  // pointer is enough.
+  static bool is_same_node(const BranchType& branch, const NodeType& other) {
+    const auto* other_branch = other.as_branch();
+    return other_branch != nullptr &&
+           branch.prefix() == other_branch->prefix() &&
+           branch.branching_bit() == other_branch->branching_bit() &&
+           branch.left_tree() == other_branch->left_tree() &&
+           branch.right_tree() == other_branch->right_tree();
+  }
+
+  static constexpr size_t kNumShards = 64;
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_multimap<size_t, const NodeType*> nodes;
+  };
+  Shard m_shards[kNumShards];
+};
+
 // Advances over each leaf in the tree in post-order.
 //
 // This is the central core that iterators use to iterate,
@@ -703,6 +886,9 @@ inline bool is_tree_equal(
     return true;
   } else if (tree1 == nullptr || tree2 == nullptr) {
     return false;
+  } else if (tree1->is_hash_consed() && tree2->is_hash_consed()) {
+    // Equal hash-consed trees are the same node.
+    return false;
   }
   const auto* leaf1 = tree1->as_leaf();
   const auto* leaf2 = tree2->as_leaf();
@@ -1485,4 +1671,17 @@ class PatriciaTreeCore {
 
 } // namespace pt_core
 
+/*
+ * Turns hash-consing of Patricia tree nodes on or off for the whole process
+ * (see `pt_core::hash_consing_flag`). This only affects nodes created from then
+ * on, so it is best called once, before any analysis runs.
+ */
+inline void set_patricia_tree_hash_consing(bool enabled) {
+  pt_core::hash_consing_flag().store(enabled, std::memory_order_relaxed);
+}
+
+inline bool patricia_tree_hash_consing() {
+  return pt_core::hash_consing_flag().load(std::memory_order_relaxed);
+}
+
 } // namespace sparta
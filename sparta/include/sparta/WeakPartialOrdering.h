@@ -195,7 +195,7 @@ class WeakPartialOrdering final {
   uint32_t size() const { return m_nodes.size(); }
 
   // Entry node of this wpo.
-  WpoIdx get_entry() { return m_nodes.size() - 1; }
+  WpoIdx get_entry() const { return m_nodes.size() - 1; }
 
   // Successors of the node.
   const std::set<WpoIdx>& get_successors(WpoIdx idx) const {
@@ -13,7 +13,6 @@
 #include <iterator>
 #include <limits>
 #include <ostream>
-#include <stack>
 #include <unordered_map>
 #include <vector>
 
@@ -252,6 +251,14 @@ class WeakTopologicalOrdering final {
 
 namespace wto_impl {
 
+/*
+ * This is Bourdoncle's recursive algorithm, where the recursion is unfolded
+ * into an explicit stack of frames, so that the construction doesn't run out
+ * of native stack on graphs with very long paths (e.g., generated methods with
+ * tens of thousands of blocks). The successors of the nodes being explored are
+ * copied into a single scratch buffer shared by all frames, rather than into
+ * per-node containers.
+ */
 template <typename NodeId, typename NodeHash, typename SuccFn>
 class WtoBuilder final {
  public:
@@ -262,59 +269,110 @@ class WtoBuilder final {
         m_num(0) {}
 
   void build(const NodeId& root) {
-    int32_t partition = -1;
-    visit(root, &partition);
+    m_partitions.push_back(-1);
+    visit(root, /* partition */ 0);
+    run();
   }
 
+ private:
   // We keep the notations used by Bourdoncle in the paper to describe the
-  // algorithm.
-
-  uint32_t visit(const NodeId& vertex, int32_t* partition) {
-    m_stack.push(vertex);
+  // algorithm. A frame is either a call to `visit`, or, once the vertex has
+  // been identified as the head of a component, the subsequent call to
+  // `component`.
+  struct Frame {
+    NodeId vertex;
+    // The successors of the vertex are m_succs[succ_begin, succ_end).
+    size_t succ_begin;
+    size_t succ_end;
+    size_t next_succ;
+    // Index into m_partitions of the partition passed to `visit`.
+    size_t partition;
+    // Index into m_partitions of the local partition of `component`.
+    size_t component_partition;
+    uint32_t head;
+    bool loop;
+    bool in_component;
+  };
+
+  void visit(const NodeId& vertex, size_t partition) {
+    m_stack.push_back(vertex);
     uint32_t head = set_dfn(vertex, ++m_num);
-    bool loop = false;
+    size_t succ_begin = m_succs.size();
     for (const NodeId& succ : m_successors(vertex)) {
-      uint32_t succ_dfn = get_dfn(succ);
-      uint32_t min;
-      if (succ_dfn == 0) {
-        min = visit(succ, partition);
-      } else {
-        min = succ_dfn;
-      };
-      if (min <= head) {
-        head = min;
-        loop = true;
-      }
+      m_succs.push_back(succ);
     }
-    if (head == get_dfn(vertex)) {
-      // We encode the special value +oo used in the paper with UINT32_MAX.
-      set_dfn(vertex, std::numeric_limits<uint32_t>::max());
-      NodeId element = m_stack.top();
-      m_stack.pop();
-      if (loop) {
-        // Nodes are required to be comparable using `operator==()`. We don't
-        // assume `operator!=()` to be defined on nodes.
-        while (!(element == vertex)) {
-          set_dfn(element, 0);
-          element = m_stack.top();
-          m_stack.pop();
+    m_frames.push_back(Frame{vertex, succ_begin, m_succs.size(), succ_begin,
+                             partition, 0, head, /* loop */ false,
+                             /* in_component */ false});
+  }
+
+  void run() {
+    while (!m_frames.empty()) {
+      Frame& frame = m_frames.back();
+      if (frame.next_succ != frame.succ_end) {
+        // Copy the successor, since visiting it may grow the buffer.
+        NodeId succ = m_succs[frame.next_succ++];
+        uint32_t succ_dfn = get_dfn(succ);
+        if (frame.in_component) {
+          if (succ_dfn == 0) {
+            visit(succ, frame.component_partition);
+          }
+        } else if (succ_dfn == 0) {
+          visit(succ, frame.partition);
+        } else if (succ_dfn <= frame.head) {
+          frame.head = succ_dfn;
+          frame.loop = true;
+        }
+        continue;
+      }
+      if (!frame.in_component && frame.head == get_dfn(frame.vertex)) {
+        // We encode the special value +oo used in the paper with UINT32_MAX.
+        set_dfn(frame.vertex, std::numeric_limits<uint32_t>::max());
+        NodeId element = m_stack.back();
+        m_stack.pop_back();
+        if (frame.loop) {
+          // Nodes are required to be comparable using `operator==()`. We don't
+          // assume `operator!=()` to be defined on nodes.
+          while (!(element == frame.vertex)) {
+            set_dfn(element, 0);
+            element = m_stack.back();
+            m_stack.pop_back();
+          }
+          // Explore the component, starting over from the successors of the
+          // head.
+          frame.in_component = true;
+          frame.next_succ = frame.succ_begin;
+          frame.component_partition = m_partitions.size();
+          m_partitions.push_back(m_partitions[frame.partition]);
+          continue;
+        }
+        add_component(frame, WtoComponent<NodeId>::Kind::Vertex);
+      } else if (frame.in_component) {
+        SPARTA_RUNTIME_CHECK(
+            frame.component_partition + 1 == m_partitions.size(),
+            internal_error());
+        m_partitions.pop_back();
+        add_component(frame, WtoComponent<NodeId>::Kind::Scc);
+      }
+      // Return from the call to `visit`.
+      uint32_t head = frame.head;
+      m_succs.resize(frame.succ_begin);
+      m_frames.pop_back();
+      if (!m_frames.empty()) {
+        Frame& caller = m_frames.back();
+        if (!caller.in_component && head <= caller.head) {
+          caller.head = head;
+          caller.loop = true;
         }
-        push_component(vertex, *partition);
       }
-      auto kind = loop ? WtoComponent<NodeId>::Kind::Scc
-                       : WtoComponent<NodeId>::Kind::Vertex;
-      m_wto_space->emplace_back(vertex, kind, m_free_position, *partition);
-      *partition = m_free_position++;
     }
-    return head;
   }
 
-  void push_component(const NodeId& vertex, int32_t partition) {
-    for (const NodeId& succ : m_successors(vertex)) {
-      if (get_dfn(succ) == 0) {
-        visit(succ, &partition);
-      }
-    }
+  void add_component(const Frame& frame,
+                     typename WtoComponent<NodeId>::Kind kind) {
+    int32_t& partition = m_partitions[frame.partition];
+    m_wto_space->emplace_back(frame.vertex, kind, m_free_position, partition);
+    partition = m_free_position++;
   }
 
   uint32_t get_dfn(const NodeId& node) {
@@ -340,8 +398,13 @@ class WtoBuilder final {
   int32_t m_free_position;
   // These are auxiliary data structures used by Bourdoncle's algorithm.
   std::unordered_map<NodeId, uint32_t, NodeHash> m_dfn;
-  std::stack<NodeId> m_stack;
+  std::vector<NodeId> m_stack;
   uint32_t m_num;
+  // The explicit call stack, the successor buffer shared by its frames, and
+  // the partition variables of the frames.
+  std::vector<Frame> m_frames;
+  std::vector<NodeId> m_succs;
+  std::vector<int32_t> m_partitions;
 };
 
 } // namespace wto_impl
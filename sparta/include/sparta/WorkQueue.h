@@ -13,11 +13,13 @@
 #include <chrono>
 #include <condition_variable>
 #include <exception>
+#include <limits>
 #include <mutex>
 #include <numeric>
 #include <random>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <sparta/Arity.h>
 #include <sparta/Exceptions.h>
@@ -245,6 +247,11 @@ class WorkQueue {
   workqueue_impl::StateCounters m_state_counters;
   const bool m_can_push_task{false};
   AsyncRunner* m_async_runner;
+  std::vector<std::pair<Input, uint64_t>> m_weighted_tasks;
+  std::chrono::steady_clock::duration m_last_run_tail{};
+
+  // Distribute the weighted items over the workers (see `add_weighted_item`).
+  void distribute_weighted_tasks();
 
   // Run the worker on m_num_threads many threads, and wait for them to finish.
   template <typename Worker>
@@ -275,11 +282,31 @@ class WorkQueue {
   /* Add an item on the queue of the given worker. */
   void add_item(Input task, size_t worker_id);
 
+  /*
+   * Adds an item with a cost hint (any measure of the expected work, e.g. the
+   * number of instructions to process). Before running, weighted items are
+   * distributed over the workers such that the most expensive ones get
+   * scheduled first and every worker gets a similar total cost, so that few
+   * large items don't end up being processed last while other threads are
+   * already idle. Weighted items are scheduled after any items added via
+   * `add_item`.
+   */
+  void add_weighted_item(Input task, uint64_t cost);
+
   /**
    * Spawn threads and evaluate function.  This method blocks.
    */
   void run_all();
 
+  /*
+   * The time between the first worker running out of work and the last
+   * worker finishing during the last `run_all`, i.e. how long the available
+   * parallelism was not fully used at the end.
+   */
+  std::chrono::steady_clock::duration last_run_tail() const {
+    return m_last_run_tail;
+  }
+
   template <class>
   friend class WorkerState;
 };
@@ -316,12 +343,63 @@ void WorkQueue<Input, Executor>::add_item(Input task, size_t worker_id) {
   m_states[worker_id]->m_initial_tasks.push_back(std::move(task));
 }
 
+template <class Input, typename Executor>
+void WorkQueue<Input, Executor>::add_weighted_item(Input task, uint64_t cost) {
+  m_weighted_tasks.emplace_back(std::move(task), cost);
+}
+
+/*
+ * Longest-processing-time-first scheduling: Visit the items by decreasing cost,
+ * and assign each to the worker with the smallest total cost so far. As a
+ * result, each worker's queue is ordered by decreasing cost, and as workers
+ * pop (and steal) items from the front, the most expensive items are started
+ * first.
+ */
+template <class Input, typename Executor>
+void WorkQueue<Input, Executor>::distribute_weighted_tasks() {
+  if (m_weighted_tasks.empty()) {
+    return;
+  }
+  // We sort indices, as Input is not required to be assignable.
+  std::vector<size_t> order(m_weighted_tasks.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return m_weighted_tasks[a].second > m_weighted_tasks[b].second;
+  });
+  using Load = std::pair<uint64_t, size_t>;
+  std::vector<Load> loads;
+  loads.reserve(m_num_threads);
+  for (size_t i = 0; i < m_num_threads; ++i) {
+    loads.emplace_back(0, i);
+  }
+  // A min-heap, with ties broken by the worker id, for determinism.
+  auto cmp = [](const Load& a, const Load& b) { return a > b; };
+  for (auto idx : order) {
+    auto& [task, cost] = m_weighted_tasks[idx];
+    std::pop_heap(loads.begin(), loads.end(), cmp);
+    auto& load = loads.back();
+    m_states[load.second]->m_initial_tasks.push_back(std::move(task));
+    load.first += cost;
+    std::push_heap(loads.begin(), loads.end(), cmp);
+  }
+  m_weighted_tasks.clear();
+}
+
 /*
  * Each worker thread pulls from its own queue first, and then once finished
  * looks randomly at other queues to try and steal work.
  */
 template <class Input, typename Executor>
 void WorkQueue<Input, Executor>::run_all() {
+  distribute_weighted_tasks();
+  using clock = std::chrono::steady_clock;
+  std::atomic<clock::rep> first_idle{std::numeric_limits<clock::rep>::max()};
+  auto record_idle = [&first_idle]() {
+    auto now = clock::now().time_since_epoch().count();
+    auto prev = first_idle.load(std::memory_order_relaxed);
+    while (now < prev && !first_idle.compare_exchange_weak(prev, now)) {
+    }
+  };
   m_state_counters.num_non_empty_initial.store(0, std::memory_order_relaxed);
   m_state_counters.num_non_empty_additional.store(0, std::memory_order_relaxed);
   m_state_counters.num_running.store(0, std::memory_order_relaxed);
@@ -351,6 +429,7 @@ void WorkQueue<Input, Executor>::run_all() {
         if (!m_can_push_task) {
           // New tasks can't be added. We don't need to wait for the currently
           // running jobs to finish.
+          record_idle();
           return;
         }
 
@@ -361,6 +440,7 @@ void WorkQueue<Input, Executor>::run_all() {
             m_state_counters.num_non_empty_additional.load() == 0) {
           // Wake up everyone who might be waiting, so they can quit.
           m_state_counters.waiter->give(m_state_counters.num_all);
+          record_idle();
           return;
         }
 
@@ -401,6 +481,10 @@ void WorkQueue<Input, Executor>::run_all() {
 
   run_in_parallel(worker);
 
+  auto end = clock::now().time_since_epoch().count();
+  auto idle = first_idle.load();
+  m_last_run_tail = clock::duration(idle < end ? end - idle : 0);
+
   for (size_t i = 0; i < m_num_threads; ++i) {
     SPARTA_RUNTIME_CHECK(!m_states[i]->m_running, internal_error());
   }
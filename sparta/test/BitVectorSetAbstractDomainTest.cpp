@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sparta/BitVectorSetAbstractDomain.h>
+
+#include <cstdint>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+
+using namespace sparta;
+
+using Set = BitVectorSet<uint16_t>;
+using Domain = BitVectorSetAbstractDomain<uint16_t>;
+
+TEST(BitVectorSetTest, setOperations) {
+  Set s1{1, 63, 64, 300};
+  EXPECT_EQ(4, s1.size());
+  EXPECT_THAT(std::vector<uint16_t>(s1.begin(), s1.end()),
+              ::testing::ElementsAre(1, 63, 64, 300));
+  EXPECT_TRUE(s1.contains(300));
+  EXPECT_FALSE(s1.contains(299));
+  EXPECT_FALSE(s1.contains(10000));
+
+  // Removing the largest element shrinks the vector back, so equality does
+  // not depend on the history of the set.
+  Set s2{1, 63, 64};
+  EXPECT_NE(s1, s2);
+  s1.remove(300);
+  EXPECT_EQ(s1, s2);
+  s1.remove(1).remove(63).remove(64);
+  EXPECT_TRUE(s1.empty());
+  EXPECT_EQ(s1, Set());
+
+  // Large enough to go through the vectorized loops.
+  Set a, b;
+  for (uint16_t i = 0; i < 1000; i += 3) {
+    a.insert(i);
+  }
+  for (uint16_t i = 0; i < 2000; i += 2) {
+    b.insert(i);
+  }
+  auto u = a;
+  u.union_with(b);
+  auto n = a;
+  n.intersection_with(b);
+  auto d = a;
+  d.difference_with(b);
+  for (uint16_t i = 0; i < 2100; ++i) {
+    bool in_a = i < 1000 && i % 3 == 0;
+    bool in_b = i < 2000 && i % 2 == 0;
+    EXPECT_EQ(in_a || in_b, u.contains(i)) << i;
+    EXPECT_EQ(in_a && in_b, n.contains(i)) << i;
+    EXPECT_EQ(in_a && !in_b, d.contains(i)) << i;
+  }
+  EXPECT_TRUE(n.is_subset_of(a));
+  EXPECT_TRUE(n.is_subset_of(b));
+  EXPECT_TRUE(a.is_subset_of(u));
+  EXPECT_FALSE(a.is_subset_of(b));
+  EXPECT_FALSE(u.is_subset_of(a));
+  EXPECT_TRUE(d.is_subset_of(a));
+  d.intersection_with(b);
+  EXPECT_TRUE(d.empty());
+}
+
+TEST(BitVectorSetAbstractDomainTest, latticeOperations) {
+  Domain e1{1};
+  Domain e2{1, 2, 3};
+  Domain e3{2, 3, 200};
+  EXPECT_THAT(e1.elements(), ::testing::ElementsAre(1));
+  EXPECT_THAT(e2.elements(), ::testing::ElementsAre(1, 2, 3));
+  EXPECT_THAT(e3.elements(), ::testing::ElementsAre(2, 3, 200));
+
+  std::ostringstream out;
+  out << e2;
+  EXPECT_EQ("[#3]{1, 2, 3}", out.str());
+
+  EXPECT_TRUE(Domain::bottom().leq(Domain::top()));
+  EXPECT_FALSE(Domain::top().leq(Domain::bottom()));
+  EXPECT_TRUE(Domain().leq(e1));
+  EXPECT_TRUE(e1.leq(e2));
+  EXPECT_FALSE(e1.leq(e3));
+  EXPECT_FALSE(e3.leq(e2));
+  EXPECT_TRUE(e2.equals(Domain{3, 2, 1}));
+  EXPECT_FALSE(e2.equals(e3));
+
+  EXPECT_THAT(e2.join(e3).elements(), ::testing::ElementsAre(1, 2, 3, 200));
+  EXPECT_TRUE(e2.join(Domain::bottom()).equals(e2));
+  EXPECT_TRUE(e2.join(Domain::top()).is_top());
+  EXPECT_THAT(e2.meet(e3).elements(), ::testing::ElementsAre(2, 3));
+  EXPECT_TRUE(e3.meet(e1).elements().empty());
+  EXPECT_TRUE(e2.meet(Domain::bottom()).is_bottom());
+  EXPECT_TRUE(e2.meet(Domain::top()).equals(e2));
+
+  e3.remove(200);
+  EXPECT_TRUE(e3.leq(e2));
+  e3.difference_with(e2);
+  EXPECT_TRUE(e3.is_value());
+  EXPECT_TRUE(e3.elements().empty());
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <sparta/DenseIndexMapAbstractEnvironment.h>
+#include <sparta/HashedSetAbstractDomain.h>
+#include <sparta/PatriciaTreeMap.h>
+#include <sparta/PatriciaTreeMapAbstractEnvironment.h>
+
+#include <cstdint>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <sstream>
+
+using namespace sparta;
+
+using Domain = HashedSetAbstractDomain<std::string>;
+// A small dense limit, so that the random tests exercise the sparse part.
+using Map = DenseIndexMap<uint32_t, Domain, TopValueInterface<Domain>, 32>;
+using Environment = AbstractEnvironment<Map>;
+using ReferenceEnvironment =
+    PatriciaTreeMapAbstractEnvironment<uint32_t, Domain>;
+
+using UIntMap = DenseIndexMap<uint32_t, uint32_t>;
+
+class DenseIndexMapAbstractEnvironmentTest : public ::testing::Test {
+ protected:
+  DenseIndexMapAbstractEnvironmentTest()
+      : m_generator(0),
+        m_size_dist(0, 40),
+        m_key_dist(0, 48),
+        m_elem_dist(0, 3) {}
+
+  // Returns the same environment in both representations.
+  std::pair<Environment, ReferenceEnvironment> generate_random_environments() {
+    Environment env;
+    ReferenceEnvironment ref;
+    size_t size = m_size_dist(m_generator);
+    for (size_t i = 0; i < size; ++i) {
+      auto key = m_key_dist(m_generator);
+      Domain value;
+      for (size_t j = 0, n = m_elem_dist(m_generator) + 1; j < n; ++j) {
+        value.add(std::to_string(m_elem_dist(m_generator)));
+      }
+      env.set(key, value);
+      ref.set(key, value);
+    }
+    return {env, ref};
+  }
+
+  std::mt19937 m_generator;
+  std::uniform_int_distribution<uint32_t> m_size_dist;
+  std::uniform_int_distribution<uint32_t> m_key_dist;
+  std::uniform_int_distribution<uint32_t> m_elem_dist;
+};
+
+static std::map<uint32_t, Domain> bindings_of(const Environment& env) {
+  return std::map<uint32_t, Domain>(env.bindings().begin(),
+                                    env.bindings().end());
+}
+
+static std::map<uint32_t, Domain> bindings_of(const ReferenceEnvironment& env) {
+  return std::map<uint32_t, Domain>(env.bindings().begin(),
+                                    env.bindings().end());
+}
+
+static void expect_same(const Environment& env,
+                        const ReferenceEnvironment& ref) {
+  ASSERT_EQ(env.kind(), ref.kind());
+  if (env.is_value()) {
+    EXPECT_EQ(env.size(), ref.size());
+    EXPECT_EQ(bindings_of(env), bindings_of(ref));
+  }
+}
+
+TEST_F(DenseIndexMapAbstractEnvironmentTest, mapOperations) {
+  UIntMap m;
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.begin(), m.end());
+  EXPECT_EQ(m.at(3), 0);
+
+  m.insert_or_assign(3, 30).insert_or_assign(1, 10).insert_or_assign(
+      std::numeric_limits<uint32_t>::max(), 42);
+  EXPECT_EQ(m.size(), 3);
+  EXPECT_EQ(m.at(1), 10);
+  EXPECT_EQ(m.at(3), 30);
+  EXPECT_EQ(m.at(std::numeric_limits<uint32_t>::max()), 42);
+  std::vector<std::pair<uint32_t, uint32_t>> bindings(m.begin(), m.end());
+  EXPECT_THAT(bindings,
+              ::testing::ElementsAre(
+                  std::make_pair(1u, 10u), std::make_pair(3u, 30u),
+                  std::make_pair(std::numeric_limits<uint32_t>::max(), 42u)));
+
+  // Copies share their storage until one of them is written to.
+  UIntMap copy = m;
+  EXPECT_TRUE(copy.reference_equals(m));
+  copy.update([](uint32_t x) { return x + 1; }, 3);
+  EXPECT_FALSE(copy.reference_equals(m));
+  EXPECT_EQ(m.at(3), 30);
+  EXPECT_EQ(copy.at(3), 31);
+
+  // Binding the default value removes the binding.
+  copy.insert_or_assign(3, 0);
+  EXPECT_EQ(copy.size(), 2);
+  copy.remove(1).remove(std::numeric_limits<uint32_t>::max());
+  EXPECT_TRUE(copy.empty());
+  EXPECT_TRUE(copy.equals(UIntMap()));
+
+  EXPECT_TRUE(m.erase_all_matching(2));
+  EXPECT_EQ(m.size(), 1);
+  EXPECT_EQ(m.at(1), 10);
+  EXPECT_FALSE(m.erase_all_matching(2));
+
+  std::ostringstream out;
+  out << UIntMap{{1, 2}, {4, 5}};
+  EXPECT_EQ(out.str(), "{1 -> 2, 4 -> 5}");
+}
+
+TEST_F(DenseIndexMapAbstractEnvironmentTest, latticeOperations) {
+  for (size_t k = 0; k < 300; ++k) {
+    auto [e1, r1] = generate_random_environments();
+    auto [e2, r2] = generate_random_environments();
+    expect_same(e1, r1);
+
+    EXPECT_EQ(e1.leq(e2), r1.leq(r2));
+    EXPECT_EQ(e1.equals(e2), r1.equals(r2));
+    EXPECT_TRUE(e1.leq(e1.join(e2)));
+    EXPECT_TRUE(e1.meet(e2).leq(e1));
+
+    expect_same(e1.join(e2), r1.join(r2));
+    expect_same(e1.widening(e2), r1.widening(r2));
+    expect_same(e1.meet(e2), r1.meet(r2));
+    expect_same(e1.narrowing(e2), r1.narrowing(r2));
+
+    auto key = m_key_dist(m_generator);
+    auto value = e2.get(key);
+    e1.update(key, [&](const Domain& x) { return x.join(value); });
+    r1.update(key, [&](const Domain& x) { return x.join(value); });
+    expect_same(e1, r1);
+
+    auto keep_even = [](uint32_t key, const Domain&) { return key % 2 == 0; };
+    auto filtered = e1.is_value() ? Map(e1.bindings()).filter(keep_even)
+                                  : Map();
+    auto ref_filtered = r1.is_value()
+                            ? ReferenceEnvironment::MapType(r1.bindings())
+                                  .filter(keep_even)
+                            : ReferenceEnvironment::MapType();
+    EXPECT_EQ(filtered.size(), ref_filtered.size());
+
+    auto mask = m_key_dist(m_generator);
+    EXPECT_EQ(e1.erase_all_matching(mask), r1.erase_all_matching(mask));
+    expect_same(e1, r1);
+  }
+}
+
+TEST_F(DenseIndexMapAbstractEnvironmentTest, combiningOperations) {
+  using SmallUIntMap = DenseIndexMap<uint32_t, uint32_t,
+                                     pt_core::SimpleValue<uint32_t>, 16>;
+  using ReferenceMap = PatriciaTreeMap<uint32_t, uint32_t>;
+  auto generate = [&]() {
+    std::pair<SmallUIntMap, ReferenceMap> maps;
+    for (size_t i = 0, size = m_size_dist(m_generator); i < size; ++i) {
+      auto key = m_key_dist(m_generator);
+      auto value = m_elem_dist(m_generator);
+      maps.first.insert_or_assign(key, value);
+      maps.second.insert_or_assign(key, value);
+    }
+    return maps;
+  };
+  auto same = [](const SmallUIntMap& m, const ReferenceMap& r) {
+    return std::map<uint32_t, uint32_t>(m.begin(), m.end()) ==
+           std::map<uint32_t, uint32_t>(r.begin(), r.end());
+  };
+  // Subtraction saturates at 0, the default value, which removes the binding.
+  auto minus = [](uint32_t x, uint32_t y) { return x > y ? x - y : 0; };
+  auto plus = [](uint32_t x, uint32_t y) { return x + y; };
+  auto min = [](uint32_t x, uint32_t y) { return std::min(x, y); };
+  for (size_t k = 0; k < 300; ++k) {
+    auto [m1, r1] = generate();
+    auto [m2, r2] = generate();
+    EXPECT_TRUE(same(m1, r1));
+    EXPECT_EQ(m1.size(), r1.size());
+    EXPECT_EQ(m1.equals(m2), r1.equals(r2));
+    EXPECT_TRUE(same(SmallUIntMap(m1).union_with(plus, m2),
+                     ReferenceMap(r1).union_with(plus, r2)));
+    EXPECT_TRUE(same(SmallUIntMap(m1).intersection_with(min, m2),
+                     ReferenceMap(r1).intersection_with(min, r2)));
+    EXPECT_TRUE(same(SmallUIntMap(m1).difference_with(minus, m2),
+                     ReferenceMap(r1).difference_with(minus, r2)));
+    auto decrement = [](uint32_t x) { return x - 1; };
+    EXPECT_EQ(m1.transform(decrement), r1.transform(decrement));
+    EXPECT_TRUE(same(m1, r1));
+  }
+}
+
+TEST_F(DenseIndexMapAbstractEnvironmentTest, bottomAndTop) {
+  Environment env;
+  EXPECT_TRUE(env.is_top());
+  env.set(1, Domain({"a"}));
+  EXPECT_TRUE(env.is_value());
+  env.set(2, Domain::bottom());
+  EXPECT_TRUE(env.is_bottom());
+  EXPECT_TRUE(env.get(1).is_bottom());
+
+  env = Environment({{1, Domain({"a"})}, {100, Domain({"b"})}});
+  env.set(1, Domain::top());
+  env.set(100, Domain::top());
+  EXPECT_TRUE(env.is_top());
+}
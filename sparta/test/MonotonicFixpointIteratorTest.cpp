@@ -21,6 +21,23 @@
 
 #include <boost/functional/hash.hpp>
 
+/*
+ * A MonotonicFixpointIterator with a thread budget, which makes it switch to
+ * the concurrent algorithm.
+ */
+template <typename GraphInterface, typename Domain, typename NodeHash>
+class ThreadedMonotonicFixpointIterator
+    : public sparta::
+          MonotonicFixpointIterator<GraphInterface, Domain, NodeHash> {
+ public:
+  explicit ThreadedMonotonicFixpointIterator(
+      const typename GraphInterface::Graph& graph)
+      : sparta::MonotonicFixpointIterator<GraphInterface, Domain, NodeHash>(
+            graph) {
+    this->set_num_threads(4);
+  }
+};
+
 namespace liveness {
 
 using namespace sparta;
@@ -299,7 +316,8 @@ class MonotonicFixpointIteratorLivenessTest : public ::testing::Test {
 using LivenessFixpoints = ::testing::Types<
     liveness::FixpointEngine<sparta::WTOMonotonicFixpointIterator>,
     liveness::FixpointEngine<sparta::MonotonicFixpointIterator>,
-    liveness::FixpointEngine<sparta::ParallelMonotonicFixpointIterator>>;
+    liveness::FixpointEngine<sparta::ParallelMonotonicFixpointIterator>,
+    liveness::FixpointEngine<ThreadedMonotonicFixpointIterator>>;
 TYPED_TEST_CASE(MonotonicFixpointIteratorLivenessTest, LivenessFixpoints);
 
 TYPED_TEST(MonotonicFixpointIteratorLivenessTest, program1) {
@@ -463,6 +481,62 @@ TYPED_TEST(MonotonicFixpointIteratorLivenessTest, program3) {
               ::testing::UnorderedElementsAre("z", "c", "b", "y"));
 }
 
+/*
+ * Editing program1 and updating the invariants in place must give the same
+ * result as running the fixpoint iteration on the edited program from scratch.
+ */
+TEST(MonotonicFixpointIteratorUpdateTest, programEdits) {
+  using namespace liveness;
+  using Engine = FixpointEngine<sparta::MonotonicFixpointIterator>;
+  Program program(1);
+  program.add(1, Statement(/* use: */ {}, /* def: */ {"a"}));
+  program.add(2, Statement(/* use: */ {"a"}, /* def: */ {"b"}));
+  program.add(3, Statement(/* use: */ {"c", "b"}, /* def: */ {"c"}));
+  program.add(4, Statement(/* use: */ {"b"}, /* def: */ {"a"}));
+  program.add(5, Statement(/* use: */ {"a"}, /* def: */ {}));
+  program.add(6, Statement(/* use: */ {"c"}, /* def: */ {}));
+  program.add_edge(1, 2);
+  program.add_edge(2, 3);
+  program.add_edge(3, 4);
+  program.add_edge(4, 5);
+  program.add_edge(5, 6);
+  program.add_edge(5, 2);
+  program.set_exit(6);
+
+  Engine fp(program);
+  fp.run(LivenessDomain());
+  auto expect_same_as_fresh_run = [&]() {
+    Engine fresh(program);
+    fresh.run(LivenessDomain());
+    for (uint32_t node = 1; node <= 7; ++node) {
+      EXPECT_TRUE(fp.get_live_in_vars_at(node).equals(
+          fresh.get_live_in_vars_at(node)))
+          << node;
+      EXPECT_TRUE(fp.get_live_out_vars_at(node).equals(
+          fresh.get_live_out_vars_at(node)))
+          << node;
+    }
+  };
+
+  // 3: c = b; the variable c is not live around the loop anymore, so the
+  // invariants have to shrink.
+  program.add(3, Statement(/* use: */ {"b"}, /* def: */ {"c"}));
+  fp.update(LivenessDomain(), {3});
+  expect_same_as_fresh_run();
+  EXPECT_THAT(fp.get_live_in_vars_at(2).elements(),
+              ::testing::UnorderedElementsAre("a"));
+  EXPECT_TRUE(fp.get_live_in_vars_at(1).elements().empty());
+
+  // A new node on a new path from 1 to 6.
+  program.add(7, Statement(/* use: */ {"d"}, /* def: */ {"c"}));
+  program.add_edge(1, 7);
+  program.add_edge(7, 6);
+  fp.update(LivenessDomain(), {1, 6, 7});
+  expect_same_as_fresh_run();
+  EXPECT_THAT(fp.get_live_in_vars_at(1).elements(),
+              ::testing::UnorderedElementsAre("d"));
+}
+
 namespace numerical {
 
 using namespace sparta;
@@ -759,7 +833,8 @@ class MonotonicFixpointIteratorNumericalTest : public ::testing::Test {};
 using NumericalFixpoints = ::testing::Types<
     numerical::FixpointEngine<sparta::WTOMonotonicFixpointIterator>,
     numerical::FixpointEngine<sparta::MonotonicFixpointIterator>,
-    numerical::FixpointEngine<sparta::ParallelMonotonicFixpointIterator>>;
+    numerical::FixpointEngine<sparta::ParallelMonotonicFixpointIterator>,
+    numerical::FixpointEngine<ThreadedMonotonicFixpointIterator>>;
 TYPED_TEST_CASE(MonotonicFixpointIteratorNumericalTest, NumericalFixpoints);
 
 TYPED_TEST(MonotonicFixpointIteratorNumericalTest, program1) {
@@ -6,10 +6,13 @@
  */
 
 #include <sparta/PatriciaTreeCore.h>
+#include <sparta/PatriciaTreeSet.h>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 using namespace sparta;
 
@@ -45,3 +48,54 @@ TEST(PatriciaTreeCoreTest, nodeSizes) {
   // The branch node is bigger for the empty value, for the hash.
   EXPECT_GT(sizeof(PatriciaTreeBranchEmpty), sizeof(PatriciaTreeBranch));
 }
+
+TEST(PatriciaTreeCoreTest, hashConsedSets) {
+  using Set = PatriciaTreeSet<uint32_t>;
+  using Table =
+      pt_core::HashConsingTable<Set::IntegerType, pt_core::EmptyValue>;
+  set_patricia_tree_hash_consing(true);
+  {
+    Set s1{1, 2, 3, 42};
+    Set s2{42, 3};
+    s2.insert(2);
+    s2.insert(1);
+    // Built differently, but the same nodes.
+    EXPECT_TRUE(s1.reference_equals(s2));
+    EXPECT_TRUE(s1.equals(s2));
+
+    Set s3{1, 2, 3};
+    EXPECT_FALSE(s1.reference_equals(s3));
+    EXPECT_FALSE(s1.equals(s3));
+    s3.insert(42);
+    EXPECT_TRUE(s1.reference_equals(s3));
+  }
+  // Nodes leave the table once unreferenced.
+  EXPECT_EQ(Table::get().size(), 0);
+
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < 4; ++t) {
+    threads.emplace_back([]() {
+      for (uint32_t i = 0; i < 1000; ++i) {
+        Set s;
+        for (uint32_t j = 0; j < 16; ++j) {
+          s.insert((i * 7 + j) % 64);
+        }
+        Set t{s};
+        t.remove((i * 7) % 64);
+        t.insert((i * 7) % 64);
+        EXPECT_TRUE(s.reference_equals(t));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(Table::get().size(), 0);
+  set_patricia_tree_hash_consing(false);
+
+  // Trees built without hash-consing are still compared structurally.
+  Set s4{1, 2, 3, 42};
+  Set s5{42, 3, 2, 1};
+  EXPECT_FALSE(s4.reference_equals(s5));
+  EXPECT_TRUE(s4.equals(s5));
+}
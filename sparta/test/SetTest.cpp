@@ -178,6 +178,12 @@ TYPED_TEST(UInt32SetTest, basicOperations) {
   TypeParam d43 = t4.get_difference_with(t3);
   EXPECT_THAT(d43,
               ::testing::UnorderedElementsAre(0, 1, 5, 101, 8137, 1234567));
+
+  // Removing adjacent elements.
+  TypeParam d44 = t4;
+  d44.difference_with(TypeParam({1, 2, 5}));
+  EXPECT_THAT(d44, ::testing::UnorderedElementsAre(0, 101, 4096, 8137, 1234567,
+                                                   bigint));
 }
 
 TYPED_TEST(UInt32SetTest, robustness) {
@@ -251,3 +251,35 @@ TEST(WeakTopologicalOrderingTest, InvalidIteratorDeref) {
   EXPECT_ANY_THROW(wto.end()->head_node());
   EXPECT_ANY_THROW(wto.end()++);
 }
+
+TEST(WeakTopologicalOrderingTest, LongPath) {
+  // A long path looping back to its start, followed by a node outside of the
+  // loop. The construction must not use stack space proportional to the
+  // length of the path.
+  const uint32_t length = 200000;
+  auto successors = [length](const uint32_t& n) {
+    std::vector<uint32_t> succs;
+    if (n < length - 1) {
+      succs.push_back(n + 1);
+    } else if (n == length - 1) {
+      succs.push_back(0);
+      succs.push_back(length);
+    }
+    return succs;
+  };
+  WeakTopologicalOrdering<uint32_t> wto(0, successors);
+
+  auto it = wto.begin();
+  ASSERT_TRUE(it->is_scc());
+  EXPECT_EQ(0, it->head_node());
+  uint32_t expected = 1;
+  for (const auto& sub : *it) {
+    EXPECT_TRUE(sub.is_vertex());
+    EXPECT_EQ(expected++, sub.head_node());
+  }
+  EXPECT_EQ(length, expected);
+  ++it;
+  EXPECT_EQ(length, it->head_node());
+  ++it;
+  EXPECT_EQ(it, wto.end());
+}
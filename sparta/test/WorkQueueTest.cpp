@@ -138,6 +138,48 @@ TEST(WorkQueueTest, preciseScheduling) {
   }
 }
 
+TEST(WorkQueueTest, weightedScheduling) {
+  std::array<int, NUM_INTS> array = {0};
+  std::vector<int*> order;
+
+  // With a single thread, items must be processed by decreasing cost.
+  auto process = [&](int* a) {
+    (*a)++;
+    order.push_back(a);
+  };
+  auto wq = sparta::work_queue<int*>(process, 1);
+
+  for (int idx = 0; idx < NUM_INTS; ++idx) {
+    wq.add_weighted_item(&array[idx], /* cost */ idx % 10);
+  }
+  wq.run_all();
+  for (int idx = 0; idx < NUM_INTS; ++idx) {
+    ASSERT_EQ(1, array[idx]);
+  }
+  ASSERT_EQ(NUM_INTS, order.size());
+  for (size_t i = 1; i < order.size(); ++i) {
+    auto prev_cost = (order[i - 1] - array.data()) % 10;
+    auto cost = (order[i] - array.data()) % 10;
+    EXPECT_GE(prev_cost, cost);
+  }
+}
+
+TEST(WorkQueueTest, weightedSchedulingParallel) {
+  std::array<std::atomic<int>, NUM_INTS> array{};
+
+  auto wq = sparta::work_queue<std::atomic<int>*>(
+      [](std::atomic<int>* a) { (*a)++; }, 8);
+
+  for (int idx = 0; idx < NUM_INTS; ++idx) {
+    wq.add_weighted_item(&array[idx], /* cost */ idx);
+  }
+  wq.run_all();
+  for (int idx = 0; idx < NUM_INTS; ++idx) {
+    ASSERT_EQ(1, array[idx]);
+  }
+  EXPECT_GE(wq.last_run_tail().count(), 0);
+}
+
 static void exceptionPropagation(sparta::AsyncRunner* async_runner = nullptr) {
   auto wq = sparta::work_queue<int>(
       [](int i) {
@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 
 #include "CallGraph.h"
+#include "CompactCallGraph.h"
 #include "DexClass.h"
 #include "MethodOverrideGraph.h"
 #include "RedexTest.h"
@@ -275,3 +276,45 @@ TEST_F(CallGraphTest, test_multiple_callee_graph_invoke_super) {
   EXPECT_THAT(callees,
               ::testing::UnorderedElementsAre(more_than_5_class_return_num));
 }
+
+TEST_F(CallGraphTest, test_compact_graph_matches_graph) {
+  call_graph::CompactGraph compact(*complete_graph);
+  auto stats = call_graph::get_num_nodes_edges(*complete_graph);
+  // The compact graph always has an exit node, even if nothing reaches it.
+  EXPECT_GE(compact.num_nodes(), stats.num_nodes);
+  EXPECT_LE(compact.num_nodes(), stats.num_nodes + 1);
+  EXPECT_EQ(compact.num_edges(), stats.num_edges);
+
+  for (auto* method : {clinit, calls_returns_int, base_returns_int,
+                       extended_returns_int, more_impl1_return}) {
+    ASSERT_TRUE(compact.has_node(method));
+    auto n = compact.node(method);
+    EXPECT_EQ(compact.method(n), method);
+
+    std::vector<std::pair<const DexMethod*, IRInstruction*>> expected_callees;
+    for (const auto& edge : complete_graph->node(method)->callees()) {
+      expected_callees.emplace_back(edge->callee()->method(),
+                                    edge->invoke_insn());
+    }
+    std::vector<std::pair<const DexMethod*, IRInstruction*>> callees;
+    for (auto e : compact.callees(n)) {
+      EXPECT_EQ(compact.caller(e), n);
+      callees.emplace_back(compact.method(compact.callee(e)),
+                           compact.invoke_insn(e));
+    }
+    EXPECT_THAT(callees,
+                ::testing::UnorderedElementsAreArray(expected_callees));
+
+    std::vector<const DexMethod*> expected_callers;
+    for (const auto& edge : complete_graph->node(method)->callers()) {
+      expected_callers.emplace_back(edge->caller()->method());
+    }
+    std::vector<const DexMethod*> callers;
+    for (auto e : compact.callers(n)) {
+      EXPECT_EQ(compact.callee(e), n);
+      callers.emplace_back(compact.method(compact.caller(e)));
+    }
+    EXPECT_THAT(callers,
+                ::testing::UnorderedElementsAreArray(expected_callers));
+  }
+}
@@ -635,10 +635,14 @@ class IODIEncodingTest : public IODITest {
       uint16_t klen;
       uint64_t method_id;
     };
+    std::string previous_name;
     for (uint32_t i = 0; i < hdr.count; i++) {
       const EntryHeader& entry = *p.parse<EntryHeader>();
       const char* key_c = p.parse<char>(entry.klen);
       auto name = std::string(key_c, entry.klen);
+      // Entries are sorted by key.
+      EXPECT_LT(previous_name, name);
+      previous_name = name;
       auto mid_it = iodi_mid.find(name);
       if (mid_it != iodi_mid.end()) {
         EXPECT_EQ(mid_it->second, entry.method_id);
@@ -100,6 +100,12 @@ TEST_F(MaxDepthAnalysisTest, test_results) {
       pass_manager->get_preserved_analysis<MaxDepthAnalysisPass>();
   ASSERT_NE(nullptr, preserved);
 
+  // AnalysisConsumerPass picked up the result instead of recomputing it.
+  const auto& reuse_stats = pass_manager->get_analysis_reuse_stats();
+  auto it = reuse_stats.find(get_analysis_id_by_pass<MaxDepthAnalysisPass>());
+  ASSERT_NE(it, reuse_stats.end());
+  EXPECT_EQ(it->second.reuses, 1);
+
   auto results = preserved->get_result();
 
   constexpr int total_functions = 9;
@@ -9,6 +9,7 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <fstream>
 #include <set>
 #include <sstream>
 #include <string>
@@ -348,4 +349,20 @@ TEST_F(PointsToSemanticsTest, semanticActionGeneration) {
     deserialization.insert(out.str());
   }
   EXPECT_THAT(deserialization, ::testing::ContainerEq(method_semantics));
+
+  // Testing the streaming of the semantics to a file.
+  auto tmp_dir = redex::make_tmp_dir("redex_pts_test_%%%%%%%%");
+  auto file_name = tmp_dir.path + "/semantics.sexpr";
+  {
+    std::ofstream file_output(file_name);
+    PointsToSemantics::write_method_semantics(scope, file_output);
+  }
+  std::set<std::string> streamed;
+  PointsToSemantics::read_method_semantics(
+      file_name, [&streamed](PointsToMethodSemantics&& semantics) {
+        std::ostringstream out;
+        out << semantics;
+        streamed.insert(out.str());
+      });
+  EXPECT_THAT(streamed, ::testing::ContainerEq(method_semantics));
 }
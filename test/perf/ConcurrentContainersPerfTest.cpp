@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "ConcurrentContainers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+//==========
+// Test for performance of concurrent lookups
+//==========
+
+namespace {
+
+constexpr size_t kNumKeys = 1 << 16;
+constexpr size_t kLookupsPerThread = 1 << 22;
+
+// Runs `lookup` from `num_threads` threads in parallel, and returns the
+// achieved number of lookups per microsecond.
+template <typename Fn>
+double measure(size_t num_threads, const Fn& lookup) {
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  std::vector<size_t> found(num_threads);
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      size_t res = 0;
+      size_t key = t;
+      for (size_t i = 0; i < kLookupsPerThread; ++i) {
+        key = (key * 31 + 7) % kNumKeys;
+        res += lookup(key);
+      }
+      found[t] = res;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  for (auto res : found) {
+    if (res != kLookupsPerThread) {
+      fprintf(stderr, "unexpected lookup result\n");
+      exit(1);
+    }
+  }
+  double duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+          .count();
+  return num_threads * kLookupsPerThread / duration;
+}
+
+// Repeatedly inserts and looks up fresh keys, so that lookups race with the
+// resizing of the underlying hashtables.
+double measure_with_resizing(size_t num_threads) {
+  InsertOnlyConcurrentMap<size_t, size_t> map;
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < kLookupsPerThread / 16; ++i) {
+        size_t key = i * num_threads + t;
+        map.emplace(key, key);
+        if (*map.get(key) != key) {
+          fprintf(stderr, "unexpected lookup result\n");
+          exit(1);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double duration =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+          .count();
+  return num_threads * (kLookupsPerThread / 16) / duration;
+}
+
+} // namespace
+
+int main() {
+  InsertOnlyConcurrentMap<size_t, size_t> insert_only_map;
+  ConcurrentMap<size_t, size_t> map;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    insert_only_map.emplace(i, 1);
+    map.emplace(i, 1);
+  }
+
+  printf("threads | InsertOnlyConcurrentMap::get | ConcurrentMap::get | "
+         "InsertOnlyConcurrentMap emplace+get (resizing)\n");
+  for (size_t num_threads : {1, 8, 32, 64}) {
+    double insert_only = measure(num_threads, [&](size_t key) {
+      return *insert_only_map.get(key);
+    });
+    double locked =
+        measure(num_threads, [&](size_t key) { return map.get(key, 0); });
+    double resizing = measure_with_resizing(num_threads);
+    printf("%7zu | %22.1f ops/us | %12.1f ops/us | %20.1f ops/us\n",
+           num_threads, insert_only, locked, resizing);
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "DexEncoding.h"
+
+namespace {
+
+std::vector<std::string> make_strings() {
+  return {
+      "Lcom/some/class/name;",
+      "Lcom/some/package/with/a/rather/long/name/SomeClass$Inner;",
+      "methodname",
+      "(Ljava/lang/String;ILjava/util/List;)V",
+      "A",
+      // Non-ASCII, two and three byte code points.
+      "caf\xc3\xa9 na\xc3\xafve",
+      "\xe2\x82\xac 100 and some more trailing ascii characters",
+      "mixed \xc3\xa9\xe2\x82\xac\xc3\xa9 in the middle of a longer string",
+  };
+}
+
+template <typename Fn>
+long long time_ms(const Fn& fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+      .count();
+}
+
+} // namespace
+
+TEST(DexEncodingPerfTest, LengthOfUtf8String) {
+  const int iter = 10000000;
+  auto strs = make_strings();
+  uint64_t result1 = 0;
+  uint64_t result2 = 0;
+  auto t1 = time_ms([&] {
+    for (int i = 0; i < iter; i++) {
+      for (const auto& s : strs) {
+        result1 += length_of_utf8_string(s.c_str());
+      }
+    }
+  });
+  auto t2 = time_ms([&] {
+    for (int i = 0; i < iter; i++) {
+      for (const auto& s : strs) {
+        result2 += length_of_utf8_string(s.c_str(), s.size());
+      }
+    }
+  });
+  printf("Execution time (ms) unsized: %lld sized: %lld\n", t1, t2);
+  EXPECT_EQ(result1, result2);
+}
+
+TEST(DexEncodingPerfTest, JavaHashcodeOfUtf8String) {
+  const int iter = 10000000;
+  auto strs = make_strings();
+  int64_t result1 = 0;
+  int64_t result2 = 0;
+  auto t1 = time_ms([&] {
+    for (int i = 0; i < iter; i++) {
+      for (const auto& s : strs) {
+        result1 += java_hashcode_of_utf8_string(s.c_str());
+      }
+    }
+  });
+  auto t2 = time_ms([&] {
+    for (int i = 0; i < iter; i++) {
+      for (const auto& s : strs) {
+        result2 += java_hashcode_of_utf8_string(s.c_str(), s.size());
+      }
+    }
+  });
+  printf("Execution time (ms) unsized: %lld sized: %lld\n", t1, t2);
+  EXPECT_EQ(result1, result2);
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <json/value.h>
+
+#include "ConfigFiles.h"
+#include "Creators.h"
+#include "DebugUtils.h"
+#include "DexClass.h"
+#include "DexStore.h"
+#include "IRAssembler.h"
+#include "Pass.h"
+#include "PassManager.h"
+#include "PassRegistry.h"
+#include "RedexContext.h"
+
+//==========
+// End-to-end performance of individual passes over synthetic scopes
+//==========
+//
+// Usage: pass_perf_test [--scale N] [--out FILE] [PassName...]
+//
+// Each of the given passes (or the default ones) is run on a fresh
+// RedexContext for each kind of synthetic scope. The wall time and the peak
+// RSS of each run are written as JSON to FILE, or to stdout.
+
+namespace {
+
+const std::vector<std::string> kDefaultPasses = {
+    "MethodInlinePass",
+    "RegAllocPass",
+    "CommonSubexpressionEliminationPass",
+    "InterproceduralConstantPropagationPass",
+    "InterDexPass",
+};
+
+DexClass* make_class(const std::string& name,
+                     DexType* super,
+                     DexClasses* classes) {
+  ClassCreator creator(DexType::make_type(name));
+  creator.set_super(super);
+  auto cls = creator.create();
+  classes->push_back(cls);
+  return cls;
+}
+
+void add_method(DexClass* cls,
+                const std::string& sig,
+                DexAccessFlags access,
+                bool is_virtual,
+                const std::string& code) {
+  auto method = DexMethod::make_method(sig)->make_concrete(access, is_virtual);
+  method->set_code(assembler::ircode_from_string(code));
+  cls->add_method(method);
+}
+
+// Chains of small static methods, each calling the next one.
+void make_small_methods(size_t scale, DexClasses* classes) {
+  const size_t num_classes = 500 * scale;
+  const size_t methods_per_class = 20;
+  for (size_t c = 0; c < num_classes; ++c) {
+    auto name = "LSmall" + std::to_string(c) + ";";
+    auto cls = make_class(name, type::java_lang_Object(), classes);
+    for (size_t m = 0; m < methods_per_class; ++m) {
+      std::ostringstream code;
+      code << "((load-param v0) (const v1 " << m << ")";
+      if (m + 1 < methods_per_class) {
+        code << " (invoke-static (v0) \"" << name << ".m" << (m + 1)
+             << ":(I)I\") (move-result v2) (add-int v1 v1 v2)";
+      }
+      code << " (add-int v1 v1 v0) (return v1))";
+      add_method(cls, name + ".m" + std::to_string(m) + ":(I)I",
+                 ACC_PUBLIC | ACC_STATIC, false, code.str());
+    }
+  }
+}
+
+// Large methods with many live registers, redundant computations and
+// branches.
+void make_huge_methods(size_t scale, DexClasses* classes) {
+  const size_t num_methods = 20 * scale;
+  const size_t blocks_per_method = 500;
+  const size_t num_regs = 48;
+  auto cls = make_class("LHuge;", type::java_lang_Object(), classes);
+  for (size_t m = 0; m < num_methods; ++m) {
+    std::ostringstream code;
+    code << "((load-param v" << num_regs << ")";
+    for (size_t r = 0; r < num_regs; ++r) {
+      code << " (const v" << r << " " << (r + m) << ")";
+    }
+    for (size_t b = 0; b < blocks_per_method; ++b) {
+      auto r = b % num_regs;
+      auto s = (b * 7 + 3) % num_regs;
+      code << " (add-int v" << r << " v" << r << " v" << s << ")"
+           << " (add-int v" << s << " v" << r << " v" << s << ")"
+           << " (mul-int v" << r << " v" << r << " v" << num_regs << ")"
+           << " (if-eqz v" << s << " :L" << b << ")"
+           << " (xor-int v" << s << " v" << s << " v" << r << ")"
+           << " (:L" << b << ")";
+    }
+    for (size_t r = 1; r < num_regs; ++r) {
+      code << " (add-int v0 v0 v" << r << ")";
+    }
+    code << " (return v0))";
+    add_method(cls, "LHuge;.m" + std::to_string(m) + ":(I)I",
+               ACC_PUBLIC | ACC_STATIC, false, code.str());
+  }
+}
+
+// Deep class hierarchies, each level overriding a virtual method, and a
+// caller per hierarchy invoking it on the root type.
+void make_deep_hierarchies(size_t scale, DexClasses* classes) {
+  const size_t num_hierarchies = 20 * scale;
+  const size_t depth = 40;
+  for (size_t h = 0; h < num_hierarchies; ++h) {
+    auto super = type::java_lang_Object();
+    std::string root_name;
+    for (size_t d = 0; d < depth; ++d) {
+      auto name =
+          "LDeep" + std::to_string(h) + "_" + std::to_string(d) + ";";
+      auto cls = make_class(name, super, classes);
+      add_method(cls, name + ".<init>:()V", ACC_PUBLIC | ACC_CONSTRUCTOR,
+                 false,
+                 "((load-param-object v0) (invoke-direct (v0) \"" +
+                     super->str_copy() + ".<init>:()V\") (return-void))");
+      add_method(cls, name + ".get:()I", ACC_PUBLIC, true,
+                 "((load-param-object v0) (const v1 " + std::to_string(d) +
+                     ") (return v1))");
+      if (d == 0) {
+        root_name = name;
+      }
+      super = cls->get_type();
+    }
+    auto leaf_name = super->str_copy();
+    add_method(type_class(super), leaf_name + ".call:()I",
+               ACC_PUBLIC | ACC_STATIC, false,
+               "((new-instance \"" + leaf_name +
+                   "\") (move-result-pseudo-object v0)"
+                   " (invoke-direct (v0) \"" +
+                   leaf_name + ".<init>:()V\") (invoke-virtual (v0) \"" +
+                   root_name + ".get:()I\") (move-result v1) (return v1))");
+  }
+}
+
+struct Shape {
+  std::string name;
+  std::function<void(size_t, DexClasses*)> make;
+};
+
+const std::vector<Shape> kShapes = {
+    {"small_methods", make_small_methods},
+    {"huge_methods", make_huge_methods},
+    {"deep_hierarchies", make_deep_hierarchies},
+};
+
+Pass* find_pass(const std::string& name) {
+  for (auto* pass : PassRegistry::get().get_passes()) {
+    if (pass->name() == name) {
+      return pass;
+    }
+  }
+  return nullptr;
+}
+
+// Runs the pass on a freshly generated scope and returns the measurements.
+Json::Value run(Pass* pass, const Shape& shape, size_t scale) {
+  g_redex = new RedexContext();
+  Json::Value res;
+  {
+    DexStoresVector stores;
+    DexMetadata dm;
+    dm.set_id("classes");
+    stores.emplace_back(dm);
+    DexClasses classes;
+    shape.make(scale, &classes);
+    auto num_classes = classes.size();
+    stores.back().add_classes(std::move(classes));
+
+    PassManager manager({pass});
+    manager.set_testing_mode();
+    ConfigFiles conf(Json::nullValue);
+
+    bool hwm_reset = try_reset_hwm_mem_stat();
+    auto start = std::chrono::steady_clock::now();
+    manager.run_passes(stores, conf);
+    auto end = std::chrono::steady_clock::now();
+    auto mem_stats = get_mem_stats();
+
+    res["pass"] = pass->name();
+    res["shape"] = shape.name;
+    res["scale"] = Json::UInt64(scale);
+    res["classes"] = Json::UInt64(num_classes);
+    res["wall_time_ms"] = Json::Int64(
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+            .count());
+    // If the high water mark could not be reset, it includes the peak of
+    // earlier runs.
+    res["peak_rss_bytes"] = Json::UInt64(mem_stats.vm_hwm);
+    res["peak_rss_is_per_run"] = hwm_reset;
+  }
+  delete g_redex;
+  g_redex = nullptr;
+  return res;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  size_t scale = 1;
+  std::string out_path;
+  std::vector<std::string> pass_names;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--scale" && i + 1 < argc) {
+      scale = std::stoul(argv[++i]);
+    } else if (arg == "--out" && i + 1 < argc) {
+      out_path = argv[++i];
+    } else {
+      pass_names.push_back(arg);
+    }
+  }
+  if (pass_names.empty()) {
+    pass_names = kDefaultPasses;
+  }
+
+  Json::Value results(Json::arrayValue);
+  for (const auto& pass_name : pass_names) {
+    auto* pass = find_pass(pass_name);
+    if (pass == nullptr) {
+      fprintf(stderr, "Unknown pass %s\n", pass_name.c_str());
+      return 1;
+    }
+    for (const auto& shape : kShapes) {
+      auto res = run(pass, shape, scale);
+      fprintf(stderr, "%s on %s: %s ms\n", pass_name.c_str(),
+              shape.name.c_str(), res["wall_time_ms"].asString().c_str());
+      results.append(res);
+    }
+  }
+
+  if (out_path.empty()) {
+    std::cout << results.toStyledString();
+  } else {
+    std::ofstream ofs(out_path, std::ofstream::out | std::ofstream::trunc);
+    ofs << results.toStyledString();
+  }
+  return 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "AnalysisSummaryCache.h"
+#include "Creators.h"
+#include "DexAsm.h"
+#include "IRAssembler.h"
+#include "ProguardMap.h"
+#include "ProguardMatcher.h"
+#include "ProguardParser.h"
+#include "Purity.h"
+#include "ReachableClasses.h"
+#include "RedexTest.h"
+#include "RedexTestUtils.h"
+#include "Show.h"
+
+using namespace dex_asm;
+
+class AnalysisSummaryCacheTest : public RedexTest {
+ protected:
+  AnalysisSummaryCacheTest()
+      : m_tmp_dir(redex::make_tmp_dir("redex_summary_cache_test_%%%%%%%%")) {
+    g_redex->analysis_summary_cache_dir = m_tmp_dir.path;
+  }
+
+  redex::TempDir m_tmp_dir;
+};
+
+TEST_F(AnalysisSummaryCacheTest, RoundTrip) {
+  EXPECT_TRUE(analysis_summary_cache::enabled());
+  auto key = analysis_summary_cache::make_key("scope", {"a", "b"});
+  EXPECT_FALSE(analysis_summary_cache::load("foo", key));
+
+  analysis_summary_cache::store("foo", key, {"x", "y"});
+  auto lines = analysis_summary_cache::load("foo", key);
+  ASSERT_TRUE(lines);
+  EXPECT_EQ(*lines, std::vector<std::string>({"x", "y"}));
+
+  EXPECT_FALSE(analysis_summary_cache::load("bar", key));
+  EXPECT_FALSE(analysis_summary_cache::load(
+      "foo", analysis_summary_cache::make_key("scope", {"a"})));
+}
+
+TEST_F(AnalysisSummaryCacheTest, NoSideEffectsMethods) {
+  auto* pure = assembler::method_from_string(R"(
+    (method (public static) "LFoo;.pure:()I"
+      (
+        (const v0 0)
+        (return v0)
+      )
+    )
+  )");
+  auto* impure = assembler::method_from_string(R"(
+    (method (public static) "LFoo;.impure:()V"
+      (
+        (const v0 0)
+        (sput v0 "LFoo;.f:I")
+        (return-void)
+      )
+    )
+  )");
+  Scope scope{assembler::class_with_methods("LFoo;", {pure, impure})};
+
+  const std::string context = "test";
+  auto compute = [&]() {
+    std::unordered_set<const DexMethod*> result;
+    compute_no_side_effects_methods(
+        scope, /* method_override_graph */ nullptr,
+        [](const DexType*) { return true; }, {}, &result, &context);
+    return result;
+  };
+  EXPECT_EQ(compute(), std::unordered_set<const DexMethod*>({pure}));
+
+  // Tamper with the stored summary to observe that it gets used.
+  std::vector<boost::filesystem::path> files(
+      boost::filesystem::directory_iterator(m_tmp_dir.path),
+      boost::filesystem::directory_iterator());
+  ASSERT_EQ(files.size(), 1);
+  auto key = files[0].stem().string().substr(
+      std::string("no_side_effects_methods-").size());
+  analysis_summary_cache::store("no_side_effects_methods", key,
+                                {show(impure)});
+  EXPECT_EQ(compute(), std::unordered_set<const DexMethod*>({impure}));
+
+  // Changing the code of any class invalidates the summary.
+  pure->get_code()->push_back(dasm(OPCODE_CONST, {1_v, 1_L}));
+  EXPECT_EQ(compute(), std::unordered_set<const DexMethod*>({pure}));
+}
+
+TEST_F(AnalysisSummaryCacheTest, ProguardMatches) {
+  auto make_class = [](const char* name) {
+    ClassCreator cc(DexType::make_type(name));
+    cc.set_super(type::java_lang_Object());
+    return cc.create();
+  };
+  auto* foo = make_class("Lcom/foo/Foo;");
+  auto* bar = make_class("Lcom/bar/Bar;");
+  std::vector<DexClasses> dexen{{foo, bar}};
+  ProguardMap pm;
+  apply_deobfuscated_names(dexen, pm);
+  Scope scope = build_class_scope(dexen);
+  Scope external_classes;
+
+  keep_rules::ProguardConfiguration pg_config;
+  std::istringstream pg_config_text("-keep class com.foo.** { *; }");
+  keep_rules::proguard_parser::parse(pg_config_text, &pg_config);
+
+  keep_rules::process_proguard_rules(pm, scope, external_classes, pg_config,
+                                     /* keep_all_annotation_classes */ false);
+  EXPECT_FALSE(can_delete(foo));
+  EXPECT_TRUE(can_delete(bar));
+
+  // Tamper with the stored matches to observe that they get used.
+  std::vector<boost::filesystem::path> files(
+      boost::filesystem::directory_iterator(m_tmp_dir.path),
+      boost::filesystem::directory_iterator());
+  ASSERT_EQ(files.size(), 1);
+  auto key =
+      files[0].stem().string().substr(std::string("proguard_matches-").size());
+  analysis_summary_cache::store("proguard_matches", key, {"Lcom/bar/Bar;"});
+  auto recorder = keep_rules::process_proguard_rules(
+      pm, scope, external_classes, pg_config,
+      /* keep_all_annotation_classes */ false);
+  EXPECT_FALSE(can_delete(bar));
+  EXPECT_EQ(recorder.used_keep_rules.size(), 1);
+}
+
+TEST_F(AnalysisSummaryCacheTest, ProguardMapRoundTrip) {
+  auto map_file = m_tmp_dir.path + "/mapping.txt";
+  {
+    std::ofstream out(map_file);
+    out << "com.foo.Foo -> A:\n"
+        << "    int bar -> a\n"
+        << "    1:3:void baz():10:12 -> b\n"
+        << "com.foo.Qux -> B:\n";
+  }
+
+  ProguardMap parsed(map_file);
+  EXPECT_EQ(parsed.deobfuscate_class("LA;"), "Lcom/foo/Foo;");
+
+  std::vector<boost::filesystem::path> files;
+  for (boost::filesystem::directory_iterator it(m_tmp_dir.path), end;
+       it != end; ++it) {
+    if (it->path().filename().string().rfind("proguard_map-", 0) == 0) {
+      files.push_back(it->path());
+    }
+  }
+  ASSERT_EQ(files.size(), 1);
+
+  ProguardMap cached(map_file);
+  for (const auto& cls : {"LA;", "LB;", "LC;"}) {
+    EXPECT_EQ(cached.deobfuscate_class(cls), parsed.deobfuscate_class(cls));
+  }
+  EXPECT_EQ(cached.deobfuscate_field("LA;.a:I"),
+            parsed.deobfuscate_field("LA;.a:I"));
+  EXPECT_EQ(cached.translate_method("Lcom/foo/Foo;.baz:()V"),
+            parsed.translate_method("Lcom/foo/Foo;.baz:()V"));
+  auto* method = DexString::make_string(
+      parsed.translate_method("Lcom/foo/Foo;.baz:()V"));
+  auto expected = parsed.deobfuscate_frame(method, 2);
+  auto actual = cached.deobfuscate_frame(method, 2);
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(actual[i].method, expected[i].method);
+    EXPECT_EQ(actual[i].line, expected[i].line);
+  }
+
+  // A damaged entry is ignored, and the map parsed again.
+  auto key =
+      files[0].stem().string().substr(std::string("proguard_map-").size());
+  analysis_summary_cache::store("proguard_map", key, {"bogus"});
+  ProguardMap reparsed(map_file);
+  EXPECT_EQ(reparsed.deobfuscate_class("LA;"), "Lcom/foo/Foo;");
+}
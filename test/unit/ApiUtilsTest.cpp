@@ -10,8 +10,10 @@
 #include "ApiLevelsUtils.h"
 #include "DexClass.h"
 #include "DexUtil.h"
+#include "FrameworkApi.h"
 #include "IRAssembler.h"
 #include "RedexContext.h"
+#include "RedexTestUtils.h"
 #include "ScopeHelper.h"
 #include "Show.h"
 
@@ -234,3 +236,39 @@ TEST(ApiUtilsTest, testHasMethod) {
 
   EXPECT_TRUE(sdk.has_method(method));
 }
+
+TEST(ApiUtilsTest, testBinaryIndex) {
+  g_redex = new RedexContext();
+
+  auto api_file =
+      boost::optional<std::string>(std::getenv("api_utils_easy_input_path"));
+  api::AndroidSDK text_sdk(api_file);
+
+  auto tmp_dir = redex::make_tmp_dir("redex_api_utils_test_%%%%%%%%");
+  auto index_file = tmp_dir.path + "/api.bin";
+  text_sdk.write_binary_index(index_file);
+  api::AndroidSDK binary_sdk{boost::optional<std::string>(index_file)};
+
+  const auto& expected = text_sdk.get_framework_classes();
+  const auto& actual = binary_sdk.get_framework_classes();
+  EXPECT_EQ(actual.size(), expected.size());
+  for (const auto& [type, api] : expected) {
+    ASSERT_EQ(actual.count(type), 1) << show(type);
+    const auto& loaded = actual.at(type);
+    EXPECT_EQ(loaded.cls, api.cls);
+    EXPECT_EQ(loaded.super_cls, api.super_cls);
+    EXPECT_EQ(loaded.access_flags, api.access_flags);
+    ASSERT_EQ(loaded.mrefs_info.size(), api.mrefs_info.size());
+    for (size_t i = 0; i < api.mrefs_info.size(); ++i) {
+      EXPECT_EQ(loaded.mrefs_info[i].mref, api.mrefs_info[i].mref);
+      EXPECT_EQ(loaded.mrefs_info[i].access_flags,
+                api.mrefs_info[i].access_flags);
+    }
+    ASSERT_EQ(loaded.frefs_info.size(), api.frefs_info.size());
+    for (size_t i = 0; i < api.frefs_info.size(); ++i) {
+      EXPECT_EQ(loaded.frefs_info[i].fref, api.frefs_info[i].fref);
+      EXPECT_EQ(loaded.frefs_info[i].access_flags,
+                api.frefs_info[i].access_flags);
+    }
+  }
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ArrayBoundsCheckElimination.h"
+#include "ControlFlow.h"
+#include "IRAssembler.h"
+#include "IRCode.h"
+#include "RedexTest.h"
+
+class ArrayBoundsCheckEliminationTest : public RedexTest {};
+
+namespace {
+
+size_t num_throw_edges(const cfg::ControlFlowGraph& cfg) {
+  size_t res = 0;
+  for (auto* block : cfg.blocks()) {
+    for (auto* edge : block->succs()) {
+      if (edge->type() == cfg::EDGE_THROW) {
+        res++;
+      }
+    }
+  }
+  return res;
+}
+
+} // namespace
+
+TEST_F(ArrayBoundsCheckEliminationTest, counting_loop) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (load-param-object v0)
+      (const v1 0)
+      (array-length v0)
+      (move-result-pseudo v2)
+      (:loop)
+      (if-ge v1 v2 :end)
+      (.try_start a)
+      (aget v0 v1)
+      (move-result-pseudo v3)
+      (.try_end a)
+      (add-int/lit v1 v1 1)
+      (goto :loop)
+      (:end)
+      (return-void)
+      (.catch (a))
+      (const v4 1)
+      (return-void)
+    )
+  )");
+  code->build_cfg();
+  auto& cfg = code->cfg();
+  auto stats = array_bounds::process_cfg(cfg);
+  EXPECT_EQ(stats.safe_array_accesses, 1);
+  EXPECT_EQ(stats.throw_edges_removed, 1);
+  EXPECT_EQ(num_throw_edges(cfg), 0);
+  code->clear_cfg();
+}
+
+TEST_F(ArrayBoundsCheckEliminationTest, counting_down_loop) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (load-param-object v0)
+      (array-length v0)
+      (move-result-pseudo v2)
+      (add-int/lit v1 v2 -1)
+      (:loop)
+      (if-ltz v1 :end)
+      (const v3 7)
+      (aput v3 v0 v1)
+      (add-int/lit v1 v1 -1)
+      (goto :loop)
+      (:end)
+      (return-void)
+    )
+  )");
+  code->build_cfg();
+  auto stats = array_bounds::process_cfg(code->cfg());
+  EXPECT_EQ(stats.safe_array_accesses, 1);
+  EXPECT_EQ(stats.throw_edges_removed, 0);
+  code->clear_cfg();
+}
+
+TEST_F(ArrayBoundsCheckEliminationTest, new_array_and_repeated_access) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (load-param v0)
+      (load-param v1)
+      (new-array v0 "[I")
+      (move-result-pseudo-object v2)
+      (array-length v2)
+      (move-result-pseudo v3)
+      (aget v2 v1)
+      (move-result-pseudo v4)
+      (aget v2 v1)
+      (move-result-pseudo v5)
+      (return-void)
+    )
+  )");
+  code->build_cfg();
+  auto stats = array_bounds::process_cfg(code->cfg());
+  // The array-length of the new array, and the second aget.
+  EXPECT_EQ(stats.safe_array_accesses, 2);
+  code->clear_cfg();
+}
+
+TEST_F(ArrayBoundsCheckEliminationTest, off_by_one_loop) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (load-param-object v0)
+      (const v1 0)
+      (array-length v0)
+      (move-result-pseudo v2)
+      (:loop)
+      (if-gt v1 v2 :end)
+      (.try_start a)
+      (aget v0 v1)
+      (move-result-pseudo v3)
+      (.try_end a)
+      (add-int/lit v1 v1 1)
+      (goto :loop)
+      (:end)
+      (return-void)
+      (.catch (a))
+      (return-void)
+    )
+  )");
+  code->build_cfg();
+  auto& cfg = code->cfg();
+  auto stats = array_bounds::process_cfg(cfg);
+  EXPECT_EQ(stats.safe_array_accesses, 0);
+  EXPECT_EQ(num_throw_edges(cfg), 1);
+  code->clear_cfg();
+}
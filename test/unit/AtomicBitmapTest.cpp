@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "AtomicBitmap.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+
+class AtomicBitmapTest : public ::testing::Test {};
+
+TEST_F(AtomicBitmapTest, setAndTest) {
+  AtomicBitmap bitmap(130);
+  EXPECT_EQ(130, bitmap.size());
+  EXPECT_EQ(0, bitmap.count());
+  EXPECT_TRUE(bitmap.set(0));
+  EXPECT_TRUE(bitmap.set(64));
+  EXPECT_TRUE(bitmap.set(129));
+  EXPECT_FALSE(bitmap.set(64));
+  EXPECT_TRUE(bitmap.test(0));
+  EXPECT_FALSE(bitmap.test(1));
+  EXPECT_TRUE(bitmap.test(64));
+  EXPECT_FALSE(bitmap.test(128));
+  EXPECT_TRUE(bitmap.test(129));
+  EXPECT_EQ(3, bitmap.count());
+}
+
+TEST_F(AtomicBitmapTest, concurrentSet) {
+  const size_t N_THREADS = 16;
+  const size_t N = 10000;
+  AtomicBitmap bitmap(N);
+  std::atomic<size_t> newly_set{0};
+  std::vector<boost::thread> threads;
+  for (size_t t = 0; t < N_THREADS; ++t) {
+    threads.emplace_back([&]() {
+      for (size_t i = 0; i < N; ++i) {
+        if (bitmap.set(i)) {
+          newly_set++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Every bit was reported as newly set exactly once.
+  EXPECT_EQ(N, newly_set.load());
+  EXPECT_EQ(N, bitmap.count());
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "BalancedPartitioning.h"
+#include "RedexTest.h"
+
+class BalancedPartitioningTest : public RedexTest {};
+
+namespace {
+
+std::vector<uint32_t> partition(size_t num_documents, uint32_t num_threads) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<uint32_t> kmer_dist(0, 999);
+  std::vector<Document> documents(num_documents);
+  for (uint32_t i = 0; i < num_documents; i++) {
+    documents[i].init(i);
+    for (size_t j = 0; j < 8; j++) {
+      documents[i].add(kmer_dist(rng));
+    }
+  }
+  std::vector<Document*> documents_ptr;
+  for (auto& doc : documents) {
+    documents_ptr.push_back(&doc);
+  }
+  BalancedPartitioning(documents_ptr, num_threads).run();
+
+  std::vector<uint32_t> buckets;
+  for (const auto& doc : documents) {
+    buckets.push_back(doc.bucket);
+  }
+  return buckets;
+}
+
+} // namespace
+
+TEST_F(BalancedPartitioningTest, ResultIndependentOfThreadCount) {
+  // Large enough for the top-level bisections to run in parallel.
+  constexpr size_t num_documents = 20000;
+  auto sequential = partition(num_documents, 1);
+
+  std::vector<bool> seen(num_documents);
+  for (auto bucket : sequential) {
+    ASSERT_LT(bucket, num_documents);
+    EXPECT_FALSE(seen[bucket]);
+    seen[bucket] = true;
+  }
+
+  EXPECT_EQ(partition(num_documents, 8), sequential);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "BinarySerialization.h"
+
+namespace bs = binary_serialization;
+
+namespace {
+
+constexpr uint32_t TEST_TAG = bs::make_schema_tag("TEST");
+
+// Copies the serialized bytes into suitably aligned storage.
+std::vector<uint64_t> to_aligned(const std::string& bytes) {
+  std::vector<uint64_t> storage((bytes.size() + 7) / 8);
+  memcpy(storage.data(), bytes.data(), bytes.size());
+  return storage;
+}
+
+} // namespace
+
+TEST(BinarySerializationTest, round_trip) {
+  std::ostringstream os;
+  bs::SchemaWriter writer(os, TEST_TAG, /* schema_version */ 3);
+  writer.write<uint8_t>(7);
+  writer.write_string("hello");
+  writer.write_array(std::vector<uint64_t>{1, 2, 3});
+  writer.write<int32_t>(-1);
+  writer.write_array(std::vector<uint16_t>{});
+  auto bytes = os.str();
+  EXPECT_EQ(writer.size(), bytes.size());
+
+  auto storage = to_aligned(bytes);
+  bs::SchemaReader reader((const char*)storage.data(), bytes.size());
+  EXPECT_TRUE(reader.has_schema(TEST_TAG, 3));
+  EXPECT_FALSE(reader.has_schema(TEST_TAG, 2));
+  EXPECT_FALSE(reader.has_schema(bs::make_schema_tag("TSET"), 3));
+  EXPECT_EQ(reader.read<uint8_t>(), 7);
+  EXPECT_EQ(reader.read_string(), "hello");
+  auto array = reader.read_array<uint64_t>();
+  EXPECT_EQ(std::vector<uint64_t>(array.begin(), array.end()),
+            std::vector<uint64_t>({1, 2, 3}));
+  // The array is read in place.
+  EXPECT_EQ((uintptr_t)array.begin() % alignof(uint64_t), 0);
+  auto* data = (const char*)storage.data();
+  EXPECT_GE((const char*)array.begin(), data);
+  EXPECT_LE((const char*)array.end(), data + bytes.size());
+  EXPECT_EQ(reader.read<int32_t>(), -1);
+  EXPECT_TRUE(reader.read_array<uint16_t>().empty());
+  EXPECT_TRUE(reader.at_end());
+}
+
+TEST(BinarySerializationTest, read_past_end) {
+  std::ostringstream os;
+  bs::SchemaWriter writer(os, TEST_TAG, /* schema_version */ 1);
+  writer.write<uint32_t>(2);
+  auto bytes = os.str();
+
+  auto storage = to_aligned(bytes);
+  bs::SchemaReader reader((const char*)storage.data(), bytes.size());
+  // The count is read as the length of a string that isn't there.
+  EXPECT_THROW(reader.read_string(), RedexException);
+}
+
+TEST(BinarySerializationTest, not_a_schema_file) {
+  std::vector<uint64_t> storage(2, 0);
+  EXPECT_THROW(bs::SchemaReader((const char*)storage.data(), 16),
+               RedexException);
+}
@@ -12,6 +12,7 @@
 #include "DexAsm.h"
 #include "IRAssembler.h"
 #include "IRInstruction.h"
+#include "Liveness.h"
 #include "RedexTest.h"
 
 #include <functional>
@@ -508,3 +509,47 @@ TEST_F(CFGMutationTest, InsertAfterVariant) {
 }
 
 } // namespace
+
+TEST_F(CFGMutationTest, ChangedBlocksUpdateLiveness) {
+  auto code = assembler::ircode_from_string(R"((
+    (load-param v0)
+    (const v1 1)
+    (if-eqz v0 :true)
+    (const v2 2)
+    (goto :join)
+    (:true)
+    (const v2 3)
+    (:join)
+    (return v2)
+  ))");
+  code->build_cfg();
+  auto& cfg = code->cfg();
+  cfg.calculate_exit_block();
+
+  LivenessFixpointIterator liveness(cfg);
+  liveness.run(LivenessDomain());
+  EXPECT_FALSE(liveness.get_live_in_vars_at(cfg.exit_block()).contains(1));
+
+  // Use v1 right before the return.
+  CFGMutation m(cfg);
+  auto return_it = cfg.find_insn(cfg.exit_block()->get_last_insn()->insn);
+  m.insert_before(return_it, {dasm(OPCODE_ADD_INT, {2_v, 2_v, 1_v})});
+  m.flush();
+  ASSERT_EQ(m.changed_blocks(), std::vector<Block*>{cfg.exit_block()});
+
+  liveness.update(LivenessDomain(), m.changed_blocks());
+  LivenessFixpointIterator fresh(cfg);
+  fresh.run(LivenessDomain());
+  for (auto* block : cfg.blocks()) {
+    EXPECT_EQ(liveness.get_live_in_vars_at(block),
+              fresh.get_live_in_vars_at(block))
+        << block->id();
+    EXPECT_EQ(liveness.get_live_out_vars_at(block),
+              fresh.get_live_out_vars_at(block))
+        << block->id();
+  }
+  EXPECT_TRUE(liveness.get_live_in_vars_at(cfg.entry_block()).contains(0));
+  EXPECT_TRUE(liveness.get_live_out_vars_at(cfg.entry_block()).contains(1));
+
+  code->clear_cfg();
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <json/json.h>
+#include <set>
+
+#include "ChromeTrace.h"
+#include "Timer.h"
+
+TEST(ChromeTraceTest, WritesTimeline) {
+  auto path = std::string(::testing::TempDir()) + "chrome_trace.json";
+  EXPECT_FALSE(chrome_trace::is_enabled());
+  chrome_trace::enable(path);
+  EXPECT_TRUE(chrome_trace::is_enabled());
+
+  {
+    Timer t("outer \"timer\"");
+    chrome_trace::ScopedSpan span("inner span", "test");
+  }
+  chrome_trace::add_counter("some counter", 42);
+  chrome_trace::write();
+
+  std::ifstream is(path);
+  Json::Value root;
+  is >> root;
+  const auto& events = root["traceEvents"];
+  ASSERT_TRUE(events.isArray());
+
+  std::set<std::string> names;
+  for (const auto& event : events) {
+    names.insert(event["name"].asString());
+    if (event["name"].asString() == "some counter") {
+      EXPECT_EQ(event["ph"].asString(), "C");
+      EXPECT_EQ(event["args"]["bytes"].asUInt64(), 42);
+    } else if (event["ph"].asString() == "X") {
+      EXPECT_TRUE(event.isMember("dur"));
+    }
+  }
+  EXPECT_EQ(names.count("outer \"timer\""), 1);
+  EXPECT_EQ(names.count("inner span"), 1);
+  EXPECT_EQ(names.count("RSS"), 1);
+}
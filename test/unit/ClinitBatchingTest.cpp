@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ClinitBatching.h"
+#include "Creators.h"
+#include "DexAccess.h"
+#include "DexStore.h"
+#include "IRAssembler.h"
+#include "IRCode.h"
+#include "InitClassesWithSideEffects.h"
+#include "RedexTest.h"
+#include "Show.h"
+#include "Walkers.h"
+
+struct ClinitBatchingTest : public RedexTest {
+ protected:
+  DexClass* create_class(const char* type,
+                         const char* field,
+                         const std::vector<std::string>& methods) {
+    ClassCreator creator(DexType::make_type(type));
+    creator.set_super(type::java_lang_Object());
+    auto* f = static_cast<DexField*>(DexField::make_field(field));
+    f->make_concrete(ACC_STATIC | ACC_FINAL,
+                     DexEncodedValue::zero_for_type(f->get_type()));
+    creator.add_field(f);
+    for (const auto& method : methods) {
+      creator.add_method(assembler::method_from_string(method));
+    }
+    return creator.create();
+  }
+
+  static clinit_batching::Stats run(const std::vector<DexClass*>& classes) {
+    auto store = DexStore("classes");
+    store.add_classes(classes);
+    DexStoresVector stores{store};
+    auto scope = build_class_scope(stores);
+    XStoreRefs xstores(stores);
+    init_classes::InitClassesWithSideEffects init_classes_with_side_effects(
+        scope, /* create_init_class_insns */ false);
+    walk::code(scope, [&](DexMethod*, IRCode& code) { code.build_cfg(); });
+    auto res = clinit_batching::batch_clinits(
+        scope, init_classes_with_side_effects, xstores,
+        /* startup_types */ nullptr);
+    walk::code(scope, [&](DexMethod*, IRCode& code) { code.clear_cfg(); });
+    return res;
+  }
+
+  DexClass* create_owner() {
+    return create_class("LA;", "LA;.x:I",
+                        {R"(
+      (method (public static) "LA;.<clinit>:()V"
+       (
+        (const v0 1)
+        (sput v0 "LA;.x:I")
+        (return-void)
+       )
+      )
+    )",
+                         R"(
+      (method (public static) "LA;.get:()I"
+       (
+        (sget "LB;.f:I")
+        (move-result-pseudo v0)
+        (return v0)
+       )
+      )
+    )"});
+  }
+};
+
+TEST_F(ClinitBatchingTest, batches_into_only_accessor) {
+  auto* a = create_owner();
+  auto* b = create_class("LB;", "LB;.f:I", {R"(
+      (method (public static) "LB;.<clinit>:()V"
+       (
+        (const v0 42)
+        (sput v0 "LB;.f:I")
+        (return-void)
+       )
+      )
+    )"});
+
+  auto stats = run({a, b});
+  EXPECT_EQ(stats.batched_clinits, 1);
+  EXPECT_EQ(stats.batching_clinits, 1);
+  EXPECT_EQ(b->get_clinit(), nullptr);
+  EXPECT_FALSE(is_final(b->get_sfields().front()));
+
+  auto* batched = DexMethod::get_method("LB;.$clinit$:()V");
+  ASSERT_NE(batched, nullptr);
+  auto ii = InstructionIterable(a->get_clinit()->get_code());
+  auto it = ii.begin();
+  ASSERT_NE(it, ii.end());
+  EXPECT_EQ(it->insn->opcode(), OPCODE_INVOKE_STATIC);
+  EXPECT_EQ(it->insn->get_method(), batched);
+}
+
+TEST_F(ClinitBatchingTest, skips_fields_with_several_accessors) {
+  auto* a = create_owner();
+  auto* b = create_class("LB;", "LB;.f:I", {R"(
+      (method (public static) "LB;.<clinit>:()V"
+       (
+        (const v0 42)
+        (sput v0 "LB;.f:I")
+        (return-void)
+       )
+      )
+    )"});
+  auto* c = create_class("LC;", "LC;.y:I", {R"(
+      (method (public static) "LC;.get:()I"
+       (
+        (sget "LB;.f:I")
+        (move-result-pseudo v0)
+        (return v0)
+       )
+      )
+    )"});
+
+  auto stats = run({a, b, c});
+  EXPECT_EQ(stats.batched_clinits, 0);
+  EXPECT_NE(b->get_clinit(), nullptr);
+}
+
+TEST_F(ClinitBatchingTest, skips_initializer_reading_owner) {
+  auto* a = create_owner();
+  auto* b = create_class("LB;", "LB;.f:I", {R"(
+      (method (public static) "LB;.<clinit>:()V"
+       (
+        (sget "LA;.x:I")
+        (move-result-pseudo v0)
+        (sput v0 "LB;.f:I")
+        (return-void)
+       )
+      )
+    )"});
+
+  auto stats = run({a, b});
+  EXPECT_EQ(stats.batched_clinits, 0);
+  EXPECT_NE(b->get_clinit(), nullptr);
+}
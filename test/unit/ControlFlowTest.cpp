@@ -2783,3 +2783,95 @@ TEST_F(ControlFlowTest, insert_block_switch) {
   EXPECT_TRUE(branch_edges[2]->target() == nb0);
   EXPECT_TRUE(nb0->goes_to() != nullptr && nb0->goes_to() == branch_block);
 }
+
+TEST_F(ControlFlowTest, pooledBlocksAndEdges) {
+  Block* freed_block;
+  Edge* freed_edge;
+  {
+    ControlFlowGraph cfg;
+    auto b0 = cfg.create_block();
+    auto b1 = cfg.create_block();
+    cfg.set_entry_block(b0);
+    cfg.add_edge(b0, b1, EDGE_GOTO);
+    freed_block = b1;
+    freed_edge = b0->succs()[0];
+  }
+  // Freed objects are handed out again on the same thread.
+  ControlFlowGraph cfg;
+  auto b0 = cfg.create_block();
+  auto b1 = cfg.create_block();
+  cfg.add_edge(b0, b1, EDGE_GOTO);
+  EXPECT_TRUE(b0 == freed_block || b1 == freed_block);
+  EXPECT_EQ(b0->succs()[0], freed_edge);
+}
+
+TEST_F(ControlFlowTest, liveMemoryAccounting) {
+  // Big enough to get past the per-thread batching of the counters.
+  constexpr size_t NUM_BLOCKS = 10000;
+  auto live_before = live_memory_bytes();
+  reset_peak_memory_bytes();
+  {
+    ControlFlowGraph cfg;
+    auto prev = cfg.create_block();
+    cfg.set_entry_block(prev);
+    for (size_t i = 1; i < NUM_BLOCKS; ++i) {
+      auto block = cfg.create_block();
+      cfg.add_edge(prev, block, EDGE_GOTO);
+      prev = block;
+    }
+    EXPECT_GT(live_memory_bytes(),
+              live_before + (int64_t)((NUM_BLOCKS / 2) * sizeof(Block)));
+  }
+  EXPECT_LT(live_memory_bytes(),
+            live_before + (int64_t)((NUM_BLOCKS / 2) * sizeof(Block)));
+  EXPECT_GT(peak_memory_bytes(),
+            live_before + (int64_t)((NUM_BLOCKS / 2) * sizeof(Block)));
+}
+
+TEST_F(ControlFlowTest, profileGuidedLinearization) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (load-param v0)
+      (.src_block "LFoo;.bar:(I)I" 0 (10.0 1.0))
+      (if-eqz v0 :hot)
+      (.src_block "LFoo;.bar:(I)I" 1 (0.0 0.0))
+      (const v1 1)
+      (return v1)
+      (:hot)
+      (.src_block "LFoo;.bar:(I)I" 2 (10.0 1.0))
+      (const v1 2)
+      (return v1)
+    )
+  )");
+  auto get_opcodes = [&]() {
+    std::vector<IROpcode> res;
+    for (const auto& mie : ::InstructionIterable(code.get())) {
+      res.push_back(mie.insn->opcode());
+    }
+    return res;
+  };
+  auto get_consts = [&]() {
+    std::vector<int64_t> res;
+    for (const auto& mie : ::InstructionIterable(code.get())) {
+      if (mie.insn->opcode() == OPCODE_CONST) {
+        res.push_back(mie.insn->get_literal());
+      }
+    }
+    return res;
+  };
+
+  code->build_cfg();
+  code->clear_cfg();
+  EXPECT_EQ(get_consts(), std::vector<int64_t>({1, 2}));
+
+  // The hot branch target now falls through, and the cold block goes last.
+  code->build_cfg();
+  std::unique_ptr<LinearizationStrategy> strategy =
+      std::make_unique<ProfileGuidedLinearizationStrategy>();
+  code->clear_cfg(strategy);
+  EXPECT_EQ(get_consts(), std::vector<int64_t>({2, 1}));
+  EXPECT_THAT(get_opcodes(),
+              ::testing::ElementsAre(IOPCODE_LOAD_PARAM, OPCODE_IF_NEZ,
+                                     OPCODE_CONST, OPCODE_RETURN, OPCODE_CONST,
+                                     OPCODE_RETURN));
+}
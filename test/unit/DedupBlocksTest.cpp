@@ -1998,3 +1998,60 @@ TEST_F(DedupBlocksTest, blockWithIterativeLimit2) {
 
   EXPECT_CODE_EQ(expected_code.get(), code);
 }
+
+TEST_F(DedupBlocksTest, blockHashIndexAcrossMethods) {
+  auto method_a = get_fresh_method("hashA");
+  method_a->set_code(assembler::ircode_from_string(R"(
+    (
+      (const v0 1)
+      (const v1 2)
+      (add-int v2 v0 v1)
+      (return v2)
+    )
+  )"));
+  // Same computation in other registers, with commuted operands.
+  auto method_b = get_fresh_method("hashB");
+  method_b->set_code(assembler::ircode_from_string(R"(
+    (
+      (const v3 2)
+      (const v4 1)
+      (add-int v5 v3 v4)
+      (return v5)
+    )
+  )"));
+  auto method_c = get_fresh_method("hashC");
+  method_c->set_code(assembler::ircode_from_string(R"(
+    (
+      (const v0 1)
+      (const v1 3)
+      (add-int v2 v0 v1)
+      (return v2)
+    )
+  )"));
+
+  dedup_blocks_impl::Config config;
+  config.collect_block_hashes = true;
+  dedup_blocks_impl::BlockHashIndex index;
+  for (auto* method : {method_a, method_b, method_c}) {
+    method->get_code()->build_cfg();
+    dedup_blocks_impl::DedupBlocks impl(&config, method);
+    impl.run();
+    index.update(method, std::move(impl.get_block_hashes()));
+    method->get_code()->clear_cfg();
+  }
+  EXPECT_EQ(index.num_methods(), 3);
+
+  auto duplicates = index.get_cross_method_duplicates();
+  ASSERT_EQ(duplicates.size(), 1);
+  const auto& occ = duplicates.begin()->second;
+  EXPECT_EQ(occ.num_opcodes, 4);
+  std::vector<const DexMethod*> expected_methods{method_a, method_b};
+  std::sort(expected_methods.begin(), expected_methods.end(),
+            compare_dexmethods);
+  EXPECT_EQ(occ.methods, expected_methods);
+
+  // Re-indexing a method replaces its entries.
+  index.update(method_b, {});
+  EXPECT_EQ(index.num_methods(), 2);
+  EXPECT_TRUE(index.get_cross_method_duplicates().empty());
+}
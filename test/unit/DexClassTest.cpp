@@ -10,6 +10,7 @@
 #include <boost/optional.hpp>
 
 #include "IRAssembler.h"
+#include "InstructionLowering.h"
 #include "RedexTest.h"
 #include "SimpleClassHierarchy.h"
 
@@ -39,6 +40,27 @@ TEST_F(DexClassTest, testUniqueMethodName) {
             "baz"); // no conflict, expect baz not to be suffixed
 }
 
+TEST_F(DexClassTest, getMethodByDescriptor) {
+  auto method = DexMethod::make_method("LFoo;.bar:(I[Ljava/lang/String;J)V");
+  EXPECT_EQ(DexMethod::get_method("LFoo;.bar:(I[Ljava/lang/String;J)V"),
+            method);
+  EXPECT_EQ(DexMethod::get_method<true>("LFoo;.bar:(I[Ljava/lang/String;J)V"),
+            method);
+
+  // Each token missing from the tables makes the lookup fail, without
+  // interning anything.
+  EXPECT_EQ(DexMethod::get_method("LNoSuchClass;.bar:(I[Ljava/lang/String;J)V"),
+            nullptr);
+  EXPECT_EQ(DexMethod::get_method("LFoo;.noSuchName:(I[Ljava/lang/String;J)V"),
+            nullptr);
+  EXPECT_EQ(DexMethod::get_method("LFoo;.bar:(I[LNoSuchArg;J)V"), nullptr);
+  EXPECT_EQ(DexMethod::get_method("LFoo;.bar:(I)LNoSuchReturn;"), nullptr);
+  EXPECT_EQ(DexMethod::get_method("LFoo;.bar:(I[Ljava/lang/String;)V"),
+            nullptr);
+  EXPECT_EQ(DexType::get_type("LNoSuchClass;"), nullptr);
+  EXPECT_EQ(DexString::get_string("noSuchName"), nullptr);
+}
+
 TEST_F(DexClassTest, testUniqueFieldName) {
   auto class_type = DexType::make_type(DexString::make_string("LFoo;"));
   ClassCreator class_creator(class_type);
@@ -214,3 +236,57 @@ Methods:
 
   EXPECT_EQ(c->show_structure(), expected);
 }
+
+TEST_F(DexClassTest, testArenaStats) {
+  auto find_used = [](const char* kind) {
+    for (const auto& stats : g_redex->get_arena_stats()) {
+      if (strcmp(stats.kind, kind) == 0) {
+        EXPECT_LE(stats.used, stats.allocated);
+        return stats.used;
+      }
+    }
+    ADD_FAILURE() << "No arena for " << kind;
+    return size_t(0);
+  };
+  auto types_before = find_used("types");
+  auto protos_before = find_used("protos");
+
+  auto* type = DexType::make_type("LArenaFoo;");
+  EXPECT_EQ(type, DexType::make_type("LArenaFoo;"));
+  EXPECT_EQ(type->str(), "LArenaFoo;");
+  EXPECT_GT(find_used("types"), types_before);
+
+  auto* proto = DexProto::make_proto(type, DexTypeList::make_type_list({}));
+  EXPECT_EQ(proto,
+            DexProto::make_proto(type, DexTypeList::make_type_list({})));
+  EXPECT_EQ(proto->get_rtype(), type);
+  EXPECT_GT(find_used("protos"), protos_before);
+}
+
+TEST_F(DexClassTest, testBalloonLazily) {
+  auto method = DexMethod::make_method("LFoo;.lazy:()V")
+                    ->make_concrete(ACC_PUBLIC | ACC_STATIC, false);
+  method->set_code(assembler::ircode_from_string(R"(
+    (
+      (const v0 0)
+      (return-void)
+    )
+  )"));
+  instruction_lowering::lower(method);
+  method->sync();
+  ASSERT_NE(method->get_dex_code(), nullptr);
+
+  method->balloon_lazily();
+  // Nothing is lifted until the code is asked for.
+  EXPECT_NE(method->get_dex_code(), nullptr);
+
+  auto expected_code = assembler::ircode_from_string(R"(
+    (
+      (const v0 0)
+      (return-void)
+    )
+  )");
+  ASSERT_NE(method->get_code(), nullptr);
+  EXPECT_EQ(method->get_dex_code(), nullptr);
+  EXPECT_CODE_EQ(method->get_code(), expected_code.get());
+}
@@ -8,6 +8,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "ControlFlow.h"
+#include "FrozenIRList.h"
 #include "IRCode.h"
 #include "IRList.h"
 #include "RedexTest.h"
@@ -134,3 +136,78 @@ TEST_F(IRListTest, keep_valid_regs) {
   EXPECT_EQ(assembler::to_string(expected_code.get()),
             assembler::to_string(code.get()));
 }
+
+TEST_F(IRListTest, frozen_linear) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (load-param v0)
+      (.dbg DBG_SET_PROLOGUE_END)
+      (if-gtz v0 :tru)
+      (const v1 1)
+      (return v1)
+
+      (:tru)
+      (const v1 2)
+      (return v1)
+    )
+  )");
+
+  FrozenIRList frozen(*code);
+  ASSERT_EQ(frozen.size(), 6);
+  EXPECT_FALSE(frozen.is_stale(*code));
+  std::vector<IROpcode> ops;
+  for (auto* insn : frozen) {
+    ops.push_back(insn->opcode());
+  }
+  EXPECT_THAT(ops,
+              ::testing::ElementsAre(IOPCODE_LOAD_PARAM, OPCODE_IF_GTZ,
+                                     OPCODE_CONST, OPCODE_RETURN,
+                                     OPCODE_CONST, OPCODE_RETURN));
+  EXPECT_THAT(frozen.targets(1), ::testing::ElementsAre(4));
+  EXPECT_TRUE(frozen.targets(0).empty());
+
+  code->push_back(new IRInstruction(OPCODE_RETURN_VOID));
+  EXPECT_TRUE(frozen.is_stale(*code));
+}
+
+TEST_F(IRListTest, frozen_cfg) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (load-param v0)
+      (if-gtz v0 :tru)
+      (const v1 1)
+      (return v1)
+
+      (:tru)
+      (const v1 2)
+      (return v1)
+    )
+  )");
+  code->build_cfg();
+  auto& cfg = code->cfg();
+
+  FrozenIRList frozen(cfg);
+  EXPECT_EQ(frozen.size(), cfg.num_opcodes());
+  ASSERT_EQ(frozen.num_blocks(), cfg.num_blocks());
+  EXPECT_FALSE(frozen.is_stale(cfg));
+
+  auto blocks = cfg.blocks();
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    std::vector<IRInstruction*> insns;
+    for (const auto& mie : InstructionIterable(blocks[b])) {
+      insns.push_back(mie.insn);
+    }
+    EXPECT_EQ(std::vector<IRInstruction*>(frozen.begin() + frozen.block_begin(b),
+                                          frozen.begin() + frozen.block_end(b)),
+              insns);
+    std::vector<uint32_t> succs;
+    for (auto* edge : blocks[b]->succs()) {
+      auto it = std::find(blocks.begin(), blocks.end(), edge->target());
+      succs.push_back(it - blocks.begin());
+    }
+    auto frozen_succs = frozen.successors(b);
+    EXPECT_EQ(std::vector<uint32_t>(frozen_succs.begin(), frozen_succs.end()),
+              succs);
+  }
+  code->clear_cfg();
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "KotlinShapes.h"
+
+#include "Creators.h"
+#include "RedexTest.h"
+
+struct KotlinShapesTest : public RedexTest {
+  Scope m_scope;
+
+  DexClass* make_class(const std::string& name,
+                       DexType* super,
+                       DexAccessFlags access = ACC_PUBLIC) {
+    ClassCreator creator(DexType::make_type(name));
+    creator.set_super(super);
+    creator.set_access(access);
+    auto cls = creator.create();
+    m_scope.push_back(cls);
+    return cls;
+  }
+
+  DexField* add_sfield(DexClass* cls, const std::string& name, DexType* type) {
+    auto field = DexField::make_field(cls->get_type(),
+                                      DexString::make_string(name), type)
+                     ->make_concrete(ACC_PUBLIC | ACC_STATIC | ACC_FINAL);
+    cls->add_field(field);
+    return field;
+  }
+};
+
+TEST_F(KotlinShapesTest, lambdas_and_singletons) {
+  auto lambda_type = DexType::make_type("Lkotlin/jvm/internal/Lambda;");
+  auto non_capturing = make_class("LFoo$bar$1;", lambda_type);
+  auto instance =
+      add_sfield(non_capturing, "INSTANCE", non_capturing->get_type());
+  auto capturing = make_class("LFoo$bar$2;", lambda_type);
+  capturing->add_field(DexField::make_field("LFoo$bar$2;.captured:I")
+                           ->make_concrete(ACC_PUBLIC));
+  auto object = make_class("LObj;", type::java_lang_Object());
+  auto object_instance = add_sfield(object, "INSTANCE", object->get_type());
+  auto other = make_class("LOther;", type::java_lang_Object());
+  add_sfield(other, "INSTANCE", object->get_type());
+
+  kotlin_shapes::ShapeIndex shapes(m_scope);
+  EXPECT_TRUE(shapes.get(non_capturing).is_non_capturing_lambda);
+  EXPECT_EQ(shapes.get(non_capturing).instance_field, instance);
+  EXPECT_TRUE(shapes.get(capturing).is_lambda);
+  EXPECT_FALSE(shapes.get(capturing).is_non_capturing_lambda);
+  EXPECT_EQ(shapes.get(object).instance_field, object_instance);
+  EXPECT_TRUE(shapes.get(other).empty());
+
+  EXPECT_EQ(shapes.lambdas(),
+            std::vector<DexClass*>({non_capturing, capturing}));
+  EXPECT_EQ(shapes.singletons(),
+            std::vector<DexClass*>({non_capturing, object}));
+}
+
+TEST_F(KotlinShapesTest, companions) {
+  auto outer = make_class("LOuter;", type::java_lang_Object());
+  auto companion = make_class("LOuter$Companion;", type::java_lang_Object(),
+                              ACC_PUBLIC | ACC_FINAL);
+  add_sfield(outer, "Companion", companion->get_type());
+  // Not final
+  auto open = make_class("LOuter$Open;", type::java_lang_Object());
+  add_sfield(outer, "Open", open->get_type());
+  // Held in two fields of the outer class
+  auto twice = make_class("LOuter$Twice;", type::java_lang_Object(),
+                          ACC_PUBLIC | ACC_FINAL);
+  add_sfield(outer, "Twice1", twice->get_type());
+  add_sfield(outer, "Twice2", twice->get_type());
+
+  kotlin_shapes::ShapeIndex shapes(m_scope);
+  EXPECT_EQ(shapes.get(companion).companion_outer_cls, outer);
+  EXPECT_EQ(shapes.get(open).companion_outer_cls, nullptr);
+  EXPECT_EQ(shapes.get(twice).companion_outer_cls, nullptr);
+  EXPECT_EQ(shapes.companions(), std::vector<DexClass*>({companion}));
+}
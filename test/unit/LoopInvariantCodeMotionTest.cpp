@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ControlFlow.h"
+#include "IRAssembler.h"
+#include "IRCode.h"
+#include "LoopInfo.h"
+#include "LoopInvariantCodeMotion.h"
+#include "RedexTest.h"
+
+class LoopInvariantCodeMotionTest : public RedexTest {};
+
+namespace {
+
+struct Result {
+  size_t hoisted;
+  // Instructions with the given opcode that are still inside a loop.
+  size_t left_in_loops;
+};
+
+Result run(const std::string& code_str, IROpcode op) {
+  auto* method =
+      DexMethod::make_method("LFoo;.bar:(I[I)V")
+          ->make_concrete(ACC_PUBLIC | ACC_STATIC, /* is_virtual */ false);
+  auto code = assembler::ircode_from_string(code_str);
+  code->build_cfg();
+  auto& cfg = code->cfg();
+  Result res{LoopInvariantCodeMotionPass::process_cfg(method, cfg), 0};
+
+  loop_impl::LoopInfo loop_info(std::as_const(cfg));
+  for (auto* block : cfg.blocks()) {
+    if (loop_info.get_loop_for(block) == nullptr) {
+      continue;
+    }
+    for (auto& mie : InstructionIterable(block)) {
+      if (mie.insn->opcode() == op) {
+        res.left_in_loops++;
+      }
+    }
+  }
+  code->clear_cfg();
+  return res;
+}
+
+} // namespace
+
+TEST_F(LoopInvariantCodeMotionTest, hoists_pure_instructions) {
+  auto res = run(R"(
+    (
+      (load-param v0)
+      (load-param-object v3)
+      (const v1 0)
+      (:loop)
+      (if-ge v1 v0 :end)
+      (const v2 5)
+      (add-int/lit v4 v2 3)
+      (add-int v1 v1 v4)
+      (goto :loop)
+      (:end)
+      (return-void)
+    )
+  )",
+                 OPCODE_ADD_INT_LIT);
+  EXPECT_EQ(res.hoisted, 2);
+  EXPECT_EQ(res.left_in_loops, 0);
+}
+
+TEST_F(LoopInvariantCodeMotionTest, keeps_variant_instructions) {
+  auto res = run(R"(
+    (
+      (load-param v0)
+      (load-param-object v3)
+      (const v1 0)
+      (:loop)
+      (if-ge v1 v0 :end)
+      (add-int/lit v1 v1 1)
+      (goto :loop)
+      (:end)
+      (return-void)
+    )
+  )",
+                 OPCODE_ADD_INT_LIT);
+  EXPECT_EQ(res.hoisted, 0);
+  EXPECT_EQ(res.left_in_loops, 1);
+}
+
+TEST_F(LoopInvariantCodeMotionTest, keeps_dest_live_into_header) {
+  // v2 still holds its value from before the loop in the first iteration.
+  auto res = run(R"(
+    (
+      (load-param v0)
+      (load-param-object v3)
+      (const v1 0)
+      (const v2 0)
+      (:loop)
+      (if-ge v1 v2 :end)
+      (add-int/lit v2 v0 3)
+      (add-int/lit v1 v1 1)
+      (goto :loop)
+      (:end)
+      (return-void)
+    )
+  )",
+                 OPCODE_ADD_INT_LIT);
+  EXPECT_EQ(res.hoisted, 0);
+  EXPECT_EQ(res.left_in_loops, 2);
+}
+
+TEST_F(LoopInvariantCodeMotionTest, hoists_array_length_from_header) {
+  auto res = run(R"(
+    (
+      (load-param v0)
+      (load-param-object v3)
+      (const v1 0)
+      (:loop)
+      (array-length v3)
+      (move-result-pseudo v2)
+      (if-ge v1 v2 :end)
+      (add-int/lit v1 v1 1)
+      (goto :loop)
+      (:end)
+      (return-void)
+    )
+  )",
+                 OPCODE_ARRAY_LENGTH);
+  EXPECT_EQ(res.hoisted, 1);
+  EXPECT_EQ(res.left_in_loops, 0);
+}
+
+TEST_F(LoopInvariantCodeMotionTest, keeps_array_length_after_side_effect) {
+  auto res = run(R"(
+    (
+      (load-param v0)
+      (load-param-object v3)
+      (const v1 0)
+      (:loop)
+      (invoke-static () "LFoo;.baz:()V")
+      (array-length v3)
+      (move-result-pseudo v2)
+      (if-ge v1 v2 :end)
+      (add-int/lit v1 v1 1)
+      (goto :loop)
+      (:end)
+      (return-void)
+    )
+  )",
+                 OPCODE_ARRAY_LENGTH);
+  EXPECT_EQ(res.hoisted, 0);
+  EXPECT_EQ(res.left_in_loops, 1);
+}
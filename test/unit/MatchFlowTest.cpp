@@ -936,5 +936,108 @@ TEST_F(MatchFlowTest, InstructionGraphTransitiveFailure) {
   EXPECT_EQ(locs.at(2), nullptr);
 }
 
+TEST_F(MatchFlowTest, IndexAliasAndResult) {
+  flow_t f;
+  auto fst = f.insn(m::invoke_static_() || m::const_string_());
+  auto snd = f.insn(m::any<IRInstruction*>());
+  auto lit = f.insn(m::const_());
+  auto add = f.insn(m::add_int_())
+                 .src(0, fst, exists | result)
+                 .src(1, snd, exists | alias);
+  auto sub = f.insn(m::sub_int_()).src(0, lit, exists | dest);
+
+  auto code = assembler::ircode_from_string(R"((
+    (load-param v0)
+    (switch v0 (:a :b :c))
+
+    (:a 0)
+    (const v0 0)
+    (const v1 1)
+    (goto :end)
+
+    (:b 1)
+    (invoke-static () "LFoo;.src:()I")
+    (move-result v0)
+    (move v1 v0)
+    (goto :end)
+
+    (:c 2)
+    (const-string "bar")
+    (move-result-pseudo-object v0)
+    (move v1 v0)
+    (goto :end)
+
+    (:end)
+    (add-int v2 v0 v1)
+    (sub-int v3 v1 v0)
+    (return-void)
+  ))");
+
+  cfg::ScopedCFG cfg{code.get()};
+  auto ii = InstructionIterable(*cfg);
+  auto mies = IndexedWrapper{ii};
+
+  ASSERT_INSN(const_1, mies[3], OPCODE_CONST);
+  ASSERT_INSN(invoke_src, mies[4], OPCODE_INVOKE_STATIC);
+  ASSERT_INSN(const_str, mies[7], OPCODE_CONST_STRING);
+  ASSERT_INSN(add_int, mies[10], OPCODE_ADD_INT);
+  ASSERT_INSN(sub_int, mies[11], OPCODE_SUB_INT);
+
+  method_index_t index{*cfg};
+  auto res = f.find(index, {add, sub});
+  EXPECT_INSNS(res.matching(add, add_int, 0), invoke_src, const_str);
+  EXPECT_INSNS(res.matching(add, add_int, 1), const_1, invoke_src, const_str);
+  // The other definitions of v1 are moves, which `dest` does not look through.
+  EXPECT_INSNS(res.matching(sub, sub_int, 0), const_1);
+}
+
+TEST_F(MatchFlowTest, IndexSharedAcrossFlows) {
+  auto is_even = m::matcher<int64_t>([](auto l) { return l % 2 == 0; });
+
+  flow_t f;
+  auto even = f.insn(m::const_(m::has_literal(is_even)));
+  auto add_all = f.insn(m::add_int_()).src(0, even, forall | dest);
+
+  flow_t g;
+  auto any_lit = g.insn(m::const_());
+  auto add_unique = g.insn(m::add_int_()).src(1, any_lit, unique | dest);
+
+  auto code = assembler::ircode_from_string(R"((
+    (load-param v0)
+    (const v2 6)
+    (if-eqz v0 :else)
+    (const v1 1)
+    (goto :end)
+    (:else)
+    (const v1 2)
+    (:end)
+    (add-int v3 v1 v2)
+    (add-int v4 v2 v1)
+    (return-void)
+  ))");
+
+  cfg::ScopedCFG cfg{code.get()};
+  auto ii = InstructionIterable(*cfg);
+  auto mies = IndexedWrapper{ii};
+
+  ASSERT_INSN(const_2_6, mies[1], OPCODE_CONST);
+  ASSERT_INSN(add_int_3, mies[5], OPCODE_ADD_INT);
+  ASSERT_INSN(add_int_4, mies[6], OPCODE_ADD_INT);
+
+  method_index_t index{*cfg};
+
+  auto res_f = f.find(index, add_all);
+  EXPECT_INSNS(res_f.matching(add_all), add_int_4);
+  EXPECT_INSNS(res_f.matching(add_all, add_int_4, 0), const_2_6);
+
+  auto res_g = g.find(index, add_unique);
+  EXPECT_INSNS(res_g.matching(add_unique), add_int_3);
+  EXPECT_INSNS(res_g.matching(add_unique, add_int_3, 1), const_2_6);
+
+  // Same results as without the index.
+  auto res_cfg = g.find(*cfg, add_unique);
+  EXPECT_INSNS(res_cfg.matching(add_unique), add_int_3);
+}
+
 } // namespace
 } // namespace mf
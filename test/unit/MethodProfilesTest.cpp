@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "MethodProfiles.h"
+#include "RedexTest.h"
+#include "RedexTestUtils.h"
+
+using namespace method_profiles;
+
+namespace {
+
+struct Row {
+  std::string name;
+  std::string interaction;
+  double appear_percent;
+  double call_count;
+  double order_percent;
+  int16_t min_api_level;
+};
+
+// Mirrors gen_binary_method_profile.py.
+void write_binary_profile(
+    const std::string& path,
+    const std::vector<std::pair<std::string, uint32_t>>& metadata,
+    const std::vector<std::string>& interactions,
+    const std::vector<Row>& rows) {
+  std::ofstream out(path, std::ofstream::binary);
+  auto write_raw = [&](const auto& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+  auto write_u4 = [&](uint32_t value) { write_raw(value); };
+  auto write_str = [&](const std::string& str) {
+    write_u4(str.size());
+    out.write(str.data(), str.size());
+  };
+
+  out.write("RDXPRF01", 8);
+  write_u4(metadata.size());
+  for (const auto& [interaction, count] : metadata) {
+    write_str(interaction);
+    write_u4(count);
+  }
+  write_u4(interactions.size());
+  for (const auto& interaction : interactions) {
+    write_str(interaction);
+  }
+  write_u4(rows.size());
+  std::string names;
+  write_u4(0);
+  for (const auto& row : rows) {
+    names += row.name;
+    write_u4(names.size());
+  }
+  write_str(names);
+  for (const auto& row : rows) {
+    auto it = std::find(interactions.begin(), interactions.end(),
+                        row.interaction);
+    write_u4(it - interactions.begin());
+  }
+  for (const auto& row : rows) {
+    write_raw(row.appear_percent);
+  }
+  for (const auto& row : rows) {
+    write_raw(row.call_count);
+  }
+  for (const auto& row : rows) {
+    write_raw(row.order_percent);
+  }
+  for (const auto& row : rows) {
+    write_raw(row.min_api_level);
+  }
+}
+
+} // namespace
+
+class MethodProfilesTest : public RedexTest {
+ protected:
+  MethodProfilesTest()
+      : m_tmp_dir(redex::make_tmp_dir("redex_method_profiles_test_%%%%%%%%")) {
+  }
+
+  redex::TempDir m_tmp_dir;
+};
+
+TEST_F(MethodProfilesTest, BinaryMatchesCsv) {
+  auto foo = DexMethod::make_method("LFoo;.foo:()V");
+  auto bar = DexMethod::make_method("LFoo;.bar:(I)V");
+
+  std::vector<Row> rows{
+      {"LFoo;.foo:()V", "ColdStart", 100.0, 1.5, 10.0, 21},
+      {"LFoo;.bar:(I)V", "ColdStart", 50.0, 2.0, 20.0, 23},
+      {"LFoo;.bar:(I)V", "Other", 25.0, 3.0, 30.0, 24},
+      {"LFoo;.unknown:()V", "ColdStart", 75.0, 1.0, 40.0, 21},
+  };
+
+  auto csv_path = m_tmp_dir.path + "/profile.csv";
+  {
+    std::ofstream csv(csv_path);
+    csv << "interaction,appear#\n";
+    csv << "ColdStart,7\n";
+    csv << "index,name,appear100,appear#,avg_call,avg_order,avg_rank100,"
+           "min_api_level,interaction\n";
+    for (size_t i = 0; i < rows.size(); ++i) {
+      const auto& row = rows[i];
+      csv << i << "," << row.name << "," << row.appear_percent << ",1,"
+          << row.call_count << ",0," << row.order_percent << ","
+          << row.min_api_level << "," << row.interaction << "\n";
+    }
+  }
+  auto binary_path = m_tmp_dir.path + "/profile.bin";
+  write_binary_profile(binary_path, {{"ColdStart", 7}}, {"ColdStart", "Other"},
+                       rows);
+
+  MethodProfiles from_csv;
+  from_csv.initialize({csv_path});
+  MethodProfiles from_binary;
+  from_binary.initialize({binary_path});
+
+  EXPECT_EQ(from_binary.size(), 3);
+  EXPECT_EQ(from_binary.size(), from_csv.size());
+  EXPECT_EQ(from_binary.unresolved_size(), 1);
+  EXPECT_EQ(from_binary.unresolved_size(), from_csv.unresolved_size());
+  EXPECT_EQ(*from_binary.get_interaction_count("ColdStart"), 7);
+  for (const auto& interaction : {COLD_START, std::string("Other")}) {
+    for (const auto* method : {foo, bar}) {
+      auto expected = from_csv.get_method_stat(interaction, method);
+      auto actual = from_binary.get_method_stat(interaction, method);
+      ASSERT_EQ(expected.has_value(), actual.has_value());
+      if (!expected) {
+        continue;
+      }
+      EXPECT_EQ(actual->appear_percent, expected->appear_percent);
+      EXPECT_EQ(actual->call_count, expected->call_count);
+      EXPECT_EQ(actual->order_percent, expected->order_percent);
+      EXPECT_EQ(actual->min_api_level, expected->min_api_level);
+    }
+  }
+  EXPECT_EQ(from_binary.get_method_stat("Other", bar)->min_api_level, 24);
+
+  DexMethod::make_method("LFoo;.unknown:()V");
+  from_binary.process_unresolved_lines();
+  EXPECT_EQ(from_binary.unresolved_size(), 0);
+  EXPECT_EQ(from_binary.size(), 4);
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Creators.h"
+#include "DexStore.h"
+#include "IRAssembler.h"
+#include "IRCode.h"
+#include "InitClassesWithSideEffects.h"
+#include "MethodSpecialization.h"
+#include "RedexTest.h"
+#include "Show.h"
+#include "Shrinker.h"
+#include "Walkers.h"
+
+namespace ms = method_specialization;
+
+class MethodSpecializationTest : public RedexTest {
+ protected:
+  void SetUp() override {
+    ClassCreator creator(DexType::make_type("LFoo;"));
+    creator.set_super(type::java_lang_Object());
+    m_callee = assembler::method_from_string(R"(
+      (method (public static) "LFoo;.callee:(I)I"
+       (
+        (load-param v0)
+        (if-eqz v0 :zero)
+        (const v1 1)
+        (add-int v1 v1 v0)
+        (mul-int v1 v1 v0)
+        (add-int v1 v1 v0)
+        (mul-int v1 v1 v0)
+        (add-int v1 v1 v0)
+        (return v1)
+        (:zero)
+        (const v1 7)
+        (return v1)
+       )
+      )
+    )");
+    m_caller = assembler::method_from_string(R"(
+      (method (public static) "LFoo;.caller:()I"
+       (
+        (const v0 0)
+        (invoke-static (v0) "LFoo;.callee:(I)I")
+        (move-result v1)
+        (return v1)
+       )
+      )
+    )");
+    creator.add_method(m_callee);
+    creator.add_method(m_caller);
+    m_cls = creator.create();
+  }
+
+  ms::Stats run(const std::unordered_set<DexMethod*>& hot_callers,
+                const ms::Config& config) {
+    auto store = DexStore("classes");
+    store.add_classes({m_cls});
+    DexStoresVector stores{store};
+    auto scope = build_class_scope(stores);
+    init_classes::InitClassesWithSideEffects init_classes_with_side_effects(
+        scope, /* create_init_class_insns */ false);
+    shrinker::ShrinkerConfig shrinker_config;
+    shrinker_config.run_const_prop = true;
+    shrinker_config.run_local_dce = true;
+    shrinker_config.compute_pure_methods = false;
+    shrinker::Shrinker shrinker(stores, scope, init_classes_with_side_effects,
+                                shrinker_config, /* min_sdk */ 0);
+    walk::code(scope, [&](DexMethod*, IRCode& code) { code.build_cfg(); });
+    auto stats = ms::specialize(scope, shrinker, hot_callers, config);
+    walk::code(scope, [&](DexMethod*, IRCode& code) { code.clear_cfg(); });
+    return stats;
+  }
+
+  DexMethodRef* invoked() {
+    for (auto& mie : InstructionIterable(m_caller->get_code())) {
+      if (mie.insn->opcode() == OPCODE_INVOKE_STATIC) {
+        return mie.insn->get_method();
+      }
+    }
+    return nullptr;
+  }
+
+  DexClass* m_cls;
+  DexMethod* m_callee;
+  DexMethod* m_caller;
+};
+
+TEST_F(MethodSpecializationTest, specializes_constant_argument) {
+  auto stats = run({m_caller}, ms::Config());
+  EXPECT_EQ(stats.specialized_methods, 1);
+  EXPECT_EQ(stats.retargeted_invokes, 1);
+
+  auto* specialization = DexMethod::get_method("LFoo;.callee$spec$0:(I)I");
+  ASSERT_NE(specialization, nullptr);
+  EXPECT_EQ(invoked(), specialization);
+  auto* code = specialization->as_def()->get_code();
+  EXPECT_LT(code->count_opcodes(), m_callee->get_code()->count_opcodes());
+}
+
+TEST_F(MethodSpecializationTest, respects_code_size_budget) {
+  ms::Config config;
+  config.max_code_size_increase = 0;
+  auto stats = run({m_caller}, config);
+  EXPECT_EQ(stats.specialized_methods, 0);
+  EXPECT_EQ(stats.rejected_specializations, 1);
+  EXPECT_EQ(invoked(), m_callee);
+}
+
+TEST_F(MethodSpecializationTest, ignores_cold_callers) {
+  auto stats = run({}, ms::Config());
+  EXPECT_EQ(stats.specialized_methods, 0);
+  EXPECT_EQ(invoked(), m_callee);
+}
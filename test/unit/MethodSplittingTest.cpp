@@ -355,6 +355,34 @@ TEST_F(MethodSplitterTest, SplitBranchFallthrough) {
   ASSERT_TRUE(res);
 }
 
+TEST_F(MethodSplitterTest, ColdOnlyKeepsPartiallyHotCode) {
+  // The branch target starts cold, but part of it is hot in one interaction.
+  auto before = R"(
+    (
+      (load-param v0)
+      (.src_block "LFoo;.bar:()V" 1 (0.5 0.5))
+      (add-int v0 v0 v0)
+      (add-int v0 v0 v0)
+      (if-eqz v0 :L0)
+      (.src_block "LFoo;.bar:()V" 2 (0.0 0.0))
+      (add-int v0 v0 v0)
+      (add-int v0 v0 v0)
+      (.src_block "LFoo;.bar:()V" 3 (0.0 0.5))
+      (add-int v0 v0 v0)
+      (add-int v0 v0 v0)
+    (:L0)
+      (return v0)
+    ))";
+  auto config = defaultConfig();
+  config.min_hot_cold_split_size = 4;
+  config.cold_only = true;
+  auto res = test("(I)I",
+                  before,
+                  config,
+                  {std::make_pair<std::string, std::string>("", before)});
+  ASSERT_TRUE(res);
+}
+
 TEST_F(MethodSplitterTest, SplitSwitch) {
   auto before = R"(
     (
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "IRAssembler.h"
+#include "MethodStartupPageOrderer.h"
+#include "RedexTest.h"
+
+using namespace method_profiles;
+
+class MethodStartupPageOrdererTest : public RedexTest {
+ protected:
+  std::vector<DexMethod*> make_methods(size_t count) {
+    auto* type = DexType::make_type("LFoo;");
+    auto* proto =
+        DexProto::make_proto(type::_void(), DexTypeList::make_type_list({}));
+    std::vector<DexMethod*> methods;
+    for (size_t i = 0; i < count; ++i) {
+      auto* method =
+          DexMethod::make_method(
+              type, DexString::make_string("m" + std::to_string(i)), proto)
+              ->make_concrete(ACC_PUBLIC | ACC_STATIC, false);
+      method->set_code(assembler::ircode_from_string("((return-void))"));
+      methods.push_back(method);
+    }
+    return methods;
+  }
+};
+
+TEST_F(MethodStartupPageOrdererTest, ProfiledMethodsComeFirst) {
+  auto methods = make_methods(40);
+  StatsMap stats;
+  for (size_t i = 0; i < methods.size(); i += 2) {
+    stats[methods[i]] = Stats{100, 1, i < 20 ? 1.0 : 90.0, 0};
+  }
+  auto profiles = MethodProfiles::initialize(COLD_START, stats);
+
+  auto ordered = methods;
+  MethodStartupPageOrderer(profiles, /* min_appear_percent */ 10)
+      .order(ordered);
+
+  ASSERT_EQ(ordered.size(), methods.size());
+  EXPECT_TRUE(std::is_permutation(ordered.begin(), ordered.end(),
+                                  methods.begin()));
+  for (size_t i = 0; i < ordered.size(); ++i) {
+    EXPECT_EQ(stats.count(ordered[i]), i < 20 ? 1u : 0u) << i;
+  }
+  // Unprofiled methods keep their relative order.
+  for (size_t i = 20; i < ordered.size(); ++i) {
+    EXPECT_EQ(ordered[i], methods[2 * (i - 20) + 1]);
+  }
+}
+
+TEST_F(MethodStartupPageOrdererTest, EstimatePages) {
+  // Each method takes a 16-byte header plus a single code unit, aligned to
+  // 20 bytes, so the 300 methods span two pages.
+  auto methods = make_methods(300);
+  std::vector<const DexMethod*> layout(methods.begin(), methods.end());
+
+  StatsMap stats;
+  EXPECT_EQ(MethodStartupPageOrderer::estimate_pages(layout, stats, 10), 0u);
+
+  stats[methods[0]] = Stats{100, 1, 0, 0};
+  stats[methods[1]] = Stats{100, 1, 0, 0};
+  EXPECT_EQ(MethodStartupPageOrderer::estimate_pages(layout, stats, 10), 1u);
+
+  stats[methods[299]] = Stats{100, 1, 0, 0};
+  EXPECT_EQ(MethodStartupPageOrderer::estimate_pages(layout, stats, 10), 2u);
+  // Methods below the appear threshold are not counted.
+  EXPECT_EQ(MethodStartupPageOrderer::estimate_pages(layout, stats, 100.5), 0u);
+}
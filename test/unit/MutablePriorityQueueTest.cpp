@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "MutablePriorityQueue.h"
+
+#include <gtest/gtest.h>
+
+TEST(MutablePriorityQueueTest, updatePriority) {
+  MutablePriorityQueue<int, int> pq;
+  pq.insert(1, 10);
+  pq.insert(2, 20);
+  pq.insert(3, 30);
+  EXPECT_EQ(pq.front(), 3);
+  EXPECT_EQ(pq.back(), 1);
+
+  pq.update_priority(1, 40);
+  EXPECT_EQ(pq.front(), 1);
+  EXPECT_EQ(pq.get_priority(1), 40);
+
+  // Unchanged priorities are fine, and leave the queue as it is.
+  pq.update_priority(2, 20);
+  EXPECT_EQ(pq.back(), 2);
+  EXPECT_EQ(pq.get_priority(2), 20);
+
+  // The freed priority can be taken by another value.
+  pq.update_priority(3, 10);
+  EXPECT_EQ(pq.back(), 3);
+
+  pq.erase(1);
+  EXPECT_EQ(pq.front(), 2);
+  EXPECT_FALSE(pq.contains(1));
+  pq.erase(2);
+  pq.erase(3);
+  EXPECT_TRUE(pq.empty());
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "PassCache.h"
+#include "RedexTestUtils.h"
+
+TEST(PassCacheTest, DisabledWithoutDirectory) {
+  PassCache cache("");
+  EXPECT_FALSE(cache.enabled());
+  cache.record("FooPass#1", {"a", "c", "a", {}});
+  // Nothing to write to.
+  cache.save();
+}
+
+TEST(PassCacheTest, RoundTrip) {
+  auto tmp_dir = redex::make_tmp_dir("redex_pass_cache_test_%%%%%%%%");
+  {
+    PassCache cache(tmp_dir.path);
+    EXPECT_TRUE(cache.enabled());
+    EXPECT_FALSE(cache.find_noop("FooPass#1", "a", "c"));
+    cache.record("FooPass#1", {"a", "c", "a", {{"num_foos", 42}}});
+    cache.record("BarPass#1", {"a", "c", "b", {}});
+    cache.save();
+  }
+
+  PassCache cache(tmp_dir.path);
+  auto entry = cache.find_noop("FooPass#1", "a", "c");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(entry->metrics.at("num_foos"), 42);
+
+  // Different input or configuration.
+  EXPECT_FALSE(cache.find_noop("FooPass#1", "b", "c"));
+  EXPECT_FALSE(cache.find_noop("FooPass#1", "a", "d"));
+  // The pass changed the scope, so its result cannot be replayed.
+  EXPECT_FALSE(cache.find_noop("BarPass#1", "a", "c"));
+}
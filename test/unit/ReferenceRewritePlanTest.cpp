@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ReferenceRewritePlan.h"
+
+#include "Creators.h"
+#include "DexAnnotation.h"
+#include "IRAssembler.h"
+#include "RedexTest.h"
+
+using namespace reference_update;
+
+struct ReferenceRewritePlanTest : public RedexTest {
+  DexType* m_old_type;
+  DexType* m_new_type;
+  DexClass* m_user;
+  Scope m_scope;
+
+  ReferenceRewritePlanTest() {
+    m_old_type = make_class("LOld;");
+    m_new_type = make_class("LNew;");
+    m_user = type_class(make_class("LUser;"));
+  }
+
+  DexType* make_class(const std::string& name) {
+    auto type = DexType::make_type(name);
+    ClassCreator creator(type);
+    creator.set_super(type::java_lang_Object());
+    m_scope.push_back(creator.create());
+    return type;
+  }
+
+  DexMethod* make_method(const std::string& sig, const std::string& code) {
+    auto method = DexMethod::make_method(sig)->make_concrete(
+        ACC_PUBLIC | ACC_STATIC, /* is_virtual */ false);
+    method->set_code(assembler::ircode_from_string(code));
+    type_class(method->get_class())->add_method(method);
+    return method;
+  }
+};
+
+TEST_F(ReferenceRewritePlanTest, rewrite_code) {
+  auto old_callee = make_method("LOld;.callee:()V", "((return-void))");
+  auto new_callee = make_method("LNew;.callee:()V", "((return-void))");
+  auto caller = make_method("LUser;.caller:()V", R"(
+    (
+      (const-class "LOld;")
+      (move-result-pseudo-object v0)
+      (const v1 1)
+      (new-array v1 "[LOld;")
+      (move-result-pseudo-object v2)
+      (invoke-static () "LOld;.callee:()V")
+      (return-void)
+    )
+  )");
+
+  RewritePlan plan;
+  plan.add_type(m_old_type, m_new_type);
+  plan.add_method(old_callee, new_callee);
+  auto stats = plan.apply(m_scope);
+  EXPECT_EQ(stats.code_refs, 3);
+
+  auto expected = assembler::ircode_from_string(R"(
+    (
+      (const-class "LNew;")
+      (move-result-pseudo-object v0)
+      (const v1 1)
+      (new-array v1 "[LNew;")
+      (move-result-pseudo-object v2)
+      (invoke-static () "LNew;.callee:()V")
+      (return-void)
+    )
+  )");
+  EXPECT_CODE_EQ(caller->get_code(), expected.get());
+}
+
+TEST_F(ReferenceRewritePlanTest, rewrite_annotations) {
+  auto anno = std::make_unique<DexAnnotation>(
+      DexType::make_type("LAnno;"), DAV_RUNTIME);
+  anno->add_element("value", std::make_unique<DexEncodedValueType>(
+                                 type::make_array_type(m_old_type)));
+  auto anno_set = std::make_unique<DexAnnotationSet>();
+  anno_set->add_annotation(std::move(anno));
+  m_user->attach_annotation_set(std::move(anno_set));
+
+  RewritePlan plan;
+  plan.add_type(m_old_type, m_new_type);
+  auto stats = plan.apply(m_scope);
+  EXPECT_EQ(stats.annotation_refs, 1);
+
+  const auto& annos = m_user->get_anno_set()->get_annotations();
+  const auto& elems = annos.at(0)->anno_elems();
+  auto* value =
+      static_cast<DexEncodedValueType*>(elems.at(0).encoded_value.get());
+  EXPECT_EQ(value->type(), type::make_array_type(m_new_type));
+}
+
+TEST_F(ReferenceRewritePlanTest, rewrite_signatures) {
+  auto method = make_method("LUser;.take:(LOld;)V", R"(
+    (
+      (load-param-object v0)
+      (return-void)
+    )
+  )");
+  auto field =
+      DexField::make_field("LUser;.f:LOld;")->make_concrete(ACC_PUBLIC);
+  m_user->add_field(field);
+  auto caller = make_method("LUser;.caller:()V", R"(
+    (
+      (const v0 0)
+      (invoke-static (v0) "LUser;.take:(LOld;)V")
+      (return-void)
+    )
+  )");
+
+  RewritePlan plan;
+  plan.add_type(m_old_type, m_new_type);
+  plan.apply(m_scope);
+
+  EXPECT_EQ(method->get_proto()->get_args()->at(0), m_new_type);
+  EXPECT_EQ(field->get_type(), m_new_type);
+  // The reference in code is the definition itself.
+  for (auto& mie : InstructionIterable(caller->get_code())) {
+    if (mie.insn->opcode() == OPCODE_INVOKE_STATIC) {
+      EXPECT_EQ(mie.insn->get_method(), method);
+    }
+  }
+}
+
+TEST_F(ReferenceRewritePlanTest, skip_code) {
+  auto code = R"(
+    (
+      (const-class "LOld;")
+      (move-result-pseudo-object v0)
+      (return-void)
+    )
+  )";
+  auto method = make_method("LOld;.self:()V", code);
+
+  RewritePlan plan;
+  plan.add_type(m_old_type, m_new_type);
+  RewriteOptions options;
+  options.skip_code = [&](const DexClass* cls) {
+    return cls->get_type() == m_old_type;
+  };
+  auto stats = plan.apply(m_scope, options);
+  EXPECT_EQ(stats.code_refs, 0);
+  EXPECT_CODE_EQ(method->get_code(), assembler::ircode_from_string(code).get());
+}
@@ -232,6 +232,38 @@ TEST_F(RegAllocTest, CombineNonAdjacentNodes) {
   EXPECT_FALSE(ig.get_node(2).is_active());
 }
 
+/*
+ * High-degree nodes switch to a bit vector for their adjacency; make sure
+ * queries agree with the edges we added on both sides of that threshold.
+ */
+TEST_F(RegAllocTest, HighDegreeAdjacency) {
+  using namespace interference::impl;
+  auto ig = GraphBuilder::create_empty();
+  constexpr reg_t NUM_NODES = 300;
+  for (reg_t i = 0; i < NUM_NODES; ++i) {
+    GraphBuilder::make_node(&ig, i, RegisterType::NORMAL,
+                            /* max_vreg */ 255);
+  }
+  for (reg_t i = 1; i < NUM_NODES; i += 2) {
+    GraphBuilder::add_edge(&ig, 0, i);
+  }
+  ig.add_coalesceable_edge(2, 4);
+  ig.add_coalesceable_edge(2, 6);
+  GraphBuilder::add_edge(&ig, 6, 2);
+
+  EXPECT_EQ(ig.get_node(0).adjacent().size(), NUM_NODES / 2);
+  for (reg_t i = 1; i < NUM_NODES; ++i) {
+    EXPECT_EQ(ig.is_adjacent(0, i), i % 2 == 1) << i;
+    EXPECT_EQ(ig.is_adjacent(i, 0), i % 2 == 1) << i;
+  }
+  EXPECT_FALSE(ig.is_adjacent(0, 0));
+  EXPECT_TRUE(ig.is_adjacent(4, 2));
+  EXPECT_TRUE(ig.is_coalesceable(2, 4));
+  EXPECT_FALSE(ig.is_coalesceable(2, 6));
+  EXPECT_FALSE(ig.is_coalesceable(0, 1));
+  EXPECT_TRUE(ig.is_coalesceable(0, 2));
+}
+
 TEST_F(RegAllocTest, CombineAdjacentNodes) {
   using namespace interference::impl;
   auto ig = GraphBuilder::create_empty();
@@ -913,3 +945,33 @@ TEST_F(RegAllocTest, NoOverwriteThis) {
   method->get_code()->clear_cfg();
   EXPECT_CODE_EQ(expected_code.get(), method->get_code());
 }
+
+TEST_F(RegAllocTest, NoCoalescing) {
+  auto make_method = [](const std::string& name) {
+    auto method = assembler::method_from_string(R"(
+      (method (public static) "LFoo;.)" +
+                                                name + R"(:(I)I"
+       (
+        (load-param v0)
+        (move v1 v0)
+        (return v1)
+       )
+      )
+    )");
+    method->get_code()->set_registers_size(2);
+    method->get_code()->build_cfg();
+    return method;
+  };
+
+  graph_coloring::Allocator::Config config;
+  auto stats = graph_coloring::allocate(config, make_method("coalesced"));
+  EXPECT_EQ(stats.moves_coalesced, 1);
+
+  config.use_coalescing = false;
+  auto method = make_method("not_coalesced");
+  stats = graph_coloring::allocate(config, method);
+  EXPECT_EQ(stats.moves_coalesced, 0);
+  auto& cfg = method->get_code()->cfg();
+  EXPECT_EQ(cfg.get_registers_size(), 1);
+  method->get_code()->clear_cfg();
+}
@@ -212,3 +212,138 @@ TEST_F(RemoveRecursiveLocksTest, recursion_nested) {
     ))");
   EXPECT_CODE_EQ(code, expected_code.get());
 }
+
+namespace {
+
+RemoveRecursiveLocksPass::Config only(bool thread_local_locks,
+                                      bool string_buffers,
+                                      bool coarsen) {
+  RemoveRecursiveLocksPass::Config config;
+  config.elide_thread_local_locks = thread_local_locks;
+  config.replace_string_buffers = string_buffers;
+  config.coarsen_locks = coarsen;
+  return config;
+}
+
+size_t count_monitors(IRCode* code) {
+  size_t res = 0;
+  for (const auto& mie : InstructionIterable(code)) {
+    res += opcode::is_a_monitor(mie.insn->opcode()) ? 1 : 0;
+  }
+  return res;
+}
+
+} // namespace
+
+TEST_F(RemoveRecursiveLocksTest, replace_string_buffer) {
+  auto method = assembler::method_from_string(R"(
+    (method (public static) "LTest;.foo:()Ljava/lang/String;"
+      (
+        (new-instance "Ljava/lang/StringBuffer;")
+        (move-result-pseudo-object v0)
+        (invoke-direct (v0) "Ljava/lang/StringBuffer;.<init>:()V")
+        (const-string "a")
+        (move-result-pseudo-object v1)
+        (invoke-virtual (v0 v1) "Ljava/lang/StringBuffer;.append:(Ljava/lang/String;)Ljava/lang/StringBuffer;")
+        (move-result-object v2)
+        (invoke-virtual (v2) "Ljava/lang/StringBuffer;.toString:()Ljava/lang/String;")
+        (move-result-object v1)
+        (return-object v1)
+      )
+    ))");
+  auto code = method->get_code();
+  code->build_cfg();
+  auto res = RemoveRecursiveLocksPass::elide(method, code,
+                                             only(false, true, false));
+  EXPECT_EQ(res, 1);
+  code->clear_cfg();
+  auto expected_code = assembler::ircode_from_string(R"(
+    (
+      (new-instance "Ljava/lang/StringBuilder;")
+      (move-result-pseudo-object v0)
+      (invoke-direct (v0) "Ljava/lang/StringBuilder;.<init>:()V")
+      (const-string "a")
+      (move-result-pseudo-object v1)
+      (invoke-virtual (v0 v1) "Ljava/lang/StringBuilder;.append:(Ljava/lang/String;)Ljava/lang/StringBuilder;")
+      (move-result-object v2)
+      (invoke-virtual (v2) "Ljava/lang/StringBuilder;.toString:()Ljava/lang/String;")
+      (move-result-object v1)
+      (return-object v1)
+    ))");
+  EXPECT_CODE_EQ(code, expected_code.get());
+}
+
+TEST_F(RemoveRecursiveLocksTest, keep_escaping_string_buffer) {
+  auto method = assembler::method_from_string(R"(
+    (method (public static) "LTest;.foo:()Ljava/lang/StringBuffer;"
+      (
+        (new-instance "Ljava/lang/StringBuffer;")
+        (move-result-pseudo-object v0)
+        (invoke-direct (v0) "Ljava/lang/StringBuffer;.<init>:()V")
+        (return-object v0)
+      )
+    ))");
+  auto code = method->get_code();
+  code->build_cfg();
+  auto res = RemoveRecursiveLocksPass::elide(method, code,
+                                             only(false, true, false));
+  EXPECT_EQ(res, 0);
+  code->clear_cfg();
+}
+
+TEST_F(RemoveRecursiveLocksTest, remove_thread_local_monitor) {
+  auto method = assembler::method_from_string(R"(
+    (method (public static) "LTest;.foo:()V"
+      (
+        (new-instance "Ljava/lang/Object;")
+        (move-result-pseudo-object v0)
+        (invoke-direct (v0) "Ljava/lang/Object;.<init>:()V")
+        (monitor-enter v0)
+      (.try_start c0)
+        (monitor-exit v0)
+      (.try_end c0)
+        (return-void)
+      (.catch (c0))
+        (move-exception v1)
+        (throw v1)
+      )
+    ))");
+  auto code = method->get_code();
+  code->build_cfg();
+  auto res = RemoveRecursiveLocksPass::elide(method, code,
+                                             only(true, false, false));
+  EXPECT_EQ(res, 2);
+  code->clear_cfg();
+  EXPECT_EQ(count_monitors(code), 0);
+}
+
+TEST_F(RemoveRecursiveLocksTest, coarsen_adjacent_regions) {
+  auto method = assembler::method_from_string(R"(
+    (method (public static) "LTest;.foo:(Ljava/lang/Object;)V"
+      (
+        (load-param-object v0)
+        (monitor-enter v0)
+      (.try_start c0)
+        (monitor-exit v0)
+      (.try_end c0)
+        (monitor-enter v0)
+      (.try_start c1)
+        (monitor-exit v0)
+      (.try_end c1)
+        (return-void)
+      (.catch (c0))
+        (move-exception v1)
+        (throw v1)
+      (.catch (c1))
+        (move-exception v1)
+        (throw v1)
+      )
+    ))");
+  auto code = method->get_code();
+  code->build_cfg();
+  auto res = RemoveRecursiveLocksPass::elide(method, code,
+                                             only(false, false, true));
+  EXPECT_EQ(res, 2);
+  code->clear_cfg();
+  EXPECT_EQ(count_monitors(code), 2);
+}
@@ -499,6 +499,41 @@ TEST_F(RemoveUninstantiablesTest, InstanceOf) {
   EXPECT_EQ(1, stats.instance_ofs);
 }
 
+TEST_F(RemoveUninstantiablesTest, UninstantiableTypesBitmap) {
+  def_class("LFoo;");
+  def_class("LBar;", Bar_init);
+
+  remove_uninstantiables_impl::UninstantiableTypes uninstantiable_types;
+  for (auto* type : compute_uninstantiable_types()) {
+    uninstantiable_types.insert(type_class(type));
+  }
+  EXPECT_TRUE(uninstantiable_types.contains(DexType::get_type("LFoo;")));
+  EXPECT_FALSE(uninstantiable_types.contains(DexType::get_type("LBar;")));
+  EXPECT_TRUE(uninstantiable_types.contains(type::java_lang_Void()));
+  EXPECT_FALSE(uninstantiable_types.contains(DexType::make_type("LNoCls;")));
+
+  remove_uninstantiables_impl::Stats stats;
+  EXPECT_CHANGE(
+      [&](cfg::ControlFlowGraph& cfg) {
+        return remove_uninstantiables_impl::replace_uninstantiable_refs(
+            uninstantiable_types, cfg);
+      },
+      stats,
+      /* ACTUAL */ R"((
+        (instance-of v0 "LFoo;")
+        (move-result-pseudo v1)
+        (instance-of v0 "LBar;")
+        (move-result-pseudo v1)
+      ))",
+      /* EXPECTED */ R"((
+        (const v1 0)
+        (instance-of v0 "LBar;")
+        (move-result-pseudo v1)
+      ))");
+
+  EXPECT_EQ(1, stats.instance_ofs);
+}
+
 TEST_F(RemoveUninstantiablesTest, InstanceOfUnimplementedInterface) {
   auto cls = def_class("LFoo;");
   cls->set_access(cls->get_access() | ACC_INTERFACE | ACC_ABSTRACT);
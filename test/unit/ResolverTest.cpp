@@ -421,3 +421,28 @@ TEST_F(ResolverTest, ResolveMethod) {
   EXPECT_TRUE(resolve_method(g_method, MethodSearch::InterfaceVirtual) ==
               e_method);
 }
+
+TEST_F(ResolverTest, ResolveMethodCached) {
+  create_method_scope();
+
+  auto b_method = DexMethod::get_method("B.method:()V");
+  auto c_method = DexMethod::get_method("C.method:()V");
+  ASSERT_TRUE(c_method != nullptr && !c_method->is_def());
+
+  resolver_cache::reset_stats();
+  EXPECT_EQ(resolve_method_cached(c_method, MethodSearch::Virtual), b_method);
+  EXPECT_EQ(resolve_method_cached(c_method, MethodSearch::Virtual), b_method);
+  EXPECT_EQ(resolve_method_cached(c_method, MethodSearch::Direct), nullptr);
+  auto stats = resolver_cache::get_stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+
+  // Changing a member list invalidates the cached resolutions.
+  auto b_cls = type_class(b_method->get_class());
+  b_cls->remove_method(b_method->as_def());
+  auto expected = resolve_method(c_method, MethodSearch::Virtual);
+  EXPECT_NE(expected, b_method);
+  EXPECT_EQ(resolve_method_cached(c_method, MethodSearch::Virtual), expected);
+  b_cls->add_method(b_method->as_def());
+  EXPECT_EQ(resolve_method_cached(c_method, MethodSearch::Virtual), b_method);
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "ControlFlow.h"
+#include "Creators.h"
+#include "IRAssembler.h"
+#include "IRCode.h"
+#include "MethodOverrideGraph.h"
+#include "RedexTest.h"
+#include "Show.h"
+#include "SpeculativeDevirtualization.h"
+#include "VirtualScope.h"
+
+namespace sd = speculative_devirtualization;
+
+class SpeculativeDevirtualizationTest : public RedexTest {
+ public:
+  SpeculativeDevirtualizationTest() {
+    virt_scope::get_vmethods(type::java_lang_Object());
+    type_class(type::java_lang_Object())->set_external();
+
+    auto* i_type = DexType::make_type("LI;");
+    ClassCreator i_creator(i_type);
+    i_creator.set_access(ACC_PUBLIC | ACC_INTERFACE | ACC_ABSTRACT);
+    i_creator.set_super(type::java_lang_Object());
+    auto* i_m = DexMethod::make_method("LI;.m:()I")
+                    ->make_concrete(ACC_PUBLIC | ACC_ABSTRACT,
+                                    /* is_virtual */ true);
+    i_creator.add_method(i_m);
+    m_scope.push_back(i_creator.create());
+
+    for (auto [name, value] : {std::pair("LA;", 1), std::pair("LB;", 2)}) {
+      ClassCreator creator(DexType::make_type(name));
+      creator.set_access(ACC_PUBLIC);
+      creator.set_super(type::java_lang_Object());
+      creator.add_interface(i_type);
+      creator.add_method(assembler::method_from_string(
+          "(method (public) \"" + std::string(name) +
+          ".m:()I\" ((load-param-object v0) (const v1 " +
+          std::to_string(value) + ") (return v1)))"));
+      m_scope.push_back(creator.create());
+    }
+
+    m_caller = assembler::method_from_string(R"(
+      (method (public static) "LFoo;.bar:(LI;)I"
+        (
+          (load-param-object v0)
+          (invoke-interface (v0) "LI;.m:()I")
+          (move-result v1)
+          (return v1)
+        )
+      )
+    )");
+    ClassCreator foo_creator(DexType::make_type("LFoo;"));
+    foo_creator.set_super(type::java_lang_Object());
+    foo_creator.add_method(m_caller);
+    m_scope.push_back(foo_creator.create());
+  }
+
+  size_t speculate(const std::string& profile) {
+    std::istringstream input(profile);
+    auto speculations = sd::read_receiver_profile(input, /* min_calls */ 100,
+                                                  /* min_share_percent */ 90);
+    auto it = speculations.find(m_caller);
+    if (it == speculations.end()) {
+      return 0;
+    }
+    auto graph = method_override_graph::build_graph(m_scope);
+    m_caller->get_code()->build_cfg();
+    auto res = sd::speculate(*graph, m_caller, it->second);
+    m_caller->get_code()->clear_cfg();
+    return res;
+  }
+
+  size_t count(IROpcode op, const char* method = nullptr) {
+    size_t res = 0;
+    for (auto& mie : InstructionIterable(m_caller->get_code())) {
+      if (mie.insn->opcode() == op &&
+          (method == nullptr || show(mie.insn->get_method()) == method)) {
+        res++;
+      }
+    }
+    return res;
+  }
+
+ protected:
+  Scope m_scope;
+  DexMethod* m_caller;
+};
+
+TEST_F(SpeculativeDevirtualizationTest, guards_dominant_receiver) {
+  EXPECT_EQ(speculate("LFoo;.bar:(LI;)I,LI;.m:()I,LA;,950\n"
+                      "LFoo;.bar:(LI;)I,LI;.m:()I,LB;,50\n"),
+            1);
+  EXPECT_EQ(count(OPCODE_INSTANCE_OF), 1);
+  EXPECT_EQ(count(OPCODE_CHECK_CAST), 1);
+  EXPECT_EQ(count(OPCODE_INVOKE_VIRTUAL, "LA;.m:()I"), 1);
+  EXPECT_EQ(count(OPCODE_INVOKE_INTERFACE, "LI;.m:()I"), 1);
+  EXPECT_EQ(count(OPCODE_MOVE_RESULT), 2);
+}
+
+TEST_F(SpeculativeDevirtualizationTest, skips_polymorphic_call_site) {
+  EXPECT_EQ(speculate("LFoo;.bar:(LI;)I,LI;.m:()I,LA;,600\n"
+                      "LFoo;.bar:(LI;)I,LI;.m:()I,LB;,400\n"),
+            0);
+  EXPECT_EQ(count(OPCODE_INSTANCE_OF), 0);
+  EXPECT_EQ(count(OPCODE_INVOKE_INTERFACE, "LI;.m:()I"), 1);
+}
+
+TEST_F(SpeculativeDevirtualizationTest, skips_cold_call_site) {
+  EXPECT_EQ(speculate("LFoo;.bar:(LI;)I,LI;.m:()I,LA;,10\n"), 0);
+  EXPECT_EQ(count(OPCODE_INSTANCE_OF), 0);
+}
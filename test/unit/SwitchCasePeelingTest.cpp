@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include "ControlFlow.h"
+#include "IRAssembler.h"
+#include "IRCode.h"
+#include "RedexTest.h"
+#include "SwitchCasePeeling.h"
+
+namespace scp = switch_case_peeling;
+
+class SwitchCasePeelingTest : public RedexTest {
+ public:
+  // A switch over v0 that is executed 100 times, where case i is taken
+  // hits[i] times.
+  static std::unique_ptr<IRCode> make_code(
+      const std::vector<std::pair<int32_t, float>>& hits) {
+    std::string labels;
+    std::string cases;
+    uint32_t id = 1;
+    for (auto [key, val] : hits) {
+      auto label = ":c" + std::to_string(id);
+      labels += label + " ";
+      cases += "(" + label + " " + std::to_string(key) + ")" +
+               "(.src_block \"LFoo;.bar:(I)V\" " + std::to_string(id++) +
+               " (" + std::to_string(val) + " 1.0))" +
+               "(const v1 " + std::to_string(key) + ")(return v1)";
+    }
+    return assembler::ircode_from_string(
+        "((load-param v0)(.src_block \"LFoo;.bar:(I)V\" 0 (100.0 1.0))"
+        "(switch v0 (" +
+        labels + "))(const v1 -1)(return v1)" + cases + ")");
+  }
+
+  struct Shape {
+    size_t switch_cases{0};
+    size_t switches{0};
+    size_t ifs{0};
+    // The key tested first, if the entry block ends with an if.
+    int64_t first_key{-1};
+  };
+
+  static Shape shape(cfg::ControlFlowGraph& cfg) {
+    Shape res;
+    for (auto* block : cfg.blocks()) {
+      auto last_it = block->get_last_insn();
+      if (last_it == block->end()) {
+        continue;
+      }
+      auto op = last_it->insn->opcode();
+      if (op == OPCODE_SWITCH) {
+        res.switches++;
+        for (auto* e : block->succs()) {
+          if (e->type() == cfg::EDGE_BRANCH) {
+            res.switch_cases++;
+          }
+        }
+      } else if (op == OPCODE_IF_EQ || op == OPCODE_IF_EQZ) {
+        res.ifs++;
+      }
+    }
+    auto* entry = cfg.entry_block();
+    auto last_it = entry->get_last_insn();
+    if (last_it->insn->opcode() == OPCODE_IF_EQZ) {
+      res.first_key = 0;
+    } else if (last_it->insn->opcode() == OPCODE_IF_EQ) {
+      res.first_key = std::prev(last_it)->insn->get_literal();
+    }
+    return res;
+  }
+};
+
+TEST_F(SwitchCasePeelingTest, peels_hot_cases_in_order) {
+  auto code = make_code({{0, 5}, {1, 30}, {2, 60}, {3, 5}});
+  code->build_cfg();
+  auto stats = scp::process_cfg(code->cfg(), scp::Config());
+  EXPECT_EQ(stats.switches_with_peeled_cases, 1);
+  EXPECT_EQ(stats.peeled_cases, 2);
+  auto res = shape(code->cfg());
+  EXPECT_EQ(res.switches, 1);
+  EXPECT_EQ(res.switch_cases, 2);
+  EXPECT_EQ(res.ifs, 2);
+  EXPECT_EQ(res.first_key, 2);
+  code->clear_cfg();
+}
+
+TEST_F(SwitchCasePeelingTest, keeps_packed_switch_packed) {
+  auto code = make_code({{0, 5}, {1, 60}, {2, 30}, {3, 5}, {10, 0}});
+  code->build_cfg();
+  auto stats = scp::process_cfg(code->cfg(), scp::Config());
+  EXPECT_EQ(stats.peeled_cases, 2);
+  auto res = shape(code->cfg());
+  EXPECT_EQ(res.switch_cases, 5);
+  EXPECT_EQ(res.first_key, 1);
+  code->clear_cfg();
+}
+
+TEST_F(SwitchCasePeelingTest, removes_fully_peeled_switch) {
+  auto code = make_code({{0, 25}, {1, 25}, {2, 25}, {3, 25}});
+  code->build_cfg();
+  scp::Config config;
+  config.max_peeled_cases = 4;
+  config.min_case_share_percent = 20;
+  auto stats = scp::process_cfg(code->cfg(), config);
+  EXPECT_EQ(stats.removed_switches, 1);
+  auto res = shape(code->cfg());
+  EXPECT_EQ(res.switches, 0);
+  EXPECT_EQ(res.ifs, 4);
+  EXPECT_EQ(res.first_key, 0);
+  code->clear_cfg();
+}
+
+TEST_F(SwitchCasePeelingTest, ignores_flat_profile) {
+  auto code = make_code({{0, 20}, {1, 20}, {2, 20}, {3, 20}, {4, 20}});
+  code->build_cfg();
+  auto stats = scp::process_cfg(code->cfg(), scp::Config());
+  EXPECT_EQ(stats.switches_with_peeled_cases, 0);
+  auto res = shape(code->cfg());
+  EXPECT_EQ(res.switch_cases, 5);
+  EXPECT_EQ(res.ifs, 0);
+  code->clear_cfg();
+}
@@ -9,6 +9,7 @@
 
 #include "IRAssembler.h"
 #include "RedexTest.h"
+#include "Show.h"
 #include "TypeInference.h"
 
 using namespace testing;
@@ -45,3 +46,55 @@ TEST_F(TypeInferenceTest, const0) {
     }
   }
 }
+
+TEST_F(TypeInferenceTest, onDemandTypeEnvironments) {
+  auto method = assembler::method_from_string(R"(
+    (method (public static) "LFoo;.bar:(LBar;I)V"
+     (
+      (load-param-object v0)
+      (load-param v1)
+      (const v2 0)
+      (if-eqz v1 :else)
+      (new-instance "LBaz;")
+      (move-result-pseudo-object v2)
+      (goto :join)
+      (:else)
+      (check-cast v0 "LBaz;")
+      (move-result-pseudo-object v2)
+      (:join)
+      (:loop)
+      (if-eqz v1 :end)
+      (add-int/lit v1 v1 -1)
+      (move-object v3 v2)
+      (invoke-static (v3) "LFoo;.baz:(LBaz;)V")
+      (goto :loop)
+      (:end)
+      (return-void)
+     )
+    )
+  )");
+  auto code = method->get_code();
+  code->build_cfg();
+  auto& cfg = code->cfg();
+  type_inference::TypeInference inference(cfg);
+  inference.run(method);
+  type_inference::TypeInference on_demand_inference(cfg);
+  on_demand_inference.set_on_demand_type_environments();
+  on_demand_inference.run(method);
+  EXPECT_TRUE(on_demand_inference.get_type_environments().empty());
+
+  // Query in reverse order as well, so that not every query can reuse the
+  // last recomputed entry state.
+  std::vector<IRInstruction*> insns;
+  for (auto& mie : cfg::InstructionIterable(cfg)) {
+    insns.push_back(mie.insn);
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    for (auto* insn : insns) {
+      EXPECT_TRUE(inference.get_type_environment(insn).equals(
+          on_demand_inference.get_type_environment(insn)))
+          << show(insn);
+    }
+    std::reverse(insns.begin(), insns.end());
+  }
+}
@@ -214,6 +214,17 @@ TEST_F(TypeSystemTest, empty) {
   EXPECT_EQ(types.size(), 0);
   types.clear();
 
+  EXPECT_THAT(type_system.get_all_children_range(a_t),
+              ::testing::UnorderedElementsAre(c_t, d_t, e_t, f_t, g_t, h_t,
+                                              i_t, j_t, l_t));
+  EXPECT_THAT(type_system.get_all_children_range(h_t),
+              ::testing::UnorderedElementsAre(i_t, j_t, l_t));
+  EXPECT_THAT(type_system.get_all_children_range(odd_t),
+              ::testing::UnorderedElementsAre(odd1_t, odd2_t, odd11_t,
+                                              odd12_t));
+  EXPECT_TRUE(type_system.get_all_children_range(o_t).empty());
+  EXPECT_TRUE(type_system.get_all_children_range(i1_t).empty());
+
   EXPECT_EQ(type_system.parent_chain(a_t).size(), 2);
   EXPECT_THAT(type_system.parent_chain(a_t),
               ::testing::UnorderedElementsAre(a_t, obj_t));
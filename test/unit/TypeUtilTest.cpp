@@ -173,3 +173,14 @@ TEST_F(TypeUtilTest, same_package_sub_package) {
   EXPECT_FALSE(same_package(DexType::make_type("Ljava/lang/Object;"),
                             DexType::make_type("Ljava/lang/reflect/Method;")));
 }
+
+TEST_F(TypeUtilTest, optional_well_known_types) {
+  EXPECT_EQ(type::kotlin_jvm_internal_Lambda(), nullptr);
+  auto lambda = DexType::make_type("Lkotlin/jvm/internal/Lambda;");
+  EXPECT_EQ(type::kotlin_jvm_internal_Lambda(), lambda);
+  EXPECT_EQ(type::kotlin_jvm_internal_Lambda(), lambda);
+
+  // After a change of the hierarchy generation, the type is looked up again.
+  RedexContext::bump_hierarchy_generation();
+  EXPECT_EQ(type::kotlin_jvm_internal_Lambda(), lambda);
+}
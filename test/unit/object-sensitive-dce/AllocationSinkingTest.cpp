@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "AllocationSinking.h"
+
+#include <gtest/gtest.h>
+
+#include "Creators.h"
+#include "IRAssembler.h"
+#include "RedexTest.h"
+
+namespace ptrs = local_pointers;
+
+class AllocationSinkingTest : public RedexTest {
+ protected:
+  void SetUp() override {
+    ClassCreator cc(DexType::make_type("LFoo;"));
+    cc.set_super(type::java_lang_Object());
+    auto* ctor = DexMethod::make_method("LFoo;.<init>:()V")
+                     ->make_concrete(ACC_PUBLIC, /* is_virtual */ false);
+    cc.add_method(ctor);
+    cc.add_field(DexField::make_field("LFoo;.x:I")->make_concrete(ACC_PUBLIC));
+    m_scope.push_back(cc.create());
+  }
+
+  // Runs the transformations, with all constructors having `ctor_summary`.
+  allocation_sinking::Stats run(
+      IRCode* code,
+      const side_effects::Summary& ctor_summary = side_effects::Summary({0})) {
+    code->build_cfg();
+    auto& cfg = code->cfg();
+    cfg.calculate_exit_block();
+    side_effects::InvokeToSummaryMap invoke_to_eff_summary_map;
+    ptrs::InvokeToSummaryMap invoke_to_esc_summary_map;
+    for (auto& mie : InstructionIterable(cfg)) {
+      auto insn = mie.insn;
+      if (opcode::is_an_invoke(insn->opcode()) &&
+          method::is_init(insn->get_method())) {
+        invoke_to_eff_summary_map.emplace(insn, ctor_summary);
+        invoke_to_esc_summary_map.emplace(insn, ptrs::EscapeSummary{});
+      }
+    }
+    ptrs::FixpointIterator ptrs_fp_iter(cfg, invoke_to_esc_summary_map);
+    ptrs_fp_iter.run(ptrs::Environment());
+    init_classes::InitClassesWithSideEffects init_classes_with_side_effects(
+        m_scope, /* create_init_class_insns */ false);
+    auto stats = allocation_sinking::optimize(
+        init_classes_with_side_effects, ptrs_fp_iter, invoke_to_eff_summary_map,
+        allocation_sinking::Config(), cfg);
+    code->clear_cfg();
+    return stats;
+  }
+
+  Scope m_scope;
+};
+
+TEST_F(AllocationSinkingTest, sink_into_using_branch) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (load-param v1)
+      (new-instance "LFoo;")
+      (move-result-pseudo-object v0)
+      (invoke-direct (v0) "LFoo;.<init>:()V")
+      (if-eqz v1 :use)
+      (return-void)
+      (:use)
+      (invoke-static (v0) "LBar;.use:(LFoo;)V")
+      (return-void)
+    )
+  )");
+  auto stats = run(code.get());
+  EXPECT_EQ(stats.sunk_allocations, 1);
+
+  auto expected_code = assembler::ircode_from_string(R"(
+    (
+      (load-param v1)
+      (if-eqz v1 :use)
+      (return-void)
+      (:use)
+      (new-instance "LFoo;")
+      (move-result-pseudo-object v0)
+      (invoke-direct (v0) "LFoo;.<init>:()V")
+      (invoke-static (v0) "LBar;.use:(LFoo;)V")
+      (return-void)
+    )
+  )");
+  EXPECT_CODE_EQ(code.get(), expected_code.get());
+}
+
+TEST_F(AllocationSinkingTest, keep_allocation_used_on_all_paths) {
+  auto original = R"(
+    (
+      (load-param v1)
+      (new-instance "LFoo;")
+      (move-result-pseudo-object v0)
+      (invoke-direct (v0) "LFoo;.<init>:()V")
+      (if-eqz v1 :use)
+      (invoke-static (v0) "LBar;.other:(LFoo;)V")
+      (return-void)
+      (:use)
+      (invoke-static (v0) "LBar;.use:(LFoo;)V")
+      (return-void)
+    )
+  )";
+  auto code = assembler::ircode_from_string(original);
+  auto stats = run(code.get());
+  EXPECT_EQ(stats.sunk_allocations, 0);
+  EXPECT_CODE_EQ(code.get(), assembler::ircode_from_string(original).get());
+}
+
+TEST_F(AllocationSinkingTest, keep_allocation_with_side_effecting_ctor) {
+  auto original = R"(
+    (
+      (load-param v1)
+      (new-instance "LFoo;")
+      (move-result-pseudo-object v0)
+      (invoke-direct (v0) "LFoo;.<init>:()V")
+      (if-eqz v1 :use)
+      (return-void)
+      (:use)
+      (invoke-static (v0) "LBar;.use:(LFoo;)V")
+      (return-void)
+    )
+  )";
+  auto code = assembler::ircode_from_string(original);
+  auto stats = run(code.get(), side_effects::Summary(
+                                   side_effects::EFF_WRITE_MAY_ESCAPE, {}));
+  EXPECT_EQ(stats.sunk_allocations, 0);
+  EXPECT_CODE_EQ(code.get(), assembler::ircode_from_string(original).get());
+}
+
+TEST_F(AllocationSinkingTest, remove_overwritten_field_store) {
+  auto code = assembler::ircode_from_string(R"(
+    (
+      (new-instance "LFoo;")
+      (move-result-pseudo-object v0)
+      (invoke-direct (v0) "LFoo;.<init>:()V")
+      (const v1 1)
+      (iput v1 v0 "LFoo;.x:I")
+      (const v1 2)
+      (iput v1 v0 "LFoo;.x:I")
+      (invoke-static (v0) "LBar;.use:(LFoo;)V")
+      (return-void)
+    )
+  )");
+  auto stats = run(code.get());
+  EXPECT_EQ(stats.removed_field_stores, 1);
+
+  auto expected_code = assembler::ircode_from_string(R"(
+    (
+      (new-instance "LFoo;")
+      (move-result-pseudo-object v0)
+      (invoke-direct (v0) "LFoo;.<init>:()V")
+      (const v1 1)
+      (const v1 2)
+      (iput v1 v0 "LFoo;.x:I")
+      (invoke-static (v0) "LBar;.use:(LFoo;)V")
+      (return-void)
+    )
+  )");
+  EXPECT_CODE_EQ(code.get(), expected_code.get());
+}
+
+TEST_F(AllocationSinkingTest, keep_field_store_read_in_between) {
+  auto original = R"(
+    (
+      (new-instance "LFoo;")
+      (move-result-pseudo-object v0)
+      (invoke-direct (v0) "LFoo;.<init>:()V")
+      (const v1 1)
+      (iput v1 v0 "LFoo;.x:I")
+      (iget v0 "LFoo;.x:I")
+      (move-result-pseudo v2)
+      (iput v2 v0 "LFoo;.x:I")
+      (invoke-static (v0) "LBar;.use:(LFoo;)V")
+      (return-void)
+    )
+  )";
+  auto code = assembler::ircode_from_string(original);
+  auto stats = run(code.get());
+  EXPECT_EQ(stats.removed_field_stores, 0);
+  EXPECT_CODE_EQ(code.get(), assembler::ircode_from_string(original).get());
+}
@@ -161,7 +161,7 @@ size_t compute_overhead(const android::ResStringPool_header* header,
       auto len = compute_string_size(pool, idx);
       TRACE_NO_LINE(ARSC, 3, "%u: \"%s\", length = %zu bytes. ", idx,
                     str.c_str(), len);
-      auto set = usages.at(idx);
+      const auto& set = usages.at(idx);
       if (set.empty()) {
         TRACE(ARSC, 3, "No uses.");
       } else {
@@ -202,7 +202,7 @@ void tally_string_sizes(const char* audit_msg,
 
   std::set<uint32_t> all_ids;
   for (uint32_t idx = 0; idx < pool.size(); idx++) {
-    auto set = usages.at(idx);
+    const auto& set = usages.at(idx);
     if (!set.empty()) {
       auto amount = compute_string_size(pool, idx);
       for (const auto id : set) {
@@ -264,15 +264,25 @@ std::set<uint32_t> tally_type_and_entries(
   uint32_t upper =
       (PACKAGE_MASK_BIT & (package_id << PACKAGE_INDEX_BIT_SHIFT)) |
       (TYPE_MASK_BIT & (type_id << TYPE_INDEX_BIT_SHIFT));
+  // Entries for every (type, entry index) pair, looked up once and reused by
+  // both passes below.
+  std::vector<std::vector<arsc::EntryValueData>> type_entries(
+      types.size(), std::vector<arsc::EntryValueData>(entry_count));
+  for (uint16_t i = 0; i < entry_count && !types.empty(); i++) {
+    uint32_t res_id = upper | i;
+    auto& config_to_entry = parser.m_res_id_to_entries.at(res_id);
+    for (size_t t = 0; t < types.size(); t++) {
+      type_entries[t][i] = config_to_entry.at(&types[t]->config);
+    }
+  }
+
   // Note: this vector could be empty.
-  for (const auto& type : types) {
+  for (size_t t = 0; t < types.size(); t++) {
+    const auto& type = types[t];
     for (uint16_t i = 0; i < entry_count; i++) {
       uint32_t res_id = upper | i;
-      if (resource_configs->count(res_id) == 0) {
-        std::vector<std::string> empty_vec;
-        resource_configs->emplace(res_id, empty_vec);
-      }
-      auto ev = parser.get_entry_for_config(res_id, &type->config);
+      auto& configs = (*resource_configs)[res_id];
+      const auto& ev = type_entries[t][i];
       if (!arsc::is_empty(ev)) {
         non_empty_res_ids.emplace(res_id);
         type_to_non_empty_ids[type].emplace(res_id);
@@ -286,9 +296,9 @@ std::set<uint32_t> tally_type_and_entries(
         }
         auto config_name = std::string(type->config.toString().string());
         if (config_name.empty()) {
-          resource_configs->at(res_id).emplace_back("default");
+          configs.emplace_back("default");
         } else {
-          resource_configs->at(res_id).emplace_back(config_name);
+          configs.emplace_back(std::move(config_name));
         }
         // Keep track of if we've seen a redundant pointer before
         data_to_ids[entry].emplace(res_id);
@@ -311,7 +321,8 @@ std::set<uint32_t> tally_type_and_entries(
 
   // Last step, re-iterate over the resource ids in each type, and compute
   // overhead of the type
-  for (const auto& type : types) {
+  for (size_t t = 0; t < types.size(); t++) {
+    const auto& type = types[t];
     auto& this_non_empty_set = type_to_non_empty_ids.at(type);
     size_t type_overhead = dtohs(type->header.headerSize);
     if ((type->flags & android::ResTable_type::FLAG_SPARSE) == 0) {
@@ -319,7 +330,7 @@ std::set<uint32_t> tally_type_and_entries(
     }
     for (uint16_t i = 0; i < entry_count; i++) {
       uint32_t res_id = upper | i;
-      auto ev = parser.get_entry_for_config(res_id, &type->config);
+      const auto& ev = type_entries[t][i];
       if (!arsc::is_empty(ev)) {
         add_size("ResTable_type offset", res_id, OFFSET_SIZE, 1,
                  resource_sizes);
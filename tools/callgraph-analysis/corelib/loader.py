@@ -114,6 +114,10 @@ class CallGraph(object):
     def load(self, fn):
         with open(fn) as f:
             mapping = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+            version = struct.unpack_from("<L", mapping, 4)[0]
+            if version == CompactCallGraph.VERSION:
+                self.load_compact(mapping)
+                return
             self.read_header(mapping)
             nodes_count = struct.unpack("<L", mapping.read(4))[0]
             nodes = [None] * nodes_count
@@ -131,3 +135,97 @@ class CallGraph(object):
                 for succ in out_edges[i]:
                     succ_node = nodes[succ]
                     self.add_edge(node, succ_node)
+
+    def load_compact(self, mapping):
+        graph = CompactCallGraph(mapping)
+        nodes = [None] * graph.nodes_count
+        for i, node_name in enumerate(graph.names):
+            split_name = node_name.split("{")
+            assert len(split_name) == 2
+            nodes[i] = CallGraphNode(split_name[0], split_name[1][:-1])
+            self.add_node(nodes[i])
+        for i in range(graph.nodes_count):
+            for succ in graph.callees(i):
+                self.add_edge(nodes[i], nodes[succ])
+
+
+class CompactCallGraph(object):
+    """
+    A read-only view of a call graph written by CallGraphFileGenerationPass
+    with "compact_format". The callee and caller lists are used in place from
+    the mapped file; only the node names are decoded.
+    """
+
+    VERSION = 2
+
+    def __init__(self, mapping):
+        magic, version, self.nodes_count, edges_count = struct.unpack_from(
+            "<LLLL", mapping, 0
+        )
+        if magic != 0xFACEB000:
+            raise Exception("Magic number mismatch")
+        if version != self.VERSION:
+            raise Exception("Version mismatch")
+        self.mapping = mapping
+        self.names = []
+        self.ids = {}
+        pos = 16
+        for i in range(self.nodes_count):
+            (name_size,) = struct.unpack_from("<L", mapping, pos)
+            name = mapping[pos + 4 : pos + 4 + name_size].decode("ascii")
+            pos += 4 + name_size
+            self.names.append(name)
+            self.ids[name.split("{")[0]] = i
+
+        def u32s(count):
+            nonlocal pos
+            view = memoryview(mapping)[pos : pos + 4 * count].cast("I")
+            pos += 4 * count
+            return view
+
+        self.callee_starts = u32s(self.nodes_count + 1)
+        self.callee_ids = u32s(edges_count)
+        self.caller_starts = u32s(self.nodes_count + 1)
+        self.caller_ids = u32s(edges_count)
+
+    @staticmethod
+    def load(fn):
+        with open(fn, "rb") as f:
+            return CompactCallGraph(
+                mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+            )
+
+    def callees(self, node_id):
+        return self.callee_ids[
+            self.callee_starts[node_id] : self.callee_starts[node_id + 1]
+        ]
+
+    def callers(self, node_id):
+        return self.caller_ids[
+            self.caller_starts[node_id] : self.caller_starts[node_id + 1]
+        ]
+
+    def depths_from(self, root_id, reverse=False, max_depth=None):
+        """
+        Breadth-first walk from :root_id. Returns a dict from every reachable
+        node id to its distance from the root. With :reverse, the walk follows
+        callers instead of callees.
+        """
+        starts, ids = (
+            (self.caller_starts, self.caller_ids)
+            if reverse
+            else (self.callee_starts, self.callee_ids)
+        )
+        depths = {root_id: 0}
+        frontier = [root_id]
+        depth = 0
+        while frontier and (max_depth is None or depth < max_depth):
+            depth += 1
+            next_frontier = []
+            for node_id in frontier:
+                for succ in ids[starts[node_id] : starts[node_id + 1]]:
+                    if succ not in depths:
+                        depths[succ] = depth
+                        next_frontier.append(succ)
+            frontier = next_frontier
+        return depths
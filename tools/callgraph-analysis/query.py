@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+import argparse
+import multiprocessing
+import sys
+
+from corelib.loader import CompactCallGraph
+
+# Set before the worker processes are forked, so that they share the mapped
+# graph instead of each loading their own copy.
+graph = None
+
+
+def parse_args(argv):
+    parser = argparse.ArgumentParser(
+        description="""Answer transitive reachability queries on a call graph
+written by CallGraphFileGenerationPass with "compact_format": true.
+
+For every root, prints the number of reachable methods and the depth of the
+deepest one, or with --list every reachable method with its depth. Roots are
+processed in parallel.""",
+        formatter_class=argparse.RawTextHelpFormatter,
+    )
+    parser.add_argument(
+        "-i", "--input", help="Compact call graph file", required=True
+    )
+    parser.add_argument(
+        "-r",
+        "--root",
+        action="append",
+        default=[],
+        help="Method to start from, e.g. 'LFoo;.bar:()V'. May be repeated",
+    )
+    parser.add_argument(
+        "--roots-file", help="File with one root method per line"
+    )
+    parser.add_argument(
+        "--callers",
+        action="store_true",
+        help="Walk callers instead of callees",
+    )
+    parser.add_argument("--max-depth", type=int, help="Stop the walk at this depth")
+    parser.add_argument(
+        "--list", action="store_true", help="Print every reachable method"
+    )
+    parser.add_argument(
+        "-j",
+        "--jobs",
+        type=int,
+        default=multiprocessing.cpu_count(),
+        help="Number of worker processes",
+    )
+    return parser.parse_args(argv)
+
+
+def query(task):
+    root, reverse, max_depth = task
+    if root not in graph.ids:
+        return root, None
+    return root, graph.depths_from(graph.ids[root], reverse, max_depth)
+
+
+def main(argv):
+    global graph
+    args = parse_args(argv)
+    roots = list(args.root)
+    if args.roots_file:
+        with open(args.roots_file) as f:
+            roots.extend(line.strip() for line in f if line.strip())
+
+    graph = CompactCallGraph.load(args.input)
+    tasks = [(root, args.callers, args.max_depth) for root in roots]
+    if args.jobs > 1 and len(tasks) > 1:
+        with multiprocessing.get_context("fork").Pool(args.jobs) as pool:
+            results = pool.imap(query, tasks)
+            report(results, args.list)
+    else:
+        report(map(query, tasks), args.list)
+
+
+def report(results, list_nodes):
+    for root, depths in results:
+        if depths is None:
+            print("%s: not in call graph" % root)
+            continue
+        print(
+            "%s: %d reachable, max depth %d"
+            % (root, len(depths) - 1, max(depths.values()))
+        )
+        if list_nodes:
+            for node_id, depth in sorted(depths.items(), key=lambda x: x[1]):
+                if depth > 0:
+                    print("  %d %s" % (depth, graph.names[node_id]))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
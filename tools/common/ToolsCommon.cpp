@@ -16,9 +16,12 @@
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
 #endif
+#include <atomic>
+#include <boost/optional.hpp>
 #include <fstream>
 #include <iostream>
 #include <json/json.h>
+#include <thread>
 
 #include "CommentFilter.h"
 #include "DexLoader.h"
@@ -264,6 +267,48 @@ void load_all_intermediate(const std::string& input_ir_dir,
   }
 }
 
+namespace {
+
+bool is_dex_file(const std::string& filename) {
+  return filename.size() >= 5 &&
+         filename.compare(filename.size() - 4, 4, ".dex") == 0;
+}
+
+/*
+ * Reads the given files front to back on a background thread, so that they
+ * are in the page cache by the time the loader maps them. Loading a dex is
+ * already parallel across its classes, but each dex is only mapped when its
+ * turn comes, and page faults on a cold cache then stall all workers. With
+ * many stores on slow storage, that I/O dominates.
+ *
+ * The dexes themselves are still loaded one by one and in order: when two
+ * dexes define the same class, the first one loaded wins.
+ */
+class DexPrefetcher {
+ public:
+  explicit DexPrefetcher(std::vector<std::string> files)
+      : m_thread([this, files = std::move(files)]() {
+          std::vector<char> buffer(1 << 20);
+          for (const auto& file : files) {
+            std::ifstream in(file, std::ifstream::binary);
+            while (!m_cancelled.load(std::memory_order_relaxed) && in) {
+              in.read(buffer.data(), buffer.size());
+            }
+          }
+        }) {}
+
+  ~DexPrefetcher() {
+    m_cancelled = true;
+    m_thread.join();
+  }
+
+ private:
+  std::atomic<bool> m_cancelled{false};
+  std::thread m_thread;
+};
+
+} // namespace
+
 /**
  * Helper to load classes from a list of input dex files into a DexStoresVector.
  * Processes dex (.dex) files as well as DexMetadata files (.json)
@@ -275,17 +320,14 @@ void load_classes_from_dexes_and_metadata(
     std::vector<dex_stats_t>& input_dexes_stats) {
   always_assert_log(!stores.empty(),
                     "Cannot load classes into empty DexStoresVector");
+  // Parse all store metadata upfront, so that we know all dex files to
+  // prefetch.
+  std::vector<boost::optional<DexMetadata>> stores_metadata;
+  std::vector<std::string> files_to_prefetch;
   for (const auto& filename : dex_files) {
-    if (filename.size() >= 5 &&
-        filename.compare(filename.size() - 4, 4, ".dex") == 0) {
-      auto location = DexLocation::make_location("dex", filename);
-      assert_dex_magic_consistency(stores[0].get_dex_magic(),
-                                   load_dex_magic_from_dex(location));
-      dex_stats_t dex_stats;
-      DexClasses classes = load_classes_from_dex(location, &dex_stats);
-      input_totals += dex_stats;
-      input_dexes_stats.push_back(dex_stats);
-      stores[0].add_classes(std::move(classes));
+    if (is_dex_file(filename)) {
+      stores_metadata.emplace_back();
+      files_to_prefetch.push_back(filename);
     } else if (is_zip(filename)) {
       std::cerr << "error: Input files are expected to be DEX (with filename "
                    "ending in "
@@ -297,6 +339,27 @@ void load_classes_from_dexes_and_metadata(
     } else {
       DexMetadata store_metadata;
       store_metadata.parse(filename);
+      const auto& files = store_metadata.get_files();
+      files_to_prefetch.insert(files_to_prefetch.end(), files.begin(),
+                               files.end());
+      stores_metadata.emplace_back(std::move(store_metadata));
+    }
+  }
+  DexPrefetcher prefetcher(std::move(files_to_prefetch));
+
+  for (size_t i = 0; i < dex_files.size(); ++i) {
+    const auto& filename = dex_files[i];
+    if (!stores_metadata[i]) {
+      auto location = DexLocation::make_location("dex", filename);
+      assert_dex_magic_consistency(stores[0].get_dex_magic(),
+                                   load_dex_magic_from_dex(location));
+      dex_stats_t dex_stats;
+      DexClasses classes = load_classes_from_dex(location, &dex_stats);
+      input_totals += dex_stats;
+      input_dexes_stats.push_back(dex_stats);
+      stores[0].add_classes(std::move(classes));
+    } else {
+      const auto& store_metadata = *stores_metadata[i];
       DexStore store(store_metadata);
       for (const auto& file_path : store_metadata.get_files()) {
         auto location = DexLocation::make_location(store.get_name(), file_path);
@@ -7,6 +7,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <getopt.h>
 #include <regex>
 
@@ -43,7 +44,14 @@ int main(int argc, char* argv[]) {
   }
 
   const char* search_str = argv[optind];
-  std::regex re(search_str);
+  std::regex re(search_str, std::regex::optimize);
+  // Most searches are for plain class names, which do not need the (slow)
+  // regex machinery at all.
+  bool is_literal = strpbrk(search_str, ".^$|()[]{}*+?\\") == nullptr;
+  auto matches = [&](const char* name) {
+    return is_literal ? strstr(name, search_str) != nullptr
+                      : std::regex_search(name, re);
+  };
 
   for (int i = optind + 1; i < argc; ++i) {
     const char* dexfile = argv[i];
@@ -54,9 +62,10 @@ int main(int argc, char* argv[]) {
     for (uint32_t j = 0; j < size; j++) {
       dex_class_def* cls_def = rd.dex_class_defs + j;
       char* name = dex_string_by_type_idx(&rd, cls_def->typeidx);
-      if (std::regex_search(name, re)) {
+      if (matches(name)) {
         if (files_only) {
           printf("%s\n", dexfile);
+          break;
         } else {
           printf("%s: %s\n", dexfile, name);
         }
@@ -0,0 +1,463 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+/*
+ * Native equivalent of `dump_classes_from_hprof.py --hprof <file>`.
+ *
+ * The python script materializes every object of the heap before it prints
+ * the class list, which takes a long time on large dumps. This tool only
+ * looks at what the class list needs: STRING and LOAD_CLASS records and the
+ * CLASS_DUMP sub-records of the heap dump segments. The file is mapped into
+ * memory and the heap dump segments are scanned on several threads.
+ *
+ * Usage: hprof_class_list [-j <threads>] <file.hprof>
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+enum HprofTag : uint8_t {
+  STRING = 0x01,
+  LOAD_CLASS = 0x02,
+  HEAP_DUMP = 0x0C,
+  HEAP_DUMP_SEGMENT = 0x1C,
+  HEAP_DUMP_END = 0x2C,
+};
+
+enum HeapTag : uint8_t {
+  // standard
+  ROOT_UNKNOWN = 0xFF,
+  ROOT_JNI_GLOBAL = 0x01,
+  ROOT_JNI_LOCAL = 0x02,
+  ROOT_JAVA_FRAME = 0x03,
+  ROOT_NATIVE_STACK = 0x04,
+  ROOT_STICKY_CLASS = 0x05,
+  ROOT_THREAD_BLOCK = 0x06,
+  ROOT_MONITOR_USED = 0x07,
+  ROOT_THREAD_OBJECT = 0x08,
+  CLASS_DUMP = 0x20,
+  INSTANCE_DUMP = 0x21,
+  OBJECT_ARRAY_DUMP = 0x22,
+  PRIMITIVE_ARRAY_DUMP = 0x23,
+
+  // Android
+  HEAP_DUMP_INFO = 0xFE,
+  ROOT_INTERNED_STRING = 0x89,
+  ROOT_FINALIZING = 0x8A,
+  ROOT_DEBUGGER = 0x8B,
+  ROOT_REFERENCE_CLEANUP = 0x8C,
+  ROOT_VM_INTERNAL = 0x8D,
+  ROOT_JNI_MONITOR = 0x8E,
+};
+
+enum HprofBasic : uint8_t {
+  OBJECT = 2,
+  BOOLEAN = 4,
+  CHAR = 5,
+  FLOAT = 6,
+  DOUBLE = 7,
+  BYTE = 8,
+  SHORT = 9,
+  INT = 10,
+  LONG = 11,
+};
+
+class Reader {
+ public:
+  Reader(const uint8_t* begin, const uint8_t* end, size_t id_size)
+      : m_ptr(begin), m_end(end), m_id_size(id_size) {}
+
+  bool has_more() const { return m_ptr < m_end; }
+  const uint8_t* position() const { return m_ptr; }
+
+  uint8_t u1() {
+    require(1);
+    return *m_ptr++;
+  }
+
+  uint16_t u2() { return static_cast<uint16_t>(read_be(2)); }
+  uint32_t u4() { return static_cast<uint32_t>(read_be(4)); }
+  uint64_t id() { return read_be(m_id_size); }
+
+  void skip(uint64_t n) {
+    require(n);
+    m_ptr += n;
+  }
+
+  void skip_ids(uint64_t n) {
+    if (n > static_cast<uint64_t>(m_end - m_ptr) / m_id_size) {
+      throw std::runtime_error("Truncated hprof record");
+    }
+    m_ptr += n * m_id_size;
+  }
+
+  size_t basic_size(uint8_t type) const {
+    switch (type) {
+    case OBJECT:
+      return m_id_size;
+    case BOOLEAN:
+    case BYTE:
+      return 1;
+    case CHAR:
+    case SHORT:
+      return 2;
+    case FLOAT:
+    case INT:
+      return 4;
+    case DOUBLE:
+    case LONG:
+      return 8;
+    default:
+      throw std::runtime_error("Invalid HprofBasic type: " +
+                               std::to_string(type));
+    }
+  }
+
+ private:
+  void require(uint64_t n) const {
+    if (n > static_cast<uint64_t>(m_end - m_ptr)) {
+      throw std::runtime_error("Truncated hprof record");
+    }
+  }
+
+  uint64_t read_be(size_t n) {
+    require(n);
+    uint64_t value = 0;
+    for (size_t i = 0; i < n; ++i) {
+      value = (value << 8) | m_ptr[i];
+    }
+    m_ptr += n;
+    return value;
+  }
+
+  const uint8_t* m_ptr;
+  const uint8_t* m_end;
+  size_t m_id_size;
+};
+
+struct LoadClass {
+  uint32_t class_serial;
+  uint64_t class_string_id;
+};
+
+struct Segment {
+  const uint8_t* begin;
+  const uint8_t* end;
+};
+
+/*
+ * Walk one heap dump segment and collect the object ids of its CLASS_DUMP
+ * sub-records, in file order. Everything else is skipped by size.
+ */
+void scan_segment(const Segment& segment,
+                  size_t id_size,
+                  std::vector<uint64_t>* class_ids) {
+  Reader in(segment.begin, segment.end, id_size);
+  while (in.has_more()) {
+    uint8_t heap_tag = in.u1();
+    switch (heap_tag) {
+    case ROOT_UNKNOWN:
+    case ROOT_STICKY_CLASS:
+    case ROOT_MONITOR_USED:
+    case ROOT_INTERNED_STRING:
+    case ROOT_FINALIZING:
+    case ROOT_DEBUGGER:
+    case ROOT_REFERENCE_CLEANUP:
+    case ROOT_VM_INTERNAL:
+      in.skip_ids(1);
+      break;
+    case ROOT_JNI_GLOBAL:
+    case HEAP_DUMP_INFO:
+      in.skip_ids(2);
+      break;
+    case ROOT_THREAD_OBJECT:
+    case ROOT_JNI_LOCAL:
+    case ROOT_JNI_MONITOR:
+    case ROOT_JAVA_FRAME:
+      in.skip_ids(1);
+      in.skip(8);
+      break;
+    case ROOT_NATIVE_STACK:
+    case ROOT_THREAD_BLOCK:
+      in.skip_ids(1);
+      in.skip(4);
+      break;
+    case CLASS_DUMP: {
+      class_ids->push_back(in.id());
+      in.skip(4); // stack serial
+      // super class, class loader, signer, protection domain, 2 x reserved
+      in.skip_ids(6);
+      in.skip(4); // instance size
+      if (in.u2() != 0) {
+        throw std::runtime_error("Cannot handle const_pools.");
+      }
+      uint16_t static_field_count = in.u2();
+      for (uint16_t i = 0; i < static_field_count; ++i) {
+        in.skip_ids(1);
+        uint8_t type = in.u1();
+        in.skip(in.basic_size(type));
+      }
+      uint16_t instance_field_count = in.u2();
+      for (uint16_t i = 0; i < instance_field_count; ++i) {
+        in.skip_ids(1);
+        in.skip(1);
+      }
+      break;
+    }
+    case INSTANCE_DUMP: {
+      in.skip_ids(1);
+      in.skip(4);
+      in.skip_ids(1);
+      uint32_t size = in.u4();
+      in.skip(size);
+      break;
+    }
+    case OBJECT_ARRAY_DUMP: {
+      in.skip_ids(1);
+      in.skip(4);
+      uint32_t num_elements = in.u4();
+      in.skip_ids(1);
+      in.skip_ids(num_elements);
+      break;
+    }
+    case PRIMITIVE_ARRAY_DUMP: {
+      in.skip_ids(1);
+      in.skip(4);
+      uint32_t num_elements = in.u4();
+      uint8_t type = in.u1();
+      in.skip(static_cast<uint64_t>(num_elements) * in.basic_size(type));
+      break;
+    }
+    default:
+      throw std::runtime_error("Unrecognized tag: " + std::to_string(heap_tag));
+    }
+  }
+}
+
+class MappedFile {
+ public:
+  explicit MappedFile(const char* path) {
+    m_fd = open(path, O_RDONLY);
+    if (m_fd < 0) {
+      throw std::runtime_error(std::string("Could not open ") + path + ": " +
+                               strerror(errno));
+    }
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) {
+      close(m_fd);
+      throw std::runtime_error(std::string("Could not stat ") + path);
+    }
+    m_size = st.st_size;
+    if (m_size == 0) {
+      return;
+    }
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED) {
+      close(m_fd);
+      throw std::runtime_error(std::string("Could not map ") + path);
+    }
+    madvise(data, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const uint8_t*>(data);
+  }
+
+  ~MappedFile() {
+    if (m_data != nullptr) {
+      munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    close(m_fd);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const uint8_t* begin() const { return m_data; }
+  const uint8_t* end() const { return m_data + m_size; }
+
+ private:
+  int m_fd{-1};
+  size_t m_size{0};
+  const uint8_t* m_data{nullptr};
+};
+
+std::vector<std::string> class_list(const MappedFile& file,
+                                    unsigned num_threads) {
+  const uint8_t* ptr = file.begin();
+  const uint8_t* end = file.end();
+
+  // Header: null-terminated format tag, id size, timestamp.
+  const uint8_t* nul =
+      ptr == end ? nullptr
+                 : static_cast<const uint8_t*>(memchr(ptr, '\0', end - ptr));
+  if (nul == nullptr) {
+    throw std::runtime_error("Missing hprof header");
+  }
+  Reader header(nul + 1, end, 4);
+  size_t id_size = header.u4();
+  if (id_size != 4 && id_size != 8) {
+    throw std::runtime_error("Unsupported id size: " + std::to_string(id_size));
+  }
+  header.skip(8);
+
+  // Top-level records are few; index them in a single sequential pass and
+  // only remember where the heap dump segments live.
+  std::unordered_map<uint64_t, std::pair<const uint8_t*, const uint8_t*>>
+      strings;
+  std::unordered_map<uint64_t, LoadClass> load_classes;
+  std::vector<Segment> segments;
+  Reader in(header.position(), end, id_size);
+  while (in.has_more()) {
+    uint8_t tag = in.u1();
+    in.skip(4); // time offset
+    uint32_t length = in.u4();
+    const uint8_t* body = in.position();
+    in.skip(length);
+    Reader record(body, body + length, id_size);
+    if (tag == STRING) {
+      uint64_t string_id = record.id();
+      strings.emplace(string_id, std::make_pair(record.position(), body + length));
+    } else if (tag == LOAD_CLASS) {
+      LoadClass load_class;
+      load_class.class_serial = record.u4();
+      uint64_t object_id = record.id();
+      record.skip(4); // stack serial
+      load_class.class_string_id = record.id();
+      load_classes[object_id] = load_class;
+    } else if (tag == HEAP_DUMP || tag == HEAP_DUMP_SEGMENT) {
+      segments.push_back({body, body + length});
+    } else if (tag == HEAP_DUMP_END) {
+      break;
+    }
+  }
+
+  // Scan the heap dump segments in parallel. Each worker takes a contiguous
+  // run of segments so that concatenating the results keeps file order.
+  num_threads = std::max(
+      1u, std::min<unsigned>(num_threads, static_cast<unsigned>(segments.size())));
+  std::vector<std::vector<uint64_t>> class_ids(num_threads);
+  std::vector<std::string> errors(num_threads);
+  std::vector<std::thread> workers;
+  size_t per_thread = (segments.size() + num_threads - 1) / num_threads;
+  for (unsigned t = 0; t < num_threads; ++t) {
+    workers.emplace_back([&, t]() {
+      size_t first = t * per_thread;
+      size_t last = std::min(segments.size(), first + per_thread);
+      try {
+        for (size_t i = first; i < last; ++i) {
+          scan_segment(segments[i], id_size, &class_ids[t]);
+        }
+      } catch (const std::exception& e) {
+        errors[t] = e.what();
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (const auto& error : errors) {
+    if (!error.empty()) {
+      throw std::runtime_error(error);
+    }
+  }
+
+  // Resolve names. Like the python script, the first class seen for a name
+  // wins, array classes are dropped, and the list is ordered by class serial
+  // which corresponds to class load order on Dalvik.
+  std::unordered_set<std::string> seen;
+  std::vector<std::pair<uint32_t, std::string>> classes;
+  for (const auto& ids : class_ids) {
+    for (uint64_t class_id : ids) {
+      auto lc = load_classes.find(class_id);
+      if (lc == load_classes.end()) {
+        throw std::runtime_error("Missing LOAD_CLASS record for class " +
+                                 std::to_string(class_id));
+      }
+      auto str = strings.find(lc->second.class_string_id);
+      if (str == strings.end()) {
+        throw std::runtime_error("Missing string " +
+                                 std::to_string(lc->second.class_string_id));
+      }
+      std::string name(reinterpret_cast<const char*>(str->second.first),
+                        str->second.second - str->second.first);
+      if (!seen.insert(name).second) {
+        fprintf(stderr, "Warning: duplicate class: %s\n", name.c_str());
+        continue;
+      }
+      if (name.size() >= 2 && name.compare(name.size() - 2, 2, "[]") == 0) {
+        continue;
+      }
+      classes.emplace_back(lc->second.class_serial, std::move(name));
+    }
+  }
+  std::stable_sort(
+      classes.begin(), classes.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::vector<std::string> result;
+  result.reserve(classes.size());
+  for (auto& cls : classes) {
+    std::string& name = cls.second;
+    std::replace(name.begin(), name.end(), '.', '/');
+    name += ".class";
+    result.push_back(std::move(name));
+  }
+  return result;
+}
+
+void usage(const char* prog) {
+  fprintf(stderr, "Usage: %s [-j <threads>] <file.hprof>\n", prog);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+  int opt;
+  while ((opt = getopt(argc, argv, "j:h")) != -1) {
+    switch (opt) {
+    case 'j':
+      num_threads = std::max(1, atoi(optarg));
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (optind != argc - 1) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  try {
+    MappedFile file(argv[optind]);
+    for (const auto& name : class_list(file, num_threads)) {
+      fwrite(name.data(), 1, name.size(), stdout);
+      fputc('\n', stdout);
+    }
+  } catch (const std::exception& e) {
+    fprintf(stderr, "%s: %s\n", argv[0], e.what());
+    return 1;
+  }
+  return 0;
+}
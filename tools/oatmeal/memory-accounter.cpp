@@ -129,6 +129,15 @@ class MemoryAccounterImpl : public MemoryAccounter {
   void markRangeImpl(uint32_t begin, uint32_t end) {
     CHECK(begin <= end);
     CHECK(end <= buf_.len);
+    // Parsing mostly consumes the buffer front to back, so a range usually
+    // starts right where the previously recorded one ended. Extend that one
+    // instead of recording another; print() sees no gap between them either
+    // way. The end marker added at construction is the first entry and is
+    // never extended.
+    if (consumed_ranges_.size() > 1 && consumed_ranges_.back().end == begin) {
+      consumed_ranges_.back().end = end;
+      return;
+    }
     consumed_ranges_.emplace_back(begin, end);
   }
 };
@@ -15,53 +15,66 @@ OffsetLine = namedtuple("OffsetLine", "offset line")
 
 
 class DebugLineMap(object):
-    def __init__(self, method_id_map):
-        self.method_id_map = method_id_map
+    def __init__(self, mapping, method_ranges):
+        # The line mappings of a method are only decoded when it is first
+        # looked up; most runs only ever touch a handful of methods.
+        self.mapping = mapping
+        self.method_ranges = method_ranges
+        self.method_id_map = {}
 
     @staticmethod
     def read_from(filename):
         with open(filename) as f:
             mapping = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
-            magic = struct.unpack("<L", mapping.read(4))[0]
-            if magic != 0xFACEB000:
-                raise Exception("Magic number mismatch")
-            version = struct.unpack("<L", mapping.read(4))[0]
-            if version != 1:
-                raise Exception("Version mismatch")
-            method_count = struct.unpack("<L", mapping.read(4))[0]
-            method_data_struct = struct.Struct("<QLL")
-            offset_line_struct = struct.Struct("<LL")
-            method_datas = []
-            for _ in range(method_count):
-                method_datas.append(method_data_struct.unpack(mapping.read(16)))
-            method_id_map = {}
-            for i in range(method_count):
-                method_id = struct.unpack("<Q", mapping.read(8))[0]
-                if method_id != method_datas[i][0]:
-                    raise Exception("Method id mismatch")
-                if method_id in method_id_map:
-                    raise Exception(
-                        "Found duplicate method id entry: " + str(method_id)
-                    )
-                line_mapping_size = method_datas[i][2] - 8
-                line_mapping_count = line_mapping_size // 8
-                if line_mapping_count > 0:
-                    line_mappings = []
-                    for _ in range(line_mapping_count):
-                        line_mappings.append(
-                            OffsetLine(*offset_line_struct.unpack(mapping.read(8)))
-                        )
-                    method_id_map[method_id] = line_mappings
-            logging.info(
-                "Unpacked " + str(len(method_id_map)) + " methods from debug line map"
-            )
-            return DebugLineMap(method_id_map)
+        magic, version, method_count = struct.unpack_from("<LLL", mapping, 0)
+        if magic != 0xFACEB000:
+            raise Exception("Magic number mismatch")
+        if version != 1:
+            raise Exception("Version mismatch")
+        method_data_struct = struct.Struct("<QLL")
+        pos = 12
+        method_datas = []
+        for method_data in method_data_struct.iter_unpack(
+            mapping[pos : pos + method_count * method_data_struct.size]
+        ):
+            method_datas.append(method_data)
+        pos += method_count * method_data_struct.size
+        method_ranges = {}
+        for i in range(method_count):
+            method_id = struct.unpack_from("<Q", mapping, pos)[0]
+            pos += 8
+            if method_id != method_datas[i][0]:
+                raise Exception("Method id mismatch")
+            if method_id in method_ranges:
+                raise Exception("Found duplicate method id entry: " + str(method_id))
+            line_mapping_size = method_datas[i][2] - 8
+            line_mapping_count = line_mapping_size // 8
+            if line_mapping_count > 0:
+                method_ranges[method_id] = (pos, line_mapping_count)
+                pos += line_mapping_count * 8
+        logging.info(
+            "Unpacked " + str(len(method_ranges)) + " methods from debug line map"
+        )
+        return DebugLineMap(mapping, method_ranges)
+
+    def _get_line_mappings(self, method_id):
+        line_mappings = self.method_id_map.get(method_id)
+        if line_mappings is None and method_id in self.method_ranges:
+            pos, count = self.method_ranges[method_id]
+            line_mappings = [
+                OffsetLine(*offset_line)
+                for offset_line in struct.iter_unpack(
+                    "<LL", self.mapping[pos : pos + count * 8]
+                )
+            ]
+            self.method_id_map[method_id] = line_mappings
+        return line_mappings
 
     def find_line_number(self, method_id, line):
         method_id = int(method_id)
         line = int(line)
-        if method_id in self.method_id_map:
-            mappings = self.method_id_map[method_id]
+        mappings = self._get_line_mappings(method_id)
+        if mappings is not None:
             result = None
             for pc, mapped_line in mappings:
                 if pc <= line:
@@ -75,7 +88,4 @@ class DebugLineMap(object):
         return None
 
     def get_mappings(self, method_id):
-        method_id = int(method_id)
-        if method_id in self.method_id_map:
-            return self.method_id_map[method_id]
-        return None
+        return self._get_line_mappings(int(method_id))
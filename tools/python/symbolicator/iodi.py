@@ -19,19 +19,23 @@ class IODIMetadata(object):
 
     def __init__(self, path):
         with open(path, "rb") as f:
-            magic, version, count, zero = struct.unpack("<LLLL", f.read(4 * 4))
-            if magic != 0xFACEB001:
-                raise Exception("Unexpected magic: " + hex(magic))
-            if version != 1:
-                raise Exception("Unexpected version: " + str(version))
-            if zero != 0:
-                raise Exception("Unexpected zero: " + str(zero))
-            self._entries = {}
-            for _ in range(count):
-                klen, method_id = struct.unpack("<HQ", f.read(2 + 8))
-                form = "<" + str(klen) + "s"
-                key = struct.unpack(form, f.read(klen))[0].decode("ascii")
-                self._entries[key] = method_id
+            data = f.read()
+        magic, version, count, zero = struct.unpack_from("<LLLL", data, 0)
+        if magic != 0xFACEB001:
+            raise Exception("Unexpected magic: " + hex(magic))
+        if version != 1:
+            raise Exception("Unexpected version: " + str(version))
+        if zero != 0:
+            raise Exception("Unexpected zero: " + str(zero))
+        entry_header = struct.Struct("<HQ")
+        pos = 4 * 4
+        self._entries = {}
+        for _ in range(count):
+            klen, method_id = entry_header.unpack_from(data, pos)
+            pos += entry_header.size
+            key = data[pos : pos + klen].decode("ascii")
+            pos += klen
+            self._entries[key] = method_id
 
     def map_iodi(self, debug_line_map, class_name, method_name, input_lineno):
         input_lineno = int(input_lineno)
@@ -70,8 +74,8 @@ class IODIMetadata(object):
     def write(self, path):
         with open(path, "wb") as f:
             self._f = f
-            self._write("<LLLL", 0xFACEB001, 1, len(self.entries), 0)
-            for key, mid in self._entries.items():
+            self._write("<LLLL", 0xFACEB001, 1, len(self._entries), 0)
+            for key, mid in sorted(self._entries.items()):
                 self._write("<HQ", len(key), mid)
                 self._write("<" + str(len(key)) + "s", key.encode("ascii"))
             self._f = None
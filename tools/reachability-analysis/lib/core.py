@@ -219,6 +219,174 @@ class ReachabilityGraph(AbstractGraph):
         return self.nodes[(ReachableObjectType.SEED, node_name)]
 
 
+class IndexedReachableObject(object):
+    """
+    A node of an IndexedReachabilityGraph. Its neighbors are decoded from the
+    mapped graph file each time they are requested.
+    """
+
+    def __init__(self, graph, node_id, type, name):
+        self.graph = graph
+        self.node_id = node_id
+        self.type = type
+        self.name = name
+
+    @property
+    def preds(self):
+        return self.graph.retainers_of(self.node_id)
+
+    @property
+    def succs(self):
+        return self.graph.retained_by(self.node_id)
+
+    def __eq__(self, other):
+        return (
+            isinstance(other, IndexedReachableObject)
+            and self.graph is other.graph
+            and self.node_id == other.node_id
+        )
+
+    def __hash__(self):
+        return self.node_id
+
+    def __str__(self):
+        return "%s: %s\n" % (ReachableObjectType.to_string(self.type), self.name)
+
+    def __repr__(self):
+        preds = self.preds
+        succs = self.succs
+        ret = "%s: %s\n" % (ReachableObjectType.to_string(self.type), self.name)
+        ret += "Reachable from %d predecessor(s):\n" % len(preds)
+        ret += show_list_with_idx(preds)
+        ret += "Reaching %d successor(s):\n" % len(succs)
+        ret += show_list_with_idx(succs)
+        return ret
+
+
+class IndexedReachabilityGraph(object):
+    """
+    A read-only view of a graph written by Reachability.dump_graph() that keeps
+    the file mapped and only holds a name -> node id table in memory. Retainers
+    and retained nodes are decoded on demand, using the index that dump_graph()
+    appends to the file. Graphs written without an index are still accepted;
+    in that case the reverse edges are computed once, on the first query that
+    needs them.
+    """
+
+    INDEX_MAGIC = 0xFACEB0FF
+
+    def __init__(self):
+        self.ids = {}
+
+    def load(self, fn):
+        with open(fn, "rb") as f:
+            self.mapping = mmap.mmap(f.fileno(), 0, prot=mmap.PROT_READ)
+        mapping = self.mapping
+        magic, version = struct.unpack_from("<LL", mapping, 0)
+        if magic != 0xFACEB000:
+            raise Exception("Magic number mismatch")
+        if version != ReachabilityGraph.expected_version():
+            raise Exception("Version mismatch")
+        self.base = 8
+        (self.nodes_count,) = struct.unpack_from("<L", mapping, self.base)
+
+        self.offsets = None
+        self.reverse_starts = None
+        self.reverse_edges = None
+        if len(mapping) >= self.base + 16:
+            index_size, magic = struct.unpack_from("<QL", mapping, len(mapping) - 12)
+            if magic == self.INDEX_MAGIC:
+                start = len(mapping) - 12 - index_size
+                n = self.nodes_count
+                self.offsets = memoryview(mapping)[start : start + 8 * n].cast("Q")
+                start += 8 * n
+                self.reverse_starts = memoryview(mapping)[
+                    start : start + 4 * (n + 1)
+                ].cast("I")
+                start += 4 * (n + 1)
+                self.reverse_edges = memoryview(mapping)[
+                    start : start + 4 * self.reverse_starts[n]
+                ].cast("I")
+
+        # Only the labels are needed up front, to resolve names to ids.
+        offsets = array.array("Q") if self.offsets is None else None
+        pos = self.base + 4
+        for i in range(self.nodes_count):
+            if offsets is not None:
+                offsets.append(pos - self.base)
+            node_type, name_size = struct.unpack_from("<BL", mapping, pos)
+            pos += 5
+            name = mapping[pos : pos + name_size].decode("ascii")
+            pos += name_size
+            (edges_size,) = struct.unpack_from("<L", mapping, pos)
+            pos += 4 + 4 * edges_size
+            self.ids[(node_type, name)] = i
+        if offsets is not None:
+            self.offsets = offsets
+
+    def node(self, node_id):
+        pos = self.base + self.offsets[node_id]
+        node_type, name_size = struct.unpack_from("<BL", self.mapping, pos)
+        name = self.mapping[pos + 5 : pos + 5 + name_size].decode("ascii")
+        return IndexedReachableObject(self, node_id, node_type, name)
+
+    def retainers_of(self, node_id):
+        return [self.node(i) for i in self.retainer_ids(node_id)]
+
+    def retained_by(self, node_id):
+        if self.reverse_starts is None:
+            self._build_reverse_edges()
+        begin = self.reverse_starts[node_id]
+        end = self.reverse_starts[node_id + 1]
+        return [self.node(i) for i in self.reverse_edges[begin:end]]
+
+    def _build_reverse_edges(self):
+        out_edges = [self.retainer_ids(i) for i in range(self.nodes_count)]
+        counts = array.array("I", [0]) * (self.nodes_count + 1)
+        for edges in out_edges:
+            for target in edges:
+                counts[target + 1] += 1
+        for i in range(self.nodes_count):
+            counts[i + 1] += counts[i]
+        fill = array.array("I", counts)
+        reverse_edges = array.array("I", [0]) * counts[self.nodes_count]
+        for source, edges in enumerate(out_edges):
+            for target in edges:
+                reverse_edges[fill[target]] = source
+                fill[target] += 1
+        self.reverse_starts = counts
+        self.reverse_edges = reverse_edges
+
+    def retainer_ids(self, node_id):
+        pos = self.base + self.offsets[node_id]
+        (name_size,) = struct.unpack_from("<L", self.mapping, pos + 1)
+        pos += 5 + name_size
+        (edges_size,) = struct.unpack_from("<L", self.mapping, pos)
+        edges = array.array("I")
+        edges.frombytes(self.mapping[pos + 4 : pos + 4 + 4 * edges_size])
+        return edges
+
+    def list_nodes(self, search_str=None):
+        for key in list(self.ids.keys()):
+            type = ReachableObjectType.to_string(key[0])
+            name = key[1]
+            if search_str is None or search_str in name:
+                print(('(ReachableObjectType.%s, "%s")' % (type, name)))
+
+    def get_node(self, node_name):
+        if is_method(node_name):
+            return self.node(self.ids[(ReachableObjectType.METHOD, node_name)])
+        if is_field(node_name):
+            return self.node(self.ids[(ReachableObjectType.FIELD, node_name)])
+        return self.node(self.ids[(ReachableObjectType.CLASS, node_name)])
+
+    def get_anno(self, node_name):
+        return self.node(self.ids[(ReachableObjectType.ANNO, node_name)])
+
+    def get_seed(self, node_name):
+        return self.node(self.ids[(ReachableObjectType.SEED, node_name)])
+
+
 class MethodOverrideGraph(AbstractGraph):
     class Node(object):
         def __init__(self, name):
@@ -7,7 +7,7 @@
 import argparse
 import sys
 
-from lib.core import ReachabilityGraph
+from lib.core import IndexedReachabilityGraph
 
 PROMPT_MSG = "Enter a node's name or 's {search term}' to search for one: "
 
@@ -37,8 +37,8 @@ Once a graph is loaded, the interface supports 3 operations:
 
 def main(argv):
     args = parse_args(argv)
-    graph = ReachabilityGraph()
-    print("Loading graph. This might take a couple of minutes")
+    graph = IndexedReachabilityGraph()
+    print("Indexing graph. This might take a minute")
     graph.load(args.input)
 
     while True:
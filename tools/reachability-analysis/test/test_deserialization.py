@@ -34,6 +34,32 @@ class TestGraphDeserialization(unittest.TestCase):
         assertEdge(cls, method)
         assertEdge(method, field)
 
+    def test_indexed_reachability_graph(self):
+        """
+        Check that the lazily decoded graph has the same edges as the one
+        serialized in ReachabilityGraphSerialization.cpp.
+        """
+        graph_file = os.environ["REACHABILITY_GRAPH_FILE"]
+        graph = core.IndexedReachabilityGraph()
+        graph.load(graph_file)
+
+        seed = graph.get_seed("<SEED>")
+        cls = graph.get_node("LFoo;")
+        anno = graph.get_anno("LAnno;")
+        field = graph.get_node("LFoo;.field1:I")
+        method = graph.get_node("LFoo;.method1:()I")
+
+        def assertEdge(pred, succ):
+            self.assertIn(succ, pred.succs)
+            self.assertIn(pred, succ.preds)
+
+        assertEdge(seed, cls)
+        assertEdge(cls, anno)
+        assertEdge(cls, method)
+        assertEdge(method, field)
+        self.assertEqual(field.succs, [])
+        self.assertEqual(seed.preds, [])
+
     def test_method_override_graph(self):
         """
         Check that we are able to recover the same graph serialized in
@@ -11,13 +11,16 @@
 #include <cstring>
 #include <ctime>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <set>
 #include <streambuf>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <signal.h>
@@ -29,6 +32,7 @@
 #ifdef _MSC_VER
 #include <io.h>
 #else
+#include <sys/wait.h>
 #include <unistd.h>
 #endif
 
@@ -36,7 +40,10 @@
 #include <boost/program_options.hpp>
 #include <json/json.h>
 
+#include <sparta/PatriciaTreeCore.h>
+
 #include "AggregateException.h"
+#include "ChromeTrace.h"
 #include "CommandProfiling.h"
 #include "CommentFilter.h"
 #include "ConfigFiles.h"
@@ -82,6 +89,8 @@
 #include "Warning.h"
 #include "WorkQueue.h" // For concurrency.
 
+int redex_main(int argc, char* argv[]);
+
 namespace {
 
 // Do *not* change these values. Many services will break.
@@ -108,9 +117,15 @@ struct Arguments {
   // command line arguments. For development usage
   Json::Value entry_data;
   boost::optional<int> stop_pass_idx;
+  // Directory of a checkpoint written with --stop-pass/--output-ir to resume
+  // from. For development usage
+  std::string resume_ir_dir;
   RedexOptions redex_options;
   bool properties_check{false};
   bool properties_check_allow_disabled{false};
+  bool plan{false};
+  // Stats of a previous run, to estimate the memory use of each planned pass.
+  std::string plan_stats_path;
 };
 
 UNUSED void dump_args(const Arguments& args) {
@@ -325,6 +340,14 @@ Arguments parse_args(int argc, char* argv[]) {
       "parse configuration, perform a stack properties check and exit");
   od.add_options()("properties-check-allow-disabled",
                    "accept the disable flag in the configuration");
+  od.add_options()("plan",
+                   "parse the configuration of Redex and of all activated "
+                   "passes, check the pass order properties, print the "
+                   "resulting pass plan and exit, without loading inputs");
+  od.add_options()("plan-stats",
+                   po::value<std::string>(),
+                   "redex-stats.json of a previous run, used by --plan to "
+                   "estimate the memory use of each pass");
   od.add_options()("apkdir,a",
                    // We allow overwrites to most of the options but will take
                    // only the last one.
@@ -413,9 +436,18 @@ Arguments parse_args(int argc, char* argv[]) {
                    "Stop before pass n and output IR to file");
   od.add_options()("output-ir", po::value<std::string>(),
                    "IR output directory, used with --stop-pass");
+  od.add_options()("resume-ir", po::value<std::string>(),
+                   "Resume from the IR directory written by --stop-pass and "
+                   "--output-ir, instead of loading the input dex files, and "
+                   "only run the passes from the stop point on");
   od.add_options()("jni-summary",
                    po::value<std::string>(),
                    "Path to JNI summary directory of json files.");
+  od.add_options()("chrome-trace",
+                   po::value<std::string>(),
+                   "Write a timeline of timers, passes, work queue threads and "
+                   "RSS samples to the given file, in the Chrome trace event "
+                   "format (viewable in chrome://tracing or Perfetto).");
   po::positional_options_description pod;
   pod.add("dex-files", -1);
   po::variables_map vm;
@@ -474,10 +506,21 @@ Arguments parse_args(int argc, char* argv[]) {
   if (vm.count("properties-check-allow-disabled")) {
     args.properties_check_allow_disabled = true;
   }
+  if (vm.count("plan")) {
+    args.plan = true;
+  }
+  if (vm.count("plan-stats")) {
+    args.plan_stats_path = vm["plan-stats"].as<std::string>();
+  }
+
+  if (vm.count("resume-ir")) {
+    args.resume_ir_dir = vm["resume-ir"].as<std::string>();
+  }
 
   if (vm.count("dex-files")) {
     args.dex_files = vm["dex-files"].as<std::vector<std::string>>();
-  } else if (!args.properties_check) {
+  } else if (!args.properties_check && !args.plan &&
+             args.resume_ir_dir.empty()) {
     std::cerr << "error: no input dex files" << std::endl << std::endl;
     print_usage();
     exit(EXIT_SUCCESS);
@@ -591,6 +634,10 @@ Arguments parse_args(int argc, char* argv[]) {
     args.redex_options.jni_summary_path = vm["jni-summary"].as<std::string>();
   }
 
+  if (vm.count("chrome-trace")) {
+    chrome_trace::enable(vm["chrome-trace"].as<std::string>());
+  }
+
   if (args.stop_pass_idx != boost::none) {
     // Resize the passes list and append an additional RegAllocPass if its final
     // pass is not RegAllocPass.
@@ -603,6 +650,7 @@ Arguments parse_args(int argc, char* argv[]) {
     if (passes_list.size() > (size_t)idx) {
       passes_list.resize(idx);
     }
+    args.entry_data["stop_pass_idx"] = idx;
     // Append the two passes when `--stop-pass` is enabled.
     passes_list.append("MakePublicPass");
     passes_list.append("RegAllocPass");
@@ -612,6 +660,28 @@ Arguments parse_args(int argc, char* argv[]) {
     }
   }
 
+  if (!args.resume_ir_dir.empty()) {
+    if (args.stop_pass_idx != boost::none) {
+      std::cerr << "resume-ir cannot be combined with stop-pass" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    // Drop the passes that already ran before the checkpoint was written.
+    auto entry_data = redex::parse_config(args.resume_ir_dir + "/entry.json");
+    auto idx = entry_data.get("stop_pass_idx", 0).asUInt();
+    auto& passes_list = args.config["redex"]["passes"];
+    if (idx > passes_list.size()) {
+      std::cerr << "resume-ir checkpoint stopped at pass " << idx
+                << ", but there are only " << passes_list.size() << " passes"
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    Json::Value remaining_passes = Json::arrayValue;
+    for (Json::ArrayIndex i = idx; i < passes_list.size(); ++i) {
+      remaining_passes.append(passes_list[i]);
+    }
+    passes_list = std::move(remaining_passes);
+  }
+
   std::string metafiles = args.out_dir + "/meta/";
   int status = [&metafiles]() -> int {
 #if !IS_WINDOWS
@@ -673,6 +743,9 @@ Json::Value get_stats(const dex_stats_t& stats) {
 
   val["instruction_bytes"] = stats.instruction_bytes;
 
+  val["num_minor_page_faults"] = stats.num_minor_page_faults;
+  val["num_major_page_faults"] = stats.num_major_page_faults;
+
   val["header_item_count"] = stats.header_item_count;
   val["header_item_bytes"] = stats.header_item_bytes;
   val["string_id_count"] = stats.string_id_count;
@@ -705,6 +778,8 @@ Json::Value get_stats(const dex_stats_t& stats) {
   val["code_bytes"] = stats.code_bytes;
   val["string_data_count"] = stats.string_data_count;
   val["string_data_bytes"] = stats.string_data_bytes;
+  val["num_coldstart_strings"] = stats.num_coldstart_strings;
+  val["num_coldstart_string_pages"] = stats.num_coldstart_string_pages;
   val["debug_info_count"] = stats.debug_info_count;
   val["debug_info_bytes"] = stats.debug_info_bytes;
   val["annotation_count"] = stats.annotation_count;
@@ -996,7 +1071,7 @@ std::string get_dex_magic(std::vector<std::string>& dex_files) {
 void dump_keep_reasons(const ConfigFiles& conf,
                        const Arguments& args,
                        const DexStoresVector& stores) {
-  if (!args.config.get("dump_keep_reasons", false).asBool()) {
+  if (!conf.get_json_config().get("dump_keep_reasons", false)) {
     return;
   }
 
@@ -1091,7 +1166,8 @@ void process_proguard_rules(ConfigFiles& conf,
   }
 }
 
-void load_library_jars(Arguments& args,
+void load_library_jars(const ConfigFiles& conf,
+                       Arguments& args,
                        Scope& external_classes,
                        const std::set<std::string>& library_jars,
                        const std::string& base_dir) {
@@ -1127,9 +1203,8 @@ void load_library_jars(Arguments& args,
 
   // We cannot use GlobalConfig here, it is too early.
   JarLoaderConfig jar_conf{};
-  if (args.config.isMember("jar_loader")) {
-    jar_conf.parse_config(
-        JsonWrapper(args.config.get("jar_loader", Json::nullValue)));
+  if (conf.get_json_config().contains("jar_loader")) {
+    jar_conf.parse_config(JsonWrapper(conf.get_json_config()["jar_loader"]));
   }
 
   Timer t("Load library jars");
@@ -1198,7 +1273,7 @@ void redex_frontend(ConfigFiles& conf, /* input */
   keep_rules::proguard_parser::identify_blanket_native_rules(&pg_config);
 
   auto ignore_no_keep_rules =
-      args.config.get("ignore_no_keep_rules", false).asBool();
+      conf.get_json_config().get("ignore_no_keep_rules", false);
   if (pg_config.keep_rules.empty() && !ignore_no_keep_rules) {
     std::cerr << "error: No ProGuard keep rules provided. Redex optimizations "
                  "will not preserve semantics without accurate keep rules."
@@ -1262,7 +1337,7 @@ void redex_frontend(ConfigFiles& conf, /* input */
   });
 
   Scope external_classes;
-  load_library_jars(args, external_classes, library_jars,
+  load_library_jars(conf, args, external_classes, library_jars,
                     pg_config.basedirectory);
 
   {
@@ -1351,6 +1426,26 @@ void finalize_resource_table(ConfigFiles& conf) {
 /**
  * Post processing steps: write dex and collect stats
  */
+/**
+ * Loads the checkpoint written by an earlier run with --stop-pass. The keep
+ * rules and reachability information were already applied by the run that
+ * wrote it, and are restored from the IR meta data.
+ */
+void resume_frontend(const Arguments& args, DexStoresVector& stores) {
+  Timer t("Resuming from IR checkpoint");
+  Json::Value entry_data;
+  redex::load_all_intermediate(args.resume_ir_dir, stores, &entry_data);
+  always_assert_log(!stores.empty() && !entry_data["dex_list"].empty(),
+                    "No dex files in checkpoint %s",
+                    args.resume_ir_dir.c_str());
+  // Only set dex magic to root DexStore since all dex magic should be
+  // consistent within one APK.
+  auto first_dex_path = boost::filesystem::path(args.resume_ir_dir) /
+                        entry_data["dex_list"][0]["list"][0].asString();
+  stores[0].set_dex_magic(load_dex_magic_from_dex(
+      DexLocation::make_location("dex", first_dex_path.string())));
+}
+
 void redex_backend(ConfigFiles& conf,
                    PassManager& manager,
                    DexStoresVector& stores,
@@ -1366,9 +1461,12 @@ void redex_backend(ConfigFiles& conf,
   {
     bool lower_with_cfg = true;
     conf.get_json_config().get("lower_with_cfg", true, lower_with_cfg);
+    bool profile_guided_block_layout = false;
+    conf.get_json_config().get("profile_guided_block_layout", false,
+                               profile_guided_block_layout);
     Timer t("Instruction lowering");
-    instruction_lowering_stats =
-        instruction_lowering::run(stores, lower_with_cfg, &conf);
+    instruction_lowering_stats = instruction_lowering::run(
+        stores, lower_with_cfg, &conf, profile_guided_block_layout);
   }
 
   sanitizers::lsan_do_recoverable_leak_check();
@@ -1487,12 +1585,12 @@ void redex_backend(ConfigFiles& conf,
     const Json::Value& opt_decisions_args = json_config["opt_decisions"];
     if (opt_decisions_args.get("enable_logs", false).asBool()) {
       auto opt_decisions_output_path = conf.metafile(OPT_DECISIONS);
-      auto opt_data =
-          opt_metadata::OptDataMapper::get_instance().serialize_sql();
-      {
-        std::ofstream opt_data_out(opt_decisions_output_path);
-        opt_data_out << opt_data;
+      bool compress = opt_decisions_args.get("compress_output", false).asBool();
+      if (compress) {
+        opt_decisions_output_path += ".gz";
       }
+      opt_metadata::OptDataMapper::get_instance().write_sql(
+          opt_decisions_output_path, compress);
     }
   }
 
@@ -1643,8 +1741,35 @@ void copy_proguard_stats(Json::Value& stats) {
   }
 }
 
-int check_pass_properties(const Arguments& args) {
+// Returns a description of the first violation of the property interactions
+// of `active_passes`, if any.
+std::optional<std::string> verify_pass_order(
+    ConfigFiles& conf, const PassManager::ActivatedPasses& active_passes) {
   using namespace redex_properties;
+  auto props_manager =
+      Manager(conf, PropertyCheckerRegistry::get().get_checkers());
+  std::vector<std::pair<std::string, PropertyInteractions>> pass_interactions;
+  for (const auto& [pass, _] : active_passes.activated_passes) {
+    auto m = pass->get_property_interactions();
+    for (auto it = m.begin(); it != m.end();) {
+      auto&& [name, property_interaction] = *it;
+
+      if (!props_manager.property_is_enabled(name)) {
+        it = m.erase(it);
+        continue;
+      }
+
+      always_assert_log(property_interaction.is_valid(),
+                        "%s has an invalid property interaction for %s",
+                        pass->name().c_str(), get_name(name));
+      ++it;
+    }
+    pass_interactions.emplace_back(pass->name(), std::move(m));
+  }
+  return Manager::verify_pass_interactions(pass_interactions, conf);
+}
+
+int check_pass_properties(const Arguments& args) {
   // Cannot parse GlobalConfig nor passes, as they may require binding
   // to dex elements. So this looks more complicated than necessary.
 
@@ -1663,41 +1788,170 @@ int check_pass_properties(const Arguments& args) {
   }
 
   auto const& all_passes = PassRegistry::get().get_passes();
-  auto props_manager =
-      Manager(conf, PropertyCheckerRegistry::get().get_checkers());
   auto active_passes =
       PassManager::compute_activated_passes(all_passes, conf, &pmc);
+  auto failure = verify_pass_order(conf, active_passes);
+  if (failure) {
+    std::cerr << "Illegal pass order:\n" << *failure << std::endl;
+    return 1;
+  }
+  return 0;
+}
 
-  std::vector<std::pair<std::string, PropertyInteractions>> pass_interactions;
-  for (const auto& [pass, _] : active_passes.activated_passes) {
-    auto m = pass->get_property_interactions();
-    for (auto it = m.begin(); it != m.end();) {
-      auto&& [name, property_interaction] = *it;
+// Classifies the memory use of each pass from the VmHWM deltas of a previous
+// run: there is nothing to go by statically.
+std::vector<std::string> estimate_memory_classes(
+    const std::string& stats_path,
+    const std::vector<std::pair<Pass*, std::string>>& passes) {
+  Json::Value pass_stats;
+  if (!stats_path.empty()) {
+    std::ifstream stats_file(stats_path);
+    always_assert_log(stats_file, "Cannot open %s", stats_path.c_str());
+    Json::Value stats;
+    stats_file >> stats;
+    pass_stats = stats["output_stats"]["pass_stats"];
+  }
+
+  std::vector<std::string> classes;
+  std::unordered_map<const Pass*, size_t> pass_counters;
+  for (const auto& [pass, _] : passes) {
+    // Same naming as the PassInfo the stats were written from.
+    auto name = pass->name() + "#" + std::to_string(++pass_counters[pass]);
+    if (!pass_stats.isMember(name) ||
+        !pass_stats[name].isMember("vm_hwm_delta")) {
+      classes.emplace_back("unknown");
+      continue;
+    }
+    auto delta = pass_stats[name]["vm_hwm_delta"].asInt64();
+    constexpr int64_t kMB = 1024 * 1024;
+    if (delta < 64 * kMB) {
+      classes.emplace_back("low");
+    } else if (delta < 1024 * kMB) {
+      classes.emplace_back("medium");
+    } else {
+      classes.emplace_back("high");
+    }
+  }
+  return classes;
+}
 
-      if (!props_manager.property_is_enabled(name)) {
-        it = m.erase(it);
-        continue;
-      }
+// Does all of the setup of a run that does not need the inputs: resolving the
+// pass list and parsing the configuration of Redex and of every pass. Dex
+// element bindings cannot resolve without inputs, so they are skipped.
+int plan_passes(const Arguments& args) {
+  ConfigFiles conf(args.config, args.out_dir);
 
-      always_assert_log(property_interaction.is_valid(),
-                        "%s has an invalid property interaction for %s",
-                        pass->name().c_str(), get_name(name));
-      ++it;
+  PassManagerConfig pmc;
+  if (conf.get_json_config().contains("pass_manager")) {
+    pmc.parse_config(JsonWrapper(conf.get_json_config().get(
+        "pass_manager", (Json::Value)Json::nullValue)));
+  }
+
+  auto const& all_passes = PassRegistry::get().get_passes();
+  auto active_passes =
+      PassManager::compute_activated_passes(all_passes, conf, &pmc);
+
+  Configurable::ScopedAllowUnresolved allow_unresolved;
+  bool ok = true;
+  try {
+    conf.parse_global_config();
+  } catch (const std::exception& e) {
+    std::cerr << "Invalid global config: " << e.what() << std::endl;
+    ok = false;
+  }
+
+  const auto& json_config = conf.get_json_config();
+  auto memory_classes = estimate_memory_classes(
+      args.plan_stats_path, active_passes.activated_passes);
+  std::cout << "Planned passes: " << active_passes.activated_passes.size()
+            << std::endl;
+  for (size_t i = 0; i < active_passes.activated_passes.size(); ++i) {
+    const auto& [pass, config_name] = active_passes.activated_passes[i];
+    std::cout << i + 1 << ": " << config_name;
+    if (config_name != pass->name()) {
+      std::cout << " (" << pass->name() << ")";
+    }
+    std::cout << ", memory: " << memory_classes[i] << std::endl;
+    try {
+      pass->parse_config(JsonWrapper(json_config[config_name.c_str()]));
+    } catch (const std::exception& e) {
+      std::cerr << "Invalid config for " << config_name << ": " << e.what()
+                << std::endl;
+      ok = false;
     }
-    pass_interactions.emplace_back(pass->name(), std::move(m));
   }
-  auto failure = Manager::verify_pass_interactions(pass_interactions, conf);
-  if (failure) {
-    std::cerr << "Illegal pass order:\n" << *failure << std::endl;
-    return 1;
+
+  if (pmc.check_pass_order_properties) {
+    auto failure = verify_pass_order(conf, active_passes);
+    if (failure) {
+      std::cerr << "Illegal pass order:\n" << *failure << std::endl;
+      ok = false;
+    }
   }
-  return 0;
+  return ok ? 0 : 1;
+}
+
+#if !IS_WINDOWS
+// Runs redex once for every line of `batch_file`, which holds the arguments of
+// one app variant. Blank lines and lines starting with '#' are skipped. Each
+// variant runs in its own forked process, so that it starts from a fresh
+// RedexContext and a failing variant does not take down the others.
+int run_batch(char* argv0, const std::string& batch_file) {
+  std::ifstream in(batch_file);
+  if (!in) {
+    std::cerr << "error: cannot open batch file " << batch_file << std::endl;
+    return EXIT_FAILURE;
+  }
+  size_t num_variants = 0;
+  size_t num_failed = 0;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    auto variant_args = boost::program_options::split_unix(line);
+    num_variants++;
+    Timer t("Batch variant " + std::to_string(num_variants));
+    std::cerr << "Running batch variant " << num_variants << ": " << line
+              << std::endl;
+    pid_t child = fork();
+    always_assert_log(child != -1, "Failed to fork: %s", strerror(errno));
+    if (child == 0) {
+      std::vector<char*> child_argv{argv0};
+      for (auto& arg : variant_args) {
+        child_argv.push_back(arg.data());
+      }
+      child_argv.push_back(nullptr);
+      exit(redex_main(child_argv.size() - 1, child_argv.data()));
+    }
+    int status;
+    pid_t wpid = waitpid(child, &status, 0);
+    always_assert_log(wpid != -1, "Failed to waitpid: %s", strerror(errno));
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::cerr << "error: batch variant " << num_variants << " failed"
+                << std::endl;
+      num_failed++;
+    }
+  }
+  std::cerr << "Batch done: " << num_variants - num_failed << " of "
+            << num_variants << " variants succeeded" << std::endl;
+  return num_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
+#endif
 
 } // namespace
 
-// NOLINTNEXTLINE(bugprone-exception-escape)
 int main(int argc, char* argv[]) {
+#if !IS_WINDOWS
+  if (argc == 3 && strcmp(argv[1], "--batch") == 0) {
+    return run_batch(argv[0], argv[2]);
+  }
+#endif
+  return redex_main(argc, argv);
+}
+
+// NOLINTNEXTLINE(bugprone-exception-escape)
+int redex_main(int argc, char* argv[]) {
   signal(SIGABRT, debug_backtrace_handler);
   signal(SIGINT, debug_backtrace_handler);
   signal(SIGSEGV, crash_backtrace_handler);
@@ -1749,6 +2003,9 @@ int main(int argc, char* argv[]) {
     if (args.properties_check) {
       return check_pass_properties(args);
     }
+    if (args.plan) {
+      return plan_passes(args);
+    }
 
     keep_reason::Reason::set_record_keep_reasons(
         args.config.get("record_keep_reasons", false).asBool());
@@ -1758,6 +2015,33 @@ int main(int argc, char* argv[]) {
     if (g_redex->instrument_mode) {
       IRList::CONSECUTIVE_STYLE = IRList::ConsecutiveStyle::kChain;
     }
+    g_redex->lazy_code_materialization =
+        args.config.get("lazy_code_materialization", false).asBool();
+    {
+      auto debug_info_loading =
+          args.config.get("debug_info_loading", "full").asString();
+      if (debug_info_loading == "lines_only") {
+        g_redex->debug_info_loading =
+            RedexContext::DebugInfoLoading::kLinesOnly;
+      } else if (debug_info_loading == "none") {
+        g_redex->debug_info_loading = RedexContext::DebugInfoLoading::kNone;
+      } else {
+        always_assert_log(debug_info_loading == "full",
+                          "Unknown debug_info_loading value %s",
+                          debug_info_loading.c_str());
+      }
+    }
+    g_redex->parallel_fixpoint_threads =
+        args.config.get("parallel_fixpoint_threads", 1).asUInt();
+    g_redex->parallel_fixpoint_min_blocks =
+        args.config
+            .get("parallel_fixpoint_min_blocks",
+                 (Json::UInt)g_redex->parallel_fixpoint_min_blocks)
+            .asUInt();
+    g_redex->analysis_summary_cache_dir =
+        args.config.get("analysis_summary_cache_dir", "").asString();
+    sparta::set_patricia_tree_hash_consing(
+        args.config.get("patricia_tree_hash_consing", false).asBool());
     {
       auto consecutive_val =
           args.config.get("sb_consecutive_style", Json::nullValue);
@@ -1787,7 +2071,8 @@ int main(int argc, char* argv[]) {
 
     auto pg_config = std::make_unique<keep_rules::ProguardConfiguration>();
     DexStoresVector stores;
-    ConfigFiles conf(args.config, args.out_dir);
+    // The config DOM stays with `conf` from here on.
+    ConfigFiles conf(std::move(args.config), args.out_dir);
 
     std::string apk_dir;
     conf.get_json_config().get("apk_dir", "", apk_dir);
@@ -1798,15 +2083,25 @@ int main(int argc, char* argv[]) {
       args.redex_options.min_sdk = *maybe_sdk;
     }
 
+    // Validating the input resources only needs the resource table, so it
+    // overlaps with loading the code. It must be done before any pass may
+    // modify resources.
+    auto pre_run_resources_check = std::async(
+        std::launch::async, [&conf] { check_required_resources(conf, true); });
+
     {
       auto profile_frontend =
           ScopedCommandProfiling::maybe_from_env("FRONTEND_", "frontend");
-      redex_frontend(conf, args, *pg_config, stores, stats);
+      if (args.resume_ir_dir.empty()) {
+        redex_frontend(conf, args, *pg_config, stores, stats);
+      } else {
+        resume_frontend(args, stores);
+      }
       conf.parse_global_config();
       maybe_dump_jemalloc_profile("MALLOC_PROFILE_DUMP_FRONTEND");
     }
 
-    check_required_resources(conf, true);
+    pre_run_resources_check.get();
 
     auto const& passes = PassRegistry::get().get_passes();
     auto props_manager = redex_properties::Manager(
@@ -1825,7 +2120,7 @@ int main(int argc, char* argv[]) {
       auto profile_backend =
           ScopedCommandProfiling::maybe_from_env("BACKEND_", "backend");
       redex_backend(conf, manager, stores, stats);
-      if (args.config.get("emit_class_method_info_map", false).asBool()) {
+      if (conf.get_json_config().get("emit_class_method_info_map", false)) {
         dump_class_method_info_map(conf.metafile(CLASS_METHOD_INFO_MAP),
                                    stores);
       }
@@ -1836,7 +2131,8 @@ int main(int argc, char* argv[]) {
     maybe_dump_jemalloc_profile("MALLOC_PROFILE_DUMP_BACKEND");
 
     stats_output_path = conf.metafile(
-        args.config.get("stats_output", "redex-stats.txt").asString());
+        conf.get_json_config().get("stats_output",
+                                   std::string("redex-stats.txt")));
 
     {
       Timer t("Freeing global memory");
@@ -1855,6 +2151,10 @@ int main(int argc, char* argv[]) {
   stats["output_stats"]["threads"] = get_threads_stats();
 
   stats["output_stats"]["build_cfg_counter"] = (Json::UInt64)build_cfg_counter;
+  for (const auto& [type_name, count] : cc_impl::get_lock_contention()) {
+    stats["output_stats"]["concurrent_map_lock_contention"][type_name] =
+        (Json::UInt64)count;
+  }
   // For the time being, copy proguard stats, if any, to the first pass.
   copy_proguard_stats(stats);
 
@@ -1863,6 +2163,8 @@ int main(int argc, char* argv[]) {
     out << stats;
   }
 
+  chrome_trace::write();
+
   TRACE(MAIN, 1, "Done.");
   if (traceEnabled(MAIN, 1) || traceEnabled(STATS, 1)) {
     TRACE(STATS, 0, "Memory stats: VmPeak=%s VmHWM=%s",
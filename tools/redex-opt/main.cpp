@@ -7,13 +7,23 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <json/json.h>
+#include <map>
 
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "Debug.h"
 #include "DexClass.h"
 #include "DexLoader.h"
 #include "PassRegistry.h"
 #include "RedexContext.h"
+#include "ThreadPool.h"
 #include "Timer.h"
 #include "ToolsCommon.h"
 
@@ -27,8 +37,23 @@ struct Arguments {
   std::string config_file;
   std::vector<std::string> s_args;
   std::vector<std::string> j_args;
+  std::string batch_file;
+  size_t jobs{1};
 };
 
+void create_output_dir(const std::string& output_ir_dir) {
+  if (output_ir_dir.empty()) {
+    std::cerr << "output-dir is empty\n";
+    exit(EXIT_FAILURE);
+  }
+  std::string meta_dir = output_ir_dir + "/meta";
+  boost::filesystem::create_directories(meta_dir);
+  if (!boost::filesystem::is_directory(meta_dir)) {
+    std::cerr << "Could not create " << meta_dir << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
 Arguments parse_args(int argc, char* argv[]) {
   namespace po = boost::program_options;
   po::options_description desc(
@@ -45,6 +70,17 @@ Arguments parse_args(int argc, char* argv[]) {
                      po::value<std::string>(),
                      "A JSON-formatted config file to replace the one from "
                      "{input-ir}/entry.json");
+  desc.add_options()(
+      "batch,b",
+      po::value<std::string>(),
+      "A JSON file with an array of runs. The input is loaded once and each "
+      "run is executed in a forked copy of it. Each run is an object with "
+      "the keys \"output-ir\" (required), \"pass-name\", \"config\", \"S\" "
+      "and \"J\", which have the same meaning as the command line options "
+      "and extend them");
+  desc.add_options()("jobs,j",
+                     po::value<size_t>(),
+                     "Number of batch runs to execute concurrently");
   desc.add_options()(",S",
                      po::value<std::vector<std::string>>(), // Accumulation
                      "-Skey=string\n"
@@ -87,15 +123,16 @@ Arguments parse_args(int argc, char* argv[]) {
   if (vm.count("output-ir")) {
     args.output_ir_dir = vm["output-ir"].as<std::string>();
   }
-  if (args.output_ir_dir.empty()) {
-    std::cerr << "output-dir is empty\n";
-    exit(EXIT_FAILURE);
+
+  if (vm.count("batch")) {
+    args.batch_file = vm["batch"].as<std::string>();
   }
-  std::string meta_dir = args.output_ir_dir + "/meta";
-  boost::filesystem::create_directories(meta_dir);
-  if (!boost::filesystem::is_directory(meta_dir)) {
-    std::cerr << "Could not create " << meta_dir << std::endl;
-    exit(EXIT_FAILURE);
+  if (vm.count("jobs")) {
+    args.jobs = std::max<size_t>(1, vm["jobs"].as<size_t>());
+  }
+
+  if (args.batch_file.empty()) {
+    create_output_dir(args.output_ir_dir);
   }
 
   if (vm.count("pass-name")) {
@@ -198,6 +235,144 @@ Json::Value process_entry_data(const Json::Value& entry_data,
 
   return config_data;
 }
+
+void run_passes(Arguments& args,
+                Json::Value entry_data,
+                DexStoresVector& stores) {
+  if (!args.config_file.empty()) {
+    entry_data["config"] = args.config_file;
+  }
+
+  args.redex_options.deserialize(entry_data);
+
+  Json::Value config_data = process_entry_data(entry_data, args);
+  ConfigFiles conf(config_data, args.output_ir_dir);
+
+  const auto& passes = PassRegistry::get().get_passes();
+  PassManager manager(passes, conf, args.redex_options);
+  manager.set_testing_mode();
+  manager.run_passes(stores, conf);
+
+  redex::write_all_intermediate(conf, args.output_ir_dir, args.redex_options,
+                                stores, entry_data);
+}
+
+void append_strings(const Json::Value& run,
+                    const char* key,
+                    std::vector<std::string>* out) {
+  if (!run.isMember(key)) {
+    return;
+  }
+  const auto& value = run[key];
+  if (value.isArray()) {
+    for (const auto& item : value) {
+      out->push_back(item.asString());
+    }
+  } else {
+    out->push_back(value.asString());
+  }
+}
+
+/**
+ * Each run of a batch starts from the arguments given on the command line and
+ * extends them with the values of its JSON object.
+ */
+std::vector<Arguments> parse_batch(const Arguments& args) {
+  Json::Value batch = redex::parse_config(args.batch_file);
+  if (!batch.isArray()) {
+    std::cerr << "error: " << args.batch_file << " is not a JSON array\n";
+    exit(EXIT_FAILURE);
+  }
+  std::vector<Arguments> runs;
+  for (const auto& run : batch) {
+    Arguments run_args = args;
+    run_args.batch_file.clear();
+    run_args.output_ir_dir = run.get("output-ir", "").asString();
+    if (run.isMember("config")) {
+      run_args.config_file = run["config"].asString();
+    }
+    append_strings(run, "pass-name", &run_args.pass_names);
+    append_strings(run, "S", &run_args.s_args);
+    append_strings(run, "J", &run_args.j_args);
+    create_output_dir(run_args.output_ir_dir);
+    runs.push_back(std::move(run_args));
+  }
+  return runs;
+}
+
+#ifdef __linux__
+/**
+ * Run every configuration of the batch in its own forked child, so that all of
+ * them share the loaded stores copy-on-write instead of loading the input IR
+ * again. At most `args.jobs` children run at the same time.
+ */
+int run_batch(const Arguments& args,
+              const Json::Value& entry_data,
+              DexStoresVector& stores) {
+  auto runs = parse_batch(args);
+
+  // Worker threads do not survive a fork.
+  auto thread_pool_instance = redex_thread_pool::ThreadPool::get_instance();
+  if (thread_pool_instance != nullptr) {
+    thread_pool_instance->join();
+  }
+
+  std::map<pid_t, size_t> open_jobs;
+  size_t failures = 0;
+  auto wait_one = [&]() {
+    int stat;
+    pid_t pid;
+    do {
+      pid = wait(&stat);
+    } while (pid == -1 && errno == EINTR);
+    always_assert_log(pid != -1, "wait failed: %s", strerror(errno));
+    auto it = open_jobs.find(pid);
+    if (it == open_jobs.end()) {
+      return;
+    }
+    const auto& output_ir_dir = runs[it->second].output_ir_dir;
+    if (WIFEXITED(stat) && WEXITSTATUS(stat) == 0) {
+      std::cerr << "Finished " << output_ir_dir << std::endl;
+    } else {
+      std::cerr << "Run for " << output_ir_dir << " failed" << std::endl;
+      ++failures;
+    }
+    open_jobs.erase(it);
+  };
+
+  for (size_t i = 0; i < runs.size(); ++i) {
+    while (open_jobs.size() >= args.jobs) {
+      wait_one();
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+      std::cerr << "Fork failed! " << strerror(errno) << std::endl;
+      ++failures;
+      continue;
+    }
+    if (pid == 0) {
+      // Child: run the passes on our private copy of the stores and leave
+      // without tearing down the shared state.
+      run_passes(runs[i], entry_data, stores);
+      std::cout.flush();
+      std::cerr.flush();
+      _exit(EXIT_SUCCESS);
+    }
+    open_jobs.emplace(pid, i);
+  }
+  while (!open_jobs.empty()) {
+    wait_one();
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#else
+int run_batch(const Arguments&, const Json::Value&, DexStoresVector&) {
+  std::cerr << "error: --batch is only supported on Linux\n";
+  return EXIT_FAILURE;
+}
+#endif
 } // namespace
 
 int main(int argc, char* argv[]) {
@@ -220,23 +395,13 @@ int main(int argc, char* argv[]) {
     stores[0].set_dex_magic(load_dex_magic_from_dex(location));
   }
 
-  if (!args.config_file.empty()) {
-    entry_data["config"] = args.config_file;
+  int ret = EXIT_SUCCESS;
+  if (!args.batch_file.empty()) {
+    ret = run_batch(args, entry_data, stores);
+  } else {
+    run_passes(args, entry_data, stores);
   }
 
-  args.redex_options.deserialize(entry_data);
-
-  Json::Value config_data = process_entry_data(entry_data, args);
-  ConfigFiles conf(config_data, args.output_ir_dir);
-
-  const auto& passes = PassRegistry::get().get_passes();
-  PassManager manager(passes, conf, args.redex_options);
-  manager.set_testing_mode();
-  manager.run_passes(stores, conf);
-
-  redex::write_all_intermediate(conf, args.output_ir_dir, args.redex_options,
-                                stores, entry_data);
-
   delete g_redex;
-  return 0;
+  return ret;
 }
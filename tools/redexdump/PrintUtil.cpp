@@ -12,26 +12,29 @@
 bool clean = false;
 bool raw = false;
 bool escape = false;
+thread_local FILE* redump_out = nullptr;
+
+static FILE* out() { return redump_out != nullptr ? redump_out : stdout; }
 
 void redump(const char* format, ...) {
   va_list va;
   va_start(va, format);
-  vprintf(format, va);
+  vfprintf(out(), format, va);
   va_end(va);
 }
 
 void redump(uint32_t off, const char* format, ...) {
   va_list va;
   va_start(va, format);
-  if (!clean) printf("[0x%x] ", off);
-  vprintf(format, va);
+  if (!clean) fprintf(out(), "[0x%x] ", off);
+  vfprintf(out(), format, va);
   va_end(va);
 }
 
 void redump(uint32_t pos, uint32_t off, const char* format, ...) {
   va_list va;
   va_start(va, format);
-  if (!clean) printf("(0x%x) [0x%x] ", pos, off);
-  vprintf(format, va);
+  if (!clean) fprintf(out(), "(0x%x) [0x%x] ", pos, off);
+  vfprintf(out(), format, va);
   va_end(va);
 }
@@ -8,11 +8,15 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdio.h>
 
 extern bool clean;
 extern bool raw;
 extern bool escape;
 
+// Stream the calling thread's redump output goes to; stdout when unset.
+extern thread_local FILE* redump_out;
+
 void redump(const char* format, ...);
 void redump(uint32_t off, const char* format, ...);
 void redump(uint32_t pos, uint32_t off, const char* format, ...);
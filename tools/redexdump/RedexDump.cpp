@@ -6,10 +6,14 @@
  */
 
 #include "RedexDump.h"
+#include <algorithm>
+#include <atomic>
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <thread>
+#include <vector>
 
 #include "Formatters.h"
 #include "PrintUtil.h"
@@ -164,8 +168,7 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
-  while (optind < argc) {
-    const char* dexfile = argv[optind++];
+  auto dump_dex = [&](const char* dexfile) {
     ddump_data rd;
     open_dex_file(dexfile, &rd);
     if (!no_headers) {
@@ -217,9 +220,51 @@ int main(int argc, char* argv[]) {
     if (ddebug_offset != 0) {
       disassemble_debug(&rd, ddebug_offset);
     }
-    fprintf(stdout, "\n");
+    redump("\n");
+  };
+
+  std::vector<const char*> dexfiles(argv + optind, argv + argc);
+  if (dexfiles.size() == 1) {
+    dump_dex(dexfiles[0]);
     fflush(stdout);
+    return 0;
+  }
+
+  // Several dex files are dumped concurrently, each into its own in-memory
+  // stream, and then written out in the order they were given.
+  struct DumpBuffer {
+    char* data = nullptr;
+    size_t size = 0;
+  };
+  std::vector<DumpBuffer> buffers(dexfiles.size());
+  std::atomic<size_t> next_dexfile{0};
+  auto worker = [&]() {
+    for (size_t i = next_dexfile++; i < dexfiles.size(); i = next_dexfile++) {
+      redump_out = open_memstream(&buffers[i].data, &buffers[i].size);
+      if (redump_out == nullptr) {
+        fprintf(stderr, "Cannot allocate output for %s, bailing\n",
+                dexfiles[i]);
+        exit(1);
+      }
+      dump_dex(dexfiles[i]);
+      fclose(redump_out);
+      redump_out = nullptr;
+    }
+  };
+  size_t num_threads = std::min<size_t>(
+      dexfiles.size(), std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& buffer : buffers) {
+    fwrite(buffer.data, 1, buffer.size, stdout);
+    free(buffer.data);
   }
+  fflush(stdout);
 
   return 0;
 }
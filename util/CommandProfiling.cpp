@@ -114,7 +114,7 @@ ScopedCommandProfiling::~ScopedCommandProfiling() {
       kill_and_wait(m_profiler, SIGINT);
     }
     if (m_post_cmd) {
-      run_and_wait(*m_post_cmd + " perf.data");
+      run_and_wait(*m_post_cmd + " " + m_data_file);
     }
   }
 }
@@ -129,6 +129,7 @@ ScopedCommandProfiling& ScopedCommandProfiling::operator=(
   m_profiler = rhs.m_profiler;
   m_shutdown_cmd = std::move(rhs.m_shutdown_cmd);
   m_post_cmd = std::move(rhs.m_post_cmd);
+  m_data_file = std::move(rhs.m_data_file);
 
   rhs.m_profiler = -1;
 
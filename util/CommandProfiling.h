@@ -15,6 +15,9 @@ class ScopedCommandProfiling final {
     std::string command;
     boost::optional<std::string> shutdown_cmd;
     boost::optional<std::string> post_cmd;
+    // The profile the command writes, passed as the last argument to the
+    // post command.
+    std::string data_file{"perf.data"};
     ProfilerInfo(const std::string& command,
                  const boost::optional<std::string>& shutdown_cmd,
                  const boost::optional<std::string>& post_cmd)
@@ -41,7 +44,9 @@ class ScopedCommandProfiling final {
   explicit ScopedCommandProfiling(const ProfilerInfo& info,
                                   const T* log_str = nullptr)
       : ScopedCommandProfiling(
-            info.command, info.shutdown_cmd, info.post_cmd, log_str) {}
+            info.command, info.shutdown_cmd, info.post_cmd, log_str) {
+    m_data_file = info.data_file;
+  }
   ScopedCommandProfiling(const ScopedCommandProfiling&) = delete;
   ScopedCommandProfiling(ScopedCommandProfiling&&) noexcept;
 
@@ -67,4 +72,5 @@ class ScopedCommandProfiling final {
   boost::optional<std::string> m_shutdown_cmd;
   // After the profiling process has finished, run this command.
   boost::optional<std::string> m_post_cmd;
+  std::string m_data_file{"perf.data"};
 };
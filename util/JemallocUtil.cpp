@@ -72,6 +72,28 @@ void some_malloc_stats(const std::function<void(const char*, uint64_t)>& fn) {
   // Consider stats.arenas here.
 }
 
+uint64_t num_allocations() {
+  // Statistics are only refreshed when the epoch is advanced.
+  uint64_t epoch = 1;
+  size_t epoch_len = sizeof(epoch);
+  mallctl("epoch", &epoch, &epoch_len, &epoch, epoch_len);
+
+  uint64_t res = 0;
+  auto all_arenas = "stats.arenas." + std::to_string(MALLCTL_ARENAS_ALL);
+  for (const char* kind : {".small.nmalloc", ".large.nmalloc"}) {
+    uint64_t value;
+    size_t len = sizeof(value);
+    auto stat = all_arenas + kind;
+    auto err = mallctl(stat.c_str(), &value, &len, nullptr, 0);
+    if (err != 0) {
+      std::cerr << "Failed reading " << stat << ": " << err << std::endl;
+      continue;
+    }
+    res += value;
+  }
+  return res;
+}
+
 #else // !USE_JEMALLOC
 
 void enable_profiling() {}
@@ -85,6 +107,8 @@ void dump(const std::string&) {
 std::string get_malloc_stats() { return ""; }
 void some_malloc_stats(const std::function<void(const char*, uint64_t)>&) {}
 
+uint64_t num_allocations() { return 0; }
+
 #endif
 
 } // namespace jemalloc_util
@@ -33,4 +33,8 @@ class ScopedProfiling final {
 std::string get_malloc_stats();
 void some_malloc_stats(const std::function<void(const char*, uint64_t)>& fn);
 
+// Number of allocations made so far by all threads. Always zero without
+// jemalloc.
+uint64_t num_allocations();
+
 } // namespace jemalloc_util
@@ -90,13 +90,11 @@ constexpr const char* NEW_CHECK_EXPR_NULL_SIGNATURE_POST =
 // Lkotlin/jvm/internal/Intrinsics;.checkParameterIsNotNull which does not
 // require name of the parameter.
 inline DexMethod* kotlin_jvm_internal_Intrinsics_WrCheckParameter_V1_3() {
-  return static_cast<DexMethod*>(
-      DexMethod::get_method(NEW_CHECK_PARAM_NULL_SIGNATURE_V1_3));
+  return method::kotlin_jvm_internal_Intrinsics_WrCheckParameter_V1_3();
 }
 
 inline DexMethod* kotlin_jvm_internal_Intrinsics_WrCheckParameter_V1_4() {
-  return static_cast<DexMethod*>(
-      DexMethod::get_method(NEW_CHECK_PARAM_NULL_SIGNATURE_V1_4));
+  return method::kotlin_jvm_internal_Intrinsics_WrCheckParameter_V1_4();
 }
 
 // Wrapper for Kotlin null safety check
@@ -52,10 +52,22 @@ class MutablePriorityQueue {
   }
 
   // Changes the priority of a value. The value must already be in the queue.
-  // No current queue element may already have the new priority.
+  // No current queue element may already have the new priority. Re-keys the
+  // existing node, and does nothing if the priority didn't change.
   void update_priority(const Value& value, const Priority& priority) {
-    erase(value);
-    insert(value, priority);
+    auto priority_it = m_priorities.find(value);
+    always_assert(priority_it != m_priorities.end());
+    auto& old_priority = priority_it->second;
+    if (!m_values.key_comp()(old_priority, priority) &&
+        !m_values.key_comp()(priority, old_priority)) {
+      return;
+    }
+    auto node = m_values.extract(old_priority);
+    always_assert(!node.empty());
+    node.key() = priority;
+    auto map_result = m_values.insert(std::move(node));
+    always_assert(map_result.inserted);
+    old_priority = priority;
   }
 
   // Removes all elements.